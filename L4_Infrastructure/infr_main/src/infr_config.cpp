@@ -7,6 +7,7 @@
  */
 
 #include "infr_config.h"
+#include <comm_arena.h>
 #include <comm_config_client.h>
 #include <glog/logging.h>
 
@@ -76,8 +77,7 @@ void InfrConfig::Initialize() {
 }
 
 InfrMainConfig InfrConfig::Get() const {
-  std::lock_guard<std::mutex> lock(m_config_mutex);
-  return m_config;
+  return m_config.Copy();
 }
 
 void InfrConfig::RegisterReloadListener(std::function<void()> listener) {
@@ -97,10 +97,7 @@ void InfrConfig::Reload() {
     auto& config = comm::Config::Instance();
     auto new_config = config.Get<InfrMainConfig>("infr_main");
 
-    {
-      std::lock_guard<std::mutex> lock(m_config_mutex);
-      m_config = new_config;
-    }
+    m_config.Update(std::move(new_config));
 
     LOG(INFO) << "InfrConfig reloaded successfully";
   } catch (const std::exception& e) {
@@ -109,10 +106,11 @@ void InfrConfig::Reload() {
 }
 
 void InfrConfig::NotifyListeners() {
-  std::vector<std::function<void()>> listeners_copy;
+  comm::InlineArena<2048> arena;
+  std::pmr::vector<std::function<void()>> listeners_copy(&arena);
   {
     std::lock_guard<std::mutex> lock(m_listeners_mutex);
-    listeners_copy = m_listeners;
+    listeners_copy.assign(m_listeners.begin(), m_listeners.end());
   }
 
   LOG(INFO) << "Notifying " << listeners_copy.size() << " InfrConfig listener(s)";
@@ -6,6 +6,8 @@
 #include <vector>
 #include <toml.hpp>
 
+#include <comm_rcu.h>
+
 namespace infr {
 
 struct InfrMainConfig {
@@ -46,7 +48,7 @@ class InfrConfig {
   void Initialize();
 
   /**
-   * @brief Get current configuration (thread-safe)
+   * @brief Get current configuration (thread-safe, lock-free)
    * @return Copy of current InfrMainConfig
    */
   InfrMainConfig Get() const;
@@ -77,8 +79,7 @@ class InfrConfig {
   void NotifyListeners();
 
   bool m_initialized{false};
-  InfrMainConfig m_config;
-  mutable std::mutex m_config_mutex;
+  comm::Rcu<InfrMainConfig> m_config;  // Readers never block on a reload
   std::vector<std::function<void()>> m_listeners;
   mutable std::mutex m_listeners_mutex;
 };
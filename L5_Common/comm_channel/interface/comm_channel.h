@@ -0,0 +1,370 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_channel.h
+ * @brief Typed bounded channels between pipeline stages
+ * @details A Channel<T> holds at most capacity elements. When it is full,
+ *          Send() blocks (or TrySend() fails, or SendFor() times out), so an
+ *          overloaded consumer slows its producers down instead of letting
+ *          the backlog grow. Close() lets receivers drain what is left.
+ *          Select (comm_select.h) waits on several channels at once.
+ *
+ * @code
+ * comm::Channel<Request> requests(1024);
+ *
+ * // Producer
+ * if (auto error = requests.SendFor(std::move(request), 10ms)) {
+ *   return Reject(error);                // ChannelError::Timeout or Closed
+ * }
+ *
+ * // Consumer
+ * Request request;
+ * while (!requests.Receive(request)) {
+ *   Handle(request);
+ * }                                      // Closed: closed and drained
+ * @endcode
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace comm {
+
+/**
+ * @brief Error codes for Channel module operations
+ */
+enum class ChannelError {
+  Success = 0,  ///< Operation completed successfully
+  Closed = 1,   ///< Channel closed (and, for receives, drained)
+  Full = 2,     ///< TrySend(): no room
+  Empty = 3,    ///< TryReceive(), Select::Try(): nothing ready
+  Timeout = 4,  ///< *For()/*Until(): deadline passed
+};
+
+/**
+ * @brief Error category for Channel module errors
+ */
+class ChannelErrorCategory : public std::error_category {
+ public:
+  const char* name() const noexcept override { return "comm_channel"; }
+  std::string message(int error_value) const override;
+};
+
+/**
+ * @brief Get the singleton instance of ChannelErrorCategory
+ */
+const std::error_category& get_channel_error_category() noexcept;
+
+/**
+ * @brief Helper function to create std::error_code from ChannelError
+ */
+inline std::error_code make_error_code(ChannelError err) noexcept {
+  return {static_cast<int>(err), get_channel_error_category()};
+}
+
+/**
+ * @brief Queue depth and back-pressure counters of one channel
+ * @details Waits and blocked times count blocking Send*()/Receive*() calls
+ *          that found the channel full/empty; Select waits are not included.
+ */
+struct ChannelStats {
+  std::size_t size = 0;
+  std::size_t capacity = 0;
+  /// Highest size since construction
+  std::size_t max_size = 0;
+  std::uint64_t sent = 0;
+  std::uint64_t received = 0;
+  /// TrySend() calls that found the channel full
+  std::uint64_t rejected = 0;
+  std::uint64_t send_waits = 0;
+  std::uint64_t receive_waits = 0;
+  std::chrono::nanoseconds send_blocked_time{0};
+  std::chrono::nanoseconds receive_blocked_time{0};
+};
+
+class Select;
+
+namespace detail {
+
+template <typename T>
+class SelectReceive;
+template <typename T>
+class SelectSend;
+
+/**
+ * @brief now + timeout on the steady clock, saturating at time_point::max()
+ */
+template <typename Rep, typename Period>
+std::chrono::steady_clock::time_point DeadlineAfter(std::chrono::duration<Rep, Period> timeout) {
+  using Clock = std::chrono::steady_clock;
+  using Seconds = std::chrono::duration<double>;
+  const auto now = Clock::now();
+  if (Seconds(timeout) >= Seconds(Clock::time_point::max() - now)) {
+    return Clock::time_point::max();
+  }
+  return now + std::chrono::ceil<Clock::duration>(timeout);
+}
+
+/**
+ * @brief Wake-up flag of one waiting Select, registered with its channels
+ */
+struct SelectWaiter {
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool signaled = false;
+
+  void Signal() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      signaled = true;
+    }
+    cv.notify_one();
+  }
+};
+
+}  // namespace detail
+
+/**
+ * @class ChannelBase
+ * @brief Type-independent state of a channel: lock, waiters, close flag, stats
+ */
+class ChannelBase {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  ChannelBase(const ChannelBase&) = delete;
+  ChannelBase& operator=(const ChannelBase&) = delete;
+
+  /**
+   * @brief Reject further sends, wake all waiters; elements stay receivable
+   */
+  void Close();
+
+  bool IsClosed() const;
+  std::size_t Size() const;
+  std::size_t Capacity() const noexcept { return m_capacity; }
+
+  ChannelStats GetStats() const;
+
+ protected:
+  explicit ChannelBase(std::size_t capacity) : m_capacity(capacity < 1 ? 1 : capacity) {}
+  ~ChannelBase() = default;
+
+  /// An element was added (lock held)
+  void OnSent();
+  /// An element was removed (lock held)
+  void OnReceived();
+  /// TrySend() found no room (lock held)
+  void OnRejected() { ++m_stats.rejected; }
+
+  /**
+   * @brief Wait on cv until ready() or deadline (lock held)
+   * @return False on timeout
+   */
+  template <typename Ready>
+  bool WaitUntil(std::unique_lock<std::mutex>& lock, std::condition_variable& cv, bool sending,
+                 Clock::time_point deadline, Ready ready);
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_not_empty;
+  std::condition_variable m_not_full;
+  const std::size_t m_capacity;
+  std::size_t m_size{0};
+  bool m_closed{false};
+
+ private:
+  friend class Select;
+
+  void AddSelectWaiter(detail::SelectWaiter* waiter);
+  void RemoveSelectWaiter(detail::SelectWaiter* waiter);
+
+  int m_waiting_senders{0};
+  int m_waiting_receivers{0};
+  std::vector<detail::SelectWaiter*> m_select_waiters;
+  ChannelStats m_stats;
+};
+
+/**
+ * @class Channel
+ * @brief Bounded multi-producer, multi-consumer FIFO channel
+ * @tparam T Element type; receives move-assign into the caller's object
+ * @note Thread-safe. A send that fails leaves the caller's value untouched.
+ */
+template <typename T>
+class Channel : public ChannelBase {
+ public:
+  /**
+   * @param capacity Elements buffered before senders block (at least 1)
+   */
+  explicit Channel(std::size_t capacity)
+      : ChannelBase(capacity), m_slots(std::make_unique<std::optional<T>[]>(m_capacity)) {}
+
+  /**
+   * @brief Send, waiting for room
+   * @return Empty error_code, or ChannelError::Closed
+   */
+  template <typename U>
+    requires std::is_constructible_v<T, U&&>
+  std::error_code Send(U&& value) {
+    return SendUntil(std::forward<U>(value), Clock::time_point::max());
+  }
+
+  /**
+   * @return Empty error_code, ChannelError::Full or ChannelError::Closed
+   */
+  template <typename U>
+    requires std::is_constructible_v<T, U&&>
+  std::error_code TrySend(U&& value) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_closed) {
+      return make_error_code(ChannelError::Closed);
+    }
+    if (!PushLocked(std::forward<U>(value))) {
+      OnRejected();
+      return make_error_code(ChannelError::Full);
+    }
+    return {};
+  }
+
+  /**
+   * @return Empty error_code, ChannelError::Timeout or ChannelError::Closed
+   */
+  template <typename U, typename Rep, typename Period>
+    requires std::is_constructible_v<T, U&&>
+  std::error_code SendFor(U&& value, std::chrono::duration<Rep, Period> timeout) {
+    return SendUntil(std::forward<U>(value), detail::DeadlineAfter(timeout));
+  }
+
+  template <typename U>
+    requires std::is_constructible_v<T, U&&>
+  std::error_code SendUntil(U&& value, Clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!WaitUntil(lock, m_not_full, true, deadline,
+                   [this] { return m_closed || m_size < m_capacity; })) {
+      return make_error_code(ChannelError::Timeout);
+    }
+    if (m_closed) {
+      return make_error_code(ChannelError::Closed);
+    }
+    PushLocked(std::forward<U>(value));
+    return {};
+  }
+
+  /**
+   * @brief Receive, waiting for an element
+   * @return Empty error_code, or ChannelError::Closed once closed and drained
+   */
+  std::error_code Receive(T& out) { return ReceiveUntil(out, Clock::time_point::max()); }
+
+  /**
+   * @return Empty error_code, ChannelError::Empty or ChannelError::Closed
+   */
+  std::error_code TryReceive(T& out) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (PopLocked(out)) {
+      return {};
+    }
+    return make_error_code(m_closed ? ChannelError::Closed : ChannelError::Empty);
+  }
+
+  /**
+   * @return Empty error_code, ChannelError::Timeout or ChannelError::Closed
+   */
+  template <typename Rep, typename Period>
+  std::error_code ReceiveFor(T& out, std::chrono::duration<Rep, Period> timeout) {
+    return ReceiveUntil(out, detail::DeadlineAfter(timeout));
+  }
+
+  std::error_code ReceiveUntil(T& out, Clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!WaitUntil(lock, m_not_empty, false, deadline,
+                   [this] { return m_closed || m_size > 0; })) {
+      return make_error_code(ChannelError::Timeout);
+    }
+    return PopLocked(out) ? std::error_code{} : make_error_code(ChannelError::Closed);
+  }
+
+ private:
+  friend class detail::SelectReceive<T>;
+  friend class detail::SelectSend<T>;
+
+
+  template <typename U>
+  bool PushLocked(U&& value) {
+    if (m_size == m_capacity) {
+      return false;
+    }
+    std::size_t tail = m_head + m_size;
+    if (tail >= m_capacity) {
+      tail -= m_capacity;
+    }
+    m_slots[tail].emplace(std::forward<U>(value));
+    ++m_size;
+    OnSent();
+    return true;
+  }
+
+  bool PopLocked(T& out) {
+    if (m_size == 0) {
+      return false;
+    }
+    out = std::move(*m_slots[m_head]);
+    m_slots[m_head].reset();
+    if (++m_head == m_capacity) {
+      m_head = 0;
+    }
+    --m_size;
+    OnReceived();
+    return true;
+  }
+
+  std::unique_ptr<std::optional<T>[]> m_slots;
+  std::size_t m_head{0};
+};
+
+template <typename Ready>
+bool ChannelBase::WaitUntil(std::unique_lock<std::mutex>& lock, std::condition_variable& cv,
+                            bool sending, Clock::time_point deadline, Ready ready) {
+  if (ready()) {
+    return true;
+  }
+  int& waiting = sending ? m_waiting_senders : m_waiting_receivers;
+  const auto start = Clock::now();
+  ++waiting;
+  bool satisfied = true;
+  if (deadline == Clock::time_point::max()) {
+    cv.wait(lock, ready);
+  } else {
+    satisfied = cv.wait_until(lock, deadline, ready);
+  }
+  --waiting;
+  const auto blocked = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+  if (sending) {
+    ++m_stats.send_waits;
+    m_stats.send_blocked_time += blocked;
+  } else {
+    ++m_stats.receive_waits;
+    m_stats.receive_blocked_time += blocked;
+  }
+  return satisfied;
+}
+
+}  // namespace comm
+
+namespace std {
+template <>
+struct is_error_code_enum<comm::ChannelError> : true_type {};
+}  // namespace std
@@ -0,0 +1,184 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_select.h
+ * @brief Wait for the first of several channel operations
+ * @details A Select is a list of cases: receive from a channel, or send a
+ *          value to one. Wait() performs exactly one ready case and runs its
+ *          handler; cases are tried in rotating order so that one busy
+ *          channel does not starve the others. Cases on closed channels drop
+ *          out, and once all have, Wait() returns ChannelError::Closed.
+ *
+ * @code
+ * comm::Select select;
+ * select.Receive(requests, [&](Request request) { Handle(std::move(request)); })
+ *       .Receive(control, [&](Command command) { Apply(command); });
+ * while (!select.Wait()) {
+ * }                                        // all inputs closed and drained
+ * @endcode
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "comm_channel.h"
+
+namespace comm {
+
+namespace detail {
+
+/**
+ * @brief One case of a Select
+ */
+class SelectCase {
+ public:
+  enum class State {
+    Fired,     ///< Performed, the case stays
+    Done,      ///< Performed, the case drops out
+    NotReady,  ///< Channel full (send) or empty (receive)
+    Closed,    ///< Channel closed (and drained, for receives)
+  };
+
+  virtual ~SelectCase() = default;
+
+  virtual ChannelBase& Target() = 0;
+
+  /// Perform the operation if possible, run the handler after unlocking
+  virtual State TryFire() = 0;
+};
+
+template <typename T>
+class SelectReceive final : public SelectCase {
+ public:
+  SelectReceive(Channel<T>& channel, std::function<void(T)> handler)
+      : m_channel(channel), m_handler(std::move(handler)) {}
+
+  ChannelBase& Target() override { return m_channel; }
+
+  State TryFire() override {
+    T value{};
+    {
+      std::lock_guard<std::mutex> lock(m_channel.m_mutex);
+      if (!m_channel.PopLocked(value)) {
+        return m_channel.m_closed ? State::Closed : State::NotReady;
+      }
+    }
+    m_handler(std::move(value));
+    return State::Fired;
+  }
+
+ private:
+  Channel<T>& m_channel;
+  std::function<void(T)> m_handler;
+};
+
+template <typename T>
+class SelectSend final : public SelectCase {
+ public:
+  SelectSend(Channel<T>& channel, T value, std::function<void()> handler)
+      : m_channel(channel), m_value(std::move(value)), m_handler(std::move(handler)) {}
+
+  ChannelBase& Target() override { return m_channel; }
+
+  State TryFire() override {
+    {
+      std::lock_guard<std::mutex> lock(m_channel.m_mutex);
+      if (m_channel.m_closed) {
+        return State::Closed;
+      }
+      if (!m_channel.PushLocked(std::move(*m_value))) {
+        return State::NotReady;
+      }
+    }
+    m_value.reset();
+    if (m_handler) {
+      m_handler();
+    }
+    return State::Done;
+  }
+
+ private:
+  Channel<T>& m_channel;
+  std::optional<T> m_value;
+  std::function<void()> m_handler;
+};
+
+}  // namespace detail
+
+/**
+ * @class Select
+ * @brief Set of channel operations of which Wait() performs the first ready
+ * @note One Select is used by one thread at a time; the channels may be
+ *       shared with any number of other threads and Selects.
+ */
+class Select {
+ public:
+  using Clock = ChannelBase::Clock;
+
+  Select() = default;
+  Select(const Select&) = delete;
+  Select& operator=(const Select&) = delete;
+
+  /**
+   * @brief Case receiving one element and passing it to handler
+   */
+  template <typename T>
+  Select& Receive(Channel<T>& channel, std::function<void(std::type_identity_t<T>)> handler) {
+    m_cases.push_back(std::make_unique<detail::SelectReceive<T>>(channel, std::move(handler)));
+    return *this;
+  }
+
+  /**
+   * @brief Case sending value, then calling handler (if any)
+   * @note Fires at most once: after its value is sent the case drops out
+   */
+  template <typename T>
+  Select& Send(Channel<T>& channel, std::type_identity_t<T> value,
+               std::function<void()> handler = {}) {
+    m_cases.push_back(
+        std::make_unique<detail::SelectSend<T>>(channel, std::move(value), std::move(handler)));
+    return *this;
+  }
+
+  /**
+   * @brief Perform one ready case, waiting until one is
+   * @return Empty error_code, or ChannelError::Closed when no case is left
+   */
+  std::error_code Wait() { return WaitUntil(Clock::time_point::max()); }
+
+  /**
+   * @brief Perform one case if one is ready now
+   * @return Empty error_code, ChannelError::Empty or ChannelError::Closed
+   */
+  std::error_code Try();
+
+  /**
+   * @return Empty error_code, ChannelError::Timeout or ChannelError::Closed
+   */
+  template <typename Rep, typename Period>
+  std::error_code WaitFor(std::chrono::duration<Rep, Period> timeout) {
+    return WaitUntil(detail::DeadlineAfter(timeout));
+  }
+
+  std::error_code WaitUntil(Clock::time_point deadline);
+
+ private:
+  /// Try each remaining case once, starting after the last one tried
+  detail::SelectCase::State TryAll();
+
+  /// Cases still in play (not on a closed channel, send not yet done)
+  std::vector<std::unique_ptr<detail::SelectCase>> m_cases;
+  std::size_t m_next{0};
+};
+
+}  // namespace comm
@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_channel.cpp
+ * @brief Channel wake-ups, statistics and the Select wait loop
+ */
+
+#include "comm_channel.h"
+
+#include <algorithm>
+
+#include "comm_select.h"
+
+namespace comm {
+
+// Error category implementation
+std::string ChannelErrorCategory::message(int error_value) const {
+  switch (static_cast<ChannelError>(error_value)) {
+    case ChannelError::Success:
+      return "Success";
+    case ChannelError::Closed:
+      return "Channel is closed";
+    case ChannelError::Full:
+      return "Channel is full";
+    case ChannelError::Empty:
+      return "Channel is empty";
+    case ChannelError::Timeout:
+      return "Channel operation timed out";
+    default:
+      return "Unknown channel error";
+  }
+}
+
+const std::error_category& get_channel_error_category() noexcept {
+  static ChannelErrorCategory instance;
+  return instance;
+}
+
+void ChannelBase::Close() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_closed) {
+    return;
+  }
+  m_closed = true;
+  m_not_empty.notify_all();
+  m_not_full.notify_all();
+  for (detail::SelectWaiter* waiter : m_select_waiters) {
+    waiter->Signal();
+  }
+}
+
+bool ChannelBase::IsClosed() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_closed;
+}
+
+std::size_t ChannelBase::Size() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_size;
+}
+
+ChannelStats ChannelBase::GetStats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  ChannelStats stats = m_stats;
+  stats.size = m_size;
+  stats.capacity = m_capacity;
+  return stats;
+}
+
+void ChannelBase::OnSent() {
+  ++m_stats.sent;
+  m_stats.max_size = std::max(m_stats.max_size, m_size);
+  if (m_waiting_receivers > 0) {
+    m_not_empty.notify_one();
+  }
+  for (detail::SelectWaiter* waiter : m_select_waiters) {
+    waiter->Signal();
+  }
+}
+
+void ChannelBase::OnReceived() {
+  ++m_stats.received;
+  if (m_waiting_senders > 0) {
+    m_not_full.notify_one();
+  }
+  for (detail::SelectWaiter* waiter : m_select_waiters) {
+    waiter->Signal();
+  }
+}
+
+void ChannelBase::AddSelectWaiter(detail::SelectWaiter* waiter) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_select_waiters.push_back(waiter);
+}
+
+void ChannelBase::RemoveSelectWaiter(detail::SelectWaiter* waiter) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const auto found = std::find(m_select_waiters.begin(), m_select_waiters.end(), waiter);
+  if (found != m_select_waiters.end()) {
+    m_select_waiters.erase(found);
+  }
+}
+
+detail::SelectCase::State Select::TryAll() {
+  using State = detail::SelectCase::State;
+  std::size_t tried = 0;
+  while (tried < m_cases.size()) {
+    if (m_next >= m_cases.size()) {
+      m_next = 0;
+    }
+    switch (m_cases[m_next]->TryFire()) {
+      case State::NotReady:
+        ++m_next;
+        ++tried;
+        break;
+      case State::Closed:
+        m_cases.erase(m_cases.begin() + static_cast<std::ptrdiff_t>(m_next));
+        break;
+      case State::Fired:
+        ++m_next;
+        return State::Fired;
+      case State::Done:
+        m_cases.erase(m_cases.begin() + static_cast<std::ptrdiff_t>(m_next));
+        return State::Fired;
+    }
+  }
+  return m_cases.empty() ? State::Closed : State::NotReady;
+}
+
+std::error_code Select::Try() {
+  switch (TryAll()) {
+    case detail::SelectCase::State::Fired:
+      return {};
+    case detail::SelectCase::State::NotReady:
+      return make_error_code(ChannelError::Empty);
+    default:
+      return make_error_code(ChannelError::Closed);
+  }
+}
+
+std::error_code Select::WaitUntil(Clock::time_point deadline) {
+  using State = detail::SelectCase::State;
+  State state = TryAll();
+  if (state != State::NotReady) {
+    return state == State::Fired ? std::error_code{} : make_error_code(ChannelError::Closed);
+  }
+
+  // Register before trying again: a change after a failed try signals us
+  detail::SelectWaiter waiter;
+  struct Registration {
+    std::vector<ChannelBase*> channels;
+    detail::SelectWaiter* waiter;
+    ~Registration() {
+      for (ChannelBase* channel : channels) {
+        channel->RemoveSelectWaiter(waiter);
+      }
+    }
+  } registration{{}, &waiter};
+  for (const auto& select_case : m_cases) {
+    ChannelBase& channel = select_case->Target();
+    channel.AddSelectWaiter(&waiter);
+    registration.channels.push_back(&channel);
+  }
+
+  while ((state = TryAll()) == State::NotReady) {
+    std::unique_lock<std::mutex> lock(waiter.mutex);
+    const auto signaled = [&waiter] { return waiter.signaled; };
+    if (deadline == Clock::time_point::max()) {
+      waiter.cv.wait(lock, signaled);
+    } else if (!waiter.cv.wait_until(lock, deadline, signaled)) {
+      return make_error_code(ChannelError::Timeout);
+    }
+    waiter.signaled = false;
+  }
+  return state == State::Fired ? std::error_code{} : make_error_code(ChannelError::Closed);
+}
+
+}  // namespace comm
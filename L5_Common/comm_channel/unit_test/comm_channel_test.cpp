@@ -0,0 +1,238 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_channel_test.cpp
+ * @brief Unit tests for Channel and Select
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "comm_channel.h"
+#include "comm_select.h"
+
+namespace comm {
+namespace {
+
+using namespace std::chrono_literals;
+
+TEST(ChannelTest, TryOperationsRespectCapacity) {
+  Channel<int> channel(2);
+  EXPECT_FALSE(channel.TrySend(1));
+  EXPECT_FALSE(channel.TrySend(2));
+  EXPECT_EQ(channel.TrySend(3), ChannelError::Full);
+  EXPECT_EQ(channel.Size(), 2U);
+
+  int value = 0;
+  EXPECT_FALSE(channel.TryReceive(value));
+  EXPECT_EQ(value, 1);
+  EXPECT_FALSE(channel.TryReceive(value));
+  EXPECT_EQ(value, 2);
+  EXPECT_EQ(channel.TryReceive(value), ChannelError::Empty);
+
+  const ChannelStats stats = channel.GetStats();
+  EXPECT_EQ(stats.capacity, 2U);
+  EXPECT_EQ(stats.max_size, 2U);
+  EXPECT_EQ(stats.sent, 2U);
+  EXPECT_EQ(stats.received, 2U);
+  EXPECT_EQ(stats.rejected, 1U);
+}
+
+TEST(ChannelTest, FailedSendKeepsValue) {
+  Channel<std::unique_ptr<int>> channel(1);
+  EXPECT_FALSE(channel.TrySend(std::make_unique<int>(1)));
+  auto value = std::make_unique<int>(2);
+  EXPECT_EQ(channel.TrySend(std::move(value)), ChannelError::Full);
+  ASSERT_NE(value, nullptr);
+  EXPECT_EQ(channel.SendFor(std::move(value), 1ms), ChannelError::Timeout);
+  ASSERT_NE(value, nullptr);
+  EXPECT_EQ(*value, 2);
+}
+
+TEST(ChannelTest, BlockedSenderResumesWhenRoomIsMade) {
+  Channel<int> channel(1);
+  ASSERT_FALSE(channel.Send(1));
+  std::thread producer([&] { EXPECT_FALSE(channel.Send(2)); });
+
+  std::this_thread::sleep_for(20ms);
+  int value = 0;
+  ASSERT_FALSE(channel.Receive(value));
+  EXPECT_EQ(value, 1);
+  ASSERT_FALSE(channel.Receive(value));
+  EXPECT_EQ(value, 2);
+  producer.join();
+
+  const ChannelStats stats = channel.GetStats();
+  EXPECT_EQ(stats.send_waits, 1U);
+  EXPECT_GE(stats.send_blocked_time, 10ms);
+}
+
+TEST(ChannelTest, ReceiveTimesOut) {
+  Channel<int> channel(4);
+  int value = 0;
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(channel.ReceiveFor(value, 20ms), ChannelError::Timeout);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 20ms);
+  EXPECT_EQ(channel.GetStats().receive_waits, 1U);
+
+  // Timeouts too large for the clock wait without limit instead of overflowing
+  ASSERT_FALSE(channel.Send(5));
+  EXPECT_FALSE(channel.ReceiveFor(value, std::chrono::hours::max()));
+  EXPECT_EQ(value, 5);
+}
+
+TEST(ChannelTest, CloseDrainsThenReportsClosed) {
+  Channel<std::string> channel(4);
+  ASSERT_FALSE(channel.Send("left over"));
+  channel.Close();
+  EXPECT_TRUE(channel.IsClosed());
+  EXPECT_EQ(channel.Send("late"), ChannelError::Closed);
+  EXPECT_EQ(channel.TrySend("late"), ChannelError::Closed);
+
+  std::string value;
+  EXPECT_FALSE(channel.Receive(value));
+  EXPECT_EQ(value, "left over");
+  EXPECT_EQ(channel.Receive(value), ChannelError::Closed);
+  EXPECT_EQ(channel.TryReceive(value), ChannelError::Closed);
+}
+
+TEST(ChannelTest, CloseWakesBlockedReceivers) {
+  Channel<int> channel(1);
+  std::vector<std::thread> receivers;
+  for (int index = 0; index < 3; ++index) {
+    receivers.emplace_back([&] {
+      int value = 0;
+      EXPECT_EQ(channel.Receive(value), ChannelError::Closed);
+    });
+  }
+  std::this_thread::sleep_for(10ms);
+  channel.Close();
+  for (auto& receiver : receivers) {
+    receiver.join();
+  }
+}
+
+TEST(ChannelTest, ManyProducersAndConsumersDeliverEverything) {
+  constexpr int kProducers = 4;
+  constexpr int kPerProducer = 10000;
+  Channel<int> channel(16);
+  std::atomic<long long> sum{0};
+  std::atomic<int> count{0};
+
+  std::vector<std::thread> consumers;
+  for (int index = 0; index < 3; ++index) {
+    consumers.emplace_back([&] {
+      int value = 0;
+      while (!channel.Receive(value)) {
+        sum.fetch_add(value, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+      }
+    });
+  }
+  std::vector<std::thread> producers;
+  for (int producer = 0; producer < kProducers; ++producer) {
+    producers.emplace_back([&] {
+      for (int value = 1; value <= kPerProducer; ++value) {
+        ASSERT_FALSE(channel.Send(value));
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  channel.Close();
+  for (auto& consumer : consumers) {
+    consumer.join();
+  }
+  EXPECT_EQ(count.load(), kProducers * kPerProducer);
+  EXPECT_EQ(sum.load(), static_cast<long long>(kProducers) * kPerProducer * (kPerProducer + 1) / 2);
+  EXPECT_LE(channel.GetStats().max_size, 16U);
+}
+
+TEST(SelectTest, ReceivesFromWhicheverChannelIsReady) {
+  Channel<int> numbers(4);
+  Channel<std::string> words(4);
+  std::vector<std::string> seen;
+  Select select;
+  select.Receive(numbers, [&](int value) { seen.push_back(std::to_string(value)); })
+      .Receive(words, [&](std::string value) { seen.push_back(value); });
+
+  EXPECT_EQ(select.Try(), ChannelError::Empty);
+  ASSERT_FALSE(words.Send("hello"));
+  ASSERT_FALSE(select.Wait());
+  ASSERT_EQ(seen.size(), 1U);
+  EXPECT_EQ(seen[0], "hello");
+
+  std::thread producer([&] {
+    std::this_thread::sleep_for(10ms);
+    EXPECT_FALSE(numbers.Send(42));
+  });
+  ASSERT_FALSE(select.Wait());
+  producer.join();
+  EXPECT_EQ(seen.back(), "42");
+}
+
+TEST(SelectTest, RotatesBetweenReadyChannels) {
+  Channel<int> first(8);
+  Channel<int> second(8);
+  for (int index = 0; index < 4; ++index) {
+    ASSERT_FALSE(first.Send(1));
+    ASSERT_FALSE(second.Send(2));
+  }
+  std::vector<int> order;
+  Select select;
+  select.Receive(first, [&](int value) { order.push_back(value); })
+      .Receive(second, [&](int value) { order.push_back(value); });
+  for (int index = 0; index < 4; ++index) {
+    ASSERT_FALSE(select.Try());
+  }
+  EXPECT_EQ(order, (std::vector<int>{1, 2, 1, 2}));
+}
+
+TEST(SelectTest, SendCaseFiresOnce) {
+  Channel<int> channel(1);
+  ASSERT_FALSE(channel.Send(0));
+  bool sent = false;
+  Select select;
+  select.Send(channel, 7, [&] { sent = true; });
+  EXPECT_EQ(select.WaitFor(10ms), ChannelError::Timeout);
+
+  int value = 0;
+  ASSERT_FALSE(channel.Receive(value));
+  ASSERT_FALSE(select.Wait());
+  EXPECT_TRUE(sent);
+  ASSERT_FALSE(channel.Receive(value));
+  EXPECT_EQ(value, 7);
+  EXPECT_EQ(select.Try(), ChannelError::Closed);  // no case left
+}
+
+TEST(SelectTest, ReturnsClosedWhenAllInputsAreClosedAndDrained) {
+  Channel<int> first(4);
+  Channel<int> second(4);
+  int total = 0;
+  Select select;
+  select.Receive(first, [&](int value) { total += value; })
+      .Receive(second, [&](int value) { total += value; });
+
+  std::thread producer([&] {
+    EXPECT_FALSE(first.Send(1));
+    first.Close();
+    EXPECT_FALSE(second.Send(2));
+    std::this_thread::sleep_for(10ms);
+    second.Close();
+  });
+  while (!select.Wait()) {
+  }
+  producer.join();
+  EXPECT_EQ(total, 3);
+}
+
+}  // namespace
+}  // namespace comm
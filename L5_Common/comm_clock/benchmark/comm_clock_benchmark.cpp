@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_clock_benchmark.cpp
+ * @brief FastClock against the std::chrono and clock_gettime() clocks
+ *
+ * Usage: modu-core-comm_clock_benchmark [--benchmark_filter=...]
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <ctime>
+
+#include "comm_clock.h"
+
+namespace {
+
+void BM_FastClockNow(benchmark::State& state) {
+  comm::FastClock::Calibrate();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(comm::FastClock::now());
+  }
+  state.SetLabel(comm::FastClock::GetStatus().counter_enabled
+                     ? "counter"
+                     : comm::FastClock::GetStatus().fallback_reason);
+}
+BENCHMARK(BM_FastClockNow)->ThreadRange(1, 8);
+
+void BM_SteadyClockNow(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(std::chrono::steady_clock::now());
+  }
+}
+BENCHMARK(BM_SteadyClockNow)->ThreadRange(1, 8);
+
+void BM_FastClockRealtime(benchmark::State& state) {
+  comm::FastClock::Calibrate();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(comm::FastClock::RealtimeNs());
+  }
+}
+BENCHMARK(BM_FastClockRealtime);
+
+void BM_SystemClockNow(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(std::chrono::system_clock::now());
+  }
+}
+BENCHMARK(BM_SystemClockNow);
+
+void BM_ClockGettimeMonotonicCoarse(benchmark::State& state) {
+  timespec now{};
+  for (auto _ : state) {
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+    benchmark::DoNotOptimize(now);
+  }
+}
+BENCHMARK(BM_ClockGettimeMonotonicCoarse);
+
+/// Measure an interval the way latency metrics do: two reads per sample
+template <typename Clock>
+void BM_MeasureInterval(benchmark::State& state) {
+  for (auto _ : state) {
+    const auto start = Clock::now();
+    benchmark::ClobberMemory();
+    benchmark::DoNotOptimize(Clock::now() - start);
+  }
+}
+BENCHMARK_TEMPLATE(BM_MeasureInterval, comm::FastClock);
+BENCHMARK_TEMPLATE(BM_MeasureInterval, std::chrono::steady_clock);
+
+}  // namespace
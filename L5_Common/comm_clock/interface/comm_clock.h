@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_clock.h
+ * @brief Calibrated CPU counter clock for timestamps on hot paths
+ * @details FastClock reads the invariant TSC (x86-64) or the generic timer
+ *          (aarch64) and scales it to nanoseconds of CLOCK_MONOTONIC. It is
+ *          calibrated on first use, re-checked against CLOCK_MONOTONIC with
+ *          growing intervals (up to once per second) and slewed to stay in
+ *          step. When the counter is missing, not invariant, not trusted by
+ *          the kernel or drifts, FastClock permanently falls back to
+ *          clock_gettime().
+ *
+ * @code
+ * const auto start = comm::FastClock::now();
+ * DoWork();
+ * const auto elapsed = comm::FastClock::now() - start;  // std::chrono duration
+ * @endcode
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+namespace comm {
+
+/**
+ * @brief Calibration state reported by FastClock::GetStatus()
+ */
+struct FastClockStatus {
+  bool counter_enabled{false};    ///< False when using clock_gettime()
+  double counter_hz{0};           ///< Calibrated counter frequency
+  std::uint64_t recalibrations{0};  ///< Re-checks against CLOCK_MONOTONIC
+  const char* fallback_reason{""};  ///< Why the counter is not used
+};
+
+namespace detail {
+
+/**
+ * @brief Scaling parameters, published with a sequence lock
+ * @details ns = base_ns + ((ticks - base_ticks) * mult) >> 32
+ */
+struct FastClockParams {
+  std::atomic<std::uint32_t> sequence{0};
+  std::atomic<bool> enabled{false};
+  std::atomic<std::uint64_t> base_ticks{0};
+  std::atomic<std::int64_t> base_ns{0};
+  std::atomic<std::uint64_t> mult{0};
+  std::atomic<std::uint64_t> recheck_ticks{0};
+  std::atomic<std::int64_t> realtime_offset_ns{0};
+};
+
+extern FastClockParams g_fast_clock;
+
+/// Counter disabled or not calibrated yet: calibrate once, else clock_gettime
+std::int64_t FastClockSlowPath() noexcept;
+
+/// Re-check interval elapsed: recalibrate (one thread) and return the time
+std::int64_t FastClockRecheck(std::uint64_t ticks) noexcept;
+
+inline std::uint64_t ReadClockTicks() noexcept {
+#if defined(__x86_64__)
+  return __rdtsc();
+#elif defined(__aarch64__)
+  std::uint64_t ticks;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+  return ticks;
+#else
+  return 0;
+#endif
+}
+
+}  // namespace detail
+
+/**
+ * @class FastClock
+ * @brief std::chrono clock with the epoch and rate of CLOCK_MONOTONIC
+ * @note Like steady_clock readings, values from different threads are only
+ *       ordered when the threads synchronize
+ */
+class FastClock {
+ public:
+  using rep = std::int64_t;
+  using period = std::nano;
+  using duration = std::chrono::nanoseconds;
+  using time_point = std::chrono::time_point<FastClock>;
+  static constexpr bool is_steady = true;
+
+  static time_point now() noexcept { return time_point(duration(NowNs())); }
+
+  /**
+   * @brief Nanoseconds on the CLOCK_MONOTONIC time line
+   */
+  static std::int64_t NowNs() noexcept {
+    auto& params = detail::g_fast_clock;
+    while (true) {
+      const std::uint32_t sequence =
+          params.sequence.load(std::memory_order_acquire);
+      if (!params.enabled.load(std::memory_order_relaxed)) {
+        return detail::FastClockSlowPath();
+      }
+      const std::uint64_t ticks = detail::ReadClockTicks();
+      const std::uint64_t base_ticks =
+          params.base_ticks.load(std::memory_order_relaxed);
+      const std::int64_t base_ns = params.base_ns.load(std::memory_order_relaxed);
+      const std::uint64_t mult = params.mult.load(std::memory_order_relaxed);
+      const std::uint64_t recheck =
+          params.recheck_ticks.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if ((sequence & 1) != 0 ||
+          params.sequence.load(std::memory_order_relaxed) != sequence) {
+        continue;
+      }
+      // Also catches ticks slightly behind base_ticks (wraps to a huge delta)
+      const std::uint64_t delta = ticks - base_ticks;
+      if (delta >= recheck) {
+        return detail::FastClockRecheck(ticks);
+      }
+      return base_ns + static_cast<std::int64_t>(
+                           (static_cast<unsigned __int128>(delta) * mult) >> 32);
+    }
+  }
+
+  /**
+   * @brief Wall clock in nanoseconds since the epoch (CLOCK_REALTIME)
+   * @note Follows clock steps at the next re-check (within a second)
+   */
+  static std::int64_t RealtimeNs() noexcept {
+    if (!detail::g_fast_clock.enabled.load(std::memory_order_relaxed)) {
+      timespec now{};
+      clock_gettime(CLOCK_REALTIME, &now);
+      return static_cast<std::int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+    }
+    return NowNs() +
+           detail::g_fast_clock.realtime_offset_ns.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Calibrate now instead of on first use (e.g. during startup)
+   * @return True when the counter is used
+   */
+  static bool Calibrate();
+
+  /**
+   * @brief Stop using the counter (e.g. for comparison or diagnostics)
+   */
+  static void Disable(const char* reason);
+
+  static FastClockStatus GetStatus();
+};
+
+}  // namespace comm
@@ -0,0 +1,291 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_clock.cpp
+ * @brief FastClock calibration, re-checks and fallback
+ */
+
+#include "comm_clock.h"
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+namespace comm {
+
+namespace detail {
+
+FastClockParams g_fast_clock;
+
+}  // namespace detail
+
+namespace {
+
+/// Initial calibration window (busy wait, once per process)
+constexpr std::int64_t kCalibrationNs = 2'000'000;
+
+/// Re-check intervals: doubled after every check up to the maximum
+constexpr std::int64_t kFirstRecheckNs = 50'000'000;
+constexpr std::int64_t kMaxRecheckNs = 1'000'000'000;
+
+/// Deviations treating the counter as unreliable
+constexpr std::int64_t kMaxErrorNs = 1'000'000;
+constexpr double kMaxRateChange = 500e-6;
+
+std::int64_t ReadClockNs(clockid_t clock) {
+  timespec now{};
+  clock_gettime(clock, &now);
+  return static_cast<std::int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+/**
+ * @brief Calibration state, only touched under mutex
+ */
+struct Calibration {
+  std::mutex mutex;
+  std::once_flag once;
+  bool disabled{false};
+  const char* fallback_reason{"not calibrated"};
+  std::uint64_t anchor_ticks{0};
+  std::int64_t anchor_ns{0};
+  double ns_per_tick{0};
+  std::int64_t recheck_interval_ns{kFirstRecheckNs};
+  std::uint64_t recalibrations{0};
+};
+
+Calibration& GetCalibration() {
+  static Calibration calibration;
+  return calibration;
+}
+
+/**
+ * @brief Counter and CLOCK_MONOTONIC read as close together as possible
+ */
+void Sample(std::uint64_t& ticks, std::int64_t& ns) {
+  std::uint64_t best_window = ~std::uint64_t{0};
+  for (int attempt = 0; attempt < 5; ++attempt) {
+    const std::uint64_t before = detail::ReadClockTicks();
+    const std::int64_t now = ReadClockNs(CLOCK_MONOTONIC);
+    const std::uint64_t after = detail::ReadClockTicks();
+    if (after - before < best_window) {
+      best_window = after - before;
+      ticks = before + (after - before) / 2;
+      ns = now;
+    }
+  }
+}
+
+/**
+ * @brief Reason the counter cannot be used on this machine, nullptr if usable
+ */
+const char* CheckCounterSupport() {
+#if defined(__x86_64__)
+  unsigned eax = 0;
+  unsigned ebx = 0;
+  unsigned ecx = 0;
+  unsigned edx = 0;
+  if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0 ||
+      (edx & (1U << 8)) == 0) {
+    return "CPU has no invariant TSC";
+  }
+  // The kernel drops "tsc" from the list when it found the TSC unstable
+  std::ifstream sources(
+      "/sys/devices/system/clocksource/clocksource0/available_clocksource");
+  std::string source;
+  bool listed = !sources;
+  while (sources >> source) {
+    listed = listed || source == "tsc";
+  }
+  return listed ? nullptr : "kernel marked the TSC unstable";
+#elif defined(__aarch64__)
+  return nullptr;
+#else
+  return "no supported cycle counter";
+#endif
+}
+
+/**
+ * @brief Publish new scaling parameters (caller holds the calibration mutex)
+ */
+void Publish(bool enabled, std::uint64_t base_ticks, std::int64_t base_ns,
+             double ns_per_tick, std::int64_t recheck_ns) {
+  auto& params = detail::g_fast_clock;
+  const std::uint32_t sequence = params.sequence.load(std::memory_order_relaxed);
+  params.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  params.base_ticks.store(base_ticks, std::memory_order_relaxed);
+  params.base_ns.store(base_ns, std::memory_order_relaxed);
+  params.mult.store(static_cast<std::uint64_t>(std::ldexp(ns_per_tick, 32)),
+                    std::memory_order_relaxed);
+  params.recheck_ticks.store(
+      static_cast<std::uint64_t>(static_cast<double>(recheck_ns) / ns_per_tick),
+      std::memory_order_relaxed);
+  params.realtime_offset_ns.store(
+      ReadClockNs(CLOCK_REALTIME) - ReadClockNs(CLOCK_MONOTONIC),
+      std::memory_order_relaxed);
+  params.enabled.store(enabled, std::memory_order_relaxed);
+
+  params.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void DisableLocked(Calibration& calibration, const char* reason) {
+  calibration.disabled = true;
+  calibration.fallback_reason = reason;
+  auto& params = detail::g_fast_clock;
+  const std::uint32_t sequence = params.sequence.load(std::memory_order_relaxed);
+  params.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  params.enabled.store(false, std::memory_order_relaxed);
+  params.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+/**
+ * @brief Value of the counter reading under the published parameters
+ */
+std::int64_t ValueAt(std::uint64_t ticks) {
+  auto& params = detail::g_fast_clock;
+  const std::uint64_t base_ticks = params.base_ticks.load(std::memory_order_relaxed);
+  const std::int64_t base_ns = params.base_ns.load(std::memory_order_relaxed);
+  if (ticks <= base_ticks) {
+    return base_ns;
+  }
+  const std::uint64_t mult = params.mult.load(std::memory_order_relaxed);
+  return base_ns + static_cast<std::int64_t>(
+                       (static_cast<unsigned __int128>(ticks - base_ticks) * mult) >>
+                       32);
+}
+
+void CalibrateOnce() {
+  auto& calibration = GetCalibration();
+  std::lock_guard<std::mutex> lock(calibration.mutex);
+  if (calibration.disabled) {
+    return;
+  }
+  if (const char* reason = CheckCounterSupport(); reason != nullptr) {
+    DisableLocked(calibration, reason);
+    return;
+  }
+
+  std::uint64_t start_ticks = 0;
+  std::int64_t start_ns = 0;
+  Sample(start_ticks, start_ns);
+  while (ReadClockNs(CLOCK_MONOTONIC) - start_ns < kCalibrationNs) {
+  }
+  std::uint64_t end_ticks = 0;
+  std::int64_t end_ns = 0;
+  Sample(end_ticks, end_ns);
+
+  const double ns_per_tick = end_ticks > start_ticks
+                                 ? static_cast<double>(end_ns - start_ns) /
+                                       static_cast<double>(end_ticks - start_ticks)
+                                 : 0;
+  // Plausible counters run between 1 MHz and 100 GHz
+  if (!(ns_per_tick > 0.01 && ns_per_tick < 1000)) {
+    DisableLocked(calibration, "implausible counter frequency");
+    return;
+  }
+
+  calibration.anchor_ticks = start_ticks;
+  calibration.anchor_ns = start_ns;
+  calibration.ns_per_tick = ns_per_tick;
+  calibration.fallback_reason = "";
+  Publish(true, end_ticks, end_ns, ns_per_tick, calibration.recheck_interval_ns);
+}
+
+}  // namespace
+
+namespace detail {
+
+std::int64_t FastClockSlowPath() noexcept {
+  auto& calibration = GetCalibration();
+  std::call_once(calibration.once, CalibrateOnce);
+  if (g_fast_clock.enabled.load(std::memory_order_relaxed)) {
+    return FastClock::NowNs();
+  }
+  return ReadClockNs(CLOCK_MONOTONIC);
+}
+
+std::int64_t FastClockRecheck(std::uint64_t ticks) noexcept {
+  // A counter read slightly behind the base (other CPU) is not a re-check
+  const std::uint64_t base_ticks =
+      g_fast_clock.base_ticks.load(std::memory_order_relaxed);
+  if (ticks < base_ticks && base_ticks - ticks < (std::uint64_t{1} << 32)) {
+    return g_fast_clock.base_ns.load(std::memory_order_relaxed);
+  }
+
+  auto& calibration = GetCalibration();
+  std::unique_lock<std::mutex> lock(calibration.mutex, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    // Another thread is re-checking; the current parameters are still good
+    std::lock_guard<std::mutex> wait(calibration.mutex);
+    return FastClock::NowNs();
+  }
+  if (!g_fast_clock.enabled.load(std::memory_order_relaxed)) {
+    return ReadClockNs(CLOCK_MONOTONIC);
+  }
+
+  std::uint64_t now_ticks = 0;
+  std::int64_t now_ns = 0;
+  Sample(now_ticks, now_ns);
+  const std::int64_t current = ValueAt(now_ticks);
+  const std::int64_t result = ValueAt(ticks);
+  const std::int64_t error = current - now_ns;
+
+  // Rate over the whole lifetime: precise, and any drift shows up here
+  const double rate =
+      static_cast<double>(now_ns - calibration.anchor_ns) /
+      static_cast<double>(now_ticks - calibration.anchor_ticks);
+  const double change = std::fabs(rate / calibration.ns_per_tick - 1);
+  if (now_ticks <= calibration.anchor_ticks || std::llabs(error) > kMaxErrorNs ||
+      change > kMaxRateChange) {
+    DisableLocked(calibration, "counter drifted from CLOCK_MONOTONIC");
+    return now_ns;
+  }
+
+  // Slew so the accumulated error is gone by the next re-check
+  calibration.ns_per_tick = rate;
+  calibration.recheck_interval_ns =
+      std::min(calibration.recheck_interval_ns * 2, kMaxRecheckNs);
+  const auto interval = static_cast<double>(calibration.recheck_interval_ns);
+  const double slewed = rate * (interval - static_cast<double>(error)) / interval;
+  Publish(true, now_ticks, current, slewed, calibration.recheck_interval_ns);
+  ++calibration.recalibrations;
+  return result;
+}
+
+}  // namespace detail
+
+bool FastClock::Calibrate() {
+  std::call_once(GetCalibration().once, CalibrateOnce);
+  return detail::g_fast_clock.enabled.load(std::memory_order_relaxed);
+}
+
+void FastClock::Disable(const char* reason) {
+  auto& calibration = GetCalibration();
+  std::lock_guard<std::mutex> lock(calibration.mutex);
+  DisableLocked(calibration, reason);
+}
+
+FastClockStatus FastClock::GetStatus() {
+  auto& calibration = GetCalibration();
+  std::lock_guard<std::mutex> lock(calibration.mutex);
+  FastClockStatus status;
+  status.counter_enabled =
+      detail::g_fast_clock.enabled.load(std::memory_order_relaxed);
+  status.counter_hz =
+      calibration.ns_per_tick > 0 ? 1e9 / calibration.ns_per_tick : 0;
+  status.recalibrations = calibration.recalibrations;
+  status.fallback_reason = calibration.fallback_reason;
+  return status;
+}
+
+}  // namespace comm
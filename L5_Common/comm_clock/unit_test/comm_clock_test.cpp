@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_clock_test.cpp
+ * @brief Unit tests for FastClock
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "comm_clock.h"
+
+namespace comm {
+namespace {
+
+std::int64_t MonotonicNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/// Allowed distance between FastClock and CLOCK_MONOTONIC (VM scheduling)
+constexpr std::int64_t kToleranceNs = 2'000'000;
+
+}  // namespace
+
+TEST(FastClockTest, TracksMonotonicClock) {
+  FastClock::Calibrate();
+  for (int i = 0; i < 20; ++i) {
+    const std::int64_t before = MonotonicNs();
+    const std::int64_t fast = FastClock::NowNs();
+    const std::int64_t after = MonotonicNs();
+    EXPECT_GE(fast, before - kToleranceNs);
+    EXPECT_LE(fast, after + kToleranceNs);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+}
+
+TEST(FastClockTest, NeverGoesBackwardsOnOneThread) {
+  std::int64_t previous = FastClock::NowNs();
+  for (int i = 0; i < 1'000'000; ++i) {
+    const std::int64_t now = FastClock::NowNs();
+    ASSERT_GE(now, previous);
+    previous = now;
+  }
+}
+
+TEST(FastClockTest, WorksAsChronoClock) {
+  const FastClock::time_point start = FastClock::now();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  const auto elapsed = FastClock::now() - start;
+
+  EXPECT_GE(elapsed, std::chrono::milliseconds(19));
+  EXPECT_LT(elapsed, std::chrono::milliseconds(500));
+}
+
+TEST(FastClockTest, RealtimeMatchesSystemClock) {
+  const std::int64_t system =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count();
+  EXPECT_LT(std::llabs(FastClock::RealtimeNs() - system), kToleranceNs);
+}
+
+TEST(FastClockTest, RecheckKeepsCounterInStep) {
+  if (!FastClock::Calibrate()) {
+    GTEST_SKIP() << "Counter unavailable: "
+                 << FastClock::GetStatus().fallback_reason;
+  }
+  // Readings across several re-check intervals from concurrent threads
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([] {
+      const std::int64_t end = MonotonicNs() + 300'000'000;
+      while (MonotonicNs() < end) {
+        const std::int64_t fast = FastClock::NowNs();
+        const std::int64_t mono = MonotonicNs();
+        EXPECT_LE(fast, mono + kToleranceNs);
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  const FastClockStatus status = FastClock::GetStatus();
+  EXPECT_TRUE(status.counter_enabled) << status.fallback_reason;
+  EXPECT_GE(status.recalibrations, 2U);
+  EXPECT_GT(status.counter_hz, 1e6);
+}
+
+TEST(FastClockTest, DisableFallsBackToClockGettime) {
+  FastClock::Calibrate();
+  FastClock::Disable("test");
+
+  const FastClockStatus status = FastClock::GetStatus();
+  EXPECT_FALSE(status.counter_enabled);
+  EXPECT_STREQ(status.fallback_reason, "test");
+
+  const std::int64_t before = MonotonicNs();
+  const std::int64_t fast = FastClock::NowNs();
+  EXPECT_GE(fast, before);
+  EXPECT_LE(fast, MonotonicNs());
+}
+
+}  // namespace comm
@@ -10,16 +10,23 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <system_error>
 #include <type_traits>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 #include <toml.hpp>
 
+#include "comm_counter.h"
+#include "comm_flat_map.h"
+#include "comm_symbol.h"
+
 namespace comm {
 
 /**
@@ -59,6 +66,17 @@ inline std::error_code make_error_code(ConfigError error) {
   return {static_cast<int>(error), get_config_error_category()};
 }
 
+/**
+ * @brief Counters reported by Config::GetStats()
+ */
+struct ConfigStats {
+  std::uint64_t reloads{0};                    ///< Successful Reload() calls
+  std::uint64_t reload_failures{0};            ///< Failed Reload() calls
+  std::uint64_t listener_calls{0};             ///< Reload listener invocations
+  std::uint64_t listener_failures{0};          ///< Listeners that threw
+  std::chrono::microseconds max_listener_time{0};  ///< Slowest listener so far
+};
+
 /**
  * @class Config
  * @brief Singleton configuration manager for TOML-based configuration
@@ -124,6 +142,21 @@ class Config {
    */
   bool IsInitialized() const;
 
+  /**
+   * @brief Number of successful loads, reloads and overrides so far
+   * @return Generation of the current configuration data (0 = never loaded)
+   * @note Lets consumers tag work with the configuration it ran under
+   */
+  std::uint64_t GetGeneration() const {
+    return m_generation.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Reload and listener statistics
+   * @return Counters aggregated over all threads
+   */
+  ConfigStats GetStats() const;
+
   /**
    * @brief Get parsed TOML data
    * @return Copy of parsed TOML table
@@ -189,14 +222,14 @@ class Config {
    * @param path Dot-separated path (e.g., "infr_main.port")
    * @param value String value to set (converted to appropriate type)
    */
-  void ApplyOverrideToData(const std::string& path, const std::string& value);
+  void ApplyOverrideToData(std::string_view path, std::string_view value);
 
   /**
    * @brief Apply override without acquiring m_data_mutex (caller must hold lock)
    * @param path Dot-separated path (e.g., "infr_main.port")
    * @param value String value to set (converted to appropriate type)
    */
-  void ApplyOverrideToDataNoLock(const std::string& path, const std::string& value);
+  void ApplyOverrideToDataNoLock(std::string_view path, std::string_view value);
 
   /**
    * @brief Notify registered listeners after successful reload
@@ -204,14 +237,16 @@ class Config {
   void NotifyReloadListeners();
 
   bool m_initialized{false};
+  std::atomic<std::uint64_t> m_generation{0};
   std::string m_app_name;
   std::vector<std::string> m_config_paths;  // For reload
   toml::value m_data;
   mutable std::mutex m_data_mutex;  // Protects m_data access
   std::vector<std::function<void()>> m_reload_listeners;
   mutable std::mutex m_reload_listeners_mutex;
-  std::unordered_map<std::string, std::string> m_overrides;  // O(1) lookup
+  FlatMap<Symbol, std::string> m_overrides;  // Keyed by interned path
   mutable std::mutex m_overrides_mutex;
+  MaxGauge m_max_listener_us;  // Counters live in the MetricsRegistry
 };
 
 }  // namespace comm
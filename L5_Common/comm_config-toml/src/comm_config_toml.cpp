@@ -8,6 +8,10 @@
 
 #include "comm_config_core.h"
 
+#include "comm_arena.h"
+#include "comm_metrics.h"
+#include "comm_trace.h"
+
 #include <glog/logging.h>
 #include <cstdlib>
 #include <fstream>
@@ -155,6 +159,7 @@ std::error_code Config::Initialize(const std::string& app_name) {
   }
   
   m_initialized = true;
+  m_generation.fetch_add(1, std::memory_order_acq_rel);
   LOG(INFO) << "Configuration initialized with " << m_config_paths.size() << " file(s)";
   return make_error_code(ConfigError::Success);
 }
@@ -170,6 +175,7 @@ std::error_code Config::Load(const std::string& config_path) {
     }
     m_config_paths = {config_path};
     m_initialized = true;
+    m_generation.fetch_add(1, std::memory_order_acq_rel);
     LOG(INFO) << "Successfully loaded TOML configuration from: " << config_path;
     return make_error_code(ConfigError::Success);
   } catch (const toml::syntax_error& e) {
@@ -181,8 +187,36 @@ std::error_code Config::Load(const std::string& config_path) {
   }
 }
 
+namespace {
+
+/// Reload metrics; Config is a singleton, so they are process-wide as well
+struct ConfigMetrics {
+  Counter& reloads = MetricsRegistry::Instance().GetCounter(
+      "modu_config_reloads_total", "Successful configuration reloads");
+  Counter& reload_failures = MetricsRegistry::Instance().GetCounter(
+      "modu_config_reload_failures_total", "Configuration reloads that failed");
+  Histogram& reload_duration = MetricsRegistry::Instance().GetHistogram(
+      "modu_config_reload_duration_seconds",
+      "Time to reload the configuration, listeners included");
+  Counter& listener_calls = MetricsRegistry::Instance().GetCounter(
+      "modu_config_listener_calls_total", "Configuration reload listener invocations");
+  Counter& listener_failures = MetricsRegistry::Instance().GetCounter(
+      "modu_config_listener_failures_total", "Configuration reload listeners that threw");
+  Histogram& listener_duration = MetricsRegistry::Instance().GetHistogram(
+      "modu_config_listener_duration_seconds", "Time spent in one reload listener");
+};
+
+ConfigMetrics& Metrics() {
+  static ConfigMetrics metrics;
+  return metrics;
+}
+
+}  // namespace
+
 std::error_code Config::Reload() {
   LOG(INFO) << "Config::Reload() called";
+  Span span("config.reload");
+  const auto start = std::chrono::steady_clock::now();
   
   if (!m_initialized) {
     LOG(ERROR) << "Cannot reload: configuration not initialized";
@@ -206,10 +240,15 @@ std::error_code Config::Reload() {
     result = Load(m_config_paths[0]);
   }
 
+  span.SetAttribute("ok", !result);
   if (!result) {
+    Metrics().reloads.Add();
     ApplyOverrides();
     NotifyReloadListeners();
+  } else {
+    Metrics().reload_failures.Add();
   }
+  Metrics().reload_duration.ObserveDuration(std::chrono::steady_clock::now() - start);
   return result;
 }
 
@@ -217,6 +256,16 @@ bool Config::IsInitialized() const {
   return m_initialized;
 }
 
+ConfigStats Config::GetStats() const {
+  ConfigStats stats;
+  stats.reloads = Metrics().reloads.Value();
+  stats.reload_failures = Metrics().reload_failures.Value();
+  stats.listener_calls = Metrics().listener_calls.Value();
+  stats.listener_failures = Metrics().listener_failures.Value();
+  stats.max_listener_time = std::chrono::microseconds(m_max_listener_us.Value());
+  return stats;
+}
+
 toml::value Config::GetData() const {
   std::lock_guard<std::mutex> lock(m_data_mutex);
   return m_data;  // Returns a copy
@@ -270,17 +319,23 @@ void Config::SetOverride(const std::string& path, const std::string& value) {
   std::lock_guard<std::mutex> overrides_lock(m_overrides_mutex);
   std::lock_guard<std::mutex> data_lock(m_data_mutex);
   
-  m_overrides[path] = value;  // O(1) insert or update
+  m_overrides.insert_or_assign(Symbol(path), value);
   
   // Apply directly to m_data (locks already held)
   ApplyOverrideToDataNoLock(path, value);
+  m_generation.fetch_add(1, std::memory_order_acq_rel);
 }
 
 void Config::ApplyOverrides() {
-  std::unordered_map<std::string, std::string> overrides_copy;
+  // Scratch copy for this reload only: no global heap traffic for typical sizes
+  InlineArena<4096> arena;
+  std::pmr::vector<std::pair<Symbol, std::pmr::string>> overrides_copy(&arena);
   {
     std::lock_guard<std::mutex> lock(m_overrides_mutex);
-    overrides_copy = m_overrides;
+    overrides_copy.reserve(m_overrides.size());
+    for (const auto& [path, value] : m_overrides) {
+      overrides_copy.emplace_back(path, value);
+    }
   }
 
   if (overrides_copy.empty()) {
@@ -289,41 +344,42 @@ void Config::ApplyOverrides() {
 
   LOG(INFO) << "Applying " << overrides_copy.size() << " override(s)";
   for (const auto& [path, value] : overrides_copy) {
-    ApplyOverrideToData(path, value);
+    ApplyOverrideToData(path.View(), value);
   }
 }
 
-void Config::ApplyOverrideToData(const std::string& path, const std::string& value) {
+void Config::ApplyOverrideToData(std::string_view path, std::string_view value) {
   std::lock_guard<std::mutex> lock(m_data_mutex);
   ApplyOverrideToDataNoLock(path, value);
 }
 
-void Config::ApplyOverrideToDataNoLock(const std::string& path, const std::string& value) {
+void Config::ApplyOverrideToDataNoLock(std::string_view path, std::string_view value) {
   // Assumes m_data_mutex is already held by caller
   LOG(INFO) << "Applying override: " << path << " = " << value;
 
-  // Parse path: "infr_main.port" -> ["infr_main", "port"]
-  std::vector<std::string> keys;
+  // Parse path: "infr_main.port" -> ["infr_main", "port"] (views into path)
+  InlineArena<512> arena;
+  std::pmr::vector<std::string_view> keys(&arena);
   size_t start = 0;
   size_t end = path.find('.');
 
-  while (end != std::string::npos) {
-    std::string key = path.substr(start, end - start);
+  while (end != std::string_view::npos) {
+    std::string_view key = path.substr(start, end - start);
     if (key.empty()) {
       LOG(ERROR) << "Invalid override path (empty key): " << path;
       return;
     }
-    keys.push_back(std::move(key));
+    keys.push_back(key);
     start = end + 1;
     end = path.find('.', start);
   }
 
-  std::string last_key = path.substr(start);
+  std::string_view last_key = path.substr(start);
   if (last_key.empty()) {
     LOG(ERROR) << "Invalid override path (empty final key): " << path;
     return;
   }
-  keys.push_back(std::move(last_key));
+  keys.push_back(last_key);
 
   if (keys.empty()) {
     LOG(ERROR) << "Invalid override path: " << path;
@@ -338,7 +394,7 @@ void Config::ApplyOverrideToDataNoLock(const std::string& path, const std::strin
   // Navigate to the target location, creating tables as needed
   toml::value* current = &m_data;
   for (size_t i = 0; i < keys.size() - 1; ++i) {
-    const auto& key = keys[i];
+    const std::string key(keys[i]);
 
     if (!current->is_table()) {
       LOG(ERROR) << "Cannot set override: " << key << " is not a table";
@@ -354,9 +410,9 @@ void Config::ApplyOverrideToDataNoLock(const std::string& path, const std::strin
 
   // Set the final value with type inference
   if (current->is_table()) {
-    const auto& last_key = keys.back();
+    const std::string last_key(keys.back());
     auto& table = current->as_table();
-    table[last_key] = InferValueType(value);
+    table[last_key] = InferValueType(std::string(value));
     LOG(INFO) << "Successfully applied override: " << path << " = " << value;
   } else {
     LOG(ERROR) << "Cannot set override: parent is not a table";
@@ -371,23 +427,36 @@ void Config::RegisterReloadListener(std::function<void()> callback) {
 }
 
 void Config::NotifyReloadListeners() {
-  std::vector<std::function<void()>> listeners_copy;
+  InlineArena<2048> arena;
+  std::pmr::vector<std::function<void()>> listeners_copy(&arena);
   {
     std::lock_guard<std::mutex> lock(m_reload_listeners_mutex);
-    listeners_copy = m_reload_listeners;
+    listeners_copy.assign(m_reload_listeners.begin(), m_reload_listeners.end());
   }
 
   LOG(INFO) << "Notifying " << listeners_copy.size()
             << " config reload listeners";
 
-  for (const auto& listener : listeners_copy) {
+  ConfigMetrics& metrics = Metrics();
+  for (std::size_t index = 0; index < listeners_copy.size(); ++index) {
+    const auto& listener = listeners_copy[index];
+    Span span("config.listener");
+    span.SetAttribute("index", index);
+    const auto start = std::chrono::steady_clock::now();
     try {
       listener();
     } catch (const std::exception& e) {
+      metrics.listener_failures.Add();
       LOG(ERROR) << "Exception in config reload listener: " << e.what();
     } catch (...) {
+      metrics.listener_failures.Add();
       LOG(ERROR) << "Unknown exception in config reload listener";
     }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    metrics.listener_calls.Add();
+    metrics.listener_duration.ObserveDuration(elapsed);
+    m_max_listener_us.Record(
+        std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
   }
 }
 
@@ -13,6 +13,7 @@
 #include <fstream>
 #include <filesystem>
 #include <cstdlib>
+#include <stdexcept>
 
 namespace comm {
 class ConfigTest : public ::testing::Test {
@@ -129,6 +130,46 @@ TEST_F(ConfigTest, OverridesPersistAfterReload) {
   EXPECT_EQ(test_table.at("port").as_integer(), 2000);
 }
 
+TEST_F(ConfigTest, GenerationAdvancesOnLoadReloadAndOverride) {
+  CreateTestConfig("[test]\nvalue = 42\n");
+
+  Config& config = Config::Instance();
+  const std::uint64_t before = config.GetGeneration();
+  ASSERT_FALSE(config.Load(test_config_path_));
+  const std::uint64_t loaded = config.GetGeneration();
+  EXPECT_GT(loaded, before);
+
+  config.SetOverride("test.value", "43");
+  const std::uint64_t overridden = config.GetGeneration();
+  EXPECT_GT(overridden, loaded);
+
+  ASSERT_FALSE(config.Reload());
+  EXPECT_GT(config.GetGeneration(), overridden);
+
+  // A failed load keeps the current data and generation
+  const std::uint64_t current = config.GetGeneration();
+  EXPECT_TRUE(config.Load("/nonexistent/path/config.toml"));
+  EXPECT_EQ(config.GetGeneration(), current);
+}
+
+TEST_F(ConfigTest, StatsCountReloadsAndListeners) {
+  CreateTestConfig("[test]\nvalue = 42\n");
+
+  Config& config = Config::Instance();
+  ASSERT_FALSE(config.Load(test_config_path_));
+  config.RegisterReloadListener([]() { throw std::runtime_error("listener failure"); });
+
+  const ConfigStats before = config.GetStats();
+  ASSERT_FALSE(config.Reload());
+  const ConfigStats after = config.GetStats();
+
+  EXPECT_EQ(after.reloads, before.reloads + 1);
+  EXPECT_EQ(after.reload_failures, before.reload_failures);
+  EXPECT_GT(after.listener_calls, before.listener_calls);
+  EXPECT_EQ(after.listener_failures, before.listener_failures + 1);
+  EXPECT_GE(after.max_listener_time, before.max_listener_time);
+}
+
 TEST_F(ConfigTest, ReloadInvokesRegisteredListeners) {
   CreateTestConfig("[test]\nvalue = 42\n");
 
@@ -0,0 +1,164 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_container_benchmark.cpp
+ * @brief FlatMap against std::unordered_map, and Symbol keys
+ * @details Lookups (hits and misses) and inserts of configuration-path-like
+ *          string keys and of integer keys, for tables from 16 to 64k
+ *          elements. Lookups go through the keys in shuffled order so that
+ *          neither table benefits from the insertion order. FlatMap looks
+ *          strings up by std::string_view, std::unordered_map by the
+ *          std::string it needs. BM_SymbolLookup looks up interned keys
+ *          (an integer hash and compare); BM_SymbolIntern interns strings
+ *          that already exist, the lock-free path, from 1-8 threads.
+ *
+ * Usage: modu-core-comm_container_benchmark [--benchmark_filter=...]
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "comm_flat_map.h"
+#include "comm_symbol.h"
+
+namespace {
+
+using StdStringMap = std::unordered_map<std::string, int>;
+using FlatStringMap = comm::FlatMap<std::string, int>;
+using StdIntMap = std::unordered_map<std::uint64_t, int>;
+using FlatIntMap = comm::FlatMap<std::uint64_t, int>;
+using FlatSymbolMap = comm::FlatMap<comm::Symbol, int>;
+
+std::vector<std::string> StringKeys(std::size_t count, std::string_view prefix) {
+  std::vector<std::string> keys;
+  keys.reserve(count);
+  for (std::size_t key = 0; key < count; ++key) {
+    keys.push_back(std::string(prefix) + ".section" + std::to_string(key % 97) + ".key" +
+                   std::to_string(key));
+  }
+  return keys;
+}
+
+std::vector<std::uint64_t> IntKeys(std::size_t count, std::uint64_t offset) {
+  std::vector<std::uint64_t> keys(count);
+  for (std::size_t key = 0; key < count; ++key) {
+    keys[key] = offset + key * 64;  // aligned ids, like pointers or fds * stride
+  }
+  return keys;
+}
+
+template <typename Keys>
+Keys Shuffled(Keys keys) {
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+  return keys;
+}
+
+template <typename Map, typename Keys>
+Map Build(const Keys& keys) {
+  Map map;
+  int value = 0;
+  for (const auto& key : keys) {
+    map.try_emplace(key, value++);
+  }
+  return map;
+}
+
+/// Look up probes round-robin; hits when probes are the table's keys
+template <typename Map, typename Keys>
+void Lookup(benchmark::State& state, const Keys& keys, const Keys& probes) {
+  const Map map = Build<Map>(keys);
+  std::size_t next = 0;
+  for (auto _ : state) {
+    const auto& probe = probes[next];
+    if constexpr (std::is_same_v<Map, FlatStringMap>) {
+      benchmark::DoNotOptimize(map.find(std::string_view(probe)) != map.end());
+    } else {
+      benchmark::DoNotOptimize(map.find(probe) != map.end());
+    }
+    next = next + 1 == probes.size() ? 0 : next + 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+template <typename Map>
+void BM_StringHit(benchmark::State& state) {
+  const auto keys = StringKeys(static_cast<std::size_t>(state.range(0)), "app");
+  Lookup<Map>(state, keys, Shuffled(keys));
+}
+
+template <typename Map>
+void BM_StringMiss(benchmark::State& state) {
+  const auto count = static_cast<std::size_t>(state.range(0));
+  Lookup<Map>(state, StringKeys(count, "app"), Shuffled(StringKeys(count, "other")));
+}
+
+template <typename Map>
+void BM_IntHit(benchmark::State& state) {
+  const auto keys = IntKeys(static_cast<std::size_t>(state.range(0)), 0);
+  Lookup<Map>(state, keys, Shuffled(keys));
+}
+
+template <typename Map>
+void BM_IntMiss(benchmark::State& state) {
+  const auto count = static_cast<std::size_t>(state.range(0));
+  Lookup<Map>(state, IntKeys(count, 0), Shuffled(IntKeys(count, 1)));
+}
+
+/// Build a table of range(0) string keys from empty
+template <typename Map>
+void BM_StringInsert(benchmark::State& state) {
+  const auto keys = StringKeys(static_cast<std::size_t>(state.range(0)), "app");
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Build<Map>(keys).size());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_SymbolLookup(benchmark::State& state) {
+  std::vector<comm::Symbol> keys;
+  for (const auto& key : StringKeys(static_cast<std::size_t>(state.range(0)), "app")) {
+    keys.emplace_back(key);
+  }
+  Lookup<FlatSymbolMap>(state, keys, Shuffled(keys));
+}
+
+void BM_SymbolIntern(benchmark::State& state) {
+  static const auto keys = StringKeys(4096, "intern");
+  static const bool interned = [] {
+    for (const auto& key : keys) {
+      comm::Symbol{key};
+    }
+    return true;
+  }();
+  benchmark::DoNotOptimize(interned);
+  std::size_t next = static_cast<std::size_t>(state.thread_index()) * 997;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(comm::Symbol(keys[next % keys.size()]).Id());
+    ++next;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_StringHit, StdStringMap)->RangeMultiplier(16)->Range(16, 65536);
+BENCHMARK_TEMPLATE(BM_StringHit, FlatStringMap)->RangeMultiplier(16)->Range(16, 65536);
+BENCHMARK_TEMPLATE(BM_StringMiss, StdStringMap)->RangeMultiplier(16)->Range(16, 65536);
+BENCHMARK_TEMPLATE(BM_StringMiss, FlatStringMap)->RangeMultiplier(16)->Range(16, 65536);
+BENCHMARK_TEMPLATE(BM_IntHit, StdIntMap)->RangeMultiplier(16)->Range(16, 65536);
+BENCHMARK_TEMPLATE(BM_IntHit, FlatIntMap)->RangeMultiplier(16)->Range(16, 65536);
+BENCHMARK_TEMPLATE(BM_IntMiss, StdIntMap)->RangeMultiplier(16)->Range(16, 65536);
+BENCHMARK_TEMPLATE(BM_IntMiss, FlatIntMap)->RangeMultiplier(16)->Range(16, 65536);
+BENCHMARK_TEMPLATE(BM_StringInsert, StdStringMap)->RangeMultiplier(16)->Range(16, 4096);
+BENCHMARK_TEMPLATE(BM_StringInsert, FlatStringMap)->RangeMultiplier(16)->Range(16, 4096);
+BENCHMARK(BM_SymbolLookup)->RangeMultiplier(16)->Range(16, 65536);
+BENCHMARK(BM_SymbolIntern)->ThreadRange(1, 8)->UseRealTime();
@@ -0,0 +1,608 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_flat_map.h
+ * @brief Open-addressing hash map with SIMD group probing
+ * @details FlatMap keeps its elements in one array and a parallel array of
+ *          one control byte per slot: empty, deleted, or the low 7 bits of
+ *          the element's hash. A lookup hashes once, picks a group of 16
+ *          slots from the remaining bits and compares all 16 control bytes
+ *          against the tag with a single SSE2 compare; only slots whose tag
+ *          matches are compared by key, which is usually one. The probe
+ *          moves to the next group (triangular sequence) only when a group
+ *          is full. Compared with std::unordered_map there is no node per
+ *          element and no pointer to chase, and the whole table is a
+ *          single allocation from a std::pmr::memory_resource.
+ *
+ *          The interface is the commonly used subset of std::unordered_map.
+ *          Differences:
+ *          - Inserting may move elements: references and iterators are
+ *            invalidated by every insertion that grows the table (keep
+ *            stable objects behind a pointer)
+ *          - value_type is std::pair<Key, Value>; keys must not be modified
+ *            through an iterator
+ *          - Key and Value must be nothrow move constructible
+ *
+ * @code
+ * comm::FlatMap<std::string, int> ports(&comm::PoolResource::Instance());
+ * ports.try_emplace("http", 80);
+ * if (auto it = ports.find(std::string_view("http")); it != ports.end()) {
+ *   Listen(it->second);          // no std::string built for the lookup
+ * }
+ * @endcode
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory_resource>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "comm_hash.h"
+
+namespace comm {
+
+namespace detail {
+
+using CtrlByte = std::int8_t;
+
+/// Control bytes with the high bit set mark free slots; full slots hold a 7-bit tag
+constexpr CtrlByte kCtrlEmpty = -128;
+constexpr CtrlByte kCtrlDeleted = -2;
+
+/// Slots whose control bytes are compared at once
+constexpr std::size_t kGroupWidth = 16;
+
+/**
+ * @class ProbeGroup
+ * @brief Control bytes of one 16-slot group, matched into 16-bit masks
+ */
+class ProbeGroup {
+ public:
+#if defined(__SSE2__)
+  explicit ProbeGroup(const CtrlByte* ctrl) noexcept
+      : m_ctrl(_mm_load_si128(reinterpret_cast<const __m128i*>(ctrl))) {}
+
+  /// Slots whose tag equals tag
+  std::uint32_t Match(CtrlByte tag) const noexcept {
+    return static_cast<std::uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(tag), m_ctrl)));
+  }
+
+  /// Empty or deleted slots
+  std::uint32_t MatchFree() const noexcept {
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(m_ctrl));
+  }
+
+ private:
+  __m128i m_ctrl;
+#else
+  explicit ProbeGroup(const CtrlByte* ctrl) noexcept : m_ctrl(ctrl) {}
+
+  std::uint32_t Match(CtrlByte tag) const noexcept {
+    std::uint32_t bits = 0;
+    for (std::size_t slot = 0; slot < kGroupWidth; ++slot) {
+      bits |= static_cast<std::uint32_t>(m_ctrl[slot] == tag) << slot;
+    }
+    return bits;
+  }
+
+  std::uint32_t MatchFree() const noexcept {
+    std::uint32_t bits = 0;
+    for (std::size_t slot = 0; slot < kGroupWidth; ++slot) {
+      bits |= static_cast<std::uint32_t>(m_ctrl[slot] < 0) << slot;
+    }
+    return bits;
+  }
+
+ private:
+  const CtrlByte* m_ctrl;
+#endif
+
+ public:
+  /// Empty slots (a lookup ends at a group that has one)
+  std::uint32_t MatchEmpty() const noexcept { return Match(kCtrlEmpty); }
+};
+
+}  // namespace detail
+
+/**
+ * @class FlatMap
+ * @brief Hash map storing its elements inline, probed 16 slots at a time
+ * @tparam Hash Must spread keys over all bits (see FlatHash); with
+ *              Hash::is_transparent and KeyEqual::is_transparent, lookups
+ *              accept any type both of them accept (e.g. std::string_view
+ *              for std::string keys)
+ * @note Not thread-safe, like the standard containers
+ */
+template <typename Key, typename Value, typename Hash = FlatHash<Key>,
+          typename KeyEqual = std::equal_to<>>
+class FlatMap {
+ public:
+  using key_type = Key;
+  using mapped_type = Value;
+  using value_type = std::pair<Key, Value>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+  /// Lookups accept any type that both Hash and KeyEqual accept
+  static constexpr bool kTransparent = requires {
+    typename Hash::is_transparent;
+    typename KeyEqual::is_transparent;
+  };
+
+  static_assert(std::is_nothrow_move_constructible_v<value_type>,
+                "FlatMap moves elements when it grows");
+
+  template <bool Const>
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = FlatMap::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+    using reference = std::conditional_t<Const, const value_type&, value_type&>;
+
+    Iterator() = default;
+
+    /// iterator converts to const_iterator
+    template <bool OtherConst>
+      requires(Const && !OtherConst)
+    Iterator(const Iterator<OtherConst>& other) noexcept
+        : m_ctrl(other.m_ctrl), m_slot(other.m_slot), m_end(other.m_end) {}
+
+    reference operator*() const noexcept { return *m_slot; }
+    pointer operator->() const noexcept { return m_slot; }
+
+    Iterator& operator++() noexcept {
+      ++m_ctrl;
+      ++m_slot;
+      SkipFree();
+      return *this;
+    }
+
+    Iterator operator++(int) noexcept {
+      Iterator previous = *this;
+      ++*this;
+      return previous;
+    }
+
+    friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept {
+      return lhs.m_ctrl == rhs.m_ctrl;
+    }
+
+   private:
+    friend class FlatMap;
+    friend class Iterator<!Const>;
+
+    Iterator(const detail::CtrlByte* ctrl, pointer slot, const detail::CtrlByte* end) noexcept
+        : m_ctrl(ctrl), m_slot(slot), m_end(end) {}
+
+    void SkipFree() noexcept {
+      while (m_ctrl != m_end && *m_ctrl < 0) {
+        ++m_ctrl;
+        ++m_slot;
+      }
+    }
+
+    const detail::CtrlByte* m_ctrl{nullptr};
+    pointer m_slot{nullptr};
+    const detail::CtrlByte* m_end{nullptr};
+  };
+
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  FlatMap() noexcept : FlatMap(std::pmr::get_default_resource()) {}
+
+  explicit FlatMap(std::pmr::memory_resource* resource) noexcept : m_alloc(resource) {}
+
+  /// Empty map that takes capacity elements without growing
+  explicit FlatMap(size_type capacity,
+                   std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+      : m_alloc(resource) {
+    reserve(capacity);
+  }
+
+  FlatMap(const FlatMap& other,
+          std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+      : m_alloc(resource), m_hash(other.m_hash), m_equal(other.m_equal) {
+    CopyFrom(other);
+  }
+
+  FlatMap(FlatMap&& other) noexcept
+      : m_alloc(other.m_alloc), m_hash(std::move(other.m_hash)), m_equal(std::move(other.m_equal)) {
+    Steal(other);
+  }
+
+  FlatMap& operator=(const FlatMap& other) {
+    if (this != &other) {
+      clear();
+      CopyFrom(other);
+    }
+    return *this;
+  }
+
+  /// Takes other's table if both use the same resource, moves its elements otherwise
+  FlatMap& operator=(FlatMap&& other) {
+    if (this == &other) {
+      return *this;
+    }
+    if (m_alloc == other.m_alloc) {
+      Release();
+      Steal(other);
+    } else {
+      clear();
+      reserve(other.size());
+      for (auto& element : other) {
+        InsertNew(m_hash(element.first), std::move(element));
+      }
+      other.clear();
+    }
+    return *this;
+  }
+
+  ~FlatMap() { Release(); }
+
+  iterator begin() noexcept { return MakeIterator<false>(0); }
+  iterator end() noexcept { return MakeIterator<false>(m_capacity); }
+  const_iterator begin() const noexcept { return MakeIterator<true>(0); }
+  const_iterator end() const noexcept { return MakeIterator<true>(m_capacity); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  bool empty() const noexcept { return m_size == 0; }
+  size_type size() const noexcept { return m_size; }
+
+  /// Slots allocated (elements fit up to 7/8 of them)
+  size_type capacity() const noexcept { return m_capacity; }
+
+  allocator_type get_allocator() const noexcept { return m_alloc; }
+
+  /// Destroy all elements, keep the table
+  void clear() noexcept {
+    if (m_size != 0) {
+      for (size_type index = 0; index < m_capacity; ++index) {
+        if (m_ctrl[index] >= 0) {
+          m_slots[index].~value_type();
+        }
+      }
+    }
+    if (m_capacity != 0) {
+      std::memset(m_ctrl, static_cast<unsigned char>(detail::kCtrlEmpty), m_capacity);
+    }
+    m_size = 0;
+    m_growth_left = MaxLoad(m_capacity);
+  }
+
+  /// Make room for count elements without further growth
+  void reserve(size_type count) {
+    if (count <= MaxLoad(m_capacity)) {
+      return;
+    }
+    size_type capacity = std::max(m_capacity, detail::kGroupWidth);
+    while (MaxLoad(capacity) < count) {
+      capacity *= 2;
+    }
+    Rehash(capacity);
+  }
+
+  iterator find(const Key& key) { return MakeIterator<false>(FindIndex(key, m_hash(key))); }
+  const_iterator find(const Key& key) const {
+    return MakeIterator<true>(FindIndex(key, m_hash(key)));
+  }
+
+  template <typename K>
+    requires kTransparent
+  iterator find(const K& key) {
+    return MakeIterator<false>(FindIndex(key, m_hash(key)));
+  }
+
+  template <typename K>
+    requires kTransparent
+  const_iterator find(const K& key) const {
+    return MakeIterator<true>(FindIndex(key, m_hash(key)));
+  }
+
+  bool contains(const Key& key) const { return FindIndex(key, m_hash(key)) != m_capacity; }
+
+  template <typename K>
+    requires kTransparent
+  bool contains(const K& key) const {
+    return FindIndex(key, m_hash(key)) != m_capacity;
+  }
+
+  /**
+   * @brief Insert {key, Value(args...)} unless key is present
+   * @return Iterator to the element with key, and whether it was inserted
+   */
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+    return TryEmplace(key, std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args) {
+    return TryEmplace(std::move(key), std::forward<Args>(args)...);
+  }
+
+  /// Key is only constructed from key if it is inserted
+  template <typename K, typename... Args>
+    requires kTransparent && std::is_constructible_v<Key, K&&>
+  std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+    return TryEmplace(std::forward<K>(key), std::forward<Args>(args)...);
+  }
+
+  template <typename V>
+  std::pair<iterator, bool> insert_or_assign(const Key& key, V&& value) {
+    return InsertOrAssign(key, std::forward<V>(value));
+  }
+
+  template <typename V>
+  std::pair<iterator, bool> insert_or_assign(Key&& key, V&& value) {
+    return InsertOrAssign(std::move(key), std::forward<V>(value));
+  }
+
+  template <typename K, typename V>
+    requires kTransparent && std::is_constructible_v<Key, K&&>
+  std::pair<iterator, bool> insert_or_assign(K&& key, V&& value) {
+    return InsertOrAssign(std::forward<K>(key), std::forward<V>(value));
+  }
+
+  Value& operator[](const Key& key) { return TryEmplace(key).first->second; }
+  Value& operator[](Key&& key) { return TryEmplace(std::move(key)).first->second; }
+
+  template <typename K>
+    requires kTransparent && std::is_constructible_v<Key, K&&>
+  Value& operator[](K&& key) {
+    return TryEmplace(std::forward<K>(key)).first->second;
+  }
+
+  /// @return Number of elements erased (0 or 1)
+  size_type erase(const Key& key) { return EraseKey(key); }
+
+  template <typename K>
+    requires kTransparent
+  size_type erase(const K& key) {
+    return EraseKey(key);
+  }
+
+  /// Erase the element at position; other iterators stay valid
+  /// @return Iterator to the next element
+  iterator erase(const_iterator position) noexcept {
+    const auto index = static_cast<size_type>(position.m_ctrl - m_ctrl);
+    EraseIndex(index);
+    iterator next = MakeIterator<false>(index);
+    next.SkipFree();
+    return next;
+  }
+
+  iterator erase(iterator position) noexcept { return erase(const_iterator(position)); }
+
+ private:
+  static constexpr std::size_t kAlignment = std::max(alignof(value_type), detail::kGroupWidth);
+
+  /// Elements that fit in capacity slots (7/8 load factor)
+  static constexpr size_type MaxLoad(size_type capacity) noexcept {
+    return capacity - capacity / 8;
+  }
+
+  /// Bytes of the slot array, rounded so that the control bytes are aligned
+  static constexpr size_type SlotBytes(size_type capacity) noexcept {
+    return (capacity * sizeof(value_type) + detail::kGroupWidth - 1) &
+           ~(detail::kGroupWidth - 1);
+  }
+
+  static detail::CtrlByte Tag(std::size_t hash) noexcept {
+    return static_cast<detail::CtrlByte>(hash & 0x7F);
+  }
+
+  /// First group probed for hash (the tag bits are not reused)
+  size_type FirstGroup(std::size_t hash) const noexcept {
+    return (hash >> 7) & (m_capacity / detail::kGroupWidth - 1);
+  }
+
+  template <bool Const>
+  Iterator<Const> MakeIterator(size_type index) const noexcept {
+    Iterator<Const> it(m_ctrl + index, m_slots + index, m_ctrl + m_capacity);
+    if (index == 0) {
+      it.SkipFree();
+    }
+    return it;
+  }
+
+  /// Index of key, or m_capacity
+  template <typename K>
+  size_type FindIndex(const K& key, std::size_t hash) const {
+    if (m_size == 0) {
+      return m_capacity;
+    }
+    const size_type group_mask = m_capacity / detail::kGroupWidth - 1;
+    const detail::CtrlByte tag = Tag(hash);
+    size_type group = FirstGroup(hash);
+    for (size_type step = 1;; ++step) {
+      const size_type base = group * detail::kGroupWidth;
+      const detail::ProbeGroup probe(m_ctrl + base);
+      for (std::uint32_t bits = probe.Match(tag); bits != 0; bits &= bits - 1) {
+        const size_type index = base + static_cast<size_type>(std::countr_zero(bits));
+        if (m_equal(m_slots[index].first, key)) {
+          return index;
+        }
+      }
+      // Keys are inserted into the first group with a free slot
+      if (probe.MatchEmpty() != 0) {
+        return m_capacity;
+      }
+      group = (group + step) & group_mask;
+    }
+  }
+
+  /// First empty or deleted slot on the probe sequence of hash
+  size_type FindFree(std::size_t hash) const noexcept {
+    const size_type group_mask = m_capacity / detail::kGroupWidth - 1;
+    size_type group = FirstGroup(hash);
+    for (size_type step = 1;; ++step) {
+      const size_type base = group * detail::kGroupWidth;
+      if (const std::uint32_t bits = detail::ProbeGroup(m_ctrl + base).MatchFree()) {
+        return base + static_cast<size_type>(std::countr_zero(bits));
+      }
+      group = (group + step) & group_mask;
+    }
+  }
+
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> TryEmplace(K&& key, Args&&... args) {
+    const std::size_t hash = m_hash(key);
+    if (const size_type index = FindIndex(key, hash); index != m_capacity) {
+      return {MakeIterator<false>(index), false};
+    }
+    const size_type index = InsertNew(hash, std::piecewise_construct,
+                                      std::forward_as_tuple(std::forward<K>(key)),
+                                      std::forward_as_tuple(std::forward<Args>(args)...));
+    return {MakeIterator<false>(index), true};
+  }
+
+  template <typename K, typename V>
+  std::pair<iterator, bool> InsertOrAssign(K&& key, V&& value) {
+    auto result = TryEmplace(std::forward<K>(key), std::forward<V>(value));
+    if (!result.second) {
+      // Not consumed by TryEmplace: nothing was constructed
+      result.first->second = std::forward<V>(value);
+    }
+    return result;
+  }
+
+  /// Construct an element known to be absent, growing first if needed
+  template <typename... Args>
+  size_type InsertNew(std::size_t hash, Args&&... args) {
+    if (m_capacity == 0) {
+      Rehash(detail::kGroupWidth);
+    }
+    size_type index = FindFree(hash);
+    // A deleted slot can be reused without using up an empty one
+    if (m_growth_left == 0 && m_ctrl[index] != detail::kCtrlDeleted) {
+      // Grow, unless dropping the tombstones frees enough room
+      Rehash(m_size + 1 > MaxLoad(m_capacity) / 2 ? m_capacity * 2 : m_capacity);
+      index = FindFree(hash);
+    }
+    ::new (static_cast<void*>(m_slots + index)) value_type(std::forward<Args>(args)...);
+    if (m_ctrl[index] == detail::kCtrlEmpty) {
+      --m_growth_left;
+    }
+    m_ctrl[index] = Tag(hash);
+    ++m_size;
+    return index;
+  }
+
+  template <typename K>
+  size_type EraseKey(const K& key) {
+    const size_type index = FindIndex(key, m_hash(key));
+    if (index == m_capacity) {
+      return 0;
+    }
+    EraseIndex(index);
+    return 1;
+  }
+
+  void EraseIndex(size_type index) noexcept {
+    m_slots[index].~value_type();
+    --m_size;
+    // Lookups stop at a group with an empty slot: if this group already
+    // has one, no probe sequence continues past it and the slot can be empty
+    const size_type base = index & ~(detail::kGroupWidth - 1);
+    if (detail::ProbeGroup(m_ctrl + base).MatchEmpty() != 0) {
+      m_ctrl[index] = detail::kCtrlEmpty;
+      ++m_growth_left;
+    } else {
+      m_ctrl[index] = detail::kCtrlDeleted;
+    }
+  }
+
+  /// Move all elements into a new table of capacity slots
+  void Rehash(size_type capacity) {
+    void* block = m_alloc.allocate_bytes(SlotBytes(capacity) + capacity, kAlignment);
+    auto* slots = static_cast<value_type*>(block);
+    auto* ctrl = reinterpret_cast<detail::CtrlByte*>(static_cast<std::byte*>(block) +
+                                                     SlotBytes(capacity));
+    std::memset(ctrl, static_cast<unsigned char>(detail::kCtrlEmpty), capacity);
+
+    value_type* old_slots = m_slots;
+    detail::CtrlByte* old_ctrl = m_ctrl;
+    const size_type old_capacity = m_capacity;
+    m_slots = slots;
+    m_ctrl = ctrl;
+    m_capacity = capacity;
+    m_growth_left = MaxLoad(capacity) - m_size;
+
+    for (size_type index = 0; index < old_capacity; ++index) {
+      if (old_ctrl[index] < 0) {
+        continue;
+      }
+      const std::size_t hash = m_hash(old_slots[index].first);
+      const size_type target = FindFree(hash);
+      ::new (static_cast<void*>(m_slots + target)) value_type(std::move(old_slots[index]));
+      m_ctrl[target] = Tag(hash);
+      old_slots[index].~value_type();
+    }
+    if (old_capacity != 0) {
+      m_alloc.deallocate_bytes(old_slots, SlotBytes(old_capacity) + old_capacity, kAlignment);
+    }
+  }
+
+  void CopyFrom(const FlatMap& other) {
+    reserve(other.size());
+    for (const auto& element : other) {
+      InsertNew(m_hash(element.first), element);
+    }
+  }
+
+  /// Take other's table, leaving other empty (same resource)
+  void Steal(FlatMap& other) noexcept {
+    m_ctrl = std::exchange(other.m_ctrl, nullptr);
+    m_slots = std::exchange(other.m_slots, nullptr);
+    m_capacity = std::exchange(other.m_capacity, 0);
+    m_size = std::exchange(other.m_size, 0);
+    m_growth_left = std::exchange(other.m_growth_left, 0);
+  }
+
+  void Release() noexcept {
+    if (m_capacity == 0) {
+      return;
+    }
+    clear();
+    m_alloc.deallocate_bytes(m_slots, SlotBytes(m_capacity) + m_capacity, kAlignment);
+    m_slots = nullptr;
+    m_ctrl = nullptr;
+    m_capacity = 0;
+    m_growth_left = 0;
+  }
+
+  allocator_type m_alloc;
+  [[no_unique_address]] Hash m_hash;
+  [[no_unique_address]] KeyEqual m_equal;
+  detail::CtrlByte* m_ctrl{nullptr};
+  value_type* m_slots{nullptr};
+  size_type m_capacity{0};
+  size_type m_size{0};
+  /// Empty slots that may still be filled before the table grows
+  size_type m_growth_left{0};
+};
+
+}  // namespace comm
@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_hash.h
+ * @brief Hash functions for open-addressing tables
+ * @details FlatMap takes both the probe position and a 7-bit tag from one
+ *          hash, so every bit of it has to depend on every bit of the key.
+ *          std::hash of an integer or a pointer is the identity on
+ *          libstdc++; FlatHash mixes it with a 64x64->128 bit multiply.
+ *          Strings are hashed by HashBytes(), which reads 8 or 16 bytes per
+ *          step, and can be looked up by std::string_view or const char*
+ *          without building a std::string.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace comm {
+
+/**
+ * @brief Hash size bytes at data
+ * @note Not a cryptographic hash: keys chosen by a remote peer should be
+ *       hashed with a secret seed
+ */
+std::uint64_t HashBytes(const void* data, std::size_t size, std::uint64_t seed = 0) noexcept;
+
+/**
+ * @brief Spread an integer over all 64 bits
+ */
+inline std::uint64_t HashMix(std::uint64_t value) noexcept {
+  const __uint128_t product =
+      static_cast<__uint128_t>(value ^ 0xa0761d6478bd642fULL) * 0xe7037ed1a0b428dbULL;
+  return static_cast<std::uint64_t>(product) ^ static_cast<std::uint64_t>(product >> 64);
+}
+
+/**
+ * @brief Default hash of FlatMap: std::hash, mixed
+ */
+template <typename T>
+struct FlatHash {
+  std::size_t operator()(const T& value) const noexcept(noexcept(std::hash<T>{}(value))) {
+    return HashMix(std::hash<T>{}(value));
+  }
+};
+
+/**
+ * @brief String hash accepting std::string, std::string_view and const char*
+ */
+template <>
+struct FlatHash<std::string> {
+  using is_transparent = void;
+
+  std::size_t operator()(std::string_view value) const noexcept {
+    return HashBytes(value.data(), value.size());
+  }
+};
+
+template <>
+struct FlatHash<std::string_view> : FlatHash<std::string> {};
+
+}  // namespace comm
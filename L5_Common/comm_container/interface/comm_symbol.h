@@ -0,0 +1,177 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_symbol.h
+ * @brief Process-wide string interning
+ * @details A Symbol is a 32-bit id for a string stored once in the
+ *          SymbolTable. Equal strings get equal ids, so names used as keys
+ *          (configuration paths, log modules, rate limit names) compare and
+ *          hash as integers and are kept in memory once. Interned text is
+ *          never freed or moved: Symbol::View() stays valid for the life of
+ *          the process and is NUL-terminated.
+ *
+ *          Looking up a string that is already interned takes no lock: the
+ *          hash index is an array of atomic ids, published by the single
+ *          (mutex-protected) writer with release stores. Only new strings
+ *          take the mutex.
+ *
+ * @code
+ * const comm::Symbol port("server.port");
+ * if (key == port) { ... }                       // integer compare
+ * LOG(INFO) << port.View();                       // "server.port"
+ * @endcode
+ */
+
+#pragma once
+
+#include <atomic>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "comm_hash.h"
+
+namespace comm {
+
+class SymbolTable;
+
+/**
+ * @class Symbol
+ * @brief Interned string, compared and hashed by id
+ * @note The default Symbol is the empty string (id 0)
+ */
+class Symbol {
+ public:
+  constexpr Symbol() noexcept = default;
+
+  /// Intern text (takes a lock only the first time text is seen)
+  explicit Symbol(std::string_view text);
+
+  /// Symbol of text if it was interned before; never adds it
+  static std::optional<Symbol> Find(std::string_view text) noexcept;
+
+  constexpr std::uint32_t Id() const noexcept { return m_id; }
+  constexpr bool Empty() const noexcept { return m_id == 0; }
+
+  /// Interned text, valid for the life of the process
+  std::string_view View() const noexcept;
+
+  /// Interned text as a NUL-terminated string
+  const char* CStr() const noexcept { return View().data(); }
+
+  friend constexpr bool operator==(Symbol, Symbol) noexcept = default;
+
+  /// Orders by id, i.e. by first interning, not alphabetically
+  friend constexpr std::strong_ordering operator<=>(Symbol, Symbol) noexcept = default;
+
+ private:
+  friend class SymbolTable;
+
+  explicit constexpr Symbol(std::uint32_t id) noexcept : m_id(id) {}
+
+  std::uint32_t m_id{0};
+};
+
+std::ostream& operator<<(std::ostream& stream, Symbol symbol);
+
+template <>
+struct FlatHash<Symbol> {
+  std::size_t operator()(Symbol symbol) const noexcept { return HashMix(symbol.Id()); }
+};
+
+/**
+ * @brief Counters reported by SymbolTable::GetStats()
+ */
+struct SymbolStats {
+  std::size_t symbols{0};         ///< Distinct strings interned (including "")
+  std::size_t text_bytes{0};      ///< Interned text including terminators
+  std::size_t reserved_bytes{0};  ///< Text chunks, entries and hash index allocated
+};
+
+/**
+ * @class SymbolTable
+ * @brief The strings behind all Symbols
+ */
+class SymbolTable {
+ public:
+  /**
+   * @brief Returns the process-wide table
+   * @note Never destroyed, so Symbols stay valid during static destruction
+   */
+  static SymbolTable& Instance();
+
+  SymbolTable(const SymbolTable&) = delete;
+  SymbolTable& operator=(const SymbolTable&) = delete;
+
+  /// Symbol of text, interned if new
+  /// @throws std::length_error once 2^32 - 256 strings are interned
+  Symbol Intern(std::string_view text);
+
+  /// Symbol of text if interned; lock-free
+  std::optional<Symbol> Find(std::string_view text) const noexcept;
+
+  /// Text of symbol
+  std::string_view View(Symbol symbol) const noexcept;
+
+  SymbolStats GetStats() const;
+
+ private:
+  struct Entry {
+    const char* text{nullptr};
+    std::uint32_t size{0};
+    std::uint32_t hash{0};
+  };
+
+  /// Open-addressing index of id + 1 (0 = empty), linear probing
+  struct Index {
+    explicit Index(std::size_t slots);
+
+    const std::size_t mask;
+    std::unique_ptr<std::atomic<std::uint32_t>[]> ids;
+  };
+
+  /// Entries live in segments of 256, 512, 1024, ... so that they never move
+  static constexpr std::size_t kFirstSegmentBits = 8;
+  static constexpr std::size_t kSegments = 32 - kFirstSegmentBits;
+
+  SymbolTable();
+  ~SymbolTable() = default;
+
+  static std::uint32_t HashOf(std::string_view text) noexcept;
+  const Entry& EntryOf(std::uint32_t id) const noexcept;
+  std::optional<Symbol> Probe(const Index& index, std::string_view text,
+                              std::uint32_t hash) const noexcept;
+  /// Add a new entry (mutex held)
+  Symbol Add(std::string_view text, std::uint32_t hash);
+  /// Copy text and a terminator into the text chunks (mutex held)
+  const char* Store(std::string_view text);
+  static void Insert(Index& index, std::uint32_t id, std::uint32_t hash) noexcept;
+
+  std::atomic<Index*> m_index{nullptr};
+  std::atomic<Entry*> m_segments[kSegments]{};
+  std::atomic<std::uint32_t> m_count{0};
+
+  mutable std::mutex m_mutex;  ///< Serializes Add()
+  /// Every index ever published: readers may still probe an older one
+  std::vector<std::unique_ptr<Index>> m_indexes;
+  std::vector<std::unique_ptr<Entry[]>> m_segment_storage;
+  std::vector<std::unique_ptr<char[]>> m_chunks;
+  char* m_chunk_next{nullptr};
+  std::size_t m_chunk_left{0};
+  std::size_t m_text_bytes{0};
+  std::size_t m_reserved_bytes{0};
+};
+
+}  // namespace comm
+
+template <>
+struct std::hash<comm::Symbol> {
+  std::size_t operator()(comm::Symbol symbol) const noexcept { return symbol.Id(); }
+};
@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_hash.cpp
+ * @brief Byte hash behind FlatHash<std::string>
+ */
+
+#include "comm_hash.h"
+
+#include <cstring>
+
+namespace comm {
+
+namespace {
+
+constexpr std::uint64_t kSecret0 = 0xa0761d6478bd642fULL;
+constexpr std::uint64_t kSecret1 = 0xe7037ed1a0b428dbULL;
+constexpr std::uint64_t kSecret2 = 0x8ebc6af09c88c6e3ULL;
+
+/// Multiply into 128 bits and fold the halves
+inline std::uint64_t Fold(std::uint64_t a, std::uint64_t b) noexcept {
+  const __uint128_t product = static_cast<__uint128_t>(a) * b;
+  return static_cast<std::uint64_t>(product) ^ static_cast<std::uint64_t>(product >> 64);
+}
+
+inline std::uint64_t Load64(const unsigned char* bytes) noexcept {
+  std::uint64_t value;
+  std::memcpy(&value, bytes, sizeof(value));
+  return value;
+}
+
+inline std::uint64_t Load32(const unsigned char* bytes) noexcept {
+  std::uint32_t value;
+  std::memcpy(&value, bytes, sizeof(value));
+  return value;
+}
+
+}  // namespace
+
+std::uint64_t HashBytes(const void* data, std::size_t size, std::uint64_t seed) noexcept {
+  const auto* bytes = static_cast<const unsigned char*>(data);
+  std::uint64_t state = seed ^ kSecret0;
+  std::size_t left = size;
+
+  while (left > 16) {
+    state = Fold(Load64(bytes) ^ kSecret1, Load64(bytes + 8) ^ state);
+    bytes += 16;
+    left -= 16;
+  }
+
+  // Tail of 0-16 bytes, read as two possibly overlapping words
+  std::uint64_t a = 0;
+  std::uint64_t b = 0;
+  if (left >= 8) {
+    a = Load64(bytes);
+    b = Load64(bytes + left - 8);
+  } else if (left >= 4) {
+    a = Load32(bytes);
+    b = Load32(bytes + left - 4);
+  } else if (left > 0) {
+    a = (static_cast<std::uint64_t>(bytes[0]) << 16) |
+        (static_cast<std::uint64_t>(bytes[left / 2]) << 8) | bytes[left - 1];
+  }
+  return Fold(kSecret1 ^ size, Fold(a ^ kSecret1, b ^ state ^ kSecret2));
+}
+
+}  // namespace comm
@@ -0,0 +1,184 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_symbol.cpp
+ * @brief SymbolTable: append-only text, entry segments and lock-free index
+ */
+
+#include "comm_symbol.h"
+
+#include <bit>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+
+namespace comm {
+
+namespace {
+
+/// Text is copied into chunks of this size; longer strings get their own
+constexpr std::size_t kChunkSize = 64 * 1024;
+constexpr std::size_t kInitialIndexSlots = 1024;
+
+}  // namespace
+
+Symbol::Symbol(std::string_view text) : Symbol(SymbolTable::Instance().Intern(text)) {}
+
+std::optional<Symbol> Symbol::Find(std::string_view text) noexcept {
+  return SymbolTable::Instance().Find(text);
+}
+
+std::string_view Symbol::View() const noexcept { return SymbolTable::Instance().View(*this); }
+
+std::ostream& operator<<(std::ostream& stream, Symbol symbol) {
+  return stream << symbol.View();
+}
+
+SymbolTable::Index::Index(std::size_t slots)
+    : mask(slots - 1), ids(std::make_unique<std::atomic<std::uint32_t>[]>(slots)) {}
+
+SymbolTable& SymbolTable::Instance() {
+  static SymbolTable* const instance = new SymbolTable();
+  return *instance;
+}
+
+SymbolTable::SymbolTable() {
+  m_indexes.push_back(std::make_unique<Index>(kInitialIndexSlots));
+  m_reserved_bytes += kInitialIndexSlots * sizeof(std::uint32_t);
+  m_index.store(m_indexes.back().get(), std::memory_order_release);
+  // Id 0, the default Symbol
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Add({}, HashOf({}));
+}
+
+std::uint32_t SymbolTable::HashOf(std::string_view text) noexcept {
+  const std::uint64_t hash = HashBytes(text.data(), text.size());
+  return static_cast<std::uint32_t>(hash ^ (hash >> 32));
+}
+
+const SymbolTable::Entry& SymbolTable::EntryOf(std::uint32_t id) const noexcept {
+  // Segment k holds ids [256 * (2^k - 1), 256 * (2^(k+1) - 1))
+  const std::uint64_t biased = static_cast<std::uint64_t>(id) + (1U << kFirstSegmentBits);
+  const auto segment = static_cast<std::size_t>(std::bit_width(biased)) - kFirstSegmentBits - 1;
+  const std::uint64_t offset = biased - (std::uint64_t{1} << (segment + kFirstSegmentBits));
+  return m_segments[segment].load(std::memory_order_acquire)[offset];
+}
+
+std::optional<Symbol> SymbolTable::Probe(const Index& index, std::string_view text,
+                                         std::uint32_t hash) const noexcept {
+  for (std::size_t slot = hash & index.mask;; slot = (slot + 1) & index.mask) {
+    const std::uint32_t stored = index.ids[slot].load(std::memory_order_acquire);
+    if (stored == 0) {
+      return std::nullopt;
+    }
+    const Entry& entry = EntryOf(stored - 1);
+    if (entry.hash == hash && std::string_view(entry.text, entry.size) == text) {
+      return Symbol(stored - 1);
+    }
+  }
+}
+
+std::optional<Symbol> SymbolTable::Find(std::string_view text) const noexcept {
+  return Probe(*m_index.load(std::memory_order_acquire), text, HashOf(text));
+}
+
+Symbol SymbolTable::Intern(std::string_view text) {
+  const std::uint32_t hash = HashOf(text);
+  if (auto symbol = Probe(*m_index.load(std::memory_order_acquire), text, hash)) {
+    return *symbol;
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  // Another thread may have added it since
+  if (auto symbol = Probe(*m_index.load(std::memory_order_relaxed), text, hash)) {
+    return *symbol;
+  }
+  return Add(text, hash);
+}
+
+std::string_view SymbolTable::View(Symbol symbol) const noexcept {
+  const Entry& entry = EntryOf(symbol.Id());
+  return {entry.text, entry.size};
+}
+
+SymbolStats SymbolTable::GetStats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  SymbolStats stats;
+  stats.symbols = m_count.load(std::memory_order_relaxed);
+  stats.text_bytes = m_text_bytes;
+  stats.reserved_bytes = m_reserved_bytes;
+  return stats;
+}
+
+Symbol SymbolTable::Add(std::string_view text, std::uint32_t hash) {
+  const std::uint32_t id = m_count.load(std::memory_order_relaxed);
+  if (id == UINT32_MAX - (1U << kFirstSegmentBits)) {
+    throw std::length_error("SymbolTable full");
+  }
+
+  // Entry first: readers reach it only through the index slot stored last
+  const std::uint64_t biased = static_cast<std::uint64_t>(id) + (1U << kFirstSegmentBits);
+  const auto segment = static_cast<std::size_t>(std::bit_width(biased)) - kFirstSegmentBits - 1;
+  if (m_segments[segment].load(std::memory_order_relaxed) == nullptr) {
+    const std::size_t entries = std::size_t{1} << (segment + kFirstSegmentBits);
+    m_segment_storage.push_back(std::make_unique<Entry[]>(entries));
+    m_reserved_bytes += entries * sizeof(Entry);
+    m_segments[segment].store(m_segment_storage.back().get(), std::memory_order_release);
+  }
+  const std::uint64_t offset = biased - (std::uint64_t{1} << (segment + kFirstSegmentBits));
+  Entry& entry = m_segments[segment].load(std::memory_order_relaxed)[offset];
+  entry.text = Store(text);
+  entry.size = static_cast<std::uint32_t>(text.size());
+  entry.hash = hash;
+
+  // Keep the index at most half full; the old one stays valid for readers
+  Index* index = m_index.load(std::memory_order_relaxed);
+  if ((static_cast<std::size_t>(id) + 1) * 2 > index->mask + 1) {
+    const std::size_t slots = (index->mask + 1) * 2;
+    m_indexes.push_back(std::make_unique<Index>(slots));
+    m_reserved_bytes += slots * sizeof(std::uint32_t);
+    Index* grown = m_indexes.back().get();
+    for (std::uint32_t existing = 0; existing < id; ++existing) {
+      Insert(*grown, existing, EntryOf(existing).hash);
+    }
+    m_index.store(grown, std::memory_order_release);
+    index = grown;
+  }
+  Insert(*index, id, hash);
+  m_count.store(id + 1, std::memory_order_release);
+  return Symbol(id);
+}
+
+const char* SymbolTable::Store(std::string_view text) {
+  const std::size_t bytes = text.size() + 1;
+  char* target = nullptr;
+  if (bytes > kChunkSize / 4) {
+    m_chunks.push_back(std::make_unique<char[]>(bytes));
+    m_reserved_bytes += bytes;
+    target = m_chunks.back().get();
+  } else {
+    if (bytes > m_chunk_left) {
+      m_chunks.push_back(std::make_unique<char[]>(kChunkSize));
+      m_reserved_bytes += kChunkSize;
+      m_chunk_next = m_chunks.back().get();
+      m_chunk_left = kChunkSize;
+    }
+    target = m_chunk_next;
+    m_chunk_next += bytes;
+    m_chunk_left -= bytes;
+  }
+  std::memcpy(target, text.data(), text.size());
+  target[text.size()] = '\0';
+  m_text_bytes += bytes;
+  return target;
+}
+
+void SymbolTable::Insert(Index& index, std::uint32_t id, std::uint32_t hash) noexcept {
+  std::size_t slot = hash & index.mask;
+  while (index.ids[slot].load(std::memory_order_relaxed) != 0) {
+    slot = (slot + 1) & index.mask;
+  }
+  index.ids[slot].store(id + 1, std::memory_order_release);
+}
+
+}  // namespace comm
@@ -0,0 +1,333 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_container_test.cpp
+ * @brief Unit tests for FlatMap, FlatHash and Symbol
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "comm_flat_map.h"
+#include "comm_hash.h"
+#include "comm_symbol.h"
+
+namespace comm {
+namespace {
+
+/// Counts what goes through it to the default resource
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  std::size_t allocations{0};
+  std::size_t bytes_in_use{0};
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    ++allocations;
+    bytes_in_use += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override {
+    bytes_in_use -= bytes;
+    std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+/// Sends every key to the same group with the same tag
+struct CollidingHash {
+  std::size_t operator()(int) const noexcept { return 0x2A; }
+};
+
+TEST(FlatMapTest, InsertFindEraseAcrossGrowth) {
+  FlatMap<int, int> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.find(1), map.end());
+
+  for (int key = 0; key < 10000; ++key) {
+    auto [it, inserted] = map.try_emplace(key, key * 2);
+    ASSERT_TRUE(inserted);
+    ASSERT_EQ(it->first, key);
+  }
+  EXPECT_EQ(map.size(), 10000U);
+  EXPECT_FALSE(map.try_emplace(5, 0).second);
+  EXPECT_EQ(map.find(5)->second, 10);
+
+  for (int key = 0; key < 10000; key += 2) {
+    ASSERT_EQ(map.erase(key), 1U);
+  }
+  EXPECT_EQ(map.erase(0), 0U);
+  EXPECT_EQ(map.size(), 5000U);
+  for (int key = 0; key < 10000; ++key) {
+    ASSERT_EQ(map.contains(key), key % 2 == 1) << key;
+  }
+
+  map[3] = 7;
+  map[4] = 8;
+  EXPECT_EQ(map.find(3)->second, 7);
+  EXPECT_EQ(map.find(4)->second, 8);
+  EXPECT_TRUE(map.insert_or_assign(4, 9).second == false);
+  EXPECT_EQ(map[4], 9);
+}
+
+TEST(FlatMapTest, StringKeysAreFoundByStringView) {
+  FlatMap<std::string, int> map;
+  static_assert(FlatMap<std::string, int>::kTransparent);
+
+  map.try_emplace(std::string_view("alpha"), 1);  // key built only on insert
+  map.try_emplace("beta", 2);
+  map.insert_or_assign(std::string("gamma"), 3);
+
+  const std::string_view beta = "beta";
+  ASSERT_NE(map.find(beta), map.end());
+  EXPECT_EQ(map.find(beta)->second, 2);
+  EXPECT_TRUE(map.contains("alpha"));
+  EXPECT_FALSE(map.contains(std::string_view("alph")));
+  EXPECT_EQ(map[std::string_view("gamma")], 3);
+  EXPECT_EQ(map.erase(std::string_view("alpha")), 1U);
+  EXPECT_FALSE(map.contains("alpha"));
+  EXPECT_EQ(map.size(), 2U);
+}
+
+TEST(FlatMapTest, CollidingKeysProbeFurtherGroups) {
+  FlatMap<int, int, CollidingHash> map;
+  for (int key = 0; key < 100; ++key) {
+    map.try_emplace(key, key);
+  }
+  for (int key = 0; key < 100; key += 3) {
+    ASSERT_EQ(map.erase(key), 1U);
+  }
+  for (int key = 0; key < 100; ++key) {
+    ASSERT_EQ(map.contains(key), key % 3 != 0) << key;
+  }
+  // Freed slots are reused
+  for (int key = 0; key < 100; key += 3) {
+    ASSERT_TRUE(map.try_emplace(key, -key).second);
+  }
+  EXPECT_EQ(map.size(), 100U);
+  EXPECT_EQ(map.find(99)->second, -99);
+}
+
+TEST(FlatMapTest, ChurnDoesNotGrowTheTable) {
+  FlatMap<std::uint64_t, int> map;
+  for (std::uint64_t key = 0; key < 100000; ++key) {
+    map.try_emplace(key, 0);
+    if (key >= 10) {
+      ASSERT_EQ(map.erase(key - 10), 1U);
+    }
+  }
+  EXPECT_EQ(map.size(), 10U);
+  EXPECT_LE(map.capacity(), 32U);
+}
+
+TEST(FlatMapTest, IterationVisitsEveryElementOnce) {
+  FlatMap<int, int> map;
+  for (int key = 0; key < 1000; ++key) {
+    map[key] = key;
+  }
+  std::set<int> seen;
+  for (const auto& [key, value] : map) {
+    EXPECT_EQ(key, value);
+    EXPECT_TRUE(seen.insert(key).second);
+  }
+  EXPECT_EQ(seen.size(), 1000U);
+
+  // Erase while iterating
+  for (auto it = map.begin(); it != map.end();) {
+    it = it->first % 2 == 0 ? map.erase(it) : std::next(it);
+  }
+  EXPECT_EQ(map.size(), 500U);
+  EXPECT_EQ(std::distance(map.begin(), map.end()), 500);
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.begin(), map.end());
+}
+
+TEST(FlatMapTest, TableComesFromTheMemoryResource) {
+  CountingResource first;
+  CountingResource second;
+  {
+    FlatMap<std::string, std::unique_ptr<int>> map(&first);
+    EXPECT_EQ(first.allocations, 0U);
+    map.reserve(100);
+    EXPECT_EQ(first.allocations, 1U);
+    for (int key = 0; key < 100; ++key) {
+      map.try_emplace(std::to_string(key), std::make_unique<int>(key));
+    }
+    EXPECT_EQ(first.allocations, 1U);  // reserved: no growth
+
+    FlatMap<std::string, std::unique_ptr<int>> moved(std::move(map));
+    EXPECT_EQ(first.allocations, 1U);
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(*moved.find("42")->second, 42);
+
+    FlatMap<std::string, std::unique_ptr<int>> other(&second);
+    other = std::move(moved);  // different resource: elements move
+    EXPECT_EQ(second.allocations, 1U);
+    EXPECT_EQ(other.size(), 100U);
+    EXPECT_EQ(*other.find("99")->second, 99);
+  }
+  EXPECT_EQ(first.bytes_in_use, 0U);
+  EXPECT_EQ(second.bytes_in_use, 0U);
+
+  FlatMap<std::string, std::string> source(&first);
+  source.try_emplace("key", "value");
+  const FlatMap<std::string, std::string> copy(source, &second);
+  EXPECT_EQ(copy.get_allocator().resource(), &second);
+  EXPECT_EQ(copy.find("key")->second, "value");
+}
+
+TEST(FlatMapTest, MatchesUnorderedMapUnderRandomOperations) {
+  std::mt19937 random(7);
+  std::uniform_int_distribution<int> key_of(0, 2000);
+  FlatMap<std::string, int> map;
+  std::unordered_map<std::string, int> expected;
+
+  for (int round = 0; round < 50000; ++round) {
+    const std::string key = std::to_string(key_of(random));
+    switch (random() % 3) {
+      case 0:
+        ASSERT_EQ(map.try_emplace(key, round).second, expected.try_emplace(key, round).second);
+        break;
+      case 1:
+        ASSERT_EQ(map.erase(key), expected.erase(key));
+        break;
+      default: {
+        const auto it = map.find(key);
+        const auto expected_it = expected.find(key);
+        ASSERT_EQ(it == map.end(), expected_it == expected.end());
+        if (it != map.end()) {
+          ASSERT_EQ(it->second, expected_it->second);
+        }
+      }
+    }
+    ASSERT_EQ(map.size(), expected.size());
+  }
+}
+
+TEST(FlatHashTest, StringHashAgreesAcrossTypesAndUsesAllBits) {
+  const FlatHash<std::string> hash;
+  EXPECT_EQ(hash(std::string("modu-core")), hash(std::string_view("modu-core")));
+  EXPECT_EQ(hash("modu-core"), hash(std::string_view("modu-core")));
+  EXPECT_NE(hash(""), hash(std::string_view("\0", 1)));
+
+  // Low 7 bits (tag) and high bits (group) of similar keys differ
+  std::set<std::size_t> tags;
+  std::set<std::size_t> groups;
+  for (int key = 0; key < 1000; ++key) {
+    const std::size_t value = hash("module." + std::to_string(key));
+    tags.insert(value & 0x7F);
+    groups.insert((value >> 7) & 0x3FF);
+  }
+  EXPECT_EQ(tags.size(), 128U);
+  EXPECT_GT(groups.size(), 550U);
+
+  // Integers and pointers are mixed, not passed through
+  EXPECT_NE(FlatHash<int>{}(1) & 0x7F, 1U);
+  EXPECT_NE(HashMix(1), HashMix(2));
+}
+
+
+TEST(SymbolTest, EqualStringsShareOneSymbol) {
+  const Symbol first("symbol_test.port");
+  const Symbol second(std::string("symbol_test.") + "port");
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(first.View().data(), second.View().data());  // stored once
+  EXPECT_EQ(first.View(), "symbol_test.port");
+  EXPECT_STREQ(first.CStr(), "symbol_test.port");
+  EXPECT_NE(first, Symbol("symbol_test.host"));
+
+  EXPECT_TRUE(Symbol().Empty());
+  EXPECT_EQ(Symbol(""), Symbol());
+  EXPECT_EQ(Symbol().View(), "");
+  const Symbol with_nul(std::string_view("a\0b", 3));
+  EXPECT_EQ(with_nul.View().size(), 3U);
+  EXPECT_NE(with_nul, Symbol("a"));
+}
+
+TEST(SymbolTest, FindDoesNotIntern) {
+  EXPECT_FALSE(Symbol::Find("symbol_test.never_interned").has_value());
+  const std::size_t before = SymbolTable::Instance().GetStats().symbols;
+  EXPECT_FALSE(Symbol::Find("symbol_test.never_interned").has_value());
+  EXPECT_EQ(SymbolTable::Instance().GetStats().symbols, before);
+
+  const Symbol added("symbol_test.found");
+  ASSERT_TRUE(Symbol::Find("symbol_test.found").has_value());
+  EXPECT_EQ(*Symbol::Find("symbol_test.found"), added);
+}
+
+TEST(SymbolTest, ViewsStayValidWhileTheTableGrows) {
+  const Symbol first("symbol_test.grow.first");
+  const std::string_view view = first.View();
+  std::vector<Symbol> symbols;
+  for (int key = 0; key < 20000; ++key) {
+    symbols.emplace_back("symbol_test.grow." + std::to_string(key));
+  }
+  const std::string long_text(100000, 'x');
+  const Symbol long_symbol(long_text);
+
+  EXPECT_EQ(first.View().data(), view.data());
+  EXPECT_EQ(view, "symbol_test.grow.first");
+  for (int key = 0; key < 20000; ++key) {
+    ASSERT_EQ(symbols[static_cast<std::size_t>(key)].View(),
+              "symbol_test.grow." + std::to_string(key));
+  }
+  EXPECT_EQ(long_symbol.View(), long_text);
+  const SymbolStats stats = SymbolTable::Instance().GetStats();
+  EXPECT_GT(stats.symbols, 20000U);
+  EXPECT_GE(stats.reserved_bytes, stats.text_bytes);
+}
+
+TEST(SymbolTest, ConcurrentInterningAgreesOnIds) {
+  constexpr int kThreads = 4;
+  constexpr int kKeys = 5000;
+  std::vector<std::vector<Symbol>> results(kThreads);
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < kThreads; ++thread) {
+    threads.emplace_back([&results, thread] {
+      auto& symbols = results[static_cast<std::size_t>(thread)];
+      symbols.resize(kKeys);
+      // Each thread walks the keys from a different starting point
+      for (int step = 0; step < kKeys; ++step) {
+        const int key = (step + thread * kKeys / kThreads) % kKeys;
+        symbols[static_cast<std::size_t>(key)] =
+            Symbol("symbol_test.concurrent." + std::to_string(key));
+        EXPECT_EQ(symbols[static_cast<std::size_t>(key)].View(),
+                  "symbol_test.concurrent." + std::to_string(key));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int thread = 1; thread < kThreads; ++thread) {
+    EXPECT_EQ(results[static_cast<std::size_t>(thread)], results[0]);
+  }
+}
+
+TEST(SymbolTest, SymbolsAreFlatMapKeys) {
+  FlatMap<Symbol, int> map;
+  map[Symbol("symbol_test.key.a")] = 1;
+  map[Symbol("symbol_test.key.b")] = 2;
+  EXPECT_EQ(map.find(Symbol("symbol_test.key.a"))->second, 1);
+  EXPECT_FALSE(map.contains(Symbol("symbol_test.key.c")));
+}
+
+}  // namespace
+}  // namespace comm
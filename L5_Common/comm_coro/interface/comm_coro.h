@@ -0,0 +1,594 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_coro.h
+ * @brief C++20 coroutine tasks scheduled on the comm_executor thread pools
+ * @details Task<T> is a lazily started coroutine: it runs when awaited, and
+ *          resumes its awaiter by symmetric transfer when done. Spawn() and
+ *          TaskScope start tasks on a ThreadPool, SyncWait() blocks a plain
+ *          thread on one. Suspended coroutines hold no thread: timers and I/O
+ *          readiness (comm_coro_io.h) and AsyncEvent resume them on the pool
+ *          they were running on. Cancellation uses std::stop_token.
+ *
+ * @code
+ * comm::Task<int> Fetch(int fd, std::stop_token stop) {
+ *   if (auto error = co_await comm::WaitReadable(fd, stop)) {
+ *     co_return -1;
+ *   }
+ *   co_return ReadValue(fd);
+ * }
+ *
+ * comm::Task<void> Handle(Connection& connection) {
+ *   auto [a, b] = co_await comm::WhenAll(Fetch(connection.a, {}), Fetch(connection.b, {}));
+ *   co_await comm::SleepFor(std::chrono::milliseconds(10));
+ * }
+ *
+ * comm::Spawn(Handle(connection));
+ * @endcode
+ */
+
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <semaphore>
+#include <stop_token>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "comm_executor.h"
+
+namespace comm {
+
+/**
+ * @brief Error codes for coroutine operations
+ */
+enum class CoroError {
+  Success = 0,       ///< Operation completed successfully
+  Cancelled = 1,     ///< The stop_token was triggered before completion
+  ShuttingDown = 2,  ///< The reactor was stopped (process shutdown)
+};
+
+/**
+ * @brief Error category for coroutine errors
+ */
+class CoroErrorCategory : public std::error_category {
+ public:
+  const char* name() const noexcept override { return "comm_coro"; }
+  std::string message(int error_value) const override;
+};
+
+/**
+ * @brief Get the singleton instance of CoroErrorCategory
+ */
+const std::error_category& get_coro_error_category() noexcept;
+
+/**
+ * @brief Helper function to create std::error_code from CoroError
+ */
+inline std::error_code make_error_code(CoroError err) noexcept {
+  return {static_cast<int>(err), get_coro_error_category()};
+}
+
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+/**
+ * @brief Pool of the calling worker, the default pool on other threads
+ */
+ThreadPool& CurrentPool();
+
+/**
+ * @brief A suspended coroutine waiting for an external completion
+ * @details Whoever removes the operation from its wait list owns it and
+ *          completes it exactly once with Resume().
+ */
+struct Operation {
+  std::coroutine_handle<> handle;
+  ThreadPool* pool{nullptr};
+  std::error_code result;
+};
+
+/**
+ * @brief Resume the operation's coroutine on its pool (inline if stopped)
+ */
+void Resume(Operation& operation);
+
+/**
+ * @brief Storage for a task's value or exception
+ */
+template <typename T>
+class TaskResult {
+ public:
+  template <typename U>
+  void return_value(U&& value) {
+    m_result.template emplace<1>(std::forward<U>(value));
+  }
+  void unhandled_exception() noexcept {
+    m_result.template emplace<2>(std::current_exception());
+  }
+  T Take() {
+    if (m_result.index() == 2) {
+      std::rethrow_exception(std::get<2>(m_result));
+    }
+    return std::move(std::get<1>(m_result));
+  }
+
+ private:
+  std::variant<std::monostate, T, std::exception_ptr> m_result;
+};
+
+template <>
+class TaskResult<void> {
+ public:
+  void return_void() noexcept {}
+  void unhandled_exception() noexcept { m_exception = std::current_exception(); }
+  void Take() {
+    if (m_exception) {
+      std::rethrow_exception(m_exception);
+    }
+  }
+
+ private:
+  std::exception_ptr m_exception;
+};
+
+template <typename T>
+struct TaskPromise : TaskResult<T> {
+  std::coroutine_handle<> continuation{std::noop_coroutine()};
+
+  struct FinalAwaiter {
+    bool await_ready() noexcept { return false; }
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+      return handle.promise().continuation;
+    }
+    void await_resume() noexcept {}
+  };
+
+  Task<T> get_return_object() noexcept;
+  std::suspend_always initial_suspend() noexcept { return {}; }
+  FinalAwaiter final_suspend() noexcept { return {}; }
+};
+
+}  // namespace detail
+
+/**
+ * @class Task
+ * @brief Lazily started coroutine producing a T (or an exception)
+ * @details Move-only; co_await starts it on the awaiting thread and yields
+ *          its value or rethrows its exception. Destroying a Task that was
+ *          never awaited destroys the coroutine without running it.
+ */
+template <typename T>
+class [[nodiscard]] Task {
+ public:
+  using promise_type = detail::TaskPromise<T>;
+  using Handle = std::coroutine_handle<promise_type>;
+
+  Task() = default;
+  explicit Task(Handle handle) : m_handle(handle) {}
+  Task(Task&& other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      m_handle = std::exchange(other.m_handle, {});
+    }
+    return *this;
+  }
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+  ~Task() { Reset(); }
+
+  bool IsValid() const { return static_cast<bool>(m_handle); }
+
+  auto operator co_await() && noexcept {
+    struct Awaiter {
+      Handle handle;
+      bool await_ready() const noexcept { return !handle || handle.done(); }
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+      }
+      T await_resume() { return handle.promise().Take(); }
+    };
+    return Awaiter{m_handle};
+  }
+
+ private:
+  void Reset() {
+    if (m_handle) {
+      m_handle.destroy();
+      m_handle = {};
+    }
+  }
+
+  Handle m_handle;
+};
+
+template <typename T>
+Task<T> detail::TaskPromise<T>::get_return_object() noexcept {
+  return Task<T>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+}
+
+/**
+ * @brief Continue the calling coroutine on a worker of pool
+ * @details Continues inline if the pool does not accept tasks
+ */
+inline auto ScheduleOn(ThreadPool& pool) noexcept {
+  struct Awaiter {
+    ThreadPool& pool;
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> handle) {
+      return !pool.Submit([handle] { handle.resume(); });
+    }
+    void await_resume() const noexcept {}
+  };
+  return Awaiter{pool};
+}
+
+namespace detail {
+
+/**
+ * @brief Fire-and-forget coroutine; its frame frees itself when done
+ */
+struct Detached {
+  struct promise_type {
+    Detached get_return_object() noexcept { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+};
+
+/// Log an exception that escaped a spawned task
+void LogSpawnedException(std::exception_ptr exception) noexcept;
+
+inline Detached RunDetached(ThreadPool& pool, Task<void> task) {
+  co_await ScheduleOn(pool);
+  try {
+    co_await std::move(task);
+  } catch (...) {
+    LogSpawnedException(std::current_exception());
+  }
+}
+
+/**
+ * @brief Frame of SyncWait(): runs the task and releases the waiting thread
+ */
+template <typename T>
+struct SyncWaitDriver {
+  struct promise_type {
+    std::binary_semaphore* done{nullptr};
+    SyncWaitDriver get_return_object() noexcept {
+      return {std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    auto final_suspend() noexcept {
+      struct Release {
+        bool await_ready() noexcept { return false; }
+        void await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+          handle.promise().done->release();
+        }
+        void await_resume() noexcept {}
+      };
+      return Release{};
+    }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+  std::coroutine_handle<promise_type> handle;
+};
+
+template <typename T>
+SyncWaitDriver<T> RunSyncWait(Task<T> task, TaskResult<T>& result) {
+  try {
+    if constexpr (std::is_void_v<T>) {
+      co_await std::move(task);
+      result.return_void();
+    } else {
+      result.return_value(co_await std::move(task));
+    }
+  } catch (...) {
+    result.unhandled_exception();
+  }
+}
+
+/**
+ * @brief Shared state of one WhenAll(): children left and the parent
+ */
+struct JoinCounter {
+  explicit JoinCounter(std::size_t children) : remaining(children + 1) {}
+  std::atomic<std::size_t> remaining;
+  std::coroutine_handle<> parent;
+};
+
+/**
+ * @brief Child of WhenAll(): frees its frame and resumes the parent if last
+ */
+struct JoinChild {
+  struct promise_type {
+    JoinCounter* counter{nullptr};
+    JoinChild get_return_object() noexcept {
+      return {std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    auto final_suspend() noexcept {
+      struct Finish {
+        bool await_ready() noexcept { return false; }
+        std::coroutine_handle<> await_suspend(
+            std::coroutine_handle<promise_type> handle) noexcept {
+          JoinCounter* counter = handle.promise().counter;
+          handle.destroy();
+          if (counter->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            return counter->parent;
+          }
+          return std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+      };
+      return Finish{};
+    }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+  std::coroutine_handle<promise_type> handle;
+};
+
+inline JoinChild RunJoinChild(Task<void> task, std::exception_ptr& error) {
+  try {
+    co_await std::move(task);
+  } catch (...) {
+    error = std::current_exception();
+  }
+}
+
+/**
+ * @brief Starts all children on the pool and resumes when the last finishes
+ */
+class JoinAwaiter {
+ public:
+  JoinAwaiter(std::vector<Task<void>>& tasks, std::vector<std::exception_ptr>& errors)
+      : m_tasks(tasks), m_errors(errors), m_counter(tasks.size()) {}
+
+  bool await_ready() const noexcept { return m_tasks.empty(); }
+  bool await_suspend(std::coroutine_handle<> parent);
+  void await_resume() const noexcept {}
+
+ private:
+  std::vector<Task<void>>& m_tasks;
+  std::vector<std::exception_ptr>& m_errors;
+  JoinCounter m_counter;
+};
+
+template <typename T>
+Task<void> StoreResult(Task<T> task, std::optional<T>& slot) {
+  slot.emplace(co_await std::move(task));
+}
+
+template <typename Tuple, std::size_t... Indexes>
+auto UnwrapResults(Tuple& results, std::index_sequence<Indexes...>) {
+  return std::make_tuple(std::move(*std::get<Indexes>(results))...);
+}
+
+}  // namespace detail
+
+/**
+ * @brief Run a task on pool without waiting for it
+ * @param task Task to run; an escaping exception is logged
+ * @param pool Pool to start on (default: the shared "default" pool)
+ */
+inline void Spawn(Task<void> task, ThreadPool& pool = Executor::Instance().Default()) {
+  detail::RunDetached(pool, std::move(task));
+}
+
+/**
+ * @brief Block the calling thread until the task finishes
+ * @return The task's value; its exception is rethrown
+ * @note The task starts on the calling thread; do not call from a pool worker
+ */
+template <typename T>
+T SyncWait(Task<T> task) {
+  std::binary_semaphore done{0};
+  detail::TaskResult<T> result;
+  auto driver = detail::RunSyncWait(std::move(task), result);
+  driver.handle.promise().done = &done;
+  driver.handle.resume();
+  done.acquire();
+  driver.handle.destroy();
+  return result.Take();
+}
+
+/**
+ * @brief Run tasks concurrently on the current pool, wait for all of them
+ * @details All tasks run to completion even if some throw; the first
+ *          exception (by position) is rethrown afterwards
+ */
+Task<void> WhenAll(std::vector<Task<void>> tasks);
+
+/**
+ * @brief Run tasks concurrently, collect their values in order
+ */
+template <typename T>
+Task<std::vector<T>> WhenAll(std::vector<Task<T>> tasks) {
+  std::vector<std::optional<T>> slots(tasks.size());
+  std::vector<Task<void>> wrapped;
+  wrapped.reserve(tasks.size());
+  for (std::size_t index = 0; index < tasks.size(); ++index) {
+    wrapped.push_back(detail::StoreResult(std::move(tasks[index]), slots[index]));
+  }
+  co_await WhenAll(std::move(wrapped));
+  std::vector<T> values;
+  values.reserve(slots.size());
+  for (auto& slot : slots) {
+    values.push_back(std::move(*slot));
+  }
+  co_return values;
+}
+
+/**
+ * @brief Run tasks of different (non-void) types concurrently
+ * @return Tuple of their values
+ */
+template <typename First, typename... Rest>
+  requires(!std::is_void_v<First> && (!std::is_void_v<Rest> && ...))
+Task<std::tuple<First, Rest...>> WhenAll(Task<First> first, Task<Rest>... rest) {
+  std::tuple<std::optional<First>, std::optional<Rest>...> slots;
+  std::vector<Task<void>> wrapped;
+  wrapped.reserve(1 + sizeof...(Rest));
+  auto tasks = std::forward_as_tuple(std::move(first), std::move(rest)...);
+  [&]<std::size_t... Indexes>(std::index_sequence<Indexes...>) {
+    (wrapped.push_back(detail::StoreResult(std::move(std::get<Indexes>(tasks)),
+                                           std::get<Indexes>(slots))),
+     ...);
+  }(std::index_sequence_for<First, Rest...>{});
+  co_await WhenAll(std::move(wrapped));
+  co_return detail::UnwrapResults(slots, std::index_sequence_for<First, Rest...>{});
+}
+
+/**
+ * @class AsyncEvent
+ * @brief Manual-reset event coroutines can wait on without blocking a thread
+ */
+class AsyncEvent {
+ public:
+  explicit AsyncEvent(bool set = false) : m_set(set) {}
+  AsyncEvent(const AsyncEvent&) = delete;
+  AsyncEvent& operator=(const AsyncEvent&) = delete;
+
+  /**
+   * @brief Set the event and resume all waiters (on their pools)
+   */
+  void Set();
+
+  /**
+   * @brief Make later Wait() calls suspend again
+   */
+  void Reset();
+
+  bool IsSet() const;
+
+  class Awaiter;
+
+  /**
+   * @brief co_await: resumes when the event is set
+   * @return Empty error_code, or CoroError::Cancelled if stop was requested
+   */
+  Awaiter Wait(std::stop_token stop = {});
+
+ private:
+  friend class Awaiter;
+
+  struct Waiter {
+    detail::Operation operation;
+    Waiter* next{nullptr};
+    Waiter* previous{nullptr};
+    bool queued{false};
+  };
+
+  /// False (and waiter resumable inline) if already set or stopped
+  bool Enqueue(Waiter& waiter, const std::stop_token& stop);
+  void Cancel(Waiter& waiter);
+
+  mutable std::mutex m_mutex;
+  bool m_set;
+  Waiter* m_head{nullptr};
+};
+
+class AsyncEvent::Awaiter {
+ public:
+  Awaiter(AsyncEvent& event, std::stop_token stop)
+      : m_event(event), m_stop(std::move(stop)) {}
+
+  bool await_ready() const { return m_event.IsSet(); }
+  bool await_suspend(std::coroutine_handle<> handle);
+  std::error_code await_resume() const noexcept { return m_waiter.operation.result; }
+
+ private:
+  struct CancelWait {
+    Awaiter* awaiter;
+    void operator()() const noexcept { awaiter->m_event.Cancel(awaiter->m_waiter); }
+  };
+
+  AsyncEvent& m_event;
+  std::stop_token m_stop;
+  Waiter m_waiter;
+  std::optional<std::stop_callback<CancelWait>> m_callback;
+};
+
+inline AsyncEvent::Awaiter AsyncEvent::Wait(std::stop_token stop) {
+  return Awaiter(*this, std::move(stop));
+}
+
+/**
+ * @class TaskScope
+ * @brief Structured group of concurrently running tasks
+ * @details Spawned tasks run on the current pool. The first exception
+ *          requests stop on the scope's token (so siblings can wind down)
+ *          and is rethrown by Join(). co_await Join() before destroying the
+ *          scope; the destructor otherwise blocks until the tasks finish.
+ *
+ * @code
+ * comm::TaskScope scope;
+ * for (auto& connection : connections) {
+ *   scope.Spawn(Serve(connection, scope.GetToken()));
+ * }
+ * co_await scope.Join();
+ * @endcode
+ */
+class TaskScope {
+ public:
+  TaskScope() = default;
+  ~TaskScope();
+  TaskScope(const TaskScope&) = delete;
+  TaskScope& operator=(const TaskScope&) = delete;
+
+  /**
+   * @brief Start a task in this scope (only before Join() completes)
+   */
+  void Spawn(Task<void> task);
+
+  /**
+   * @brief Request stop on GetToken() for all tasks of the scope
+   */
+  void Cancel() { m_stop.request_stop(); }
+
+  std::stop_token GetToken() const { return m_stop.get_token(); }
+
+  /**
+   * @brief Wait until all spawned tasks finished, rethrow the first exception
+   */
+  Task<void> Join();
+
+ private:
+  static Task<void> RunChild(TaskScope& scope, Task<void> task);
+  void Finish();
+
+  std::stop_source m_stop;
+  /// Running tasks plus one reference released by Join()
+  std::atomic<std::size_t> m_active{1};
+  bool m_joined{false};
+  AsyncEvent m_done;
+  std::mutex m_error_mutex;
+  std::exception_ptr m_error;
+};
+
+}  // namespace comm
+
+namespace std {
+template <>
+struct is_error_code_enum<comm::CoroError> : true_type {};
+}  // namespace std
@@ -0,0 +1,227 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_coro_io.h
+ * @brief co_await-able timers and file descriptor readiness
+ * @details One reactor thread waits in epoll_wait() on all registered file
+ *          descriptors and on a timerfd armed for the earliest deadline.
+ *          Ready operations are resumed on the pool their coroutine was
+ *          running on, so the reactor thread never runs user code.
+ *
+ * @code
+ * if (auto error = co_await comm::SleepFor(std::chrono::seconds(1), stop)) {
+ *   co_return;   // CoroError::Cancelled or CoroError::ShuttingDown
+ * }
+ * @endcode
+ */
+
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "comm_clock.h"
+#include "comm_coro.h"
+
+namespace comm {
+
+/**
+ * @class Reactor
+ * @brief epoll/timerfd thread completing timer and readiness operations
+ * @details Started on first use; comm::Main::deinit() stops it before the
+ *          thread pools, completing pending operations with ShuttingDown.
+ */
+class Reactor {
+ public:
+  /**
+   * @brief Returns singleton instance of Reactor class
+   * @details Thread-safe initialization using Meyers' Singleton pattern
+   * @return Reference to the single Reactor instance
+   */
+  static Reactor& Instance() {
+    static Reactor instance;
+    return instance;
+  }
+
+  Reactor(const Reactor&) = delete;
+  Reactor& operator=(const Reactor&) = delete;
+
+  /**
+   * @brief Complete all pending operations with ShuttingDown, join the thread
+   * @note Later operations complete immediately with ShuttingDown
+   */
+  void Stop();
+
+  /**
+   * @brief Number of timers and fd waits currently registered
+   */
+  std::size_t GetPendingCount() const;
+
+  /// Operation ids, unique for the process lifetime
+  std::uint64_t NextId();
+
+  /**
+   * @brief Register a timer completing at deadline_ns (FastClock time line)
+   * @return False if not registered: operation.result holds the reason
+   *         (stop already requested, reactor stopped or failed to start)
+   */
+  bool AddTimer(std::uint64_t id, std::int64_t deadline_ns,
+                detail::Operation& operation, const std::stop_token& stop);
+
+  /**
+   * @brief Register a wait for EPOLLIN/EPOLLOUT on fd
+   * @return False if not registered: operation.result holds the reason
+   * @note One reader and one writer may wait per fd; fd must stay open
+   */
+  bool AddFdWait(std::uint64_t id, int fd, bool write, detail::Operation& operation,
+                 const std::stop_token& stop);
+
+  /**
+   * @brief Complete a registered operation with CoroError::Cancelled
+   */
+  void Cancel(std::uint64_t id);
+
+ private:
+  Reactor() = default;
+  ~Reactor();
+
+  struct Pending {
+    detail::Operation* operation;
+    std::int64_t deadline_ns;  ///< Timers only
+    int fd;                    ///< -1 for timers
+    bool write;
+  };
+
+  struct FdWaiters {
+    std::uint64_t reader{0};
+    std::uint64_t writer{0};
+  };
+
+  std::error_code StartLocked();
+  void Loop();
+  void ArmTimerLocked();
+  void UpdateFdLocked(int fd);
+  void ExpireTimersLocked(std::vector<detail::Operation*>& ready);
+  detail::Operation* RemoveLocked(std::uint64_t id);
+
+  mutable std::mutex m_mutex;
+  bool m_stopped{false};
+  std::thread m_thread;
+  int m_epoll_fd{-1};
+  int m_timer_fd{-1};
+  int m_wake_fd{-1};
+  std::int64_t m_armed_deadline_ns{0};
+  std::uint64_t m_next_id{1};
+
+  std::unordered_map<std::uint64_t, Pending> m_pending;
+  std::multimap<std::int64_t, std::uint64_t> m_timers;
+  std::unordered_map<int, FdWaiters> m_fds;
+};
+
+namespace detail {
+
+/**
+ * @brief Awaiter registering one reactor operation, cancellable by stop_token
+ */
+class ReactorAwaiter {
+ public:
+  explicit ReactorAwaiter(std::stop_token stop) : m_stop(std::move(stop)) {}
+
+  bool await_ready() const noexcept { return false; }
+  std::error_code await_resume() const noexcept { return m_operation.result; }
+
+ protected:
+  /// Set up cancellation; returns the id to register the operation under
+  std::uint64_t Prepare(std::coroutine_handle<> handle);
+
+  std::stop_token m_stop;
+  Operation m_operation;
+
+ private:
+  struct CancelOperation {
+    std::uint64_t id;
+    void operator()() const noexcept { Reactor::Instance().Cancel(id); }
+  };
+
+  std::optional<std::stop_callback<CancelOperation>> m_callback;
+};
+
+class TimerAwaiter : public ReactorAwaiter {
+ public:
+  TimerAwaiter(std::int64_t deadline_ns, std::stop_token stop)
+      : ReactorAwaiter(std::move(stop)), m_deadline_ns(deadline_ns) {}
+
+  bool await_suspend(std::coroutine_handle<> handle) {
+    const std::uint64_t id = Prepare(handle);
+    return Reactor::Instance().AddTimer(id, m_deadline_ns, m_operation, m_stop);
+  }
+
+ private:
+  std::int64_t m_deadline_ns;
+};
+
+class FdAwaiter : public ReactorAwaiter {
+ public:
+  FdAwaiter(int fd, bool write, std::stop_token stop)
+      : ReactorAwaiter(std::move(stop)), m_fd(fd), m_write(write) {}
+
+  bool await_suspend(std::coroutine_handle<> handle) {
+    const std::uint64_t id = Prepare(handle);
+    return Reactor::Instance().AddFdWait(id, m_fd, m_write, m_operation, m_stop);
+  }
+
+ private:
+  int m_fd;
+  bool m_write;
+};
+
+}  // namespace detail
+
+/**
+ * @brief co_await: resume at deadline
+ * @return Empty error_code, CoroError::Cancelled or CoroError::ShuttingDown
+ */
+inline detail::TimerAwaiter SleepUntil(FastClock::time_point deadline,
+                                       std::stop_token stop = {}) {
+  return detail::TimerAwaiter(deadline.time_since_epoch().count(), std::move(stop));
+}
+
+/**
+ * @brief co_await: resume after delay
+ * @return Empty error_code, CoroError::Cancelled or CoroError::ShuttingDown
+ */
+template <typename Rep, typename Period>
+detail::TimerAwaiter SleepFor(std::chrono::duration<Rep, Period> delay,
+                              std::stop_token stop = {}) {
+  return SleepUntil(FastClock::now() +
+                        std::chrono::duration_cast<FastClock::duration>(delay),
+                    std::move(stop));
+}
+
+/**
+ * @brief co_await: resume when fd is readable (or has an error/hangup)
+ * @return Empty error_code, a system error from epoll_ctl(), or a CoroError
+ */
+inline detail::FdAwaiter WaitReadable(int fd, std::stop_token stop = {}) {
+  return detail::FdAwaiter(fd, false, std::move(stop));
+}
+
+/**
+ * @brief co_await: resume when fd is writable (or has an error/hangup)
+ * @return Empty error_code, a system error from epoll_ctl(), or a CoroError
+ */
+inline detail::FdAwaiter WaitWritable(int fd, std::stop_token stop = {}) {
+  return detail::FdAwaiter(fd, true, std::move(stop));
+}
+
+}  // namespace comm
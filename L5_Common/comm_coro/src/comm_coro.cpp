@@ -0,0 +1,217 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_coro.cpp
+ * @brief Coroutine resumption, WhenAll(), AsyncEvent and TaskScope
+ */
+
+#include "comm_coro.h"
+
+#include <glog/logging.h>
+
+namespace comm {
+
+// Error category implementation
+std::string CoroErrorCategory::message(int error_value) const {
+  switch (static_cast<CoroError>(error_value)) {
+    case CoroError::Success:
+      return "Success";
+    case CoroError::Cancelled:
+      return "Operation cancelled";
+    case CoroError::ShuttingDown:
+      return "Reactor is shutting down";
+    default:
+      return "Unknown coroutine error";
+  }
+}
+
+const std::error_category& get_coro_error_category() noexcept {
+  static CoroErrorCategory instance;
+  return instance;
+}
+
+namespace detail {
+
+ThreadPool& CurrentPool() {
+  if (ThreadPool* pool = ThreadPool::Current()) {
+    return *pool;
+  }
+  return Executor::Instance().Default();
+}
+
+void Resume(Operation& operation) {
+  // The operation lives in the coroutine frame: copy before handing it over
+  const std::coroutine_handle<> handle = operation.handle;
+  if (operation.pool->Submit([handle] { handle.resume(); })) {
+    // Pool already shut down (process exit): finish the coroutine here
+    handle.resume();
+  }
+}
+
+void LogSpawnedException(std::exception_ptr exception) noexcept {
+  try {
+    std::rethrow_exception(exception);
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Exception in spawned task: " << e.what();
+  } catch (...) {
+    LOG(ERROR) << "Unknown exception in spawned task";
+  }
+}
+
+bool JoinAwaiter::await_suspend(std::coroutine_handle<> parent) {
+  m_counter.parent = parent;
+  ThreadPool& pool = CurrentPool();
+  for (std::size_t index = 0; index < m_tasks.size(); ++index) {
+    JoinChild child = RunJoinChild(std::move(m_tasks[index]), m_errors[index]);
+    child.handle.promise().counter = &m_counter;
+    const std::coroutine_handle<> handle = child.handle;
+    if (pool.Submit([handle] { handle.resume(); })) {
+      handle.resume();
+    }
+  }
+  // Drop the reference held while starting: the children may all be done
+  return m_counter.remaining.fetch_sub(1, std::memory_order_acq_rel) != 1;
+}
+
+}  // namespace detail
+
+Task<void> WhenAll(std::vector<Task<void>> tasks) {
+  std::vector<std::exception_ptr> errors(tasks.size());
+  co_await detail::JoinAwaiter(tasks, errors);
+  for (auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+void AsyncEvent::Set() {
+  Waiter* waiter = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_set) {
+      return;
+    }
+    m_set = true;
+    waiter = std::exchange(m_head, nullptr);
+    for (Waiter* next = waiter; next != nullptr; next = next->next) {
+      next->queued = false;
+    }
+  }
+  // Waiters stay valid until resumed; read the link first
+  while (waiter != nullptr) {
+    Waiter* next = waiter->next;
+    waiter->operation.result = {};
+    detail::Resume(waiter->operation);
+    waiter = next;
+  }
+}
+
+void AsyncEvent::Reset() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_set = false;
+}
+
+bool AsyncEvent::IsSet() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_set;
+}
+
+bool AsyncEvent::Enqueue(Waiter& waiter, const std::stop_token& stop) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_set) {
+    return false;
+  }
+  if (stop.stop_requested()) {
+    waiter.operation.result = make_error_code(CoroError::Cancelled);
+    return false;
+  }
+  waiter.next = m_head;
+  waiter.previous = nullptr;
+  if (m_head != nullptr) {
+    m_head->previous = &waiter;
+  }
+  m_head = &waiter;
+  waiter.queued = true;
+  return true;
+}
+
+void AsyncEvent::Cancel(Waiter& waiter) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!waiter.queued) {
+      return;
+    }
+    if (waiter.previous != nullptr) {
+      waiter.previous->next = waiter.next;
+    } else {
+      m_head = waiter.next;
+    }
+    if (waiter.next != nullptr) {
+      waiter.next->previous = waiter.previous;
+    }
+    waiter.queued = false;
+  }
+  waiter.operation.result = make_error_code(CoroError::Cancelled);
+  detail::Resume(waiter.operation);
+}
+
+bool AsyncEvent::Awaiter::await_suspend(std::coroutine_handle<> handle) {
+  m_waiter.operation.handle = handle;
+  m_waiter.operation.pool = &detail::CurrentPool();
+  if (m_stop.stop_possible()) {
+    m_callback.emplace(m_stop, CancelWait{this});
+  }
+  // Nothing may touch *this once queued: another thread can resume us
+  return m_event.Enqueue(m_waiter, m_stop);
+}
+
+TaskScope::~TaskScope() {
+  if (!m_joined) {
+    LOG(ERROR) << "TaskScope destroyed without Join(), waiting for its tasks";
+    try {
+      SyncWait(Join());
+    } catch (...) {
+      detail::LogSpawnedException(std::current_exception());
+    }
+  }
+}
+
+void TaskScope::Spawn(Task<void> task) {
+  m_active.fetch_add(1, std::memory_order_relaxed);
+  detail::RunDetached(detail::CurrentPool(), RunChild(*this, std::move(task)));
+}
+
+Task<void> TaskScope::RunChild(TaskScope& scope, Task<void> task) {
+  try {
+    co_await std::move(task);
+  } catch (...) {
+    {
+      std::lock_guard<std::mutex> lock(scope.m_error_mutex);
+      if (!scope.m_error) {
+        scope.m_error = std::current_exception();
+      }
+    }
+    scope.m_stop.request_stop();
+  }
+  // The scope may be gone once this returns
+  scope.Finish();
+}
+
+void TaskScope::Finish() {
+  if (m_active.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    m_done.Set();
+  }
+}
+
+Task<void> TaskScope::Join() {
+  m_joined = true;
+  Finish();
+  co_await m_done.Wait();
+  if (m_error) {
+    std::rethrow_exception(m_error);
+  }
+}
+
+}  // namespace comm
@@ -0,0 +1,359 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_coro_reactor.cpp
+ * @brief epoll/timerfd reactor behind SleepFor() and WaitReadable()
+ */
+
+#include "comm_coro_io.h"
+
+#include <glog/logging.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+#include "comm_terminate_signals.h"
+
+namespace comm {
+
+namespace {
+
+/// epoll_event.data.u64 values of the reactor's own descriptors
+constexpr std::uint64_t kTimerKey = ~std::uint64_t{0};
+constexpr std::uint64_t kWakeKey = ~std::uint64_t{0} - 1;
+
+constexpr int kMaxEvents = 64;
+
+std::int64_t MonotonicNowNs() {
+  timespec now{};
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<std::int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+std::error_code LastError() { return {errno, std::system_category()}; }
+
+/// One-shot registration for the directions somebody waits for
+std::uint32_t Interest(bool reader, bool writer) {
+  return static_cast<std::uint32_t>(EPOLLONESHOT) |
+         (reader ? static_cast<std::uint32_t>(EPOLLIN) : 0U) |
+         (writer ? static_cast<std::uint32_t>(EPOLLOUT) : 0U);
+}
+
+}  // namespace
+
+namespace detail {
+
+std::uint64_t ReactorAwaiter::Prepare(std::coroutine_handle<> handle) {
+  m_operation.handle = handle;
+  m_operation.pool = &CurrentPool();
+  const std::uint64_t id = Reactor::Instance().NextId();
+  // Registered first: a stop requested before the operation is added is
+  // seen by AddTimer()/AddFdWait(), one requested later finds it by id
+  if (m_stop.stop_possible()) {
+    m_callback.emplace(m_stop, CancelOperation{id});
+  }
+  return id;
+}
+
+}  // namespace detail
+
+Reactor::~Reactor() { Stop(); }
+
+std::uint64_t Reactor::NextId() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_next_id++;
+}
+
+std::size_t Reactor::GetPendingCount() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_pending.size();
+}
+
+std::error_code Reactor::StartLocked() {
+  if (m_thread.joinable()) {
+    return {};
+  }
+  m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  m_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  m_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  std::error_code result;
+  if (m_epoll_fd < 0 || m_timer_fd < 0 || m_wake_fd < 0) {
+    result = LastError();
+  } else {
+    epoll_event timer_event{};
+    timer_event.events = EPOLLIN;
+    timer_event.data.u64 = kTimerKey;
+    epoll_event wake_event{};
+    wake_event.events = EPOLLIN;
+    wake_event.data.u64 = kWakeKey;
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_timer_fd, &timer_event) != 0 ||
+        epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_wake_fd, &wake_event) != 0) {
+      result = LastError();
+    }
+  }
+
+  if (!result) {
+    try {
+      const TerminationSignalBlock block;
+      m_thread = std::thread(&Reactor::Loop, this);
+    } catch (const std::system_error& e) {
+      result = e.code();
+    }
+  }
+
+  if (result) {
+    LOG(ERROR) << "Failed to start coroutine reactor: " << result.message();
+    for (int* fd : {&m_epoll_fd, &m_timer_fd, &m_wake_fd}) {
+      if (*fd >= 0) {
+        close(*fd);
+        *fd = -1;
+      }
+    }
+  }
+  return result;
+}
+
+bool Reactor::AddTimer(std::uint64_t id, std::int64_t deadline_ns,
+                       detail::Operation& operation, const std::stop_token& stop) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_stopped) {
+    operation.result = make_error_code(CoroError::ShuttingDown);
+    return false;
+  }
+  if (stop.stop_requested()) {
+    operation.result = make_error_code(CoroError::Cancelled);
+    return false;
+  }
+  if (deadline_ns <= FastClock::NowNs()) {
+    operation.result = {};
+    return false;
+  }
+  if (auto result = StartLocked(); result) {
+    operation.result = result;
+    return false;
+  }
+
+  m_pending.emplace(id, Pending{&operation, deadline_ns, -1, false});
+  m_timers.emplace(deadline_ns, id);
+  if (m_armed_deadline_ns == 0 || deadline_ns < m_armed_deadline_ns) {
+    ArmTimerLocked();
+  }
+  return true;
+}
+
+bool Reactor::AddFdWait(std::uint64_t id, int fd, bool write,
+                        detail::Operation& operation, const std::stop_token& stop) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_stopped) {
+    operation.result = make_error_code(CoroError::ShuttingDown);
+    return false;
+  }
+  if (stop.stop_requested()) {
+    operation.result = make_error_code(CoroError::Cancelled);
+    return false;
+  }
+  if (auto result = StartLocked(); result) {
+    operation.result = result;
+    return false;
+  }
+
+  FdWaiters& waiters = m_fds[fd];
+  std::uint64_t& slot = write ? waiters.writer : waiters.reader;
+  if (slot != 0) {
+    operation.result = std::make_error_code(std::errc::device_or_resource_busy);
+    return false;
+  }
+  slot = id;
+  m_pending.emplace(id, Pending{&operation, 0, fd, write});
+
+  epoll_event event{};
+  event.events = Interest(waiters.reader != 0, waiters.writer != 0);
+  event.data.u64 = static_cast<std::uint64_t>(fd);
+  const bool registered = waiters.reader != 0 && waiters.writer != 0;
+  if (epoll_ctl(m_epoll_fd, registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &event) != 0) {
+    operation.result = LastError();
+    slot = 0;
+    m_pending.erase(id);
+    if (waiters.reader == 0 && waiters.writer == 0) {
+      m_fds.erase(fd);
+    }
+    return false;
+  }
+  return true;
+}
+
+void Reactor::Cancel(std::uint64_t id) {
+  detail::Operation* operation = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    operation = RemoveLocked(id);
+  }
+  if (operation != nullptr) {
+    operation->result = make_error_code(CoroError::Cancelled);
+    detail::Resume(*operation);
+  }
+}
+
+detail::Operation* Reactor::RemoveLocked(std::uint64_t id) {
+  auto it = m_pending.find(id);
+  if (it == m_pending.end()) {
+    return nullptr;
+  }
+  const Pending pending = it->second;
+  m_pending.erase(it);
+
+  if (pending.fd < 0) {
+    // The timerfd may still fire for it; that only costs a spurious wake-up
+    auto [first, last] = m_timers.equal_range(pending.deadline_ns);
+    for (auto timer = first; timer != last; ++timer) {
+      if (timer->second == id) {
+        m_timers.erase(timer);
+        break;
+      }
+    }
+  } else {
+    auto waiters = m_fds.find(pending.fd);
+    (pending.write ? waiters->second.writer : waiters->second.reader) = 0;
+    UpdateFdLocked(pending.fd);
+  }
+  return pending.operation;
+}
+
+void Reactor::UpdateFdLocked(int fd) {
+  auto waiters = m_fds.find(fd);
+  if (waiters->second.reader == 0 && waiters->second.writer == 0) {
+    epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    m_fds.erase(waiters);
+    return;
+  }
+  epoll_event event{};
+  event.events = Interest(waiters->second.reader != 0, waiters->second.writer != 0);
+  event.data.u64 = static_cast<std::uint64_t>(fd);
+  if (epoll_ctl(m_epoll_fd, EPOLL_CTL_MOD, fd, &event) != 0) {
+    LOG(WARNING) << "epoll_ctl(MOD) failed for fd " << fd << ": "
+                 << std::strerror(errno);
+  }
+}
+
+void Reactor::ArmTimerLocked() {
+  itimerspec spec{};
+  m_armed_deadline_ns = m_timers.empty() ? 0 : m_timers.begin()->first;
+  if (m_armed_deadline_ns != 0) {
+    spec.it_value.tv_sec = m_armed_deadline_ns / 1000000000;
+    spec.it_value.tv_nsec = m_armed_deadline_ns % 1000000000;
+  }
+  timerfd_settime(m_timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+void Reactor::ExpireTimersLocked(std::vector<detail::Operation*>& ready) {
+  // Compared with the clock the timerfd runs on
+  const std::int64_t now = MonotonicNowNs();
+  while (!m_timers.empty() && m_timers.begin()->first <= now) {
+    const std::uint64_t id = m_timers.begin()->second;
+    m_timers.erase(m_timers.begin());
+    auto pending = m_pending.find(id);
+    pending->second.operation->result = {};
+    ready.push_back(pending->second.operation);
+    m_pending.erase(pending);
+  }
+  ArmTimerLocked();
+}
+
+void Reactor::Loop() {
+  pthread_setname_np(pthread_self(), "comm_reactor");
+  std::vector<detail::Operation*> ready;
+  epoll_event events[kMaxEvents];
+  bool running = true;
+
+  while (running) {
+    const int count = epoll_wait(m_epoll_fd, events, kMaxEvents, -1);
+    if (count < 0 && errno != EINTR) {
+      LOG(ERROR) << "epoll_wait() failed: " << std::strerror(errno);
+    }
+
+    ready.clear();
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      for (int index = 0; index < count; ++index) {
+        const std::uint64_t key = events[index].data.u64;
+        if (key == kWakeKey) {
+          std::uint64_t value = 0;
+          (void)!read(m_wake_fd, &value, sizeof(value));
+        } else if (key == kTimerKey) {
+          std::uint64_t expirations = 0;
+          (void)!read(m_timer_fd, &expirations, sizeof(expirations));
+          ExpireTimersLocked(ready);
+        } else {
+          const int fd = static_cast<int>(key);
+          auto waiters = m_fds.find(fd);
+          if (waiters == m_fds.end()) {
+            continue;
+          }
+          const std::uint32_t flags = events[index].events;
+          const bool failed = (flags & (EPOLLERR | EPOLLHUP)) != 0;
+          for (const bool write : {false, true}) {
+            const std::uint64_t id = write ? waiters->second.writer : waiters->second.reader;
+            if (id != 0 && (failed || (flags & (write ? EPOLLOUT : EPOLLIN)) != 0)) {
+              (write ? waiters->second.writer : waiters->second.reader) = 0;
+              auto pending = m_pending.find(id);
+              pending->second.operation->result = {};
+              ready.push_back(pending->second.operation);
+              m_pending.erase(pending);
+            }
+          }
+          // Re-arm the one-shot registration for the remaining waiter
+          UpdateFdLocked(fd);
+        }
+      }
+
+      if (m_stopped) {
+        for (auto& [id, pending] : m_pending) {
+          pending.operation->result = make_error_code(CoroError::ShuttingDown);
+          ready.push_back(pending.operation);
+        }
+        for (const auto& [fd, waiters] : m_fds) {
+          epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        }
+        m_pending.clear();
+        m_timers.clear();
+        m_fds.clear();
+        running = false;
+      }
+    }
+
+    // Outside the lock: resuming may register new operations
+    for (detail::Operation* operation : ready) {
+      detail::Resume(*operation);
+    }
+  }
+}
+
+void Reactor::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stopped) {
+      return;
+    }
+    m_stopped = true;
+    if (!m_thread.joinable()) {
+      return;
+    }
+    const std::uint64_t one = 1;
+    (void)!write(m_wake_fd, &one, sizeof(one));
+  }
+  m_thread.join();
+  close(m_epoll_fd);
+  close(m_timer_fd);
+  close(m_wake_fd);
+  m_epoll_fd = m_timer_fd = m_wake_fd = -1;
+  LOG(INFO) << "Coroutine reactor stopped";
+}
+
+}  // namespace comm
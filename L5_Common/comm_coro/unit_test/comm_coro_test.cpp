@@ -0,0 +1,270 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_coro_test.cpp
+ * @brief Unit tests for coroutine tasks, timers, fd readiness and scopes
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "comm_coro.h"
+#include "comm_coro_io.h"
+
+namespace comm {
+namespace {
+
+using std::chrono::milliseconds;
+
+Task<int> Add(int a, int b) { co_return a + b; }
+
+Task<int> AddTwice(int value) {
+  const int once = co_await Add(value, value);
+  co_return co_await Add(once, once);
+}
+
+Task<int> Fail() {
+  throw std::runtime_error("task failed");
+  co_return 0;
+}
+
+Task<std::string> Text(std::string text) {
+  co_await SleepFor(milliseconds(1));
+  co_return text;
+}
+
+std::int64_t ElapsedMs(FastClock::time_point start) {
+  return std::chrono::duration_cast<milliseconds>(FastClock::now() - start).count();
+}
+
+}  // namespace
+
+TEST(CoroTaskTest, ReturnsValuesAndRethrowsExceptions) {
+  EXPECT_EQ(SyncWait(AddTwice(3)), 12);
+  EXPECT_THROW(SyncWait(Fail()), std::runtime_error);
+
+  // Never awaited: destroyed without running
+  Task<int> unused = Fail();
+  EXPECT_TRUE(unused.IsValid());
+}
+
+TEST(CoroTaskTest, ScheduleOnContinuesOnPool) {
+  ThreadPool pool("coro-pool", 2);
+  ASSERT_FALSE(pool.Start());
+  auto on_pool = [](ThreadPool& target) -> Task<ThreadPool*> {
+    co_await ScheduleOn(target);
+    co_return ThreadPool::Current();
+  };
+  EXPECT_EQ(SyncWait(on_pool(pool)), &pool);
+}
+
+TEST(CoroTimerTest, SleepForResumesAfterDelay) {
+  auto sleep = []() -> Task<std::error_code> {
+    co_return co_await SleepFor(milliseconds(30));
+  };
+  const auto start = FastClock::now();
+  EXPECT_FALSE(SyncWait(sleep()));
+  EXPECT_GE(ElapsedMs(start), 29);
+
+  // A deadline in the past completes without suspending
+  auto past = []() -> Task<std::error_code> {
+    co_return co_await SleepUntil(FastClock::now() - milliseconds(1));
+  };
+  EXPECT_FALSE(SyncWait(past()));
+}
+
+TEST(CoroTimerTest, TenThousandConcurrentSleepers) {
+  constexpr int kSleepers = 10000;
+  std::atomic<int> woken{0};
+  auto sleeper = [](int index, std::atomic<int>& counter) -> Task<void> {
+    if (!co_await SleepFor(milliseconds(1 + index % 50))) {
+      counter.fetch_add(1);
+    }
+  };
+  auto run = [&]() -> Task<void> {
+    TaskScope scope;
+    for (int index = 0; index < kSleepers; ++index) {
+      scope.Spawn(sleeper(index, woken));
+    }
+    co_await scope.Join();
+  };
+  const auto start = FastClock::now();
+  SyncWait(run());
+  EXPECT_EQ(woken.load(), kSleepers);
+  EXPECT_LT(ElapsedMs(start), 5000);
+  EXPECT_EQ(Reactor::Instance().GetPendingCount(), 0U);
+}
+
+TEST(CoroTimerTest, StopTokenCancelsSleep) {
+  std::stop_source stop;
+  auto sleep = [](std::stop_token token) -> Task<std::error_code> {
+    co_return co_await SleepFor(std::chrono::seconds(30), token);
+  };
+  std::thread canceller([&stop] {
+    std::this_thread::sleep_for(milliseconds(20));
+    stop.request_stop();
+  });
+  const auto start = FastClock::now();
+  EXPECT_EQ(SyncWait(sleep(stop.get_token())), CoroError::Cancelled);
+  EXPECT_LT(ElapsedMs(start), 5000);
+  canceller.join();
+
+  // Already requested: completes without registering
+  EXPECT_EQ(SyncWait(sleep(stop.get_token())), CoroError::Cancelled);
+}
+
+TEST(CoroIoTest, WaitsForPipeReadiness) {
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  auto read_one = [](int fd) -> Task<char> {
+    if (auto error = co_await WaitReadable(fd)) {
+      co_return '!';
+    }
+    char value = 0;
+    co_return read(fd, &value, 1) == 1 ? value : '?';
+  };
+  std::thread writer([fd = fds[1]] {
+    std::this_thread::sleep_for(milliseconds(20));
+    (void)!write(fd, "x", 1);
+  });
+  EXPECT_EQ(SyncWait(read_one(fds[0])), 'x');
+  writer.join();
+
+  auto writable = [](int fd) -> Task<std::error_code> {
+    co_return co_await WaitWritable(fd);
+  };
+  EXPECT_FALSE(SyncWait(writable(fds[1])));
+
+  // Cancelling a readiness wait
+  std::stop_source stop;
+  auto wait = [](int fd, std::stop_token token) -> Task<std::error_code> {
+    co_return co_await WaitReadable(fd, token);
+  };
+  std::thread canceller([&stop] {
+    std::this_thread::sleep_for(milliseconds(20));
+    stop.request_stop();
+  });
+  EXPECT_EQ(SyncWait(wait(fds[0], stop.get_token())), CoroError::Cancelled);
+  canceller.join();
+
+  // Not pollable (regular file): the epoll_ctl() error is returned
+  auto regular = []() -> Task<std::error_code> {
+    FILE* file = tmpfile();
+    auto result = co_await WaitReadable(fileno(file));
+    fclose(file);
+    co_return result;
+  };
+  EXPECT_EQ(SyncWait(regular()), std::errc::operation_not_permitted);
+
+  close(fds[0]);
+  close(fds[1]);
+  EXPECT_EQ(Reactor::Instance().GetPendingCount(), 0U);
+}
+
+TEST(CoroEventTest, SetResumesAllWaiters) {
+  AsyncEvent event;
+  std::atomic<int> resumed{0};
+  auto waiter = [](AsyncEvent& target, std::atomic<int>& counter) -> Task<void> {
+    if (!co_await target.Wait()) {
+      counter.fetch_add(1);
+    }
+  };
+  auto run = [&]() -> Task<void> {
+    TaskScope scope;
+    for (int index = 0; index < 100; ++index) {
+      scope.Spawn(waiter(event, resumed));
+    }
+    co_await SleepFor(milliseconds(10));
+    event.Set();
+    co_await scope.Join();
+  };
+  SyncWait(run());
+  EXPECT_EQ(resumed.load(), 100);
+
+  // Already set: no suspension; after Reset a stop token cancels the wait
+  EXPECT_FALSE(SyncWait([](AsyncEvent& target) -> Task<std::error_code> {
+    co_return co_await target.Wait();
+  }(event)));
+  event.Reset();
+  std::stop_source stop;
+  stop.request_stop();
+  EXPECT_EQ(SyncWait([](AsyncEvent& target, std::stop_token token) -> Task<std::error_code> {
+              co_return co_await target.Wait(token);
+            }(event, stop.get_token())),
+            CoroError::Cancelled);
+}
+
+TEST(CoroWhenAllTest, CollectsResultsInOrder) {
+  auto run = []() -> Task<std::vector<int>> {
+    std::vector<Task<int>> tasks;
+    for (int index = 0; index < 20; ++index) {
+      tasks.push_back(Add(index, 1));
+    }
+    co_return co_await WhenAll(std::move(tasks));
+  };
+  const std::vector<int> values = SyncWait(run());
+  ASSERT_EQ(values.size(), 20U);
+  for (int index = 0; index < 20; ++index) {
+    EXPECT_EQ(values[index], index + 1);
+  }
+
+  auto mixed = []() -> Task<std::tuple<int, std::string>> {
+    co_return co_await WhenAll(AddTwice(1), Text("done"));
+  };
+  const auto [number, text] = SyncWait(mixed());
+  EXPECT_EQ(number, 4);
+  EXPECT_EQ(text, "done");
+}
+
+TEST(CoroWhenAllTest, RunsAllTasksBeforeRethrowing) {
+  std::atomic<int> finished{0};
+  auto slow = [](std::atomic<int>& counter) -> Task<void> {
+    co_await SleepFor(milliseconds(20));
+    counter.fetch_add(1);
+  };
+  auto failing = []() -> Task<void> {
+    co_await Fail();
+  };
+  auto run = [&]() -> Task<void> {
+    std::vector<Task<void>> tasks;
+    tasks.push_back(slow(finished));
+    tasks.push_back(failing());
+    tasks.push_back(slow(finished));
+    co_await WhenAll(std::move(tasks));
+  };
+  EXPECT_THROW(SyncWait(run()), std::runtime_error);
+  EXPECT_EQ(finished.load(), 2);
+}
+
+TEST(CoroScopeTest, FirstExceptionCancelsSiblings) {
+  std::atomic<int> cancelled{0};
+  auto sibling = [](std::stop_token token, std::atomic<int>& counter) -> Task<void> {
+    if (co_await SleepFor(std::chrono::seconds(30), token) == CoroError::Cancelled) {
+      counter.fetch_add(1);
+    }
+  };
+  auto failing = []() -> Task<void> {
+    co_await SleepFor(milliseconds(10));
+    throw std::runtime_error("scope member failed");
+  };
+  auto run = [&]() -> Task<void> {
+    TaskScope scope;
+    scope.Spawn(sibling(scope.GetToken(), cancelled));
+    scope.Spawn(sibling(scope.GetToken(), cancelled));
+    scope.Spawn(failing());
+    co_await scope.Join();
+  };
+  const auto start = FastClock::now();
+  EXPECT_THROW(SyncWait(run()), std::runtime_error);
+  EXPECT_EQ(cancelled.load(), 2);
+  EXPECT_LT(ElapsedMs(start), 5000);
+}
+
+}  // namespace comm
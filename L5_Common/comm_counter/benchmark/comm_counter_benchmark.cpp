@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_counter_benchmark.cpp
+ * @brief Sharded counters and gauges against a single shared atomic
+ *
+ * Usage: modu-core-comm_counter_benchmark [--benchmark_filter=...]
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdint>
+
+#include "comm_counter.h"
+
+namespace {
+
+std::atomic<std::uint64_t> g_shared_counter{0};
+comm::ShardedCounter g_sharded_counter;
+
+std::atomic<std::int64_t> g_shared_max{0};
+comm::MaxGauge g_sharded_max;
+
+void BM_SharedAtomicAdd(benchmark::State& state) {
+  for (auto _ : state) {
+    g_shared_counter.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+BENCHMARK(BM_SharedAtomicAdd)->ThreadRange(1, 16)->UseRealTime();
+
+void BM_ShardedCounterAdd(benchmark::State& state) {
+  for (auto _ : state) {
+    g_sharded_counter.Add();
+  }
+}
+BENCHMARK(BM_ShardedCounterAdd)->ThreadRange(1, 16)->UseRealTime();
+
+void BM_ShardedCounterValue(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(g_sharded_counter.Value());
+  }
+}
+BENCHMARK(BM_ShardedCounterValue);
+
+/// Each thread records increasing values, so new maxima are frequent
+void BM_SharedAtomicMax(benchmark::State& state) {
+  std::int64_t value = 0;
+  for (auto _ : state) {
+    std::int64_t current = g_shared_max.load(std::memory_order_relaxed);
+    ++value;
+    while (value > current &&
+           !g_shared_max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+  }
+}
+BENCHMARK(BM_SharedAtomicMax)->ThreadRange(1, 16)->UseRealTime();
+
+void BM_MaxGaugeRecord(benchmark::State& state) {
+  std::int64_t value = 0;
+  for (auto _ : state) {
+    g_sharded_max.Record(++value);
+  }
+}
+BENCHMARK(BM_MaxGaugeRecord)->ThreadRange(1, 16)->UseRealTime();
+
+}  // namespace
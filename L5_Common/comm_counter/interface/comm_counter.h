@@ -0,0 +1,199 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_counter.h
+ * @brief Sharded counters and gauges for statistics updated from many threads
+ * @details A single atomic counter updated by every thread keeps its cache
+ *          line bouncing between cores. These types split the value into one
+ *          cache line per shard; each thread updates the shard it was
+ *          assigned on first use (round robin over the shards, one shard per
+ *          hardware thread) and readers fold the shards together. Updates
+ *          are cheap and uncontended, reads cost one load per shard.
+ *
+ * @code
+ * comm::ShardedCounter m_requests;
+ * comm::MaxGauge m_max_latency_us;
+ *
+ * m_requests.Add();                       // any thread
+ * m_max_latency_us.Record(elapsed_us);
+ *
+ * LOG(INFO) << m_requests.Value() << " requests, max "
+ *           << m_max_latency_us.Value() << " us";
+ * @endcode
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+namespace comm {
+
+namespace detail {
+
+/// Threads that have not touched a counter yet
+inline constexpr std::size_t kUnassignedCounterSlot = std::numeric_limits<std::size_t>::max();
+
+/// Shard slot of the calling thread, assigned on its first update
+inline thread_local std::size_t t_counter_slot = kUnassignedCounterSlot;
+
+/// Number of shards: hardware threads rounded up to a power of two, at most 64
+std::size_t CounterShardCount() noexcept;
+
+/// Give the calling thread the next slot, round robin
+std::size_t AssignCounterSlot() noexcept;
+
+inline std::size_t CounterSlot() noexcept {
+  const std::size_t slot = t_counter_slot;
+  return slot != kUnassignedCounterSlot ? slot : AssignCounterSlot();
+}
+
+/**
+ * @brief One value per shard, each on its own cache line
+ */
+template <typename T>
+class CounterShards {
+ public:
+  explicit CounterShards(T initial)
+      : m_mask(CounterShardCount() - 1), m_shards(new Shard[m_mask + 1]) {
+    Fill(initial);
+  }
+
+  std::atomic<T>& Local() noexcept { return m_shards[CounterSlot() & m_mask].value; }
+
+  template <typename F>
+  T Fold(T result, F&& combine) const noexcept {
+    for (std::size_t index = 0; index <= m_mask; ++index) {
+      result = combine(result, m_shards[index].value.load(std::memory_order_relaxed));
+    }
+    return result;
+  }
+
+  void Fill(T value) noexcept {
+    for (std::size_t index = 0; index <= m_mask; ++index) {
+      m_shards[index].value.store(value, std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  struct alignas(64) Shard {
+    std::atomic<T> value;
+  };
+
+  const std::size_t m_mask;
+  std::unique_ptr<Shard[]> m_shards;
+};
+
+/**
+ * @brief Extremum of the recorded values
+ * @tparam Better Better(a, b) is true if a replaces b
+ * @tparam kEmpty Shard value before anything is recorded
+ */
+template <typename Better, std::int64_t kEmpty>
+class ExtremumGauge {
+ public:
+  ExtremumGauge() : m_shards(kEmpty) {}
+  ExtremumGauge(const ExtremumGauge&) = delete;
+  ExtremumGauge& operator=(const ExtremumGauge&) = delete;
+
+  void Record(std::int64_t value) noexcept {
+    std::atomic<std::int64_t>& shard = m_shards.Local();
+    std::int64_t current = shard.load(std::memory_order_relaxed);
+    // Only a new extremum writes; the common case is a load and a compare
+    while (Better()(value, current) &&
+           !shard.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  /**
+   * @brief Extremum over all shards, 0 if nothing was recorded
+   */
+  std::int64_t Value() const noexcept {
+    const std::int64_t result = m_shards.Fold(kEmpty, [](std::int64_t best, std::int64_t value) {
+      return Better()(value, best) ? value : best;
+    });
+    return result == kEmpty ? 0 : result;
+  }
+
+  /**
+   * @brief Forget recorded values, e.g. after reporting an interval
+   * @note Values recorded concurrently may be kept or dropped
+   */
+  void Reset() noexcept { m_shards.Fill(kEmpty); }
+
+ private:
+  CounterShards<std::int64_t> m_shards;
+};
+
+struct Greater {
+  constexpr bool operator()(std::int64_t a, std::int64_t b) const noexcept { return a > b; }
+};
+
+struct Less {
+  constexpr bool operator()(std::int64_t a, std::int64_t b) const noexcept { return a < b; }
+};
+
+}  // namespace detail
+
+/**
+ * @class ShardedCounter
+ * @brief Monotonic event count
+ */
+class ShardedCounter {
+ public:
+  ShardedCounter() : m_shards(0) {}
+  ShardedCounter(const ShardedCounter&) = delete;
+  ShardedCounter& operator=(const ShardedCounter&) = delete;
+
+  void Add(std::uint64_t count = 1) noexcept {
+    m_shards.Local().fetch_add(count, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Sum over all shards
+   * @note Not a snapshot: concurrent Add() calls may or may not be included
+   */
+  std::uint64_t Value() const noexcept {
+    return m_shards.Fold(0, [](std::uint64_t sum, std::uint64_t value) { return sum + value; });
+  }
+
+ private:
+  detail::CounterShards<std::uint64_t> m_shards;
+};
+
+/**
+ * @class ShardedGauge
+ * @brief Value that goes up and down (in-flight requests, queued items)
+ * @note A shard may go negative when a thread decrements what another
+ *       incremented; only the sum is meaningful
+ */
+class ShardedGauge {
+ public:
+  ShardedGauge() : m_shards(0) {}
+  ShardedGauge(const ShardedGauge&) = delete;
+  ShardedGauge& operator=(const ShardedGauge&) = delete;
+
+  void Add(std::int64_t delta = 1) noexcept {
+    m_shards.Local().fetch_add(delta, std::memory_order_relaxed);
+  }
+  void Subtract(std::int64_t delta = 1) noexcept { Add(-delta); }
+
+  std::int64_t Value() const noexcept {
+    return m_shards.Fold(0, [](std::int64_t sum, std::int64_t value) { return sum + value; });
+  }
+
+ private:
+  detail::CounterShards<std::int64_t> m_shards;
+};
+
+/// Largest value recorded (peak latency, high-water mark)
+using MaxGauge = detail::ExtremumGauge<detail::Greater, std::numeric_limits<std::int64_t>::min()>;
+
+/// Smallest value recorded
+using MinGauge = detail::ExtremumGauge<detail::Less, std::numeric_limits<std::int64_t>::max()>;
+
+}  // namespace comm
@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_counter.cpp
+ * @brief Shard count and per-thread slot assignment
+ */
+
+#include "comm_counter.h"
+
+#include <algorithm>
+#include <bit>
+#include <thread>
+
+namespace comm {
+
+namespace detail {
+
+namespace {
+
+/// More shards only cost memory and read time
+constexpr std::size_t kMaxCounterShards = 64;
+
+std::atomic<std::size_t> g_next_counter_slot{0};
+
+}  // namespace
+
+std::size_t CounterShardCount() noexcept {
+  static const std::size_t count = [] {
+    const std::size_t threads = std::max(1U, std::thread::hardware_concurrency());
+    return std::min(std::bit_ceil(threads), kMaxCounterShards);
+  }();
+  return count;
+}
+
+std::size_t AssignCounterSlot() noexcept {
+  // Slots are masked per counter, so a thread keeps one slot for all of them
+  t_counter_slot = g_next_counter_slot.fetch_add(1, std::memory_order_relaxed) % kMaxCounterShards;
+  return t_counter_slot;
+}
+
+}  // namespace detail
+
+}  // namespace comm
@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_counter_test.cpp
+ * @brief Unit tests for sharded counters and gauges
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "comm_counter.h"
+
+namespace comm {
+namespace {
+
+constexpr int kThreads = 8;
+constexpr int kUpdates = 10000;
+
+template <typename F>
+void RunThreads(F&& body) {
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < kThreads; ++thread) {
+    threads.emplace_back(body, thread);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+TEST(CounterTest, ShardCountIsPowerOfTwo) {
+  const std::size_t count = detail::CounterShardCount();
+  EXPECT_GE(count, 1U);
+  EXPECT_LE(count, 64U);
+  EXPECT_EQ(count & (count - 1), 0U);
+}
+
+TEST(CounterTest, ThreadKeepsItsSlot) {
+  const std::size_t slot = detail::CounterSlot();
+  EXPECT_EQ(detail::CounterSlot(), slot);
+  std::size_t other = slot;
+  std::thread([&other] { other = detail::CounterSlot(); }).join();
+  EXPECT_NE(other, slot);  // round robin: the next thread gets the next slot
+}
+
+TEST(CounterTest, ConcurrentAddsAreNotLost) {
+  ShardedCounter counter;
+  RunThreads([&counter](int) {
+    for (int update = 0; update < kUpdates; ++update) {
+      counter.Add();
+    }
+  });
+  counter.Add(5);
+  EXPECT_EQ(counter.Value(), static_cast<std::uint64_t>(kThreads) * kUpdates + 5);
+}
+
+TEST(CounterTest, GaugeSumsAcrossThreads) {
+  ShardedGauge in_flight;
+  std::vector<std::thread> threads;
+  // One thread increments, another decrements the same amount
+  threads.emplace_back([&in_flight] {
+    for (int update = 0; update < kUpdates; ++update) {
+      in_flight.Add();
+    }
+  });
+  threads.emplace_back([&in_flight] {
+    for (int update = 0; update < kUpdates / 2; ++update) {
+      in_flight.Subtract(2);
+    }
+  });
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(in_flight.Value(), 0);
+  in_flight.Add(3);
+  EXPECT_EQ(in_flight.Value(), 3);
+}
+
+TEST(CounterTest, MaxAndMinGaugesTrackExtremes) {
+  MaxGauge max;
+  MinGauge min;
+  EXPECT_EQ(max.Value(), 0);  // nothing recorded
+  EXPECT_EQ(min.Value(), 0);
+
+  RunThreads([&max, &min](int thread) {
+    for (int update = 0; update < kUpdates; ++update) {
+      const std::int64_t value = thread * kUpdates + update - 1000;
+      max.Record(value);
+      min.Record(value);
+    }
+  });
+  EXPECT_EQ(max.Value(), kThreads * kUpdates - 1 - 1000);
+  EXPECT_EQ(min.Value(), -1000);
+
+  max.Reset();
+  min.Reset();
+  EXPECT_EQ(max.Value(), 0);
+  max.Record(-5);
+  min.Record(7);
+  EXPECT_EQ(max.Value(), -5);
+  EXPECT_EQ(min.Value(), 7);
+}
+
+}  // namespace
+}  // namespace comm
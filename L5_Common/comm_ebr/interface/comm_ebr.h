@@ -0,0 +1,161 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_ebr.h
+ * @brief Epoch-based memory reclamation for lock-free read paths
+ * @details Readers pin the current global epoch in a per-thread record for
+ *          the duration of a read section (a store and a fence, no shared
+ *          writes). Writers unlink an object and Retire() it into the list
+ *          of the current epoch. The epoch advances only when every pinned
+ *          reader has seen it, so objects retired two epochs ago can no
+ *          longer be referenced and are freed. A background thread advances
+ *          the epoch and runs the deleters; readers never wait.
+ *
+ * @code
+ * {
+ *   comm::Ebr::Guard guard = comm::Ebr::Instance().Pin();
+ *   const Route* route = m_routes.load(std::memory_order_acquire);
+ *   Use(*route);                        // not freed before guard is destroyed
+ * }
+ * Route* old = m_routes.exchange(new Route(...));
+ * comm::Ebr::Instance().Retire(old);    // deleted once all readers moved on
+ * @endcode
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace comm {
+
+/**
+ * @brief Counters reported by Ebr::GetStats()
+ */
+struct EbrStats {
+  std::uint64_t epoch{0};        ///< Current global epoch
+  std::uint64_t retired{0};      ///< Objects passed to Retire()
+  std::uint64_t reclaimed{0};    ///< Objects deleted
+  std::size_t pending{0};        ///< Retired, not deleted yet
+  std::size_t thread_records{0}; ///< Per-thread records (reused after thread exit)
+};
+
+/**
+ * @class Ebr
+ * @brief Process-wide epoch domain with background reclamation
+ */
+class Ebr {
+ public:
+  /**
+   * @brief Returns singleton instance of Ebr class
+   * @details Thread-safe initialization using Meyers' Singleton pattern
+   * @return Reference to the single Ebr instance
+   */
+  static Ebr& Instance() {
+    static Ebr instance;
+    return instance;
+  }
+
+  Ebr(const Ebr&) = delete;
+  Ebr& operator=(const Ebr&) = delete;
+
+  struct ThreadRecord;
+
+  /**
+   * @class Guard
+   * @brief Read section: objects reachable when it started stay allocated
+   * @details Guards nest; only the outermost one pins the epoch. Not
+   *          movable: a guard belongs to the thread that created it.
+   */
+  class Guard {
+   public:
+    ~Guard();
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+
+   private:
+    friend class Ebr;
+    explicit Guard(ThreadRecord& record);
+
+    ThreadRecord& m_record;
+  };
+
+  /**
+   * @brief Enter a read section on the calling thread
+   */
+  Guard Pin();
+
+  /**
+   * @brief True if the calling thread is inside a read section
+   */
+  bool IsPinned() const;
+
+  /**
+   * @brief Delete ptr once no read section can still reference it
+   * @details The object must already be unreachable for new readers.
+   *          After Stop() the object is freed synchronously.
+   */
+  void Retire(void* ptr, void (*deleter)(void*));
+
+  template <typename T>
+  void Retire(T* ptr) {
+    Retire(const_cast<void*>(static_cast<const void*>(ptr)),
+           [](void* object) { delete static_cast<T*>(object); });
+  }
+
+  /**
+   * @brief Wait until every read section active now has ended and free
+   *        everything retired before the call
+   * @note Must not be called inside a read section (it would wait for itself)
+   */
+  void Synchronize();
+
+  /**
+   * @brief Stop the background thread and free all retired objects
+   * @note Call when no read sections remain (comm::Main::deinit())
+   */
+  void Stop();
+
+  EbrStats GetStats() const;
+
+ private:
+  /// Entry of a retire list
+  struct Retired {
+    void* ptr;
+    void (*deleter)(void*);
+  };
+
+  Ebr() = default;
+  ~Ebr();
+
+  ThreadRecord& LocalRecord();
+  bool TryAdvanceLocked();
+  /// Advance the epoch if possible and delete what became unreachable
+  bool Reclaim();
+  void StartLocked();
+  void Loop();
+  static void Free(std::vector<Retired>& objects);
+
+  alignas(64) std::atomic<std::uint64_t> m_epoch{1};
+  /// Lock-free list of per-thread records; entries are never removed
+  std::atomic<ThreadRecord*> m_records{nullptr};
+  std::atomic<std::size_t> m_record_count{0};
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_wake;
+  /// Objects retired in epoch e wait in m_retired[e % 3]
+  std::array<std::vector<Retired>, 3> m_retired;
+  std::uint64_t m_retired_total{0};
+  std::uint64_t m_reclaimed_total{0};
+  std::thread m_thread;
+  bool m_stopped{false};
+};
+
+}  // namespace comm
@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_rcu.h
+ * @brief Read-copy-update value on top of epoch-based reclamation
+ * @details Rcu<T> holds an immutable snapshot of T. Readers get a pointer
+ *          to the current snapshot without locking or writing shared memory;
+ *          writers publish a new snapshot and retire the old one, which is
+ *          deleted once no reader can still hold it.
+ *
+ * @code
+ * comm::Rcu<RoutingTable> m_routes{RoutingTable{}};
+ *
+ * // Any number of readers, any thread
+ * auto routes = m_routes.Read();
+ * Forward(packet, routes->Lookup(packet.destination));
+ *
+ * // Writers
+ * m_routes.Update(BuildTable());
+ * m_routes.Modify([&](RoutingTable& table) { table.Add(route); });
+ * @endcode
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "comm_ebr.h"
+
+namespace comm {
+
+/**
+ * @class Rcu
+ * @tparam T Snapshot type; readers only get const access
+ */
+template <typename T>
+class Rcu {
+ public:
+  /**
+   * @class ReadPtr
+   * @brief Pointer to a snapshot, valid while the ReadPtr lives
+   * @note Keeps the thread in a read section: hold it briefly and do not
+   *       pass it to another thread
+   */
+  class ReadPtr {
+   public:
+    const T& operator*() const { return *m_snapshot; }
+    const T* operator->() const { return m_snapshot; }
+    const T* get() const { return m_snapshot; }
+
+   private:
+    friend class Rcu;
+    explicit ReadPtr(const std::atomic<T*>& current)
+        : m_guard(Ebr::Instance().Pin()),
+          m_snapshot(current.load(std::memory_order_acquire)) {}
+
+    Ebr::Guard m_guard;
+    const T* m_snapshot;
+  };
+
+  explicit Rcu(T initial = T()) : m_current(new T(std::move(initial))) {}
+
+  /**
+   * @note No reader may still use a snapshot of this Rcu
+   */
+  ~Rcu() { delete m_current.load(std::memory_order_relaxed); }
+
+  Rcu(const Rcu&) = delete;
+  Rcu& operator=(const Rcu&) = delete;
+
+  /**
+   * @brief Current snapshot (wait-free: a thread-local store and a fence)
+   */
+  ReadPtr Read() const { return ReadPtr(m_current); }
+
+  /**
+   * @brief Copy of the current snapshot
+   */
+  T Copy() const { return *Read(); }
+
+  /**
+   * @brief Publish value as the new snapshot
+   */
+  void Update(T value) {
+    std::lock_guard<std::mutex> lock(m_write_mutex);
+    Publish(new T(std::move(value)));
+  }
+
+  /**
+   * @brief Copy the current snapshot, let modify change the copy, publish it
+   * @details Writers are serialized, so concurrent Modify() calls never
+   *          lose each other's changes
+   */
+  template <typename F>
+  void Modify(F&& modify) {
+    std::lock_guard<std::mutex> lock(m_write_mutex);
+    auto next = std::make_unique<T>(*m_current.load(std::memory_order_relaxed));
+    std::forward<F>(modify)(*next);
+    Publish(next.release());
+  }
+
+ private:
+  void Publish(T* next) {
+    T* previous = m_current.exchange(next, std::memory_order_acq_rel);
+    Ebr::Instance().Retire(previous);
+  }
+
+  std::atomic<T*> m_current;
+  std::mutex m_write_mutex;
+};
+
+}  // namespace comm
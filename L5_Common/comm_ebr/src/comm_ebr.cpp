@@ -0,0 +1,277 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_ebr.cpp
+ * @brief Epoch domain: thread records, retire lists and reclamation thread
+ */
+
+#include "comm_ebr.h"
+
+#include <glog/logging.h>
+#include <pthread.h>
+
+#include <algorithm>
+#include <chrono>
+#include <system_error>
+
+#include "comm_terminate_signals.h"
+
+namespace comm {
+
+namespace {
+
+/// Epoch value of a thread outside any read section
+constexpr std::uint64_t kInactive = 0;
+
+/// Retired objects that wake the reclamation thread early
+constexpr std::size_t kReclaimThreshold = 256;
+
+/// Reclamation period while objects are pending
+constexpr auto kReclaimInterval = std::chrono::milliseconds(10);
+
+}  // namespace
+
+/**
+ * @brief Per-thread epoch, on its own cache line
+ */
+struct alignas(64) Ebr::ThreadRecord {
+  /// Pinned epoch, or kInactive; written by the owner, read by reclaimers
+  std::atomic<std::uint64_t> epoch{kInactive};
+  /// Guard nesting depth, owner thread only
+  std::uint32_t nesting{0};
+  std::atomic<bool> in_use{true};
+  ThreadRecord* next{nullptr};
+};
+
+namespace {
+
+/**
+ * @brief Returns the calling thread's record to the pool on thread exit
+ */
+struct RecordOwner {
+  Ebr::ThreadRecord* record{nullptr};
+
+  ~RecordOwner() {
+    if (record != nullptr) {
+      record->in_use.store(false, std::memory_order_release);
+    }
+  }
+};
+
+thread_local RecordOwner t_owner;
+
+}  // namespace
+
+Ebr::Guard::Guard(ThreadRecord& record) : m_record(record) {
+  if (m_record.nesting++ == 0) {
+    m_record.epoch.store(Ebr::Instance().m_epoch.load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+    // The pinned epoch must be visible before any shared pointer is read
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+}
+
+Ebr::Guard::~Guard() {
+  if (--m_record.nesting == 0) {
+    m_record.epoch.store(kInactive, std::memory_order_release);
+  }
+}
+
+Ebr::~Ebr() {
+  Stop();
+  ThreadRecord* record = m_records.exchange(nullptr);
+  while (record != nullptr) {
+    ThreadRecord* next = record->next;
+    delete record;
+    record = next;
+  }
+}
+
+Ebr::ThreadRecord& Ebr::LocalRecord() {
+  if (t_owner.record != nullptr) {
+    return *t_owner.record;
+  }
+  // Reuse the record of a thread that exited
+  for (ThreadRecord* record = m_records.load(std::memory_order_acquire); record != nullptr;
+       record = record->next) {
+    bool expected = false;
+    if (!record->in_use.load(std::memory_order_relaxed) &&
+        record->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+      t_owner.record = record;
+      return *record;
+    }
+  }
+  auto* record = new ThreadRecord();
+  record->next = m_records.load(std::memory_order_relaxed);
+  while (!m_records.compare_exchange_weak(record->next, record, std::memory_order_release,
+                                          std::memory_order_relaxed)) {
+  }
+  m_record_count.fetch_add(1, std::memory_order_relaxed);
+  t_owner.record = record;
+  return *record;
+}
+
+Ebr::Guard Ebr::Pin() { return Guard(LocalRecord()); }
+
+bool Ebr::IsPinned() const {
+  return t_owner.record != nullptr && t_owner.record->nesting != 0;
+}
+
+bool Ebr::TryAdvanceLocked() {
+  const std::uint64_t epoch = m_epoch.load(std::memory_order_relaxed);
+  // Pairs with the fence in Guard(): a reader either pinned an epoch this
+  // scan sees, or it will see every unlink made before this point
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  for (ThreadRecord* record = m_records.load(std::memory_order_acquire); record != nullptr;
+       record = record->next) {
+    const std::uint64_t pinned = record->epoch.load(std::memory_order_acquire);
+    if (pinned != kInactive && pinned != epoch) {
+      return false;  // a reader is still in the previous epoch
+    }
+  }
+  m_epoch.store(epoch + 1, std::memory_order_release);
+  return true;
+}
+
+bool Ebr::Reclaim() {
+  std::vector<Retired> unreachable;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!TryAdvanceLocked()) {
+      return false;
+    }
+    // Retired two epochs ago: (epoch - 2) % 3 == (epoch + 1) % 3
+    const std::uint64_t epoch = m_epoch.load(std::memory_order_relaxed);
+    unreachable.swap(m_retired[(epoch + 1) % 3]);
+    m_reclaimed_total += unreachable.size();
+  }
+  // Outside the lock: a deleter may retire further objects
+  Free(unreachable);
+  return true;
+}
+
+void Ebr::Free(std::vector<Retired>& objects) {
+  for (const Retired& object : objects) {
+    object.deleter(object.ptr);
+  }
+  objects.clear();
+}
+
+void Ebr::Retire(void* ptr, void (*deleter)(void*)) {
+  if (ptr == nullptr) {
+    return;
+  }
+  bool synchronous = false;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // The unlink of ptr happens before the epoch is read
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const std::uint64_t epoch = m_epoch.load(std::memory_order_relaxed);
+    auto& list = m_retired[epoch % 3];
+    list.push_back({ptr, deleter});
+    ++m_retired_total;
+    if (m_stopped) {
+      synchronous = true;
+    } else {
+      StartLocked();
+      // First object of the epoch (the thread may sleep without timeout)
+      // or enough to be worth reclaiming early
+      if (list.size() == 1 || list.size() >= kReclaimThreshold) {
+        m_wake.notify_one();
+      }
+    }
+  }
+  if (synchronous) {
+    Synchronize();
+  }
+}
+
+void Ebr::Synchronize() {
+  if (IsPinned()) {
+    LOG(ERROR) << "Ebr::Synchronize() called inside a read section, ignored";
+    return;
+  }
+  // Everything retired so far belongs to an epoch <= now; each advance
+  // frees the list two epochs back, so two advances free all of it
+  const std::uint64_t target = m_epoch.load(std::memory_order_acquire) + 2;
+  auto delay = std::chrono::microseconds(10);
+  while (m_epoch.load(std::memory_order_acquire) < target) {
+    if (!Reclaim()) {
+      std::this_thread::sleep_for(delay);
+      delay = std::min(delay * 2, std::chrono::microseconds(1000));
+    }
+  }
+}
+
+void Ebr::StartLocked() {
+  if (m_thread.joinable()) {
+    return;
+  }
+  try {
+    const TerminationSignalBlock block;
+    m_thread = std::thread(&Ebr::Loop, this);
+  } catch (const std::system_error& e) {
+    // Objects stay queued; Synchronize() and Stop() still free them
+    LOG(ERROR) << "Failed to create reclamation thread: " << e.what();
+  }
+}
+
+void Ebr::Loop() {
+  pthread_setname_np(pthread_self(), "comm_ebr");
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (!m_stopped) {
+    const bool pending =
+        !m_retired[0].empty() || !m_retired[1].empty() || !m_retired[2].empty();
+    if (pending) {
+      m_wake.wait_for(lock, kReclaimInterval);
+    } else {
+      m_wake.wait(lock);
+    }
+    if (m_stopped) {
+      break;
+    }
+    lock.unlock();
+    Reclaim();
+    lock.lock();
+  }
+}
+
+void Ebr::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stopped) {
+      return;
+    }
+    m_stopped = true;
+  }
+  m_wake.notify_all();
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+
+  // No read sections remain: everything retired can go
+  std::vector<Retired> remaining;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& list : m_retired) {
+      remaining.insert(remaining.end(), list.begin(), list.end());
+      list.clear();
+    }
+    m_reclaimed_total += remaining.size();
+  }
+  Free(remaining);
+}
+
+EbrStats Ebr::GetStats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  EbrStats stats;
+  stats.epoch = m_epoch.load(std::memory_order_relaxed);
+  stats.retired = m_retired_total;
+  stats.reclaimed = m_reclaimed_total;
+  stats.pending = m_retired[0].size() + m_retired[1].size() + m_retired[2].size();
+  stats.thread_records = m_record_count.load(std::memory_order_relaxed);
+  return stats;
+}
+
+}  // namespace comm
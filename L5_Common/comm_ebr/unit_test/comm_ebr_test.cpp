@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_ebr_test.cpp
+ * @brief Unit tests for Ebr and Rcu
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "comm_ebr.h"
+#include "comm_rcu.h"
+
+namespace comm {
+namespace {
+
+/// Counts live instances to catch leaked or early-deleted objects
+struct Tracked {
+  static inline std::atomic<int> live{0};
+  int value{0};
+
+  Tracked() { live.fetch_add(1); }
+  explicit Tracked(int v) : value(v) { live.fetch_add(1); }
+  Tracked(const Tracked& other) : value(other.value) { live.fetch_add(1); }
+  ~Tracked() {
+    value = -1;
+    live.fetch_sub(1);
+  }
+};
+
+/// Two fields a writer always keeps equal; a torn or freed snapshot breaks it
+struct Pair {
+  long first{0};
+  long second{0};
+};
+
+TEST(EbrTest, PinnedReaderDelaysReclamation) {
+  const int before = Tracked::live.load();
+  auto* object = new Tracked(7);
+  std::atomic<bool> pinned{false};
+  std::atomic<bool> release{false};
+
+  std::thread reader([&] {
+    auto guard = Ebr::Instance().Pin();
+    EXPECT_TRUE(Ebr::Instance().IsPinned());
+    pinned.store(true);
+    while (!release.load()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(object->value, 7);
+  });
+  while (!pinned.load()) {
+    std::this_thread::yield();
+  }
+
+  Ebr::Instance().Retire(object);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(Tracked::live.load(), before + 1);
+
+  release.store(true);
+  reader.join();
+  Ebr::Instance().Synchronize();
+  EXPECT_EQ(Tracked::live.load(), before);
+}
+
+TEST(EbrTest, GuardsNest) {
+  EXPECT_FALSE(Ebr::Instance().IsPinned());
+  {
+    auto outer = Ebr::Instance().Pin();
+    {
+      auto inner = Ebr::Instance().Pin();
+      EXPECT_TRUE(Ebr::Instance().IsPinned());
+    }
+    EXPECT_TRUE(Ebr::Instance().IsPinned());
+  }
+  EXPECT_FALSE(Ebr::Instance().IsPinned());
+}
+
+TEST(EbrTest, BackgroundThreadReclaims) {
+  const int before = Tracked::live.load();
+  for (int index = 0; index < 1000; ++index) {
+    Ebr::Instance().Retire(new Tracked(index));
+  }
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (Tracked::live.load() != before && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  EXPECT_EQ(Tracked::live.load(), before);
+}
+
+TEST(EbrTest, ThreadRecordsAreReused) {
+  // Records of exited threads are taken over by new ones
+  for (int round = 0; round < 3; ++round) {
+    std::thread([] { auto guard = Ebr::Instance().Pin(); }).join();
+  }
+  const std::size_t records = Ebr::Instance().GetStats().thread_records;
+  for (int round = 0; round < 10; ++round) {
+    std::thread([] { auto guard = Ebr::Instance().Pin(); }).join();
+  }
+  EXPECT_EQ(Ebr::Instance().GetStats().thread_records, records);
+}
+
+TEST(RcuTest, ReadersSeeConsistentSnapshots) {
+  Rcu<Pair> value;
+  std::atomic<bool> done{false};
+  std::atomic<long> reads{0};
+
+  std::vector<std::thread> readers;
+  for (int reader = 0; reader < 4; ++reader) {
+    readers.emplace_back([&] {
+      long last = 0;
+      while (!done.load(std::memory_order_relaxed)) {
+        auto snapshot = value.Read();
+        EXPECT_EQ(snapshot->first, snapshot->second);
+        EXPECT_GE(snapshot->first, last);  // never goes back in time
+        last = snapshot->first;
+        reads.fetch_add(1, std::memory_order_relaxed);
+      }
+    });
+  }
+  std::vector<std::thread> writers;
+  for (int writer = 0; writer < 2; ++writer) {
+    writers.emplace_back([&] {
+      for (int update = 0; update < 2000; ++update) {
+        value.Modify([](Pair& pair) {
+          ++pair.first;
+          ++pair.second;
+        });
+      }
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  done.store(true);
+  for (auto& reader : readers) {
+    reader.join();
+  }
+
+  const Pair last = value.Copy();
+  EXPECT_EQ(last.first, 4000);  // serialized writers lose no update
+  EXPECT_EQ(last.second, 4000);
+  EXPECT_GT(reads.load(), 0);
+}
+
+TEST(RcuTest, OldSnapshotsAreFreed) {
+  const int before = Tracked::live.load();
+  {
+    Rcu<Tracked> value(Tracked(0));
+    for (int update = 1; update <= 100; ++update) {
+      value.Update(Tracked(update));
+    }
+    EXPECT_EQ(value.Read()->value, 100);
+    Ebr::Instance().Synchronize();
+    EXPECT_EQ(Tracked::live.load(), before + 1);
+  }
+  EXPECT_EQ(Tracked::live.load(), before);
+}
+
+// Runs last in this binary: Stop() is final for the process-wide domain
+TEST(EbrShutdownTest, StopFreesEverythingAndRetiresSynchronously) {
+  const int before = Tracked::live.load();
+  for (int index = 0; index < 10; ++index) {
+    Ebr::Instance().Retire(new Tracked(index));
+  }
+  Ebr::Instance().Stop();
+  EXPECT_EQ(Tracked::live.load(), before);
+
+  Ebr::Instance().Retire(new Tracked(1));
+  EXPECT_EQ(Tracked::live.load(), before);
+  const EbrStats stats = Ebr::Instance().GetStats();
+  EXPECT_EQ(stats.pending, 0U);
+  EXPECT_EQ(stats.retired, stats.reclaimed);
+}
+
+}  // namespace
+}  // namespace comm
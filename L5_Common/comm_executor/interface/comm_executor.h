@@ -0,0 +1,289 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_executor.h
+ * @brief Work-stealing thread pools shared by all modules
+ * @details Every worker owns a Chase-Lev deque. Tasks submitted from a worker
+ *          go to its own deque (LIFO), tasks submitted from other threads go
+ *          to a shared injection queue. Idle workers take from the injection
+ *          queue, then steal from other workers (FIFO), then park on a futex.
+ *          Executor owns the process-wide "default" pool and named pools
+ *          configured in the [executor] section of config.toml.
+ *
+ * @code
+ * comm::Executor::Instance().Default().Submit([] { Compress(block); });
+ *
+ * if (auto* io = comm::Executor::Instance().GetPool("io")) {
+ *   io->Submit([request = std::move(request)]() mutable { Send(request); });
+ * }
+ * @endcode
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace comm {
+
+/**
+ * @brief Error codes for Executor module operations
+ */
+enum class ExecutorError {
+  Success = 0,               ///< Operation completed successfully
+  NotRunning = 1,            ///< Pool not started yet or already shut down
+  PoolExists = 2,            ///< A pool with this name already exists
+  ThreadCreationFailed = 3,  ///< Failed to create a worker thread
+  InvalidThreadCount = 4,    ///< Thread count outside 1..kMaxThreads
+};
+
+/**
+ * @brief Error category for Executor module errors
+ */
+class ExecutorErrorCategory : public std::error_category {
+ public:
+  const char* name() const noexcept override { return "comm_executor"; }
+  std::string message(int error_value) const override;
+};
+
+/**
+ * @brief Get the singleton instance of ExecutorErrorCategory
+ */
+const std::error_category& get_executor_error_category() noexcept;
+
+/**
+ * @brief Helper function to create std::error_code from ExecutorError
+ */
+inline std::error_code make_error_code(ExecutorError err) noexcept {
+  return {static_cast<int>(err), get_executor_error_category()};
+}
+
+struct ExecutorConfig;
+
+namespace detail {
+
+/**
+ * @brief Type-erased, move-only task (one allocation per Submit())
+ */
+class TaskNode {
+ public:
+  virtual ~TaskNode() = default;
+  virtual void Run() = 0;
+};
+
+template <typename F>
+class TaskImpl final : public TaskNode {
+ public:
+  explicit TaskImpl(F&& function) : m_function(std::move(function)) {}
+  explicit TaskImpl(const F& function) : m_function(function) {}
+  void Run() override { m_function(); }
+
+ private:
+  F m_function;
+};
+
+}  // namespace detail
+
+/**
+ * @brief Counters reported by ThreadPool::GetStats()
+ */
+struct ThreadPoolStats {
+  std::uint64_t submitted{0};  ///< Tasks accepted by Submit()
+  std::uint64_t executed{0};   ///< Tasks finished (including ones that threw)
+  std::uint64_t stolen{0};     ///< Tasks taken from another worker's deque
+  std::uint64_t parked{0};     ///< Times a worker went to sleep without work
+};
+
+/**
+ * @class ThreadPool
+ * @brief Fixed-size pool of work-stealing workers
+ * @note Tasks must not block for long (use a dedicated pool for blocking work)
+ */
+class ThreadPool {
+ public:
+  /// Upper bound for the thread count of one pool
+  static constexpr unsigned kMaxThreads = 1024;
+
+  /**
+   * @param name Pool name, also used for worker thread names (<name>-<index>)
+   * @param threads Number of workers, 0 = one per CPU
+   */
+  ThreadPool(std::string name, unsigned threads);
+
+  /**
+   * @brief Shut down (runs remaining tasks) and join the workers
+   */
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * @brief Spawn the workers
+   * @return std::error_code - empty on success, error code on failure
+   * @details Workers block TerminationSignals() (comm_terminate_signals.h)
+   *          so those signals keep going to Terminate's sigwait() thread
+   */
+  std::error_code Start();
+
+  /**
+   * @brief Queue a callable for execution on one of the workers
+   * @param task Callable taking no arguments; may be move-only
+   * @return ExecutorError::NotRunning before Start() and after Shutdown()
+   * @note Exceptions escaping a task are logged and swallowed
+   */
+  template <typename F>
+  std::error_code Submit(F&& task) {
+    using Task = detail::TaskImpl<std::decay_t<F>>;
+    return Enqueue(std::make_unique<Task>(std::forward<F>(task)));
+  }
+
+  /**
+   * @brief Block until every submitted task has finished
+   * @note Polls; must not be called from a worker of this pool
+   */
+  void WaitIdle() const;
+
+  /**
+   * @brief Stop accepting tasks from outside, run the queued ones, join
+   * @details Tasks running on the workers may still submit follow-up work,
+   *          which is executed before the workers exit. Idempotent.
+   */
+  void Shutdown();
+
+  const std::string& GetName() const { return m_name; }
+  unsigned GetThreadCount() const { return m_thread_count; }
+
+  /**
+   * @brief Sum of the per-worker counters (approximate while running)
+   */
+  ThreadPoolStats GetStats() const;
+
+  /**
+   * @brief Pool of the calling worker thread, nullptr on other threads
+   */
+  static ThreadPool* Current();
+
+  /**
+   * @brief Index (0..threads-1) of the calling worker, -1 on other threads
+   */
+  static int CurrentWorkerIndex();
+
+ private:
+  struct Worker;
+
+  std::error_code Enqueue(std::unique_ptr<detail::TaskNode> task);
+  void WorkerLoop(unsigned index);
+  detail::TaskNode* FindTask(Worker& self);
+  detail::TaskNode* TakeInjected(Worker& self);
+  bool HasQueuedWork() const;
+  bool IsQuiescent() const;
+  void Run(Worker& self, detail::TaskNode* task);
+  void Notify();
+
+  const std::string m_name;
+  const unsigned m_thread_count;
+
+  std::vector<std::unique_ptr<Worker>> m_workers;
+  std::vector<std::thread> m_threads;
+
+  /// Tasks submitted from outside the pool (protected by m_inject_mutex)
+  mutable std::mutex m_inject_mutex;
+  std::deque<detail::TaskNode*> m_injected;
+  std::atomic<std::size_t> m_injected_size{0};
+  std::atomic<std::uint64_t> m_injected_total{0};
+  bool m_accepting{true};
+
+  /// Futex word workers park on; bumped when work arrives while any sleep
+  std::atomic<std::uint32_t> m_wake_epoch{0};
+  std::atomic<int> m_sleepers{0};
+
+  std::atomic<bool> m_running{false};
+  std::atomic<bool> m_exit{false};
+  std::mutex m_lifecycle_mutex;
+};
+
+/**
+ * @class Executor
+ * @brief Process-wide registry of thread pools
+ * @details comm::Main::init() starts the pools from the [executor] section;
+ *          comm::Main::deinit() shuts them down after the higher layers are
+ *          deinitialized and before the log backend stops, so tasks queued
+ *          during shutdown still run and can still log.
+ */
+class Executor {
+ public:
+  /**
+   * @brief Returns singleton instance of Executor class
+   * @details Thread-safe initialization using Meyers' Singleton pattern
+   * @return Reference to the single Executor instance
+   */
+  static Executor& Instance() {
+    static Executor instance;
+    return instance;
+  }
+
+  Executor(const Executor&) = delete;
+  Executor& operator=(const Executor&) = delete;
+
+  /**
+   * @brief Create and start the default pool and the configured named pools
+   * @param config Parsed [executor] section
+   * @return First error encountered; pools started before it keep running
+   * @note Thread counts are applied once; changes need a restart
+   */
+  std::error_code Start(const ExecutorConfig& config);
+
+  /**
+   * @brief Create and start a named pool
+   * @param name Pool name, unique within the process
+   * @param threads Number of workers, 0 = one per CPU
+   * @return ExecutorError::PoolExists or the error from ThreadPool::Start()
+   */
+  std::error_code CreatePool(std::string_view name, unsigned threads);
+
+  /**
+   * @brief Find a pool by name
+   * @return Pool pointer (valid until process exit) or nullptr
+   */
+  ThreadPool* GetPool(std::string_view name);
+
+  /**
+   * @brief The shared CPU pool ("default")
+   * @details Created with one worker per CPU on first use if Start() was not
+   *          called (e.g. in tests and tools)
+   */
+  ThreadPool& Default();
+
+  /**
+   * @brief Shut down all pools, most recently created first
+   * @note Pools stay registered; Submit() on them returns NotRunning
+   */
+  void Shutdown();
+
+ private:
+  Executor() = default;
+  ~Executor();
+
+  std::mutex m_mutex;
+  std::vector<std::unique_ptr<ThreadPool>> m_pools;
+  std::atomic<ThreadPool*> m_default{nullptr};
+};
+
+}  // namespace comm
+
+namespace std {
+template <>
+struct is_error_code_enum<comm::ExecutorError> : true_type {};
+}  // namespace std
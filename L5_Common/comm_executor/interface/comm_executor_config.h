@@ -0,0 +1,41 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_executor_config.h
+ * @brief [executor] configuration section and its TOML serialization
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <toml.hpp>
+
+namespace comm {
+
+/**
+ * @brief Settings read from the [executor] section of config.toml
+ *
+ * @code
+ * [executor]
+ * threads = 0        # workers of the "default" pool, 0 = one per CPU
+ *
+ * [executor.pools]
+ * blocking_io = 4    # additional named pools and their worker counts
+ * @endcode
+ *
+ * @note Applied once at startup; changes take effect after a restart
+ */
+struct ExecutorConfig {
+  int threads = 0;
+  std::map<std::string, int> pools;
+
+  bool operator==(const ExecutorConfig&) const = default;
+};
+
+// ADL-based serialization functions
+void to_toml(toml::value& dest, const ExecutorConfig& value);
+void from_toml(const toml::value& src, ExecutorConfig& value);
+
+}  // namespace comm
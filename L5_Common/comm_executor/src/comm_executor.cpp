@@ -0,0 +1,457 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_executor.cpp
+ * @brief Work-stealing thread pool and pool registry
+ */
+
+#include "comm_executor.h"
+
+#include <glog/logging.h>
+#include <pthread.h>
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+
+#include "comm_executor_config.h"
+#include "comm_terminate_signals.h"
+#include "comm_work_deque.h"
+
+namespace comm {
+
+namespace {
+
+/// Most tasks moved from the injection queue to a worker deque at once
+constexpr std::size_t kMaxInjectedBatch = 32;
+
+/// Failed searches (with a yield in between) before a worker parks
+constexpr int kSpinRounds = 16;
+
+/// Pool and index of the calling worker thread
+thread_local ThreadPool* t_current_pool = nullptr;
+thread_local int t_worker_index = -1;
+
+/**
+ * @brief Counter written only by its owner thread
+ */
+void Increment(std::atomic<std::uint64_t>& counter) {
+  counter.store(counter.load(std::memory_order_relaxed) + 1,
+                std::memory_order_release);
+}
+
+}  // namespace
+
+// Error category implementation
+std::string ExecutorErrorCategory::message(int error_value) const {
+  switch (static_cast<ExecutorError>(error_value)) {
+    case ExecutorError::Success:
+      return "Success";
+    case ExecutorError::NotRunning:
+      return "Thread pool is not running";
+    case ExecutorError::PoolExists:
+      return "Thread pool with this name already exists";
+    case ExecutorError::ThreadCreationFailed:
+      return "Failed to create worker thread";
+    case ExecutorError::InvalidThreadCount:
+      return "Invalid thread count";
+    default:
+      return "Unknown executor error";
+  }
+}
+
+const std::error_category& get_executor_error_category() noexcept {
+  static ExecutorErrorCategory instance;
+  return instance;
+}
+
+/**
+ * @brief Per-worker deque and counters, each on its own cache lines
+ */
+struct alignas(64) ThreadPool::Worker {
+  WorkDeque<detail::TaskNode> deque;
+
+  /// Written by the owning worker only (submitted: its own Submit() calls)
+  alignas(64) std::atomic<std::uint64_t> submitted{0};
+  std::atomic<std::uint64_t> executed{0};
+  std::atomic<std::uint64_t> stolen{0};
+  std::atomic<std::uint64_t> parked{0};
+
+  /// Victim selection (xorshift), owner only
+  std::uint64_t random;
+};
+
+ThreadPool::ThreadPool(std::string name, unsigned threads)
+    : m_name(std::move(name)),
+      m_thread_count(threads != 0 ? threads
+                                  : std::max(1U, std::thread::hardware_concurrency())) {
+  m_workers.reserve(m_thread_count);
+  for (unsigned index = 0; index < m_thread_count; ++index) {
+    auto worker = std::make_unique<Worker>();
+    worker->random = 0x9E3779B97F4A7C15ULL * (index + 1);
+    m_workers.push_back(std::move(worker));
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  Shutdown();
+  for (detail::TaskNode* task : m_injected) {
+    delete task;
+  }
+}
+
+std::error_code ThreadPool::Start() {
+  std::lock_guard<std::mutex> lock(m_lifecycle_mutex);
+  if (m_thread_count > kMaxThreads) {
+    return make_error_code(ExecutorError::InvalidThreadCount);
+  }
+  if (m_running.load(std::memory_order_relaxed)) {
+    return {};
+  }
+  if (m_exit.load(std::memory_order_relaxed)) {
+    return make_error_code(ExecutorError::NotRunning);
+  }
+
+  // Workers inherit the mask, even if the pool starts before Terminate
+  std::error_code result;
+  try {
+    const TerminationSignalBlock block;
+    m_threads.reserve(m_thread_count);
+    for (unsigned index = 0; index < m_thread_count; ++index) {
+      m_threads.emplace_back(&ThreadPool::WorkerLoop, this, index);
+    }
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Failed to create worker thread for pool '" << m_name
+               << "': " << e.what();
+    result = make_error_code(ExecutorError::ThreadCreationFailed);
+  }
+
+  if (result) {
+    m_exit.store(true, std::memory_order_seq_cst);
+    m_wake_epoch.fetch_add(1, std::memory_order_release);
+    m_wake_epoch.notify_all();
+    for (auto& thread : m_threads) {
+      thread.join();
+    }
+    m_threads.clear();
+    return result;
+  }
+
+  m_running.store(true, std::memory_order_release);
+  LOG(INFO) << "Thread pool '" << m_name << "' started with " << m_thread_count
+            << " workers";
+  return {};
+}
+
+std::error_code ThreadPool::Enqueue(std::unique_ptr<detail::TaskNode> task) {
+  if (!m_running.load(std::memory_order_acquire)) {
+    return make_error_code(ExecutorError::NotRunning);
+  }
+
+  if (t_current_pool == this) {
+    // Follow-up work stays on this worker; others steal it when idle
+    Worker& self = *m_workers[static_cast<std::size_t>(t_worker_index)];
+    Increment(self.submitted);
+    self.deque.Push(task.release());
+  } else {
+    std::lock_guard<std::mutex> lock(m_inject_mutex);
+    if (!m_accepting) {
+      return make_error_code(ExecutorError::NotRunning);
+    }
+    m_injected_total.fetch_add(1, std::memory_order_release);
+    m_injected.push_back(task.release());
+    m_injected_size.store(m_injected.size(), std::memory_order_relaxed);
+  }
+  Notify();
+  return {};
+}
+
+void ThreadPool::Notify() {
+  // Pairs with the fence in WorkerLoop(): either this thread sees the
+  // sleeper, or the sleeper sees the new work before it waits
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (m_sleepers.load(std::memory_order_relaxed) > 0) {
+    m_wake_epoch.fetch_add(1, std::memory_order_release);
+    m_wake_epoch.notify_one();
+  }
+}
+
+void ThreadPool::WorkerLoop(unsigned index) {
+  const std::string thread_name =
+      (m_name + "-" + std::to_string(index)).substr(0, 15);
+  pthread_setname_np(pthread_self(), thread_name.c_str());
+  t_current_pool = this;
+  t_worker_index = static_cast<int>(index);
+  Worker& self = *m_workers[index];
+
+  int failed_rounds = 0;
+  while (true) {
+    if (detail::TaskNode* task = FindTask(self)) {
+      failed_rounds = 0;
+      Run(self, task);
+      continue;
+    }
+    if (++failed_rounds < kSpinRounds) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    // Announce the sleep, then re-check: see Notify()
+    m_sleepers.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const std::uint32_t epoch = m_wake_epoch.load(std::memory_order_acquire);
+    const bool exit = m_exit.load(std::memory_order_seq_cst);
+    if (!exit && !HasQueuedWork()) {
+      Increment(self.parked);
+      m_wake_epoch.wait(epoch, std::memory_order_acquire);
+    }
+    m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+    failed_rounds = 0;
+    if (exit && !HasQueuedWork()) {
+      break;
+    }
+  }
+
+  t_current_pool = nullptr;
+  t_worker_index = -1;
+}
+
+detail::TaskNode* ThreadPool::FindTask(Worker& self) {
+  if (detail::TaskNode* task = self.deque.Pop()) {
+    return task;
+  }
+  if (detail::TaskNode* task = TakeInjected(self)) {
+    return task;
+  }
+
+  // Steal from the others, starting at a random victim
+  const std::size_t count = m_workers.size();
+  self.random ^= self.random << 13;
+  self.random ^= self.random >> 7;
+  self.random ^= self.random << 17;
+  const std::size_t start = self.random % count;
+  for (std::size_t offset = 0; offset < count; ++offset) {
+    Worker& victim = *m_workers[(start + offset) % count];
+    if (&victim == &self) {
+      continue;
+    }
+    if (detail::TaskNode* task = victim.deque.Steal()) {
+      Increment(self.stolen);
+      // More work may be waiting: let a sleeping worker look for it
+      if (victim.deque.Size() > 0) {
+        Notify();
+      }
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+detail::TaskNode* ThreadPool::TakeInjected(Worker& self) {
+  if (m_injected_size.load(std::memory_order_relaxed) == 0) {
+    return nullptr;
+  }
+  detail::TaskNode* first = nullptr;
+  bool more = false;
+  {
+    std::lock_guard<std::mutex> lock(m_inject_mutex);
+    if (m_injected.empty()) {
+      return nullptr;
+    }
+    // A fair share, so one worker does not drain the queue for everyone
+    const std::size_t batch =
+        std::min({kMaxInjectedBatch, m_injected.size(),
+                  m_injected.size() / m_thread_count + 1});
+    first = m_injected.front();
+    m_injected.pop_front();
+    for (std::size_t taken = 1; taken < batch; ++taken) {
+      self.deque.Push(m_injected.front());
+      m_injected.pop_front();
+    }
+    m_injected_size.store(m_injected.size(), std::memory_order_relaxed);
+    more = !m_injected.empty();
+  }
+  if (more) {
+    Notify();
+  }
+  return first;
+}
+
+bool ThreadPool::HasQueuedWork() const {
+  if (m_injected_size.load(std::memory_order_relaxed) != 0) {
+    return true;
+  }
+  return std::any_of(m_workers.begin(), m_workers.end(),
+                     [](const auto& worker) { return worker->deque.Size() > 0; });
+}
+
+void ThreadPool::Run(Worker& self, detail::TaskNode* task) {
+  try {
+    task->Run();
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Exception in task on thread pool '" << m_name
+               << "': " << e.what();
+  } catch (...) {
+    LOG(ERROR) << "Unknown exception in task on thread pool '" << m_name << "'";
+  }
+  delete task;
+  Increment(self.executed);
+}
+
+bool ThreadPool::IsQuiescent() const {
+  // Executed counts are read first: a task's follow-up submissions are
+  // counted before it counts as executed, so equal sums mean nothing was
+  // queued or running at the time the executed counts were read
+  std::uint64_t executed = 0;
+  for (const auto& worker : m_workers) {
+    executed += worker->executed.load(std::memory_order_acquire);
+  }
+  std::uint64_t submitted = m_injected_total.load(std::memory_order_acquire);
+  for (const auto& worker : m_workers) {
+    submitted += worker->submitted.load(std::memory_order_acquire);
+  }
+  return executed == submitted;
+}
+
+void ThreadPool::WaitIdle() const {
+  auto delay = std::chrono::microseconds(50);
+  while (!IsQuiescent()) {
+    std::this_thread::sleep_for(delay);
+    delay = std::min(delay * 2, std::chrono::microseconds(2000));
+  }
+}
+
+void ThreadPool::Shutdown() {
+  std::lock_guard<std::mutex> lock(m_lifecycle_mutex);
+  {
+    std::lock_guard<std::mutex> inject_lock(m_inject_mutex);
+    m_accepting = false;
+  }
+  if (!m_running.load(std::memory_order_relaxed)) {
+    m_exit.store(true, std::memory_order_seq_cst);
+    return;
+  }
+
+  // Queued tasks and the follow-up work they submit run to completion
+  WaitIdle();
+
+  m_exit.store(true, std::memory_order_seq_cst);
+  m_wake_epoch.fetch_add(1, std::memory_order_release);
+  m_wake_epoch.notify_all();
+  for (auto& thread : m_threads) {
+    thread.join();
+  }
+  m_threads.clear();
+  m_running.store(false, std::memory_order_release);
+
+  const ThreadPoolStats stats = GetStats();
+  LOG(INFO) << "Thread pool '" << m_name << "' stopped after " << stats.executed
+            << " tasks (" << stats.stolen << " stolen)";
+}
+
+ThreadPoolStats ThreadPool::GetStats() const {
+  ThreadPoolStats stats;
+  stats.submitted = m_injected_total.load(std::memory_order_relaxed);
+  for (const auto& worker : m_workers) {
+    stats.submitted += worker->submitted.load(std::memory_order_relaxed);
+    stats.executed += worker->executed.load(std::memory_order_relaxed);
+    stats.stolen += worker->stolen.load(std::memory_order_relaxed);
+    stats.parked += worker->parked.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+ThreadPool* ThreadPool::Current() { return t_current_pool; }
+
+int ThreadPool::CurrentWorkerIndex() { return t_worker_index; }
+
+Executor::~Executor() { Shutdown(); }
+
+std::error_code Executor::Start(const ExecutorConfig& config) {
+  std::error_code first_error;
+  auto create = [&](const std::string& name, int threads) {
+    std::error_code result =
+        threads < 0 ? make_error_code(ExecutorError::InvalidThreadCount)
+                    : CreatePool(name, static_cast<unsigned>(threads));
+    if (result) {
+      LOG(ERROR) << "Failed to start thread pool '" << name
+                 << "': " << result.message();
+      if (!first_error) {
+        first_error = result;
+      }
+    }
+  };
+
+  create("default", config.threads);
+  for (const auto& [name, threads] : config.pools) {
+    create(name, threads);
+  }
+  return first_error;
+}
+
+std::error_code Executor::CreatePool(std::string_view name, unsigned threads) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (const auto& pool : m_pools) {
+    if (pool->GetName() == name) {
+      return make_error_code(ExecutorError::PoolExists);
+    }
+  }
+  auto pool = std::make_unique<ThreadPool>(std::string(name), threads);
+  if (auto result = pool->Start(); result) {
+    return result;
+  }
+  if (name == "default") {
+    m_default.store(pool.get(), std::memory_order_release);
+  }
+  m_pools.push_back(std::move(pool));
+  return {};
+}
+
+ThreadPool* Executor::GetPool(std::string_view name) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (const auto& pool : m_pools) {
+    if (pool->GetName() == name) {
+      return pool.get();
+    }
+  }
+  return nullptr;
+}
+
+ThreadPool& Executor::Default() {
+  if (ThreadPool* pool = m_default.load(std::memory_order_acquire)) {
+    return *pool;
+  }
+  if (auto result = CreatePool("default", 0);
+      result && result != ExecutorError::PoolExists) {
+    LOG(ERROR) << "Failed to start default thread pool: " << result.message();
+  }
+  ThreadPool* pool = m_default.load(std::memory_order_acquire);
+  if (pool == nullptr) {
+    // Thread creation failed: register a stopped pool so Submit() reports it
+    std::lock_guard<std::mutex> lock(m_mutex);
+    pool = m_default.load(std::memory_order_relaxed);
+    if (pool == nullptr) {
+      m_pools.push_back(std::make_unique<ThreadPool>("default", 1));
+      pool = m_pools.back().get();
+      m_default.store(pool, std::memory_order_release);
+    }
+  }
+  return *pool;
+}
+
+void Executor::Shutdown() {
+  std::vector<ThreadPool*> pools;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_pools.rbegin(); it != m_pools.rend(); ++it) {
+      pools.push_back(it->get());
+    }
+  }
+  // Outside the lock: tasks still draining may look up pools
+  for (ThreadPool* pool : pools) {
+    pool->Shutdown();
+  }
+}
+
+}  // namespace comm
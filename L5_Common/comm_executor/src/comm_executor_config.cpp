@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_executor_config.cpp
+ * @brief Implementation of ExecutorConfig serialization
+ */
+
+#include "comm_executor_config.h"
+
+#include <glog/logging.h>
+
+namespace comm {
+
+void to_toml(toml::value& dest, const ExecutorConfig& value) {
+  dest["threads"] = value.threads;
+  toml::value pools(toml::table{});
+  for (const auto& [name, threads] : value.pools) {
+    pools[name] = threads;
+  }
+  dest["pools"] = pools;
+}
+
+void from_toml(const toml::value& src, ExecutorConfig& value) {
+  // Use default-constructed struct as source of default values (created once)
+  static const ExecutorConfig defaults;
+
+  try {
+    value.threads = toml::find_or(src, "threads", defaults.threads);
+    value.pools = toml::find_or(src, "pools", defaults.pools);
+
+    LOG(INFO) << "Loaded ExecutorConfig";
+    LOG(INFO) << "  threads: " << value.threads;
+    for (const auto& [name, threads] : value.pools) {
+      LOG(INFO) << "  pools." << name << ": " << threads;
+    }
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Error parsing ExecutorConfig: " << e.what();
+    LOG(WARNING) << "Using default values";
+    value = defaults;
+  }
+}
+
+}  // namespace comm
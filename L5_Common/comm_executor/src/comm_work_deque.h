@@ -0,0 +1,153 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_work_deque.h
+ * @brief Chase-Lev work-stealing deque
+ * @details The owning worker pushes and pops at the bottom (LIFO, cache-warm
+ *          work first); other workers steal from the top (FIFO, oldest and
+ *          usually largest work). Follows "Correct and Efficient
+ *          Work-Stealing for Weak Memory Models" (Le et al., PPoPP 2013).
+ *          The buffer grows on demand; old buffers are kept until the deque
+ *          is destroyed because a thief may still be reading them.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace comm {
+
+/**
+ * @class WorkDeque
+ * @brief Single-owner, multi-thief deque of pointers
+ * @tparam T Pointee type; the deque stores T* and never owns them
+ */
+template <typename T>
+class WorkDeque {
+ public:
+  explicit WorkDeque(std::size_t initial_capacity = 256) {
+    std::size_t capacity = 1;
+    while (capacity < initial_capacity) {
+      capacity <<= 1;
+    }
+    m_buffers.push_back(std::make_unique<Buffer>(capacity));
+    m_buffer.store(m_buffers.back().get(), std::memory_order_relaxed);
+  }
+
+  WorkDeque(const WorkDeque&) = delete;
+  WorkDeque& operator=(const WorkDeque&) = delete;
+
+  /**
+   * @brief Add an item at the bottom (owner thread only)
+   */
+  void Push(T* item) {
+    const std::int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+    const std::int64_t top = m_top.load(std::memory_order_acquire);
+    Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+    if (bottom - top > buffer->mask) {
+      buffer = Grow(buffer, top, bottom);
+    }
+    buffer->Put(bottom, item);
+    // Release publishes the item (and what it points to) to thieves
+    m_bottom.store(bottom + 1, std::memory_order_release);
+  }
+
+  /**
+   * @brief Take the most recently pushed item (owner thread only)
+   * @return nullptr when empty or the last item was stolen concurrently
+   */
+  T* Pop() {
+    const std::int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+    Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+    m_bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t top = m_top.load(std::memory_order_relaxed);
+
+    if (top > bottom) {
+      m_bottom.store(bottom + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    T* item = buffer->Get(bottom);
+    if (top == bottom) {
+      // Last item: race the thieves for it
+      if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                         std::memory_order_relaxed)) {
+        item = nullptr;
+      }
+      m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  /**
+   * @brief Take the oldest item (any thread)
+   * @return nullptr when empty or another thread won the race
+   */
+  T* Steal() {
+    std::int64_t top = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const std::int64_t bottom = m_bottom.load(std::memory_order_acquire);
+    if (top >= bottom) {
+      return nullptr;
+    }
+    Buffer* buffer = m_buffer.load(std::memory_order_acquire);
+    T* item = buffer->Get(top);
+    if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                       std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return item;
+  }
+
+  /**
+   * @brief Approximate number of items (any thread)
+   */
+  std::int64_t Size() const {
+    const std::int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+    const std::int64_t top = m_top.load(std::memory_order_relaxed);
+    return bottom > top ? bottom - top : 0;
+  }
+
+ private:
+  struct Buffer {
+    explicit Buffer(std::size_t capacity)
+        : mask(static_cast<std::int64_t>(capacity) - 1),
+          items(std::make_unique<std::atomic<T*>[]>(capacity)) {}
+
+    T* Get(std::int64_t index) const {
+      return items[index & mask].load(std::memory_order_relaxed);
+    }
+    void Put(std::int64_t index, T* item) {
+      items[index & mask].store(item, std::memory_order_relaxed);
+    }
+
+    std::int64_t mask;
+    std::unique_ptr<std::atomic<T*>[]> items;
+  };
+
+  Buffer* Grow(Buffer* old_buffer, std::int64_t top, std::int64_t bottom) {
+    auto grown = std::make_unique<Buffer>(static_cast<std::size_t>(old_buffer->mask + 1) * 2);
+    for (std::int64_t index = top; index < bottom; ++index) {
+      grown->Put(index, old_buffer->Get(index));
+    }
+    Buffer* buffer = grown.get();
+    m_buffers.push_back(std::move(grown));
+    m_buffer.store(buffer, std::memory_order_release);
+    return buffer;
+  }
+
+  /// Thieves and the owner contend on top, only the owner writes bottom
+  alignas(64) std::atomic<std::int64_t> m_top{0};
+  alignas(64) std::atomic<std::int64_t> m_bottom{0};
+  std::atomic<Buffer*> m_buffer{nullptr};
+
+  /// Every buffer ever used (owner thread only), freed with the deque
+  std::vector<std::unique_ptr<Buffer>> m_buffers;
+};
+
+}  // namespace comm
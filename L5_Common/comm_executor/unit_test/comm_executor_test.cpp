@@ -0,0 +1,224 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_executor_test.cpp
+ * @brief Unit tests for the work-stealing deque, ThreadPool and Executor
+ */
+
+#include <gtest/gtest.h>
+#include <pthread.h>
+
+#include <atomic>
+#include <csignal>
+#include <latch>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "comm_executor.h"
+#include "comm_work_deque.h"
+
+namespace comm {
+namespace {
+
+/// Binary tree of tasks: every task below max_depth submits two children
+void Fork(ThreadPool& pool, int depth, int max_depth, std::atomic<int>& leaves) {
+  if (depth == max_depth) {
+    leaves.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  for (int child = 0; child < 2; ++child) {
+    EXPECT_FALSE(pool.Submit([&pool, depth, max_depth, &leaves] {
+      Fork(pool, depth + 1, max_depth, leaves);
+    }));
+  }
+}
+
+}  // namespace
+
+TEST(WorkDequeTest, OwnerPopsLifoThievesStealFifo) {
+  WorkDeque<int> deque(2);
+  int items[5] = {0, 1, 2, 3, 4};
+  for (int& item : items) {
+    deque.Push(&item);  // grows past the initial capacity
+  }
+  EXPECT_EQ(deque.Size(), 5);
+  EXPECT_EQ(deque.Steal(), &items[0]);
+  EXPECT_EQ(deque.Pop(), &items[4]);
+  EXPECT_EQ(deque.Steal(), &items[1]);
+  EXPECT_EQ(deque.Pop(), &items[3]);
+  EXPECT_EQ(deque.Pop(), &items[2]);
+  EXPECT_EQ(deque.Pop(), nullptr);
+  EXPECT_EQ(deque.Steal(), nullptr);
+}
+
+TEST(WorkDequeTest, EveryItemIsTakenExactlyOnce) {
+  constexpr int kItems = 200000;
+  constexpr int kThieves = 3;
+  std::vector<int> items(kItems);
+  std::vector<std::atomic<int>> taken(kItems);
+  WorkDeque<int> deque(16);
+  std::atomic<bool> done{false};
+
+  auto take = [&](int* item) { taken[item - items.data()].fetch_add(1); };
+  std::vector<std::thread> thieves;
+  for (int thief = 0; thief < kThieves; ++thief) {
+    thieves.emplace_back([&] {
+      while (!done.load() || deque.Size() > 0) {
+        if (int* item = deque.Steal()) {
+          take(item);
+        }
+      }
+    });
+  }
+  for (int index = 0; index < kItems; ++index) {
+    deque.Push(&items[index]);
+    if (index % 3 == 0) {
+      if (int* item = deque.Pop()) {
+        take(item);
+      }
+    }
+  }
+  while (int* item = deque.Pop()) {
+    take(item);
+  }
+  done.store(true);
+  for (auto& thief : thieves) {
+    thief.join();
+  }
+
+  for (int index = 0; index < kItems; ++index) {
+    ASSERT_EQ(taken[index].load(), 1) << "item " << index;
+  }
+}
+
+TEST(ThreadPoolTest, RunsSubmittedTasks) {
+  ThreadPool pool("test-run", 4);
+  ASSERT_FALSE(pool.Start());
+  std::atomic<int> count{0};
+  for (int i = 0; i < 10000; ++i) {
+    ASSERT_FALSE(pool.Submit([&count] { count.fetch_add(1); }));
+  }
+  pool.WaitIdle();
+  EXPECT_EQ(count.load(), 10000);
+
+  const ThreadPoolStats stats = pool.GetStats();
+  EXPECT_EQ(stats.submitted, 10000U);
+  EXPECT_EQ(stats.executed, 10000U);
+}
+
+TEST(ThreadPoolTest, RejectsTasksWhenNotRunning) {
+  ThreadPool pool("test-reject", 1);
+  EXPECT_EQ(pool.Submit([] {}), ExecutorError::NotRunning);
+  ASSERT_FALSE(pool.Start());
+  EXPECT_FALSE(pool.Submit([] {}));
+  pool.Shutdown();
+  EXPECT_EQ(pool.Submit([] {}), ExecutorError::NotRunning);
+  EXPECT_EQ(pool.Start(), ExecutorError::NotRunning);
+}
+
+TEST(ThreadPoolTest, NestedTasksSpreadOverWorkers) {
+  ThreadPool pool("test-fork", 4);
+  ASSERT_FALSE(pool.Start());
+  std::atomic<int> leaves{0};
+  ASSERT_FALSE(pool.Submit([&] { Fork(pool, 0, 14, leaves); }));
+  pool.WaitIdle();
+  EXPECT_EQ(leaves.load(), 1 << 14);
+
+  const ThreadPoolStats stats = pool.GetStats();
+  EXPECT_EQ(stats.submitted, stats.executed);
+  if (std::thread::hardware_concurrency() > 1) {
+    EXPECT_GT(stats.stolen, 0U);
+  }
+}
+
+TEST(ThreadPoolTest, ShutdownRunsQueuedAndFollowUpTasks) {
+  std::atomic<int> count{0};
+  {
+    ThreadPool pool("test-drain", 2);
+    ASSERT_FALSE(pool.Start());
+    for (int i = 0; i < 100; ++i) {
+      ASSERT_FALSE(pool.Submit([&pool, &count] {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        count.fetch_add(1);
+        // Follow-up work submitted while shutting down still runs
+        EXPECT_FALSE(pool.Submit([&count] { count.fetch_add(1); }));
+      }));
+    }
+    pool.Shutdown();
+    EXPECT_EQ(count.load(), 200);
+  }
+  EXPECT_EQ(count.load(), 200);
+}
+
+TEST(ThreadPoolTest, AcceptsMoveOnlyTasksAndSurvivesExceptions) {
+  ThreadPool pool("test-move", 2);
+  ASSERT_FALSE(pool.Start());
+  auto value = std::make_unique<int>(42);
+  std::atomic<int> seen{0};
+  ASSERT_FALSE(pool.Submit([value = std::move(value), &seen] { seen = *value; }));
+  ASSERT_FALSE(pool.Submit([] { throw std::runtime_error("task failure"); }));
+  pool.WaitIdle();
+  EXPECT_EQ(seen.load(), 42);
+
+  std::atomic<bool> ran{false};
+  ASSERT_FALSE(pool.Submit([&ran] { ran = true; }));
+  pool.WaitIdle();
+  EXPECT_TRUE(ran.load());
+}
+
+TEST(ThreadPoolTest, WorkersKnowTheirPoolAndBlockTerminateSignals) {
+  ThreadPool pool("test-current", 3);
+  ASSERT_FALSE(pool.Start());
+  EXPECT_EQ(ThreadPool::Current(), nullptr);
+  EXPECT_EQ(ThreadPool::CurrentWorkerIndex(), -1);
+
+  std::atomic<ThreadPool*> current{nullptr};
+  std::atomic<int> index{-1};
+  std::atomic<bool> blocked{false};
+  std::latch done(1);
+  ASSERT_FALSE(pool.Submit([&] {
+    current = ThreadPool::Current();
+    index = ThreadPool::CurrentWorkerIndex();
+    sigset_t mask;
+    pthread_sigmask(SIG_BLOCK, nullptr, &mask);
+    blocked = sigismember(&mask, SIGINT) == 1 && sigismember(&mask, SIGTERM) == 1 &&
+              sigismember(&mask, SIGQUIT) == 1 && sigismember(&mask, SIGHUP) == 1;
+    done.count_down();
+  }));
+  done.wait();
+  EXPECT_EQ(current.load(), &pool);
+  EXPECT_GE(index.load(), 0);
+  EXPECT_LT(index.load(), 3);
+  EXPECT_TRUE(blocked.load());
+
+  // The calling thread's mask is unchanged
+  sigset_t mask;
+  pthread_sigmask(SIG_BLOCK, nullptr, &mask);
+  EXPECT_EQ(sigismember(&mask, SIGTERM), 0);
+}
+
+TEST(ExecutorTest, RegistersNamedPools) {
+  auto& executor = Executor::Instance();
+  ASSERT_FALSE(executor.CreatePool("test-named", 2));
+  EXPECT_EQ(executor.CreatePool("test-named", 2), ExecutorError::PoolExists);
+  ThreadPool* pool = executor.GetPool("test-named");
+  ASSERT_NE(pool, nullptr);
+  EXPECT_EQ(pool->GetThreadCount(), 2U);
+  EXPECT_EQ(executor.GetPool("test-missing"), nullptr);
+
+  // The default pool is created on first use when Start() was not called
+  ThreadPool& shared = executor.Default();
+  EXPECT_EQ(&shared, executor.GetPool("default"));
+  std::latch done(1);
+  ASSERT_FALSE(shared.Submit([&done] { done.count_down(); }));
+  done.wait();
+
+  EXPECT_EQ(executor.CreatePool("test-too-many", ThreadPool::kMaxThreads + 1),
+            ExecutorError::InvalidThreadCount);
+}
+
+}  // namespace comm
@@ -0,0 +1,290 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_binlog.h
+ * @brief Deferred-formatting binary logging macros (BLOG) next to glog
+ * @details BLOG() stores a static call-site id plus the raw argument bytes in
+ *          the calling thread's log ring; no text is formatted on the caller.
+ *          The async writer either appends the record to a binary log file
+ *          (decoded offline by modu-core-binlog-decode) or renders it to text
+ *          for the regular outputs. Without the async backend BLOG() formats
+ *          immediately and logs through glog, so records are never lost.
+ *
+ * @code
+ * BLOG(INFO, "accepted connection fd={} from {} in {} us", fd, peer, elapsed);
+ * @endcode
+ *
+ * Placeholders are "{}" ("{{" and "}}" print braces). Supported arguments:
+ * bool, integers, enums, floating point, pointers, const char*,
+ * std::string and std::string_view (strings are truncated to 1 KiB).
+ */
+
+#pragma once
+
+#include <glog/logging.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "comm_log_level.h"
+
+namespace comm {
+
+/**
+ * @brief Argument type tags stored per call site and read by the decoder
+ */
+enum class BinlogTag : char {
+  Bool = 'b',     ///< 1 byte
+  Int = 'i',      ///< int64_t
+  Uint = 'u',     ///< uint64_t
+  Double = 'd',   ///< double
+  String = 's',   ///< uint32_t length followed by bytes
+  Pointer = 'p',  ///< uint64_t address
+};
+
+/// Longest string argument stored by BLOG()
+inline constexpr std::size_t kMaxBinlogString = 1024;
+
+/**
+ * @brief Static description of one BLOG() call site
+ * @note Constant-initialized; the id is assigned on first use
+ */
+struct BinlogSite {
+  constexpr BinlogSite(int severity_value, const char* file_value,
+                       int line_value, const char* format_value,
+                       const char* arg_types_value)
+      : severity(severity_value),
+        file(file_value),
+        line(line_value),
+        format(format_value),
+        arg_types(arg_types_value) {}
+
+  const int severity;
+  const char* const file;
+  const int line;
+  const char* const format;
+  const char* const arg_types;  ///< One BinlogTag per argument
+  std::atomic<std::uint32_t> id{0};
+};
+
+/**
+ * @brief Count "{}" placeholders in a BLOG() format string
+ */
+constexpr std::size_t CountBinlogPlaceholders(const char* format) {
+  std::size_t count = 0;
+  for (const char* p = format; *p != '\0'; ++p) {
+    if ((p[0] == '{' && p[1] == '{') || (p[0] == '}' && p[1] == '}')) {
+      ++p;
+    } else if (p[0] == '{' && p[1] == '}') {
+      ++count;
+      ++p;
+    }
+  }
+  return count;
+}
+
+/**
+ * @brief Encoding of one argument type
+ */
+template <typename T, typename = void>
+struct BinlogCodec;
+
+template <>
+struct BinlogCodec<bool> {
+  static constexpr BinlogTag kTag = BinlogTag::Bool;
+  static std::size_t Size(bool /*value*/) { return 1; }
+  static void Encode(char*& out, bool value) {
+    *out++ = value ? 1 : 0;
+  }
+};
+
+template <typename T>
+struct BinlogCodec<T, std::enable_if_t<std::is_integral_v<T> ||
+                                       std::is_enum_v<T>>> {
+  using Underlying = typename std::conditional_t<
+      std::is_enum_v<T>, std::underlying_type<T>, std::type_identity<T>>::type;
+  using Stored = std::conditional_t<std::is_signed_v<Underlying>, std::int64_t,
+                                    std::uint64_t>;
+  static constexpr BinlogTag kTag =
+      std::is_signed_v<Underlying> ? BinlogTag::Int : BinlogTag::Uint;
+  static std::size_t Size(T /*value*/) { return sizeof(Stored); }
+  static void Encode(char*& out, T value) {
+    const auto stored = static_cast<Stored>(value);
+    std::memcpy(out, &stored, sizeof(stored));
+    out += sizeof(stored);
+  }
+};
+
+template <typename T>
+struct BinlogCodec<T, std::enable_if_t<std::is_floating_point_v<T>>> {
+  static constexpr BinlogTag kTag = BinlogTag::Double;
+  static std::size_t Size(T /*value*/) { return sizeof(double); }
+  static void Encode(char*& out, T value) {
+    const auto stored = static_cast<double>(value);
+    std::memcpy(out, &stored, sizeof(stored));
+    out += sizeof(stored);
+  }
+};
+
+/**
+ * @brief Shared string encoding: uint32_t length + bytes
+ */
+struct BinlogStringCodec {
+  static constexpr BinlogTag kTag = BinlogTag::String;
+  static std::size_t Size(std::string_view value) {
+    return sizeof(std::uint32_t) + std::min(value.size(), kMaxBinlogString);
+  }
+  static void Encode(char*& out, std::string_view value) {
+    const auto len =
+        static_cast<std::uint32_t>(std::min(value.size(), kMaxBinlogString));
+    std::memcpy(out, &len, sizeof(len));
+    out += sizeof(len);
+    std::memcpy(out, value.data(), len);
+    out += len;
+  }
+};
+
+template <>
+struct BinlogCodec<const char*> {
+  static constexpr BinlogTag kTag = BinlogTag::String;
+  static std::string_view View(const char* value) {
+    return value != nullptr ? std::string_view(value) : std::string_view("(null)");
+  }
+  static std::size_t Size(const char* value) {
+    return BinlogStringCodec::Size(View(value));
+  }
+  static void Encode(char*& out, const char* value) {
+    BinlogStringCodec::Encode(out, View(value));
+  }
+};
+
+template <>
+struct BinlogCodec<char*> : BinlogCodec<const char*> {};
+
+template <>
+struct BinlogCodec<std::string> : BinlogStringCodec {};
+
+template <>
+struct BinlogCodec<std::string_view> : BinlogStringCodec {};
+
+template <typename T>
+struct BinlogCodec<T*, std::enable_if_t<!std::is_same_v<std::remove_cv_t<T>, char>>> {
+  static constexpr BinlogTag kTag = BinlogTag::Pointer;
+  static std::size_t Size(const T* /*value*/) { return sizeof(std::uint64_t); }
+  static void Encode(char*& out, const T* value) {
+    const auto stored =
+        static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(value));
+    std::memcpy(out, &stored, sizeof(stored));
+    out += sizeof(stored);
+  }
+};
+
+/**
+ * @brief Compile-time type list of a BLOG() argument pack
+ */
+template <typename... Args>
+struct BinlogTypeList {
+  static constexpr std::size_t kCount = sizeof...(Args);
+  static constexpr char kTags[] = {static_cast<char>(BinlogCodec<Args>::kTag)...,
+                                   '\0'};
+};
+
+/**
+ * @brief Unevaluated helper deducing the BinlogTypeList of the arguments
+ */
+template <typename... Args>
+BinlogTypeList<std::decay_t<Args>...> MakeBinlogTypeList(const Args&... args);
+
+/**
+ * @brief Reservation of a binary record in the calling thread's ring
+ */
+struct BinlogReservation {
+  char* payload;     ///< Where to encode the arguments, nullptr if unavailable
+  void* ring;        ///< Opaque ring handle for CommitBinlogRecord()
+  bool async_active; ///< False when the async backend is not running
+};
+
+/**
+ * @brief Assign an id to a call site on its first use
+ * @return Id of the site (never 0)
+ */
+std::uint32_t RegisterBinlogSite(BinlogSite& site);
+
+/**
+ * @brief Reserve a binary record for a site with payload_size bytes
+ */
+BinlogReservation BeginBinlogRecord(std::uint32_t site_id,
+                                    std::size_t payload_size);
+
+/**
+ * @brief Publish a record reserved by BeginBinlogRecord()
+ */
+void CommitBinlogRecord(const BinlogReservation& reservation);
+
+/**
+ * @brief Format an encoded record and log it through glog
+ * @note Used when the async backend is not running
+ */
+void LogBinlogFallback(const BinlogSite& site, const char* payload,
+                       std::size_t payload_size);
+
+/**
+ * @brief Record one BLOG() call (use the macro instead)
+ */
+template <typename... Args>
+void BinlogWrite(BinlogSite& site, const Args&... args) {
+  if (site.severity < FLAGS_minloglevel ||
+      !IsLogRecordEnabled(site.file, site.severity)) {
+    return;
+  }
+  std::uint32_t id = site.id.load(std::memory_order_acquire);
+  if (id == 0) {
+    id = RegisterBinlogSite(site);
+  }
+
+  const std::size_t payload_size =
+      (std::size_t{0} + ... + BinlogCodec<std::decay_t<Args>>::Size(args));
+  const BinlogReservation reservation = BeginBinlogRecord(id, payload_size);
+  if (reservation.payload != nullptr) {
+    char* out = reservation.payload;
+    (BinlogCodec<std::decay_t<Args>>::Encode(out, args), ...);
+    CommitBinlogRecord(reservation);
+    return;
+  }
+  if (!reservation.async_active) {
+    std::string buffer(payload_size, '\0');
+    char* out = buffer.data();
+    (BinlogCodec<std::decay_t<Args>>::Encode(out, args), ...);
+    LogBinlogFallback(site, buffer.data(), buffer.size());
+  }
+}
+
+}  // namespace comm
+
+/**
+ * @brief Binary log statement: BLOG(INFO, "x={} y={}", x, y)
+ * @details Severity filtering follows FLAGS_minloglevel and the level of the
+ *          calling module (comm_log_level.h). The number of "{}"
+ *          placeholders must match the number of arguments (checked at
+ *          compile time). FATAL is not supported, use LOG(FATAL).
+ */
+#define BLOG(severity, format, ...)                                            \
+  do {                                                                         \
+    using CommBinlogTypes_ =                                                   \
+        decltype(::comm::MakeBinlogTypeList(__VA_ARGS__));                     \
+    static_assert(::comm::CountBinlogPlaceholders(format) ==                   \
+                      CommBinlogTypes_::kCount,                                \
+                  "BLOG(): placeholder count does not match arguments");       \
+    static_assert(::google::GLOG_##severity != ::google::GLOG_FATAL,           \
+                  "BLOG(FATAL) is not supported, use LOG(FATAL)");             \
+    static ::comm::BinlogSite comm_binlog_site_{::google::GLOG_##severity,     \
+                                                __FILE__, __LINE__, format,    \
+                                                CommBinlogTypes_::kTags};      \
+    ::comm::BinlogWrite(comm_binlog_site_ __VA_OPT__(, ) __VA_ARGS__);         \
+  } while (false)
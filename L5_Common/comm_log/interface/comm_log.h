@@ -0,0 +1,408 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_log.h
+ * @brief Asynchronous glog backend with per-thread lock-free rings
+ * @details AsyncLog installs a google::LogSink that copies every record into a
+ *          ring owned by the logging thread. A background writer drains all
+ *          rings and hands batches to LogOutput implementations (stderr by
+ *          default, journald or rotating files), so LOG() no longer performs
+ *          a write() on the caller.
+ *          The same rings carry BLOG() records (see comm_binlog.h).
+ */
+
+#pragma once
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "comm_flat_map.h"
+#include "comm_symbol.h"
+
+namespace comm {
+
+/**
+ * @enum LogError
+ * @brief Error codes for logging backend operations
+ */
+enum class LogError {
+  Success = 0,
+  AlreadyRunning,
+  InvalidOptions,
+  ThreadCreationFailed,
+  OutputOpenFailed
+};
+
+/**
+ * @class LogErrorCategory
+ * @brief Error category for logging backend errors
+ */
+class LogErrorCategory : public std::error_category {
+ public:
+  const char* name() const noexcept override { return "comm_log"; }
+  std::string message(int error_value) const override;
+};
+
+/**
+ * @brief Get the singleton instance of logging error category
+ * @return Reference to the error category
+ */
+const std::error_category& get_log_error_category() noexcept;
+
+/**
+ * @brief Create an error_code from LogError enum
+ * @param error Logging error value
+ * @return std::error_code representing the error
+ */
+inline std::error_code make_error_code(LogError error) {
+  return {static_cast<int>(error), get_log_error_category()};
+}
+
+/**
+ * @enum LogOverflowPolicy
+ * @brief What a logging thread does when its ring has no room left
+ */
+enum class LogOverflowPolicy {
+  Drop,    ///< Discard the record and count it (never blocks)
+  Block,   ///< Wait until the writer frees space (never loses records)
+  Sample   ///< Above half full keep 1 in sample_rate records, drop when full
+};
+
+/**
+ * @enum LogOutputKind
+ * @brief Destination used by AsyncLog::Start(options)
+ */
+enum class LogOutputKind {
+  Stderr,    ///< glog-formatted lines on stderr
+  Journald,  ///< Native journal entries with structured fields
+  File       ///< Rotating log files (see FileLogOptions)
+};
+
+/**
+ * @enum LogCompression
+ * @brief Compression applied to rotated log file segments
+ */
+enum class LogCompression {
+  None,
+  Gzip,  ///< segment.gz (zlib)
+  Zstd   ///< segment.zst (falls back to gzip when built without libzstd)
+};
+
+/**
+ * @brief Options of the rotating file output
+ */
+struct FileLogOptions {
+  std::string path;  ///< Active file; rotated segments are path.<UTC time>
+  std::uint64_t max_size_bytes = 64 * 1024 * 1024;  ///< Rotate above this size
+  std::chrono::seconds rotate_interval{0};  ///< Also rotate at UTC multiples
+  std::uint32_t max_files = 10;        ///< Rotated segments kept, 0 = all
+  std::chrono::hours max_age{0};       ///< Older segments deleted, 0 = keep
+  LogCompression compression = LogCompression::Gzip;
+  int compression_level = 0;           ///< 0 = library default
+  std::size_t buffer_size_bytes = 1024 * 1024;  ///< Appended per write()
+};
+
+/**
+ * @brief Options for the asynchronous logging backend
+ */
+struct AsyncLogOptions {
+  LogOverflowPolicy overflow_policy = LogOverflowPolicy::Drop;
+  std::size_t ring_size_bytes = 256 * 1024;  ///< Per-thread ring capacity
+  std::uint32_t sample_rate = 10;            ///< Used by Sample policy
+  std::chrono::milliseconds flush_interval{5};  ///< Writer idle wake-up
+  int flush_severity = 2;  ///< glog severity from which LOG() waits for write
+  std::string binary_file;  ///< BLOG() records go here when set, else to text
+  std::chrono::seconds summary_interval{10};  ///< Suppressed-record reports
+  LogOutputKind output = LogOutputKind::Stderr;  ///< Start(options) output
+  FileLogOptions file;  ///< Used when output is LogOutputKind::File
+};
+
+/**
+ * @brief One log record as seen by LogOutput implementations
+ * @note Views point into ring memory and are valid only during Write()
+ */
+struct LogRecord {
+  int severity;                ///< glog severity (google::GLOG_INFO...)
+  pid_t thread_id;             ///< Kernel thread id of the logging thread
+  std::int64_t timestamp_us;   ///< Wall clock, microseconds since epoch
+  const char* full_filename;   ///< Source file (static storage, from glog)
+  const char* base_filename;   ///< Source file basename
+  int line;                    ///< Source line
+  std::string_view message;    ///< Message text without prefix or newline
+  std::uint64_t trace_id = 0;  ///< Trace id of the logging thread, 0 if none
+  std::uint64_t config_generation = 0;  ///< Config generation when logged
+};
+
+/**
+ * @brief Set the trace id attached to records logged by the calling thread
+ * @param trace_id Trace id, 0 clears it
+ */
+void SetLogTraceId(std::uint64_t trace_id);
+
+/**
+ * @brief Trace id of the calling thread, 0 if none
+ */
+std::uint64_t GetLogTraceId();
+
+/**
+ * @class ScopedLogTraceId
+ * @brief Sets the thread's trace id for a scope and restores the previous one
+ */
+class ScopedLogTraceId {
+ public:
+  explicit ScopedLogTraceId(std::uint64_t trace_id)
+      : m_previous(GetLogTraceId()) {
+    SetLogTraceId(trace_id);
+  }
+  ~ScopedLogTraceId() { SetLogTraceId(m_previous); }
+
+  ScopedLogTraceId(const ScopedLogTraceId&) = delete;
+  ScopedLogTraceId& operator=(const ScopedLogTraceId&) = delete;
+
+ private:
+  std::uint64_t m_previous;
+};
+
+/**
+ * @brief Publish the configuration generation attached to new records
+ * @param generation Typically Config::Instance().GetGeneration()
+ */
+void SetLogConfigGeneration(std::uint64_t generation);
+
+/**
+ * @brief Configuration generation currently attached to new records
+ */
+std::uint64_t GetLogConfigGeneration();
+
+/**
+ * @class LogOutput
+ * @brief Destination for batches drained by the background writer
+ * @note Write() and Flush() run on the writer thread only and must not call
+ *       LOG() themselves (the record would land in the writer's own ring)
+ */
+class LogOutput {
+ public:
+  virtual ~LogOutput() = default;
+
+  /**
+   * @brief Write a batch of records, ordered by timestamp
+   * @param records Records to write
+   */
+  virtual void Write(std::span<const LogRecord> records) = 0;
+
+  /**
+   * @brief Push buffered data to the underlying device
+   */
+  virtual void Flush() {}
+};
+
+/**
+ * @class FdLogOutput
+ * @brief Writes glog-formatted lines to a file descriptor using writev()
+ */
+class FdLogOutput : public LogOutput {
+ public:
+  /**
+   * @param fd Descriptor to write to (not owned, e.g. STDERR_FILENO)
+   */
+  explicit FdLogOutput(int fd);
+
+  void Write(std::span<const LogRecord> records) override;
+
+  /**
+   * @brief Number of writev() calls that failed (writer thread counter)
+   */
+  std::uint64_t GetErrorCount() const { return m_errors; }
+
+ private:
+  int m_fd;
+  std::uint64_t m_errors{0};
+  std::vector<char> m_prefixes;
+};
+
+/**
+ * @class JournaldLogOutput
+ * @brief Sends records to the systemd journal with sd_journal_sendv()
+ * @details Every record becomes one journal entry with MESSAGE, PRIORITY,
+ *          CODE_FILE, CODE_LINE, SYSLOG_IDENTIFIER and TID plus the
+ *          structured fields COMM_MODULE, COMM_CONFIG_GENERATION,
+ *          COMM_TIMESTAMP_US and COMM_TRACE_ID (when set), e.g.
+ *          "journalctl COMM_MODULE=comm_terminate". Records the journal
+ *          rejects are written to stderr instead.
+ */
+class JournaldLogOutput : public LogOutput {
+ public:
+  /**
+   * @param identifier SYSLOG_IDENTIFIER value (program name if empty)
+   */
+  explicit JournaldLogOutput(std::string identifier = {});
+
+  void Write(std::span<const LogRecord> records) override;
+
+  /**
+   * @brief Number of records the journal rejected (writer thread counter)
+   */
+  std::uint64_t GetErrorCount() const { return m_errors; }
+
+ protected:
+  /**
+   * @brief Send one entry; returns 0 or a negative errno value
+   * @note Overridable so tests can inspect the fields
+   */
+  virtual int Send(const iovec* fields, int count);
+
+ private:
+  std::string_view ModuleOf(const char* full_filename);
+  void AppendField(std::string_view name, std::string_view value);
+
+  std::string m_identifier;
+  std::uint64_t m_errors{0};
+  std::string m_fields;                    ///< "NAME=value" fields of one entry
+  std::vector<std::size_t> m_field_ends;   ///< End offsets into m_fields
+  std::vector<iovec> m_iov;
+  FlatMap<const char*, Symbol> m_modules;  ///< Keyed by __FILE__ pointer
+  FdLogOutput m_fallback;
+};
+
+/**
+ * @brief Format the glog line prefix ("I20260101 12:00:00.000000 123 f.cc:1] ")
+ * @param record Record to describe
+ * @param buffer Destination buffer
+ * @param size Size of destination buffer
+ * @return Number of characters written (truncated to size)
+ */
+std::size_t FormatLogPrefix(const LogRecord& record, char* buffer,
+                            std::size_t size);
+
+/**
+ * @brief Counters exposed by the asynchronous backend
+ */
+struct AsyncLogStats {
+  std::uint64_t written{0};      ///< Records handed to outputs
+  std::uint64_t dropped{0};      ///< Records discarded because a ring was full
+  std::uint64_t sampled_out{0};  ///< Records skipped by the Sample policy
+  std::uint64_t batches{0};      ///< Write() rounds performed by the writer
+};
+
+class AsyncLogSink;
+class SyncLogSink;
+
+/**
+ * @class AsyncLog
+ * @brief Singleton controlling the asynchronous glog backend
+ */
+class AsyncLog {
+ public:
+  /**
+   * @brief Get singleton instance
+   * @return Reference to the singleton instance
+   */
+  static AsyncLog& Instance();
+
+  // Delete copy/move constructors and assignment operators
+  AsyncLog(const AsyncLog&) = delete;
+  AsyncLog& operator=(const AsyncLog&) = delete;
+  AsyncLog(AsyncLog&&) = delete;
+  AsyncLog& operator=(AsyncLog&&) = delete;
+
+  /**
+   * @brief Start the writer thread and route glog through it
+   * @param options Backend options, options.output selects the output
+   * @return Error code indicating success or failure
+   * @details Disables glog's own stderr/file writing while running; Stop()
+   *          restores the previous glog flags
+   */
+  std::error_code Start(const AsyncLogOptions& options);
+
+  /**
+   * @brief Start the writer thread with explicit outputs
+   * @param options Backend options
+   * @param outputs Destinations, written in order for every batch
+   * @return Error code indicating success or failure
+   */
+  std::error_code Start(const AsyncLogOptions& options,
+                        std::vector<std::unique_ptr<LogOutput>> outputs);
+
+  /**
+   * @brief Drain all rings, uninstall the sink and join the writer thread
+   * @note Safe to call when not running
+   */
+  void Stop();
+
+  /**
+   * @brief Filter records by module also while the backend is stopped
+   * @param enabled True while per-module levels are configured
+   * @details glog's own output knows only one threshold. While enabled and
+   *          not running, a synchronous sink writes the records of enabled
+   *          modules to stderr in its place. Called by ApplyLogLevels()
+   */
+  void SetModuleFilter(bool enabled);
+
+  /**
+   * @brief Block until every record logged before the call is written
+   */
+  void Flush();
+
+  /**
+   * @brief Check whether the backend is currently installed
+   */
+  bool IsRunning() const;
+
+  /**
+   * @brief Snapshot of backend counters, cumulative across Start()/Stop()
+   */
+  AsyncLogStats GetStats() const;
+
+ private:
+  AsyncLog();
+  ~AsyncLog();
+
+  /// Installed sink, owns the rings and the writer thread
+  std::unique_ptr<AsyncLogSink> m_sink;
+
+  /// Module-filtering stand-in for glog's stderr output while stopped
+  std::unique_ptr<SyncLogSink> m_sync_sink;
+
+  /// Per-module levels are configured (SetModuleFilter())
+  bool m_module_filter{false};
+
+  /// Fast-path flag for IsRunning() without taking m_mutex
+  std::atomic<bool> m_running{false};
+
+  /// Serializes Start()/Stop()/SetModuleFilter()/Flush()/GetStats()
+  mutable std::mutex m_mutex;
+
+  /// Writer counters accumulated by sinks that were already stopped
+  AsyncLogStats m_stopped_stats;
+
+  /// Turn off glog's own stderr and file output, saving its flags
+  void DisableGlogOutput();
+
+  /// Restore the flags saved by DisableGlogOutput()
+  void RestoreGlogOutput();
+
+  /// glog flags saved while a sink replaces glog's own output
+  bool m_saved_logtostderr{true};
+  int m_saved_stderrthreshold{0};
+};
+
+}  // namespace comm
+
+// Enable std::error_code support for LogError
+namespace std {
+template <>
+struct is_error_code_enum<comm::LogError> : true_type {};
+}  // namespace std
@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_log_config.h
+ * @brief [logging] configuration section and its TOML serialization
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <string_view>
+#include <toml.hpp>
+
+#include "comm_log.h"
+#include "comm_log_level.h"
+
+namespace comm {
+
+/**
+ * @brief Settings read from the [logging] section of config.toml
+ *
+ * @code
+ * [logging]
+ * async = true
+ * output = "stderr"         # stderr | journald | file
+ * overflow_policy = "drop"    # drop | block | sample
+ * ring_size_kb = 256
+ * sample_rate = 10
+ * flush_interval_ms = 5
+ * flush_severity = "ERROR"
+ * binary_file = ""            # BLOG() records as binary when set
+ * level = "INFO"              # default level: INFO..FATAL or V<n>
+ * suppressed_summary_s = 10   # report LOG_RATE_LIMITED()/LOG_SAMPLED() drops
+ * file_path = "/var/log/modu-core/modu-core.log"   # output = "file"
+ * file_max_size_mb = 64       # rotate above this size
+ * file_rotate_interval_s = 0  # also rotate at UTC multiples (86400 = daily)
+ * file_max_files = 10         # rotated segments kept, 0 = unlimited
+ * file_max_age_h = 0          # delete older segments, 0 = keep
+ * file_compression = "gzip"   # none | gzip | zstd
+ * file_compression_level = 0  # 0 = library default
+ * file_buffer_kb = 1024       # bytes appended per write()
+ *
+ * [logging.modules]
+ * comm_terminate = "V2"       # per-module overrides, re-applied on SIGHUP
+ * @endcode
+ */
+struct LogConfig {
+  bool async = true;
+  std::string output = "stderr";
+  std::string overflow_policy = "drop";
+  int ring_size_kb = 256;
+  int sample_rate = 10;
+  int flush_interval_ms = 5;
+  std::string flush_severity = "ERROR";
+  std::string binary_file;
+  std::string level = "INFO";
+  std::map<std::string, std::string> modules;
+  int suppressed_summary_s = 10;
+  std::string file_path = "/var/log/modu-core/modu-core.log";
+  int file_max_size_mb = 64;
+  int file_rotate_interval_s = 0;
+  int file_max_files = 10;
+  int file_max_age_h = 0;
+  std::string file_compression = "gzip";
+  int file_compression_level = 0;
+  int file_buffer_kb = 1024;
+};
+
+// ADL-based serialization functions
+void to_toml(toml::value& dest, const LogConfig& value);
+void from_toml(const toml::value& src, LogConfig& value);
+
+/**
+ * @brief Parse an overflow policy name ("drop", "block", "sample")
+ * @param name Policy name, case-insensitive
+ * @param policy Receives the parsed policy
+ * @return True on success, false if the name is unknown
+ */
+bool ParseLogOverflowPolicy(std::string_view name, LogOverflowPolicy& policy);
+
+/**
+ * @brief Parse an output name ("stderr", "journald")
+ * @param name Output name, case-insensitive
+ * @param output Receives the parsed output kind
+ * @return True on success, false if the name is unknown
+ */
+bool ParseLogOutput(std::string_view name, LogOutputKind& output);
+
+/**
+ * @brief Parse a compression name ("none", "gzip", "zstd")
+ * @param name Compression name, case-insensitive
+ * @param compression Receives the parsed compression
+ * @return True on success, false if the name is unknown
+ */
+bool ParseLogCompression(std::string_view name, LogCompression& compression);
+
+/**
+ * @brief Parse a glog severity name ("INFO", "WARNING", "ERROR", "FATAL")
+ * @param name Severity name, case-insensitive
+ * @param severity Receives the glog severity value
+ * @return True on success, false if the name is unknown
+ */
+bool ParseLogSeverity(std::string_view name, int& severity);
+
+/**
+ * @brief Parse "INFO", "WARNING", "ERROR", "FATAL" or "V<n>" (INFO + verbose n)
+ * @param name Level name, case-insensitive
+ * @param level Receives the parsed level
+ * @return True on success, false if the name is not a level
+ */
+bool ParseLogLevel(std::string_view name, LogLevel& level);
+
+/**
+ * @brief Apply level and [logging.modules] (startup and every reload)
+ * @param config Parsed configuration; invalid entries are skipped with a warning
+ */
+void ApplyLogConfigLevels(const LogConfig& config);
+
+/**
+ * @brief Convert the [logging] section into backend options
+ * @param config Parsed configuration; invalid values fall back to defaults
+ * @return Options for AsyncLog::Start()
+ */
+AsyncLogOptions MakeAsyncLogOptions(const LogConfig& config);
+
+}  // namespace comm
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_log_file.h
+ * @brief Rotating log file output with background compression
+ * @details Records are appended to path through a large buffer on the async
+ *          writer thread, into space preallocated with fallocate(). When the
+ *          file exceeds max_size_bytes or a rotate_interval boundary passes,
+ *          it is renamed to path.<YYYYmmdd-HHMMSS.uuuuuu> and a new file is
+ *          opened; only a rename() and open() happen on the writer thread.
+ *          A SCHED_IDLE thread compresses rotated segments and enforces
+ *          max_files/max_age. Logging threads never wait for any of this.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include "comm_log.h"
+
+namespace comm {
+
+/**
+ * @class RotatingFileLogOutput
+ * @brief LogOutput writing glog-formatted lines to rotating files
+ */
+class RotatingFileLogOutput : public LogOutput {
+ public:
+  explicit RotatingFileLogOutput(FileLogOptions options);
+
+  /**
+   * @brief Write buffered lines, close the file and stop the compressor
+   * @note Segments not yet compressed are picked up by the next Open()
+   */
+  ~RotatingFileLogOutput() override;
+
+  RotatingFileLogOutput(const RotatingFileLogOutput&) = delete;
+  RotatingFileLogOutput& operator=(const RotatingFileLogOutput&) = delete;
+
+  /**
+   * @brief Create the directory, open (append) path and start the compressor
+   * @return Error code from mkdir()/open() on failure
+   * @details Also compresses and expires segments left by earlier runs
+   */
+  std::error_code Open();
+
+  void Write(std::span<const LogRecord> records) override;
+
+  /**
+   * @brief Write buffered lines to the file
+   */
+  void Flush() override;
+
+  /**
+   * @brief Block until requested compression and retention work is done
+   */
+  void WaitForCompression();
+
+  /**
+   * @brief Number of failed file operations (both threads)
+   */
+  std::uint64_t GetErrorCount() const {
+    return m_errors.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Number of rotations performed (writer thread counter)
+   */
+  std::uint64_t GetRotationCount() const { return m_rotations; }
+
+ private:
+  bool OpenActiveFile();
+  void CloseActiveFile();
+  void Rotate();
+  void WriteBuffer();
+  void ScheduleRotation(std::int64_t now_us);
+  void RequestScan();
+
+  void CompressorLoop();
+  void ProcessSegments();
+
+  FileLogOptions m_options;
+
+  /// Writer thread state
+  int m_fd{-1};
+  std::uint64_t m_file_size{0};
+  std::uint64_t m_allocated{0};
+  bool m_preallocate{true};
+  std::int64_t m_next_rotation_us{0};
+  std::uint64_t m_rotations{0};
+  std::string m_buffer;
+
+  std::atomic<std::uint64_t> m_errors{0};
+
+  /// Compressor thread and its work flags (protected by m_work_mutex)
+  std::thread m_compressor;
+  std::mutex m_work_mutex;
+  std::condition_variable m_work_cv;
+  bool m_scan_requested{false};
+  bool m_scanning{false};
+  std::atomic<bool> m_stop{false};
+};
+
+}  // namespace comm
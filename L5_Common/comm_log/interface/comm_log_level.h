@@ -0,0 +1,147 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_log_level.h
+ * @brief Per-module log levels and the compile-time severity floor
+ * @details A module is the directory above src/, interface/, unit_test/... of
+ *          a source file (e.g. "comm_terminate"). MLOG()/MVLOG() check the
+ *          level of their module before the message is formatted; plain LOG()
+ *          records are filtered by module in the async sink, or with async
+ *          logging off by a synchronous sink that replaces glog's stderr.
+ *
+ *          COMM_LOG_STRIP_LEVEL (0 = INFO ... 3 = FATAL) and COMM_VLOG_MAX are
+ *          set by the build (MODU_LOG_STRIP_LEVEL / MODU_VLOG_MAX) and remove
+ *          lower statements from the binary entirely.
+ *
+ * @code
+ * MLOG(INFO) << "Connection accepted from " << peer;
+ * MVLOG(2) << "Frame dump: " << HexDump(frame);   // [logging.modules] x = "V2"
+ * @endcode
+ */
+
+#pragma once
+
+#include <glog/logging.h>
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <string_view>
+
+#include "comm_symbol.h"
+
+#ifndef COMM_LOG_STRIP_LEVEL
+#define COMM_LOG_STRIP_LEVEL 0
+#endif
+
+#ifndef COMM_VLOG_MAX
+#define COMM_VLOG_MAX 9
+#endif
+
+namespace comm {
+
+/**
+ * @brief Threshold of one module: severity floor plus verbose level
+ */
+struct LogLevel {
+  int severity = 0;   ///< glog severity, records below are discarded
+  int verbosity = 0;  ///< MVLOG(n) is enabled for n <= verbosity
+};
+
+/**
+ * @brief Module name of a source path (directory above src/, interface/...)
+ * @param file Source path as given by __FILE__
+ * @return Module name, or the file name without extension as a fallback
+ */
+std::string LogModuleName(std::string_view file);
+
+/**
+ * @class LogModule
+ * @brief Runtime level of one module, shared by all of its call sites
+ * @note Instances live for the whole process; levels are relaxed atomics
+ */
+class LogModule {
+ public:
+  explicit LogModule(Symbol name) : m_name(name) {}
+
+  LogModule(const LogModule&) = delete;
+  LogModule& operator=(const LogModule&) = delete;
+
+  Symbol Name() const { return m_name; }
+
+  bool IsEnabled(int severity) const {
+    return severity >= m_severity.load(std::memory_order_relaxed) ||
+           severity >= google::GLOG_FATAL;
+  }
+
+  /**
+   * @brief MVLOG(verbosity) check; verbose records are logged at INFO
+   */
+  bool IsVerboseEnabled(int verbosity) const {
+    return verbosity <= m_verbosity.load(std::memory_order_relaxed) &&
+           IsEnabled(google::GLOG_INFO);
+  }
+
+  void SetLevel(const LogLevel& level) {
+    m_severity.store(level.severity, std::memory_order_relaxed);
+    m_verbosity.store(level.verbosity, std::memory_order_relaxed);
+  }
+
+ private:
+  const Symbol m_name;
+  std::atomic<int> m_severity{0};
+  std::atomic<int> m_verbosity{0};
+};
+
+/**
+ * @brief Module of a source file, created with the current levels on first use
+ * @param file Source path as given by __FILE__ (static storage)
+ */
+LogModule& GetLogModule(const char* file);
+
+/**
+ * @brief Set the default level and per-module overrides
+ * @param global Level of modules without an override
+ * @param modules Overrides by module name; replaces earlier overrides
+ * @details Also sets FLAGS_minloglevel to the lowest configured severity and
+ *          FLAGS_v to the default verbosity, so glog lets enabled records pass.
+ *          With overrides, AsyncLog::SetModuleFilter() makes sure every
+ *          record is checked against its module
+ */
+void ApplyLogLevels(const LogLevel& global,
+                    const std::map<std::string, LogLevel>& modules);
+
+/**
+ * @brief Check a plain LOG() record against the level of its module
+ * @param file Source path of the record (static storage, from glog)
+ * @param severity Record severity
+ * @return True when the record should be written
+ * @note Cheap when no module overrides are configured
+ */
+bool IsLogRecordEnabled(const char* file, int severity);
+
+}  // namespace comm
+
+/// Module of the current call site, resolved once per site
+#define COMM_LOG_MODULE_                                                      \
+  ([]() -> const ::comm::LogModule& {                                         \
+    static const ::comm::LogModule& comm_log_module_ =                        \
+        ::comm::GetLogModule(__FILE__);                                       \
+    return comm_log_module_;                                                  \
+  }())
+
+/**
+ * @brief LOG() filtered by the level of the calling module
+ */
+#define MLOG(severity)                                                        \
+  LOG_IF(severity, ::google::GLOG_##severity >= COMM_LOG_STRIP_LEVEL &&      \
+                       COMM_LOG_MODULE_.IsEnabled(::google::GLOG_##severity))
+
+/**
+ * @brief Verbose (debug) INFO record enabled by a module level of "V<n>"
+ */
+#define MVLOG(verbosity)                                                      \
+  LOG_IF(INFO, (verbosity) <= COMM_VLOG_MAX &&                                \
+                   ::google::GLOG_INFO >= COMM_LOG_STRIP_LEVEL &&             \
+                   COMM_LOG_MODULE_.IsVerboseEnabled(verbosity))
@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_log_limit.h
+ * @brief Rate-limited and sampled LOG() variants for per-request hot paths
+ * @details Each call site owns a constant-initialized LogLimitSite updated
+ *          with atomics only. Suppressed records are counted; the count is
+ *          prefixed to the next record that passes, and the async writer
+ *          reports counts of quiet sites every summary interval.
+ *
+ * @code
+ * LOG_RATE_LIMITED(WARNING, 10, 20) << "Dropping packet from " << peer;
+ * LOG_SAMPLED(INFO, 1000) << "Request " << id << " took " << us << " us";
+ * @endcode
+ *
+ * Output: "[suppressed 12,345 similar messages] Dropping packet from ..."
+ */
+
+#pragma once
+
+#include <glog/logging.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+
+#include "comm_log_level.h"
+
+namespace comm {
+
+/**
+ * @class LogLimitSite
+ * @brief Lock-free per-call-site state of LOG_RATE_LIMITED()/LOG_SAMPLED()
+ */
+class LogLimitSite {
+ public:
+  constexpr LogLimitSite(const char* file, int line, int severity)
+      : m_file(file), m_line(line), m_severity(severity) {}
+
+  LogLimitSite(const LogLimitSite&) = delete;
+  LogLimitSite& operator=(const LogLimitSite&) = delete;
+
+  /**
+   * @brief Token bucket: per_second tokens per second, at most burst stored
+   * @return True when a token was taken, false when the record is suppressed
+   * @details Implemented as GCRA (one atomic "theoretical arrival time"),
+   *          which admits exactly the same records as a token bucket
+   */
+  bool AllowRate(double per_second, std::uint32_t burst);
+
+  /**
+   * @brief Pass the first record and then one in every n
+   */
+  bool AllowSample(std::uint32_t n);
+
+  /**
+   * @brief Take the number of records suppressed since the last report
+   */
+  std::uint64_t TakeSuppressed() {
+    return m_suppressed.exchange(0, std::memory_order_relaxed);
+  }
+
+  const char* File() const { return m_file; }
+  int Line() const { return m_line; }
+  int Severity() const { return m_severity; }
+
+ private:
+  friend void CollectSuppressedLogs(
+      const std::function<void(const LogLimitSite&, std::uint64_t)>& report);
+
+  void Suppress();
+
+  const char* const m_file;
+  const int m_line;
+  const int m_severity;
+
+  /// GCRA theoretical arrival time (FastClock, ns) / sample counter
+  std::atomic<std::int64_t> m_tat_ns{0};
+  std::atomic<std::uint64_t> m_count{0};
+
+  /// Suppressed since the last report, and membership in the report list
+  std::atomic<std::uint64_t> m_suppressed{0};
+  std::atomic<bool> m_listed{false};
+  LogLimitSite* m_next{nullptr};
+};
+
+/**
+ * @brief Report and reset suppressed counts of all sites that have any
+ * @param report Called once per site with its suppressed count
+ * @note Lock-free; used by the async writer for periodic summaries
+ */
+void CollectSuppressedLogs(
+    const std::function<void(const LogLimitSite&, std::uint64_t)>& report);
+
+/**
+ * @brief Format "suppressed 12,345 similar messages" into buffer
+ * @return Number of characters written (truncated to size)
+ */
+std::size_t FormatSuppressedNote(std::uint64_t count, char* buffer,
+                                 std::size_t size);
+
+/**
+ * @brief Stream manipulator printing the suppressed-count prefix, if any
+ */
+struct LogSuppressedPrefix {
+  std::uint64_t count;
+};
+
+std::ostream& operator<<(std::ostream& stream, const LogSuppressedPrefix& note);
+
+}  // namespace comm
+
+/// Shared body: module/compile-time check first, so disabled records cost
+/// neither tokens nor suppressed counts
+#define COMM_LOG_LIMITED_(severity, allow)                                     \
+  if (static ::comm::LogLimitSite comm_log_limit_site_{                        \
+          __FILE__, __LINE__, ::google::GLOG_##severity};                      \
+      !(::google::GLOG_##severity >= COMM_LOG_STRIP_LEVEL &&                   \
+        COMM_LOG_MODULE_.IsEnabled(::google::GLOG_##severity) &&               \
+        comm_log_limit_site_.allow)) {                                         \
+  } else                                                                       \
+    google::LogMessage(__FILE__, __LINE__, ::google::GLOG_##severity).stream() \
+        << ::comm::LogSuppressedPrefix{comm_log_limit_site_.TakeSuppressed()}
+
+/**
+ * @brief LOG() allowing per_second records per second with bursts of burst
+ */
+#define LOG_RATE_LIMITED(severity, per_second, burst) \
+  COMM_LOG_LIMITED_(severity, AllowRate((per_second), (burst)))
+
+/**
+ * @brief LOG() passing the first record and then one in every n
+ */
+#define LOG_SAMPLED(severity, n) COMM_LOG_LIMITED_(severity, AllowSample(n))
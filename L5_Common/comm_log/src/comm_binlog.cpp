@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_binlog.cpp
+ * @brief BLOG() call-site registry and ring reservation
+ */
+
+#include "comm_binlog.h"
+
+#include <mutex>
+#include <vector>
+
+#include "comm_binlog_file.h"
+#include "comm_clock.h"
+#include "comm_log_ring.h"
+
+namespace comm {
+
+namespace {
+
+/**
+ * @brief Registered call sites, index is the site id (0 unused)
+ */
+struct BinlogSiteRegistry {
+  std::mutex mutex;
+  std::vector<const BinlogSite*> sites{nullptr};
+};
+
+BinlogSiteRegistry& GetSiteRegistry() {
+  static BinlogSiteRegistry registry;
+  return registry;
+}
+
+}  // namespace
+
+std::uint32_t RegisterBinlogSite(BinlogSite& site) {
+  auto& registry = GetSiteRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  // Another thread may have won the race for this site
+  std::uint32_t id = site.id.load(std::memory_order_relaxed);
+  if (id == 0) {
+    id = static_cast<std::uint32_t>(registry.sites.size());
+    registry.sites.push_back(&site);
+    site.id.store(id, std::memory_order_release);
+  }
+  return id;
+}
+
+const BinlogSite* FindBinlogSite(std::uint32_t site_id) {
+  auto& registry = GetSiteRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  return site_id < registry.sites.size() ? registry.sites[site_id] : nullptr;
+}
+
+BinlogReservation BeginBinlogRecord(std::uint32_t site_id,
+                                    std::size_t payload_size) {
+  auto& rings = LogRingRegistry::Instance();
+  if (!rings.IsActive()) {
+    return {nullptr, nullptr, false};
+  }
+  const std::size_t frame_size = sizeof(LogBinaryHeader) + payload_size;
+  if (frame_size > rings.MaxFrameSize()) {
+    // Too large for a ring frame: log synchronously instead
+    return {nullptr, nullptr, false};
+  }
+
+  ThreadLogRing* ring = nullptr;
+  const std::uint32_t size = AlignLogFrame(frame_size);
+  char* slot = rings.Reserve(size, ring);
+  if (slot == nullptr) {
+    return {nullptr, nullptr, true};
+  }
+
+  auto* header = reinterpret_cast<LogBinaryHeader*>(slot);
+  header->frame.size = size;
+  header->frame.kind = LogFrameKind::Binary;
+  header->timestamp_us = FastClock::RealtimeNs() / 1000;
+  header->site_id = site_id;
+  header->payload_len = static_cast<std::uint32_t>(payload_size);
+  header->trace_id = GetLogTraceId();
+  header->config_generation = GetLogConfigGeneration();
+  return {slot + sizeof(LogBinaryHeader), ring, true};
+}
+
+void CommitBinlogRecord(const BinlogReservation& reservation) {
+  LogRingRegistry::Instance().Commit(
+      static_cast<ThreadLogRing*>(reservation.ring));
+}
+
+void LogBinlogFallback(const BinlogSite& site, const char* payload,
+                       std::size_t payload_size) {
+  std::string text;
+  RenderBinlogMessage(site.format, site.arg_types,
+                      std::string_view(payload, payload_size), text);
+  google::LogMessage(site.file, site.line, site.severity).stream() << text;
+}
+
+}  // namespace comm
@@ -0,0 +1,226 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_binlog_file.cpp
+ * @brief Binary log file writer and reader
+ */
+
+#include "comm_binlog_file.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+namespace comm {
+
+namespace {
+
+/// Buffered bytes that trigger a write()
+constexpr std::size_t kFlushThreshold = 64 * 1024;
+
+/// Sanity limit for strings and payloads read from a file
+constexpr std::uint32_t kMaxEntryField = 1024 * 1024;
+
+}  // namespace
+
+BinlogFileWriter::~BinlogFileWriter() {
+  Flush();
+  if (m_fd >= 0) {
+    ::close(m_fd);
+  }
+}
+
+std::error_code BinlogFileWriter::Open(const std::string& path) {
+  m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (m_fd < 0) {
+    return {errno, std::generic_category()};
+  }
+  struct stat info {};
+  if (::fstat(m_fd, &info) == 0 && info.st_size == 0) {
+    PutBytes(std::string_view(kBinlogMagic, sizeof(kBinlogMagic)));
+    Put(kBinlogVersion);
+  }
+
+  timespec now{};
+  clock_gettime(CLOCK_REALTIME, &now);
+  Put(BinlogEntry::Session);
+  Put(static_cast<std::int64_t>(now.tv_sec) * 1000000 + now.tv_nsec / 1000);
+  Put(static_cast<std::int32_t>(::getpid()));
+  Flush();
+  if (m_errors > 0) {
+    return {EIO, std::generic_category()};
+  }
+  return {};
+}
+
+template <typename T>
+void BinlogFileWriter::Put(const T& value) {
+  const auto* bytes = reinterpret_cast<const char*>(&value);
+  m_buffer.insert(m_buffer.end(), bytes, bytes + sizeof(T));
+}
+
+void BinlogFileWriter::PutBytes(std::string_view bytes) {
+  m_buffer.insert(m_buffer.end(), bytes.begin(), bytes.end());
+}
+
+void BinlogFileWriter::Append(const BinlogSite& site, std::uint32_t site_id,
+                              std::int64_t timestamp_us, pid_t tid,
+                              std::string_view payload) {
+  if (site_id >= m_defined_sites.size()) {
+    m_defined_sites.resize(site_id + 1, false);
+  }
+  if (!m_defined_sites[site_id]) {
+    m_defined_sites[site_id] = true;
+    const std::string_view file(site.file);
+    const std::string_view format(site.format);
+    const std::string_view types(site.arg_types);
+    Put(BinlogEntry::Site);
+    Put(site_id);
+    Put(static_cast<std::int32_t>(site.severity));
+    Put(static_cast<std::int32_t>(site.line));
+    Put(static_cast<std::uint32_t>(file.size()));
+    Put(static_cast<std::uint32_t>(format.size()));
+    Put(static_cast<std::uint32_t>(types.size()));
+    PutBytes(file);
+    PutBytes(format);
+    PutBytes(types);
+  }
+
+  Put(BinlogEntry::Event);
+  Put(site_id);
+  Put(timestamp_us);
+  Put(static_cast<std::int32_t>(tid));
+  Put(static_cast<std::uint32_t>(payload.size()));
+  PutBytes(payload);
+
+  if (m_buffer.size() >= kFlushThreshold) {
+    Flush();
+  }
+}
+
+void BinlogFileWriter::Flush() {
+  std::size_t offset = 0;
+  while (m_fd >= 0 && offset < m_buffer.size()) {
+    const ssize_t written =
+        ::write(m_fd, m_buffer.data() + offset, m_buffer.size() - offset);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      ++m_errors;
+      break;
+    }
+    offset += static_cast<std::size_t>(written);
+  }
+  m_buffer.clear();
+}
+
+template <typename T>
+bool BinlogFileReader::Get(T& value) {
+  return static_cast<bool>(
+      m_input.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+bool BinlogFileReader::ReadString(std::uint32_t len, std::string& value) {
+  if (len > kMaxEntryField) {
+    return false;
+  }
+  value.resize(len);
+  return static_cast<bool>(m_input.read(value.data(), len));
+}
+
+bool BinlogFileReader::ReadHeader() {
+  char magic[sizeof(kBinlogMagic)];
+  std::uint16_t version = 0;
+  if (!m_input.read(magic, sizeof(magic)) || !Get(version)) {
+    return false;
+  }
+  return std::memcmp(magic, kBinlogMagic, sizeof(magic)) == 0 &&
+         version == kBinlogVersion;
+}
+
+bool BinlogFileReader::ReadSite() {
+  BinlogSiteInfo site;
+  std::int32_t severity = 0;
+  std::int32_t line = 0;
+  std::uint32_t file_len = 0;
+  std::uint32_t format_len = 0;
+  std::uint32_t types_len = 0;
+  if (!Get(site.id) || !Get(severity) || !Get(line) || !Get(file_len) ||
+      !Get(format_len) || !Get(types_len) ||
+      !ReadString(file_len, site.file) ||
+      !ReadString(format_len, site.format) ||
+      !ReadString(types_len, site.arg_types)) {
+    return false;
+  }
+  site.severity = severity;
+  site.line = line;
+  m_sites[site.id] = std::move(site);
+  return true;
+}
+
+bool BinlogFileReader::Next(BinlogEvent& event) {
+  if (m_corrupt) {
+    return false;
+  }
+  if (!m_header_read) {
+    if (!ReadHeader()) {
+      m_corrupt = true;
+      return false;
+    }
+    m_header_read = true;
+  }
+
+  while (true) {
+    BinlogEntry tag{};
+    if (!Get(tag)) {
+      return false;  // Clean end of file
+    }
+    switch (tag) {
+      case BinlogEntry::Session: {
+        std::int64_t start_us = 0;
+        std::int32_t pid = 0;
+        if (!Get(start_us) || !Get(pid)) {
+          m_corrupt = true;
+          return false;
+        }
+        m_sites.clear();
+        break;
+      }
+      case BinlogEntry::Site:
+        if (!ReadSite()) {
+          m_corrupt = true;
+          return false;
+        }
+        break;
+      case BinlogEntry::Event: {
+        std::uint32_t site_id = 0;
+        std::int32_t tid = 0;
+        std::uint32_t payload_len = 0;
+        if (!Get(site_id) || !Get(event.timestamp_us) || !Get(tid) ||
+            !Get(payload_len) || !ReadString(payload_len, event.payload)) {
+          m_corrupt = true;
+          return false;
+        }
+        const auto site = m_sites.find(site_id);
+        if (site == m_sites.end()) {
+          m_corrupt = true;
+          return false;
+        }
+        event.site = &site->second;
+        event.tid = tid;
+        return true;
+      }
+      default:
+        m_corrupt = true;
+        return false;
+    }
+  }
+}
+
+}  // namespace comm
@@ -0,0 +1,169 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_binlog_file.h
+ * @brief Binary log file format written by the async writer
+ * @details Layout (native byte order):
+ *          - file header: "MCBLOG" + uint16_t version
+ *          - entries, each starting with a uint8_t tag:
+ *            - Session: int64_t start_us, int32_t pid. Written whenever a
+ *              process opens the file; site ids are only valid within a
+ *              session.
+ *            - Site: uint32_t id, int32_t severity, int32_t line,
+ *              uint32_t file_len, uint32_t format_len, uint32_t types_len,
+ *              then the three strings. Written before the first event of the
+ *              site in the session.
+ *            - Event: uint32_t site_id, int64_t timestamp_us, int32_t tid,
+ *              uint32_t payload_len, then the BLOG() payload.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+#include "comm_binlog.h"
+
+namespace comm {
+
+/// File magic and format version
+inline constexpr char kBinlogMagic[6] = {'M', 'C', 'B', 'L', 'O', 'G'};
+inline constexpr std::uint16_t kBinlogVersion = 1;
+
+/**
+ * @brief Entry tags of the binary log file
+ */
+enum class BinlogEntry : std::uint8_t {
+  Site = 1,
+  Event = 2,
+  Session = 3,
+};
+
+/**
+ * @class BinlogFileWriter
+ * @brief Appends BLOG() records to a binary log file (writer thread only)
+ */
+class BinlogFileWriter {
+ public:
+  BinlogFileWriter() = default;
+  ~BinlogFileWriter();
+
+  BinlogFileWriter(const BinlogFileWriter&) = delete;
+  BinlogFileWriter& operator=(const BinlogFileWriter&) = delete;
+
+  /**
+   * @brief Open (append) path and start a new session
+   * @return Error code from open()/write() on failure
+   */
+  std::error_code Open(const std::string& path);
+
+  /**
+   * @brief Buffer one event, preceded by its site description if needed
+   */
+  void Append(const BinlogSite& site, std::uint32_t site_id,
+              std::int64_t timestamp_us, pid_t tid, std::string_view payload);
+
+  /**
+   * @brief Write buffered entries to the file
+   */
+  void Flush();
+
+  /**
+   * @brief Number of failed write() calls
+   */
+  std::uint64_t GetErrorCount() const { return m_errors; }
+
+ private:
+  template <typename T>
+  void Put(const T& value);
+  void PutBytes(std::string_view bytes);
+
+  int m_fd{-1};
+  std::vector<char> m_buffer;
+  std::vector<bool> m_defined_sites;
+  std::uint64_t m_errors{0};
+};
+
+/**
+ * @brief Call site as described in a binary log file
+ */
+struct BinlogSiteInfo {
+  std::uint32_t id{0};
+  int severity{0};
+  int line{0};
+  std::string file;
+  std::string format;
+  std::string arg_types;
+};
+
+/**
+ * @brief One decoded event; site points into the reader's session table
+ */
+struct BinlogEvent {
+  const BinlogSiteInfo* site{nullptr};
+  std::int64_t timestamp_us{0};
+  pid_t tid{0};
+  std::string payload;
+};
+
+/**
+ * @class BinlogFileReader
+ * @brief Sequential reader of binary log files
+ */
+class BinlogFileReader {
+ public:
+  explicit BinlogFileReader(std::istream& input) : m_input(input) {}
+
+  /**
+   * @brief Read the next event
+   * @return False at end of file or on a malformed entry (see IsCorrupt())
+   * @note Invalidates the site pointer of the previous event on session change
+   */
+  bool Next(BinlogEvent& event);
+
+  /**
+   * @brief True when reading stopped on a malformed or truncated entry
+   */
+  bool IsCorrupt() const { return m_corrupt; }
+
+ private:
+  bool ReadHeader();
+  bool ReadSite();
+  bool ReadString(std::uint32_t len, std::string& value);
+  template <typename T>
+  bool Get(T& value);
+
+  std::istream& m_input;
+  bool m_header_read{false};
+  bool m_corrupt{false};
+  std::unordered_map<std::uint32_t, BinlogSiteInfo> m_sites;
+};
+
+/**
+ * @brief Append the text of an encoded BLOG() record to out
+ * @param format Site format string with "{}" placeholders
+ * @param arg_types One BinlogTag per argument
+ * @param payload Encoded arguments
+ */
+void RenderBinlogMessage(std::string_view format, std::string_view arg_types,
+                         std::string_view payload, std::string& out);
+
+/**
+ * @brief Call site registered under site_id, nullptr if unknown
+ */
+const BinlogSite* FindBinlogSite(std::uint32_t site_id);
+
+/**
+ * @brief Basename of a __FILE__ path
+ */
+const char* BinlogBaseName(const char* path);
+
+}  // namespace comm
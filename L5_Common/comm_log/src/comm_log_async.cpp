@@ -0,0 +1,705 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_log_async.cpp
+ * @brief Asynchronous glog sink: per-thread rings drained by a writer thread
+ */
+
+#include "comm_log.h"
+
+#include <glog/logging.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <thread>
+
+#include "comm_binlog_file.h"
+#include "comm_log_file.h"
+#include "comm_log_level.h"
+#include "comm_log_limit.h"
+#include "comm_log_ring.h"
+#include "comm_terminate_signals.h"
+
+namespace comm {
+
+namespace {
+
+/// Upper bound of records handed to outputs in one Write() call
+constexpr std::size_t kMaxBatch = 512;
+
+/// Minimum share of a batch every ring gets when several rings are busy
+constexpr std::size_t kMinRingQuota = 16;
+
+/// Space reserved per record for the formatted glog prefix
+constexpr std::size_t kPrefixCapacity = 128;
+
+/// Set by send() when the record requires WaitTillSent() to flush
+thread_local bool t_flush_pending = false;
+
+/// True on the writer thread; records logged there cannot be queued safely
+thread_local bool t_is_writer = false;
+
+}  // namespace
+
+/**
+ * @class AsyncLogSink
+ * @brief google::LogSink queuing records into per-thread rings
+ * @note glog calls send() under its global log mutex and WaitTillSent()
+ *       right after it, outside the mutex, on the logging thread
+ */
+class AsyncLogSink final : public google::LogSink {
+ public:
+  AsyncLogSink(const AsyncLogOptions& options,
+               std::vector<std::unique_ptr<LogOutput>> outputs,
+               std::unique_ptr<BinlogFileWriter> binary_file)
+      : m_options(options),
+        m_outputs(std::move(outputs)),
+        m_binary_file(std::move(binary_file)) {
+    // Losses of earlier sinks were already reported by them
+    AsyncLogStats losses;
+    LogRingRegistry::Instance().AddLossStats(losses);
+    m_reported_losses = losses.dropped + losses.sampled_out;
+  }
+
+  ~AsyncLogSink() override { StopWriter(); }
+
+  std::error_code StartWriter() {
+    try {
+      // Started before Terminate::Start(): keep its signals off this thread
+      const TerminationSignalBlock block;
+      m_writer = std::thread(&AsyncLogSink::WriterLoop, this);
+    } catch (const std::exception&) {
+      return make_error_code(LogError::ThreadCreationFailed);
+    }
+    return {};
+  }
+
+  void StopWriter() {
+    if (!m_writer.joinable()) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(m_flush_mutex);
+      m_stop = true;
+    }
+    LogRingRegistry::Instance().RequestWake();
+    m_writer.join();
+  }
+
+  void send(google::LogSeverity severity, const char* full_filename,
+            const char* base_filename, int line,
+            const google::LogMessageTime& logmsgtime, const char* message,
+            size_t message_len) override {
+    if (t_is_writer || !IsLogRecordEnabled(full_filename, severity)) {
+      return;
+    }
+    auto& rings = LogRingRegistry::Instance();
+    const std::size_t max_message =
+        rings.MaxFrameSize() - sizeof(LogRecordHeader);
+    message_len = std::min(message_len, max_message);
+    const std::uint32_t size =
+        AlignLogFrame(sizeof(LogRecordHeader) + message_len);
+
+    ThreadLogRing* ring = nullptr;
+    char* slot = rings.Reserve(size, ring);
+    if (slot == nullptr) {
+      return;
+    }
+
+    auto* header = reinterpret_cast<LogRecordHeader*>(slot);
+    header->frame.size = size;
+    header->frame.kind = LogFrameKind::Text;
+    header->timestamp_us =
+        static_cast<std::int64_t>(logmsgtime.timestamp()) * 1000000 +
+        logmsgtime.usec();
+    header->full_filename = full_filename;
+    header->base_filename = base_filename;
+    header->line = line;
+    header->severity = severity;
+    header->message_len = static_cast<std::uint32_t>(message_len);
+    header->trace_id = GetLogTraceId();
+    header->config_generation = GetLogConfigGeneration();
+    std::memcpy(slot + sizeof(LogRecordHeader), message, message_len);
+    rings.Commit(ring);
+
+    if (severity >= m_options.flush_severity) {
+      t_flush_pending = true;
+    }
+  }
+
+  void WaitTillSent() override {
+    if (t_flush_pending) {
+      t_flush_pending = false;
+      Flush();
+    }
+  }
+
+  void Flush() {
+    if (t_is_writer) {
+      return;
+    }
+    std::unique_lock<std::mutex> lock(m_flush_mutex);
+    if (m_stop) {
+      return;
+    }
+    const std::uint64_t ticket = ++m_flush_requested;
+    LogRingRegistry::Instance().RequestWake();
+    m_flush_cv.wait(lock, [this, ticket] {
+      return m_flush_completed >= ticket || m_writer_exited;
+    });
+  }
+
+  /**
+   * @brief Writer-side counters of this sink (losses live in the registry)
+   */
+  AsyncLogStats GetStats() const {
+    AsyncLogStats stats;
+    stats.written = m_written.load(std::memory_order_relaxed);
+    stats.batches = m_batches.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+ private:
+  /**
+   * @brief Resolve a BLOG() site id, caching the registry lookup
+   */
+  const BinlogSite* LookupSite(std::uint32_t site_id) {
+    if (site_id >= m_sites.size()) {
+      m_sites.resize(site_id + 1, nullptr);
+    }
+    if (m_sites[site_id] == nullptr) {
+      m_sites[site_id] = FindBinlogSite(site_id);
+    }
+    return m_sites[site_id];
+  }
+
+  /**
+   * @brief Turn a binary frame into a file entry or a rendered LogRecord
+   */
+  void ConsumeBinary(const LogBinaryHeader* header, pid_t tid) {
+    const BinlogSite* site = LookupSite(header->site_id);
+    if (site == nullptr) {
+      return;
+    }
+    const std::string_view payload(reinterpret_cast<const char*>(header + 1),
+                                   header->payload_len);
+    if (m_binary_file) {
+      m_binary_file->Append(*site, header->site_id, header->timestamp_us, tid,
+                            payload);
+      ++m_binary_written;
+      return;
+    }
+
+    // References into a deque stay valid while it grows
+    if (m_rendered_used == m_rendered.size()) {
+      m_rendered.emplace_back();
+    }
+    std::string& text = m_rendered[m_rendered_used++];
+    text.clear();
+    RenderBinlogMessage(site->format, site->arg_types, payload, text);
+    m_batch.push_back(LogRecord{site->severity, tid, header->timestamp_us,
+                                site->file, BinlogBaseName(site->file),
+                                site->line, text, header->trace_id,
+                                header->config_generation});
+  }
+
+  /**
+   * @brief Move up to kMaxBatch records from the rings to the outputs
+   * @return Number of frames consumed
+   */
+  std::size_t DrainOnce(const std::vector<std::shared_ptr<ThreadLogRing>>& rings) {
+    m_batch.clear();
+    m_releases.clear();
+    m_rendered_used = 0;
+    m_binary_written = 0;
+    const std::size_t quota =
+        rings.empty() ? kMaxBatch
+                      : std::max(kMinRingQuota, kMaxBatch / rings.size());
+
+    std::size_t consumed = 0;
+    for (const auto& ring : rings) {
+      std::uint64_t cursor = ring->ring.Tail();
+      const std::uint64_t start = cursor;
+      std::size_t taken = 0;
+      while (taken < quota && consumed < kMaxBatch) {
+        const LogFrame* frame = ring->ring.Peek(cursor);
+        if (frame == nullptr) {
+          break;
+        }
+        if (frame->kind == LogFrameKind::Binary) {
+          ConsumeBinary(reinterpret_cast<const LogBinaryHeader*>(frame),
+                        ring->tid);
+        } else {
+          const auto* header = reinterpret_cast<const LogRecordHeader*>(frame);
+          m_batch.push_back(LogRecord{
+              header->severity, ring->tid, header->timestamp_us,
+              header->full_filename, header->base_filename, header->line,
+              std::string_view(reinterpret_cast<const char*>(header + 1),
+                               header->message_len),
+              header->trace_id, header->config_generation});
+        }
+        cursor += frame->size;
+        ++taken;
+        ++consumed;
+      }
+      if (cursor != start) {
+        m_releases.emplace_back(ring.get(), cursor);
+      }
+    }
+
+    if (!m_batch.empty()) {
+      // Interleave threads by time; each ring is already in order
+      std::stable_sort(m_batch.begin(), m_batch.end(),
+                       [](const LogRecord& a, const LogRecord& b) {
+                         return a.timestamp_us < b.timestamp_us;
+                       });
+      for (const auto& output : m_outputs) {
+        output->Write(m_batch);
+      }
+    }
+    if (consumed > 0) {
+      m_written.fetch_add(m_batch.size() + m_binary_written,
+                          std::memory_order_relaxed);
+      m_batches.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    for (const auto& [ring, cursor] : m_releases) {
+      ring->ring.Release(cursor);
+    }
+    return consumed;
+  }
+
+  /**
+   * @brief Emit a synthetic warning when records were lost since last report
+   */
+  void ReportLosses() {
+    AsyncLogStats stats;
+    LogRingRegistry::Instance().AddLossStats(stats);
+    const std::uint64_t lost = stats.dropped + stats.sampled_out;
+    if (lost == m_reported_losses) {
+      return;
+    }
+    char text[160];
+    const int len = std::snprintf(
+        text, sizeof(text),
+        "comm_log: %llu log record(s) discarded by overflow policy "
+        "(dropped total %llu, sampled out total %llu)",
+        static_cast<unsigned long long>(lost - m_reported_losses),
+        static_cast<unsigned long long>(stats.dropped),
+        static_cast<unsigned long long>(stats.sampled_out));
+    m_reported_losses = lost;
+
+    timespec now{};
+    clock_gettime(CLOCK_REALTIME, &now);
+    const LogRecord record{
+        google::GLOG_WARNING, ::gettid(),
+        static_cast<std::int64_t>(now.tv_sec) * 1000000 + now.tv_nsec / 1000,
+        __FILE__, "comm_log_async.cpp", __LINE__,
+        std::string_view(text, static_cast<std::size_t>(std::max(len, 0))),
+        0, GetLogConfigGeneration()};
+    for (const auto& output : m_outputs) {
+      output->Write(std::span<const LogRecord>(&record, 1));
+    }
+  }
+
+  /**
+   * @brief Summarize records suppressed by LOG_RATE_LIMITED()/LOG_SAMPLED()
+   * @details Covers sites that went quiet; busy sites report in-band with
+   *          their next record
+   */
+  void ReportSuppressed() {
+    const auto now = std::chrono::steady_clock::now();
+    if (now < m_next_summary) {
+      return;
+    }
+    m_next_summary = now + m_options.summary_interval;
+
+    timespec wall{};
+    clock_gettime(CLOCK_REALTIME, &wall);
+    const std::int64_t timestamp_us =
+        static_cast<std::int64_t>(wall.tv_sec) * 1000000 + wall.tv_nsec / 1000;
+    const pid_t tid = ::gettid();
+    CollectSuppressedLogs([&](const LogLimitSite& site, std::uint64_t count) {
+      char text[64];
+      const std::size_t len = FormatSuppressedNote(count, text, sizeof(text));
+      const LogRecord record{site.Severity(),
+                             tid,
+                             timestamp_us,
+                             site.File(),
+                             BinlogBaseName(site.File()),
+                             site.Line(),
+                             std::string_view(text, len),
+                             0,
+                             GetLogConfigGeneration()};
+      for (const auto& output : m_outputs) {
+        output->Write(std::span<const LogRecord>(&record, 1));
+      }
+    });
+  }
+
+  void WriterLoop() {
+    t_is_writer = true;
+    pthread_setname_np(pthread_self(), "comm_log");
+
+    auto& registry = LogRingRegistry::Instance();
+    std::vector<std::shared_ptr<ThreadLogRing>> rings;
+    std::uint64_t seen_version = ~std::uint64_t{0};
+
+    while (true) {
+      std::uint64_t flush_ticket = 0;
+      bool stopping = false;
+      {
+        std::lock_guard<std::mutex> lock(m_flush_mutex);
+        flush_ticket = m_flush_requested;
+        stopping = m_stop;
+      }
+
+      const std::uint64_t version = registry.Version();
+      if (version != seen_version) {
+        seen_version = version;
+        registry.Snapshot(rings);
+      }
+
+      if (DrainOnce(rings) > 0) {
+        continue;
+      }
+
+      // Rings are empty: everything logged before flush_ticket is written
+      ReportLosses();
+      ReportSuppressed();
+      if (m_binary_file) {
+        m_binary_file->Flush();
+      }
+      for (const auto& output : m_outputs) {
+        output->Flush();
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(m_flush_mutex);
+        m_flush_completed = flush_ticket;
+        m_flush_cv.notify_all();
+      }
+      if (stopping) {
+        break;
+      }
+      registry.WaitForWork(m_options.flush_interval);
+    }
+
+    std::lock_guard<std::mutex> lock(m_flush_mutex);
+    m_writer_exited = true;
+    m_flush_cv.notify_all();
+  }
+
+  const AsyncLogOptions m_options;
+  const std::vector<std::unique_ptr<LogOutput>> m_outputs;
+  const std::unique_ptr<BinlogFileWriter> m_binary_file;
+
+  /// Writer thread state
+  std::thread m_writer;
+  std::vector<LogRecord> m_batch;
+  std::vector<std::pair<ThreadLogRing*, std::uint64_t>> m_releases;
+  std::vector<const BinlogSite*> m_sites;
+  std::deque<std::string> m_rendered;
+  std::size_t m_rendered_used{0};
+  std::size_t m_binary_written{0};
+  std::uint64_t m_reported_losses{0};
+  std::chrono::steady_clock::time_point m_next_summary{};
+  std::atomic<std::uint64_t> m_written{0};
+  std::atomic<std::uint64_t> m_batches{0};
+
+  /// Flush and stop handshake (protected by m_flush_mutex)
+  std::mutex m_flush_mutex;
+  std::condition_variable m_flush_cv;
+  bool m_stop{false};
+  bool m_writer_exited{false};
+  std::uint64_t m_flush_requested{0};
+  std::uint64_t m_flush_completed{0};
+};
+
+/**
+ * @class SyncLogSink
+ * @brief google::LogSink writing records of enabled modules to stderr
+ * @details Stands in for glog's own stderr output while per-module levels are
+ *          set and the asynchronous backend is stopped: FLAGS_minloglevel is
+ *          then the lowest configured level, which glog applies to all modules
+ * @note glog calls send() under its global log mutex, which serializes writes
+ */
+class SyncLogSink final : public google::LogSink {
+ public:
+  void send(google::LogSeverity severity, const char* full_filename,
+            const char* base_filename, int line,
+            const google::LogMessageTime& logmsgtime, const char* message,
+            size_t message_len) override {
+    if (!IsLogRecordEnabled(full_filename, severity)) {
+      return;
+    }
+    LogRecord record{severity,
+                     static_cast<pid_t>(::gettid()),
+                     static_cast<std::int64_t>(logmsgtime.timestamp()) * 1000000 +
+                         logmsgtime.usec(),
+                     full_filename,
+                     base_filename,
+                     line,
+                     std::string_view(message, message_len),
+                     GetLogTraceId(),
+                     GetLogConfigGeneration()};
+    m_output.Write(std::span<const LogRecord>(&record, 1));
+  }
+
+ private:
+  FdLogOutput m_output{STDERR_FILENO};
+};
+
+// Error category implementation
+std::string LogErrorCategory::message(int error_value) const {
+  switch (static_cast<LogError>(error_value)) {
+    case LogError::Success:
+      return "Success";
+    case LogError::AlreadyRunning:
+      return "Asynchronous logging is already running";
+    case LogError::InvalidOptions:
+      return "Invalid logging options";
+    case LogError::ThreadCreationFailed:
+      return "Failed to create log writer thread";
+    case LogError::OutputOpenFailed:
+      return "Failed to open log output";
+    default:
+      return "Unknown logging error";
+  }
+}
+
+const std::error_category& get_log_error_category() noexcept {
+  static LogErrorCategory instance;
+  return instance;
+}
+
+FdLogOutput::FdLogOutput(int fd) : m_fd(fd) {
+  m_prefixes.resize(kMaxBatch * kPrefixCapacity);
+}
+
+void FdLogOutput::Write(std::span<const LogRecord> records) {
+  static char newline = '\n';
+  constexpr std::size_t kIovecsPerRecord = 3;
+  constexpr std::size_t kRecordsPerCall = IOV_MAX / kIovecsPerRecord;
+
+  if (m_prefixes.size() < records.size() * kPrefixCapacity) {
+    m_prefixes.resize(records.size() * kPrefixCapacity);
+  }
+
+  iovec iov[kRecordsPerCall * kIovecsPerRecord];
+  std::size_t index = 0;
+  while (index < records.size()) {
+    const std::size_t count =
+        std::min(kRecordsPerCall, records.size() - index);
+    std::size_t iov_count = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      const LogRecord& record = records[index + i];
+      char* prefix = m_prefixes.data() + (index + i) * kPrefixCapacity;
+      iov[iov_count++] = {prefix,
+                          FormatLogPrefix(record, prefix, kPrefixCapacity)};
+      iov[iov_count++] = {const_cast<char*>(record.message.data()),
+                          record.message.size()};
+      iov[iov_count++] = {&newline, 1};
+    }
+    index += count;
+
+    // Retry on EINTR and continue after partial writes
+    iovec* pending = iov;
+    while (iov_count > 0) {
+      const ssize_t written =
+          ::writev(m_fd, pending, static_cast<int>(iov_count));
+      if (written < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        ++m_errors;
+        break;
+      }
+      auto remaining = static_cast<std::size_t>(written);
+      while (iov_count > 0 && remaining >= pending->iov_len) {
+        remaining -= pending->iov_len;
+        ++pending;
+        --iov_count;
+      }
+      if (iov_count > 0) {
+        pending->iov_base = static_cast<char*>(pending->iov_base) + remaining;
+        pending->iov_len -= remaining;
+      }
+    }
+  }
+}
+
+AsyncLog& AsyncLog::Instance() {
+  static AsyncLog instance;
+  return instance;
+}
+
+AsyncLog::AsyncLog() = default;
+
+AsyncLog::~AsyncLog() {
+  Stop();
+  SetModuleFilter(false);  // glog must not keep a pointer to the sink
+}
+
+std::error_code AsyncLog::Start(const AsyncLogOptions& options) {
+  std::vector<std::unique_ptr<LogOutput>> outputs;
+  if (options.output == LogOutputKind::Journald) {
+    outputs.push_back(std::make_unique<JournaldLogOutput>());
+  } else if (options.output == LogOutputKind::File) {
+    auto file = std::make_unique<RotatingFileLogOutput>(options.file);
+    if (auto ec = file->Open(); ec) {
+      LOG(WARNING) << "Cannot open log file " << options.file.path << ": "
+                   << ec.message();
+      return make_error_code(LogError::OutputOpenFailed);
+    }
+    outputs.push_back(std::move(file));
+  } else {
+    outputs.push_back(std::make_unique<FdLogOutput>(STDERR_FILENO));
+  }
+  return Start(options, std::move(outputs));
+}
+
+std::error_code AsyncLog::Start(const AsyncLogOptions& options,
+                                std::vector<std::unique_ptr<LogOutput>> outputs) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_sink) {
+    return make_error_code(LogError::AlreadyRunning);
+  }
+  if (options.ring_size_bytes == 0 || options.sample_rate == 0 ||
+      outputs.empty()) {
+    return make_error_code(LogError::InvalidOptions);
+  }
+
+  std::unique_ptr<BinlogFileWriter> binary_file;
+  if (!options.binary_file.empty()) {
+    binary_file = std::make_unique<BinlogFileWriter>();
+    if (auto ec = binary_file->Open(options.binary_file); ec) {
+      LOG(WARNING) << "Cannot open binary log " << options.binary_file << ": "
+                   << ec.message();
+      return make_error_code(LogError::OutputOpenFailed);
+    }
+  }
+
+  auto& rings = LogRingRegistry::Instance();
+  rings.Activate(options);
+  auto sink = std::make_unique<AsyncLogSink>(options, std::move(outputs),
+                                             std::move(binary_file));
+  if (auto ec = sink->StartWriter(); ec) {
+    rings.Deactivate();
+    return ec;
+  }
+
+  LOG(INFO) << "Starting asynchronous logging (ring "
+            << options.ring_size_bytes << " bytes per thread)";
+
+  // Route everything through the sink: no direct stderr, no log files
+  google::AddLogSink(sink.get());
+  if (m_sync_sink) {
+    google::RemoveLogSink(m_sync_sink.get());  // glog's output is already off
+    m_sync_sink.reset();
+  } else {
+    DisableGlogOutput();
+  }
+
+  m_sink = std::move(sink);
+  m_running.store(true, std::memory_order_release);
+  return make_error_code(LogError::Success);
+}
+
+void AsyncLog::Stop() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_sink) {
+    return;
+  }
+
+  // Restore direct logging first so nothing logged from now on is lost
+  m_sink->Flush();
+  if (m_module_filter) {
+    m_sync_sink = std::make_unique<SyncLogSink>();
+    google::AddLogSink(m_sync_sink.get());
+  } else {
+    RestoreGlogOutput();
+  }
+  google::RemoveLogSink(m_sink.get());
+  LogRingRegistry::Instance().Deactivate();
+  m_running.store(false, std::memory_order_release);
+
+  // The writer drains what BLOG() queued before Deactivate() on its way out
+  m_sink->StopWriter();
+  AsyncLogStats stats = m_sink->GetStats();
+  m_stopped_stats.written += stats.written;
+  m_stopped_stats.batches += stats.batches;
+  m_sink.reset();
+  LogRingRegistry::Instance().AddLossStats(stats);
+
+  LOG(INFO) << "Asynchronous logging stopped (written " << stats.written
+            << ", dropped " << stats.dropped << ", sampled out "
+            << stats.sampled_out << ")";
+}
+
+void AsyncLog::SetModuleFilter(bool enabled) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_module_filter = enabled;
+  if (m_sink) {
+    return;  // The asynchronous sink filters by module itself
+  }
+  if (enabled && !m_sync_sink) {
+    m_sync_sink = std::make_unique<SyncLogSink>();
+    google::AddLogSink(m_sync_sink.get());
+    DisableGlogOutput();
+  } else if (!enabled && m_sync_sink) {
+    RestoreGlogOutput();
+    google::RemoveLogSink(m_sync_sink.get());
+    m_sync_sink.reset();
+  }
+}
+
+void AsyncLog::DisableGlogOutput() {
+  m_saved_logtostderr = FLAGS_logtostderr;
+  m_saved_stderrthreshold = FLAGS_stderrthreshold;
+  for (int severity = 0; severity < google::NUM_SEVERITIES; ++severity) {
+    google::SetLogDestination(severity, "");
+  }
+  FLAGS_stderrthreshold = google::NUM_SEVERITIES;
+  FLAGS_logtostderr = false;
+}
+
+void AsyncLog::RestoreGlogOutput() {
+  FLAGS_logtostderr = m_saved_logtostderr;
+  FLAGS_stderrthreshold = m_saved_stderrthreshold;
+}
+
+void AsyncLog::Flush() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_sink) {
+    m_sink->Flush();
+  }
+}
+
+bool AsyncLog::IsRunning() const {
+  return m_running.load(std::memory_order_acquire);
+}
+
+AsyncLogStats AsyncLog::GetStats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  AsyncLogStats stats = m_stopped_stats;
+  if (m_sink) {
+    const AsyncLogStats current = m_sink->GetStats();
+    stats.written += current.written;
+    stats.batches += current.batches;
+  }
+  LogRingRegistry::Instance().AddLossStats(stats);
+  return stats;
+}
+
+}  // namespace comm
@@ -0,0 +1,261 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_log_config.cpp
+ * @brief Implementation of LogConfig serialization and option parsing
+ */
+
+#include "comm_log_config.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cctype>
+
+namespace comm {
+
+namespace {
+
+bool EqualsIgnoreCase(std::string_view lhs, std::string_view rhs) {
+  return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                    [](char a, char b) {
+                      return std::tolower(static_cast<unsigned char>(a)) ==
+                             std::tolower(static_cast<unsigned char>(b));
+                    });
+}
+
+}  // namespace
+
+void to_toml(toml::value& dest, const LogConfig& value) {
+  dest["async"] = value.async;
+  dest["output"] = value.output;
+  dest["overflow_policy"] = value.overflow_policy;
+  dest["ring_size_kb"] = value.ring_size_kb;
+  dest["sample_rate"] = value.sample_rate;
+  dest["flush_interval_ms"] = value.flush_interval_ms;
+  dest["flush_severity"] = value.flush_severity;
+  dest["binary_file"] = value.binary_file;
+  dest["level"] = value.level;
+  toml::value modules(toml::table{});
+  for (const auto& [name, level] : value.modules) {
+    modules[name] = level;
+  }
+  dest["modules"] = modules;
+  dest["suppressed_summary_s"] = value.suppressed_summary_s;
+  dest["file_path"] = value.file_path;
+  dest["file_max_size_mb"] = value.file_max_size_mb;
+  dest["file_rotate_interval_s"] = value.file_rotate_interval_s;
+  dest["file_max_files"] = value.file_max_files;
+  dest["file_max_age_h"] = value.file_max_age_h;
+  dest["file_compression"] = value.file_compression;
+  dest["file_compression_level"] = value.file_compression_level;
+  dest["file_buffer_kb"] = value.file_buffer_kb;
+}
+
+void from_toml(const toml::value& src, LogConfig& value) {
+  // Use default-constructed struct as source of default values (created once)
+  static const LogConfig defaults;
+
+  try {
+    value.async = toml::find_or(src, "async", defaults.async);
+    value.output = toml::find_or(src, "output", defaults.output);
+    value.overflow_policy =
+        toml::find_or(src, "overflow_policy", defaults.overflow_policy);
+    value.ring_size_kb = toml::find_or(src, "ring_size_kb", defaults.ring_size_kb);
+    value.sample_rate = toml::find_or(src, "sample_rate", defaults.sample_rate);
+    value.flush_interval_ms =
+        toml::find_or(src, "flush_interval_ms", defaults.flush_interval_ms);
+    value.flush_severity =
+        toml::find_or(src, "flush_severity", defaults.flush_severity);
+    value.binary_file = toml::find_or(src, "binary_file", defaults.binary_file);
+    value.level = toml::find_or(src, "level", defaults.level);
+    value.modules = toml::find_or(src, "modules", defaults.modules);
+    value.suppressed_summary_s = toml::find_or(src, "suppressed_summary_s",
+                                               defaults.suppressed_summary_s);
+    value.file_path = toml::find_or(src, "file_path", defaults.file_path);
+    value.file_max_size_mb =
+        toml::find_or(src, "file_max_size_mb", defaults.file_max_size_mb);
+    value.file_rotate_interval_s = toml::find_or(
+        src, "file_rotate_interval_s", defaults.file_rotate_interval_s);
+    value.file_max_files =
+        toml::find_or(src, "file_max_files", defaults.file_max_files);
+    value.file_max_age_h =
+        toml::find_or(src, "file_max_age_h", defaults.file_max_age_h);
+    value.file_compression =
+        toml::find_or(src, "file_compression", defaults.file_compression);
+    value.file_compression_level = toml::find_or(
+        src, "file_compression_level", defaults.file_compression_level);
+    value.file_buffer_kb =
+        toml::find_or(src, "file_buffer_kb", defaults.file_buffer_kb);
+
+    LOG(INFO) << "Loaded LogConfig";
+    LOG(INFO) << "  async: " << (value.async ? "true" : "false");
+    LOG(INFO) << "  output: " << value.output;
+    if (value.output == "file") {
+      LOG(INFO) << "  file_path: " << value.file_path;
+      LOG(INFO) << "  file_max_size_mb: " << value.file_max_size_mb;
+      LOG(INFO) << "  file_max_files: " << value.file_max_files;
+      LOG(INFO) << "  file_compression: " << value.file_compression;
+    }
+    LOG(INFO) << "  overflow_policy: " << value.overflow_policy;
+    LOG(INFO) << "  ring_size_kb: " << value.ring_size_kb;
+    if (!value.binary_file.empty()) {
+      LOG(INFO) << "  binary_file: " << value.binary_file;
+    }
+    LOG(INFO) << "  level: " << value.level;
+    for (const auto& [name, level] : value.modules) {
+      LOG(INFO) << "  modules." << name << ": " << level;
+    }
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Error parsing LogConfig: " << e.what();
+    LOG(WARNING) << "Using default values";
+    value = defaults;
+  }
+}
+
+bool ParseLogOverflowPolicy(std::string_view name, LogOverflowPolicy& policy) {
+  if (EqualsIgnoreCase(name, "drop")) {
+    policy = LogOverflowPolicy::Drop;
+  } else if (EqualsIgnoreCase(name, "block")) {
+    policy = LogOverflowPolicy::Block;
+  } else if (EqualsIgnoreCase(name, "sample")) {
+    policy = LogOverflowPolicy::Sample;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool ParseLogOutput(std::string_view name, LogOutputKind& output) {
+  if (EqualsIgnoreCase(name, "stderr")) {
+    output = LogOutputKind::Stderr;
+  } else if (EqualsIgnoreCase(name, "journald")) {
+    output = LogOutputKind::Journald;
+  } else if (EqualsIgnoreCase(name, "file")) {
+    output = LogOutputKind::File;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool ParseLogCompression(std::string_view name, LogCompression& compression) {
+  if (EqualsIgnoreCase(name, "none")) {
+    compression = LogCompression::None;
+  } else if (EqualsIgnoreCase(name, "gzip")) {
+    compression = LogCompression::Gzip;
+  } else if (EqualsIgnoreCase(name, "zstd")) {
+    compression = LogCompression::Zstd;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool ParseLogSeverity(std::string_view name, int& severity) {
+  for (int candidate = 0; candidate < google::NUM_SEVERITIES; ++candidate) {
+    if (EqualsIgnoreCase(name, google::GetLogSeverityName(candidate))) {
+      severity = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ParseLogLevel(std::string_view name, LogLevel& level) {
+  if (name.size() >= 2 && (name[0] == 'V' || name[0] == 'v')) {
+    int verbosity = 0;
+    for (char c : name.substr(1)) {
+      if (c < '0' || c > '9' || verbosity > 100) {
+        return false;
+      }
+      verbosity = verbosity * 10 + (c - '0');
+    }
+    level = LogLevel{google::GLOG_INFO, verbosity};
+    return true;
+  }
+  int severity = 0;
+  if (!ParseLogSeverity(name, severity)) {
+    return false;
+  }
+  level = LogLevel{severity, 0};
+  return true;
+}
+
+void ApplyLogConfigLevels(const LogConfig& config) {
+  LogLevel global;
+  if (!ParseLogLevel(config.level, global)) {
+    LOG(WARNING) << "Unknown logging.level '" << config.level
+                 << "', using INFO";
+  }
+  std::map<std::string, LogLevel> modules;
+  for (const auto& [name, text] : config.modules) {
+    LogLevel level;
+    if (ParseLogLevel(text, level)) {
+      modules.emplace(name, level);
+    } else {
+      LOG(WARNING) << "Unknown level '" << text << "' for logging.modules."
+                   << name << ", ignoring";
+    }
+  }
+  ApplyLogLevels(global, modules);
+}
+
+AsyncLogOptions MakeAsyncLogOptions(const LogConfig& config) {
+  AsyncLogOptions options;
+
+  if (!ParseLogOutput(config.output, options.output)) {
+    LOG(WARNING) << "Unknown logging.output '" << config.output
+                 << "', using 'stderr'";
+  }
+  if (!ParseLogOverflowPolicy(config.overflow_policy, options.overflow_policy)) {
+    LOG(WARNING) << "Unknown logging.overflow_policy '" << config.overflow_policy
+                 << "', using 'drop'";
+  }
+  if (config.ring_size_kb > 0) {
+    options.ring_size_bytes = static_cast<std::size_t>(config.ring_size_kb) * 1024;
+  } else {
+    LOG(WARNING) << "Invalid logging.ring_size_kb " << config.ring_size_kb
+                 << ", using default";
+  }
+  if (config.sample_rate > 0) {
+    options.sample_rate = static_cast<std::uint32_t>(config.sample_rate);
+  }
+  if (config.flush_interval_ms > 0) {
+    options.flush_interval = std::chrono::milliseconds(config.flush_interval_ms);
+  }
+  if (!ParseLogSeverity(config.flush_severity, options.flush_severity)) {
+    LOG(WARNING) << "Unknown logging.flush_severity '" << config.flush_severity
+                 << "', using ERROR";
+  }
+  options.binary_file = config.binary_file;
+  if (config.suppressed_summary_s > 0) {
+    options.summary_interval = std::chrono::seconds(config.suppressed_summary_s);
+  }
+
+  FileLogOptions& file = options.file;
+  file.path = config.file_path;
+  if (config.file_max_size_mb > 0) {
+    file.max_size_bytes =
+        static_cast<std::uint64_t>(config.file_max_size_mb) * 1024 * 1024;
+  } else {
+    LOG(WARNING) << "Invalid logging.file_max_size_mb "
+                 << config.file_max_size_mb << ", using default";
+  }
+  file.rotate_interval =
+      std::chrono::seconds(std::max(config.file_rotate_interval_s, 0));
+  file.max_files = static_cast<std::uint32_t>(std::max(config.file_max_files, 0));
+  file.max_age = std::chrono::hours(std::max(config.file_max_age_h, 0));
+  if (!ParseLogCompression(config.file_compression, file.compression)) {
+    LOG(WARNING) << "Unknown logging.file_compression '"
+                 << config.file_compression << "', using 'gzip'";
+  }
+  file.compression_level = config.file_compression_level;
+  if (config.file_buffer_kb > 0) {
+    file.buffer_size_bytes = static_cast<std::size_t>(config.file_buffer_kb) * 1024;
+  }
+  return options;
+}
+
+}  // namespace comm
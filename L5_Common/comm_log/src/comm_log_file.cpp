@@ -0,0 +1,513 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_log_file.cpp
+ * @brief Rotating file output, segment compression and retention
+ */
+
+#include "comm_log_file.h"
+
+#include <fcntl.h>
+#include <glog/logging.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#ifdef COMM_LOG_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <vector>
+
+#include "comm_terminate_signals.h"
+
+namespace comm {
+
+namespace {
+
+/// fallocate() granularity while a segment grows
+constexpr std::uint64_t kPreallocateChunk = 8 * 1024 * 1024;
+
+/// Read size of the compressor
+constexpr std::size_t kCompressChunk = 256 * 1024;
+
+/// "YYYYmmdd-HHMMSS.uuuuuu" suffix of rotated segments
+constexpr std::size_t kSegmentStampLength = 22;
+
+const char* CompressedExtension(LogCompression compression) {
+  switch (compression) {
+    case LogCompression::Gzip:
+      return ".gz";
+    case LogCompression::Zstd:
+      return ".zst";
+    default:
+      return "";
+  }
+}
+
+std::int64_t RealtimeNowUs() {
+  timespec now{};
+  clock_gettime(CLOCK_REALTIME, &now);
+  return static_cast<std::int64_t>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+/**
+ * @brief Write all bytes, retrying on EINTR and partial writes
+ */
+bool WriteAll(int fd, const char* data, std::size_t size) {
+  while (size > 0) {
+    const ssize_t written = ::write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += written;
+    size -= static_cast<std::size_t>(written);
+  }
+  return true;
+}
+
+ssize_t ReadSome(int fd, char* data, std::size_t size) {
+  ssize_t count = 0;
+  do {
+    count = ::read(fd, data, size);
+  } while (count < 0 && errno == EINTR);
+  return count;
+}
+
+bool GzipStream(int in_fd, int out_fd, int level, const std::atomic<bool>& stop) {
+  z_stream stream{};
+  if (deflateInit2(&stream, level != 0 ? level : Z_DEFAULT_COMPRESSION,
+                   Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    return false;
+  }
+  std::vector<char> in(kCompressChunk);
+  std::vector<char> out(kCompressChunk);
+  bool ok = true;
+  int flush = Z_NO_FLUSH;
+  while (ok && flush != Z_FINISH) {
+    const ssize_t count = ReadSome(in_fd, in.data(), in.size());
+    if (count < 0 || stop.load(std::memory_order_relaxed)) {
+      ok = false;
+      break;
+    }
+    flush = count == 0 ? Z_FINISH : Z_NO_FLUSH;
+    stream.next_in = reinterpret_cast<Bytef*>(in.data());
+    stream.avail_in = static_cast<uInt>(count);
+    do {
+      stream.next_out = reinterpret_cast<Bytef*>(out.data());
+      stream.avail_out = static_cast<uInt>(out.size());
+      if (deflate(&stream, flush) == Z_STREAM_ERROR) {
+        ok = false;
+        break;
+      }
+      ok = WriteAll(out_fd, out.data(), out.size() - stream.avail_out);
+    } while (ok && stream.avail_out == 0);
+  }
+  deflateEnd(&stream);
+  return ok;
+}
+
+#ifdef COMM_LOG_HAVE_ZSTD
+bool ZstdStream(int in_fd, int out_fd, int level, const std::atomic<bool>& stop) {
+  ZSTD_CCtx* context = ZSTD_createCCtx();
+  if (context == nullptr) {
+    return false;
+  }
+  if (level != 0) {
+    ZSTD_CCtx_setParameter(context, ZSTD_c_compressionLevel, level);
+  }
+  std::vector<char> in(ZSTD_CStreamInSize());
+  std::vector<char> out(ZSTD_CStreamOutSize());
+  bool ok = true;
+  bool last = false;
+  while (ok && !last) {
+    const ssize_t count = ReadSome(in_fd, in.data(), in.size());
+    if (count < 0 || stop.load(std::memory_order_relaxed)) {
+      ok = false;
+      break;
+    }
+    last = count == 0;
+    const ZSTD_EndDirective mode = last ? ZSTD_e_end : ZSTD_e_continue;
+    ZSTD_inBuffer input{in.data(), static_cast<std::size_t>(count), 0};
+    bool finished = false;
+    while (ok && !finished) {
+      ZSTD_outBuffer output{out.data(), out.size(), 0};
+      const std::size_t remaining =
+          ZSTD_compressStream2(context, &output, &input, mode);
+      ok = !ZSTD_isError(remaining) && WriteAll(out_fd, out.data(), output.pos);
+      finished = last ? remaining == 0 : input.pos == input.size;
+    }
+  }
+  ZSTD_freeCCtx(context);
+  return ok;
+}
+#endif
+
+/**
+ * @brief Compress source into source + extension, then remove source
+ * @return False on failure; a partial ".part" file is removed
+ * @details The compressed file keeps the modification time of the segment so
+ *          max_age applies to when the records were written
+ */
+bool CompressSegment(const std::string& source, LogCompression compression,
+                     int level, const std::atomic<bool>& stop) {
+  const int in_fd = ::open(source.c_str(), O_RDONLY | O_CLOEXEC);
+  if (in_fd < 0) {
+    return false;
+  }
+  struct stat info {};
+  ::fstat(in_fd, &info);
+
+  const std::string target = source + CompressedExtension(compression);
+  const std::string partial = target + ".part";
+  const int out_fd =
+      ::open(partial.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (out_fd < 0) {
+    ::close(in_fd);
+    return false;
+  }
+
+  bool ok = false;
+#ifdef COMM_LOG_HAVE_ZSTD
+  if (compression == LogCompression::Zstd) {
+    ok = ZstdStream(in_fd, out_fd, level, stop);
+  } else {
+    ok = GzipStream(in_fd, out_fd, level, stop);
+  }
+#else
+  ok = GzipStream(in_fd, out_fd, level, stop);
+#endif
+  ::close(in_fd);
+
+  const timespec times[2] = {info.st_atim, info.st_mtim};
+  ok = ok && ::futimens(out_fd, times) == 0;
+  ok = ::close(out_fd) == 0 && ok;
+  if (!ok || ::rename(partial.c_str(), target.c_str()) != 0) {
+    ::unlink(partial.c_str());
+    return false;
+  }
+  ::unlink(source.c_str());
+  return true;
+}
+
+/**
+ * @brief Rotated segment found next to the active file
+ */
+struct LogSegment {
+  std::string stamp;  ///< Sorts chronologically
+  std::string path;
+  std::filesystem::file_time_type modified;
+  bool compressed;
+};
+
+}  // namespace
+
+RotatingFileLogOutput::RotatingFileLogOutput(FileLogOptions options)
+    : m_options(std::move(options)) {
+  m_buffer.reserve(m_options.buffer_size_bytes + 4096);
+}
+
+RotatingFileLogOutput::~RotatingFileLogOutput() {
+  CloseActiveFile();
+  if (m_compressor.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(m_work_mutex);
+      m_stop.store(true, std::memory_order_relaxed);
+    }
+    m_work_cv.notify_all();
+    m_compressor.join();
+  }
+}
+
+std::error_code RotatingFileLogOutput::Open() {
+  if (m_options.path.empty() || m_options.max_size_bytes == 0) {
+    return make_error_code(LogError::InvalidOptions);
+  }
+#ifndef COMM_LOG_HAVE_ZSTD
+  if (m_options.compression == LogCompression::Zstd) {
+    LOG(WARNING) << "Built without libzstd, compressing log files with gzip";
+    m_options.compression = LogCompression::Gzip;
+  }
+#endif
+
+  const std::filesystem::path directory =
+      std::filesystem::path(m_options.path).parent_path();
+  std::error_code ec;
+  if (!directory.empty()) {
+    std::filesystem::create_directories(directory, ec);
+    if (ec) {
+      return ec;
+    }
+  }
+  if (!OpenActiveFile()) {
+    return {errno, std::generic_category()};
+  }
+  ScheduleRotation(RealtimeNowUs());
+
+  try {
+    // Opened before Terminate::Start(): keep its signals off this thread
+    const TerminationSignalBlock block;
+    m_compressor = std::thread(&RotatingFileLogOutput::CompressorLoop, this);
+  } catch (const std::exception&) {
+    CloseActiveFile();
+    return make_error_code(LogError::ThreadCreationFailed);
+  }
+  RequestScan();
+  return {};
+}
+
+void RotatingFileLogOutput::Write(std::span<const LogRecord> records) {
+  if (m_fd < 0) {
+    return;
+  }
+  char prefix[256];
+  for (const LogRecord& record : records) {
+    const std::size_t prefix_len =
+        FormatLogPrefix(record, prefix, sizeof(prefix));
+    const std::uint64_t line_len = prefix_len + record.message.size() + 1;
+    const std::uint64_t pending = m_file_size + m_buffer.size();
+
+    if (pending > 0 && (pending + line_len > m_options.max_size_bytes ||
+                        (m_next_rotation_us != 0 &&
+                         record.timestamp_us >= m_next_rotation_us))) {
+      Rotate();
+      if (m_fd < 0) {
+        return;
+      }
+    }
+    if (m_next_rotation_us != 0 && record.timestamp_us >= m_next_rotation_us) {
+      ScheduleRotation(record.timestamp_us);
+    }
+
+    m_buffer.append(prefix, prefix_len);
+    m_buffer.append(record.message);
+    m_buffer += '\n';
+    if (m_buffer.size() >= m_options.buffer_size_bytes) {
+      WriteBuffer();
+    }
+  }
+}
+
+void RotatingFileLogOutput::Flush() {
+  WriteBuffer();
+}
+
+void RotatingFileLogOutput::WaitForCompression() {
+  std::unique_lock<std::mutex> lock(m_work_mutex);
+  m_work_cv.wait(lock, [this] {
+    return (!m_scan_requested && !m_scanning) || !m_compressor.joinable();
+  });
+}
+
+bool RotatingFileLogOutput::OpenActiveFile() {
+  m_fd = ::open(m_options.path.c_str(),
+                O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (m_fd < 0) {
+    return false;
+  }
+  struct stat info {};
+  ::fstat(m_fd, &info);
+  m_file_size = static_cast<std::uint64_t>(info.st_size);
+  m_allocated = m_file_size;
+  return true;
+}
+
+void RotatingFileLogOutput::CloseActiveFile() {
+  if (m_fd < 0) {
+    return;
+  }
+  WriteBuffer();
+  // Release blocks preallocated past the end of the data
+  if (m_allocated > m_file_size) {
+    ::ftruncate(m_fd, static_cast<off_t>(m_file_size));
+  }
+  ::close(m_fd);
+  m_fd = -1;
+}
+
+void RotatingFileLogOutput::Rotate() {
+  CloseActiveFile();
+
+  const std::int64_t now_us = RealtimeNowUs();
+  const std::time_t seconds = static_cast<std::time_t>(now_us / 1000000);
+  std::tm utc{};
+  gmtime_r(&seconds, &utc);
+  char stamp[32];
+  const std::size_t len = std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &utc);
+  std::snprintf(stamp + len, sizeof(stamp) - len, ".%06d",
+                static_cast<int>(now_us % 1000000));
+
+  const std::string segment = m_options.path + '.' + stamp;
+  if (::rename(m_options.path.c_str(), segment.c_str()) != 0) {
+    // Keep appending to the same file rather than losing records
+    m_errors.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    ++m_rotations;
+    RequestScan();
+  }
+  if (!OpenActiveFile()) {
+    m_errors.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void RotatingFileLogOutput::WriteBuffer() {
+  if (m_buffer.empty() || m_fd < 0) {
+    return;
+  }
+  const std::uint64_t end = m_file_size + m_buffer.size();
+  if (m_preallocate && end > m_allocated) {
+    const std::uint64_t target =
+        std::min(std::max(end, m_allocated + kPreallocateChunk),
+                 std::max(end, m_options.max_size_bytes));
+    if (::fallocate(m_fd, FALLOC_FL_KEEP_SIZE, static_cast<off_t>(m_allocated),
+                    static_cast<off_t>(target - m_allocated)) == 0) {
+      m_allocated = target;
+    } else if (errno == EOPNOTSUPP || errno == ENOSYS) {
+      m_preallocate = false;
+    }
+  }
+
+  if (WriteAll(m_fd, m_buffer.data(), m_buffer.size())) {
+    m_file_size = end;
+  } else {
+    m_errors.fetch_add(1, std::memory_order_relaxed);
+    struct stat info {};
+    if (::fstat(m_fd, &info) == 0) {
+      m_file_size = static_cast<std::uint64_t>(info.st_size);
+    }
+  }
+  m_buffer.clear();
+}
+
+void RotatingFileLogOutput::ScheduleRotation(std::int64_t now_us) {
+  const std::int64_t interval_us =
+      static_cast<std::int64_t>(m_options.rotate_interval.count()) * 1000000;
+  m_next_rotation_us =
+      interval_us > 0 ? (now_us / interval_us + 1) * interval_us : 0;
+}
+
+void RotatingFileLogOutput::RequestScan() {
+  {
+    std::lock_guard<std::mutex> lock(m_work_mutex);
+    m_scan_requested = true;
+  }
+  m_work_cv.notify_all();
+}
+
+void RotatingFileLogOutput::CompressorLoop() {
+  pthread_setname_np(pthread_self(), "comm_log_zip");
+  // Only use otherwise idle CPU; fall back to the lowest nice value
+  sched_param param{};
+  if (pthread_setschedparam(pthread_self(), SCHED_IDLE, &param) != 0) {
+    ::setpriority(PRIO_PROCESS, static_cast<id_t>(::gettid()), 19);
+  }
+
+  std::unique_lock<std::mutex> lock(m_work_mutex);
+  while (true) {
+    m_work_cv.wait(lock, [this] {
+      return m_scan_requested || m_stop.load(std::memory_order_relaxed);
+    });
+    if (m_stop.load(std::memory_order_relaxed)) {
+      break;
+    }
+    m_scan_requested = false;
+    m_scanning = true;
+    lock.unlock();
+    ProcessSegments();
+    lock.lock();
+    m_scanning = false;
+    m_work_cv.notify_all();
+  }
+  m_scanning = false;
+  m_work_cv.notify_all();
+}
+
+void RotatingFileLogOutput::ProcessSegments() {
+  namespace fs = std::filesystem;
+  const fs::path active(m_options.path);
+  const std::string prefix = active.filename().string() + '.';
+  fs::path directory = active.parent_path();
+  if (directory.empty()) {
+    directory = ".";
+  }
+
+  auto list_segments = [&]() {
+    std::vector<LogSegment> segments;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(directory, ec)) {
+      const std::string name = entry.path().filename().string();
+      if (name.size() < prefix.size() + kSegmentStampLength ||
+          name.compare(0, prefix.size(), prefix) != 0 ||
+          !std::isdigit(static_cast<unsigned char>(name[prefix.size()]))) {
+        continue;
+      }
+      const std::string rest = name.substr(prefix.size() + kSegmentStampLength);
+      if (rest.size() > 5 && rest.compare(rest.size() - 5, 5, ".part") == 0) {
+        // Left by an interrupted compression
+        fs::remove(entry.path(), ec);
+        continue;
+      }
+      segments.push_back({name.substr(prefix.size(), kSegmentStampLength),
+                          entry.path().string(), entry.last_write_time(ec),
+                          !rest.empty()});
+    }
+    std::sort(segments.begin(), segments.end(),
+              [](const LogSegment& a, const LogSegment& b) {
+                return a.stamp < b.stamp;
+              });
+    return segments;
+  };
+
+  std::vector<LogSegment> segments = list_segments();
+  if (m_options.compression != LogCompression::None) {
+    bool compressed_any = false;
+    for (const LogSegment& segment : segments) {
+      if (m_stop.load(std::memory_order_relaxed)) {
+        return;
+      }
+      if (segment.compressed) {
+        continue;
+      }
+      if (CompressSegment(segment.path, m_options.compression,
+                          m_options.compression_level, m_stop)) {
+        compressed_any = true;
+      } else if (!m_stop.load(std::memory_order_relaxed)) {
+        m_errors.fetch_add(1, std::memory_order_relaxed);
+        LOG(WARNING) << "Cannot compress log segment " << segment.path;
+      }
+    }
+    if (compressed_any) {
+      segments = list_segments();
+    }
+  }
+
+  // Retention: newest max_files segments, none older than max_age
+  std::error_code ec;
+  std::size_t excess = 0;
+  if (m_options.max_files > 0 && segments.size() > m_options.max_files) {
+    excess = segments.size() - m_options.max_files;
+  }
+  const auto oldest_kept =
+      fs::file_time_type::clock::now() - m_options.max_age;
+  for (std::size_t i = 0; i < segments.size(); ++i) {
+    if (i < excess ||
+        (m_options.max_age.count() > 0 && segments[i].modified < oldest_kept)) {
+      fs::remove(segments[i].path, ec);
+    }
+  }
+}
+
+}  // namespace comm
@@ -0,0 +1,174 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_log_format.cpp
+ * @brief Text rendering shared by the writer thread and the binlog decoder
+ * @note Kept free of glog so the offline decoder does not link it
+ */
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#include "comm_binlog_file.h"
+#include "comm_log.h"
+
+namespace comm {
+
+namespace {
+
+/// First letter of each glog severity name (INFO, WARNING, ERROR, FATAL)
+constexpr char kSeverityLetters[] = "IWEF";
+
+/**
+ * @brief Read a fixed-size value from the payload, advancing the cursor
+ */
+template <typename T>
+bool ReadPayload(const char*& cursor, const char* end, T& value) {
+  if (static_cast<std::size_t>(end - cursor) < sizeof(T)) {
+    return false;
+  }
+  std::memcpy(&value, cursor, sizeof(T));
+  cursor += sizeof(T);
+  return true;
+}
+
+template <typename T>
+void AppendNumber(std::string& out, T value) {
+  char text[32];
+  const auto result = std::to_chars(text, text + sizeof(text), value);
+  out.append(text, result.ptr);
+}
+
+/**
+ * @brief Append the text of one encoded argument
+ * @return False when the payload is too short for the argument
+ */
+bool AppendArgument(char tag, const char*& cursor, const char* end,
+                    std::string& out) {
+  switch (static_cast<BinlogTag>(tag)) {
+    case BinlogTag::Bool: {
+      char value = 0;
+      if (!ReadPayload(cursor, end, value)) {
+        return false;
+      }
+      out += value != 0 ? "true" : "false";
+      return true;
+    }
+    case BinlogTag::Int: {
+      std::int64_t value = 0;
+      if (!ReadPayload(cursor, end, value)) {
+        return false;
+      }
+      AppendNumber(out, value);
+      return true;
+    }
+    case BinlogTag::Uint: {
+      std::uint64_t value = 0;
+      if (!ReadPayload(cursor, end, value)) {
+        return false;
+      }
+      AppendNumber(out, value);
+      return true;
+    }
+    case BinlogTag::Double: {
+      double value = 0;
+      if (!ReadPayload(cursor, end, value)) {
+        return false;
+      }
+      AppendNumber(out, value);
+      return true;
+    }
+    case BinlogTag::String: {
+      std::uint32_t len = 0;
+      if (!ReadPayload(cursor, end, len) ||
+          static_cast<std::size_t>(end - cursor) < len) {
+        return false;
+      }
+      out.append(cursor, len);
+      cursor += len;
+      return true;
+    }
+    case BinlogTag::Pointer: {
+      std::uint64_t value = 0;
+      if (!ReadPayload(cursor, end, value)) {
+        return false;
+      }
+      char text[24];
+      const int len = std::snprintf(text, sizeof(text), "0x%llx",
+                                    static_cast<unsigned long long>(value));
+      out.append(text, static_cast<std::size_t>(std::max(len, 0)));
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+std::size_t FormatLogPrefix(const LogRecord& record, char* buffer,
+                            std::size_t size) {
+  // Writer-thread cache: localtime_r() only when the second changes
+  thread_local std::time_t cached_second = -1;
+  thread_local std::tm cached_tm{};
+
+  const std::time_t second =
+      static_cast<std::time_t>(record.timestamp_us / 1000000);
+  if (second != cached_second) {
+    localtime_r(&second, &cached_tm);
+    cached_second = second;
+  }
+  const char letter =
+      record.severity >= 0 && record.severity < 4
+          ? kSeverityLetters[record.severity]
+          : '?';
+  const int len = std::snprintf(
+      buffer, size, "%c%04d%02d%02d %02d:%02d:%02d.%06ld %5d %s:%d] ", letter,
+      cached_tm.tm_year + 1900, cached_tm.tm_mon + 1, cached_tm.tm_mday,
+      cached_tm.tm_hour, cached_tm.tm_min, cached_tm.tm_sec,
+      static_cast<long>(record.timestamp_us % 1000000),
+      static_cast<int>(record.thread_id), record.base_filename, record.line);
+  if (len < 0) {
+    return 0;
+  }
+  return std::min(static_cast<std::size_t>(len), size - 1);
+}
+
+void RenderBinlogMessage(std::string_view format, std::string_view arg_types,
+                         std::string_view payload, std::string& out) {
+  const char* cursor = payload.data();
+  const char* const end = payload.data() + payload.size();
+  std::size_t arg = 0;
+  bool valid = true;
+
+  for (std::size_t i = 0; i < format.size(); ++i) {
+    const char c = format[i];
+    const char next = i + 1 < format.size() ? format[i + 1] : '\0';
+    if ((c == '{' && next == '{') || (c == '}' && next == '}')) {
+      out += c;
+      ++i;
+    } else if (c == '{' && next == '}') {
+      if (valid && arg < arg_types.size() &&
+          AppendArgument(arg_types[arg], cursor, end, out)) {
+        ++arg;
+      } else {
+        // Truncated or mismatching record: keep the rest readable
+        valid = false;
+        out += "<?>";
+      }
+      ++i;
+    } else {
+      out += c;
+    }
+  }
+}
+
+const char* BinlogBaseName(const char* path) {
+  const char* slash = std::strrchr(path, '/');
+  return slash == nullptr ? path : slash + 1;
+}
+
+}  // namespace comm
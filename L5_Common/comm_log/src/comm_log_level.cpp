@@ -0,0 +1,174 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_log_level.cpp
+ * @brief Module registry behind MLOG()/MVLOG() and the writer-side filter
+ */
+
+#include "comm_log_level.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "comm_flat_map.h"
+#include "comm_log.h"
+#include "comm_symbol.h"
+
+namespace comm {
+
+namespace {
+
+/// Directories that hold sources of a module (the module is their parent)
+constexpr std::array<std::string_view, 6> kModuleSubdirs = {
+    "src", "interface", "unit_test", "integration_test", "tools", "benchmark"};
+
+/**
+ * @brief All modules seen so far and the configured levels
+ */
+class LogModuleRegistry {
+ public:
+  static LogModuleRegistry& Instance() {
+    static LogModuleRegistry instance;
+    return instance;
+  }
+
+  LogModule& ForFile(const char* file) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (auto it = m_by_file.find(file); it != m_by_file.end()) {
+      return *it->second;
+    }
+    LogModule& module = ForNameLocked(Symbol(LogModuleName(file)));
+    m_by_file.try_emplace(file, &module);
+    return module;
+  }
+
+  void Apply(const LogLevel& global,
+             const std::map<std::string, LogLevel>& modules) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_global = global;
+    m_overrides.clear();
+    for (const auto& [name, level] : modules) {
+      m_overrides.insert_or_assign(Symbol(name), level);
+    }
+    for (auto& [name, module] : m_by_name) {
+      module->SetLevel(LevelOfLocked(name));
+    }
+    // Overrides may be created before their module logs for the first time
+    for (const auto& [name, level] : m_overrides) {
+      ForNameLocked(name);
+    }
+    m_has_overrides.store(!modules.empty(), std::memory_order_release);
+  }
+
+  bool HasOverrides() const {
+    return m_has_overrides.load(std::memory_order_acquire);
+  }
+
+ private:
+  LogModuleRegistry() = default;
+
+  LogLevel LevelOfLocked(Symbol name) const {
+    const auto it = m_overrides.find(name);
+    return it != m_overrides.end() ? it->second : m_global;
+  }
+
+  LogModule& ForNameLocked(Symbol name) {
+    auto& module = m_by_name[name];
+    if (!module) {
+      module = std::make_unique<LogModule>(name);
+      module->SetLevel(LevelOfLocked(name));
+    }
+    return *module;
+  }
+
+  std::mutex m_mutex;
+  LogLevel m_global;
+  FlatMap<Symbol, LogLevel> m_overrides;
+  FlatMap<Symbol, std::unique_ptr<LogModule>> m_by_name;  // modules never move
+  FlatMap<const char*, LogModule*> m_by_file;
+  std::atomic<bool> m_has_overrides{false};
+};
+
+}  // namespace
+
+std::string LogModuleName(std::string_view file) {
+  // Walk the path from the end: ".../<module>/src/file.cpp" -> "<module>"
+  std::string_view rest = file;
+  const std::size_t slash = rest.rfind('/');
+  std::string_view stem =
+      slash == std::string_view::npos ? rest : rest.substr(slash + 1);
+  stem = stem.substr(0, stem.find('.'));
+  if (slash == std::string_view::npos) {
+    return std::string(stem);
+  }
+  rest = rest.substr(0, slash);
+
+  while (!rest.empty()) {
+    const std::size_t dir_slash = rest.rfind('/');
+    const std::string_view dir =
+        dir_slash == std::string_view::npos ? rest : rest.substr(dir_slash + 1);
+    if (dir_slash == std::string_view::npos) {
+      break;
+    }
+    const std::string_view parent_path = rest.substr(0, dir_slash);
+    if (std::find(kModuleSubdirs.begin(), kModuleSubdirs.end(), dir) !=
+        kModuleSubdirs.end()) {
+      const std::size_t parent_slash = parent_path.rfind('/');
+      const std::string_view parent =
+          parent_slash == std::string_view::npos
+              ? parent_path
+              : parent_path.substr(parent_slash + 1);
+      if (!parent.empty()) {
+        return std::string(parent);
+      }
+    }
+    rest = parent_path;
+  }
+  return std::string(stem);
+}
+
+LogModule& GetLogModule(const char* file) {
+  return LogModuleRegistry::Instance().ForFile(file);
+}
+
+void ApplyLogLevels(const LogLevel& global,
+                    const std::map<std::string, LogLevel>& modules) {
+  LogModuleRegistry::Instance().Apply(global, modules);
+
+  int min_severity = global.severity;
+  for (const auto& [name, level] : modules) {
+    min_severity = std::min(min_severity, level.severity);
+  }
+  FLAGS_minloglevel = min_severity;
+  FLAGS_v = global.verbosity;
+  // glog applies min_severity to every module: filter its records by module
+  AsyncLog::Instance().SetModuleFilter(!modules.empty());
+}
+
+bool IsLogRecordEnabled(const char* file, int severity) {
+  auto& registry = LogModuleRegistry::Instance();
+  if (!registry.HasOverrides()) {
+    // Every module runs at the global level, which glog already enforced
+    return true;
+  }
+
+  // Direct-mapped cache: glog passes the same __FILE__ pointer per site
+  struct CacheEntry {
+    const char* file{nullptr};
+    const LogModule* module{nullptr};
+  };
+  thread_local std::array<CacheEntry, 64> cache{};
+  const auto key = reinterpret_cast<std::uintptr_t>(file);
+  CacheEntry& entry = cache[(key >> 4) % cache.size()];
+  if (entry.file != file) {
+    entry.module = &registry.ForFile(file);
+    entry.file = file;
+  }
+  return entry.module->IsEnabled(severity);
+}
+
+}  // namespace comm
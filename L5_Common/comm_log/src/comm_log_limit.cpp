@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_log_limit.cpp
+ * @brief Per-site rate limiting, sampling and suppressed-count reporting
+ */
+
+#include "comm_log_limit.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "comm_clock.h"
+
+namespace comm {
+
+namespace {
+
+/// Sites that suppressed at least one record (push-only, sites are static)
+std::atomic<LogLimitSite*> g_suppressed_sites{nullptr};
+
+}  // namespace
+
+bool LogLimitSite::AllowRate(double per_second, std::uint32_t burst) {
+  if (!(per_second > 0)) {
+    Suppress();
+    return false;
+  }
+  const auto interval = static_cast<std::int64_t>(std::ceil(1e9 / per_second));
+  const std::int64_t tolerance = interval * std::max<std::uint32_t>(burst, 1);
+  const std::int64_t now = FastClock::NowNs();
+
+  std::int64_t tat = m_tat_ns.load(std::memory_order_relaxed);
+  while (true) {
+    const std::int64_t next = std::max(tat, now) + interval;
+    if (next - now > tolerance) {
+      Suppress();
+      return false;
+    }
+    if (m_tat_ns.compare_exchange_weak(tat, next, std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+}
+
+bool LogLimitSite::AllowSample(std::uint32_t n) {
+  const std::uint64_t count = m_count.fetch_add(1, std::memory_order_relaxed);
+  if (n <= 1 || count % n == 0) {
+    return true;
+  }
+  Suppress();
+  return false;
+}
+
+void LogLimitSite::Suppress() {
+  m_suppressed.fetch_add(1, std::memory_order_relaxed);
+  if (!m_listed.load(std::memory_order_relaxed) &&
+      !m_listed.exchange(true, std::memory_order_acq_rel)) {
+    LogLimitSite* head = g_suppressed_sites.load(std::memory_order_relaxed);
+    do {
+      m_next = head;
+    } while (!g_suppressed_sites.compare_exchange_weak(
+        head, this, std::memory_order_release, std::memory_order_relaxed));
+  }
+}
+
+void CollectSuppressedLogs(
+    const std::function<void(const LogLimitSite&, std::uint64_t)>& report) {
+  for (LogLimitSite* site = g_suppressed_sites.load(std::memory_order_acquire);
+       site != nullptr; site = site->m_next) {
+    if (const std::uint64_t count = site->TakeSuppressed(); count > 0) {
+      report(*site, count);
+    }
+  }
+}
+
+std::size_t FormatSuppressedNote(std::uint64_t count, char* buffer,
+                                 std::size_t size) {
+  // Digits with thousands separators, built from the right
+  char digits[32];
+  std::size_t pos = sizeof(digits);
+  int group = 0;
+  do {
+    if (group == 3) {
+      digits[--pos] = ',';
+      group = 0;
+    }
+    digits[--pos] = static_cast<char>('0' + count % 10);
+    count /= 10;
+    ++group;
+  } while (count > 0);
+
+  const int len = std::snprintf(
+      buffer, size, "suppressed %.*s similar message%s",
+      static_cast<int>(sizeof(digits) - pos), digits + pos,
+      (sizeof(digits) - pos == 1 && digits[pos] == '1') ? "" : "s");
+  if (len < 0 || size == 0) {
+    return 0;
+  }
+  return std::min(static_cast<std::size_t>(len), size - 1);
+}
+
+std::ostream& operator<<(std::ostream& stream, const LogSuppressedPrefix& note) {
+  if (note.count > 0) {
+    char text[64];
+    const std::size_t len = FormatSuppressedNote(note.count, text, sizeof(text));
+    stream << '[';
+    stream.write(text, static_cast<std::streamsize>(len));
+    stream << "] ";
+  }
+  return stream;
+}
+
+}  // namespace comm
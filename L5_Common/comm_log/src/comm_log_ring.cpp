@@ -0,0 +1,193 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_log_ring.cpp
+ * @brief Registry of per-thread log rings shared by all log producers
+ */
+
+#include "comm_log_ring.h"
+
+#include <unistd.h>
+
+#include <thread>
+
+namespace comm {
+
+namespace {
+
+/// Back-off used by the Block policy while waiting for ring space
+constexpr std::chrono::microseconds kBlockBackoff{50};
+
+/**
+ * @brief Thread-local handle; marks the ring orphaned on thread exit
+ */
+struct ThreadRingHandle {
+  std::shared_ptr<ThreadLogRing> ring;
+
+  ~ThreadRingHandle() { Abandon(); }
+
+  void Abandon() {
+    if (ring) {
+      ring->orphaned.store(true, std::memory_order_release);
+      ring.reset();
+      LogRingRegistry::Instance().NotifyRingAbandoned();
+    }
+  }
+};
+
+thread_local ThreadRingHandle t_ring_handle;
+
+/// Context captured into every frame by the producer
+thread_local std::uint64_t t_trace_id = 0;
+std::atomic<std::uint64_t> g_config_generation{0};
+
+}  // namespace
+
+void SetLogTraceId(std::uint64_t trace_id) {
+  t_trace_id = trace_id;
+}
+
+std::uint64_t GetLogTraceId() {
+  return t_trace_id;
+}
+
+void SetLogConfigGeneration(std::uint64_t generation) {
+  g_config_generation.store(generation, std::memory_order_relaxed);
+}
+
+std::uint64_t GetLogConfigGeneration() {
+  return g_config_generation.load(std::memory_order_relaxed);
+}
+
+ThreadLogRing::ThreadLogRing(std::size_t capacity,
+                             std::uint64_t generation_value)
+    : ring(capacity), tid(::gettid()), generation(generation_value) {}
+
+LogRingRegistry& LogRingRegistry::Instance() {
+  static LogRingRegistry instance;
+  return instance;
+}
+
+void LogRingRegistry::Activate(const AsyncLogOptions& options) {
+  m_ring_size.store(LogRing(options.ring_size_bytes).Capacity(),
+                    std::memory_order_relaxed);
+  m_policy.store(options.overflow_policy, std::memory_order_relaxed);
+  m_sample_rate.store(options.sample_rate, std::memory_order_relaxed);
+  m_generation.store(++m_last_generation, std::memory_order_release);
+}
+
+void LogRingRegistry::Deactivate() {
+  m_generation.store(0, std::memory_order_release);
+}
+
+ThreadLogRing* LogRingRegistry::CurrentRing(std::uint64_t generation) {
+  auto& handle = t_ring_handle;
+  if (handle.ring && handle.ring->generation == generation) {
+    return handle.ring.get();
+  }
+  // First frame of this thread in this generation
+  handle.Abandon();
+  handle.ring = std::make_shared<ThreadLogRing>(
+      m_ring_size.load(std::memory_order_relaxed), generation);
+  {
+    std::lock_guard<std::mutex> lock(m_rings_mutex);
+    m_rings.push_back(handle.ring);
+  }
+  m_version.fetch_add(1, std::memory_order_release);
+  return handle.ring.get();
+}
+
+char* LogRingRegistry::Reserve(std::uint32_t size, ThreadLogRing*& ring) {
+  const std::uint64_t generation = m_generation.load(std::memory_order_acquire);
+  if (generation == 0) {
+    return nullptr;
+  }
+  ring = CurrentRing(generation);
+
+  const LogOverflowPolicy policy = m_policy.load(std::memory_order_relaxed);
+  if (policy == LogOverflowPolicy::Sample &&
+      ring->ring.Used() > ring->ring.Capacity() / 2 &&
+      (++ring->sample_counter %
+       m_sample_rate.load(std::memory_order_relaxed)) != 0) {
+    ring->sampled_out.fetch_add(1, std::memory_order_relaxed);
+    WakeWriter();
+    return nullptr;
+  }
+
+  char* slot = ring->ring.TryReserve(size);
+  while (slot == nullptr) {
+    WakeWriter();
+    if (policy != LogOverflowPolicy::Block || !IsActive()) {
+      ring->dropped.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    std::this_thread::sleep_for(kBlockBackoff);
+    slot = ring->ring.TryReserve(size);
+  }
+  return slot;
+}
+
+void LogRingRegistry::Commit(ThreadLogRing* ring) {
+  ring->ring.Commit();
+  if (ring->ring.Used() > ring->ring.Capacity() / 2) {
+    WakeWriter();
+  }
+}
+
+void LogRingRegistry::Snapshot(
+    std::vector<std::shared_ptr<ThreadLogRing>>& rings) {
+  std::lock_guard<std::mutex> lock(m_rings_mutex);
+  std::erase_if(m_rings, [this](const std::shared_ptr<ThreadLogRing>& ring) {
+    if (!ring->orphaned.load(std::memory_order_acquire) ||
+        !ring->ring.Empty()) {
+      return false;
+    }
+    m_retired_dropped += ring->dropped.load(std::memory_order_relaxed);
+    m_retired_sampled_out += ring->sampled_out.load(std::memory_order_relaxed);
+    return true;
+  });
+  rings = m_rings;
+}
+
+void LogRingRegistry::AddLossStats(AsyncLogStats& stats) {
+  std::lock_guard<std::mutex> lock(m_rings_mutex);
+  stats.dropped += m_retired_dropped;
+  stats.sampled_out += m_retired_sampled_out;
+  for (const auto& ring : m_rings) {
+    stats.dropped += ring->dropped.load(std::memory_order_relaxed);
+    stats.sampled_out += ring->sampled_out.load(std::memory_order_relaxed);
+  }
+}
+
+void LogRingRegistry::WakeWriter() {
+  if (m_writer_idle.load(std::memory_order_relaxed)) {
+    {
+      std::lock_guard<std::mutex> lock(m_wake_mutex);
+      m_wake = true;
+      m_writer_idle.store(false, std::memory_order_relaxed);
+    }
+    m_wake_cv.notify_one();
+  }
+}
+
+void LogRingRegistry::RequestWake() {
+  {
+    std::lock_guard<std::mutex> lock(m_wake_mutex);
+    m_wake = true;
+    m_writer_idle.store(false, std::memory_order_relaxed);
+  }
+  m_wake_cv.notify_one();
+}
+
+void LogRingRegistry::WaitForWork(std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(m_wake_mutex);
+  if (!m_wake) {
+    m_writer_idle.store(true, std::memory_order_relaxed);
+    m_wake_cv.wait_for(lock, timeout, [this] { return m_wake; });
+  }
+  m_wake = false;
+  m_writer_idle.store(false, std::memory_order_relaxed);
+}
+
+}  // namespace comm
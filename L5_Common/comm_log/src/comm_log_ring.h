@@ -0,0 +1,352 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_log_ring.h
+ * @brief Single-producer/single-consumer byte ring for variable-size records
+ * @details The producer is the thread that owns the ring (the logging thread),
+ *          the consumer is the background writer. Records never straddle the
+ *          end of the buffer: when a record does not fit contiguously the
+ *          producer writes a padding frame and continues at offset zero, so
+ *          the consumer can hand out views straight into ring memory.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "comm_log.h"
+
+namespace comm {
+
+/// Cache line size used to keep producer and consumer indices apart
+inline constexpr std::size_t kLogCacheLine = 64;
+
+/// Every frame starts at an 8-byte aligned offset
+inline constexpr std::uint32_t kLogFrameAlign = 8;
+
+/**
+ * @brief Frame kinds stored in a LogRing
+ */
+enum class LogFrameKind : std::uint32_t {
+  Padding = 0,  ///< Filler up to the end of the buffer, skipped by consumer
+  Text = 1,     ///< LogRecordHeader followed by message bytes
+  Binary = 2,   ///< LogBinaryHeader followed by encoded BLOG() arguments
+};
+
+/**
+ * @brief Common header of every frame (8 bytes, always fits at buffer end)
+ */
+struct LogFrame {
+  std::uint32_t size;   ///< Total frame size in bytes, multiple of 8
+  LogFrameKind kind;
+};
+
+/**
+ * @brief Text record header, followed by message_len bytes of message
+ */
+struct LogRecordHeader {
+  LogFrame frame;
+  std::int64_t timestamp_us;
+  const char* full_filename;
+  const char* base_filename;
+  std::int32_t line;
+  std::int32_t severity;
+  std::uint32_t message_len;
+  std::uint32_t reserved;
+  std::uint64_t trace_id;
+  std::uint64_t config_generation;
+};
+
+/**
+ * @brief Binary record header, followed by payload_len bytes of arguments
+ */
+struct LogBinaryHeader {
+  LogFrame frame;
+  std::int64_t timestamp_us;
+  std::uint32_t site_id;
+  std::uint32_t payload_len;
+  std::uint64_t trace_id;
+  std::uint64_t config_generation;
+};
+
+/**
+ * @brief Round a byte count up to the frame alignment
+ */
+constexpr std::uint32_t AlignLogFrame(std::size_t size) {
+  return static_cast<std::uint32_t>((size + kLogFrameAlign - 1) &
+                                    ~std::size_t{kLogFrameAlign - 1});
+}
+
+/**
+ * @class LogRing
+ * @brief Lock-free SPSC ring of variable-size frames
+ */
+class LogRing {
+ public:
+  /**
+   * @param capacity Requested size in bytes, rounded up to a power of two
+   */
+  explicit LogRing(std::size_t capacity)
+      : m_capacity(std::bit_ceil(capacity < 1024 ? std::size_t{1024} : capacity)),
+        m_mask(m_capacity - 1),
+        m_buffer(new (std::align_val_t{kLogCacheLine}) char[m_capacity]) {}
+
+  LogRing(const LogRing&) = delete;
+  LogRing& operator=(const LogRing&) = delete;
+
+  std::size_t Capacity() const { return m_capacity; }
+
+  /**
+   * @brief Largest frame the ring accepts (a quarter of its capacity)
+   */
+  std::size_t MaxFrameSize() const { return m_capacity / 4; }
+
+  /**
+   * @brief Bytes currently occupied (approximate from either side)
+   */
+  std::size_t Used() const {
+    return static_cast<std::size_t>(m_head.load(std::memory_order_acquire) -
+                                    m_tail.load(std::memory_order_acquire));
+  }
+
+  /**
+   * @brief Producer: reserve a contiguous frame of size bytes
+   * @param size Frame size, multiple of kLogFrameAlign, <= MaxFrameSize()
+   * @return Pointer to frame memory, or nullptr when the ring is full
+   * @note Must be followed by Commit() before the next TryReserve()
+   */
+  char* TryReserve(std::uint32_t size) {
+    std::uint64_t head = m_head.load(std::memory_order_relaxed);
+    const std::uint64_t offset = head & m_mask;
+    const std::uint64_t contiguous = m_capacity - offset;
+    const std::uint64_t needed = size <= contiguous ? size : contiguous + size;
+
+    if (needed > m_capacity - (head - m_cached_tail)) {
+      m_cached_tail = m_tail.load(std::memory_order_acquire);
+      if (needed > m_capacity - (head - m_cached_tail)) {
+        return nullptr;
+      }
+    }
+
+    if (size > contiguous) {
+      // Fill the tail of the buffer so the record starts at offset zero
+      auto* padding = reinterpret_cast<LogFrame*>(m_buffer.get() + offset);
+      padding->size = static_cast<std::uint32_t>(contiguous);
+      padding->kind = LogFrameKind::Padding;
+      head += contiguous;
+    }
+
+    m_reserved_head = head + size;
+    return m_buffer.get() + (head & m_mask);
+  }
+
+  /**
+   * @brief Producer: publish the frame returned by the last TryReserve()
+   */
+  void Commit() { m_head.store(m_reserved_head, std::memory_order_release); }
+
+  /**
+   * @brief Consumer: next published frame at cursor, skipping padding
+   * @param cursor Consumer position, advanced past padding frames
+   * @return Frame pointer or nullptr when nothing is published
+   * @note Caller advances cursor by frame->size after using the frame
+   */
+  const LogFrame* Peek(std::uint64_t& cursor) const {
+    const std::uint64_t head = m_head.load(std::memory_order_acquire);
+    while (cursor != head) {
+      const auto* frame =
+          reinterpret_cast<const LogFrame*>(m_buffer.get() + (cursor & m_mask));
+      if (frame->kind != LogFrameKind::Padding) {
+        return frame;
+      }
+      cursor += frame->size;
+    }
+    return nullptr;
+  }
+
+  /**
+   * @brief Consumer: position of the oldest unreleased byte
+   */
+  std::uint64_t Tail() const { return m_tail.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Consumer: hand bytes up to cursor back to the producer
+   */
+  void Release(std::uint64_t cursor) {
+    m_tail.store(cursor, std::memory_order_release);
+  }
+
+  /**
+   * @brief True when every published frame has been released
+   */
+  bool Empty() const {
+    return m_head.load(std::memory_order_acquire) ==
+           m_tail.load(std::memory_order_acquire);
+  }
+
+ private:
+  struct AlignedDelete {
+    void operator()(char* buffer) const {
+      ::operator delete[](buffer, std::align_val_t{kLogCacheLine});
+    }
+  };
+
+  const std::size_t m_capacity;
+  const std::size_t m_mask;
+  std::unique_ptr<char[], AlignedDelete> m_buffer;
+
+  /// Producer side: published position and producer-private state
+  alignas(kLogCacheLine) std::atomic<std::uint64_t> m_head{0};
+  std::uint64_t m_cached_tail{0};
+  std::uint64_t m_reserved_head{0};
+
+  /// Consumer side: released position
+  alignas(kLogCacheLine) std::atomic<std::uint64_t> m_tail{0};
+};
+
+/**
+ * @brief Ring owned by one logging thread
+ */
+struct ThreadLogRing {
+  ThreadLogRing(std::size_t capacity, std::uint64_t generation_value);
+
+  LogRing ring;
+  const pid_t tid;
+  const std::uint64_t generation;
+
+  /// Set when the owning thread exits; writer frees the ring once drained
+  std::atomic<bool> orphaned{false};
+
+  /// Producer-side counters, read by the writer
+  std::atomic<std::uint64_t> dropped{0};
+  std::atomic<std::uint64_t> sampled_out{0};
+
+  /// Producer-private Sample policy counter
+  std::uint64_t sample_counter{0};
+};
+
+/**
+ * @class LogRingRegistry
+ * @brief Process-lifetime owner of all thread rings and the writer wake-up
+ * @details Producers (glog sink, BLOG()) reserve frames here; the writer
+ *          thread of the active AsyncLogSink drains the registered rings.
+ *          Outliving any sink keeps producers safe across Start()/Stop().
+ */
+class LogRingRegistry {
+ public:
+  static LogRingRegistry& Instance();
+
+  LogRingRegistry(const LogRingRegistry&) = delete;
+  LogRingRegistry& operator=(const LogRingRegistry&) = delete;
+
+  /**
+   * @brief Accept frames with the given options (new ring generation)
+   */
+  void Activate(const AsyncLogOptions& options);
+
+  /**
+   * @brief Stop accepting frames; Reserve() returns nullptr afterwards
+   */
+  void Deactivate();
+
+  bool IsActive() const {
+    return m_generation.load(std::memory_order_acquire) != 0;
+  }
+
+  /**
+   * @brief Largest frame a producer may reserve
+   */
+  std::size_t MaxFrameSize() const {
+    return m_ring_size.load(std::memory_order_relaxed) / 4;
+  }
+
+  /**
+   * @brief Reserve a frame in the calling thread's ring, applying the policy
+   * @param size Frame size, aligned with AlignLogFrame(), <= MaxFrameSize()
+   * @param ring Receives the ring to pass to Commit()
+   * @return Frame memory, or nullptr when inactive or discarded by policy
+   */
+  char* Reserve(std::uint32_t size, ThreadLogRing*& ring);
+
+  /**
+   * @brief Publish the frame returned by Reserve()
+   */
+  void Commit(ThreadLogRing* ring);
+
+  /// Writer side ------------------------------------------------------------
+
+  /**
+   * @brief Changes whenever rings are registered or abandoned
+   */
+  std::uint64_t Version() const {
+    return m_version.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Copy the live rings, retiring orphaned rings that are drained
+   */
+  void Snapshot(std::vector<std::shared_ptr<ThreadLogRing>>& rings);
+
+  /**
+   * @brief Add producer-side loss counters of all rings to stats
+   */
+  void AddLossStats(AsyncLogStats& stats);
+
+  /**
+   * @brief Wake the writer if it is idle
+   */
+  void WakeWriter();
+
+  /**
+   * @brief Wake the writer, or make its next WaitForWork() return at once
+   */
+  void RequestWake();
+
+  /**
+   * @brief Writer: sleep until woken or timeout elapses
+   */
+  void WaitForWork(std::chrono::milliseconds timeout);
+
+  /**
+   * @brief Bump the ring version (thread exit abandoned a ring)
+   */
+  void NotifyRingAbandoned() {
+    m_version.fetch_add(1, std::memory_order_release);
+  }
+
+ private:
+  LogRingRegistry() = default;
+  ~LogRingRegistry() = default;
+
+  ThreadLogRing* CurrentRing(std::uint64_t generation);
+
+  std::atomic<std::uint64_t> m_generation{0};
+  std::uint64_t m_last_generation{0};
+  std::atomic<std::size_t> m_ring_size{0};
+  std::atomic<LogOverflowPolicy> m_policy{LogOverflowPolicy::Drop};
+  std::atomic<std::uint32_t> m_sample_rate{1};
+  std::atomic<std::uint64_t> m_version{0};
+
+  std::vector<std::shared_ptr<ThreadLogRing>> m_rings;
+  std::mutex m_rings_mutex;
+  std::uint64_t m_retired_dropped{0};
+  std::uint64_t m_retired_sampled_out{0};
+
+  std::mutex m_wake_mutex;
+  std::condition_variable m_wake_cv;
+  std::atomic<bool> m_writer_idle{false};
+  bool m_wake{false};
+};
+
+}  // namespace comm
@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_binlog_decode.cpp
+ * @brief Offline decoder printing binary log files as glog-formatted text
+ *
+ * Usage: modu-core-binlog-decode FILE... (use "-" for stdin)
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "comm_binlog_file.h"
+#include "comm_log.h"
+
+namespace {
+
+/**
+ * @brief Print every event of one input
+ * @return True when the input was read to its end without errors
+ */
+bool DecodeStream(std::istream& input, const char* name) {
+  comm::BinlogFileReader reader(input);
+  comm::BinlogEvent event;
+  std::string line;
+  char prefix[256];
+
+  while (reader.Next(event)) {
+    const comm::LogRecord record{event.site->severity,
+                                 event.tid,
+                                 event.timestamp_us,
+                                 event.site->file.c_str(),
+                                 comm::BinlogBaseName(event.site->file.c_str()),
+                                 event.site->line,
+                                 {}};
+    line.assign(prefix, comm::FormatLogPrefix(record, prefix, sizeof(prefix)));
+    comm::RenderBinlogMessage(event.site->format, event.site->arg_types,
+                              event.payload, line);
+    line += '\n';
+    std::fwrite(line.data(), 1, line.size(), stdout);
+  }
+
+  if (reader.IsCorrupt()) {
+    std::fprintf(stderr, "%s: malformed or truncated binary log\n", name);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::fprintf(stderr, "Usage: %s FILE... (\"-\" reads stdin)\n", argv[0]);
+    return 2;
+  }
+
+  bool ok = true;
+  for (int i = 1; i < argc; ++i) {
+    const std::string path = argv[i];
+    if (path == "-") {
+      ok = DecodeStream(std::cin, "<stdin>") && ok;
+      continue;
+    }
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+      std::fprintf(stderr, "%s: cannot open\n", path.c_str());
+      ok = false;
+      continue;
+    }
+    ok = DecodeStream(input, path.c_str()) && ok;
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,858 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_log_test.cpp
+ * @brief Unit tests for the asynchronous logging backend
+ */
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "comm_binlog.h"
+#include "comm_binlog_file.h"
+#include "comm_log.h"
+#include "comm_log_config.h"
+#include "comm_log_file.h"
+#include "comm_log_level.h"
+#include "comm_log_limit.h"
+#include "comm_log_ring.h"
+
+namespace comm {
+namespace {
+
+/**
+ * @brief Output collecting message texts, optionally stalled by the test
+ */
+class CaptureOutput : public LogOutput {
+ public:
+  struct State {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<std::string> messages;
+    bool stalled{false};
+  };
+
+  explicit CaptureOutput(std::shared_ptr<State> state)
+      : m_state(std::move(state)) {}
+
+  void Write(std::span<const LogRecord> records) override {
+    std::unique_lock<std::mutex> lock(m_state->mutex);
+    m_state->cv.wait(lock, [this] { return !m_state->stalled; });
+    for (const auto& record : records) {
+      m_state->messages.emplace_back(record.message);
+    }
+  }
+
+ private:
+  std::shared_ptr<State> m_state;
+};
+
+std::vector<std::unique_ptr<LogOutput>> MakeOutputs(
+    const std::shared_ptr<CaptureOutput::State>& state) {
+  std::vector<std::unique_ptr<LogOutput>> outputs;
+  outputs.push_back(std::make_unique<CaptureOutput>(state));
+  return outputs;
+}
+
+std::size_t CountMatching(const std::shared_ptr<CaptureOutput::State>& state,
+                          const std::string& needle) {
+  std::lock_guard<std::mutex> lock(state->mutex);
+  std::size_t count = 0;
+  for (const auto& message : state->messages) {
+    if (message.find(needle) != std::string::npos) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+/**
+ * @brief Journal output recording the fields of every entry instead of sending
+ */
+class CaptureJournal : public JournaldLogOutput {
+ public:
+  using Entries = std::vector<std::vector<std::string>>;
+
+  CaptureJournal(std::shared_ptr<Entries> entries, int result)
+      : JournaldLogOutput("comm_log_test"),
+        m_entries(std::move(entries)),
+        m_result(result) {}
+
+ protected:
+  int Send(const iovec* fields, int count) override {
+    auto& entry = m_entries->emplace_back();
+    for (int i = 0; i < count; ++i) {
+      entry.emplace_back(static_cast<const char*>(fields[i].iov_base),
+                         fields[i].iov_len);
+    }
+    return m_result;
+  }
+
+ private:
+  std::shared_ptr<Entries> m_entries;
+  int m_result;
+};
+
+bool HasField(const std::vector<std::string>& entry, const std::string& field) {
+  return std::find(entry.begin(), entry.end(), field) != entry.end();
+}
+
+std::size_t CountMatching(const std::string& text, const std::string& needle) {
+  std::size_t count = 0;
+  for (auto pos = text.find(needle); pos != std::string::npos;
+       pos = text.find(needle, pos + needle.size())) {
+    ++count;
+  }
+  return count;
+}
+
+/// Termination signals blocked by the thread named name, waiting up to 5 s
+/// for it to appear in /proc/self/task
+std::vector<int> BlockedTerminationSignals(const std::string& name) {
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  do {
+    for (const auto& task : std::filesystem::directory_iterator("/proc/self/task")) {
+      std::ifstream comm(task.path() / "comm");
+      std::string task_name;
+      if (!std::getline(comm, task_name) || task_name != name) {
+        continue;
+      }
+      std::ifstream status(task.path() / "status");
+      for (std::string line; std::getline(status, line);) {
+        if (line.rfind("SigBlk:", 0) != 0) {
+          continue;
+        }
+        const std::uint64_t mask = std::stoull(line.substr(7), nullptr, 16);
+        std::vector<int> blocked;
+        for (const int signal : {SIGINT, SIGTERM, SIGQUIT, SIGHUP}) {
+          if ((mask >> (signal - 1)) & 1) {
+            blocked.push_back(signal);
+          }
+        }
+        return blocked;
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  } while (std::chrono::steady_clock::now() < deadline);
+  ADD_FAILURE() << "No thread named " << name;
+  return {};
+}
+
+}  // namespace
+
+class LogRingTest : public ::testing::Test {};
+
+TEST_F(LogRingTest, FramesRoundTripInOrder) {
+  LogRing ring(1024);
+  for (std::uint32_t i = 0; i < 4; ++i) {
+    char* slot = ring.TryReserve(32);
+    ASSERT_NE(slot, nullptr);
+    auto* frame = reinterpret_cast<LogFrame*>(slot);
+    frame->size = 32;
+    frame->kind = LogFrameKind::Text;
+    std::memcpy(slot + sizeof(LogFrame), &i, sizeof(i));
+    ring.Commit();
+  }
+
+  std::uint64_t cursor = ring.Tail();
+  for (std::uint32_t i = 0; i < 4; ++i) {
+    const LogFrame* frame = ring.Peek(cursor);
+    ASSERT_NE(frame, nullptr);
+    std::uint32_t value = 0;
+    std::memcpy(&value, reinterpret_cast<const char*>(frame) + sizeof(LogFrame),
+                sizeof(value));
+    EXPECT_EQ(value, i);
+    cursor += frame->size;
+  }
+  EXPECT_EQ(ring.Peek(cursor), nullptr);
+  ring.Release(cursor);
+  EXPECT_TRUE(ring.Empty());
+}
+
+TEST_F(LogRingTest, ReserveFailsWhenFullAndRecoversAfterRelease) {
+  LogRing ring(1024);
+  std::size_t frames = 0;
+  while (char* slot = ring.TryReserve(256)) {
+    reinterpret_cast<LogFrame*>(slot)->size = 256;
+    reinterpret_cast<LogFrame*>(slot)->kind = LogFrameKind::Text;
+    ring.Commit();
+    ++frames;
+  }
+  EXPECT_EQ(frames, 4U);
+
+  std::uint64_t cursor = ring.Tail();
+  const LogFrame* frame = ring.Peek(cursor);
+  ASSERT_NE(frame, nullptr);
+  ring.Release(cursor + frame->size);
+  EXPECT_NE(ring.TryReserve(256), nullptr);
+}
+
+TEST_F(LogRingTest, WrapAroundInsertsPaddingFrame) {
+  LogRing ring(1024);
+  // Leave 200 bytes at the end of the buffer, then release everything
+  for (std::uint32_t size : {256U, 256U, 312U}) {
+    char* slot = ring.TryReserve(size);
+    ASSERT_NE(slot, nullptr);
+    reinterpret_cast<LogFrame*>(slot)->size = size;
+    reinterpret_cast<LogFrame*>(slot)->kind = LogFrameKind::Text;
+    ring.Commit();
+  }
+  std::uint64_t cursor = ring.Tail();
+  while (const LogFrame* frame = ring.Peek(cursor)) {
+    cursor += frame->size;
+  }
+  ring.Release(cursor);
+
+  char* slot = ring.TryReserve(256);
+  ASSERT_NE(slot, nullptr);
+  reinterpret_cast<LogFrame*>(slot)->size = 256;
+  reinterpret_cast<LogFrame*>(slot)->kind = LogFrameKind::Text;
+  ring.Commit();
+
+  const LogFrame* frame = ring.Peek(cursor);
+  ASSERT_NE(frame, nullptr);
+  EXPECT_EQ(frame->kind, LogFrameKind::Text);
+  EXPECT_EQ(reinterpret_cast<const char*>(frame), slot);
+}
+
+class AsyncLogTest : public ::testing::Test {
+ protected:
+  void TearDown() override { AsyncLog::Instance().Stop(); }
+};
+
+TEST_F(AsyncLogTest, RecordsReachOutputAfterFlush) {
+  auto state = std::make_shared<CaptureOutput::State>();
+  ASSERT_FALSE(AsyncLog::Instance().Start(AsyncLogOptions{}, MakeOutputs(state)));
+  EXPECT_TRUE(AsyncLog::Instance().IsRunning());
+
+  for (int i = 0; i < 100; ++i) {
+    LOG(WARNING) << "async-record " << i;
+  }
+  AsyncLog::Instance().Flush();
+
+  EXPECT_EQ(CountMatching(state, "async-record "), 100U);
+}
+
+TEST_F(AsyncLogTest, StartTwiceReturnsAlreadyRunning) {
+  auto state = std::make_shared<CaptureOutput::State>();
+  ASSERT_FALSE(AsyncLog::Instance().Start(AsyncLogOptions{}, MakeOutputs(state)));
+
+  auto ec = AsyncLog::Instance().Start(AsyncLogOptions{}, MakeOutputs(state));
+  EXPECT_EQ(ec, make_error_code(LogError::AlreadyRunning));
+}
+
+TEST_F(AsyncLogTest, WriterThreadBlocksTerminationSignals) {
+  auto state = std::make_shared<CaptureOutput::State>();
+  ASSERT_FALSE(AsyncLog::Instance().Start(AsyncLogOptions{}, MakeOutputs(state)));
+
+  // Terminate's sigwait() thread must get them, not the writer
+  EXPECT_EQ(BlockedTerminationSignals("comm_log"),
+            (std::vector<int>{SIGINT, SIGTERM, SIGQUIT, SIGHUP}));
+}
+
+TEST_F(AsyncLogTest, RecordsFromManyThreadsAreAllWritten) {
+  auto state = std::make_shared<CaptureOutput::State>();
+  AsyncLogOptions options;
+  options.overflow_policy = LogOverflowPolicy::Block;
+  ASSERT_FALSE(AsyncLog::Instance().Start(options, MakeOutputs(state)));
+
+  constexpr int kThreads = 4;
+  constexpr int kPerThread = 500;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([t] {
+      for (int i = 0; i < kPerThread; ++i) {
+        LOG(WARNING) << "mt-record " << t << " " << i;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  AsyncLog::Instance().Flush();
+
+  EXPECT_EQ(CountMatching(state, "mt-record "),
+            static_cast<std::size_t>(kThreads * kPerThread));
+}
+
+TEST_F(AsyncLogTest, DropPolicyCountsRecordsThatDidNotFit) {
+  auto state = std::make_shared<CaptureOutput::State>();
+  AsyncLogOptions options;
+  options.overflow_policy = LogOverflowPolicy::Drop;
+  options.ring_size_bytes = 1024;
+  ASSERT_FALSE(AsyncLog::Instance().Start(options, MakeOutputs(state)));
+  const std::uint64_t dropped_before = AsyncLog::Instance().GetStats().dropped;
+
+  // The first record is picked up by the writer, which then stalls in Write()
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->stalled = true;
+  }
+  for (int i = 0; i < 200; ++i) {
+    LOG(WARNING) << "overflow-record " << i;
+  }
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->stalled = false;
+  }
+  state->cv.notify_all();
+  AsyncLog::Instance().Flush();
+
+  const std::uint64_t dropped =
+      AsyncLog::Instance().GetStats().dropped - dropped_before;
+  EXPECT_GT(dropped, 0U);
+  EXPECT_EQ(CountMatching(state, "overflow-record ") + dropped, 200U);
+}
+
+TEST_F(AsyncLogTest, FormatLogPrefixMatchesGlogLayout) {
+  const LogRecord record{google::GLOG_ERROR, 42, 1700000000123456, "a/b.cpp",
+                         "b.cpp", 17, "text"};
+  char buffer[128];
+  const std::size_t len = FormatLogPrefix(record, buffer, sizeof(buffer));
+  const std::string prefix(buffer, len);
+
+  EXPECT_EQ(prefix.front(), 'E');
+  EXPECT_NE(prefix.find(".123456"), std::string::npos);
+  EXPECT_NE(prefix.find(" 42 b.cpp:17] "), std::string::npos);
+}
+
+TEST_F(AsyncLogTest, ParseHelpersAcceptKnownNames) {
+  LogOverflowPolicy policy = LogOverflowPolicy::Drop;
+  EXPECT_TRUE(ParseLogOverflowPolicy("Block", policy));
+  EXPECT_EQ(policy, LogOverflowPolicy::Block);
+  EXPECT_TRUE(ParseLogOverflowPolicy("sample", policy));
+  EXPECT_EQ(policy, LogOverflowPolicy::Sample);
+  EXPECT_FALSE(ParseLogOverflowPolicy("discard", policy));
+
+  LogOutputKind output = LogOutputKind::Stderr;
+  EXPECT_TRUE(ParseLogOutput("Journald", output));
+  EXPECT_EQ(output, LogOutputKind::Journald);
+  EXPECT_FALSE(ParseLogOutput("syslog", output));
+
+  int severity = -1;
+  EXPECT_TRUE(ParseLogSeverity("warning", severity));
+  EXPECT_EQ(severity, google::GLOG_WARNING);
+  EXPECT_FALSE(ParseLogSeverity("debug", severity));
+}
+
+TEST_F(AsyncLogTest, MakeErrorCodeReturnsValidErrorCode) {
+  auto error = make_error_code(LogError::ThreadCreationFailed);
+
+  EXPECT_TRUE(error);
+  EXPECT_STREQ(error.category().name(), "comm_log");
+  EXPECT_EQ(error.message(), "Failed to create log writer thread");
+}
+
+TEST_F(AsyncLogTest, JournalEntriesCarryStructuredFields) {
+  auto entries = std::make_shared<CaptureJournal::Entries>();
+  CaptureJournal journal(entries, 0);
+  const LogRecord record{google::GLOG_WARNING,
+                         42,
+                         1700000000123456,
+                         "/src/L5_Common/comm_terminate/src/comm_terminate.cpp",
+                         "comm_terminate.cpp",
+                         17,
+                         "journal text",
+                         0xabcdef,
+                         7};
+  journal.Write(std::span<const LogRecord>(&record, 1));
+
+  ASSERT_EQ(entries->size(), 1U);
+  const auto& entry = entries->front();
+  EXPECT_EQ(entry.front(), "MESSAGE=journal text");
+  EXPECT_TRUE(HasField(entry, "PRIORITY=4"));
+  EXPECT_TRUE(HasField(entry, "SYSLOG_IDENTIFIER=comm_log_test"));
+  EXPECT_TRUE(HasField(entry, "CODE_LINE=17"));
+  EXPECT_TRUE(HasField(entry, "TID=42"));
+  EXPECT_TRUE(HasField(entry, "COMM_MODULE=comm_terminate"));
+  EXPECT_TRUE(HasField(entry, "COMM_CONFIG_GENERATION=7"));
+  EXPECT_TRUE(HasField(entry, "COMM_TIMESTAMP_US=1700000000123456"));
+  EXPECT_TRUE(HasField(entry, "COMM_TRACE_ID=0000000000abcdef"));
+  EXPECT_EQ(journal.GetErrorCount(), 0U);
+
+  // Without a trace id the field is left out
+  const LogRecord untraced{google::GLOG_INFO, 42, 0, "a.cpp", "a.cpp", 1, "x"};
+  journal.Write(std::span<const LogRecord>(&untraced, 1));
+  ASSERT_EQ(entries->size(), 2U);
+  EXPECT_TRUE(HasField(entries->back(), "PRIORITY=6"));
+  for (const auto& field : entries->back()) {
+    EXPECT_NE(field.rfind("COMM_TRACE_ID=", 0), 0U);
+  }
+}
+
+TEST_F(AsyncLogTest, RejectedJournalEntriesAreCounted) {
+  auto entries = std::make_shared<CaptureJournal::Entries>();
+  CaptureJournal journal(entries, -ENOENT);
+  const LogRecord record{google::GLOG_WARNING, 1, 0, "a.cpp", "a.cpp", 1,
+                         "journal fallback record"};
+  journal.Write(std::span<const LogRecord>(&record, 1));
+
+  EXPECT_EQ(entries->size(), 1U);
+  EXPECT_EQ(journal.GetErrorCount(), 1U);
+}
+
+TEST_F(AsyncLogTest, TraceIdAndConfigGenerationAreCapturedPerRecord) {
+  auto entries = std::make_shared<CaptureJournal::Entries>();
+  std::vector<std::unique_ptr<LogOutput>> outputs;
+  outputs.push_back(std::make_unique<CaptureJournal>(entries, 0));
+  ASSERT_FALSE(AsyncLog::Instance().Start(AsyncLogOptions{}, std::move(outputs)));
+
+  SetLogConfigGeneration(3);
+  {
+    ScopedLogTraceId trace(0x1234);
+    EXPECT_EQ(GetLogTraceId(), 0x1234U);
+    LOG(WARNING) << "traced record";
+  }
+  EXPECT_EQ(GetLogTraceId(), 0U);
+  SetLogConfigGeneration(4);
+  LOG(WARNING) << "untraced record";
+  AsyncLog::Instance().Flush();
+  SetLogConfigGeneration(0);
+
+  ASSERT_EQ(entries->size(), 2U);
+  EXPECT_EQ((*entries)[0].front(), "MESSAGE=traced record");
+  EXPECT_TRUE(HasField((*entries)[0], "COMM_TRACE_ID=0000000000001234"));
+  EXPECT_TRUE(HasField((*entries)[0], "COMM_CONFIG_GENERATION=3"));
+  EXPECT_EQ((*entries)[1].front(), "MESSAGE=untraced record");
+  EXPECT_TRUE(HasField((*entries)[1], "COMM_CONFIG_GENERATION=4"));
+}
+
+class BinlogTest : public ::testing::Test {
+ protected:
+  void TearDown() override { AsyncLog::Instance().Stop(); }
+};
+
+static_assert(CountBinlogPlaceholders("a={} b={} {{literal}}") == 2);
+static_assert(CountBinlogPlaceholders("none") == 0);
+
+TEST_F(BinlogTest, RecordsAreRenderedForTextOutputs) {
+  auto state = std::make_shared<CaptureOutput::State>();
+  ASSERT_FALSE(AsyncLog::Instance().Start(AsyncLogOptions{}, MakeOutputs(state)));
+
+  const std::string name = "conn";
+  int value = 42;
+  BLOG(WARNING, "binlog-text {} id={} ratio={} ok={} {{x}}", name, -7, 0.5,
+       true);
+  BLOG(WARNING, "binlog-text ptr={}", static_cast<const void*>(&value));
+  AsyncLog::Instance().Flush();
+
+  EXPECT_EQ(CountMatching(state, "binlog-text conn id=-7 ratio=0.5 ok=true {x}"),
+            1U);
+  EXPECT_EQ(CountMatching(state, "binlog-text ptr=0x"), 1U);
+}
+
+TEST_F(BinlogTest, BinaryFileRoundTrip) {
+  const std::string path =
+      ::testing::TempDir() + "comm_binlog_" + std::to_string(::getpid());
+  std::remove(path.c_str());
+
+  AsyncLogOptions options;
+  options.binary_file = path;
+  auto state = std::make_shared<CaptureOutput::State>();
+  ASSERT_FALSE(AsyncLog::Instance().Start(options, MakeOutputs(state)));
+  for (unsigned i = 0; i < 3; ++i) {
+    BLOG(WARNING, "binlog-file i={} tag={}", i, "abc");
+  }
+  AsyncLog::Instance().Stop();
+
+  // Binary records bypass the text outputs
+  EXPECT_EQ(CountMatching(state, "binlog-file"), 0U);
+
+  std::ifstream input(path, std::ios::binary);
+  BinlogFileReader reader(input);
+  BinlogEvent event;
+  std::vector<std::string> texts;
+  while (reader.Next(event)) {
+    ASSERT_NE(event.site, nullptr);
+    EXPECT_EQ(event.site->severity, google::GLOG_WARNING);
+    EXPECT_EQ(event.site->arg_types, "us");
+    EXPECT_EQ(event.tid, ::gettid());
+    std::string text;
+    RenderBinlogMessage(event.site->format, event.site->arg_types,
+                        event.payload, text);
+    texts.push_back(text);
+  }
+  EXPECT_FALSE(reader.IsCorrupt());
+  ASSERT_EQ(texts.size(), 3U);
+  EXPECT_EQ(texts[0], "binlog-file i=0 tag=abc");
+  EXPECT_EQ(texts[2], "binlog-file i=2 tag=abc");
+  std::remove(path.c_str());
+}
+
+TEST_F(BinlogTest, TruncatedPayloadRendersPlaceholder) {
+  const std::uint64_t value = 5;
+  const std::string payload(reinterpret_cast<const char*>(&value),
+                            sizeof(value));
+  std::string text;
+  RenderBinlogMessage("a={} b={}", "uu", payload, text);
+  EXPECT_EQ(text, "a=5 b=<?>");
+}
+
+class LogFileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir_ = ::testing::TempDir() + "comm_log_file_" + std::to_string(::getpid());
+    std::filesystem::remove_all(dir_);
+    path_ = dir_ + "/test.log";
+  }
+  void TearDown() override { std::filesystem::remove_all(dir_); }
+
+  static LogRecord Record(std::int64_t timestamp_us, std::string_view message) {
+    return LogRecord{google::GLOG_WARNING, 1, timestamp_us, "a.cpp", "a.cpp",
+                     1, message};
+  }
+
+  /// Rotated segment names in the log directory, sorted
+  std::vector<std::string> Segments() const {
+    std::vector<std::string> names;
+    for (const auto& entry : std::filesystem::directory_iterator(dir_)) {
+      const std::string name = entry.path().filename().string();
+      if (name != "test.log") {
+        names.push_back(name);
+      }
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+  }
+
+  static std::string ReadGzip(const std::string& path) {
+    std::string text;
+    gzFile file = gzopen(path.c_str(), "rb");
+    char buffer[4096];
+    int count = 0;
+    while (file != nullptr && (count = gzread(file, buffer, sizeof(buffer))) > 0) {
+      text.append(buffer, static_cast<std::size_t>(count));
+    }
+    if (file != nullptr) {
+      gzclose(file);
+    }
+    return text;
+  }
+
+  static std::size_t CountLines(const std::string& text) {
+    return static_cast<std::size_t>(std::count(text.begin(), text.end(), '\n'));
+  }
+
+  std::string dir_;
+  std::string path_;
+};
+
+TEST_F(LogFileTest, SizeRotationCompressesSegmentsAndKeepsMaxFiles) {
+  FileLogOptions options;
+  options.path = path_;
+  options.max_size_bytes = 4096;
+  options.buffer_size_bytes = 512;
+  options.max_files = 2;
+  options.compression = LogCompression::Gzip;
+  RotatingFileLogOutput output(options);
+  ASSERT_FALSE(output.Open());
+
+  const std::string message = "file-record " + std::string(60, 'x');
+  for (int i = 0; i < 300; ++i) {
+    const LogRecord record = Record(1700000000000000 + i, message);
+    output.Write(std::span<const LogRecord>(&record, 1));
+  }
+  output.Flush();
+  output.WaitForCompression();
+
+  EXPECT_GE(output.GetRotationCount(), 5U);
+  EXPECT_EQ(output.GetErrorCount(), 0U);
+  const auto segments = Segments();
+  ASSERT_EQ(segments.size(), 2U);
+  for (const auto& name : segments) {
+    EXPECT_EQ(name.substr(name.size() - 3), ".gz") << name;
+    const std::string text = ReadGzip(dir_ + "/" + name);
+    EXPECT_LE(text.size(), 4096U);
+    EXPECT_GT(CountLines(text), 0U);
+    EXPECT_EQ(CountLines(text), CountMatching(text, "file-record "));
+  }
+  EXPECT_LE(std::filesystem::file_size(path_), 4096U);
+}
+
+TEST_F(LogFileTest, CompressorThreadBlocksTerminationSignals) {
+  FileLogOptions options;
+  options.path = path_;
+  RotatingFileLogOutput output(options);
+  ASSERT_FALSE(output.Open());
+
+  EXPECT_EQ(BlockedTerminationSignals("comm_log_zip"),
+            (std::vector<int>{SIGINT, SIGTERM, SIGQUIT, SIGHUP}));
+}
+
+TEST_F(LogFileTest, IntervalRotationFollowsRecordTime) {
+  FileLogOptions options;
+  options.path = path_;
+  options.rotate_interval = std::chrono::hours(1);
+  options.max_files = 0;
+  options.compression = LogCompression::None;
+  RotatingFileLogOutput output(options);
+  ASSERT_FALSE(output.Open());
+
+  // Far in the future: the first record only moves the boundary (empty file)
+  const std::int64_t hour_us = 3600LL * 1000000;
+  const std::int64_t base = (4102444800000000LL / hour_us) * hour_us;
+  const LogRecord records[] = {Record(base + 10, "first"),
+                               Record(base + 20, "second"),
+                               Record(base + hour_us + 5, "third")};
+  output.Write(records);
+  output.Flush();
+  output.WaitForCompression();
+
+  EXPECT_EQ(output.GetRotationCount(), 1U);
+  const auto segments = Segments();
+  ASSERT_EQ(segments.size(), 1U);
+  std::ifstream segment(dir_ + "/" + segments.front());
+  const std::string text((std::istreambuf_iterator<char>(segment)),
+                         std::istreambuf_iterator<char>());
+  EXPECT_EQ(CountLines(text), 2U);
+  std::ifstream active(path_);
+  const std::string current((std::istreambuf_iterator<char>(active)),
+                            std::istreambuf_iterator<char>());
+  EXPECT_EQ(CountMatching(current, "] third"), 1U);
+}
+
+TEST_F(LogFileTest, OpenCompressesLeftoverSegmentsAndRemovesPartials) {
+  std::filesystem::create_directories(dir_);
+  const std::string leftover = path_ + ".20260101-000000.000000";
+  std::ofstream(leftover) << "leftover line\n";
+  std::ofstream(path_ + ".20260101-000001.000000.gz.part") << "partial";
+
+  FileLogOptions options;
+  options.path = path_;
+  RotatingFileLogOutput output(options);
+  ASSERT_FALSE(output.Open());
+  output.WaitForCompression();
+
+  const auto segments = Segments();
+  ASSERT_EQ(segments.size(), 1U);
+  EXPECT_EQ(dir_ + "/" + segments.front(), leftover + ".gz");
+  EXPECT_EQ(ReadGzip(leftover + ".gz"), "leftover line\n");
+}
+
+TEST_F(LogFileTest, ConfigSelectsFileOutput) {
+  LogConfig config;
+  config.output = "file";
+  config.file_path = path_;
+  config.file_max_size_mb = 2;
+  config.file_compression = "none";
+  config.file_max_files = 3;
+  const AsyncLogOptions options = MakeAsyncLogOptions(config);
+
+  EXPECT_EQ(options.output, LogOutputKind::File);
+  EXPECT_EQ(options.file.path, path_);
+  EXPECT_EQ(options.file.max_size_bytes, 2U * 1024 * 1024);
+  EXPECT_EQ(options.file.compression, LogCompression::None);
+  EXPECT_EQ(options.file.max_files, 3U);
+
+  LogCompression compression = LogCompression::None;
+  EXPECT_TRUE(ParseLogCompression("ZSTD", compression));
+  EXPECT_EQ(compression, LogCompression::Zstd);
+  EXPECT_FALSE(ParseLogCompression("lz4", compression));
+}
+
+class LogLevelTest : public ::testing::Test {
+ protected:
+  void TearDown() override {
+    AsyncLog::Instance().Stop();
+    ApplyLogLevels(LogLevel{google::GLOG_WARNING, 0}, {});
+  }
+};
+
+TEST_F(LogLevelTest, ModuleNameIsDirectoryAboveSourceDir) {
+  EXPECT_EQ(LogModuleName("/w/L5_Common/comm_terminate/src/comm_terminate.cpp"),
+            "comm_terminate");
+  EXPECT_EQ(LogModuleName("L4_Infrastructure/infr_main/interface/infr_main.h"),
+            "infr_main");
+  EXPECT_EQ(LogModuleName("/w/main/main.cpp"), "main");
+  EXPECT_EQ(LogModuleName("main.cpp"), "main");
+  EXPECT_EQ(LogModuleName(__FILE__), "comm_log");
+}
+
+TEST_F(LogLevelTest, ParseLogLevelAcceptsSeveritiesAndVerbosity) {
+  LogLevel level;
+  EXPECT_TRUE(ParseLogLevel("warning", level));
+  EXPECT_EQ(level.severity, google::GLOG_WARNING);
+  EXPECT_EQ(level.verbosity, 0);
+  EXPECT_TRUE(ParseLogLevel("V3", level));
+  EXPECT_EQ(level.severity, google::GLOG_INFO);
+  EXPECT_EQ(level.verbosity, 3);
+  EXPECT_FALSE(ParseLogLevel("V", level));
+  EXPECT_FALSE(ParseLogLevel("Vx", level));
+  EXPECT_FALSE(ParseLogLevel("debug", level));
+}
+
+TEST_F(LogLevelTest, ModuleOverrideEnablesVerboseOnlyForThatModule) {
+  ApplyLogLevels(LogLevel{google::GLOG_WARNING, 0},
+                 {{"comm_log", LogLevel{google::GLOG_INFO, 2}}});
+  EXPECT_EQ(FLAGS_minloglevel, google::GLOG_INFO);
+  EXPECT_TRUE(GetLogModule(__FILE__).IsVerboseEnabled(2));
+  EXPECT_FALSE(GetLogModule(__FILE__).IsVerboseEnabled(3));
+  EXPECT_FALSE(GetLogModule("/w/other_module/src/other.cpp").IsEnabled(
+      google::GLOG_INFO));
+
+  auto state = std::make_shared<CaptureOutput::State>();
+  ASSERT_FALSE(AsyncLog::Instance().Start(AsyncLogOptions{}, MakeOutputs(state)));
+  MVLOG(2) << "level-test verbose";
+  MVLOG(3) << "level-test too verbose";
+  MLOG(INFO) << "level-test info";
+  AsyncLog::Instance().Flush();
+
+  EXPECT_EQ(CountMatching(state, "level-test verbose"), 1U);
+  EXPECT_EQ(CountMatching(state, "level-test too verbose"), 0U);
+  EXPECT_EQ(CountMatching(state, "level-test info"), 1U);
+}
+
+TEST_F(LogLevelTest, ModuleOverrideFiltersPlainLogInWriterPath) {
+  ApplyLogLevels(LogLevel{google::GLOG_INFO, 0},
+                 {{"comm_log", LogLevel{google::GLOG_ERROR, 0}}});
+
+  auto state = std::make_shared<CaptureOutput::State>();
+  ASSERT_FALSE(AsyncLog::Instance().Start(AsyncLogOptions{}, MakeOutputs(state)));
+  LOG(WARNING) << "level-test plain warning";
+  MLOG(WARNING) << "level-test module warning";
+  LOG(ERROR) << "level-test plain error";
+  AsyncLog::Instance().Flush();
+
+  EXPECT_EQ(CountMatching(state, "level-test plain warning"), 0U);
+  EXPECT_EQ(CountMatching(state, "level-test module warning"), 0U);
+  EXPECT_EQ(CountMatching(state, "level-test plain error"), 1U);
+}
+
+TEST_F(LogLevelTest, ModuleOverridesFilterPlainLogWithoutAsyncLog) {
+  ASSERT_FALSE(AsyncLog::Instance().IsRunning());
+  testing::internal::CaptureStderr();
+  // Another module lowered to INFO: INFO of this module stays filtered
+  ApplyLogLevels(LogLevel{google::GLOG_WARNING, 0},
+                 {{"comm_other", LogLevel{google::GLOG_INFO, 0}}});
+  LOG(INFO) << "sync-test info while lowered elsewhere";
+  LOG(WARNING) << "sync-test warning while lowered elsewhere";
+  // This module raised to ERROR: its warnings are filtered
+  ApplyLogLevels(LogLevel{google::GLOG_INFO, 0},
+                 {{"comm_log", LogLevel{google::GLOG_ERROR, 0}}});
+  LOG(WARNING) << "sync-test warning while raised";
+  LOG(ERROR) << "sync-test error while raised";
+  // Without overrides glog writes directly again
+  ApplyLogLevels(LogLevel{google::GLOG_INFO, 0}, {});
+  LOG(INFO) << "sync-test info without overrides";
+  const std::string output = testing::internal::GetCapturedStderr();
+
+  EXPECT_EQ(CountMatching(output, "sync-test info while lowered elsewhere"), 0U) << output;
+  EXPECT_EQ(CountMatching(output, "sync-test warning while lowered elsewhere"), 1U) << output;
+  EXPECT_EQ(CountMatching(output, "sync-test warning while raised"), 0U) << output;
+  EXPECT_EQ(CountMatching(output, "sync-test error while raised"), 1U) << output;
+  EXPECT_EQ(CountMatching(output, "sync-test info without overrides"), 1U) << output;
+}
+
+TEST_F(LogLevelTest, ConfigLevelsAreAppliedAndReplaced) {
+  LogConfig config;
+  config.level = "ERROR";
+  config.modules = {{"comm_log", "V1"}, {"broken", "loud"}};
+  ApplyLogConfigLevels(config);
+  EXPECT_TRUE(GetLogModule(__FILE__).IsVerboseEnabled(1));
+  EXPECT_FALSE(GetLogModule("/w/broken/src/b.cpp").IsEnabled(
+      google::GLOG_WARNING));
+
+  // A reload without the override returns the module to the default level
+  config.modules.clear();
+  ApplyLogConfigLevels(config);
+  EXPECT_FALSE(GetLogModule(__FILE__).IsEnabled(google::GLOG_WARNING));
+  EXPECT_EQ(FLAGS_minloglevel, google::GLOG_ERROR);
+}
+
+class LogLimitTest : public ::testing::Test {
+ protected:
+  void TearDown() override { AsyncLog::Instance().Stop(); }
+};
+
+TEST_F(LogLimitTest, SuppressedNoteUsesThousandsSeparators) {
+  char text[64];
+  std::size_t len = FormatSuppressedNote(12345, text, sizeof(text));
+  EXPECT_EQ(std::string(text, len), "suppressed 12,345 similar messages");
+  len = FormatSuppressedNote(1, text, sizeof(text));
+  EXPECT_EQ(std::string(text, len), "suppressed 1 similar message");
+  len = FormatSuppressedNote(1000000, text, sizeof(text));
+  EXPECT_EQ(std::string(text, len), "suppressed 1,000,000 similar messages");
+}
+
+TEST_F(LogLimitTest, SampledLogPassesOneInNWithSuppressedPrefix) {
+  auto state = std::make_shared<CaptureOutput::State>();
+  ASSERT_FALSE(AsyncLog::Instance().Start(AsyncLogOptions{}, MakeOutputs(state)));
+  for (int i = 0; i < 100; ++i) {
+    LOG_SAMPLED(WARNING, 10) << "sampled-record " << i;
+  }
+  AsyncLog::Instance().Flush();
+
+  EXPECT_EQ(CountMatching(state, "sampled-record "), 10U);
+  EXPECT_EQ(CountMatching(state, "[suppressed 9 similar messages] sampled-record 10"),
+            1U);
+}
+
+TEST_F(LogLimitTest, RateLimitedLogAllowsBurstThenSuppresses) {
+  auto state = std::make_shared<CaptureOutput::State>();
+  AsyncLogOptions options;
+  options.summary_interval = std::chrono::seconds(0);
+  ASSERT_FALSE(AsyncLog::Instance().Start(options, MakeOutputs(state)));
+  for (int i = 0; i < 50; ++i) {
+    LOG_RATE_LIMITED(WARNING, 0.001, 5) << "limited-record " << i;
+  }
+  AsyncLog::Instance().Flush();
+
+  EXPECT_EQ(CountMatching(state, "limited-record "), 5U);
+  // The quiet site is summarized by the writer
+  EXPECT_EQ(CountMatching(state, "suppressed 45 similar messages"), 1U);
+}
+
+TEST_F(LogLimitTest, ConcurrentSitesCountEveryRecord) {
+  static LogLimitSite site(__FILE__, __LINE__, google::GLOG_WARNING);
+  std::atomic<std::uint64_t> passed{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&passed] {
+      for (int i = 0; i < 1000; ++i) {
+        if (site.AllowSample(7)) {
+          passed.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(passed.load(), (4000U + 6) / 7);
+  EXPECT_EQ(passed.load() + site.TakeSuppressed(), 4000U);
+}
+
+}  // namespace comm
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = true;
+  FLAGS_minloglevel = 1;  // Tests log at WARNING, keep INFO noise out
+
+  int result = RUN_ALL_TESTS();
+
+  google::ShutdownGoogleLogging();
+  return result;
+}
@@ -10,8 +10,25 @@
 #include "comm_main.h"
 
 #include <glog/logging.h>
+#include "comm_clock.h"
 #include "comm_config_core.h"
+#include "comm_coro_io.h"
+#include "comm_ebr.h"
+#include "comm_executor.h"
+#include "comm_executor_config.h"
+#include "comm_log.h"
+#include "comm_log_config.h"
+#include "comm_metrics_config.h"
+#include "comm_metrics_server.h"
+#include "comm_profiler.h"
+#include "comm_profiler_config.h"
+#include "comm_ratelimit_config.h"
+#include "comm_shard.h"
+#include "comm_shard_config.h"
 #include "comm_terminate.h"
+#include "comm_timer.h"
+#include "comm_trace.h"
+#include "comm_trace_config.h"
 
 #ifndef PROJECT_NAME
 #define PROJECT_NAME "modu-core"  // Fallback if not building from main/
@@ -68,6 +85,12 @@ std::vector<std::pair<std::string, std::string>> Main::ParseCommandLineOverrides
 }
 
 std::error_code Main::init(int argc, const char* argv[]) {  // NOLINT
+  // Calibrate the timestamp clock before any thread logs or measures
+  if (!FastClock::Calibrate()) {
+    LOG(INFO) << "FastClock uses clock_gettime(): "
+              << FastClock::GetStatus().fallback_reason;
+  }
+
   // Use project name from CMake, fallback to extracting from argv[0]
   std::string app_name = PROJECT_NAME;
   
@@ -99,6 +122,120 @@ std::error_code Main::init(int argc, const char* argv[]) {  // NOLINT
     Config::Instance().SetOverride(key, value);
   }
 
+  // Default and per-module log levels and the config generation stamped on
+  // log records, re-applied on every reload
+  auto log_config = Config::Instance().Get<LogConfig>("logging");
+  ApplyLogConfigLevels(log_config);
+  SetLogConfigGeneration(Config::Instance().GetGeneration());
+  Config::Instance().RegisterReloadListener([]() {
+    SetLogConfigGeneration(Config::Instance().GetGeneration());
+    ApplyLogConfigLevels(Config::Instance().Get<LogConfig>("logging"));
+    LOG(INFO) << "Log levels re-applied from configuration";
+  });
+
+  // Move glog output off the calling threads (applied once at startup)
+  if (log_config.async) {
+    auto log_result = AsyncLog::Instance().Start(MakeAsyncLogOptions(log_config));
+    if (log_result) {
+      LOG(WARNING) << "Asynchronous logging unavailable, logging synchronously: "
+                   << log_result.message();
+    }
+  }
+
+  // Spans recorded into per-thread rings; on/off and the sample rate follow
+  // reloads, the rings are read on demand (GET /debug/trace) and at shutdown
+  Tracer::Instance().SetServiceName(PROJECT_NAME);
+  ApplyTraceConfig(Config::Instance().Get<TraceConfig>("tracing"));
+  Config::Instance().RegisterReloadListener([]() {
+    ApplyTraceConfig(Config::Instance().Get<TraceConfig>("tracing"));
+  });
+
+  // Shared CPU pools; thread counts are applied once at startup
+  auto executor_config = Config::Instance().Get<ExecutorConfig>("executor");
+  auto executor_result = Executor::Instance().Start(executor_config);
+  if (executor_result) {
+    LOG(ERROR) << "Failed to start thread pools: " << executor_result.message();
+    return executor_result;
+  }
+  Config::Instance().RegisterReloadListener([executor_config]() {
+    if (Config::Instance().Get<ExecutorConfig>("executor") != executor_config) {
+      LOG(WARNING) << "Changed [executor] settings take effect after a restart";
+    }
+  });
+
+  // Named rate limits, re-applied on every reload; limiters created from
+  // RateLimits::Params() follow them without restarting
+  RateLimits::Instance().Apply(Config::Instance().Get<RateLimitConfig>("ratelimit").limits);
+  Config::Instance().RegisterReloadListener([]() {
+    RateLimits::Instance().Apply(Config::Instance().Get<RateLimitConfig>("ratelimit").limits);
+  });
+
+  // Shared-nothing mode: one pinned event loop per core next to the pools;
+  // every reload runs the shards' OnReload() callbacks on their own threads
+  auto shard_config = Config::Instance().Get<ShardConfig>("shards");
+  if (shard_config.enabled) {
+    auto shard_result = ShardRuntime::Instance().Start(shard_config);
+    if (shard_result) {
+      LOG(ERROR) << "Failed to start shards: " << shard_result.message();
+      return shard_result;
+    }
+  }
+  Config::Instance().RegisterReloadListener([shard_config]() {
+    if (Config::Instance().Get<ShardConfig>("shards") != shard_config) {
+      LOG(WARNING) << "Changed [shards] settings take effect after a restart";
+    }
+    ShardRuntime::Instance().Reload();
+  });
+
+  // Prometheus endpoint for the MetricsRegistry, served by coroutines on the
+  // default pool; the listen address is applied once at startup
+  auto metrics_config = Config::Instance().Get<MetricsConfig>("metrics");
+  if (metrics_config.enabled) {
+    auto metrics_result = MetricsServer::Instance().Start(metrics_config);
+    if (metrics_result) {
+      LOG(ERROR) << "Failed to start metrics server: " << metrics_result.message();
+      return metrics_result;
+    }
+  }
+  Config::Instance().RegisterReloadListener([metrics_config]() {
+    if (Config::Instance().Get<MetricsConfig>("metrics") != metrics_config) {
+      LOG(WARNING) << "Changed [metrics] settings take effect after a restart";
+    }
+  });
+  // Chrome/Perfetto JSON by default, ?format=otlp for OTLP/JSON
+  MetricsServer::Instance().AddHandler(
+      "/debug/trace", "application/json", [](std::string_view query) {
+        return Tracer::Instance().Render(query.find("format=otlp") != std::string_view::npos
+                                             ? TraceFormat::Otlp
+                                             : TraceFormat::Chrome);
+      });
+  // CPU profiler, started and stopped at runtime through the same port:
+  // /debug/profile/start[?hz=N&samples=N], /debug/profile/stop and
+  // /debug/profile[?format=pprof] (collapsed stacks by default). The port has
+  // no authentication, so only an explicit [profiler] enabled serves them
+  if (Config::Instance().Get<ProfilerConfig>("profiler").enabled) {
+    MetricsServer::Instance().AddHandler(
+        "/debug/profile/start", "text/plain", [](std::string_view query) {
+          auto profiler_config = Config::Instance().Get<ProfilerConfig>("profiler");
+          ApplyProfilerQuery(query, profiler_config);
+          const auto error = Profiler::Instance().Start(profiler_config);
+          return error ? "Profiler not started: " + error.message() + "\n"
+                       : "Profiling at " + std::to_string(profiler_config.frequency_hz) + " Hz\n";
+        });
+    MetricsServer::Instance().AddHandler("/debug/profile/stop", "text/plain", [](std::string_view) {
+      Profiler::Instance().Stop();
+      const ProfilerStats stats = Profiler::Instance().GetStats();
+      return "Profiler stopped: " + std::to_string(stats.samples) + " samples, " +
+             std::to_string(stats.dropped) + " dropped\n";
+    });
+    MetricsServer::Instance().AddHandler(
+        "/debug/profile", "application/octet-stream", [](std::string_view query) {
+          return Profiler::Instance().Render(query.find("format=pprof") != std::string_view::npos
+                                                 ? ProfileFormat::Pprof
+                                                 : ProfileFormat::Collapsed);
+        });
+  }
+
   // Initialize graceful shutdown handler (SIGINT, SIGTERM, SIGQUIT, SIGHUP)
   auto ret_code = Terminate::Instance().Start();
   if (ret_code) {
@@ -122,8 +259,45 @@ std::error_code Main::init(int argc, const char* argv[]) {  // NOLINT
 std::error_code Main::deinit() {
   // Note: Config and Terminate are singletons - cleanup happens automatically at program exit
   // No explicit deinitialization needed
-  
+
+  // Run the shards' stop callbacks and end their loops (no-op if main() did)
+  ShardRuntime::Instance().Stop();
+
+  // Close the metrics endpoint while the reactor still serves its sockets
+  MetricsServer::Instance().Stop();
+
+  // Disarm the sampling timers of a profile nobody stopped
+  Profiler::Instance().Stop();
+
+  // Pending timer callbacks are dropped; expired ones still reach their pools
+  TimerService::Instance().Stop();
+
+  // Pending sleeps and fd waits resume with ShuttingDown while pools still run
+  Reactor::Instance().Stop();
+
+  // Run tasks still queued by the higher layers, then stop the workers
+  Executor::Instance().Shutdown();
+
+  // No worker can be in a read section anymore: free retired snapshots
+  Ebr::Instance().Stop();
+
+  // Flight-recorder dump of the last spans of every thread, shutdown included
+  const auto trace_config = Config::Instance().Get<TraceConfig>("tracing");
+  if (!trace_config.export_path.empty()) {
+    auto trace_result = Tracer::Instance().Export(trace_config.export_path,
+                                                  ParseTraceFormat(trace_config.format));
+    if (trace_result) {
+      LOG(ERROR) << "Failed to export trace to " << trace_config.export_path << ": "
+                 << trace_result.message();
+    } else {
+      LOG(INFO) << "Trace exported to " << trace_config.export_path;
+    }
+  }
+
   LOG(INFO) << "Common layer (L5) deinitialization completed successfully";
+
+  // Drain queued log records and return glog to direct stderr output
+  AsyncLog::Instance().Stop();
   return {};  // Success - empty error_code
 }
 
@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_memory_benchmark.cpp
+ * @brief PoolResource and Arena against the global heap
+ * @details BM_*Churn allocates and frees blocks of mixed small sizes from
+ *          1-8 threads; BM_*ReloadScratch builds the listener and override
+ *          copies made on every configuration reload.
+ *
+ * Usage: modu-core-comm_memory_benchmark [--benchmark_filter=...]
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <functional>
+#include <memory_resource>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "comm_arena.h"
+#include "comm_pool.h"
+
+namespace {
+
+constexpr std::array<std::size_t, 8> kSizes = {16, 24, 40, 64, 100, 200, 512, 1000};
+constexpr std::size_t kLive = 64;
+
+void Churn(benchmark::State& state, std::pmr::memory_resource* resource) {
+  std::array<void*, kLive> blocks{};
+  std::array<std::size_t, kLive> sizes{};
+  std::size_t step = 0;
+  for (auto _ : state) {
+    const std::size_t slot = step % kLive;
+    if (blocks[slot] != nullptr) {
+      resource->deallocate(blocks[slot], sizes[slot]);
+    }
+    sizes[slot] = kSizes[step % kSizes.size()];
+    blocks[slot] = resource->allocate(sizes[slot]);
+    benchmark::DoNotOptimize(blocks[slot]);
+    ++step;
+  }
+  for (std::size_t slot = 0; slot < kLive; ++slot) {
+    if (blocks[slot] != nullptr) {
+      resource->deallocate(blocks[slot], sizes[slot]);
+    }
+  }
+}
+
+void BM_NewDeleteChurn(benchmark::State& state) {
+  Churn(state, std::pmr::new_delete_resource());
+}
+BENCHMARK(BM_NewDeleteChurn)->ThreadRange(1, 8)->UseRealTime();
+
+void BM_PoolChurn(benchmark::State& state) { Churn(state, &comm::PoolResource::Instance()); }
+BENCHMARK(BM_PoolChurn)->ThreadRange(1, 8)->UseRealTime();
+
+struct ReloadInput {
+  std::vector<std::function<void()>> listeners;
+  std::vector<std::pair<std::string, std::string>> overrides;
+};
+
+ReloadInput MakeReloadInput() {
+  ReloadInput input;
+  for (int index = 0; index < 8; ++index) {
+    input.listeners.emplace_back([index] { benchmark::DoNotOptimize(index); });
+    input.overrides.emplace_back("infr_main.section_" + std::to_string(index) + ".setting_name",
+                                 "a value that does not fit the small string buffer");
+  }
+  return input;
+}
+
+/// Scratch copies made by one reload: listeners and overrides
+void BM_HeapReloadScratch(benchmark::State& state) {
+  const ReloadInput input = MakeReloadInput();
+  for (auto _ : state) {
+    std::vector<std::function<void()>> listeners = input.listeners;
+    std::vector<std::pair<std::string, std::string>> overrides = input.overrides;
+    benchmark::DoNotOptimize(listeners.data());
+    benchmark::DoNotOptimize(overrides.data());
+  }
+}
+BENCHMARK(BM_HeapReloadScratch);
+
+void BM_ArenaReloadScratch(benchmark::State& state) {
+  const ReloadInput input = MakeReloadInput();
+  for (auto _ : state) {
+    comm::InlineArena<2048> arena;
+    std::pmr::vector<std::function<void()>> listeners(input.listeners.begin(),
+                                                      input.listeners.end(), &arena);
+    std::pmr::vector<std::pair<std::pmr::string, std::pmr::string>> overrides(&arena);
+    overrides.reserve(input.overrides.size());
+    for (const auto& [path, value] : input.overrides) {
+      overrides.emplace_back(path, value);
+    }
+    benchmark::DoNotOptimize(listeners.data());
+    benchmark::DoNotOptimize(overrides.data());
+  }
+}
+BENCHMARK(BM_ArenaReloadScratch);
+
+}  // namespace
@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_arena.h
+ * @brief Monotonic arena for short-lived, related allocations
+ * @details An Arena hands out memory by bumping a pointer, first through an
+ *          optional caller buffer, then through chunks from its upstream
+ *          resource (each twice the size of the previous one). Deallocation
+ *          is a no-op; everything is freed at once by Reset(), Release() or
+ *          the destructor. Reset() keeps the largest chunk, so an arena that
+ *          is reused for the same job stops allocating after the first run.
+ *
+ * @code
+ * comm::InlineArena<2048> arena;               // 2 KiB on the stack
+ * std::pmr::vector<std::function<void()>> listeners(&arena);
+ * listeners.assign(m_listeners.begin(), m_listeners.end());
+ * @endcode
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+#include "comm_pool.h"
+
+namespace comm {
+
+/**
+ * @class Arena
+ * @brief Monotonic std::pmr::memory_resource
+ * @note Not thread-safe: one arena per thread or per job
+ */
+class Arena : public std::pmr::memory_resource {
+ public:
+  explicit Arena(std::pmr::memory_resource* upstream = &PoolResource::Instance()) noexcept;
+
+  /**
+   * @param buffer Used before any chunk is allocated; must outlive the arena
+   */
+  Arena(void* buffer, std::size_t size,
+        std::pmr::memory_resource* upstream = &PoolResource::Instance()) noexcept;
+
+  ~Arena() override;
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  /**
+   * @brief Free all allocations, keep the largest chunk for reuse
+   */
+  void Reset() noexcept;
+
+  /**
+   * @brief Free all allocations and return all chunks upstream
+   */
+  void Release() noexcept;
+
+  /// Bytes handed out since construction or the last Reset()/Release()
+  std::size_t BytesUsed() const noexcept { return m_used; }
+
+  /// Chunks currently held from upstream
+  std::size_t ChunkCount() const noexcept;
+
+ private:
+  struct Chunk;
+
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+  void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override;
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+  /// Bump allocate from [m_current, m_end), nullptr if it does not fit
+  void* TryBump(std::size_t bytes, std::size_t alignment) noexcept;
+  void FreeChunks(Chunk* keep) noexcept;
+
+  std::pmr::memory_resource* const m_upstream;
+  std::byte* const m_buffer;
+  const std::size_t m_buffer_size;
+  std::byte* m_current;
+  std::byte* m_end;
+  /// Chunks in use, newest first
+  Chunk* m_chunks{nullptr};
+  /// Chunk kept by Reset() for the next overflow
+  Chunk* m_spare{nullptr};
+  std::size_t m_next_chunk_size;
+  std::size_t m_used{0};
+};
+
+/**
+ * @class InlineArena
+ * @brief Arena whose first kSize bytes live inside the object (e.g. on the stack)
+ */
+template <std::size_t kSize>
+class InlineArena : public Arena {
+ public:
+  explicit InlineArena(std::pmr::memory_resource* upstream = &PoolResource::Instance()) noexcept
+      : Arena(m_storage, kSize, upstream) {}
+
+ private:
+  // Only the address is used before this member's lifetime starts
+  alignas(std::max_align_t) std::byte m_storage[kSize];
+};
+
+}  // namespace comm
@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_pool.h
+ * @brief Size-class pool allocator with thread-local caches
+ * @details PoolResource rounds small requests up to one of 16 size classes
+ *          (16 B to 4 KiB). Each thread keeps a short free list per class,
+ *          so most allocations and deallocations touch no shared state;
+ *          full or empty thread lists exchange a batch of blocks with the
+ *          central list of the class under its mutex. Blocks are carved from
+ *          64 KiB slabs that stay with the pool. Larger or over-aligned
+ *          requests go to the upstream resource.
+ *
+ * @code
+ * std::pmr::vector<Event> events(&comm::PoolResource::Instance());
+ *
+ * auto session = comm::MakePooled<Session>(socket);   // freed into the pool
+ * @endcode
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+namespace comm {
+
+/**
+ * @brief Counters reported by PoolResource::GetStats()
+ */
+struct PoolStats {
+  std::size_t slab_bytes{0};            ///< Memory taken from upstream for slabs
+  std::size_t central_free_blocks{0};   ///< Free blocks not cached by any thread
+  std::uint64_t oversize_allocations{0};  ///< Requests passed to upstream
+};
+
+/**
+ * @class PoolResource
+ * @brief Process-wide size-class pool, usable as std::pmr::memory_resource
+ */
+class PoolResource : public std::pmr::memory_resource {
+ public:
+  /// Largest request served from a size class
+  static constexpr std::size_t kMaxBlockSize = 4096;
+
+  /**
+   * @brief Returns the process-wide pool
+   * @note Never destroyed: threads return their cached blocks at exit,
+   *       which may happen after static destruction
+   */
+  static PoolResource& Instance();
+
+  PoolResource(const PoolResource&) = delete;
+  PoolResource& operator=(const PoolResource&) = delete;
+
+  PoolStats GetStats() const;
+
+  /// Size class index for bytes (bytes <= kMaxBlockSize)
+  static std::size_t ClassIndex(std::size_t bytes) noexcept;
+
+  /// Block size of a size class
+  static std::size_t ClassSize(std::size_t index) noexcept;
+
+ private:
+  struct Central;
+
+  PoolResource();
+  ~PoolResource() override;
+
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+  void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override;
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+  friend struct PoolThreadCache;
+  /// Move up to count blocks of a class from the central list (or a new slab) into head
+  std::size_t Refill(std::size_t index, void*& head, std::size_t count);
+  /// Hand a chain of blocks back to the central list
+  void Return(std::size_t index, void* head, void* tail, std::size_t count);
+
+  std::pmr::memory_resource* const m_upstream;
+  std::unique_ptr<Central[]> m_central;
+};
+
+/**
+ * @brief Deleter for objects allocated by MakePooled()
+ */
+template <typename T>
+struct PooledDeleter {
+  void operator()(T* object) const noexcept {
+    object->~T();
+    PoolResource::Instance().deallocate(object, sizeof(T), alignof(T));
+  }
+};
+
+template <typename T>
+using PooledPtr = std::unique_ptr<T, PooledDeleter<T>>;
+
+/**
+ * @brief Construct a T in the pool, like std::make_unique
+ */
+template <typename T, typename... Args>
+PooledPtr<T> MakePooled(Args&&... args) {
+  void* memory = PoolResource::Instance().allocate(sizeof(T), alignof(T));
+  try {
+    return PooledPtr<T>(new (memory) T(std::forward<Args>(args)...));
+  } catch (...) {
+    PoolResource::Instance().deallocate(memory, sizeof(T), alignof(T));
+    throw;
+  }
+}
+
+}  // namespace comm
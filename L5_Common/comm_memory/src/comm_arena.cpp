@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_arena.cpp
+ * @brief Monotonic arena: bump allocation over a buffer and growing chunks
+ */
+
+#include "comm_arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace comm {
+
+namespace {
+
+constexpr std::size_t kFirstChunkSize = 1024;
+constexpr std::size_t kMaxChunkSize = 1024 * 1024;
+
+}  // namespace
+
+/**
+ * @brief Header at the start of every chunk taken from upstream
+ */
+struct alignas(std::max_align_t) Arena::Chunk {
+  Chunk* next;
+  std::size_t size;  ///< Including this header
+
+  std::byte* Begin() { return reinterpret_cast<std::byte*>(this + 1); }
+  std::byte* End() { return reinterpret_cast<std::byte*>(this) + size; }
+};
+
+Arena::Arena(std::pmr::memory_resource* upstream) noexcept : Arena(nullptr, 0, upstream) {}
+
+Arena::Arena(void* buffer, std::size_t size, std::pmr::memory_resource* upstream) noexcept
+    : m_upstream(upstream),
+      m_buffer(static_cast<std::byte*>(buffer)),
+      m_buffer_size(size),
+      m_current(m_buffer),
+      m_end(m_buffer + size),
+      m_next_chunk_size(std::clamp(size * 2, kFirstChunkSize, kMaxChunkSize)) {}
+
+Arena::~Arena() { Release(); }
+
+void* Arena::TryBump(std::size_t bytes, std::size_t alignment) noexcept {
+  if (m_current == nullptr) {
+    return nullptr;
+  }
+  const auto address = reinterpret_cast<std::uintptr_t>(m_current);
+  const std::uintptr_t aligned = (address + alignment - 1) & ~(std::uintptr_t{alignment} - 1);
+  const auto available = static_cast<std::uintptr_t>(m_end - m_current);
+  if (aligned - address > available || bytes > available - (aligned - address)) {
+    return nullptr;
+  }
+  m_current = reinterpret_cast<std::byte*>(aligned + bytes);
+  m_used += bytes;
+  return reinterpret_cast<void*>(aligned);
+}
+
+void* Arena::do_allocate(std::size_t bytes, std::size_t alignment) {
+  if (void* memory = TryBump(bytes, alignment)) {
+    return memory;
+  }
+  const std::size_t needed = sizeof(Chunk) + bytes + alignment;
+  Chunk* chunk = nullptr;
+  if (m_spare != nullptr && m_spare->size >= needed) {
+    chunk = m_spare;
+    m_spare = nullptr;
+  } else {
+    const std::size_t size = std::max(m_next_chunk_size, needed);
+    chunk = static_cast<Chunk*>(m_upstream->allocate(size, alignof(Chunk)));
+    chunk->size = size;
+    m_next_chunk_size = std::min(m_next_chunk_size * 2, kMaxChunkSize);
+  }
+  chunk->next = m_chunks;
+  m_chunks = chunk;
+  m_current = chunk->Begin();
+  m_end = chunk->End();
+  return TryBump(bytes, alignment);
+}
+
+void Arena::do_deallocate(void*, std::size_t, std::size_t) {
+  // Monotonic: memory comes back with Reset() or Release()
+}
+
+bool Arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+  return this == &other;
+}
+
+void Arena::FreeChunks(Chunk* keep) noexcept {
+  for (Chunk* chunk = m_chunks; chunk != nullptr;) {
+    Chunk* next = chunk->next;
+    if (chunk != keep) {
+      m_upstream->deallocate(chunk, chunk->size, alignof(Chunk));
+    }
+    chunk = next;
+  }
+  m_chunks = nullptr;
+  m_current = m_buffer;
+  m_end = m_buffer + m_buffer_size;
+  m_used = 0;
+}
+
+void Arena::Reset() noexcept {
+  Chunk* largest = m_spare;
+  for (Chunk* chunk = m_chunks; chunk != nullptr; chunk = chunk->next) {
+    if (largest == nullptr || chunk->size > largest->size) {
+      largest = chunk;
+    }
+  }
+  if (m_spare != nullptr && m_spare != largest) {
+    m_upstream->deallocate(m_spare, m_spare->size, alignof(Chunk));
+  }
+  FreeChunks(largest);
+  m_spare = largest;
+}
+
+void Arena::Release() noexcept {
+  FreeChunks(nullptr);
+  if (m_spare != nullptr) {
+    m_upstream->deallocate(m_spare, m_spare->size, alignof(Chunk));
+    m_spare = nullptr;
+  }
+}
+
+std::size_t Arena::ChunkCount() const noexcept {
+  std::size_t count = m_spare != nullptr ? 1 : 0;
+  for (const Chunk* chunk = m_chunks; chunk != nullptr; chunk = chunk->next) {
+    ++count;
+  }
+  return count;
+}
+
+}  // namespace comm
@@ -0,0 +1,231 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_pool.cpp
+ * @brief Size classes, central free lists and thread-local caches
+ */
+
+#include "comm_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <mutex>
+
+namespace comm {
+
+namespace {
+
+/// 16, 32, 48, 64, then two classes per power of two up to 4096
+constexpr std::size_t kClassCount = 16;
+
+/// Alignment of every block (slabs are cache-line aligned, sizes are multiples of 16)
+constexpr std::size_t kBlockAlignment = alignof(std::max_align_t);
+
+constexpr std::size_t kSlabSize = 64 * 1024;
+
+/// Per-thread blocks of a class before half of them go back to the central list
+std::size_t CacheLimit(std::size_t index) {
+  return std::clamp<std::size_t>(32 * 1024 / PoolResource::ClassSize(index), 4, 64);
+}
+
+void*& Next(void* block) { return *static_cast<void**>(block); }
+
+std::atomic<std::size_t> g_slab_bytes{0};
+std::atomic<std::uint64_t> g_oversize_allocations{0};
+
+}  // namespace
+
+struct PoolResource::Central {
+  std::mutex mutex;
+  void* head{nullptr};
+  std::size_t count{0};
+  /// Unused tail of the newest slab
+  std::byte* slab_current{nullptr};
+  std::byte* slab_end{nullptr};
+};
+
+/**
+ * @brief Free lists of the calling thread, returned to the pool at thread exit
+ */
+struct PoolThreadCache {
+  struct List {
+    void* head{nullptr};
+    std::size_t count{0};
+  };
+  std::array<List, kClassCount> lists;
+
+  ~PoolThreadCache();
+};
+
+namespace {
+
+thread_local PoolThreadCache t_cache;
+/// Set once t_cache is gone; later frees on this thread bypass the cache
+thread_local bool t_cache_destroyed = false;
+
+}  // namespace
+
+PoolThreadCache::~PoolThreadCache() {
+  t_cache_destroyed = true;
+  for (std::size_t index = 0; index < kClassCount; ++index) {
+    List& list = lists[index];
+    if (list.count == 0) {
+      continue;
+    }
+    void* tail = list.head;
+    while (Next(tail) != nullptr) {
+      tail = Next(tail);
+    }
+    PoolResource::Instance().Return(index, list.head, tail, list.count);
+    list = {};
+  }
+}
+
+PoolResource& PoolResource::Instance() {
+  static PoolResource* const instance = new PoolResource();
+  return *instance;
+}
+
+PoolResource::PoolResource()
+    : m_upstream(std::pmr::new_delete_resource()), m_central(new Central[kClassCount]) {}
+
+PoolResource::~PoolResource() = default;
+
+std::size_t PoolResource::ClassIndex(std::size_t bytes) noexcept {
+  if (bytes <= 64) {
+    return (std::max<std::size_t>(bytes, 1) + 15) / 16 - 1;
+  }
+  // 2^(p-1) < bytes <= 2^p: class 1.5 * 2^(p-1) or 2^p
+  const auto power = static_cast<std::size_t>(std::bit_width(bytes - 1));
+  const std::size_t half = std::size_t{1} << (power - 1);
+  const std::size_t upper = 3 + 2 * (power - 6);
+  return bytes <= half + half / 2 ? upper - 1 : upper;
+}
+
+std::size_t PoolResource::ClassSize(std::size_t index) noexcept {
+  if (index < 4) {
+    return (index + 1) * 16;
+  }
+  // index 4 -> 96, 5 -> 128, 6 -> 192, 7 -> 256, ...
+  const std::size_t power = (index - 3 + 1) / 2 + 6;
+  const std::size_t size = std::size_t{1} << power;
+  return (index % 2 == 0) ? size / 4 * 3 : size;
+}
+
+void* PoolResource::do_allocate(std::size_t bytes, std::size_t alignment) {
+  if (bytes > kMaxBlockSize || alignment > kBlockAlignment) {
+    g_oversize_allocations.fetch_add(1, std::memory_order_relaxed);
+    return m_upstream->allocate(bytes, alignment);
+  }
+  const std::size_t index = ClassIndex(bytes);
+  if (t_cache_destroyed) {
+    void* block = nullptr;
+    Refill(index, block, 1);
+    return block;
+  }
+  PoolThreadCache::List& list = t_cache.lists[index];
+  if (list.head == nullptr) {
+    list.count = Refill(index, list.head, CacheLimit(index) / 2);
+  }
+  void* block = list.head;
+  list.head = Next(block);
+  --list.count;
+  return block;
+}
+
+void PoolResource::do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) {
+  if (bytes > kMaxBlockSize || alignment > kBlockAlignment) {
+    m_upstream->deallocate(ptr, bytes, alignment);
+    return;
+  }
+  const std::size_t index = ClassIndex(bytes);
+  if (t_cache_destroyed) {
+    Next(ptr) = nullptr;
+    Return(index, ptr, ptr, 1);
+    return;
+  }
+  PoolThreadCache::List& list = t_cache.lists[index];
+  Next(ptr) = list.head;
+  list.head = ptr;
+  if (++list.count <= CacheLimit(index)) {
+    return;
+  }
+  // Keep the most recently freed (cache-warm) half, return the rest
+  const std::size_t keep = CacheLimit(index) / 2;
+  void* last_kept = list.head;
+  for (std::size_t kept = 1; kept < keep; ++kept) {
+    last_kept = Next(last_kept);
+  }
+  void* head = Next(last_kept);
+  void* tail = head;
+  while (Next(tail) != nullptr) {
+    tail = Next(tail);
+  }
+  Next(last_kept) = nullptr;
+  Return(index, head, tail, list.count - keep);
+  list.count = keep;
+}
+
+bool PoolResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+  return this == &other;
+}
+
+std::size_t PoolResource::Refill(std::size_t index, void*& head, std::size_t count) {
+  Central& central = m_central[index];
+  std::lock_guard<std::mutex> lock(central.mutex);
+  if (central.count > 0) {
+    const std::size_t taken = std::min(count, central.count);
+    void* tail = central.head;
+    for (std::size_t moved = 1; moved < taken; ++moved) {
+      tail = Next(tail);
+    }
+    head = central.head;
+    central.head = Next(tail);
+    Next(tail) = nullptr;
+    central.count -= taken;
+    return taken;
+  }
+
+  const std::size_t size = ClassSize(index);
+  if (central.slab_current == nullptr ||
+      static_cast<std::size_t>(central.slab_end - central.slab_current) < size) {
+    // Slabs are never returned: blocks of a class may live anywhere in them
+    central.slab_current = static_cast<std::byte*>(m_upstream->allocate(kSlabSize, 64));
+    central.slab_end = central.slab_current + kSlabSize;
+    g_slab_bytes.fetch_add(kSlabSize, std::memory_order_relaxed);
+  }
+  const std::size_t available = static_cast<std::size_t>(central.slab_end - central.slab_current) / size;
+  const std::size_t carved = std::min(count, available);
+  head = nullptr;
+  for (std::size_t block = carved; block > 0; --block) {
+    void* next = central.slab_current + (block - 1) * size;
+    Next(next) = head;
+    head = next;
+  }
+  central.slab_current += carved * size;
+  return carved;
+}
+
+void PoolResource::Return(std::size_t index, void* head, void* tail, std::size_t count) {
+  Central& central = m_central[index];
+  std::lock_guard<std::mutex> lock(central.mutex);
+  Next(tail) = central.head;
+  central.head = head;
+  central.count += count;
+}
+
+PoolStats PoolResource::GetStats() const {
+  PoolStats stats;
+  stats.slab_bytes = g_slab_bytes.load(std::memory_order_relaxed);
+  stats.oversize_allocations = g_oversize_allocations.load(std::memory_order_relaxed);
+  for (std::size_t index = 0; index < kClassCount; ++index) {
+    std::lock_guard<std::mutex> lock(m_central[index].mutex);
+    stats.central_free_blocks += m_central[index].count;
+  }
+  return stats;
+}
+
+}  // namespace comm
@@ -0,0 +1,206 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_memory_test.cpp
+ * @brief Unit tests for Arena and PoolResource
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "comm_arena.h"
+#include "comm_pool.h"
+
+namespace comm {
+namespace {
+
+/// Upstream that counts what the arena takes and gives back
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  int allocations{0};
+  int deallocations{0};
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    ++allocations;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override {
+    ++deallocations;
+    std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+  }
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+bool IsAligned(const void* ptr, std::size_t alignment) {
+  return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+}
+
+TEST(ArenaTest, InlineBufferServesSmallAllocations) {
+  CountingResource upstream;
+  InlineArena<1024> arena(&upstream);
+
+  void* first = arena.allocate(100, 8);
+  void* second = arena.allocate(7, 1);
+  void* third = arena.allocate(64, 64);
+  EXPECT_TRUE(IsAligned(third, 64));
+  EXPECT_NE(first, second);
+  EXPECT_EQ(static_cast<std::byte*>(second), static_cast<std::byte*>(first) + 100);
+  EXPECT_EQ(upstream.allocations, 0);
+  EXPECT_EQ(arena.BytesUsed(), 171U);
+}
+
+TEST(ArenaTest, OverflowTakesGrowingChunks) {
+  CountingResource upstream;
+  {
+    InlineArena<256> arena(&upstream);
+    for (int index = 0; index < 100; ++index) {
+      EXPECT_TRUE(IsAligned(arena.allocate(100, 16), 16));
+    }
+    EXPECT_GT(upstream.allocations, 0);
+    EXPECT_LT(upstream.allocations, 10);  // chunks double
+    EXPECT_EQ(arena.ChunkCount(), static_cast<std::size_t>(upstream.allocations));
+
+    void* large = arena.allocate(100000, 8);  // larger than the next chunk
+    EXPECT_NE(large, nullptr);
+  }
+  EXPECT_EQ(upstream.deallocations, upstream.allocations);
+}
+
+TEST(ArenaTest, ResetKeepsLargestChunk) {
+  CountingResource upstream;
+  Arena arena(&upstream);
+  for (int index = 0; index < 50; ++index) {
+    EXPECT_NE(arena.allocate(200, 8), nullptr);
+  }
+  const int allocations = upstream.allocations;
+  arena.Reset();
+  EXPECT_EQ(arena.BytesUsed(), 0U);
+  EXPECT_EQ(arena.ChunkCount(), 1U);
+  EXPECT_EQ(upstream.deallocations, allocations - 1);
+
+  // The same job fits into the kept chunk
+  EXPECT_NE(arena.allocate(2000, 8), nullptr);
+  EXPECT_EQ(upstream.allocations, allocations);
+
+  arena.Release();
+  EXPECT_EQ(arena.ChunkCount(), 0U);
+  EXPECT_EQ(upstream.deallocations, upstream.allocations);
+}
+
+TEST(ArenaTest, WorksAsPmrResource) {
+  InlineArena<4096> arena;
+  std::pmr::vector<std::pmr::string> words(&arena);
+  for (int index = 0; index < 100; ++index) {
+    words.emplace_back("a string long enough to skip the small string buffer " +
+                       std::to_string(index));
+  }
+  EXPECT_EQ(words.back().get_allocator().resource(), &arena);
+  EXPECT_EQ(words[42], "a string long enough to skip the small string buffer 42");
+
+  int called = 0;
+  std::pmr::vector<std::function<void()>> listeners(&arena);
+  listeners.assign(3, [&called] { ++called; });
+  for (const auto& listener : listeners) {
+    listener();
+  }
+  EXPECT_EQ(called, 3);
+}
+
+TEST(PoolTest, SizeClassesCoverAllSmallSizes) {
+  std::size_t previous = 0;
+  for (std::size_t bytes = 1; bytes <= PoolResource::kMaxBlockSize; ++bytes) {
+    const std::size_t index = PoolResource::ClassIndex(bytes);
+    ASSERT_LT(index, 16U);
+    const std::size_t size = PoolResource::ClassSize(index);
+    ASSERT_GE(size, bytes);
+    ASSERT_EQ(size % 16, 0U);
+    ASSERT_GE(size, previous);  // monotonic
+    if (index > 0) {
+      ASSERT_LT(PoolResource::ClassSize(index - 1), bytes);  // smallest fitting class
+    }
+    previous = size;
+  }
+  EXPECT_EQ(PoolResource::ClassSize(15), PoolResource::kMaxBlockSize);
+}
+
+TEST(PoolTest, FreedBlocksAreReused) {
+  PoolResource& pool = PoolResource::Instance();
+  void* block = pool.allocate(40, 8);
+  EXPECT_TRUE(IsAligned(block, alignof(std::max_align_t)));
+  pool.deallocate(block, 40, 8);
+  EXPECT_EQ(pool.allocate(48, 16), block);  // same class, thread cache is LIFO
+  pool.deallocate(block, 48, 16);
+}
+
+TEST(PoolTest, OversizeRequestsGoUpstream) {
+  PoolResource& pool = PoolResource::Instance();
+  const std::uint64_t before = pool.GetStats().oversize_allocations;
+  void* large = pool.allocate(PoolResource::kMaxBlockSize + 1, 8);
+  void* aligned = pool.allocate(64, 64);
+  EXPECT_TRUE(IsAligned(aligned, 64));
+  pool.deallocate(large, PoolResource::kMaxBlockSize + 1, 8);
+  pool.deallocate(aligned, 64, 64);
+  EXPECT_EQ(pool.GetStats().oversize_allocations, before + 2);
+}
+
+TEST(PoolTest, BlocksMoveBetweenThreads) {
+  constexpr int kBlocks = 1000;
+  PoolResource& pool = PoolResource::Instance();
+
+  // Allocated on one thread, freed on another, then reused by a third
+  std::vector<void*> blocks;
+  std::thread([&] {
+    for (int index = 0; index < kBlocks; ++index) {
+      blocks.push_back(pool.allocate(200, 8));
+    }
+  }).join();
+  EXPECT_EQ(std::set<void*>(blocks.begin(), blocks.end()).size(), blocks.size());
+  std::thread([&] {
+    for (void* block : blocks) {
+      pool.deallocate(block, 200, 8);
+    }
+  }).join();
+  // The freeing thread exited: its cached blocks are back in the central list
+  EXPECT_GE(pool.GetStats().central_free_blocks, static_cast<std::size_t>(kBlocks));
+
+  const std::size_t slab_bytes = pool.GetStats().slab_bytes;
+  std::thread([&] {
+    std::vector<void*> reused;
+    for (int index = 0; index < kBlocks; ++index) {
+      reused.push_back(pool.allocate(200, 8));
+    }
+    for (void* block : reused) {
+      pool.deallocate(block, 200, 8);
+    }
+  }).join();
+  EXPECT_EQ(pool.GetStats().slab_bytes, slab_bytes);  // no new slabs
+}
+
+TEST(PoolTest, MakePooledConstructsAndDestroys) {
+  struct Session {
+    explicit Session(int& live) : m_live(live) { ++m_live; }
+    ~Session() { --m_live; }
+    int& m_live;
+    char payload[100]{};
+  };
+  int live = 0;
+  {
+    auto session = MakePooled<Session>(live);
+    EXPECT_EQ(live, 1);
+  }
+  EXPECT_EQ(live, 0);
+}
+
+}  // namespace
+}  // namespace comm
@@ -0,0 +1,131 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_metrics_benchmark.cpp
+ * @brief Cost of recording metrics on hot paths and of rendering a scrape
+ * @details BM_CounterAdd and BM_HistogramObserve update one shared metric
+ *          from 1-8 threads (the per-event cost an instrumented path pays).
+ *          BM_Render formats a registry holding a few hundred series, as a
+ *          Prometheus scrape does. BM_LatencyRecord records into a shared
+ *          LatencyRecorder from 1-8 threads (compare with
+ *          BM_HistogramObserve), BM_HdrRecord into a plain HdrHistogram;
+ *          BM_TakeInterval and BM_HdrEncode are the cost of reading an
+ *          interval and of its binary export.
+ *
+ * Usage: modu-core-comm_metrics_benchmark [--benchmark_filter=...]
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <string>
+
+#include "comm_hdr_histogram.h"
+#include "comm_metrics.h"
+
+namespace {
+
+void BM_CounterAdd(benchmark::State& state) {
+  static comm::Counter& counter =
+      comm::MetricsRegistry::Instance().GetCounter("bench_events_total", "Events");
+  for (auto _ : state) {
+    counter.Add();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_HistogramObserve(benchmark::State& state) {
+  static comm::Histogram& histogram =
+      comm::MetricsRegistry::Instance().GetHistogram("bench_latency_seconds", "Latency");
+  double value = 0;
+  for (auto _ : state) {
+    value = value < 1 ? value + 0.001 : 0;
+    histogram.Observe(value);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_Render(benchmark::State& state) {
+  auto& registry = comm::MetricsRegistry::Instance();
+  for (int series = 0; series < 100; ++series) {
+    const std::string shard = std::to_string(series);
+    registry.GetCounter("bench_requests_total", "Requests", {{"shard", shard}}).Add(series);
+    registry.GetGauge("bench_queue_depth", "Queue depth", {{"shard", shard}}).Set(series);
+    registry.GetHistogram("bench_request_seconds", "Request time",
+                          comm::Histogram::DurationBounds(), {{"shard", shard}})
+        .Observe(0.001 * series);
+  }
+  std::size_t bytes = 0;
+  for (auto _ : state) {
+    const std::string text = registry.Render();
+    bytes = text.size();
+    benchmark::DoNotOptimize(text.data());
+  }
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * bytes));
+}
+
+/// Latency-like values: mostly 20-80 us with a tail to 50 ms
+std::int64_t NextLatency(std::uint64_t& state) {
+  state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+  const std::uint64_t random = state >> 33;
+  return random % 1000 == 0 ? static_cast<std::int64_t>(random % 50'000'000)
+                            : static_cast<std::int64_t>(20'000 + random % 60'000);
+}
+
+void BM_LatencyRecord(benchmark::State& state) {
+  static comm::LatencyRecorder recorder;
+  std::uint64_t random = static_cast<std::uint64_t>(state.thread_index()) + 1;
+  for (auto _ : state) {
+    recorder.Record(NextLatency(random));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_HdrRecord(benchmark::State& state) {
+  comm::HdrHistogram histogram;
+  std::uint64_t random = 1;
+  for (auto _ : state) {
+    histogram.Record(NextLatency(random));
+  }
+  benchmark::DoNotOptimize(histogram.TotalCount());
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_TakeInterval(benchmark::State& state) {
+  comm::LatencyRecorder recorder;
+  std::uint64_t random = 1;
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (int value = 0; value < 10000; ++value) {
+      recorder.Record(NextLatency(random));
+    }
+    state.ResumeTiming();
+    benchmark::DoNotOptimize(recorder.TakeInterval().Summarize());
+  }
+}
+
+void BM_HdrEncode(benchmark::State& state) {
+  comm::HdrHistogram histogram;
+  std::uint64_t random = 1;
+  for (int value = 0; value < 100000; ++value) {
+    histogram.Record(NextLatency(random));
+  }
+  std::size_t bytes = 0;
+  for (auto _ : state) {
+    const std::string encoded = histogram.Encode();
+    bytes = encoded.size();
+    benchmark::DoNotOptimize(encoded.data());
+  }
+  state.counters["encoded_bytes"] = static_cast<double>(bytes);
+}
+
+}  // namespace
+
+BENCHMARK(BM_CounterAdd)->ThreadRange(1, 8);
+BENCHMARK(BM_HistogramObserve)->ThreadRange(1, 8);
+BENCHMARK(BM_Render);
+BENCHMARK(BM_LatencyRecord)->ThreadRange(1, 8);
+BENCHMARK(BM_HdrRecord);
+BENCHMARK(BM_TakeInterval);
+BENCHMARK(BM_HdrEncode);
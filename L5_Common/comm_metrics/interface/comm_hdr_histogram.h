@@ -0,0 +1,270 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_hdr_histogram.h
+ * @brief HDR latency histograms: percentiles with a fixed relative error
+ * @details Histogram (comm_metrics.h) counts values into a few fixed buckets,
+ *          enough for Prometheus to estimate a latency SLO, but it cannot
+ *          tell a p999 of 12 ms from one of 40 ms. HdrHistogram follows the
+ *          HdrHistogram layout: values are bucketed by powers of two, and
+ *          each power of two is split linearly into enough sub-buckets to
+ *          keep `significant_digits` decimal digits. With 3 digits every
+ *          percentile is exact to 0.1% from 1 ns to an hour, in a few
+ *          hundred KiB.
+ *
+ *          LatencyRecorder records from any number of threads: each thread
+ *          counts into its own array (the comm_counter shard it was
+ *          assigned), allocated on its first value, so recording is one
+ *          relaxed increment with no lock and no shared cache line.
+ *          TakeInterval() folds the arrays into the counts recorded since
+ *          its previous call; LastInterval() does so once per period and
+ *          summarizes the result as p50/p90/p99/p999/max.
+ *
+ * @code
+ * comm::LatencyRecorder m_latency;  // nanoseconds, up to an hour, 3 digits
+ * m_latency.Publish("modu_router_latency_seconds", "Routing latency");
+ *
+ * // Hot path, any thread
+ * m_latency.RecordDuration(FastClock::now() - start);
+ *
+ * // Reporting
+ * comm::LatencySnapshot last = m_latency.LastInterval();
+ * LOG(INFO) << "p99 " << last.p99 << " ns, max " << last.max << " ns";
+ * @endcode
+ */
+
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "comm_counter.h"
+
+namespace comm {
+
+namespace detail {
+
+/**
+ * @brief Value-to-index mapping shared by HdrHistogram and LatencyRecorder
+ * @details Index 0 to sub_bucket_count - 1 counts values exactly; each
+ *          following half of sub_bucket_count covers the next power of two
+ *          with twice the width per sub-bucket.
+ */
+struct HdrLayout {
+  HdrLayout(std::int64_t highest_trackable, int significant_digits);
+
+  std::size_t Index(std::int64_t value) const noexcept {
+    const auto clamped = static_cast<std::uint64_t>(
+        value < 0 ? 0 : (value > highest_trackable ? highest_trackable : value));
+    const int bucket = static_cast<int>(std::bit_width(clamped | sub_bucket_mask)) -
+                       sub_bucket_half_magnitude - 1;
+    const auto sub_bucket = static_cast<std::size_t>(clamped >> bucket);
+    return (static_cast<std::size_t>(bucket) << sub_bucket_half_magnitude) + sub_bucket;
+  }
+
+  /// Smallest value counted at index
+  std::int64_t LowestAt(std::size_t index) const noexcept;
+  /// Largest value counted at index
+  std::int64_t HighestAt(std::size_t index) const noexcept;
+
+  bool operator==(const HdrLayout& other) const noexcept {
+    return highest_trackable == other.highest_trackable &&
+           significant_digits == other.significant_digits;
+  }
+
+  std::int64_t highest_trackable;
+  int significant_digits;
+  int sub_bucket_half_magnitude;  ///< log2(sub_bucket_count) - 1
+  std::uint64_t sub_bucket_mask;  ///< sub_bucket_count - 1
+  std::size_t counts_length;
+};
+
+}  // namespace detail
+
+/**
+ * @brief Summary of the values recorded in one interval
+ * @note Percentiles are the highest value equivalent to the one at that
+ *       rank, i.e. never understated by more than the precision
+ */
+struct LatencySnapshot {
+  std::chrono::steady_clock::time_point start{};  ///< Set by LatencyRecorder::LastInterval()
+  std::chrono::steady_clock::time_point end{};
+  std::uint64_t count{0};
+  std::int64_t min{0};
+  std::int64_t p50{0};
+  std::int64_t p90{0};
+  std::int64_t p99{0};
+  std::int64_t p999{0};
+  std::int64_t max{0};
+  double mean{0};
+};
+
+/**
+ * @class HdrHistogram
+ * @brief Log-bucketed histogram of integer values (single-threaded value type)
+ * @details Values below 0 count as 0 and values above highest_trackable as
+ *          highest_trackable, so a stall is never dropped from the tail.
+ */
+class HdrHistogram {
+ public:
+  /// One hour in nanoseconds
+  static constexpr std::int64_t kDefaultHighestTrackable = 3'600'000'000'000;
+
+  /**
+   * @param highest_trackable Largest value told apart from larger ones (>= 2)
+   * @param significant_digits Decimal digits kept for every value, 1-5
+   * @throws std::system_error with MetricsError::InvalidPrecision
+   */
+  explicit HdrHistogram(std::int64_t highest_trackable = kDefaultHighestTrackable,
+                        int significant_digits = 3);
+
+  void Record(std::int64_t value, std::uint64_t count = 1) noexcept {
+    m_counts[m_layout.Index(value)] += count;
+    m_total += count;
+  }
+
+  void RecordDuration(std::chrono::nanoseconds duration) noexcept { Record(duration.count()); }
+
+  /**
+   * @brief Add the counts of another histogram, e.g. one per thread or host
+   * @note With another range or precision, each of its values is re-recorded
+   *       at the highest value of its bucket
+   */
+  void Add(const HdrHistogram& other);
+
+  void Reset() noexcept;
+
+  std::uint64_t TotalCount() const noexcept { return m_total; }
+  /// Lowest value of the first non-empty bucket, 0 if empty
+  std::int64_t Min() const noexcept;
+  /// Highest value of the last non-empty bucket, 0 if empty
+  std::int64_t Max() const noexcept;
+  double Mean() const noexcept;
+
+  /**
+   * @brief Value at or below which percentile % of the values fall
+   * @param percentile 0-100; 0 gives Min(), 100 gives Max(), empty gives 0
+   */
+  std::int64_t ValueAtPercentile(double percentile) const noexcept;
+
+  /// Count, min, p50, p90, p99, p999, max and mean (start and end are left empty)
+  LatencySnapshot Summarize() const;
+
+  std::int64_t HighestTrackable() const noexcept { return m_layout.highest_trackable; }
+  int SignificantDigits() const noexcept { return m_layout.significant_digits; }
+
+  /**
+   * @brief Compact binary form for shipping or storing intervals
+   * @details A magic tag, the precision, the range, and the counts up to the
+   *          last non-zero one as zig-zag LEB128 varints, where a negative
+   *          entry stands for a run of empty buckets. A typical latency
+   *          interval takes a few hundred bytes.
+   */
+  std::string Encode() const;
+
+  /**
+   * @brief Rebuild a histogram from Encode() output
+   * @return Empty error_code or MetricsError::InvalidEncoding (out unchanged)
+   */
+  static std::error_code Decode(std::string_view data, HdrHistogram& out);
+
+ private:
+  friend class LatencyRecorder;
+
+  detail::HdrLayout m_layout;
+  std::vector<std::uint64_t> m_counts;
+  std::uint64_t m_total{0};
+};
+
+/**
+ * @class LatencyRecorder
+ * @brief HdrHistogram recorded from many threads, read in intervals
+ */
+class LatencyRecorder {
+ public:
+  /**
+   * @param interval Length of the intervals LastInterval() reports
+   * @throws std::system_error with MetricsError::InvalidPrecision
+   */
+  explicit LatencyRecorder(
+      std::int64_t highest_trackable = HdrHistogram::kDefaultHighestTrackable,
+      int significant_digits = 3,
+      std::chrono::steady_clock::duration interval = std::chrono::seconds(10));
+  ~LatencyRecorder();
+
+  LatencyRecorder(const LatencyRecorder&) = delete;
+  LatencyRecorder& operator=(const LatencyRecorder&) = delete;
+
+  /**
+   * @brief Count one value; callable from any thread
+   * @note Wait-free once the calling thread's shard exists (one relaxed
+   *       increment); the first value of a shard allocates its counts
+   */
+  void Record(std::int64_t value) noexcept {
+    const std::size_t slot = detail::CounterSlot() & m_mask;
+    std::atomic<std::uint64_t>* counts = m_shards[slot].load(std::memory_order_acquire);
+    if (counts == nullptr) {
+      counts = AddShard(slot);
+    }
+    counts[m_layout.Index(value)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void RecordDuration(std::chrono::nanoseconds duration) noexcept { Record(duration.count()); }
+
+  /// Everything recorded so far, merged over all threads
+  HdrHistogram Cumulative() const;
+
+  /**
+   * @brief Values recorded since the previous TakeInterval() or LastInterval() roll
+   * @note A value recorded concurrently lands in this interval or the next
+   */
+  HdrHistogram TakeInterval();
+
+  /**
+   * @brief Summary of the last completed interval
+   * @details Closes the current interval first if it is at least `interval`
+   *          old, so a reader polling more often than that gets the same
+   *          summary back, and one polling less often gets a longer interval
+   *          (see start and end). Empty until the first interval completes.
+   */
+  LatencySnapshot LastInterval();
+
+  /**
+   * @brief Export LastInterval() to the MetricsRegistry
+   * @details Registers gauge callbacks name{quantile="0.5"|"0.9"|"0.99"|"0.999"|"1"}
+   *          (1 is the max), each value multiplied by scale; the default
+   *          turns nanoseconds into seconds.
+   * @note The registry calls back into this object: publish only recorders
+   *       that live until the process exits
+   */
+  void Publish(std::string_view name, std::string_view help, double scale = 1e-9);
+
+ private:
+  std::atomic<std::uint64_t>* AddShard(std::size_t slot) noexcept;
+  HdrHistogram TakeIntervalLocked();
+  /// LastInterval() without closing the current interval
+  LatencySnapshot LastClosed();
+
+  const detail::HdrLayout m_layout;
+  const std::size_t m_mask;
+  /// Counts per shard, allocated on first use and kept until destruction
+  std::unique_ptr<std::atomic<std::atomic<std::uint64_t>*>[]> m_shards;
+
+  std::mutex m_mutex;         ///< Guards the interval state below
+  HdrHistogram m_previous;    ///< Cumulative counts at the last TakeInterval()
+  const std::chrono::steady_clock::duration m_interval;
+  std::chrono::steady_clock::time_point m_interval_start;
+  LatencySnapshot m_last;
+};
+
+}  // namespace comm
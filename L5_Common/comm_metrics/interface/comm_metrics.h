@@ -0,0 +1,277 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_metrics.h
+ * @brief Process-wide metrics: counters, gauges and histograms by name and labels
+ * @details Metrics are registered once (under the registry's mutex) and then
+ *          updated through the returned reference without any lock: counters
+ *          are ShardedCounters, gauges and histogram buckets are relaxed
+ *          atomics. MetricsRegistry::Render() writes all of them in the
+ *          Prometheus text exposition format; MetricsServer serves it over
+ *          HTTP (comm_metrics_server.h).
+ *
+ *          A metric is identified by its family name and its label set.
+ *          Names follow Prometheus conventions: `modu_<module>_<what>` with
+ *          a `_total` suffix for counters and a unit suffix (`_seconds`,
+ *          `_bytes`) where there is one.
+ *
+ * @code
+ * // Once, e.g. as a member or a function-local static
+ * comm::Counter& m_requests = comm::MetricsRegistry::Instance().GetCounter(
+ *     "modu_http_requests_total", "HTTP requests handled", {{"route", "/health"}});
+ * comm::Histogram& m_latency = comm::MetricsRegistry::Instance().GetHistogram(
+ *     "modu_http_request_duration_seconds", "HTTP request latency");
+ *
+ * // Hot path
+ * m_requests.Add();
+ * m_latency.ObserveDuration(FastClock::now() - start);
+ * @endcode
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "comm_counter.h"
+#include "comm_flat_map.h"
+#include "comm_symbol.h"
+
+namespace comm {
+
+/**
+ * @brief Error codes for Metrics module operations
+ */
+enum class MetricsError {
+  Success = 0,           ///< Operation completed successfully
+  InvalidName = 1,       ///< Metric or label name is not a valid Prometheus name
+  InvalidBuckets = 2,    ///< Histogram bounds are not ascending
+  Conflict = 3,          ///< Name already registered with another type or buckets
+  AlreadyRunning = 4,    ///< MetricsServer::Start() called twice
+  InvalidAddress = 5,    ///< [metrics] address is not an IPv4 address
+  InvalidPrecision = 6,  ///< HdrHistogram digits not in 1-5 or range below 2
+  InvalidEncoding = 7,   ///< HdrHistogram::Decode() got truncated or foreign data
+};
+
+/**
+ * @brief Error category for Metrics module errors
+ */
+class MetricsErrorCategory : public std::error_category {
+ public:
+  const char* name() const noexcept override { return "comm_metrics"; }
+  std::string message(int error_value) const override;
+};
+
+/**
+ * @brief Get the singleton instance of MetricsErrorCategory
+ */
+const std::error_category& get_metrics_error_category() noexcept;
+
+/**
+ * @brief Helper function to create std::error_code from MetricsError
+ */
+inline std::error_code make_error_code(MetricsError err) noexcept {
+  return {static_cast<int>(err), get_metrics_error_category()};
+}
+
+enum class MetricType {
+  Counter,
+  Gauge,
+  Histogram,
+};
+
+/// Label names and values of one series, e.g. {{"signal", "SIGHUP"}}
+using MetricLabels = std::initializer_list<std::pair<std::string_view, std::string_view>>;
+
+/**
+ * @class Counter
+ * @brief Monotonic count (sharded: no shared cache line between threads)
+ */
+class Counter {
+ public:
+  Counter() = default;
+  Counter(const Counter&) = delete;
+  Counter& operator=(const Counter&) = delete;
+
+  void Add(std::uint64_t count = 1) noexcept { m_value.Add(count); }
+  std::uint64_t Value() const noexcept { return m_value.Value(); }
+
+ private:
+  ShardedCounter m_value;
+};
+
+/**
+ * @class Gauge
+ * @brief Value that is set or goes up and down
+ */
+class Gauge {
+ public:
+  Gauge() = default;
+  Gauge(const Gauge&) = delete;
+  Gauge& operator=(const Gauge&) = delete;
+
+  void Set(double value) noexcept { m_value.store(value, std::memory_order_relaxed); }
+  void Add(double delta = 1) noexcept { m_value.fetch_add(delta, std::memory_order_relaxed); }
+  void Subtract(double delta = 1) noexcept { Add(-delta); }
+  double Value() const noexcept { return m_value.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<double> m_value{0};
+};
+
+/**
+ * @brief Bucket counts of a Histogram at one point in time
+ */
+struct HistogramSnapshot {
+  std::vector<double> bounds;         ///< Upper bounds, ascending (+Inf implied)
+  std::vector<std::uint64_t> counts;  ///< Per bucket (not cumulative), bounds.size() + 1
+  std::uint64_t count{0};             ///< Sum of counts
+  double sum{0};                      ///< Sum of observed values
+};
+
+/**
+ * @class Histogram
+ * @brief Observations counted in fixed buckets
+ * @details Observe() finds the bucket by binary search and increments it
+ *          with one relaxed atomic add. A snapshot taken while threads
+ *          observe may see the sum and the counts of slightly different
+ *          moments.
+ */
+class Histogram {
+ public:
+  /// @param bounds Upper bounds, sorted ascending; +Inf is added implicitly
+  explicit Histogram(std::span<const double> bounds);
+  Histogram(const Histogram&) = delete;
+  Histogram& operator=(const Histogram&) = delete;
+
+  void Observe(double value) noexcept;
+
+  /// Observe a duration in seconds (the Prometheus base unit)
+  template <typename Rep, typename Period>
+  void ObserveDuration(std::chrono::duration<Rep, Period> duration) noexcept {
+    Observe(std::chrono::duration<double>(duration).count());
+  }
+
+  HistogramSnapshot Snapshot() const;
+
+  std::span<const double> Bounds() const noexcept { return m_bounds; }
+
+  /// count bounds start, start * factor, start * factor^2, ...
+  static std::vector<double> ExponentialBounds(double start, double factor, std::size_t count);
+
+  /// Default buckets for durations: 100 us to 10 s, about three per decade
+  static std::span<const double> DurationBounds() noexcept;
+
+ private:
+  std::vector<double> m_bounds;
+  std::unique_ptr<std::atomic<std::uint64_t>[]> m_counts;
+  std::atomic<double> m_sum{0};
+};
+
+/**
+ * @class MetricsRegistry
+ * @brief All metrics of the process, rendered for Prometheus
+ */
+class MetricsRegistry {
+ public:
+  /**
+   * @brief Returns the process-wide registry
+   * @note Never destroyed, so metric references stay valid during static
+   *       destruction
+   */
+  static MetricsRegistry& Instance();
+
+  MetricsRegistry(const MetricsRegistry&) = delete;
+  MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+  /**
+   * @brief The counter with this name and labels, registered if new
+   * @return Reference valid for the life of the process
+   * @throws std::system_error MetricsError::InvalidName or Conflict
+   */
+  Counter& GetCounter(std::string_view name, std::string_view help, MetricLabels labels = {});
+
+  /// @copydoc GetCounter
+  Gauge& GetGauge(std::string_view name, std::string_view help, MetricLabels labels = {});
+
+  /**
+   * @brief The histogram with this name and labels, registered if new
+   * @param bounds Bucket upper bounds; all series of a name share them
+   * @throws std::system_error MetricsError::InvalidName, InvalidBuckets or Conflict
+   */
+  Histogram& GetHistogram(std::string_view name, std::string_view help,
+                          std::span<const double> bounds = Histogram::DurationBounds(),
+                          MetricLabels labels = {});
+
+  /**
+   * @brief A counter or gauge whose value is read when rendered
+   * @details For values kept elsewhere (queue sizes, uptime); read() runs
+   *          under the registry's mutex and must not register metrics.
+   *          Registering the same name and labels again replaces read().
+   * @throws std::system_error MetricsError::InvalidName or Conflict
+   */
+  void AddCallback(std::string_view name, std::string_view help, MetricType type,
+                   MetricLabels labels, std::function<double()> read);
+
+  /**
+   * @brief All metrics in the Prometheus text format (version 0.0.4)
+   * @details Families in registration order, each with its HELP and TYPE
+   *          lines; histograms as cumulative _bucket series plus _sum and
+   *          _count
+   */
+  std::string Render() const;
+
+ private:
+  using SeriesValue = std::variant<std::unique_ptr<Counter>, std::unique_ptr<Gauge>,
+                                   std::unique_ptr<Histogram>, std::function<double()>>;
+
+  struct Series {
+    std::string labels;  ///< Rendered without braces: a="1",b="2"
+    SeriesValue value;
+  };
+
+  struct Family {
+    Symbol name;
+    std::string help;
+    MetricType type;
+    bool callback;
+    std::vector<double> bounds;  ///< Histograms only
+    std::vector<Series> series;
+    FlatMap<std::string, std::size_t> by_labels;
+  };
+
+  MetricsRegistry();
+  ~MetricsRegistry() = default;
+
+  /// Family of name, created if new (mutex held)
+  Family& FamilyOf(std::string_view name, std::string_view help, MetricType type,
+                   bool callback, std::span<const double> bounds);
+  /// Series of labels in family, nullptr if new (mutex held)
+  static Series* Find(Family& family, const std::string& labels);
+  static std::string RenderLabels(MetricLabels labels);
+
+  mutable std::mutex m_mutex;
+  std::vector<std::unique_ptr<Family>> m_families;  ///< Registration order
+  FlatMap<Symbol, Family*> m_by_name;
+};
+
+}  // namespace comm
+
+namespace std {
+template <>
+struct is_error_code_enum<comm::MetricsError> : true_type {};
+}  // namespace std
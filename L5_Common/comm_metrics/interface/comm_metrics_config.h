@@ -0,0 +1,40 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_metrics_config.h
+ * @brief [metrics] configuration section and its TOML serialization
+ */
+
+#pragma once
+
+#include <string>
+#include <toml.hpp>
+
+namespace comm {
+
+/**
+ * @brief Settings read from the [metrics] section of config.toml
+ *
+ * @code
+ * [metrics]
+ * enabled = true          # serve GET /metrics for Prometheus
+ * address = "127.0.0.1"   # IPv4 address to listen on, "0.0.0.0" for all
+ * port = 9464
+ * @endcode
+ *
+ * @note Applied once at startup; changes take effect after a restart
+ */
+struct MetricsConfig {
+  bool enabled = false;
+  std::string address = "127.0.0.1";
+  int port = 9464;
+
+  bool operator==(const MetricsConfig&) const = default;
+};
+
+// ADL-based serialization functions
+void to_toml(toml::value& dest, const MetricsConfig& value);
+void from_toml(const toml::value& src, MetricsConfig& value);
+
+}  // namespace comm
@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_metrics_server.h
+ * @brief HTTP endpoint serving MetricsRegistry::Render() to Prometheus
+ * @details A minimal HTTP/1.1 server: GET /metrics returns the registry in
+ *          the text exposition format, anything else 404, and every
+ *          connection is closed after one response. It runs as coroutines
+ *          on the default thread pool, waiting for the socket through the
+ *          comm_coro reactor, so it holds no thread of its own. Slow clients
+ *          are dropped after a timeout and connections beyond a small limit
+ *          are refused, so a scraper cannot tie up the process.
+ *
+ *          Other modules add GET endpoints with AddHandler(), which makes
+ *          the server the process's debug and control port as well
+ *          (e.g. /debug/trace).
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+namespace comm {
+
+struct MetricsConfig;
+class TaskScope;
+
+/**
+ * @class MetricsServer
+ * @brief Singleton exposition endpoint, started by comm::Main when enabled
+ */
+class MetricsServer {
+ public:
+  /// Concurrent connections served; more are closed right away
+  static constexpr int kMaxConnections = 16;
+
+  /// Builds a response body from the query string ("format=otlp", "" if none)
+  using Handler = std::function<std::string(std::string_view query)>;
+
+  /**
+   * @brief Returns the process-wide server
+   * @note Never destroyed: a server main() did not stop is left to process exit
+   */
+  static MetricsServer& Instance();
+
+  MetricsServer(const MetricsServer&) = delete;
+  MetricsServer& operator=(const MetricsServer&) = delete;
+
+  /**
+   * @brief Listen on config.address:config.port and start serving
+   * @return Empty error_code, MetricsError::AlreadyRunning or InvalidAddress,
+   *         or the system error of socket(), bind() or listen()
+   */
+  std::error_code Start(const MetricsConfig& config);
+
+  /**
+   * @brief Stop accepting, cancel open connections and wait for them
+   * @note Call before the reactor and the thread pools stop; no-op if not running
+   */
+  void Stop();
+
+  /// Port bound by Start() (useful with port 0), 0 if not running
+  std::uint16_t Port() const noexcept { return m_port.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Serve GET path with handler, replacing any handler for it
+   * @param path Absolute path without query, e.g. "/debug/trace"
+   * @note The handler runs on a pool thread while a connection is served;
+   *       it must not block for long. May be called before or after Start().
+   */
+  void AddHandler(std::string path, std::string content_type, Handler handler);
+
+  /// Remove the handler of path; no-op if there is none
+  void RemoveHandler(std::string_view path);
+
+  /// Full HTTP response to a request head ("GET /metrics HTTP/1.1\r\n...")
+  std::string HandleRequest(std::string_view head) const;
+
+ private:
+  struct Endpoint {
+    std::string content_type;
+    Handler handler;
+  };
+
+  MetricsServer();
+  ~MetricsServer();
+
+  std::mutex m_mutex;  ///< Serializes Start() and Stop()
+  int m_listen_fd{-1};
+  std::atomic<std::uint16_t> m_port{0};
+  std::atomic<int> m_connections{0};
+  std::unique_ptr<TaskScope> m_scope;  ///< Accept loop and connections
+
+  mutable std::mutex m_handlers_mutex;
+  std::map<std::string, Endpoint, std::less<>> m_handlers;
+};
+
+}  // namespace comm
@@ -0,0 +1,357 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_hdr_histogram.cpp
+ * @brief HdrHistogram layout, percentiles and encoding; LatencyRecorder intervals
+ */
+
+#include "comm_hdr_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "comm_metrics.h"
+
+namespace comm {
+
+namespace {
+
+constexpr std::string_view kEncodingMagic = "mHD1";
+
+void AppendVarint(std::string& out, std::uint64_t value) {
+  while (value >= 0x80) {
+    out += static_cast<char>((value & 0x7F) | 0x80);
+    value >>= 7;
+  }
+  out += static_cast<char>(value);
+}
+
+void AppendZigZag(std::string& out, std::int64_t value) {
+  AppendVarint(out, (static_cast<std::uint64_t>(value) << 1) ^
+                        static_cast<std::uint64_t>(value >> 63));
+}
+
+bool ReadVarint(std::string_view& in, std::uint64_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (in.empty()) {
+      return false;
+    }
+    const auto byte = static_cast<std::uint8_t>(in.front());
+    in.remove_prefix(1);
+    value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ReadZigZag(std::string_view& in, std::int64_t& value) {
+  std::uint64_t raw = 0;
+  if (!ReadVarint(in, raw)) {
+    return false;
+  }
+  value = static_cast<std::int64_t>(raw >> 1) ^ -static_cast<std::int64_t>(raw & 1);
+  return true;
+}
+
+}  // namespace
+
+namespace detail {
+
+HdrLayout::HdrLayout(std::int64_t highest, int digits)
+    : highest_trackable(highest), significant_digits(digits) {
+  if (digits < 1 || digits > 5 || highest < 2) {
+    throw std::system_error(make_error_code(MetricsError::InvalidPrecision));
+  }
+  // Sub-buckets needed for `digits` decimal digits in the upper half of a bucket
+  const auto largest_single_unit = static_cast<std::uint64_t>(2 * std::pow(10, digits));
+  const int sub_bucket_magnitude = static_cast<int>(std::bit_width(largest_single_unit - 1));
+  sub_bucket_half_magnitude = sub_bucket_magnitude - 1;
+  sub_bucket_mask = (std::uint64_t{1} << sub_bucket_magnitude) - 1;
+
+  std::size_t buckets = 1;
+  std::uint64_t smallest_untrackable = sub_bucket_mask + 1;
+  while (smallest_untrackable <= static_cast<std::uint64_t>(highest)) {
+    ++buckets;
+    if (smallest_untrackable > std::numeric_limits<std::uint64_t>::max() / 2) {
+      break;
+    }
+    smallest_untrackable <<= 1;
+  }
+  counts_length = (buckets + 1) << sub_bucket_half_magnitude;
+}
+
+std::int64_t HdrLayout::LowestAt(std::size_t index) const noexcept {
+  const std::size_t half_count = std::size_t{1} << sub_bucket_half_magnitude;
+  std::size_t bucket = index >> sub_bucket_half_magnitude;
+  std::size_t sub_bucket = (index & (half_count - 1)) + half_count;
+  if (bucket == 0) {
+    sub_bucket -= half_count;  // Bucket 0 holds the exact lower half as well
+  } else {
+    --bucket;
+  }
+  return static_cast<std::int64_t>(sub_bucket << bucket);
+}
+
+std::int64_t HdrLayout::HighestAt(std::size_t index) const noexcept {
+  const std::size_t bucket = index >> sub_bucket_half_magnitude;
+  const std::size_t width = std::size_t{1} << (bucket == 0 ? 0 : bucket - 1);
+  return std::min(LowestAt(index) + static_cast<std::int64_t>(width) - 1, highest_trackable);
+}
+
+}  // namespace detail
+
+HdrHistogram::HdrHistogram(std::int64_t highest_trackable, int significant_digits)
+    : m_layout(highest_trackable, significant_digits), m_counts(m_layout.counts_length) {}
+
+void HdrHistogram::Add(const HdrHistogram& other) {
+  if (m_layout == other.m_layout) {
+    for (std::size_t index = 0; index < m_counts.size(); ++index) {
+      m_counts[index] += other.m_counts[index];
+    }
+    m_total += other.m_total;
+    return;
+  }
+  for (std::size_t index = 0; index < other.m_counts.size(); ++index) {
+    if (other.m_counts[index] != 0) {
+      Record(other.m_layout.HighestAt(index), other.m_counts[index]);
+    }
+  }
+}
+
+void HdrHistogram::Reset() noexcept {
+  std::fill(m_counts.begin(), m_counts.end(), 0);
+  m_total = 0;
+}
+
+std::int64_t HdrHistogram::Min() const noexcept {
+  const auto it = std::find_if(m_counts.begin(), m_counts.end(),
+                               [](std::uint64_t count) { return count != 0; });
+  return it == m_counts.end()
+             ? 0
+             : m_layout.LowestAt(static_cast<std::size_t>(it - m_counts.begin()));
+}
+
+std::int64_t HdrHistogram::Max() const noexcept {
+  const auto it = std::find_if(m_counts.rbegin(), m_counts.rend(),
+                               [](std::uint64_t count) { return count != 0; });
+  return it == m_counts.rend()
+             ? 0
+             : m_layout.HighestAt(static_cast<std::size_t>(m_counts.rend() - it - 1));
+}
+
+double HdrHistogram::Mean() const noexcept {
+  if (m_total == 0) {
+    return 0;
+  }
+  double sum = 0;
+  for (std::size_t index = 0; index < m_counts.size(); ++index) {
+    if (m_counts[index] != 0) {
+      // Middle of the bucket stands for each of its values
+      const double middle =
+          (static_cast<double>(m_layout.LowestAt(index)) + m_layout.HighestAt(index)) / 2;
+      sum += middle * static_cast<double>(m_counts[index]);
+    }
+  }
+  return sum / static_cast<double>(m_total);
+}
+
+std::int64_t HdrHistogram::ValueAtPercentile(double percentile) const noexcept {
+  if (m_total == 0) {
+    return 0;
+  }
+  if (percentile <= 0) {
+    return Min();
+  }
+  const double clamped = std::min(percentile, 100.0);
+  const auto rank = std::max<std::uint64_t>(
+      1, static_cast<std::uint64_t>(clamped / 100 * static_cast<double>(m_total) + 0.5));
+  std::uint64_t seen = 0;
+  for (std::size_t index = 0; index < m_counts.size(); ++index) {
+    seen += m_counts[index];
+    if (seen >= rank) {
+      return m_layout.HighestAt(index);
+    }
+  }
+  return Max();
+}
+
+LatencySnapshot HdrHistogram::Summarize() const {
+  LatencySnapshot summary;
+  summary.count = m_total;
+  summary.min = Min();
+  summary.p50 = ValueAtPercentile(50);
+  summary.p90 = ValueAtPercentile(90);
+  summary.p99 = ValueAtPercentile(99);
+  summary.p999 = ValueAtPercentile(99.9);
+  summary.max = Max();
+  summary.mean = Mean();
+  return summary;
+}
+
+std::string HdrHistogram::Encode() const {
+  std::string out(kEncodingMagic);
+  AppendVarint(out, static_cast<std::uint64_t>(m_layout.significant_digits));
+  AppendVarint(out, static_cast<std::uint64_t>(m_layout.highest_trackable));
+
+  std::int64_t zeros = 0;
+  for (const std::uint64_t count : m_counts) {
+    if (count == 0) {
+      ++zeros;
+      continue;
+    }
+    if (zeros != 0) {
+      AppendZigZag(out, -zeros);
+      zeros = 0;
+    }
+    AppendZigZag(out, static_cast<std::int64_t>(count));
+  }
+  return out;  // Trailing empty buckets are implied
+}
+
+std::error_code HdrHistogram::Decode(std::string_view data, HdrHistogram& out) {
+  const std::error_code invalid = make_error_code(MetricsError::InvalidEncoding);
+  if (data.substr(0, kEncodingMagic.size()) != kEncodingMagic) {
+    return invalid;
+  }
+  data.remove_prefix(kEncodingMagic.size());
+
+  std::uint64_t digits = 0;
+  std::uint64_t highest = 0;
+  constexpr auto kMaxHighest = static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max());
+  if (!ReadVarint(data, digits) || !ReadVarint(data, highest) || digits < 1 || digits > 5 ||
+      highest < 2 || highest > kMaxHighest) {
+    return invalid;
+  }
+  HdrHistogram result(static_cast<std::int64_t>(highest), static_cast<int>(digits));
+
+  std::size_t index = 0;
+  while (!data.empty()) {
+    std::int64_t entry = 0;
+    if (!ReadZigZag(data, entry)) {
+      return invalid;
+    }
+    if (entry < 0) {
+      const auto zeros = static_cast<std::uint64_t>(-(entry + 1)) + 1;
+      if (zeros > result.m_counts.size() - index) {
+        return invalid;
+      }
+      index += static_cast<std::size_t>(zeros);
+      continue;
+    }
+    if (index >= result.m_counts.size()) {
+      return invalid;
+    }
+    result.m_counts[index++] = static_cast<std::uint64_t>(entry);
+    result.m_total += static_cast<std::uint64_t>(entry);
+  }
+  out = std::move(result);
+  return {};
+}
+
+LatencyRecorder::LatencyRecorder(std::int64_t highest_trackable, int significant_digits,
+                                 std::chrono::steady_clock::duration interval)
+    : m_layout(highest_trackable, significant_digits),
+      m_mask(detail::CounterShardCount() - 1),
+      m_shards(std::make_unique<std::atomic<std::atomic<std::uint64_t>*>[]>(m_mask + 1)),
+      m_previous(highest_trackable, significant_digits),
+      m_interval(interval),
+      m_interval_start(std::chrono::steady_clock::now()) {}
+
+LatencyRecorder::~LatencyRecorder() {
+  for (std::size_t slot = 0; slot <= m_mask; ++slot) {
+    delete[] m_shards[slot].load(std::memory_order_relaxed);
+  }
+}
+
+std::atomic<std::uint64_t>* LatencyRecorder::AddShard(std::size_t slot) noexcept {
+  auto* counts = new std::atomic<std::uint64_t>[m_layout.counts_length]();
+  std::atomic<std::uint64_t>* expected = nullptr;
+  // Another thread on the same slot may have installed its array first
+  if (!m_shards[slot].compare_exchange_strong(expected, counts, std::memory_order_acq_rel,
+                                              std::memory_order_acquire)) {
+    delete[] counts;
+    return expected;
+  }
+  return counts;
+}
+
+HdrHistogram LatencyRecorder::Cumulative() const {
+  HdrHistogram result(m_layout.highest_trackable, m_layout.significant_digits);
+  for (std::size_t slot = 0; slot <= m_mask; ++slot) {
+    const std::atomic<std::uint64_t>* counts = m_shards[slot].load(std::memory_order_acquire);
+    if (counts == nullptr) {
+      continue;
+    }
+    for (std::size_t index = 0; index < m_layout.counts_length; ++index) {
+      const std::uint64_t count = counts[index].load(std::memory_order_relaxed);
+      result.m_counts[index] += count;
+      result.m_total += count;
+    }
+  }
+  return result;
+}
+
+HdrHistogram LatencyRecorder::TakeInterval() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return TakeIntervalLocked();
+}
+
+HdrHistogram LatencyRecorder::TakeIntervalLocked() {
+  HdrHistogram current = Cumulative();
+  HdrHistogram interval = current;
+  // Each shard count only grows, so every difference is the interval's share
+  for (std::size_t index = 0; index < m_layout.counts_length; ++index) {
+    interval.m_counts[index] -= m_previous.m_counts[index];
+  }
+  interval.m_total -= m_previous.m_total;
+  m_previous = std::move(current);
+  return interval;
+}
+
+LatencySnapshot LatencyRecorder::LastInterval() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const auto now = std::chrono::steady_clock::now();
+  if (now - m_interval_start >= m_interval) {
+    m_last = TakeIntervalLocked().Summarize();
+    m_last.start = m_interval_start;
+    m_last.end = now;
+    m_interval_start = now;
+  }
+  return m_last;
+}
+
+LatencySnapshot LatencyRecorder::LastClosed() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_last;
+}
+
+void LatencyRecorder::Publish(std::string_view name, std::string_view help, double scale) {
+  struct Quantile {
+    std::string_view label;
+    std::int64_t LatencySnapshot::*value;
+  };
+  static constexpr Quantile kQuantiles[] = {
+      {"0.5", &LatencySnapshot::p50},   {"0.9", &LatencySnapshot::p90},
+      {"0.99", &LatencySnapshot::p99},  {"0.999", &LatencySnapshot::p999},
+      {"1", &LatencySnapshot::max},
+  };
+  // Series render in registration order: only the first one may close the
+  // interval, so one scrape never mixes quantiles of two intervals
+  bool first = true;
+  for (const Quantile& quantile : kQuantiles) {
+    MetricsRegistry::Instance().AddCallback(
+        name, help, MetricType::Gauge, {{"quantile", quantile.label}},
+        [this, value = quantile.value, scale, roll = first] {
+          const LatencySnapshot last = roll ? LastInterval() : LastClosed();
+          return static_cast<double>(last.*value) * scale;
+        });
+    first = false;
+  }
+}
+
+}  // namespace comm
@@ -0,0 +1,347 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_metrics.cpp
+ * @brief Histogram buckets, MetricsRegistry and the Prometheus text format
+ */
+
+#include "comm_metrics.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+namespace comm {
+
+namespace {
+
+/// Taken during static initialization, i.e. as the process starts
+const std::chrono::steady_clock::time_point kProcessStart = std::chrono::steady_clock::now();
+
+constexpr double kDurationBounds[] = {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005,
+                                      0.01,   0.025,   0.05,   0.1,   0.25,   0.5,
+                                      1,      2.5,     5,      10};
+
+bool IsNameStart(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == ':';
+}
+
+bool IsValidName(std::string_view name, bool label) {
+  if (name.empty() || !IsNameStart(name[0]) || (label && name[0] == ':')) {
+    return false;
+  }
+  return std::all_of(name.begin(), name.end(), [label](char c) {
+    return (IsNameStart(c) && !(label && c == ':')) || (c >= '0' && c <= '9');
+  });
+}
+
+void AppendEscaped(std::string& out, std::string_view text, bool quote) {
+  for (const char c : text) {
+    if (c == '\\') {
+      out += "\\\\";
+    } else if (c == '\n') {
+      out += "\\n";
+    } else if (quote && c == '"') {
+      out += "\\\"";
+    } else {
+      out += c;
+    }
+  }
+}
+
+void AppendNumber(std::string& out, double value) {
+  if (std::isnan(value)) {
+    out += "NaN";
+  } else if (std::isinf(value)) {
+    out += value > 0 ? "+Inf" : "-Inf";
+  } else {
+    char buffer[32];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+  }
+}
+
+void AppendNumber(std::string& out, std::uint64_t value) {
+  char buffer[24];
+  const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  out.append(buffer, result.ptr);
+}
+
+/// name{labels} or name{labels,extra} followed by a space
+void AppendSeries(std::string& out, std::string_view name, std::string_view suffix,
+                  std::string_view labels, std::string_view extra = {}) {
+  out += name;
+  out += suffix;
+  if (!labels.empty() || !extra.empty()) {
+    out += '{';
+    out += labels;
+    if (!labels.empty() && !extra.empty()) {
+      out += ',';
+    }
+    out += extra;
+    out += '}';
+  }
+  out += ' ';
+}
+
+std::string_view TypeName(MetricType type) {
+  switch (type) {
+    case MetricType::Counter:
+      return "counter";
+    case MetricType::Gauge:
+      return "gauge";
+    case MetricType::Histogram:
+      return "histogram";
+  }
+  return "untyped";
+}
+
+}  // namespace
+
+// Error category implementation
+std::string MetricsErrorCategory::message(int error_value) const {
+  switch (static_cast<MetricsError>(error_value)) {
+    case MetricsError::Success:
+      return "Success";
+    case MetricsError::InvalidName:
+      return "Invalid metric or label name";
+    case MetricsError::InvalidBuckets:
+      return "Histogram bounds are not ascending";
+    case MetricsError::Conflict:
+      return "Metric already registered with another type or buckets";
+    case MetricsError::AlreadyRunning:
+      return "Metrics server is already running";
+    case MetricsError::InvalidAddress:
+      return "Invalid metrics listen address";
+    case MetricsError::InvalidPrecision:
+      return "Invalid HDR histogram precision or range";
+    case MetricsError::InvalidEncoding:
+      return "Invalid HDR histogram encoding";
+    default:
+      return "Unknown metrics error";
+  }
+}
+
+const std::error_category& get_metrics_error_category() noexcept {
+  static MetricsErrorCategory instance;
+  return instance;
+}
+
+Histogram::Histogram(std::span<const double> bounds)
+    : m_bounds(bounds.begin(), bounds.end()),
+      m_counts(std::make_unique<std::atomic<std::uint64_t>[]>(bounds.size() + 1)) {}
+
+void Histogram::Observe(double value) noexcept {
+  // First bucket whose upper bound is >= value ("le" is inclusive)
+  const auto bucket = static_cast<std::size_t>(
+      std::lower_bound(m_bounds.begin(), m_bounds.end(), value) - m_bounds.begin());
+  m_counts[bucket].fetch_add(1, std::memory_order_relaxed);
+  m_sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+HistogramSnapshot Histogram::Snapshot() const {
+  HistogramSnapshot snapshot;
+  snapshot.bounds = m_bounds;
+  snapshot.counts.resize(m_bounds.size() + 1);
+  for (std::size_t bucket = 0; bucket <= m_bounds.size(); ++bucket) {
+    snapshot.counts[bucket] = m_counts[bucket].load(std::memory_order_relaxed);
+    snapshot.count += snapshot.counts[bucket];
+  }
+  snapshot.sum = m_sum.load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+std::vector<double> Histogram::ExponentialBounds(double start, double factor,
+                                                 std::size_t count) {
+  std::vector<double> bounds;
+  bounds.reserve(count);
+  for (double bound = start; bounds.size() < count; bound *= factor) {
+    bounds.push_back(bound);
+  }
+  return bounds;
+}
+
+std::span<const double> Histogram::DurationBounds() noexcept { return kDurationBounds; }
+
+MetricsRegistry& MetricsRegistry::Instance() {
+  static MetricsRegistry* const instance = new MetricsRegistry();
+  return *instance;
+}
+
+MetricsRegistry::MetricsRegistry() {
+  AddCallback("modu_uptime_seconds", "Time since the process started", MetricType::Gauge, {},
+              [] {
+                return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                                     kProcessStart)
+                    .count();
+              });
+}
+
+Counter& MetricsRegistry::GetCounter(std::string_view name, std::string_view help,
+                                     MetricLabels labels) {
+  std::string rendered = RenderLabels(labels);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Family& family = FamilyOf(name, help, MetricType::Counter, false, {});
+  if (Series* series = Find(family, rendered)) {
+    return *std::get<std::unique_ptr<Counter>>(series->value);
+  }
+  auto& value =
+      family.series.emplace_back(Series{std::move(rendered), std::make_unique<Counter>()});
+  return *std::get<std::unique_ptr<Counter>>(value.value);
+}
+
+Gauge& MetricsRegistry::GetGauge(std::string_view name, std::string_view help,
+                                 MetricLabels labels) {
+  std::string rendered = RenderLabels(labels);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Family& family = FamilyOf(name, help, MetricType::Gauge, false, {});
+  if (Series* series = Find(family, rendered)) {
+    return *std::get<std::unique_ptr<Gauge>>(series->value);
+  }
+  auto& value =
+      family.series.emplace_back(Series{std::move(rendered), std::make_unique<Gauge>()});
+  return *std::get<std::unique_ptr<Gauge>>(value.value);
+}
+
+Histogram& MetricsRegistry::GetHistogram(std::string_view name, std::string_view help,
+                                         std::span<const double> bounds, MetricLabels labels) {
+  if (!std::is_sorted(bounds.begin(), bounds.end())) {
+    throw std::system_error(make_error_code(MetricsError::InvalidBuckets), std::string(name));
+  }
+  std::string rendered = RenderLabels(labels);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Family& family = FamilyOf(name, help, MetricType::Histogram, false, bounds);
+  if (Series* series = Find(family, rendered)) {
+    return *std::get<std::unique_ptr<Histogram>>(series->value);
+  }
+  auto& value = family.series.emplace_back(
+      Series{std::move(rendered), std::make_unique<Histogram>(family.bounds)});
+  return *std::get<std::unique_ptr<Histogram>>(value.value);
+}
+
+void MetricsRegistry::AddCallback(std::string_view name, std::string_view help,
+                                  MetricType type, MetricLabels labels,
+                                  std::function<double()> read) {
+  if (type == MetricType::Histogram) {
+    throw std::system_error(make_error_code(MetricsError::Conflict),
+                            "callbacks can only be counters or gauges");
+  }
+  std::string rendered = RenderLabels(labels);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Family& family = FamilyOf(name, help, type, true, {});
+  if (Series* series = Find(family, rendered)) {
+    series->value = std::move(read);
+    return;
+  }
+  family.series.push_back(Series{std::move(rendered), std::move(read)});
+}
+
+MetricsRegistry::Family& MetricsRegistry::FamilyOf(std::string_view name, std::string_view help,
+                                                   MetricType type, bool callback,
+                                                   std::span<const double> bounds) {
+  if (!IsValidName(name, false)) {
+    throw std::system_error(make_error_code(MetricsError::InvalidName), std::string(name));
+  }
+  const Symbol symbol(name);
+  if (auto it = m_by_name.find(symbol); it != m_by_name.end()) {
+    Family& family = *it->second;
+    if (family.type != type || family.callback != callback ||
+        !std::equal(bounds.begin(), bounds.end(), family.bounds.begin(), family.bounds.end())) {
+      throw std::system_error(make_error_code(MetricsError::Conflict), std::string(name));
+    }
+    return family;
+  }
+  auto family = std::make_unique<Family>();
+  family->name = symbol;
+  family->help = help;
+  family->type = type;
+  family->callback = callback;
+  family->bounds.assign(bounds.begin(), bounds.end());
+  m_families.push_back(std::move(family));
+  m_by_name.try_emplace(symbol, m_families.back().get());
+  return *m_families.back();
+}
+
+MetricsRegistry::Series* MetricsRegistry::Find(Family& family, const std::string& labels) {
+  auto [it, inserted] = family.by_labels.try_emplace(labels, family.series.size());
+  return inserted ? nullptr : &family.series[it->second];
+}
+
+std::string MetricsRegistry::RenderLabels(MetricLabels labels) {
+  std::string rendered;
+  for (const auto& [name, value] : labels) {
+    if (!IsValidName(name, true) || name == "le") {
+      throw std::system_error(make_error_code(MetricsError::InvalidName), std::string(name));
+    }
+    if (!rendered.empty()) {
+      rendered += ',';
+    }
+    rendered += name;
+    rendered += "=\"";
+    AppendEscaped(rendered, value, true);
+    rendered += '"';
+  }
+  return rendered;
+}
+
+std::string MetricsRegistry::Render() const {
+  std::string out;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (const auto& family : m_families) {
+    const std::string_view name = family->name.View();
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    AppendEscaped(out, family->help, false);
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += TypeName(family->type);
+    out += '\n';
+
+    for (const Series& series : family->series) {
+      std::visit(
+          [&](const auto& value) {
+            using Value = std::decay_t<decltype(value)>;
+            if constexpr (std::is_same_v<Value, std::unique_ptr<Counter>>) {
+              AppendSeries(out, name, {}, series.labels);
+              AppendNumber(out, value->Value());
+            } else if constexpr (std::is_same_v<Value, std::unique_ptr<Gauge>>) {
+              AppendSeries(out, name, {}, series.labels);
+              AppendNumber(out, value->Value());
+            } else if constexpr (std::is_same_v<Value, std::function<double()>>) {
+              AppendSeries(out, name, {}, series.labels);
+              AppendNumber(out, value());
+            } else {
+              const HistogramSnapshot snapshot = value->Snapshot();
+              std::uint64_t cumulative = 0;
+              std::string le;
+              for (std::size_t bucket = 0; bucket <= snapshot.bounds.size(); ++bucket) {
+                cumulative += snapshot.counts[bucket];
+                le = "le=\"";
+                AppendNumber(le, bucket < snapshot.bounds.size()
+                                     ? snapshot.bounds[bucket]
+                                     : std::numeric_limits<double>::infinity());
+                le += '"';
+                AppendSeries(out, name, "_bucket", series.labels, le);
+                AppendNumber(out, cumulative);
+                out += '\n';
+              }
+              AppendSeries(out, name, "_sum", series.labels);
+              AppendNumber(out, snapshot.sum);
+              out += '\n';
+              AppendSeries(out, name, "_count", series.labels);
+              AppendNumber(out, snapshot.count);
+            }
+          },
+          series.value);
+      out += '\n';
+    }
+  }
+  return out;
+}
+
+}  // namespace comm
@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_metrics_config.cpp
+ * @brief Implementation of MetricsConfig serialization
+ */
+
+#include "comm_metrics_config.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+
+namespace comm {
+
+void to_toml(toml::value& dest, const MetricsConfig& value) {
+  dest["enabled"] = value.enabled;
+  dest["address"] = value.address;
+  dest["port"] = value.port;
+}
+
+void from_toml(const toml::value& src, MetricsConfig& value) {
+  // Use default-constructed struct as source of default values (created once)
+  static const MetricsConfig defaults;
+
+  try {
+    value.enabled = toml::find_or(src, "enabled", defaults.enabled);
+    value.address = toml::find_or(src, "address", defaults.address);
+    value.port = std::clamp(toml::find_or(src, "port", defaults.port), 0, 65535);
+
+    LOG(INFO) << "Loaded MetricsConfig";
+    LOG(INFO) << "  enabled: " << value.enabled;
+    LOG(INFO) << "  address: " << value.address;
+    LOG(INFO) << "  port: " << value.port;
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Error parsing MetricsConfig: " << e.what();
+    LOG(WARNING) << "Using default values";
+    value = defaults;
+  }
+}
+
+}  // namespace comm
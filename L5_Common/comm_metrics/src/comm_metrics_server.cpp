@@ -0,0 +1,266 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_metrics_server.cpp
+ * @brief Accept loop and one-request HTTP connections on the comm_coro reactor
+ */
+
+#include "comm_metrics_server.h"
+
+#include <arpa/inet.h>
+#include <glog/logging.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "comm_coro.h"
+#include "comm_coro_io.h"
+#include "comm_metrics.h"
+#include "comm_metrics_config.h"
+
+namespace comm {
+
+namespace {
+
+/// Longest request head read; longer requests get 431
+constexpr std::size_t kMaxRequestBytes = 8192;
+/// Time a client has to send its request and read the response
+constexpr auto kConnectionTimeout = std::chrono::seconds(10);
+/// Pause after accept() failed for lack of resources (EMFILE, ENOBUFS)
+constexpr auto kAcceptBackoff = std::chrono::milliseconds(100);
+
+std::error_code LastError() { return {errno, std::system_category()}; }
+
+std::string Response(std::string_view status, std::string_view content_type,
+                     std::string_view body) {
+  std::string response = "HTTP/1.1 ";
+  response += status;
+  response += "\r\nContent-Type: ";
+  response += content_type;
+  response += "\r\nContent-Length: ";
+  response += std::to_string(body.size());
+  response += "\r\nConnection: close\r\n\r\n";
+  response += body;
+  return response;
+}
+
+/// Read until the blank line ending the request head
+Task<std::error_code> ReceiveHead(int fd, std::string& head, std::stop_token stop) {
+  char buffer[1024];
+  while (head.find("\r\n\r\n") == std::string::npos) {
+    if (head.size() >= kMaxRequestBytes) {
+      co_return std::make_error_code(std::errc::message_size);
+    }
+    const ssize_t received = ::recv(fd, buffer, sizeof(buffer), 0);
+    if (received > 0) {
+      head.append(buffer, static_cast<std::size_t>(received));
+    } else if (received == 0) {
+      co_return std::make_error_code(std::errc::connection_reset);
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      if (auto error = co_await WaitReadable(fd, stop)) {
+        co_return error;
+      }
+    } else if (errno != EINTR) {
+      co_return LastError();
+    }
+  }
+  co_return std::error_code{};
+}
+
+Task<std::error_code> SendAll(int fd, std::string_view data, std::stop_token stop) {
+  while (!data.empty()) {
+    const ssize_t sent = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+    if (sent >= 0) {
+      data.remove_prefix(static_cast<std::size_t>(sent));
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      if (auto error = co_await WaitWritable(fd, stop)) {
+        co_return error;
+      }
+    } else if (errno != EINTR) {
+      co_return LastError();
+    }
+  }
+  co_return std::error_code{};
+}
+
+/// Stop the connection when its time is up (ends early once it is stopped)
+Task<void> Deadline(std::stop_source& connection) {
+  if (auto error = co_await SleepFor(kConnectionTimeout, connection.get_token()); !error) {
+    connection.request_stop();
+  }
+}
+
+Task<void> Serve(const MetricsServer& server, int fd, std::stop_token server_stop,
+                 std::atomic<int>& connections) {
+  std::stop_source connection;
+  std::stop_callback link(server_stop, [&connection] { connection.request_stop(); });
+  TaskScope deadline;
+  deadline.Spawn(Deadline(connection));
+  try {
+    std::string head;
+    auto error = co_await ReceiveHead(fd, head, connection.get_token());
+    if (error == std::errc::message_size) {
+      error = co_await SendAll(
+          fd, Response("431 Request Header Fields Too Large", "text/plain", "Request too large\n"),
+          connection.get_token());
+    } else if (!error) {
+      error = co_await SendAll(fd, server.HandleRequest(head), connection.get_token());
+    }
+    if (error && error != CoroError::Cancelled && error != CoroError::ShuttingDown) {
+      VLOG(1) << "Metrics connection closed: " << error.message();
+    }
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Metrics request failed: " << e.what();
+  }
+  connection.request_stop();
+  co_await deadline.Join();
+  ::close(fd);
+  connections.fetch_sub(1, std::memory_order_relaxed);
+}
+
+Task<void> AcceptLoop(const MetricsServer& server, int listen_fd, TaskScope& scope,
+                      std::atomic<int>& connections) {
+  const std::stop_token stop = scope.GetToken();
+  while (!stop.stop_requested()) {
+    const int fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd >= 0) {
+      if (connections.load(std::memory_order_relaxed) >= MetricsServer::kMaxConnections) {
+        LOG(WARNING) << "Metrics connection refused: " << MetricsServer::kMaxConnections
+                     << " connections open";
+        ::close(fd);
+        continue;
+      }
+      connections.fetch_add(1, std::memory_order_relaxed);
+      scope.Spawn(Serve(server, fd, stop, connections));
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      if (auto error = co_await WaitReadable(listen_fd, stop)) {
+        co_return;  // Cancelled or ShuttingDown
+      }
+    } else if (errno != EINTR && errno != ECONNABORTED) {
+      LOG(ERROR) << "Metrics accept() failed: " << LastError().message();
+      if (auto error = co_await SleepFor(kAcceptBackoff, stop)) {
+        co_return;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+MetricsServer& MetricsServer::Instance() {
+  static MetricsServer* const instance = new MetricsServer();
+  return *instance;
+}
+
+MetricsServer::MetricsServer() = default;
+
+MetricsServer::~MetricsServer() = default;
+
+std::error_code MetricsServer::Start(const MetricsConfig& config) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_scope) {
+    return make_error_code(MetricsError::AlreadyRunning);
+  }
+
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(static_cast<std::uint16_t>(config.port));
+  if (::inet_pton(AF_INET, config.address.c_str(), &address.sin_addr) != 1) {
+    return make_error_code(MetricsError::InvalidAddress);
+  }
+
+  const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return LastError();
+  }
+  const int reuse = 1;
+  ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  socklen_t length = sizeof(address);
+  if (::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+      ::listen(fd, SOMAXCONN) != 0 ||
+      ::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+    const std::error_code error = LastError();
+    ::close(fd);
+    return error;
+  }
+
+  m_listen_fd = fd;
+  m_port.store(ntohs(address.sin_port), std::memory_order_relaxed);
+  m_scope = std::make_unique<TaskScope>();
+  m_scope->Spawn(AcceptLoop(*this, fd, *m_scope, m_connections));
+  LOG(INFO) << "Serving metrics on http://" << config.address << ":" << Port() << "/metrics";
+  return {};
+}
+
+void MetricsServer::Stop() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_scope) {
+    return;
+  }
+  m_scope->Cancel();
+  SyncWait(m_scope->Join());
+  m_scope.reset();
+  ::close(m_listen_fd);
+  m_listen_fd = -1;
+  m_port.store(0, std::memory_order_relaxed);
+  LOG(INFO) << "Metrics server stopped";
+}
+
+void MetricsServer::AddHandler(std::string path, std::string content_type, Handler handler) {
+  std::lock_guard<std::mutex> lock(m_handlers_mutex);
+  m_handlers.insert_or_assign(std::move(path),
+                              Endpoint{std::move(content_type), std::move(handler)});
+}
+
+void MetricsServer::RemoveHandler(std::string_view path) {
+  std::lock_guard<std::mutex> lock(m_handlers_mutex);
+  if (const auto it = m_handlers.find(path); it != m_handlers.end()) {
+    m_handlers.erase(it);
+  }
+}
+
+std::string MetricsServer::HandleRequest(std::string_view head) const {
+  static Counter& scrapes = MetricsRegistry::Instance().GetCounter(
+      "modu_metrics_scrapes_total", "Requests for /metrics served");
+
+  const std::string_view line = head.substr(0, head.find("\r\n"));
+  const std::size_t method_end = line.find(' ');
+  const std::size_t target_end = line.find(' ', method_end + 1);
+  if (method_end == std::string_view::npos || target_end == std::string_view::npos) {
+    return Response("400 Bad Request", "text/plain", "Bad request\n");
+  }
+  const std::string_view method = line.substr(0, method_end);
+  const std::string_view target = line.substr(method_end + 1, target_end - method_end - 1);
+  const std::size_t query_start = target.find('?');
+  const std::string_view path = target.substr(0, query_start);
+  const std::string_view query =
+      query_start == std::string_view::npos ? std::string_view{} : target.substr(query_start + 1);
+
+  Endpoint endpoint;
+  if (path != "/metrics") {
+    std::lock_guard<std::mutex> lock(m_handlers_mutex);
+    const auto it = m_handlers.find(path);
+    if (it == m_handlers.end()) {
+      return Response("404 Not Found", "text/plain", "Not found, try /metrics\n");
+    }
+    endpoint = it->second;  // Copied: the handler runs without the lock
+  }
+  if (method != "GET") {
+    return Response("405 Method Not Allowed", "text/plain", "Only GET is supported\n");
+  }
+  if (!endpoint.handler) {
+    scrapes.Add();
+    return Response("200 OK", "text/plain; version=0.0.4; charset=utf-8",
+                    MetricsRegistry::Instance().Render());
+  }
+  return Response("200 OK", endpoint.content_type, endpoint.handler(query));
+}
+
+}  // namespace comm
@@ -0,0 +1,340 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_metrics_test.cpp
+ * @brief Unit tests for metrics, their registry and the exposition endpoint
+ */
+
+#include <arpa/inet.h>
+#include <gtest/gtest.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "comm_hdr_histogram.h"
+#include "comm_metrics.h"
+#include "comm_metrics_config.h"
+#include "comm_metrics_server.h"
+
+namespace comm {
+namespace {
+
+/// Send request to the server on localhost:port, return the whole response
+std::string HttpRequest(std::uint16_t port, const std::string& request) {
+  const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  ::inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+  if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+    ::close(fd);
+    return {};
+  }
+  ::send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+  std::string response;
+  char buffer[4096];
+  ssize_t received = 0;
+  while ((received = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+    response.append(buffer, static_cast<std::size_t>(received));
+  }
+  ::close(fd);
+  return response;
+}
+
+}  // namespace
+
+TEST(MetricsTest, RegistryReturnsOneMetricPerNameAndLabels) {
+  auto& registry = MetricsRegistry::Instance();
+  Counter& plain = registry.GetCounter("test_events_total", "Events");
+  Counter& same = registry.GetCounter("test_events_total", "Events");
+  Counter& labelled = registry.GetCounter("test_events_total", "Events", {{"kind", "a"}});
+  EXPECT_EQ(&plain, &same);
+  EXPECT_NE(&plain, &labelled);
+
+  plain.Add();
+  plain.Add(4);
+  EXPECT_EQ(same.Value(), 5U);
+  EXPECT_EQ(labelled.Value(), 0U);
+
+  Gauge& gauge = registry.GetGauge("test_in_flight", "In flight");
+  gauge.Set(3);
+  gauge.Add(2);
+  gauge.Subtract();
+  EXPECT_DOUBLE_EQ(gauge.Value(), 4);
+}
+
+TEST(MetricsTest, RejectsInvalidNamesAndConflicts) {
+  auto& registry = MetricsRegistry::Instance();
+  auto code_of = [](auto&& register_metric) {
+    try {
+      register_metric();
+    } catch (const std::system_error& error) {
+      return error.code();
+    }
+    return std::error_code{};
+  };
+  EXPECT_EQ(code_of([&] { registry.GetCounter("9lives", ""); }), MetricsError::InvalidName);
+  EXPECT_EQ(code_of([&] { registry.GetCounter("test_ok_total", "", {{"bad-label", "x"}}); }),
+            MetricsError::InvalidName);
+  EXPECT_EQ(code_of([&] { registry.GetCounter("test_ok_total", "", {{"le", "1"}}); }),
+            MetricsError::InvalidName);
+
+  registry.GetCounter("test_conflict", "");
+  EXPECT_EQ(code_of([&] { registry.GetGauge("test_conflict", ""); }), MetricsError::Conflict);
+
+  const double bounds[] = {1, 2};
+  const double other_bounds[] = {1, 3};
+  const double unsorted[] = {2, 1};
+  registry.GetHistogram("test_sizes", "", bounds);
+  EXPECT_EQ(code_of([&] { registry.GetHistogram("test_sizes", "", other_bounds); }),
+            MetricsError::Conflict);
+  EXPECT_EQ(code_of([&] { registry.GetHistogram("test_unsorted", "", unsorted); }),
+            MetricsError::InvalidBuckets);
+}
+
+TEST(MetricsTest, HistogramCountsInclusiveUpperBounds) {
+  const double bounds[] = {1, 10, 100};
+  Histogram histogram(bounds);
+  for (const double value : {0.5, 1.0, 5.0, 10.0, 50.0, 500.0}) {
+    histogram.Observe(value);
+  }
+  const HistogramSnapshot snapshot = histogram.Snapshot();
+  EXPECT_EQ(snapshot.counts, (std::vector<std::uint64_t>{2, 2, 1, 1}));
+  EXPECT_EQ(snapshot.count, 6U);
+  EXPECT_DOUBLE_EQ(snapshot.sum, 566.5);
+
+  histogram.ObserveDuration(std::chrono::milliseconds(1500));
+  EXPECT_EQ(histogram.Snapshot().counts[1], 3U);
+
+  EXPECT_EQ(Histogram::ExponentialBounds(1, 2, 4), (std::vector<double>{1, 2, 4, 8}));
+}
+
+TEST(MetricsTest, RendersPrometheusTextFormat) {
+  auto& registry = MetricsRegistry::Instance();
+  registry.GetCounter("test_render_total", "Rendered \"events\"\nsecond line",
+                      {{"path", "a\"b\\c"}})
+      .Add(7);
+  const double bounds[] = {0.5, 1};
+  Histogram& histogram =
+      registry.GetHistogram("test_render_seconds", "Durations", bounds, {{"op", "load"}});
+  histogram.Observe(0.25);
+  histogram.Observe(2);
+  registry.AddCallback("test_render_queue_size", "Queue size", MetricType::Gauge,
+                       {{"queue", "main"}}, [] { return 12.5; });
+
+  const std::string text = registry.Render();
+  EXPECT_NE(text.find("# HELP test_render_total Rendered \"events\"\\nsecond line\n"
+                      "# TYPE test_render_total counter\n"
+                      "test_render_total{path=\"a\\\"b\\\\c\"} 7\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("# TYPE test_render_seconds histogram\n"
+                      "test_render_seconds_bucket{op=\"load\",le=\"0.5\"} 1\n"
+                      "test_render_seconds_bucket{op=\"load\",le=\"1\"} 1\n"
+                      "test_render_seconds_bucket{op=\"load\",le=\"+Inf\"} 2\n"
+                      "test_render_seconds_sum{op=\"load\"} 2.25\n"
+                      "test_render_seconds_count{op=\"load\"} 2\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("# TYPE test_render_queue_size gauge\n"
+                      "test_render_queue_size{queue=\"main\"} 12.5\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("# TYPE modu_uptime_seconds gauge\nmodu_uptime_seconds "),
+            std::string::npos);
+}
+
+TEST(MetricsTest, ConcurrentUpdatesAreNotLost) {
+  constexpr int kThreads = 4;
+  constexpr int kUpdates = 20000;
+  auto& registry = MetricsRegistry::Instance();
+  Counter& counter = registry.GetCounter("test_concurrent_total", "");
+  Histogram& histogram = registry.GetHistogram("test_concurrent_seconds", "");
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < kThreads; ++thread) {
+    threads.emplace_back([&] {
+      for (int update = 0; update < kUpdates; ++update) {
+        counter.Add();
+        histogram.Observe(0.001);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(counter.Value(), static_cast<std::uint64_t>(kThreads * kUpdates));
+  EXPECT_EQ(histogram.Snapshot().count, static_cast<std::uint64_t>(kThreads * kUpdates));
+}
+
+TEST(HdrHistogramTest, PercentilesKeepSignificantDigits) {
+  HdrHistogram histogram;  // 3 digits
+  for (std::int64_t value = 1; value <= 1'000'000; ++value) {
+    histogram.Record(value * 1000);  // 1 us to 1 s in nanoseconds
+  }
+  EXPECT_EQ(histogram.TotalCount(), 1'000'000U);
+  auto near = [](std::int64_t actual, double expected) {
+    return std::abs(static_cast<double>(actual) - expected) <= expected * 0.001;
+  };
+  EXPECT_TRUE(near(histogram.ValueAtPercentile(50), 500'000'000)) << histogram.ValueAtPercentile(50);
+  EXPECT_TRUE(near(histogram.ValueAtPercentile(99), 990'000'000));
+  EXPECT_TRUE(near(histogram.ValueAtPercentile(99.9), 999'000'000));
+  EXPECT_TRUE(near(histogram.Max(), 1'000'000'000));
+  EXPECT_TRUE(near(histogram.Min(), 1000));
+  EXPECT_TRUE(near(static_cast<std::int64_t>(histogram.Mean()), 500'000'500));
+
+  // Small values are exact; out-of-range ones are clamped, not dropped
+  HdrHistogram small(1000, 2);
+  small.Record(-5);
+  small.Record(7);
+  small.Record(1'000'000);
+  EXPECT_EQ(small.Min(), 0);
+  EXPECT_EQ(small.ValueAtPercentile(50), 7);
+  EXPECT_EQ(small.Max(), 1000);
+
+  EXPECT_THROW(HdrHistogram(1000, 6), std::system_error);
+  EXPECT_THROW(HdrHistogram(1, 3), std::system_error);
+}
+
+TEST(HdrHistogramTest, MergesAndRoundTripsThroughEncoding) {
+  HdrHistogram first;
+  HdrHistogram second;
+  HdrHistogram both;
+  for (std::int64_t value = 1; value <= 10000; ++value) {
+    (value % 2 ? first : second).Record(value * 997);
+    both.Record(value * 997);
+  }
+  first.Add(second);
+  EXPECT_EQ(first.Encode(), both.Encode());
+
+  const std::string encoded = both.Encode();
+  EXPECT_LT(encoded.size(), 16'000U);  // 10000 values over ~4000 buckets
+  HdrHistogram decoded(1000, 1);
+  ASSERT_FALSE(HdrHistogram::Decode(encoded, decoded));
+  EXPECT_EQ(decoded.TotalCount(), both.TotalCount());
+  EXPECT_EQ(decoded.SignificantDigits(), 3);
+  EXPECT_EQ(decoded.ValueAtPercentile(99.9), both.ValueAtPercentile(99.9));
+
+  HdrHistogram untouched;
+  EXPECT_EQ(HdrHistogram::Decode(encoded.substr(0, encoded.size() / 2) + "\xff", untouched),
+            MetricsError::InvalidEncoding);
+  EXPECT_EQ(HdrHistogram::Decode("not a histogram", untouched), MetricsError::InvalidEncoding);
+  EXPECT_EQ(untouched.TotalCount(), 0U);
+
+  // Another precision merges by value
+  HdrHistogram coarse(1'000'000'000, 1);
+  coarse.Add(both);
+  EXPECT_EQ(coarse.TotalCount(), both.TotalCount());
+  EXPECT_GE(coarse.Max(), both.Max());
+}
+
+TEST(HdrHistogramTest, RecorderMergesThreadsIntoIntervals) {
+  constexpr int kThreads = 4;
+  constexpr int kValues = 50000;
+  LatencyRecorder recorder(HdrHistogram::kDefaultHighestTrackable, 3,
+                           std::chrono::milliseconds(20));
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < kThreads; ++thread) {
+    threads.emplace_back([&recorder, thread] {
+      for (int value = 1; value <= kValues; ++value) {
+        recorder.Record(value + thread);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  HdrHistogram interval = recorder.TakeInterval();
+  EXPECT_EQ(interval.TotalCount(), static_cast<std::uint64_t>(kThreads * kValues));
+  EXPECT_EQ(recorder.TakeInterval().TotalCount(), 0U);
+
+  recorder.RecordDuration(std::chrono::milliseconds(5));
+  const std::int64_t max = recorder.TakeInterval().Max();  // Top of its 4096 ns bucket
+  EXPECT_GE(max, 5'000'000);
+  EXPECT_LT(max, 5'005'000);
+  EXPECT_EQ(recorder.Cumulative().TotalCount(),
+            static_cast<std::uint64_t>(kThreads * kValues + 1));
+
+  // LastInterval() rolls once per period and reports the same summary in between
+  recorder.Record(2'000'000);
+  std::this_thread::sleep_for(std::chrono::milliseconds(25));
+  const LatencySnapshot last = recorder.LastInterval();
+  EXPECT_EQ(last.count, 1U);
+  EXPECT_GE(last.end - last.start, std::chrono::milliseconds(20));
+  EXPECT_EQ(recorder.LastInterval().p50, last.p50);
+
+  static LatencyRecorder published(HdrHistogram::kDefaultHighestTrackable, 3,
+                                   std::chrono::milliseconds(10));
+  published.Publish("test_latency_seconds", "Latency");
+  published.Record(3'000'000);
+  std::this_thread::sleep_for(std::chrono::milliseconds(15));
+  const std::string text = MetricsRegistry::Instance().Render();
+  EXPECT_NE(text.find("# TYPE test_latency_seconds gauge\n"
+                      "test_latency_seconds{quantile=\"0.5\"} 0.003"),
+            std::string::npos);
+  EXPECT_NE(text.find("test_latency_seconds{quantile=\"1\"} 0.003"), std::string::npos);
+}
+
+TEST(MetricsServerTest, ServesMetricsOverHttp) {
+  MetricsRegistry::Instance().GetCounter("test_served_total", "Served").Add(3);
+
+  MetricsConfig config;
+  config.port = 0;
+  auto& server = MetricsServer::Instance();
+  ASSERT_FALSE(server.Start(config));
+  EXPECT_EQ(server.Start(config), MetricsError::AlreadyRunning);
+  const std::uint16_t port = server.Port();
+  ASSERT_NE(port, 0);
+
+  const std::string response = HttpRequest(port, "GET /metrics HTTP/1.1\r\nHost: x\r\n\r\n");
+  EXPECT_EQ(response.rfind("HTTP/1.1 200 OK\r\n", 0), 0U);
+  EXPECT_NE(response.find("Content-Type: text/plain; version=0.0.4"), std::string::npos);
+  EXPECT_NE(response.find("\ntest_served_total 3\n"), std::string::npos);
+
+  EXPECT_EQ(HttpRequest(port, "GET / HTTP/1.1\r\n\r\n").rfind("HTTP/1.1 404", 0), 0U);
+  EXPECT_EQ(HttpRequest(port, "POST /metrics HTTP/1.1\r\n\r\n").rfind("HTTP/1.1 405", 0), 0U);
+  EXPECT_NE(MetricsRegistry::Instance().Render().find("modu_metrics_scrapes_total 1\n"),
+            std::string::npos);
+
+  // A client that never sends its request does not keep Stop() waiting
+  const int idle = ::socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  ::inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+  ASSERT_EQ(::connect(idle, reinterpret_cast<const sockaddr*>(&address), sizeof(address)), 0);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  server.Stop();
+  ::close(idle);
+  EXPECT_EQ(server.Port(), 0);
+  EXPECT_TRUE(HttpRequest(port, "GET /metrics HTTP/1.1\r\n\r\n").empty());
+
+  config.address = "not-an-address";
+  EXPECT_EQ(server.Start(config), MetricsError::InvalidAddress);
+}
+
+TEST(MetricsServerTest, DispatchesAddedHandlersWithQuery) {
+  auto& server = MetricsServer::Instance();
+  server.AddHandler("/debug/echo", "application/json", [](std::string_view query) {
+    return "{\"query\":\"" + std::string(query) + "\"}";
+  });
+
+  std::string response = server.HandleRequest("GET /debug/echo?format=otlp HTTP/1.1\r\n\r\n");
+  EXPECT_EQ(response.rfind("HTTP/1.1 200 OK\r\n", 0), 0U);
+  EXPECT_NE(response.find("Content-Type: application/json\r\n"), std::string::npos);
+  EXPECT_NE(response.find("\r\n\r\n{\"query\":\"format=otlp\"}"), std::string::npos);
+  EXPECT_NE(server.HandleRequest("GET /debug/echo HTTP/1.1\r\n\r\n").find("{\"query\":\"\"}"),
+            std::string::npos);
+  EXPECT_EQ(server.HandleRequest("PUT /debug/echo HTTP/1.1\r\n\r\n").rfind("HTTP/1.1 405", 0), 0U);
+  EXPECT_EQ(server.HandleRequest("GET /debug HTTP/1.1\r\n\r\n").rfind("HTTP/1.1 404", 0), 0U);
+  EXPECT_EQ(server.HandleRequest("garbage").rfind("HTTP/1.1 400", 0), 0U);
+
+  server.RemoveHandler("/debug/echo");
+  EXPECT_EQ(server.HandleRequest("GET /debug/echo HTTP/1.1\r\n\r\n").rfind("HTTP/1.1 404", 0),
+            0U);
+}
+
+}  // namespace comm
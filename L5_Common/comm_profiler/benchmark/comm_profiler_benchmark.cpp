@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_profiler_benchmark.cpp
+ * @brief Overhead of sampling on a CPU-bound loop and cost of rendering a profile
+ * @details BM_ProfiledWork runs the same arithmetic loop with the profiler
+ *          off (Arg 0) and sampling at 99 and 1000 Hz; the difference is what
+ *          the signal handler and stack capture cost the profiled threads.
+ *          BM_Render symbolizes and writes a profile of a few hundred samples
+ *          as collapsed stacks (Arg 0) and as pprof (Arg 1).
+ *
+ * Usage: modu-core-comm_profiler_benchmark [--benchmark_filter=...]
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+#include "comm_profiler.h"
+#include "comm_profiler_config.h"
+
+namespace {
+
+__attribute__((noinline)) double Work(int iterations) {
+  double sum = 0;
+  for (int index = 0; index < iterations; ++index) {
+    sum += std::sqrt(static_cast<double>(index));
+  }
+  return sum;
+}
+
+void BM_ProfiledWork(benchmark::State& state) {
+  auto& profiler = comm::Profiler::Instance();
+  if (state.range(0) > 0) {
+    comm::ProfilerConfig config;
+    config.frequency_hz = static_cast<int>(state.range(0));
+    config.max_samples = 1 << 16;
+    profiler.Start(config);
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Work(10000));
+  }
+  if (state.range(0) > 0) {
+    profiler.Stop();
+    state.counters["samples"] = static_cast<double>(profiler.GetStats().samples);
+  }
+}
+
+void BM_Render(benchmark::State& state) {
+  auto& profiler = comm::Profiler::Instance();
+  comm::ProfilerConfig config;
+  config.frequency_hz = 1000;
+  profiler.Start(config);
+  const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+  while (std::chrono::steady_clock::now() < until) {
+    benchmark::DoNotOptimize(Work(10000));
+  }
+  profiler.Stop();
+
+  const auto format = static_cast<comm::ProfileFormat>(state.range(0));
+  std::size_t bytes = 0;
+  for (auto _ : state) {
+    const std::string profile = profiler.Render(format);
+    bytes = profile.size();
+    benchmark::DoNotOptimize(profile.data());
+  }
+  state.counters["samples"] = static_cast<double>(profiler.GetStats().samples);
+  state.counters["bytes"] = static_cast<double>(bytes);
+}
+
+}  // namespace
+
+BENCHMARK(BM_ProfiledWork)->Arg(0)->Arg(99)->Arg(1000)->MinTime(2.0);
+BENCHMARK(BM_Render)
+    ->Arg(static_cast<int>(comm::ProfileFormat::Collapsed))
+    ->Arg(static_cast<int>(comm::ProfileFormat::Pprof))
+    ->Unit(benchmark::kMicrosecond);
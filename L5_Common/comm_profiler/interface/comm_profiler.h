@@ -0,0 +1,184 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_profiler.h
+ * @brief In-process sampling CPU profiler
+ * @details Start() arms one CPU-time timer per thread of the process
+ *          (timer_create on the thread's CPU clock, delivered to that thread
+ *          as SIGPROF), so each thread is sampled in proportion to the CPU
+ *          it uses; threads created later get their timer from a scanner
+ *          thread that re-reads /proc/self/task every 10 ms. The SIGPROF
+ *          handler walks the thread's frame-pointer chain into a
+ *          preallocated buffer: raw return addresses only, no allocation and
+ *          no lock. When the buffer is full further samples are counted and
+ *          dropped. Render() symbolizes the distinct addresses once, when a
+ *          profile is requested, and writes collapsed stacks (flame graph
+ *          input) or a pprof profile.
+ *
+ * @code
+ * comm::ProfilerConfig config;
+ * config.frequency_hz = 199;
+ * if (auto error = comm::Profiler::Instance().Start(config)) {
+ *   LOG(ERROR) << "Profiler not started: " << error.message();
+ * }
+ * RunLoad();
+ * comm::Profiler::Instance().Stop();
+ * std::string pprof = comm::Profiler::Instance().Render(comm::ProfileFormat::Pprof);
+ * @endcode
+ *
+ * @note Stacks are followed through frame pointers, so code built with
+ *       -fomit-frame-pointer (the default when optimizing) loses callers. Function
+ *       names come from the dynamic symbol table: link executables with
+ *       ENABLE_EXPORTS (-rdynamic), otherwise their frames show as
+ *       "module+0xoffset".
+ */
+
+#pragma once
+
+#include <time.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace comm {
+
+struct ProfilerConfig;
+
+/**
+ * @brief Error codes for Profiler module operations
+ */
+enum class ProfilerError {
+  Success = 0,           ///< Operation completed successfully
+  AlreadyRunning = 1,    ///< Start() called while profiling
+  InvalidFrequency = 2,  ///< frequency_hz not in 1-1000
+  InvalidBuffer = 3,     ///< max_samples is 0
+  TimerFailed = 4,       ///< No thread could be given a sampling timer
+};
+
+/**
+ * @brief Error category for Profiler module errors
+ */
+class ProfilerErrorCategory : public std::error_category {
+ public:
+  const char* name() const noexcept override { return "comm_profiler"; }
+  std::string message(int error_value) const override;
+};
+
+/**
+ * @brief Get the singleton instance of ProfilerErrorCategory
+ */
+const std::error_category& get_profiler_error_category() noexcept;
+
+/**
+ * @brief Helper function to create std::error_code from ProfilerError
+ */
+inline std::error_code make_error_code(ProfilerError err) noexcept {
+  return {static_cast<int>(err), get_profiler_error_category()};
+}
+
+/**
+ * @brief Output format of Profiler::Render()
+ */
+enum class ProfileFormat {
+  Collapsed,  ///< "thread;outer;...;leaf count" lines, for flamegraph.pl and speedscope
+  Pprof,      ///< Uncompressed profile.proto, for `go tool pprof` and Perfetto
+};
+
+/**
+ * @brief Counters reported by Profiler::GetStats()
+ */
+struct ProfilerStats {
+  bool running{false};
+  int frequency_hz{0};
+  std::size_t threads{0};    ///< Threads with a sampling timer
+  std::uint64_t samples{0};  ///< Stacks held by the buffer
+  std::uint64_t dropped{0};  ///< Samples lost because the buffer was full
+  std::size_t capacity{0};   ///< Stacks the buffer holds
+};
+
+namespace detail {
+struct SampleBuffer;
+}  // namespace detail
+
+/**
+ * @class Profiler
+ * @brief Process-wide sampler; one profile at a time
+ */
+class Profiler {
+ public:
+  /// Frames kept per stack; deeper stacks lose their outermost frames
+  static constexpr std::size_t kMaxDepth = 64;
+
+  /**
+   * @brief Returns the process-wide profiler
+   * @note Stops a running profile when destroyed at exit; its SIGPROF
+   *       handler stays installed, so a late signal never hits the default action
+   */
+  static Profiler& Instance();
+
+  Profiler(const Profiler&) = delete;
+  Profiler& operator=(const Profiler&) = delete;
+
+  /**
+   * @brief Discard the previous profile and start sampling every thread,
+   *        including threads created until Stop()
+   * @return Empty error_code, ProfilerError::AlreadyRunning,
+   *         InvalidFrequency, InvalidBuffer or TimerFailed
+   */
+  std::error_code Start(const ProfilerConfig& config);
+
+  /**
+   * @brief Stop sampling; the profile stays available to Render()
+   * @note No-op if not running
+   */
+  void Stop();
+
+  bool IsRunning() const noexcept;
+
+  /**
+   * @brief The samples taken so far, symbolized, in format
+   * @note Safe while sampling: a stack being written is left out
+   */
+  std::string Render(ProfileFormat format) const;
+
+  ProfilerStats GetStats() const;
+
+ private:
+  Profiler();
+  ~Profiler();
+
+  /// Give every thread without one a timer, free the timers of exited threads
+  void ScanThreads();
+
+  /// Scanner thread: ScanThreads() every 10 ms until Stop()
+  void ScanLoop();
+
+  mutable std::mutex m_mutex;  ///< Serializes Start(), Stop(), Render() and scans
+  std::condition_variable m_wake;  ///< Ends the scanner's wait; signals its exit
+  std::unique_ptr<detail::SampleBuffer> m_buffer;
+  std::unordered_map<int, timer_t> m_timers;  ///< By tid, one per live sampled thread
+  std::vector<std::pair<int, std::string>> m_threads;  ///< tid and name of every thread sampled
+  std::thread m_scanner;
+  bool m_scanning{false};  ///< m_scanner has not finished its loop
+  bool m_running{false};
+  int m_frequency_hz{0};
+  std::int64_t m_started_ns{0};  ///< CLOCK_REALTIME
+  std::int64_t m_stopped_ns{0};  ///< CLOCK_REALTIME, 0 while running
+};
+
+}  // namespace comm
+
+namespace std {
+template <>
+struct is_error_code_enum<comm::ProfilerError> : true_type {};
+}  // namespace std
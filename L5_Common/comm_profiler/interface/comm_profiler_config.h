@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_profiler_config.h
+ * @brief [profiler] configuration section and its TOML serialization
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <toml.hpp>
+
+namespace comm {
+
+/**
+ * @brief Settings read from the [profiler] section of config.toml
+ *
+ * @code
+ * [profiler]
+ * enabled = false       # serve /debug/profile/start and /stop on the metrics port
+ * frequency_hz = 99     # samples per second of CPU time, per thread, 1-1000
+ * max_samples = 8192    # stacks kept per profile (~530 bytes each)
+ * @endcode
+ *
+ * @note Read by each Profiler::Start(); a profile is started and stopped at
+ *       runtime, e.g. through GET /debug/profile/start and /debug/profile/stop.
+ *       The metrics port has no authentication, so those endpoints exist
+ *       only with enabled set (read once at startup)
+ */
+struct ProfilerConfig {
+  bool enabled = false;
+  int frequency_hz = 99;
+  std::size_t max_samples = 8192;
+
+  bool operator==(const ProfilerConfig&) const = default;
+};
+
+/// Override config from a query string: "hz=499&samples=65536"
+void ApplyProfilerQuery(std::string_view query, ProfilerConfig& config);
+
+// ADL-based serialization functions
+void to_toml(toml::value& dest, const ProfilerConfig& value);
+void from_toml(const toml::value& src, ProfilerConfig& value);
+
+}  // namespace comm
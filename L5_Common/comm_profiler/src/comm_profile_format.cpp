@@ -0,0 +1,263 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_profile_format.cpp
+ * @brief dladdr() symbolization, collapsed stacks and a minimal profile.proto encoder
+ */
+
+#include "comm_profile_format.h"
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string_view>
+#include <unordered_map>
+
+namespace comm {
+namespace detail {
+
+namespace {
+
+std::string Hex(std::uintptr_t value) {
+  char buffer[24];
+  int length = 0;
+  do {
+    buffer[length++] = "0123456789abcdef"[value & 0xF];
+    value >>= 4;
+  } while (value != 0);
+  std::string text = "0x";
+  while (length > 0) {
+    text += buffer[--length];
+  }
+  return text;
+}
+
+/// Address to look up for frame index: return addresses point past the call
+std::uintptr_t LookupAddress(const std::vector<void*>& frames, std::size_t index) {
+  const auto address = reinterpret_cast<std::uintptr_t>(frames[index]);
+  return index == 0 ? address : address - 1;
+}
+
+/**
+ * @brief Function names of code addresses, each looked up once
+ */
+class Symbolizer {
+ public:
+  const std::string& Name(std::uintptr_t address) {
+    auto [it, inserted] = m_names.try_emplace(address);
+    if (inserted) {
+      it->second = Lookup(address);
+    }
+    return it->second;
+  }
+
+ private:
+  static std::string Lookup(std::uintptr_t address) {
+    Dl_info info{};
+    if (::dladdr(reinterpret_cast<void*>(address), &info) == 0) {
+      return Hex(address);
+    }
+    if (info.dli_sname != nullptr) {
+      int status = 0;
+      char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+      std::string name = status == 0 ? demangled : info.dli_sname;
+      std::free(demangled);
+      return name;
+    }
+    if (info.dli_fname != nullptr) {
+      // Not in the dynamic symbol table (static function, no -rdynamic)
+      const char* slash = std::strrchr(info.dli_fname, '/');
+      return std::string(slash != nullptr ? slash + 1 : info.dli_fname) + "+" +
+             Hex(address - reinterpret_cast<std::uintptr_t>(info.dli_fbase));
+    }
+    return Hex(address);
+  }
+
+  std::unordered_map<std::uintptr_t, std::string> m_names;
+};
+
+std::unordered_map<int, std::string> ThreadNames(const ProfileData& profile) {
+  std::unordered_map<int, std::string> names;
+  for (const auto& [tid, name] : profile.threads) {
+    names.emplace(tid, name.empty() ? "thread-" + std::to_string(tid) : name);
+  }
+  return names;
+}
+
+/**
+ * @brief Protocol Buffers wire format, just what profile.proto needs
+ */
+class ProtoWriter {
+ public:
+  void Varint(std::uint64_t value) {
+    while (value >= 0x80) {
+      m_out += static_cast<char>((value & 0x7F) | 0x80);
+      value >>= 7;
+    }
+    m_out += static_cast<char>(value);
+  }
+
+  /// int64/uint64 field (wire type 0); zero is the default and is skipped
+  void Int(int field, std::uint64_t value) {
+    if (value != 0) {
+      Varint(static_cast<std::uint64_t>(field) << 3);
+      Varint(value);
+    }
+  }
+
+  /// string, bytes or embedded message field (wire type 2)
+  void Bytes(int field, std::string_view bytes) {
+    Varint(static_cast<std::uint64_t>(field) << 3 | 2);
+    Varint(bytes.size());
+    m_out.append(bytes);
+  }
+
+  void Packed(int field, const std::vector<std::uint64_t>& values) {
+    ProtoWriter packed;
+    for (const std::uint64_t value : values) {
+      packed.Varint(value);
+    }
+    Bytes(field, packed.m_out);
+  }
+
+  const std::string& Data() const { return m_out; }
+
+ private:
+  std::string m_out;
+};
+
+/// Indexes into Profile.string_table; index 0 is always ""
+class StringTable {
+ public:
+  StringTable() { Index(""); }
+
+  std::uint64_t Index(const std::string& text) {
+    auto [it, inserted] = m_indexes.try_emplace(text, m_strings.size());
+    if (inserted) {
+      m_strings.push_back(text);
+    }
+    return it->second;
+  }
+
+  const std::vector<std::string>& Strings() const { return m_strings; }
+
+ private:
+  std::unordered_map<std::string, std::uint64_t> m_indexes;
+  std::vector<std::string> m_strings;
+};
+
+std::string ValueType(StringTable& strings, const std::string& type, const std::string& unit) {
+  ProtoWriter value_type;
+  value_type.Int(1, strings.Index(type));
+  value_type.Int(2, strings.Index(unit));
+  return value_type.Data();
+}
+
+}  // namespace
+
+std::string RenderCollapsed(const ProfileData& profile) {
+  const auto thread_names = ThreadNames(profile);
+  Symbolizer symbolizer;
+  std::map<std::string, std::uint64_t> folded;  // Sorted output, equal stacks merged
+  for (const StackCount& stack : profile.stacks) {
+    const auto name = thread_names.find(stack.tid);
+    std::string line =
+        name != thread_names.end() ? name->second : "thread-" + std::to_string(stack.tid);
+    for (std::size_t index = stack.frames.size(); index-- > 0;) {
+      line += ';';
+      line += symbolizer.Name(LookupAddress(stack.frames, index));
+    }
+    folded[line] += stack.count;
+  }
+
+  std::string out;
+  for (const auto& [line, count] : folded) {
+    out += line;
+    out += ' ';
+    out += std::to_string(count);
+    out += '\n';
+  }
+  return out;
+}
+
+std::string RenderPprof(const ProfileData& profile) {
+  const auto thread_names = ThreadNames(profile);
+  Symbolizer symbolizer;
+  StringTable strings;
+  ProtoWriter out;
+
+  out.Bytes(1, ValueType(strings, "samples", "count"));
+  out.Bytes(1, ValueType(strings, "cpu", "nanoseconds"));
+
+  std::unordered_map<std::uintptr_t, std::uint64_t> location_ids;
+  std::unordered_map<std::string, std::uint64_t> function_ids;
+  std::string locations;
+  std::string functions;
+  const std::uint64_t thread_key = strings.Index("thread");
+
+  for (const StackCount& stack : profile.stacks) {
+    std::vector<std::uint64_t> location_list;
+    location_list.reserve(stack.frames.size());
+    for (std::size_t index = 0; index < stack.frames.size(); ++index) {
+      const std::uintptr_t address = LookupAddress(stack.frames, index);
+      auto [location, new_location] = location_ids.try_emplace(address, location_ids.size() + 1);
+      if (new_location) {
+        const std::string& name = symbolizer.Name(address);
+        auto [function, new_function] = function_ids.try_emplace(name, function_ids.size() + 1);
+        if (new_function) {
+          ProtoWriter message;
+          message.Int(1, function->second);
+          message.Int(2, strings.Index(name));
+          message.Int(3, strings.Index(name));
+          ProtoWriter field;
+          field.Bytes(5, message.Data());
+          functions += field.Data();
+        }
+        ProtoWriter line;
+        line.Int(1, function->second);
+        ProtoWriter message;
+        message.Int(1, location->second);
+        message.Int(3, address);
+        message.Bytes(4, line.Data());
+        ProtoWriter field;
+        field.Bytes(4, message.Data());
+        locations += field.Data();
+      }
+      location_list.push_back(location->second);
+    }
+
+    const auto name = thread_names.find(stack.tid);
+    ProtoWriter label;
+    label.Int(1, thread_key);
+    label.Int(2, strings.Index(name != thread_names.end() ? name->second
+                                                          : "thread-" + std::to_string(stack.tid)));
+    ProtoWriter sample;
+    sample.Packed(1, location_list);
+    sample.Packed(2, {stack.count, stack.count * static_cast<std::uint64_t>(profile.period_ns)});
+    sample.Bytes(3, label.Data());
+    out.Bytes(2, sample.Data());
+  }
+
+  std::string profile_data = out.Data();
+  profile_data += locations;
+  profile_data += functions;
+
+  ProtoWriter tail;
+  const std::string period_type = ValueType(strings, "cpu", "nanoseconds");
+  for (const std::string& text : strings.Strings()) {
+    tail.Bytes(6, text);
+  }
+  tail.Int(9, static_cast<std::uint64_t>(profile.start_ns));
+  tail.Int(10, static_cast<std::uint64_t>(profile.duration_ns));
+  tail.Bytes(11, period_type);
+  tail.Int(12, static_cast<std::uint64_t>(profile.period_ns));
+  profile_data += tail.Data();
+  return profile_data;
+}
+
+}  // namespace detail
+}  // namespace comm
@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_profile_format.h
+ * @brief Symbolization of sampled stacks and the collapsed and pprof writers
+ * @details Samples arrive as raw addresses, leaf first. Identical stacks of
+ *          a thread are counted once; each distinct address is looked up
+ *          once with dladdr() and demangled, so the cost of a profile is paid
+ *          when it is rendered, never in the signal handler.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace comm {
+namespace detail {
+
+/// One distinct stack of one thread and the number of samples that hit it
+struct StackCount {
+  std::int32_t tid;
+  std::vector<void*> frames;  ///< Leaf first; frames[0] is the interrupted PC
+  std::uint64_t count;
+};
+
+/// Everything a profile writer needs
+struct ProfileData {
+  std::vector<std::pair<int, std::string>> threads;  ///< tid and name
+  std::vector<StackCount> stacks;
+  std::int64_t period_ns;    ///< CPU time one sample stands for
+  std::int64_t start_ns;     ///< CLOCK_REALTIME
+  std::int64_t duration_ns;
+};
+
+/// "thread;outer;...;leaf count\n" per distinct symbolized stack, sorted
+std::string RenderCollapsed(const ProfileData& profile);
+
+/// Serialized perftools.profiles.Profile (profile.proto), not gzipped
+std::string RenderPprof(const ProfileData& profile);
+
+}  // namespace detail
+}  // namespace comm
@@ -0,0 +1,457 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_profiler.cpp
+ * @brief Per-thread CPU-time timers, the SIGPROF stack sampler and its buffer
+ */
+
+#include "comm_profiler.h"
+
+#include <dirent.h>
+#include <glog/logging.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/uio.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <system_error>
+#include <thread>
+#include <unordered_set>
+
+#include "comm_profile_format.h"
+#include "comm_profiler_config.h"
+#include "comm_terminate_signals.h"
+
+// glibc's sigevent has the member but not the POSIX-style name for it
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+namespace comm {
+
+namespace detail {
+
+/**
+ * @brief Fixed number of stack slots, each filled once by a signal handler
+ * @details A handler claims the next slot with one fetch_add and publishes it
+ *          with a release store of ready; slots are never reused within a
+ *          profile, so a ready slot can be read without further checks.
+ */
+struct SampleBuffer {
+  struct Sample {
+    std::atomic<bool> ready{false};
+    std::int32_t tid;
+    std::uint32_t depth;
+    void* frames[Profiler::kMaxDepth];
+  };
+
+  explicit SampleBuffer(std::size_t slots)
+      : capacity(slots), samples(std::make_unique<Sample[]>(slots)) {}
+
+  /**
+   * @brief Store the stack of the thread context interrupted
+   * @note Async-signal-safe: a frame-pointer walk, checked memory reads and
+   *       atomics only
+   */
+  void Record(const ucontext_t* context) noexcept;
+
+  std::uint64_t Held() const noexcept {
+    return std::min<std::uint64_t>(next.load(std::memory_order_relaxed), capacity);
+  }
+
+  const std::size_t capacity;
+  std::unique_ptr<Sample[]> samples;
+  std::atomic<std::uint64_t> next{0};     ///< Slots claimed, including dropped samples
+  std::atomic<std::uint64_t> dropped{0};  ///< Samples that found the buffer full
+};
+
+}  // namespace detail
+
+namespace {
+
+/// Buffer the handler writes to, null while not profiling
+std::atomic<detail::SampleBuffer*> g_active_buffer{nullptr};
+/// Handlers between reading g_active_buffer and finishing their sample
+std::atomic<int> g_handlers_running{0};
+/// Bytes above the interrupted stack pointer a walk may read: RLIMIT_STACK,
+/// which sizes the main thread's stack and glibc's default thread stacks
+std::atomic<std::uintptr_t> g_stack_limit{0};
+/// Mask clearing the offset within a page
+std::atomic<std::uintptr_t> g_page_mask{0};
+
+/// Stack walked when RLIMIT_STACK is unlimited
+constexpr std::uintptr_t kUnlimitedStackWalk = 64U << 20;
+/// Threads created while profiling get a timer at most this much later
+constexpr std::chrono::milliseconds kScanPeriod{10};
+
+/// Interrupted instruction, frame pointer and stack pointer
+struct Registers {
+  std::uintptr_t pc{0};
+  std::uintptr_t fp{0};
+  std::uintptr_t sp{0};
+};
+
+Registers InterruptedRegisters(const ucontext_t* context) {
+#if defined(__x86_64__)
+  return {static_cast<std::uintptr_t>(context->uc_mcontext.gregs[REG_RIP]),
+          static_cast<std::uintptr_t>(context->uc_mcontext.gregs[REG_RBP]),
+          static_cast<std::uintptr_t>(context->uc_mcontext.gregs[REG_RSP])};
+#elif defined(__aarch64__)
+  return {context->uc_mcontext.pc, context->uc_mcontext.regs[29], context->uc_mcontext.sp};
+#else
+  (void)context;
+  return {};  // No walk: the sample is kept empty and left out of profiles
+#endif
+}
+
+/// Copy the frame record {caller's frame pointer, return address} at fp
+/// through the kernel, which fails instead of faulting on an unmapped address
+bool ReadFrameRecord(std::uintptr_t fp, std::uintptr_t (&record)[2]) {
+  iovec local{record, sizeof(record)};
+  iovec remote{reinterpret_cast<void*>(fp), sizeof(record)};
+  return ::process_vm_readv(::getpid(), &local, 1, &remote, 1, 0) ==
+         static_cast<ssize_t>(sizeof(record));
+}
+
+/**
+ * @brief Follow the frame-pointer chain from the interrupted frame outwards
+ * @details Each record must lie above the previous one and within
+ *          g_stack_limit of the interrupted stack pointer. A record on a page
+ *          not read yet is copied with process_vm_readv(); later records on
+ *          the same page are read directly. Code built without frame
+ *          pointers ends the chain early or skips its callers.
+ * @return Frames stored: the interrupted pc, then one return address per caller
+ */
+std::uint32_t WalkStack(const ucontext_t* context, void** frames) {
+  const Registers registers = InterruptedRegisters(context);
+  if (registers.pc == 0) {
+    return 0;
+  }
+  frames[0] = reinterpret_cast<void*>(registers.pc);
+  std::uint32_t depth = 1;
+
+  const std::uintptr_t page_mask = g_page_mask.load(std::memory_order_relaxed);
+  const std::uintptr_t limit = g_stack_limit.load(std::memory_order_relaxed);
+  const std::uintptr_t stack_end =
+      registers.sp > UINTPTR_MAX - limit ? UINTPTR_MAX : registers.sp + limit;
+  std::uintptr_t lowest = registers.sp;           // The next record lies at or above
+  std::uintptr_t readable = registers.sp & page_mask;  // The thread is using this page
+  std::uintptr_t fp = registers.fp;
+  while (depth < Profiler::kMaxDepth) {
+    std::uintptr_t record[2];
+    if (fp < lowest || fp % alignof(std::uintptr_t) != 0 || fp > stack_end - sizeof(record)) {
+      break;
+    }
+    const std::uintptr_t page = fp & page_mask;
+    if (page == readable && ((fp + sizeof(record) - 1) & page_mask) == page) {
+      std::memcpy(record, reinterpret_cast<const void*>(fp), sizeof(record));
+    } else if (ReadFrameRecord(fp, record)) {
+      readable = page;
+    } else {
+      break;
+    }
+    if (record[1] <= ~page_mask) {
+      break;  // Outermost frame: a null (or garbage) return address
+    }
+    frames[depth++] = reinterpret_cast<void*>(record[1]);
+    lowest = fp + sizeof(record);
+    fp = record[0];
+  }
+  return depth;
+}
+
+void OnSigprof(int /*signal*/, siginfo_t* /*info*/, void* context) {
+  const int saved_errno = errno;
+  g_handlers_running.fetch_add(1);
+  if (detail::SampleBuffer* buffer = g_active_buffer.load()) {
+    buffer->Record(static_cast<const ucontext_t*>(context));
+  }
+  g_handlers_running.fetch_sub(1);
+  errno = saved_errno;
+}
+
+/// Unpublish the buffer and wait for handlers still writing to it
+void DeactivateBuffer() {
+  g_active_buffer.store(nullptr);
+  while (g_handlers_running.load() != 0) {
+    std::this_thread::yield();
+  }
+}
+
+/// CPU-time clock of any thread of this process (the kernel's
+/// MAKE_THREAD_CPUCLOCK(tid, CPUCLOCK_SCHED); pthread_getcpuclockid() needs
+/// a pthread_t, which other threads' tids do not give us)
+clockid_t ThreadCpuClock(pid_t tid) {
+  return static_cast<clockid_t>((~static_cast<unsigned>(tid) << 3) | 6);
+}
+
+/// tid of every thread of the process; false if /proc is not readable
+bool ListThreadIds(std::vector<int>& tids) {
+  DIR* directory = ::opendir("/proc/self/task");
+  if (directory == nullptr) {
+    return false;
+  }
+  while (const dirent* entry = ::readdir(directory)) {
+    const int tid = std::atoi(entry->d_name);
+    if (tid > 0) {
+      tids.push_back(tid);
+    }
+  }
+  ::closedir(directory);
+  return true;
+}
+
+std::string ThreadName(int tid) {
+  std::string name;
+  std::ifstream comm("/proc/self/task/" + std::to_string(tid) + "/comm");
+  std::getline(comm, name);
+  return name;
+}
+
+std::int64_t RealtimeNs() {
+  timespec now{};
+  ::clock_gettime(CLOCK_REALTIME, &now);
+  return static_cast<std::int64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec;
+}
+
+}  // namespace
+
+namespace detail {
+
+void SampleBuffer::Record(const ucontext_t* context) noexcept {
+  const std::uint64_t index = next.fetch_add(1, std::memory_order_relaxed);
+  if (index >= capacity) {
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  Sample& sample = samples[index];
+  sample.tid = static_cast<std::int32_t>(::gettid());
+  sample.depth = WalkStack(context, sample.frames);
+  sample.ready.store(true, std::memory_order_release);
+}
+
+}  // namespace detail
+
+// Error category implementation
+std::string ProfilerErrorCategory::message(int error_value) const {
+  switch (static_cast<ProfilerError>(error_value)) {
+    case ProfilerError::Success:
+      return "Success";
+    case ProfilerError::AlreadyRunning:
+      return "Profiler is already running";
+    case ProfilerError::InvalidFrequency:
+      return "Profiler frequency must be 1-1000 Hz";
+    case ProfilerError::InvalidBuffer:
+      return "Profiler buffer must hold at least one sample";
+    case ProfilerError::TimerFailed:
+      return "Could not create a sampling timer for any thread";
+    default:
+      return "Unknown profiler error";
+  }
+}
+
+const std::error_category& get_profiler_error_category() noexcept {
+  static ProfilerErrorCategory instance;
+  return instance;
+}
+
+Profiler& Profiler::Instance() {
+  static Profiler instance;
+  return instance;
+}
+
+Profiler::Profiler() = default;
+
+// The SIGPROF handler stays installed: a signal still queued finds no buffer
+Profiler::~Profiler() { Stop(); }
+
+std::error_code Profiler::Start(const ProfilerConfig& config) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_running || m_scanning) {
+    return make_error_code(ProfilerError::AlreadyRunning);
+  }
+  if (config.frequency_hz < 1 || config.frequency_hz > 1000) {
+    return make_error_code(ProfilerError::InvalidFrequency);
+  }
+  if (config.max_samples == 0) {
+    return make_error_code(ProfilerError::InvalidBuffer);
+  }
+
+  static const bool handler_installed = [] {
+    rlimit stack{};
+    g_stack_limit.store(::getrlimit(RLIMIT_STACK, &stack) == 0 && stack.rlim_cur != RLIM_INFINITY
+                            ? static_cast<std::uintptr_t>(stack.rlim_cur)
+                            : kUnlimitedStackWalk);
+    g_page_mask.store(~static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE) - 1));
+    struct sigaction action {};
+    action.sa_sigaction = OnSigprof;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    return ::sigaction(SIGPROF, &action, nullptr) == 0;
+  }();
+  if (!handler_installed) {
+    return make_error_code(ProfilerError::TimerFailed);
+  }
+
+  // Handlers of the previous profile have finished: Stop() waited for them
+  m_buffer = std::make_unique<detail::SampleBuffer>(config.max_samples);
+  m_threads.clear();
+  m_frequency_hz = config.frequency_hz;
+  g_active_buffer.store(m_buffer.get());
+
+  ScanThreads();
+  if (m_timers.empty()) {
+    const std::error_code error = make_error_code(ProfilerError::TimerFailed);
+    DeactivateBuffer();
+    LOG(ERROR) << "Profiler not started: " << error.message() << " (" << std::strerror(errno)
+               << ")";
+    return error;
+  }
+
+  m_running = true;
+  m_started_ns = RealtimeNs();
+  m_stopped_ns = 0;
+  try {
+    const TerminationSignalBlock block;
+    m_scanner = std::thread(&Profiler::ScanLoop, this);
+    m_scanning = true;
+  } catch (const std::system_error& e) {
+    LOG(WARNING) << "Profiler samples only the threads running now: " << e.what();
+  }
+  LOG(INFO) << "Profiling " << m_timers.size() << " threads at " << m_frequency_hz
+            << " Hz, up to " << config.max_samples << " samples";
+  return {};
+}
+
+void Profiler::Stop() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (!m_running) {
+    return;
+  }
+  m_running = false;
+  m_wake.notify_all();
+  m_wake.wait(lock, [this] { return !m_scanning; });
+  if (m_scanner.joinable()) {
+    m_scanner.join();
+  }
+  for (const auto& [tid, timer] : m_timers) {
+    ::timer_delete(timer);
+  }
+  m_timers.clear();
+  DeactivateBuffer();  // A signal already queued finds no buffer and returns
+  m_stopped_ns = RealtimeNs();
+  LOG(INFO) << "Profiler stopped after " << m_buffer->Held() << " samples ("
+            << m_buffer->dropped.load(std::memory_order_relaxed) << " dropped)";
+}
+
+void Profiler::ScanThreads() {
+  std::vector<int> tids;
+  if (!ListThreadIds(tids)) {
+    if (!m_timers.empty()) {
+      return;  // Keep sampling the threads already found
+    }
+    tids.push_back(static_cast<int>(::gettid()));
+  }
+
+  // Exited threads: free their timers, keep their names for Render()
+  const std::unordered_set<int> alive(tids.begin(), tids.end());
+  std::erase_if(m_timers, [&](const auto& entry) {
+    if (alive.count(entry.first) != 0) {
+      return false;
+    }
+    ::timer_delete(entry.second);
+    return true;
+  });
+
+  const long interval_ns = 1'000'000'000L / m_frequency_hz;
+  const itimerspec interval{{interval_ns / 1'000'000'000L, interval_ns % 1'000'000'000L},
+                            {interval_ns / 1'000'000'000L, interval_ns % 1'000'000'000L}};
+  for (const int tid : tids) {
+    if (m_timers.count(tid) != 0) {
+      continue;
+    }
+    sigevent event{};
+    event.sigev_notify = SIGEV_THREAD_ID;
+    event.sigev_signo = SIGPROF;
+    event.sigev_notify_thread_id = tid;
+    timer_t timer{};
+    if (::timer_create(ThreadCpuClock(tid), &event, &timer) != 0) {
+      continue;  // Exited since it was listed
+    }
+    ::timer_settime(timer, 0, &interval, nullptr);
+    m_timers.emplace(tid, timer);
+    m_threads.emplace_back(tid, ThreadName(tid));
+  }
+}
+
+void Profiler::ScanLoop() {
+  pthread_setname_np(pthread_self(), "comm_profiler");
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (!m_wake.wait_for(lock, kScanPeriod, [this] { return !m_running; })) {
+    ScanThreads();
+  }
+  m_scanning = false;
+  m_wake.notify_all();
+}
+
+bool Profiler::IsRunning() const noexcept {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_running;
+}
+
+std::string Profiler::Render(ProfileFormat format) const {
+  detail::ProfileData profile{};
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_buffer) {
+      return format == ProfileFormat::Pprof ? detail::RenderPprof(profile) : std::string();
+    }
+    // Merge identical stacks of a thread before symbolizing
+    std::map<std::pair<std::int32_t, std::vector<void*>>, std::uint64_t> counts;
+    const std::uint64_t held = m_buffer->Held();
+    for (std::uint64_t index = 0; index < held; ++index) {
+      const auto& sample = m_buffer->samples[index];
+      if (sample.ready.load(std::memory_order_acquire) && sample.depth > 0) {
+        ++counts[{sample.tid,
+                  std::vector<void*>(sample.frames, sample.frames + sample.depth)}];
+      }
+    }
+    profile.threads = m_threads;
+    profile.stacks.reserve(counts.size());
+    for (auto& [key, count] : counts) {
+      profile.stacks.push_back({key.first, key.second, count});
+    }
+    profile.period_ns = 1'000'000'000L / m_frequency_hz;
+    profile.start_ns = m_started_ns;
+    profile.duration_ns = (m_stopped_ns != 0 ? m_stopped_ns : RealtimeNs()) - m_started_ns;
+  }
+  return format == ProfileFormat::Pprof ? detail::RenderPprof(profile)
+                                        : detail::RenderCollapsed(profile);
+}
+
+ProfilerStats Profiler::GetStats() const {
+  ProfilerStats stats;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  stats.running = m_running;
+  stats.frequency_hz = m_frequency_hz;
+  stats.threads = m_running ? m_timers.size() : 0;
+  if (m_buffer) {
+    stats.samples = m_buffer->Held();
+    stats.dropped = m_buffer->dropped.load(std::memory_order_relaxed);
+    stats.capacity = m_buffer->capacity;
+  }
+  return stats;
+}
+
+}  // namespace comm
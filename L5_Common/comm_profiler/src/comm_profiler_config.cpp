@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_profiler_config.cpp
+ * @brief Implementation of ProfilerConfig serialization
+ */
+
+#include "comm_profiler_config.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+
+namespace comm {
+
+void ApplyProfilerQuery(std::string_view query, ProfilerConfig& config) {
+  while (!query.empty()) {
+    const std::string_view parameter = query.substr(0, query.find('&'));
+    query.remove_prefix(std::min(query.size(), parameter.size() + 1));
+    const std::size_t equals = parameter.find('=');
+    if (equals == std::string_view::npos) {
+      continue;
+    }
+    const std::string_view key = parameter.substr(0, equals);
+    const std::string_view text = parameter.substr(equals + 1);
+    if (key == "hz") {
+      std::from_chars(text.data(), text.data() + text.size(), config.frequency_hz);
+    } else if (key == "samples") {
+      std::from_chars(text.data(), text.data() + text.size(), config.max_samples);
+    }
+  }
+}
+
+void to_toml(toml::value& dest, const ProfilerConfig& value) {
+  dest["enabled"] = value.enabled;
+  dest["frequency_hz"] = value.frequency_hz;
+  dest["max_samples"] = static_cast<std::int64_t>(value.max_samples);
+}
+
+void from_toml(const toml::value& src, ProfilerConfig& value) {
+  // Use default-constructed struct as source of default values (created once)
+  static const ProfilerConfig defaults;
+
+  try {
+    value.enabled = toml::find_or(src, "enabled", defaults.enabled);
+    value.frequency_hz = toml::find_or(src, "frequency_hz", defaults.frequency_hz);
+    value.max_samples = static_cast<std::size_t>(std::max<std::int64_t>(
+        toml::find_or(src, "max_samples", static_cast<std::int64_t>(defaults.max_samples)), 1));
+
+    LOG(INFO) << "Loaded ProfilerConfig";
+    LOG(INFO) << "  enabled: " << value.enabled;
+    LOG(INFO) << "  frequency_hz: " << value.frequency_hz;
+    LOG(INFO) << "  max_samples: " << value.max_samples;
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Error parsing ProfilerConfig: " << e.what();
+    LOG(WARNING) << "Using default values";
+    value = defaults;
+  }
+}
+
+}  // namespace comm
@@ -0,0 +1,270 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_profiler_test.cpp
+ * @brief Unit tests for the sampling profiler and its output formats
+ */
+
+#include <gtest/gtest.h>
+#include <pthread.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "comm_profiler.h"
+#include "comm_profiler_config.h"
+
+namespace comm {
+
+/// Exported (the test links with -rdynamic) so the profiler can name it
+__attribute__((noinline)) void ProfilerTestSpin(const std::atomic<bool>& stop) {
+  volatile std::uint64_t sum = 0;
+  while (!stop.load(std::memory_order_relaxed)) {
+    sum = sum + 1;
+  }
+}
+
+namespace {
+
+/// A thread named "spinner" burning CPU until destroyed
+class Spinner {
+ public:
+  Spinner() : m_thread([this] {
+    pthread_setname_np(pthread_self(), "spinner");
+    m_named.store(true);
+    ProfilerTestSpin(m_stop);
+  }) {
+    while (!m_named.load()) {
+      std::this_thread::yield();
+    }
+  }
+
+  ~Spinner() {
+    m_stop.store(true);
+    m_thread.join();
+  }
+
+ private:
+  std::atomic<bool> m_stop{false};
+  std::atomic<bool> m_named{false};
+  std::thread m_thread;
+};
+
+/// Wait until the profiler's buffer holds at least samples stacks
+bool WaitForSamples(std::uint64_t samples) {
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (std::chrono::steady_clock::now() < deadline) {
+    const ProfilerStats stats = Profiler::Instance().GetStats();
+    if (stats.samples >= samples) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return false;
+}
+
+/// Fields of one protobuf message: (field, wire type, value or bytes)
+struct ProtoField {
+  int field;
+  int wire_type;
+  std::uint64_t value;
+  std::string bytes;
+};
+
+bool ReadVarint(const std::string& data, std::size_t& at, std::uint64_t& value) {
+  value = 0;
+  for (int shift = 0; at < data.size() && shift < 64; shift += 7) {
+    const auto byte = static_cast<std::uint8_t>(data[at++]);
+    value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/// Decode a message using only varint and length-delimited fields; false if malformed
+bool ParseProto(const std::string& data, std::vector<ProtoField>& fields) {
+  std::size_t at = 0;
+  while (at < data.size()) {
+    std::uint64_t tag = 0;
+    std::uint64_t value = 0;
+    if (!ReadVarint(data, at, tag) || !ReadVarint(data, at, value)) {
+      return false;
+    }
+    ProtoField field{static_cast<int>(tag >> 3), static_cast<int>(tag & 7), value, {}};
+    if (field.wire_type == 2) {
+      if (value > data.size() - at) {
+        return false;
+      }
+      field.bytes = data.substr(at, value);
+      at += value;
+    } else if (field.wire_type != 0) {
+      return false;
+    }
+    fields.push_back(std::move(field));
+  }
+  return true;
+}
+
+}  // namespace
+
+TEST(ProfilerTest, RejectsInvalidSettings) {
+  auto& profiler = Profiler::Instance();
+  ProfilerConfig config;
+  config.frequency_hz = 0;
+  EXPECT_EQ(profiler.Start(config), ProfilerError::InvalidFrequency);
+  config.frequency_hz = 5000;
+  EXPECT_EQ(profiler.Start(config), ProfilerError::InvalidFrequency);
+  config.frequency_hz = 99;
+  config.max_samples = 0;
+  EXPECT_EQ(profiler.Start(config), ProfilerError::InvalidBuffer);
+  EXPECT_FALSE(profiler.IsRunning());
+  profiler.Stop();  // No-op
+}
+
+TEST(ProfilerTest, SamplesThreadsIntoCollapsedStacks) {
+  Spinner spinner;
+  auto& profiler = Profiler::Instance();
+  ProfilerConfig config;
+  config.frequency_hz = 1000;
+  ASSERT_FALSE(profiler.Start(config));
+  EXPECT_EQ(profiler.Start(config), ProfilerError::AlreadyRunning);
+  EXPECT_TRUE(profiler.IsRunning());
+  EXPECT_GE(profiler.GetStats().threads, 2U);  // This thread and the spinner
+
+  ASSERT_TRUE(WaitForSamples(20));
+  const std::string live = profiler.Render(ProfileFormat::Collapsed);  // While sampling
+  profiler.Stop();
+  EXPECT_FALSE(profiler.IsRunning());
+  const ProfilerStats stats = profiler.GetStats();
+  EXPECT_EQ(stats.dropped, 0U);
+  EXPECT_EQ(stats.capacity, config.max_samples);
+
+  const std::string collapsed = profiler.Render(ProfileFormat::Collapsed);
+  EXPECT_FALSE(live.empty());
+  EXPECT_GE(collapsed.size(), live.size());
+  const std::size_t spin = collapsed.find(";comm::ProfilerTestSpin(std::atomic<bool> const&)");
+  ASSERT_NE(spin, std::string::npos) << collapsed;
+  const std::size_t line_start = collapsed.rfind('\n', spin) + 1;  // npos + 1 == 0
+  EXPECT_EQ(collapsed.compare(line_start, 8, "spinner;"), 0) << collapsed;
+
+  // "stack count" lines adding up to the samples taken
+  std::uint64_t total = 0;
+  for (std::size_t line = 0; line < collapsed.size();) {
+    const std::size_t end = collapsed.find('\n', line);
+    ASSERT_NE(end, std::string::npos);
+    const std::size_t count = collapsed.rfind(' ', end) + 1;
+    total += std::stoull(collapsed.substr(count, end - count));
+    line = end + 1;
+  }
+  EXPECT_EQ(total, stats.samples);
+}
+
+TEST(ProfilerTest, SamplesThreadsStartedWhileProfiling) {
+  auto& profiler = Profiler::Instance();
+  ProfilerConfig config;
+  config.frequency_hz = 1000;
+  ASSERT_FALSE(profiler.Start(config));
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  std::size_t threads = 0;
+  {
+    Spinner spinner;
+    while (profiler.Render(ProfileFormat::Collapsed).find("comm::ProfilerTestSpin") ==
+               std::string::npos &&
+           std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    threads = profiler.GetStats().threads;
+  }
+  // The exited spinner's timer is freed by the next scan
+  while (profiler.GetStats().threads >= threads && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(profiler.GetStats().threads, threads - 1);
+  profiler.Stop();
+
+  EXPECT_NE(profiler.Render(ProfileFormat::Collapsed).find("comm::ProfilerTestSpin"),
+            std::string::npos);
+}
+
+TEST(ProfilerTest, WritesPprofProfile) {
+  Spinner spinner;
+  auto& profiler = Profiler::Instance();
+  ProfilerConfig config;
+  config.frequency_hz = 500;
+  ASSERT_FALSE(profiler.Start(config));
+  ASSERT_TRUE(WaitForSamples(10));
+  profiler.Stop();
+
+  std::vector<ProtoField> fields;
+  ASSERT_TRUE(ParseProto(profiler.Render(ProfileFormat::Pprof), fields));
+  std::vector<std::string> strings;
+  std::size_t samples = 0;
+  std::size_t locations = 0;
+  std::size_t functions = 0;
+  std::uint64_t period = 0;
+  for (const ProtoField& field : fields) {
+    switch (field.field) {
+      case 2: {
+        ++samples;
+        std::vector<ProtoField> sample;
+        ASSERT_TRUE(ParseProto(field.bytes, sample));
+        ASSERT_EQ(sample.size(), 3U);  // location_id, value, thread label
+        break;
+      }
+      case 4:
+        ++locations;
+        break;
+      case 5:
+        ++functions;
+        break;
+      case 6:
+        strings.push_back(field.bytes);
+        break;
+      case 12:
+        period = field.value;
+        break;
+      default:
+        break;
+    }
+  }
+  EXPECT_GT(samples, 0U);
+  EXPECT_GT(locations, 0U);
+  EXPECT_GT(functions, 0U);
+  EXPECT_LE(functions, locations);
+  EXPECT_EQ(period, 2'000'000U);  // ns per sample at 500 Hz
+  ASSERT_FALSE(strings.empty());
+  EXPECT_EQ(strings[0], "");
+  for (const char* expected : {"samples", "count", "cpu", "nanoseconds", "thread", "spinner",
+                               "comm::ProfilerTestSpin(std::atomic<bool> const&)"}) {
+    EXPECT_NE(std::find(strings.begin(), strings.end(), expected), strings.end()) << expected;
+  }
+}
+
+TEST(ProfilerTest, FullBufferCountsDroppedSamples) {
+  Spinner spinner;
+  auto& profiler = Profiler::Instance();
+  ProfilerConfig config;
+  config.frequency_hz = 1000;
+  config.max_samples = 4;
+  ASSERT_FALSE(profiler.Start(config));
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (profiler.GetStats().dropped == 0 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  profiler.Stop();
+
+  const ProfilerStats stats = profiler.GetStats();
+  EXPECT_EQ(stats.samples, 4U);
+  EXPECT_GT(stats.dropped, 0U);
+  EXPECT_EQ(stats.capacity, 4U);
+}
+
+}  // namespace comm
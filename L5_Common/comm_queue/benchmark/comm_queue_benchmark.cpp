@@ -0,0 +1,250 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_queue_benchmark.cpp
+ * @brief SpscQueue and MpmcQueue against std::queue + mutex + condition_variable
+ * @details BM_Transfer moves kItems integers from P producer threads to C
+ *          consumer threads through a queue of kCapacity elements; the
+ *          arguments are {P, C}. BM_WakeLatency measures how long a blocked
+ *          consumer takes to return from Pop() for each WaitPolicy, against
+ *          the condition variable hand-off Terminate's event processor used
+ *          before it moved to MpmcQueue.
+ *
+ * Usage: modu-core-comm_queue_benchmark [--benchmark_filter=...]
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "comm_mpmc_queue.h"
+#include "comm_spsc_queue.h"
+#include "comm_wait.h"
+
+namespace {
+
+constexpr std::size_t kCapacity = 1024;
+constexpr std::size_t kItems = 1 << 18;
+constexpr std::size_t kBatch = 32;
+
+/// Bounded std::queue guarded by a mutex, with the same interface subset
+class MutexQueue {
+ public:
+  explicit MutexQueue(std::size_t capacity) : m_capacity(capacity) {}
+
+  std::error_code Push(std::uint64_t value) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_not_full.wait(lock, [this] { return m_closed || m_queue.size() < m_capacity; });
+    if (m_closed) {
+      return comm::make_error_code(comm::QueueError::Closed);
+    }
+    m_queue.push(value);
+    lock.unlock();
+    m_not_empty.notify_one();
+    return {};
+  }
+
+  std::error_code Pop(std::uint64_t& out) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_not_empty.wait(lock, [this] { return m_closed || !m_queue.empty(); });
+    if (m_queue.empty()) {
+      return comm::make_error_code(comm::QueueError::Closed);
+    }
+    out = m_queue.front();
+    m_queue.pop();
+    lock.unlock();
+    m_not_full.notify_one();
+    return {};
+  }
+
+  void Close() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_closed = true;
+    }
+    m_not_empty.notify_all();
+    m_not_full.notify_all();
+  }
+
+ private:
+  const std::size_t m_capacity;
+  std::mutex m_mutex;
+  std::condition_variable m_not_empty;
+  std::condition_variable m_not_full;
+  std::queue<std::uint64_t> m_queue;
+  bool m_closed{false};
+};
+
+/// One transfer of kItems from producers to consumers
+template <typename Queue, bool kBatched>
+void Transfer(int producers, int consumers) {
+  Queue queue(kCapacity);
+  std::atomic<int> running{producers};
+  std::vector<std::thread> threads;
+  const std::size_t per_producer = kItems / static_cast<std::size_t>(producers);
+
+  for (int producer = 0; producer < producers; ++producer) {
+    threads.emplace_back([&queue, &running, per_producer] {
+      if constexpr (kBatched) {
+        std::uint64_t values[kBatch];
+        for (std::size_t sent = 0; sent < per_producer; sent += kBatch) {
+          for (std::size_t index = 0; index < kBatch; ++index) {
+            values[index] = sent + index;
+          }
+          queue.PushBatch(values, std::min(kBatch, per_producer - sent));
+        }
+      } else {
+        for (std::size_t sent = 0; sent < per_producer; ++sent) {
+          queue.Push(sent);
+        }
+      }
+      if (running.fetch_sub(1) == 1) {
+        queue.Close();
+      }
+    });
+  }
+  for (int consumer = 0; consumer < consumers; ++consumer) {
+    threads.emplace_back([&queue] {
+      std::uint64_t sum = 0;
+      if constexpr (kBatched) {
+        std::uint64_t values[kBatch];
+        while (const std::size_t count = queue.PopBatch(values, kBatch)) {
+          for (std::size_t index = 0; index < count; ++index) {
+            sum += values[index];
+          }
+        }
+      } else {
+        std::uint64_t value = 0;
+        while (!queue.Pop(value)) {
+          sum += value;
+        }
+      }
+      benchmark::DoNotOptimize(sum);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+template <typename Queue, bool kBatched = false>
+void BM_Transfer(benchmark::State& state) {
+  const auto producers = static_cast<int>(state.range(0));
+  const auto consumers = static_cast<int>(state.range(1));
+  for (auto _ : state) {
+    Transfer<Queue, kBatched>(producers, consumers);
+  }
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) *
+                          static_cast<std::int64_t>(kItems));
+}
+
+void SingleProducerSingleConsumer(benchmark::internal::Benchmark* benchmark) {
+  benchmark->Args({1, 1})->UseRealTime()->Unit(benchmark::kMillisecond);
+}
+
+void ProducerConsumerMatrix(benchmark::internal::Benchmark* benchmark) {
+  for (const int producers : {1, 2, 4, 8}) {
+    for (const int consumers : {1, 2, 4, 8}) {
+      benchmark->Args({producers, consumers});
+    }
+  }
+  benchmark->ArgNames({"producers", "consumers"})->UseRealTime()->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK_TEMPLATE(BM_Transfer, comm::SpscQueue<std::uint64_t>)
+    ->Apply(SingleProducerSingleConsumer);
+BENCHMARK_TEMPLATE(BM_Transfer, comm::SpscQueue<std::uint64_t>, true)
+    ->Apply(SingleProducerSingleConsumer);
+BENCHMARK_TEMPLATE(BM_Transfer, comm::MpmcQueue<std::uint64_t>)->Apply(ProducerConsumerMatrix);
+BENCHMARK_TEMPLATE(BM_Transfer, comm::MpmcQueue<std::uint64_t>, true)
+    ->Apply(ProducerConsumerMatrix);
+BENCHMARK_TEMPLATE(BM_Transfer, MutexQueue)->Apply(ProducerConsumerMatrix);
+
+/// Uncontended cost of one push and one pop on the same thread
+template <typename Queue>
+void BM_PushPopSameThread(benchmark::State& state) {
+  Queue queue(kCapacity);
+  std::uint64_t value = 0;
+  for (auto _ : state) {
+    queue.Push(value);
+    queue.Pop(value);
+    benchmark::DoNotOptimize(value);
+  }
+}
+BENCHMARK_TEMPLATE(BM_PushPopSameThread, comm::SpscQueue<std::uint64_t>);
+BENCHMARK_TEMPLATE(BM_PushPopSameThread, comm::MpmcQueue<std::uint64_t>);
+BENCHMARK_TEMPLATE(BM_PushPopSameThread, MutexQueue);
+
+/// Policies of BM_WakeLatency, selected by its first argument
+const comm::WaitPolicy kWaitPolicies[] = {
+    comm::WaitPolicy::Tradeoff(0.0),  // park at once
+    comm::WaitPolicy::Tradeoff(0.5),  // default
+    comm::WaitPolicy::Tradeoff(1.0),
+    comm::WaitPolicy::BusyPoll(),
+};
+
+/**
+ * Round trips through two one-slot queues: the echo thread waits in Pop()
+ * and answers each ping. Only the round trip is timed, after idle
+ * microseconds in which the echo thread goes from spinning to parked (if its
+ * policy parks), so the result is two wake-ups of a waiter that was idle.
+ */
+template <typename Queue>
+void PingPong(benchmark::State& state, Queue& ping, Queue& pong, std::chrono::microseconds idle) {
+  std::thread echo([&ping, &pong] {
+    std::uint64_t value = 0;
+    while (!ping.Pop(value)) {
+      pong.Push(value + 1);
+    }
+  });
+  std::uint64_t value = 0;
+  for (auto _ : state) {
+    if (idle.count() > 0) {
+      std::this_thread::sleep_for(idle);
+    }
+    const auto start = std::chrono::steady_clock::now();
+    ping.Push(value);
+    pong.Pop(value);
+    state.SetIterationTime(
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+  }
+  ping.Close();
+  echo.join();
+  benchmark::DoNotOptimize(value);
+}
+
+void BM_WakeLatency(benchmark::State& state) {
+  const comm::WaitPolicy& policy = kWaitPolicies[state.range(0)];
+  comm::SpscQueue<std::uint64_t> ping(2, policy);
+  comm::SpscQueue<std::uint64_t> pong(2, policy);
+  PingPong(state, ping, pong, std::chrono::microseconds(state.range(1)));
+  const comm::WaitStats stats = ping.PopWaitStats();
+  state.counters["parked"] = benchmark::Counter(
+      static_cast<double>(stats.parks) / static_cast<double>(state.iterations()));
+}
+BENCHMARK(BM_WakeLatency)
+    ->ArgsProduct({{0, 1, 2, 3}, {0, 200}})
+    ->ArgNames({"policy", "idle_us"})
+    ->UseManualTime()
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_WakeLatencyCondVar(benchmark::State& state) {
+  MutexQueue ping(2);
+  MutexQueue pong(2);
+  PingPong(state, ping, pong, std::chrono::microseconds(state.range(0)));
+}
+BENCHMARK(BM_WakeLatencyCondVar)
+    ->Arg(0)
+    ->Arg(200)
+    ->ArgName("idle_us")
+    ->UseManualTime()
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
@@ -0,0 +1,274 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_mpmc_queue.h
+ * @brief Bounded multi-producer multi-consumer ring buffer
+ * @details Dmitry Vyukov's bounded MPMC queue: every slot carries a sequence
+ *          number telling whose turn it is (the producer of lap n or the
+ *          consumer of lap n), so producers and consumers only contend on
+ *          one compare-and-swap of the tail or head index. Slots are padded
+ *          to a cache line so that neighbouring producers and consumers do
+ *          not false-share. Batches claim several consecutive slots with a
+ *          single compare-and-swap.
+ *
+ * @code
+ * comm::MpmcQueue<Job> jobs(4096);
+ * jobs.Push(Job{...});                          // any number of producers
+ * Job job;
+ * while (!jobs.Pop(job)) { Run(job); }          // any number of consumers
+ * @endcode
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <system_error>
+#include <utility>
+
+#include "comm_queue.h"
+
+namespace comm {
+
+/**
+ * @class MpmcQueue
+ * @tparam T Element type; may be move-only, must be default-constructible
+ *           and move-assignable to be popped into an existing object
+ */
+template <typename T>
+class MpmcQueue {
+ public:
+  /**
+   * @param capacity Rounded up to a power of two
+   * @param wait How blocking Push()/Pop() wait for room or an element
+   */
+  explicit MpmcQueue(std::size_t capacity, WaitPolicy wait = {})
+      : m_capacity(detail::RoundUpCapacity(capacity)),
+        m_mask(m_capacity - 1),
+        m_slots(std::make_unique<Slot[]>(m_capacity)),
+        m_not_full(wait),
+        m_not_empty(wait) {
+    for (std::size_t index = 0; index < m_capacity; ++index) {
+      m_slots[index].sequence.store(index, std::memory_order_relaxed);
+    }
+  }
+
+  ~MpmcQueue() {
+    const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+    for (std::size_t head = m_head.load(std::memory_order_relaxed); head != tail; ++head) {
+      m_slots[head & m_mask].Item()->~T();
+    }
+  }
+
+  MpmcQueue(const MpmcQueue&) = delete;
+  MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+  /**
+   * @brief Construct an element in place if there is room
+   */
+  template <typename... Args>
+  bool TryEmplace(Args&&... args) {
+    std::size_t position = m_tail.load(std::memory_order_relaxed);
+    if (ClaimPositions(m_tail, position, 1, 0) == 0) {
+      return false;
+    }
+    Slot& slot = m_slots[position & m_mask];
+    ::new (static_cast<void*>(slot.storage)) T(std::forward<Args>(args)...);
+    slot.sequence.store(position + 1, std::memory_order_release);
+    m_not_empty.NotifyOne();
+    return true;
+  }
+
+  bool TryPush(T&& value) { return TryEmplace(std::move(value)); }
+  bool TryPush(const T& value) { return TryEmplace(value); }
+
+  /**
+   * @brief Move as many of count elements from first as fit into
+   *        consecutive slots
+   * @return Number of elements moved
+   */
+  template <typename Iterator>
+  std::size_t TryPushBatch(Iterator first, std::size_t count) {
+    std::size_t position = m_tail.load(std::memory_order_relaxed);
+    const std::size_t claimed = ClaimPositions(m_tail, position, count, 0);
+    for (std::size_t index = 0; index < claimed; ++index, ++first) {
+      Slot& slot = m_slots[(position + index) & m_mask];
+      ::new (static_cast<void*>(slot.storage)) T(std::move(*first));
+      slot.sequence.store(position + index + 1, std::memory_order_release);
+    }
+    if (claimed != 0) {
+      claimed == 1 ? m_not_empty.NotifyOne() : m_not_empty.NotifyAll();
+    }
+    return claimed;
+  }
+
+  /**
+   * @brief Take the oldest element if any
+   */
+  bool TryPop(T& out) { return TryPopBatch(&out, 1) == 1; }
+
+  /**
+   * @brief Move up to max_count consecutive elements to out
+   * @return Number of elements moved
+   */
+  std::size_t TryPopBatch(T* out, std::size_t max_count) {
+    std::size_t position = m_head.load(std::memory_order_relaxed);
+    const std::size_t claimed = ClaimPositions(m_head, position, max_count, 1);
+    for (std::size_t index = 0; index < claimed; ++index) {
+      Slot& slot = m_slots[(position + index) & m_mask];
+      T* item = slot.Item();
+      out[index] = std::move(*item);
+      item->~T();
+      // Free for the producer of the next lap
+      slot.sequence.store(position + index + m_capacity, std::memory_order_release);
+    }
+    if (claimed != 0) {
+      claimed == 1 ? m_not_full.NotifyOne() : m_not_full.NotifyAll();
+    }
+    return claimed;
+  }
+
+  /**
+   * @brief Push, waiting for room (see WaitPolicy)
+   * @return QueueError::Closed if the queue is closed
+   */
+  std::error_code Push(T value) {
+    return detail::BlockUntil(
+        m_not_full, [&] { return !IsClosed() && TryEmplace(std::move(value)); },
+        [this] { return IsClosed(); });
+  }
+
+  /**
+   * @brief Push all count elements from first, waiting for room as needed
+   * @return Number of elements pushed, less than count if the queue closed
+   */
+  template <typename Iterator>
+  std::size_t PushBatch(Iterator first, std::size_t count) {
+    std::size_t done = 0;
+    while (done < count) {
+      std::size_t moved = 0;
+      const auto error = detail::BlockUntil(
+          m_not_full,
+          [&] { return !IsClosed() && (moved = TryPushBatch(first, count - done)) != 0; },
+          [this] { return IsClosed(); });
+      if (error) {
+        break;
+      }
+      std::advance(first, moved);
+      done += moved;
+    }
+    return done;
+  }
+
+  /**
+   * @brief Pop, waiting for an element (see WaitPolicy)
+   * @return QueueError::Closed once the queue is closed and drained
+   */
+  std::error_code Pop(T& out) {
+    return detail::BlockUntil(
+        m_not_empty, [&] { return TryPop(out); }, [this] { return IsClosed(); });
+  }
+
+  /**
+   * @brief Pop 1..max_count elements, waiting for the first one
+   * @return Number of elements moved, 0 once the queue is closed and drained
+   */
+  std::size_t PopBatch(T* out, std::size_t max_count) {
+    std::size_t taken = 0;
+    detail::BlockUntil(
+        m_not_empty, [&] { return (taken = TryPopBatch(out, max_count)) != 0; },
+        [this] { return IsClosed(); });
+    return taken;
+  }
+
+  /**
+   * @brief Reject further pushes and wake all waiters; pops drain the rest
+   * @note A push racing with Close() may still succeed
+   */
+  void Close() {
+    m_closed.store(true, std::memory_order_release);
+    m_not_empty.NotifyAll();
+    m_not_full.NotifyAll();
+  }
+
+  bool IsClosed() const { return m_closed.load(std::memory_order_acquire); }
+
+  /**
+   * @brief Number of claimed slots (a snapshot while others are active)
+   */
+  std::size_t Size() const {
+    const std::size_t head = m_head.load(std::memory_order_acquire);
+    const std::size_t tail = m_tail.load(std::memory_order_acquire);
+    return tail > head ? tail - head : 0;
+  }
+
+  std::size_t Capacity() const { return m_capacity; }
+
+  /// How blocking Pop()/PopBatch() calls waited for elements
+  WaitStats PopWaitStats() const { return m_not_empty.GetStats(); }
+
+  /// How blocking Push()/PushBatch() calls waited for room
+  WaitStats PushWaitStats() const { return m_not_full.GetStats(); }
+
+ private:
+  struct alignas(detail::kCacheLine) Slot {
+    std::atomic<std::size_t> sequence{0};
+    alignas(T) unsigned char storage[sizeof(T)];
+
+    T* Item() { return std::launder(reinterpret_cast<T*>(storage)); }
+  };
+
+  /**
+   * @brief Claim up to wanted consecutive positions starting at position
+   * @param index m_tail (producers, ready when sequence == position) or
+   *              m_head (consumers, ready when sequence == position + 1)
+   * @param position In: current index value; out: first claimed position
+   * @return Number of positions claimed, 0 if the first one is not ready
+   */
+  std::size_t ClaimPositions(std::atomic<std::size_t>& index, std::size_t& position,
+                             std::size_t wanted, std::size_t ready_offset) {
+    wanted = std::min(wanted, m_capacity);
+    while (true) {
+      std::size_t ready = 0;
+      while (ready < wanted) {
+        const std::size_t candidate = position + ready;
+        const std::size_t sequence =
+            m_slots[candidate & m_mask].sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<std::intptr_t>(sequence - (candidate + ready_offset));
+        if (difference != 0) {
+          if (ready == 0 && difference > 0) {
+            // Another thread claimed it meanwhile: start over from its index
+            position = index.load(std::memory_order_relaxed);
+            continue;
+          }
+          break;
+        }
+        ++ready;
+      }
+      if (ready == 0) {
+        return 0;  // full (producers) or empty (consumers)
+      }
+      if (index.compare_exchange_weak(position, position + ready, std::memory_order_relaxed)) {
+        return ready;
+      }
+    }
+  }
+
+  const std::size_t m_capacity;
+  const std::size_t m_mask;
+  const std::unique_ptr<Slot[]> m_slots;
+  std::atomic<bool> m_closed{false};
+
+  alignas(detail::kCacheLine) std::atomic<std::size_t> m_tail{0};
+  alignas(detail::kCacheLine) std::atomic<std::size_t> m_head{0};
+  alignas(detail::kCacheLine) WaitStrategy m_not_full;
+  alignas(detail::kCacheLine) WaitStrategy m_not_empty;
+};
+
+}  // namespace comm
@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_queue.h
+ * @brief Common parts of the bounded lock-free queues
+ * @details SpscQueue (comm_spsc_queue.h) and MpmcQueue (comm_mpmc_queue.h)
+ *          are fixed-capacity ring buffers. Their Try*() operations never
+ *          block; Push()/Pop() wait with a WaitStrategy (comm_wait.h): spin,
+ *          yield, then sleep on a futex until the queue changes or is closed.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <system_error>
+
+#include "comm_wait.h"
+
+namespace comm {
+
+/**
+ * @brief Error codes for Queue module operations
+ */
+enum class QueueError {
+  Success = 0,  ///< Operation completed successfully
+  Closed = 1,   ///< Queue closed (and, for pops, drained)
+};
+
+/**
+ * @brief Error category for Queue module errors
+ */
+class QueueErrorCategory : public std::error_category {
+ public:
+  const char* name() const noexcept override { return "comm_queue"; }
+  std::string message(int error_value) const override;
+};
+
+/**
+ * @brief Get the singleton instance of QueueErrorCategory
+ */
+const std::error_category& get_queue_error_category() noexcept;
+
+/**
+ * @brief Helper function to create std::error_code from QueueError
+ */
+inline std::error_code make_error_code(QueueError err) noexcept {
+  return {static_cast<int>(err), get_queue_error_category()};
+}
+
+namespace detail {
+
+/**
+ * @brief Retry attempt() until it succeeds or closed() holds, spinning first
+ * @return Empty error_code, or QueueError::Closed
+ */
+template <typename Attempt, typename IsClosed>
+std::error_code BlockUntil(WaitStrategy& event, Attempt&& attempt, IsClosed&& closed) {
+  bool done = false;
+  event.Wait([&] {
+    if (attempt()) {
+      done = true;
+      return true;
+    }
+    if (closed()) {
+      // Once more: an item pushed before Close() must still be popped
+      done = attempt();
+      return true;
+    }
+    return false;
+  });
+  return done ? std::error_code{} : make_error_code(QueueError::Closed);
+}
+
+/// Smallest power of two >= value (at least 2)
+constexpr std::size_t RoundUpCapacity(std::size_t value) {
+  std::size_t capacity = 2;
+  while (capacity < value) {
+    capacity <<= 1;
+  }
+  return capacity;
+}
+
+}  // namespace detail
+
+}  // namespace comm
+
+namespace std {
+template <>
+struct is_error_code_enum<comm::QueueError> : true_type {};
+}  // namespace std
@@ -0,0 +1,244 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_spsc_queue.h
+ * @brief Bounded single-producer single-consumer ring buffer
+ * @details The producer owns the tail index, the consumer the head index;
+ *          each lives on its own cache line next to a cached copy of the
+ *          other side's index, so the shared lines are only touched when
+ *          the cached view says the queue looks full (or empty). Slots are
+ *          packed: with one writer and one reader they only share a line
+ *          when the queue is nearly empty, and packed slots keep batches
+ *          contiguous.
+ *
+ * @code
+ * comm::SpscQueue<Record> queue(1024);
+ * // producer thread                  // consumer thread
+ * queue.Push(std::move(record));      Record record;
+ * queue.Close();                      while (!queue.Pop(record)) { Write(record); }
+ * @endcode
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <system_error>
+#include <utility>
+
+#include "comm_queue.h"
+
+namespace comm {
+
+/**
+ * @class SpscQueue
+ * @tparam T Element type; may be move-only, must be default-constructible
+ *           and move-assignable to be popped into an existing object
+ * @note Exactly one thread pushes and one thread pops at a time
+ */
+template <typename T>
+class SpscQueue {
+ public:
+  /**
+   * @param capacity Rounded up to a power of two
+   * @param wait How blocking Push()/Pop() wait for room or an element
+   */
+  explicit SpscQueue(std::size_t capacity, WaitPolicy wait = {})
+      : m_capacity(detail::RoundUpCapacity(capacity)),
+        m_mask(m_capacity - 1),
+        m_slots(std::make_unique_for_overwrite<Slot[]>(m_capacity)),
+        m_not_full(wait),
+        m_not_empty(wait) {}
+
+  ~SpscQueue() {
+    const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+    for (std::size_t head = m_head.load(std::memory_order_relaxed); head != tail; ++head) {
+      Item(head)->~T();
+    }
+  }
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  /**
+   * @brief Construct an element in place if there is room (producer)
+   */
+  template <typename... Args>
+  bool TryEmplace(Args&&... args) {
+    const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_cached_head == m_capacity) {
+      m_cached_head = m_head.load(std::memory_order_acquire);
+      if (tail - m_cached_head == m_capacity) {
+        return false;
+      }
+    }
+    ::new (static_cast<void*>(&m_slots[tail & m_mask])) T(std::forward<Args>(args)...);
+    m_tail.store(tail + 1, std::memory_order_release);
+    m_not_empty.NotifyOne();
+    return true;
+  }
+
+  bool TryPush(T&& value) { return TryEmplace(std::move(value)); }
+  bool TryPush(const T& value) { return TryEmplace(value); }
+
+  /**
+   * @brief Move as many of count elements from first as fit (producer)
+   * @return Number of elements moved; one release store and one notify
+   */
+  template <typename Iterator>
+  std::size_t TryPushBatch(Iterator first, std::size_t count) {
+    const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (m_capacity - (tail - m_cached_head) < count) {
+      m_cached_head = m_head.load(std::memory_order_acquire);
+    }
+    const std::size_t accepted = std::min(count, m_capacity - (tail - m_cached_head));
+    for (std::size_t index = 0; index < accepted; ++index, ++first) {
+      ::new (static_cast<void*>(&m_slots[(tail + index) & m_mask])) T(std::move(*first));
+    }
+    if (accepted != 0) {
+      m_tail.store(tail + accepted, std::memory_order_release);
+      m_not_empty.NotifyOne();
+    }
+    return accepted;
+  }
+
+  /**
+   * @brief Take the oldest element if any (consumer)
+   */
+  bool TryPop(T& out) { return TryPopBatch(&out, 1) == 1; }
+
+  /**
+   * @brief Move up to max_count elements to out (consumer)
+   * @return Number of elements moved
+   */
+  std::size_t TryPopBatch(T* out, std::size_t max_count) {
+    const std::size_t head = m_head.load(std::memory_order_relaxed);
+    if (m_cached_tail - head < max_count) {
+      m_cached_tail = m_tail.load(std::memory_order_acquire);
+    }
+    const std::size_t taken = std::min(max_count, m_cached_tail - head);
+    for (std::size_t index = 0; index < taken; ++index) {
+      T* item = Item(head + index);
+      out[index] = std::move(*item);
+      item->~T();
+    }
+    if (taken != 0) {
+      m_head.store(head + taken, std::memory_order_release);
+      m_not_full.NotifyOne();
+    }
+    return taken;
+  }
+
+  /**
+   * @brief Push, waiting for room (see WaitPolicy)
+   * @return QueueError::Closed if the queue is closed
+   */
+  std::error_code Push(T value) {
+    return detail::BlockUntil(
+        m_not_full, [&] { return !IsClosed() && TryEmplace(std::move(value)); },
+        [this] { return IsClosed(); });
+  }
+
+  /**
+   * @brief Push all count elements from first, waiting for room as needed
+   * @return Number of elements pushed, less than count if the queue closed
+   */
+  template <typename Iterator>
+  std::size_t PushBatch(Iterator first, std::size_t count) {
+    std::size_t done = 0;
+    while (done < count) {
+      std::size_t moved = 0;
+      const auto error = detail::BlockUntil(
+          m_not_full,
+          [&] { return !IsClosed() && (moved = TryPushBatch(first, count - done)) != 0; },
+          [this] { return IsClosed(); });
+      if (error) {
+        break;
+      }
+      std::advance(first, moved);
+      done += moved;
+    }
+    return done;
+  }
+
+  /**
+   * @brief Pop, waiting for an element (see WaitPolicy)
+   * @return QueueError::Closed once the queue is closed and drained
+   */
+  std::error_code Pop(T& out) {
+    return detail::BlockUntil(
+        m_not_empty, [&] { return TryPop(out); }, [this] { return IsClosed(); });
+  }
+
+  /**
+   * @brief Pop 1..max_count elements, waiting for the first one
+   * @return Number of elements moved, 0 once the queue is closed and drained
+   */
+  std::size_t PopBatch(T* out, std::size_t max_count) {
+    std::size_t taken = 0;
+    detail::BlockUntil(
+        m_not_empty, [&] { return (taken = TryPopBatch(out, max_count)) != 0; },
+        [this] { return IsClosed(); });
+    return taken;
+  }
+
+  /**
+   * @brief Reject further pushes and wake all waiters; pops drain the rest
+   */
+  void Close() {
+    m_closed.store(true, std::memory_order_release);
+    m_not_empty.NotifyAll();
+    m_not_full.NotifyAll();
+  }
+
+  bool IsClosed() const { return m_closed.load(std::memory_order_acquire); }
+
+  /**
+   * @brief Number of elements (a snapshot while the other side is active)
+   */
+  std::size_t Size() const {
+    const std::size_t head = m_head.load(std::memory_order_acquire);
+    return m_tail.load(std::memory_order_acquire) - head;
+  }
+
+  std::size_t Capacity() const { return m_capacity; }
+
+  /// How blocking Pop()/PopBatch() calls waited for elements
+  WaitStats PopWaitStats() const { return m_not_empty.GetStats(); }
+
+  /// How blocking Push()/PushBatch() calls waited for room
+  WaitStats PushWaitStats() const { return m_not_full.GetStats(); }
+
+ private:
+  struct Slot {
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+
+  T* Item(std::size_t position) {
+    return std::launder(reinterpret_cast<T*>(m_slots[position & m_mask].storage));
+  }
+
+  const std::size_t m_capacity;
+  const std::size_t m_mask;
+  const std::unique_ptr<Slot[]> m_slots;
+  std::atomic<bool> m_closed{false};
+
+  /// Producer side: written by the producer, read by the consumer
+  alignas(detail::kCacheLine) std::atomic<std::size_t> m_tail{0};
+  std::size_t m_cached_head{0};
+
+  /// Consumer side
+  alignas(detail::kCacheLine) std::atomic<std::size_t> m_head{0};
+  std::size_t m_cached_tail{0};
+
+  /// Checked on every push/pop, written only by sleepers: lines of their own
+  alignas(detail::kCacheLine) WaitStrategy m_not_full;
+  alignas(detail::kCacheLine) WaitStrategy m_not_empty;
+};
+
+}  // namespace comm
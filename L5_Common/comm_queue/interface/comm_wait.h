@@ -0,0 +1,248 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_wait.h
+ * @brief Adaptive spin, yield and park waiting for lock-free hand-offs
+ * @details A WaitStrategy waits for a condition in three phases: a busy
+ *          spin with the CPU's pause hint (wakes in tens of nanoseconds),
+ *          sched_yield() (lets other threads run on this core) and parking
+ *          on a futex (costs nothing while idle, but a wake-up goes through
+ *          the scheduler, typically several microseconds). WaitPolicy sets
+ *          the length of each phase; WaitPolicy::Tradeoff() derives them
+ *          from one latency/CPU knob. An adaptive strategy halves its spin
+ *          phase whenever a wait outlasts it and doubles it back when waits
+ *          end while spinning, so rarely signaled waits, and waits whose
+ *          waker needs the same CPU, stop burning cycles while busy
+ *          hand-offs between cores keep their fast path.
+ *
+ * @code
+ * comm::WaitStrategy ready_event(comm::WaitPolicy::Tradeoff(0.8));
+ *
+ * // Consumer
+ * ready_event.Wait([&] { return flag.load(std::memory_order_acquire); });
+ *
+ * // Producer
+ * flag.store(true, std::memory_order_release);
+ * ready_event.NotifyOne();
+ * @endcode
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace comm {
+
+/**
+ * @brief Phase lengths of a WaitStrategy
+ */
+struct WaitPolicy {
+  std::uint32_t spins = 64;   ///< Condition checks with a pause hint in between
+  std::uint32_t yields = 64;  ///< Condition checks with sched_yield() in between
+  bool park = true;           ///< Sleep on a futex after the yields (false: keep yielding)
+  bool adaptive = true;       ///< Shorten spinning while waits outlast it
+
+  bool operator==(const WaitPolicy&) const = default;
+
+  /**
+   * @brief Policy for a point on the latency/CPU scale
+   * @param latency 0 parks at once (least CPU), 0.5 is the default policy,
+   *                1 spins 4096 times and yields 256 times before parking
+   */
+  static WaitPolicy Tradeoff(double latency) {
+    if (!(latency > 0.0)) {
+      return {0, 0, true, false};
+    }
+    const auto spins = static_cast<std::uint32_t>(std::exp2(12.0 * std::min(latency, 1.0)));
+    return {spins, std::min<std::uint32_t>(spins, 256), true, true};
+  }
+
+  /// Never sleeps: for a thread owning a core and waiting for sub-microsecond hand-offs
+  static WaitPolicy BusyPoll() { return {4096, 0, false, false}; }
+};
+
+/**
+ * @brief Counters reported by WaitStrategy::GetStats()
+ */
+struct WaitStats {
+  std::uint64_t spin_wakes{0};   ///< Waits that ended while spinning
+  std::uint64_t yield_wakes{0};  ///< Waits that ended while yielding
+  std::uint64_t parks{0};        ///< Waits that slept on the futex
+};
+
+namespace detail {
+
+/// Cache line size assumed for padding (x86-64 and most aarch64 cores)
+constexpr std::size_t kCacheLine = 64;
+
+inline void CpuRelax() noexcept {
+#if defined(__x86_64__)
+  _mm_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+/**
+ * @class EventCount
+ * @brief Lets threads sleep until a condition may have changed
+ * @details The waiter announces itself, re-checks its condition and sleeps
+ *          on the epoch; the notifier publishes its change, then bumps the
+ *          epoch only if someone announced. The seq_cst fences pair up so
+ *          that either the notifier sees the waiter or the waiter sees the
+ *          change, which keeps Notify() to a fence and a load when nobody
+ *          sleeps.
+ */
+class EventCount {
+ public:
+  std::uint32_t PrepareWait() noexcept {
+    m_waiters.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return m_epoch.load(std::memory_order_acquire);
+  }
+
+  void CancelWait() noexcept { m_waiters.fetch_sub(1, std::memory_order_relaxed); }
+
+  void Wait(std::uint32_t epoch) noexcept {
+    m_epoch.wait(epoch, std::memory_order_acquire);
+    m_waiters.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  void NotifyOne() noexcept { Notify(false); }
+  void NotifyAll() noexcept { Notify(true); }
+
+ private:
+  void Notify(bool all) noexcept {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_waiters.load(std::memory_order_relaxed) == 0) {
+      return;
+    }
+    m_epoch.fetch_add(1, std::memory_order_release);
+    if (all) {
+      m_epoch.notify_all();
+    } else {
+      m_epoch.notify_one();
+    }
+  }
+
+  std::atomic<std::uint32_t> m_epoch{0};
+  std::atomic<std::uint32_t> m_waiters{0};
+};
+
+}  // namespace detail
+
+/**
+ * @class WaitStrategy
+ * @brief Spin, then yield, then park until a condition holds
+ * @details Any number of threads may wait; the side making the condition
+ *          true calls NotifyOne()/NotifyAll() afterwards, which costs a
+ *          fence and a load when nobody is parked.
+ */
+class WaitStrategy {
+ public:
+  explicit WaitStrategy(WaitPolicy policy = {}) noexcept
+      : m_policy(policy), m_spin_budget(policy.spins) {}
+
+  WaitStrategy(const WaitStrategy&) = delete;
+  WaitStrategy& operator=(const WaitStrategy&) = delete;
+
+  /**
+   * @brief Return once ready() returned true
+   * @param ready Checked before every pause, yield and sleep; it may have
+   *              side effects (e.g. try to pop) and is not called again
+   *              after returning true
+   */
+  template <typename Ready>
+  void Wait(Ready&& ready) {
+    // Not a wait yet: no accounting on the fast path
+    if (ready()) {
+      return;
+    }
+    const std::uint32_t spins = SpinBudget();
+    for (std::uint32_t spin = 0; spin < spins; ++spin) {
+      if (ready()) {
+        m_spin_wakes.fetch_add(1, std::memory_order_relaxed);
+        Adapt(std::min(m_policy.spins, spins * 2 + 1));
+        return;
+      }
+      detail::CpuRelax();
+    }
+    // Spinning did not pay off from here on
+    for (std::uint32_t yield = 0; !m_policy.park || yield < m_policy.yields; ++yield) {
+      if (ready()) {
+        m_yield_wakes.fetch_add(1, std::memory_order_relaxed);
+        Adapt(spins / 2);
+        return;
+      }
+      std::this_thread::yield();
+    }
+    bool slept = false;
+    while (true) {
+      const std::uint32_t epoch = m_event.PrepareWait();
+      if (ready()) {
+        m_event.CancelWait();
+        break;
+      }
+      m_event.Wait(epoch);
+      slept = true;
+    }
+    (slept ? m_parks : m_yield_wakes).fetch_add(1, std::memory_order_relaxed);
+    Adapt(spins / 2);
+  }
+
+  /// Wake one parked waiter (after making the condition true)
+  void NotifyOne() noexcept { m_event.NotifyOne(); }
+
+  /// Wake all parked waiters (after making the condition true)
+  void NotifyAll() noexcept { m_event.NotifyAll(); }
+
+  const WaitPolicy& Policy() const { return m_policy; }
+
+  /// Pause checks the next wait starts with (policy.spins unless adapted)
+  std::uint32_t SpinBudget() const {
+    return m_policy.adaptive ? m_spin_budget.load(std::memory_order_relaxed) : m_policy.spins;
+  }
+
+  WaitStats GetStats() const {
+    WaitStats stats;
+    stats.spin_wakes = m_spin_wakes.load(std::memory_order_relaxed);
+    stats.yield_wakes = m_yield_wakes.load(std::memory_order_relaxed);
+    stats.parks = m_parks.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+ private:
+  /// Spins never adapted away, so that a budget can grow back
+  static constexpr std::uint32_t kMinSpins = 4;
+
+  void Adapt(std::uint32_t spins) {
+    if (!m_policy.adaptive) {
+      return;
+    }
+    spins = std::max(spins, std::min(kMinSpins, m_policy.spins));
+    if (m_spin_budget.load(std::memory_order_relaxed) != spins) {
+      m_spin_budget.store(spins, std::memory_order_relaxed);
+    }
+  }
+
+  detail::EventCount m_event;
+  const WaitPolicy m_policy;
+  /// Spin phase length of an adaptive strategy; written by waiters only, so
+  /// kept off the line notifiers read (racy updates are fine)
+  alignas(detail::kCacheLine) std::atomic<std::uint32_t> m_spin_budget;
+  std::atomic<std::uint64_t> m_spin_wakes{0};
+  std::atomic<std::uint64_t> m_yield_wakes{0};
+  std::atomic<std::uint64_t> m_parks{0};
+};
+
+}  // namespace comm
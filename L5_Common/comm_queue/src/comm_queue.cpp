@@ -0,0 +1,30 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_queue.cpp
+ * @brief Error category of the queue module (the queues are header-only)
+ */
+
+#include "comm_queue.h"
+
+namespace comm {
+
+// Error category implementation
+std::string QueueErrorCategory::message(int error_value) const {
+  switch (static_cast<QueueError>(error_value)) {
+    case QueueError::Success:
+      return "Success";
+    case QueueError::Closed:
+      return "Queue is closed";
+    default:
+      return "Unknown queue error";
+  }
+}
+
+const std::error_category& get_queue_error_category() noexcept {
+  static QueueErrorCategory instance;
+  return instance;
+}
+
+}  // namespace comm
@@ -0,0 +1,301 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_queue_test.cpp
+ * @brief Unit tests for SpscQueue, MpmcQueue and WaitStrategy
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "comm_mpmc_queue.h"
+#include "comm_spsc_queue.h"
+#include "comm_wait.h"
+
+namespace comm {
+namespace {
+
+/// Counts live instances to catch leaked or double-destroyed elements
+struct Tracked {
+  static inline std::atomic<int> live{0};
+  int value{0};
+
+  Tracked() { live.fetch_add(1); }
+  explicit Tracked(int v) : value(v) { live.fetch_add(1); }
+  Tracked(Tracked&& other) noexcept : value(other.value) { live.fetch_add(1); }
+  Tracked& operator=(Tracked&& other) noexcept {
+    value = other.value;
+    return *this;
+  }
+  ~Tracked() { live.fetch_sub(1); }
+};
+
+/// Producers push 1..items each, consumers sum what they pop
+template <typename Queue>
+std::uint64_t Transfer(Queue& queue, int producers, int consumers, int items, bool batched) {
+  std::atomic<std::uint64_t> sum{0};
+  std::atomic<int> running_producers{producers};
+  std::vector<std::thread> threads;
+  for (int producer = 0; producer < producers; ++producer) {
+    threads.emplace_back([&queue, &running_producers, items, batched] {
+      if (batched) {
+        std::vector<std::uint64_t> batch;
+        for (int value = 1; value <= items; ++value) {
+          batch.push_back(static_cast<std::uint64_t>(value));
+          if (batch.size() == 16 || value == items) {
+            EXPECT_EQ(queue.PushBatch(batch.begin(), batch.size()), batch.size());
+            batch.clear();
+          }
+        }
+      } else {
+        for (int value = 1; value <= items; ++value) {
+          EXPECT_FALSE(queue.Push(static_cast<std::uint64_t>(value)));
+        }
+      }
+      if (running_producers.fetch_sub(1) == 1) {
+        queue.Close();
+      }
+    });
+  }
+  for (int consumer = 0; consumer < consumers; ++consumer) {
+    threads.emplace_back([&queue, &sum, batched] {
+      std::uint64_t local = 0;
+      std::uint64_t values[32];
+      if (batched) {
+        while (const std::size_t count = queue.PopBatch(values, 32)) {
+          local = std::accumulate(values, values + count, local);
+        }
+      } else {
+        while (!queue.Pop(values[0])) {
+          local += values[0];
+        }
+      }
+      sum.fetch_add(local);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return sum.load();
+}
+
+std::uint64_t Expected(int producers, int items) {
+  return static_cast<std::uint64_t>(producers) * items * (items + 1) / 2;
+}
+
+}  // namespace
+
+TEST(SpscQueueTest, KeepsOrderAcrossWrapAround) {
+  SpscQueue<int> queue(3);
+  EXPECT_EQ(queue.Capacity(), 4U);
+  int value = 0;
+  EXPECT_FALSE(queue.TryPop(value));
+  for (int round = 0; round < 10; ++round) {
+    for (int index = 0; index < 4; ++index) {
+      EXPECT_TRUE(queue.TryPush(round * 10 + index));
+    }
+    EXPECT_FALSE(queue.TryPush(-1));
+    EXPECT_EQ(queue.Size(), 4U);
+    for (int index = 0; index < 4; ++index) {
+      ASSERT_TRUE(queue.TryPop(value));
+      EXPECT_EQ(value, round * 10 + index);
+    }
+  }
+
+  // Batches stop at the capacity and come back in order
+  const std::vector<int> input = {1, 2, 3, 4, 5, 6};
+  EXPECT_EQ(queue.TryPushBatch(input.begin(), input.size()), 4U);
+  int output[8] = {};
+  EXPECT_EQ(queue.TryPopBatch(output, 8), 4U);
+  EXPECT_EQ(output[0], 1);
+  EXPECT_EQ(output[3], 4);
+}
+
+TEST(SpscQueueTest, DestroysMoveOnlyElements) {
+  {
+    SpscQueue<std::unique_ptr<Tracked>> queue(8);
+    EXPECT_TRUE(queue.TryEmplace(std::make_unique<Tracked>(1)));
+    EXPECT_TRUE(queue.TryPush(std::make_unique<Tracked>(2)));
+    std::unique_ptr<Tracked> out;
+    ASSERT_TRUE(queue.TryPop(out));
+    EXPECT_EQ(out->value, 1);
+    EXPECT_EQ(Tracked::live.load(), 2);
+  }
+  EXPECT_EQ(Tracked::live.load(), 0);
+}
+
+TEST(SpscQueueTest, BlockingTransferAndClose) {
+  SpscQueue<std::uint64_t> queue(64);
+  EXPECT_EQ(Transfer(queue, 1, 1, 200000, false), Expected(1, 200000));
+  SpscQueue<std::uint64_t> batched(64);
+  EXPECT_EQ(Transfer(batched, 1, 1, 200000, true), Expected(1, 200000));
+
+  // Closed: pushes are rejected, pops drain and then report Closed
+  SpscQueue<int> closed(4);
+  EXPECT_FALSE(closed.Push(1));
+  closed.Close();
+  EXPECT_EQ(closed.Push(2), QueueError::Closed);
+  int value = 0;
+  EXPECT_FALSE(closed.Pop(value));
+  EXPECT_EQ(value, 1);
+  EXPECT_EQ(closed.Pop(value), QueueError::Closed);
+}
+
+TEST(SpscQueueTest, SleepingConsumerIsWoken) {
+  SpscQueue<int> queue(4);
+  int value = 0;
+  std::thread consumer([&queue, &value] { EXPECT_FALSE(queue.Pop(value)); });
+  // Long enough for the consumer to give up spinning and wait on the futex
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_TRUE(queue.TryPush(42));
+  consumer.join();
+  EXPECT_EQ(value, 42);
+
+  // A producer waiting for room is woken by Close()
+  EXPECT_TRUE(queue.TryPush(1) && queue.TryPush(2) && queue.TryPush(3) && queue.TryPush(4));
+  std::thread producer([&queue] { EXPECT_EQ(queue.Push(5), QueueError::Closed); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  queue.Close();
+  producer.join();
+}
+
+TEST(MpmcQueueTest, KeepsFifoOrderAndDestroysElements) {
+  {
+    MpmcQueue<Tracked> queue(4);
+    for (int index = 0; index < 4; ++index) {
+      EXPECT_TRUE(queue.TryEmplace(index));
+    }
+    EXPECT_FALSE(queue.TryEmplace(4));
+    Tracked out;
+    for (int index = 0; index < 2; ++index) {
+      ASSERT_TRUE(queue.TryPop(out));
+      EXPECT_EQ(out.value, index);
+    }
+    std::vector<Tracked> input(3);
+    input[0].value = 10;
+    // Only two slots are free
+    EXPECT_EQ(queue.TryPushBatch(input.begin(), input.size()), 2U);
+    Tracked batch[8];
+    EXPECT_EQ(queue.TryPopBatch(batch, 8), 4U);
+    EXPECT_EQ(batch[0].value, 2);
+    EXPECT_EQ(batch[2].value, 10);
+    EXPECT_TRUE(queue.TryEmplace(7));
+  }
+  EXPECT_EQ(Tracked::live.load(), 0);
+}
+
+TEST(MpmcQueueTest, EveryItemIsDeliveredExactlyOnce) {
+  struct Case {
+    int producers;
+    int consumers;
+    bool batched;
+  };
+  for (const Case& test : {Case{1, 1, false}, Case{4, 1, false}, Case{1, 4, false},
+                           Case{4, 4, false}, Case{4, 4, true}, Case{2, 3, true}}) {
+    MpmcQueue<std::uint64_t> queue(128);
+    EXPECT_EQ(Transfer(queue, test.producers, test.consumers, 50000, test.batched),
+              Expected(test.producers, 50000))
+        << test.producers << " producers, " << test.consumers << " consumers"
+        << (test.batched ? ", batched" : "");
+    EXPECT_EQ(queue.Size(), 0U);
+  }
+}
+
+TEST(WaitStrategyTest, TradeoffSpansParkingToSpinning) {
+  const WaitPolicy park_at_once = WaitPolicy::Tradeoff(0.0);
+  EXPECT_EQ(park_at_once.spins, 0U);
+  EXPECT_EQ(park_at_once.yields, 0U);
+  EXPECT_TRUE(park_at_once.park);
+  EXPECT_EQ(WaitPolicy::Tradeoff(0.5), WaitPolicy{});
+  EXPECT_EQ(WaitPolicy::Tradeoff(1.0).spins, 4096U);
+  EXPECT_EQ(WaitPolicy::Tradeoff(7.0), WaitPolicy::Tradeoff(1.0));
+  EXPECT_LT(WaitPolicy::Tradeoff(0.25).spins, WaitPolicy::Tradeoff(0.75).spins);
+}
+
+TEST(WaitStrategyTest, ParkedWaiterIsWokenAndSpinningShrinks) {
+  WaitStrategy event(WaitPolicy{64, 0, true, true});
+  std::atomic<bool> ready{false};
+  std::atomic<std::uint32_t> checks{0};
+  for (int round = 0; round < 8; ++round) {
+    ready = false;
+    checks = 0;
+    const std::uint32_t spin_checks = 1 + event.SpinBudget();  // Fast path and spins
+    std::thread notifier([&] {
+      // Only once the waiter is past its spins, however it is scheduled
+      while (checks.load() <= spin_checks) {
+        std::this_thread::yield();
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      ready.store(true, std::memory_order_release);
+      event.NotifyOne();
+    });
+    event.Wait([&] {
+      checks.fetch_add(1);
+      return ready.load(std::memory_order_acquire);
+    });
+    notifier.join();
+  }
+  // Whether a wait then parks or sees ready on the check before sleeping
+  // depends on scheduling (one CPU, a loaded host)
+  const WaitStats stats = event.GetStats();
+  EXPECT_EQ(stats.spin_wakes, 0U);
+  EXPECT_EQ(stats.parks + stats.yield_wakes, 8U);
+  EXPECT_EQ(event.SpinBudget(), 4U);  // 64 halved down to the floor
+}
+
+TEST(WaitStrategyTest, SpinningGrowsBackWhenWaitsEndEarly) {
+  WaitStrategy event(WaitPolicy{8, 4, true, true});
+  const auto ready_on_check = [](int check) {
+    return [check, calls = 0]() mutable { return ++calls >= check; };
+  };
+  event.Wait(ready_on_check(1));  // fast path: not counted as a wait
+  EXPECT_EQ(event.GetStats().spin_wakes + event.GetStats().yield_wakes, 0U);
+
+  event.Wait(ready_on_check(3));
+  EXPECT_EQ(event.GetStats().spin_wakes, 1U);
+  EXPECT_EQ(event.SpinBudget(), 8U);
+
+  // 1 + 8 spins + 4 yields, then the check before parking succeeds
+  event.Wait(ready_on_check(14));
+  EXPECT_EQ(event.GetStats().yield_wakes, 1U);
+  EXPECT_EQ(event.GetStats().parks, 0U);
+  EXPECT_EQ(event.SpinBudget(), 4U);
+
+  event.Wait(ready_on_check(2));
+  EXPECT_EQ(event.SpinBudget(), 8U);
+
+  WaitStrategy fixed(WaitPolicy{8, 0, true, false});
+  // 1 + 8 spins, then the check before parking succeeds
+  fixed.Wait(ready_on_check(10));
+  EXPECT_EQ(fixed.SpinBudget(), 8U);  // not adaptive
+}
+
+TEST(WaitStrategyTest, QueuesTakeAWaitPolicy) {
+  constexpr std::uint64_t kItems = 10000;
+  for (const WaitPolicy& policy :
+       {WaitPolicy::Tradeoff(0.0), WaitPolicy::Tradeoff(1.0), WaitPolicy::BusyPoll()}) {
+    SpscQueue<std::uint64_t> queue(16, policy);
+    std::thread producer([&] {
+      for (std::uint64_t value = 1; value <= kItems; ++value) {
+        ASSERT_FALSE(queue.Push(value));
+      }
+      queue.Close();
+    });
+    std::uint64_t sum = 0;
+    std::uint64_t value = 0;
+    while (!queue.Pop(value)) {
+      sum += value;
+    }
+    producer.join();
+    EXPECT_EQ(sum, kItems * (kItems + 1) / 2);
+  }
+}
+
+}  // namespace comm
@@ -0,0 +1,88 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_ratelimit_benchmark.cpp
+ * @brief Cost of one admit check
+ * @details BM_Gcra/BM_TokenBucket check a single shared limiter from 1-8
+ *          threads (one contended atomic), BM_GcraCheckAt leaves out the
+ *          clock read, BM_Keyed* check one of a million client keys. The
+ *          limit is high enough that most checks pass.
+ *
+ * Usage: modu-core-comm_ratelimit_benchmark [--benchmark_filter=...]
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "comm_keyed_ratelimit.h"
+#include "comm_ratelimit.h"
+
+namespace {
+
+constexpr comm::RateLimit kOpenLimit{1e9, 1'000'000};
+
+void BM_Gcra(benchmark::State& state) {
+  static comm::Gcra limiter(kOpenLimit);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(limiter.TryAcquire());
+  }
+}
+BENCHMARK(BM_Gcra)->ThreadRange(1, 8)->UseRealTime();
+
+void BM_TokenBucket(benchmark::State& state) {
+  static comm::TokenBucket limiter(kOpenLimit);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(limiter.TryAcquire());
+  }
+}
+BENCHMARK(BM_TokenBucket)->ThreadRange(1, 8)->UseRealTime();
+
+/// Caller-supplied time: the limiter without the clock read
+void BM_GcraCheckAt(benchmark::State& state) {
+  static comm::Gcra limiter(kOpenLimit);
+  std::int64_t now_ns = comm::FastClock::NowNs();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(limiter.CheckAt(now_ns += 2));
+  }
+}
+BENCHMARK(BM_GcraCheckAt);
+
+/// Denied checks do not write: the cost of a limiter under overload
+void BM_GcraDenied(benchmark::State& state) {
+  static comm::Gcra limiter(comm::RateLimit{1e-3, 1});
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(limiter.TryAcquire());
+  }
+}
+BENCHMARK(BM_GcraDenied)->ThreadRange(1, 8)->UseRealTime();
+
+constexpr std::uint64_t kKeys = 1'000'000;
+
+void BM_KeyedInteger(benchmark::State& state) {
+  static comm::KeyedRateLimiter<std::uint64_t> limiter(kOpenLimit, {.max_keys = kKeys});
+  std::uint64_t key = static_cast<std::uint64_t>(state.thread_index()) * 7919;
+  for (auto _ : state) {
+    key = (key + 104729) % kKeys;
+    benchmark::DoNotOptimize(limiter.TryAcquire(key));
+  }
+}
+BENCHMARK(BM_KeyedInteger)->ThreadRange(1, 8)->UseRealTime();
+
+void BM_KeyedString(benchmark::State& state) {
+  static comm::KeyedRateLimiter<std::string> limiter(kOpenLimit, {.max_keys = kKeys});
+  std::vector<std::string> clients;
+  for (int index = 0; index < 4096; ++index) {
+    clients.push_back("client-" + std::to_string(index * 2654435761U % kKeys));
+  }
+  std::size_t next = static_cast<std::size_t>(state.thread_index()) * 512;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(limiter.TryAcquire(clients[next++ % clients.size()]));
+  }
+}
+BENCHMARK(BM_KeyedString)->ThreadRange(1, 8)->UseRealTime();
+
+}  // namespace
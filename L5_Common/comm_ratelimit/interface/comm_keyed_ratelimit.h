@@ -0,0 +1,197 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_keyed_ratelimit.h
+ * @brief GCRA limit per key (client, peer, tenant) for large key sets
+ * @details Keys are spread over cache-line aligned shards, each a small
+ *          mutex and a hash map from key to GCRA theoretical arrival time,
+ *          so threads checking different keys rarely meet. A key whose TAT
+ *          lies in the past has its full burst again and is indistinguishable
+ *          from a new key: such entries are dropped when a shard fills up.
+ *          Only when that does not free enough room is the entry closest to
+ *          rest among a few random ones evicted, which grants that key a
+ *          fresh burst.
+ *
+ * @code
+ * comm::KeyedRateLimiter<std::string> m_per_client{
+ *     comm::RateLimits::Instance().Params("per_client", {50, 10}), {.max_keys = 4'000'000}};
+ *
+ * if (!m_per_client.TryAcquire(client_id)) {
+ *   return TooManyRequests();
+ * }
+ * @endcode
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "comm_ratelimit.h"
+
+namespace comm {
+
+/**
+ * @class KeyedRateLimiter
+ * @brief Independent GCRA limiters sharing one limit, created on first use
+ * @tparam Key Hashable key type
+ */
+template <typename Key, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class KeyedRateLimiter {
+ public:
+  struct Options {
+    /// Keys kept before eviction starts (split evenly over the shards)
+    std::size_t max_keys = 1'000'000;
+    /// Rounded up to a power of two
+    std::size_t shards = 64;
+  };
+
+  explicit KeyedRateLimiter(RateLimit limit, Options options = {})
+      : KeyedRateLimiter(std::make_shared<RateLimitParams>(limit), options) {}
+
+  KeyedRateLimiter(std::shared_ptr<RateLimitParams> params, Options options = {})
+      : m_params(std::move(params)),
+        m_shard_count(std::bit_ceil(std::max<std::size_t>(options.shards, 1))),
+        m_shard_capacity(std::max<std::size_t>(options.max_keys / m_shard_count, 1)),
+        m_shards(std::make_unique<Shard[]>(m_shard_count)) {}
+
+  KeyedRateLimiter(const KeyedRateLimiter&) = delete;
+  KeyedRateLimiter& operator=(const KeyedRateLimiter&) = delete;
+
+  bool TryAcquire(const Key& key, std::uint32_t cost = 1) {
+    return CheckAt(key, FastClock::NowNs(), cost).allowed;
+  }
+
+  RateDecision Check(const Key& key, std::uint32_t cost = 1) {
+    return CheckAt(key, FastClock::NowNs(), cost);
+  }
+
+  RateDecision CheckAt(const Key& key, std::int64_t now_ns, std::uint32_t cost = 1) {
+    const std::uint64_t params = m_params->Load();
+    Shard& shard = ShardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    if (auto found = shard.tats.find(key); found != shard.tats.end()) {
+      return GcraAdmit(params, now_ns, cost, found->second);
+    }
+    std::int64_t tat = 0;
+    const RateDecision decision = GcraAdmit(params, now_ns, cost, tat);
+    if (decision) {
+      // Denied new keys stay unknown: they have nothing to remember
+      if (shard.tats.size() >= m_shard_capacity) {
+        MakeRoom(shard, now_ns);
+      }
+      shard.tats.emplace(key, tat);
+    }
+    return decision;
+  }
+
+  /// Drop the state of key (its full burst is available again)
+  void Forget(const Key& key) {
+    Shard& shard = ShardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.tats.erase(key);
+  }
+
+  /// Keys currently tracked
+  std::size_t Size() const {
+    std::size_t size = 0;
+    for (std::size_t index = 0; index < m_shard_count; ++index) {
+      std::lock_guard<std::mutex> lock(m_shards[index].mutex);
+      size += m_shards[index].tats.size();
+    }
+    return size;
+  }
+
+  /// Keys dropped before they were back at rest
+  std::uint64_t Evictions() const { return m_evictions.load(std::memory_order_relaxed); }
+
+  RateLimitParams& Params() const noexcept { return *m_params; }
+
+ private:
+  /// Entries compared when nothing is at rest (as in sampled LRU)
+  static constexpr int kEvictionSample = 8;
+  /// Buckets looked at to find them; most are filled at a full shard
+  static constexpr int kEvictionProbes = 8 * kEvictionSample;
+
+  struct alignas(64) Shard {
+    mutable std::mutex mutex;
+    std::unordered_map<Key, std::int64_t, Hash, KeyEqual> tats;
+    /// Sweeping before this time would free too little to be worth it
+    std::int64_t next_sweep_ns = INT64_MIN;
+    /// xorshift64 state choosing the buckets sampled for eviction
+    std::uint64_t sample_state = 0x9E3779B97F4A7C15ULL;
+  };
+
+  Shard& ShardFor(const Key& key) const {
+    // Fibonacci hashing: the map uses the low bits of the same hash
+    const std::uint64_t hash = static_cast<std::uint64_t>(Hash{}(key)) * 0x9E3779B97F4A7C15ULL;
+    return m_shards[(hash >> 32) & (m_shard_count - 1)];
+  }
+
+  void MakeRoom(Shard& shard, std::int64_t now_ns) {
+    if (now_ns >= shard.next_sweep_ns) {
+      std::vector<std::int64_t> remaining;
+      for (auto entry = shard.tats.begin(); entry != shard.tats.end();) {
+        if (entry->second <= now_ns) {
+          entry = shard.tats.erase(entry);
+        } else {
+          remaining.push_back(entry->second);
+          ++entry;
+        }
+      }
+      // Sweep again once an eighth of the shard is at rest, so sweeps cost
+      // O(1) per inserted key; sampled eviction covers the time in between
+      shard.next_sweep_ns = INT64_MAX;
+      if (!remaining.empty()) {
+        const auto eighth = remaining.begin() + static_cast<std::ptrdiff_t>(remaining.size() / 8);
+        std::nth_element(remaining.begin(), eighth, remaining.end());
+        shard.next_sweep_ns = *eighth;
+      }
+    }
+    if (shard.tats.size() < m_shard_capacity) {
+      return;
+    }
+    // Sample random buckets: iteration order follows insertion, so the
+    // first entries of the map are its newest keys, not a fair sample
+    const Key* victim = nullptr;
+    std::int64_t victim_tat = INT64_MAX;
+    for (int probe = 0, sampled = 0; probe < kEvictionProbes && sampled < kEvictionSample;
+         ++probe) {
+      shard.sample_state ^= shard.sample_state << 13;
+      shard.sample_state ^= shard.sample_state >> 7;
+      shard.sample_state ^= shard.sample_state << 17;
+      const std::size_t bucket = shard.sample_state % shard.tats.bucket_count();
+      const auto entry = shard.tats.begin(bucket);
+      if (entry == shard.tats.end(bucket)) {
+        continue;  // Empty bucket
+      }
+      ++sampled;
+      if (victim == nullptr || entry->second < victim_tat) {
+        victim = &entry->first;
+        victim_tat = entry->second;
+      }
+    }
+    const auto evicted = victim != nullptr ? shard.tats.find(*victim) : shard.tats.begin();
+    if (evicted->second > now_ns) {
+      m_evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+    shard.tats.erase(evicted);
+  }
+
+  std::shared_ptr<RateLimitParams> m_params;
+  const std::size_t m_shard_count;
+  const std::size_t m_shard_capacity;
+  std::unique_ptr<Shard[]> m_shards;
+  std::atomic<std::uint64_t> m_evictions{0};
+};
+
+}  // namespace comm
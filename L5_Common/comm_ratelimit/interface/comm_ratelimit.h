@@ -0,0 +1,214 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_ratelimit.h
+ * @brief Lock-free token bucket and GCRA rate limiters
+ * @details Both limiters keep their whole state in one atomic time stamp and
+ *          admit with a single compare-and-swap on FastClock time; limits
+ *          live in a RateLimitParams word that can be shared by many
+ *          limiters and replaced at run time (e.g. from RateLimits on a
+ *          configuration reload) without stopping them.
+ *
+ * @code
+ * comm::Gcra m_outbound{comm::RateLimits::Instance().Params("outbound_api", {100, 20})};
+ *
+ * if (auto decision = m_outbound.Check(); !decision) {
+ *   return Busy(decision.retry_after);
+ * }
+ * @endcode
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "comm_clock.h"
+#include "comm_flat_map.h"
+#include "comm_symbol.h"
+
+namespace comm {
+
+/**
+ * @brief Sustained rate and burst of a limiter
+ * @details per_second <= 0 admits nothing. The interval between tokens is
+ *          kept in whole nanoseconds (at most ~18 minutes) and the burst is
+ *          capped at 16,777,215.
+ */
+struct RateLimit {
+  double per_second = 0;
+  std::uint32_t burst = 1;
+
+  bool operator==(const RateLimit&) const = default;
+};
+
+/**
+ * @class RateLimitParams
+ * @brief RateLimit packed into one atomic word: 40-bit interval, 24-bit burst
+ * @details Readers never see an interval of one limit with the burst of
+ *          another; Set() takes effect on the next admit check.
+ */
+class RateLimitParams {
+ public:
+  explicit RateLimitParams(RateLimit limit) noexcept { Set(limit); }
+
+  RateLimitParams(const RateLimitParams&) = delete;
+  RateLimitParams& operator=(const RateLimitParams&) = delete;
+
+  void Set(RateLimit limit) noexcept;
+  RateLimit Get() const noexcept;
+
+  /// Nanoseconds per token, 0 when nothing is admitted
+  static std::int64_t IntervalNs(std::uint64_t word) noexcept {
+    return static_cast<std::int64_t>(word >> kBurstBits);
+  }
+  static std::int64_t Burst(std::uint64_t word) noexcept {
+    return static_cast<std::int64_t>(word & kBurstMask);
+  }
+  std::uint64_t Load() const noexcept { return m_word.load(std::memory_order_relaxed); }
+
+  static constexpr int kBurstBits = 24;
+  static constexpr std::uint64_t kBurstMask = (std::uint64_t{1} << kBurstBits) - 1;
+  static constexpr std::int64_t kMaxIntervalNs = (std::int64_t{1} << (64 - kBurstBits)) - 1;
+
+ private:
+  std::atomic<std::uint64_t> m_word{0};
+};
+
+/**
+ * @brief Outcome of Gcra::Check()
+ */
+struct RateDecision {
+  bool allowed = false;
+  /// When denied: wait at least this long before the same request can pass
+  std::chrono::nanoseconds retry_after{0};
+
+  explicit operator bool() const noexcept { return allowed; }
+};
+
+/**
+ * @class TokenBucket
+ * @brief Bucket of up to burst tokens refilled at per_second
+ * @details State is the time at which the bucket was empty: tokens available
+ *          at now are (now - empty_at) / interval, capped at burst. Starts
+ *          full. Thread-safe and lock-free.
+ */
+class TokenBucket {
+ public:
+  explicit TokenBucket(RateLimit limit) : TokenBucket(std::make_shared<RateLimitParams>(limit)) {}
+  explicit TokenBucket(std::shared_ptr<RateLimitParams> params) noexcept
+      : m_params(std::move(params)) {}
+
+  /**
+   * @brief Take tokens if that many are available (all or nothing)
+   */
+  bool TryAcquire(std::uint32_t tokens = 1) noexcept {
+    return TryAcquireAt(FastClock::NowNs(), tokens);
+  }
+  bool TryAcquireAt(std::int64_t now_ns, std::uint32_t tokens = 1) noexcept;
+
+  /**
+   * @brief Give back tokens taken for work that was not done
+   */
+  void Refund(std::uint32_t tokens = 1) noexcept;
+
+  /// Whole tokens available now
+  std::int64_t Available() const noexcept { return AvailableAt(FastClock::NowNs()); }
+  std::int64_t AvailableAt(std::int64_t now_ns) const noexcept;
+
+  /// Refill to burst
+  void Reset() noexcept { m_empty_at_ns.store(kFull, std::memory_order_relaxed); }
+
+  RateLimitParams& Params() const noexcept { return *m_params; }
+
+ private:
+  /// Empty so long ago that any bucket is full
+  static constexpr std::int64_t kFull = INT64_MIN / 2;
+
+  std::shared_ptr<RateLimitParams> m_params;
+  std::atomic<std::int64_t> m_empty_at_ns{kFull};
+};
+
+/**
+ * @class Gcra
+ * @brief Generic cell rate algorithm: one theoretical arrival time (TAT)
+ * @details Admits exactly what a TokenBucket with the same limit admits, and
+ *          additionally tells a denied caller how long to wait. Thread-safe
+ *          and lock-free.
+ */
+class Gcra {
+ public:
+  explicit Gcra(RateLimit limit) : Gcra(std::make_shared<RateLimitParams>(limit)) {}
+  explicit Gcra(std::shared_ptr<RateLimitParams> params) noexcept : m_params(std::move(params)) {}
+
+  bool TryAcquire(std::uint32_t cost = 1) noexcept { return CheckAt(FastClock::NowNs(), cost).allowed; }
+
+  /**
+   * @brief Admit a request of cost tokens, or report when it would pass
+   */
+  RateDecision Check(std::uint32_t cost = 1) noexcept { return CheckAt(FastClock::NowNs(), cost); }
+  RateDecision CheckAt(std::int64_t now_ns, std::uint32_t cost = 1) noexcept;
+
+  /// Forget past requests (full burst available)
+  void Reset() noexcept { m_tat_ns.store(0, std::memory_order_relaxed); }
+
+  RateLimitParams& Params() const noexcept { return *m_params; }
+
+ private:
+  std::shared_ptr<RateLimitParams> m_params;
+  std::atomic<std::int64_t> m_tat_ns{0};
+};
+
+/**
+ * @brief One GCRA step shared by Gcra and KeyedRateLimiter
+ * @param tat_ns In: theoretical arrival time, out: new one when allowed
+ */
+RateDecision GcraAdmit(std::uint64_t params, std::int64_t now_ns, std::uint32_t cost,
+                       std::int64_t& tat_ns) noexcept;
+
+/**
+ * @class RateLimits
+ * @brief Named limits shared by all limiters of the process (singleton)
+ * @details Params() hands out the same RateLimitParams for a name for the
+ *          lifetime of the process; Apply() overwrites them, so limiters
+ *          created from it follow configuration reloads.
+ */
+class RateLimits {
+ public:
+  static RateLimits& Instance();
+
+  RateLimits(const RateLimits&) = delete;
+  RateLimits& operator=(const RateLimits&) = delete;
+
+  /**
+   * @brief Limit registered under name, created with default_limit if new
+   * @note A configured value (Apply()) wins over default_limit
+   */
+  std::shared_ptr<RateLimitParams> Params(const std::string& name, RateLimit default_limit);
+
+  /**
+   * @brief Set the configured limits; names not listed return to their default
+   */
+  void Apply(const std::map<std::string, RateLimit>& limits);
+
+ private:
+  RateLimits() = default;
+
+  struct Entry {
+    std::shared_ptr<RateLimitParams> params;
+    RateLimit default_limit;
+  };
+
+  std::mutex m_mutex;
+  FlatMap<Symbol, Entry> m_entries;
+  /// Last Apply(), also used for names requested later
+  FlatMap<Symbol, RateLimit> m_configured;
+};
+
+}  // namespace comm
@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_ratelimit_config.h
+ * @brief [ratelimit] configuration section and its TOML serialization
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <toml.hpp>
+
+#include "comm_ratelimit.h"
+
+namespace comm {
+
+/**
+ * @brief Named limits read from the [ratelimit] section of config.toml
+ *
+ * @code
+ * [ratelimit.outbound_api]
+ * per_second = 100   # sustained rate, 0 = admit nothing
+ * burst = 20         # requests admitted at once after a quiet period
+ *
+ * [ratelimit.per_client]
+ * per_second = 2.5
+ * burst = 10
+ * @endcode
+ *
+ * @note Hot-reloaded: limiters built on RateLimits::Params() pick up
+ *       changed values on the next admit check
+ */
+struct RateLimitConfig {
+  std::map<std::string, RateLimit> limits;
+
+  bool operator==(const RateLimitConfig&) const = default;
+};
+
+// ADL-based serialization functions
+void to_toml(toml::value& dest, const RateLimitConfig& value);
+void from_toml(const toml::value& src, RateLimitConfig& value);
+
+}  // namespace comm
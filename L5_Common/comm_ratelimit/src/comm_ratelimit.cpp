@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_ratelimit.cpp
+ * @brief Token bucket and GCRA admit steps, named limit registry
+ */
+
+#include "comm_ratelimit.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace comm {
+
+namespace {
+
+/// Upper bound of count * interval; far from overflow when added to a time
+constexpr std::int64_t kMaxSpanNs = std::int64_t{1} << 62;
+
+std::int64_t Span(std::int64_t interval_ns, std::int64_t count) noexcept {
+  if (count != 0 && interval_ns > kMaxSpanNs / count) {
+    return kMaxSpanNs;
+  }
+  return interval_ns * count;
+}
+
+constexpr RateDecision kNever{false, std::chrono::nanoseconds::max()};
+
+}  // namespace
+
+void RateLimitParams::Set(RateLimit limit) noexcept {
+  std::uint64_t interval = 0;
+  if (limit.per_second > 0) {
+    const double ns = std::ceil(1e9 / limit.per_second);
+    interval = static_cast<std::uint64_t>(std::clamp(ns, 1.0, static_cast<double>(kMaxIntervalNs)));
+  }
+  const std::uint64_t burst = std::clamp<std::uint64_t>(limit.burst, 1, kBurstMask);
+  m_word.store((interval << kBurstBits) | burst, std::memory_order_relaxed);
+}
+
+RateLimit RateLimitParams::Get() const noexcept {
+  const std::uint64_t word = Load();
+  const std::int64_t interval = IntervalNs(word);
+  return RateLimit{interval > 0 ? 1e9 / static_cast<double>(interval) : 0.0,
+                   static_cast<std::uint32_t>(Burst(word))};
+}
+
+bool TokenBucket::TryAcquireAt(std::int64_t now_ns, std::uint32_t tokens) noexcept {
+  const std::uint64_t word = m_params->Load();
+  const std::int64_t interval = RateLimitParams::IntervalNs(word);
+  const std::int64_t burst = RateLimitParams::Burst(word);
+  if (interval == 0 || tokens > burst) {
+    return false;
+  }
+  const std::int64_t full_at = now_ns - Span(interval, burst);
+  const std::int64_t cost = Span(interval, tokens);
+
+  std::int64_t empty_at = m_empty_at_ns.load(std::memory_order_relaxed);
+  while (true) {
+    const std::int64_t next = std::max(empty_at, full_at) + cost;
+    if (next > now_ns) {
+      return false;
+    }
+    if (m_empty_at_ns.compare_exchange_weak(empty_at, next, std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+}
+
+void TokenBucket::Refund(std::uint32_t tokens) noexcept {
+  const std::int64_t refund = Span(RateLimitParams::IntervalNs(m_params->Load()), tokens);
+  std::int64_t empty_at = m_empty_at_ns.load(std::memory_order_relaxed);
+  while (!m_empty_at_ns.compare_exchange_weak(empty_at, std::max(empty_at - refund, kFull),
+                                              std::memory_order_relaxed)) {
+  }
+}
+
+std::int64_t TokenBucket::AvailableAt(std::int64_t now_ns) const noexcept {
+  const std::uint64_t word = m_params->Load();
+  const std::int64_t interval = RateLimitParams::IntervalNs(word);
+  if (interval == 0) {
+    return 0;
+  }
+  const std::int64_t burst = RateLimitParams::Burst(word);
+  const std::int64_t empty_at =
+      std::max(m_empty_at_ns.load(std::memory_order_relaxed), now_ns - Span(interval, burst));
+  return std::clamp<std::int64_t>((now_ns - empty_at) / interval, 0, burst);
+}
+
+RateDecision GcraAdmit(std::uint64_t params, std::int64_t now_ns, std::uint32_t cost,
+                       std::int64_t& tat_ns) noexcept {
+  const std::int64_t interval = RateLimitParams::IntervalNs(params);
+  const std::int64_t burst = RateLimitParams::Burst(params);
+  if (interval == 0 || cost > burst) {
+    return kNever;
+  }
+  const std::int64_t tolerance = Span(interval, burst);
+  const std::int64_t next = std::max(tat_ns, now_ns) + Span(interval, cost);
+  if (next - now_ns > tolerance) {
+    return RateDecision{false, std::chrono::nanoseconds(next - now_ns - tolerance)};
+  }
+  tat_ns = next;
+  return RateDecision{true, std::chrono::nanoseconds(0)};
+}
+
+RateDecision Gcra::CheckAt(std::int64_t now_ns, std::uint32_t cost) noexcept {
+  const std::uint64_t params = m_params->Load();
+  std::int64_t tat = m_tat_ns.load(std::memory_order_relaxed);
+  while (true) {
+    std::int64_t next = tat;
+    const RateDecision decision = GcraAdmit(params, now_ns, cost, next);
+    if (!decision || m_tat_ns.compare_exchange_weak(tat, next, std::memory_order_relaxed)) {
+      return decision;
+    }
+  }
+}
+
+RateLimits& RateLimits::Instance() {
+  static RateLimits instance;
+  return instance;
+}
+
+std::shared_ptr<RateLimitParams> RateLimits::Params(const std::string& name,
+                                                    RateLimit default_limit) {
+  const Symbol key(name);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto [entry, inserted] = m_entries.try_emplace(key);
+  if (inserted) {
+    const auto configured = m_configured.find(key);
+    entry->second.params = std::make_shared<RateLimitParams>(
+        configured != m_configured.end() ? configured->second : default_limit);
+    entry->second.default_limit = default_limit;
+  }
+  return entry->second.params;
+}
+
+void RateLimits::Apply(const std::map<std::string, RateLimit>& limits) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_configured.clear();
+  for (const auto& [name, limit] : limits) {
+    m_configured.insert_or_assign(Symbol(name), limit);
+  }
+  for (auto& [name, entry] : m_entries) {
+    const auto configured = m_configured.find(name);
+    entry.params->Set(configured != m_configured.end() ? configured->second : entry.default_limit);
+  }
+}
+
+}  // namespace comm
@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_ratelimit_config.cpp
+ * @brief Implementation of RateLimitConfig serialization
+ */
+
+#include "comm_ratelimit_config.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace comm {
+
+void to_toml(toml::value& dest, const RateLimitConfig& value) {
+  for (const auto& [name, limit] : value.limits) {
+    toml::value entry(toml::table{});
+    entry["per_second"] = limit.per_second;
+    entry["burst"] = static_cast<std::int64_t>(limit.burst);
+    dest[name] = entry;
+  }
+}
+
+void from_toml(const toml::value& src, RateLimitConfig& value) {
+  // Use default-constructed struct as source of default values (created once)
+  static const RateLimitConfig defaults;
+
+  try {
+    value = defaults;
+    if (!src.is_table()) {
+      return;
+    }
+    for (const auto& [name, entry] : src.as_table()) {
+      if (!entry.is_table()) {
+        LOG(WARNING) << "Ignoring ratelimit." << name << ": not a table";
+        continue;
+      }
+      RateLimit limit;
+      if (entry.contains("per_second")) {
+        // Accept both "100" and "2.5"
+        const auto& rate = entry.at("per_second");
+        limit.per_second = rate.is_integer() ? static_cast<double>(rate.as_integer())
+                                             : rate.as_floating();
+      }
+      limit.burst = static_cast<std::uint32_t>(std::clamp<std::int64_t>(
+          toml::find_or<std::int64_t>(entry, "burst", limit.burst), 1, UINT32_MAX));
+      value.limits[name] = limit;
+    }
+
+    LOG(INFO) << "Loaded RateLimitConfig";
+    for (const auto& [name, limit] : value.limits) {
+      LOG(INFO) << "  " << name << ": " << limit.per_second << "/s, burst " << limit.burst;
+    }
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Error parsing RateLimitConfig: " << e.what();
+    LOG(WARNING) << "Using default values";
+    value = defaults;
+  }
+}
+
+}  // namespace comm
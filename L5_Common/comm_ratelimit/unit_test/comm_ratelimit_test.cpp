@@ -0,0 +1,212 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_ratelimit_test.cpp
+ * @brief Unit tests for TokenBucket, Gcra, KeyedRateLimiter and RateLimits
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "comm_keyed_ratelimit.h"
+#include "comm_ratelimit.h"
+
+namespace comm {
+namespace {
+
+constexpr std::int64_t kSecond = 1'000'000'000;
+/// Arbitrary FastClock time the tests start at
+constexpr std::int64_t kStart = 1000 * kSecond;
+
+TEST(RateLimitParamsTest, PacksIntervalAndBurst) {
+  RateLimitParams params({100, 20});
+  EXPECT_EQ(RateLimitParams::IntervalNs(params.Load()), 10'000'000);
+  EXPECT_EQ(RateLimitParams::Burst(params.Load()), 20);
+  EXPECT_EQ(params.Get(), (RateLimit{100, 20}));
+
+  params.Set({0, 0});
+  EXPECT_EQ(RateLimitParams::IntervalNs(params.Load()), 0);
+  EXPECT_EQ(RateLimitParams::Burst(params.Load()), 1);
+
+  params.Set({1e-9, UINT32_MAX});  // clamped, not wrapped
+  EXPECT_EQ(RateLimitParams::IntervalNs(params.Load()), RateLimitParams::kMaxIntervalNs);
+  EXPECT_EQ(RateLimitParams::Burst(params.Load()),
+            static_cast<std::int64_t>(RateLimitParams::kBurstMask));
+}
+
+TEST(TokenBucketTest, BurstThenSustainedRate) {
+  TokenBucket bucket(RateLimit{10, 5});
+  EXPECT_EQ(bucket.AvailableAt(kStart), 5);
+  for (int index = 0; index < 5; ++index) {
+    EXPECT_TRUE(bucket.TryAcquireAt(kStart));
+  }
+  EXPECT_FALSE(bucket.TryAcquireAt(kStart));
+  EXPECT_EQ(bucket.AvailableAt(kStart), 0);
+
+  // One token per 100 ms
+  EXPECT_FALSE(bucket.TryAcquireAt(kStart + kSecond / 10 - 1));
+  EXPECT_TRUE(bucket.TryAcquireAt(kStart + kSecond / 10));
+  EXPECT_FALSE(bucket.TryAcquireAt(kStart + kSecond / 10));
+
+  // Never more than burst after a long pause
+  EXPECT_EQ(bucket.AvailableAt(kStart + 3600 * kSecond), 5);
+}
+
+TEST(TokenBucketTest, MultiTokenAcquireIsAllOrNothing) {
+  TokenBucket bucket(RateLimit{10, 5});
+  EXPECT_TRUE(bucket.TryAcquireAt(kStart, 3));
+  EXPECT_FALSE(bucket.TryAcquireAt(kStart, 3));
+  EXPECT_EQ(bucket.AvailableAt(kStart), 2);
+  EXPECT_FALSE(bucket.TryAcquireAt(kStart, 6));  // more than burst, never
+
+  bucket.Refund(3);
+  EXPECT_EQ(bucket.AvailableAt(kStart), 5);
+  bucket.Refund(100);  // refunds do not exceed the burst
+  EXPECT_EQ(bucket.AvailableAt(kStart), 5);
+}
+
+TEST(GcraTest, ReportsRetryAfter) {
+  Gcra gcra(RateLimit{10, 2});
+  EXPECT_TRUE(gcra.CheckAt(kStart));
+  EXPECT_TRUE(gcra.CheckAt(kStart));
+  const RateDecision denied = gcra.CheckAt(kStart);
+  EXPECT_FALSE(denied);
+  EXPECT_EQ(denied.retry_after, std::chrono::milliseconds(100));
+  EXPECT_TRUE(gcra.CheckAt(kStart + denied.retry_after.count()));
+
+  Gcra closed(RateLimit{0, 10});
+  EXPECT_FALSE(closed.CheckAt(kStart));
+  EXPECT_EQ(closed.CheckAt(kStart).retry_after, std::chrono::nanoseconds::max());
+}
+
+TEST(GcraTest, AdmitsLikeTokenBucket) {
+  TokenBucket bucket(RateLimit{1000, 7});
+  Gcra gcra(RateLimit{1000, 7});
+  std::int64_t now = kStart;
+  for (int step = 0; step < 10000; ++step) {
+    now += (step * 7919) % 2'500'000;  // irregular arrivals around the rate
+    const auto cost = static_cast<std::uint32_t>(1 + step % 3);
+    ASSERT_EQ(bucket.TryAcquireAt(now, cost), gcra.CheckAt(now, cost).allowed) << step;
+  }
+}
+
+TEST(GcraTest, SharedParamsFollowUpdates) {
+  auto params = std::make_shared<RateLimitParams>(RateLimit{1, 1});
+  Gcra first(params);
+  Gcra second(params);
+  EXPECT_TRUE(first.CheckAt(kStart));
+  EXPECT_FALSE(first.CheckAt(kStart + kSecond / 10));
+
+  params->Set({10, 1});
+  EXPECT_TRUE(second.CheckAt(kStart));
+  EXPECT_TRUE(second.CheckAt(kStart + kSecond / 10));
+}
+
+TEST(GcraTest, ConcurrentAdmitsNeverExceedBurst) {
+  constexpr int kThreads = 4;
+  Gcra gcra(RateLimit{1e-3, 1000});  // no refill within the test
+  std::atomic<int> admitted{0};
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < kThreads; ++thread) {
+    threads.emplace_back([&] {
+      for (int index = 0; index < 1000; ++index) {
+        if (gcra.TryAcquire()) {
+          admitted.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(admitted.load(), 1000);
+}
+
+TEST(KeyedRateLimiterTest, KeysAreIndependent) {
+  KeyedRateLimiter<std::string> limiter(RateLimit{1, 2});
+  EXPECT_TRUE(limiter.CheckAt("alice", kStart));
+  EXPECT_TRUE(limiter.CheckAt("alice", kStart));
+  EXPECT_FALSE(limiter.CheckAt("alice", kStart));
+  EXPECT_TRUE(limiter.CheckAt("bob", kStart));
+  EXPECT_EQ(limiter.Size(), 2U);
+
+  limiter.Forget("alice");
+  EXPECT_TRUE(limiter.CheckAt("alice", kStart));
+}
+
+TEST(KeyedRateLimiterTest, EvictsKeysAtRestFirst) {
+  KeyedRateLimiter<int> limiter(RateLimit{1, 5}, {.max_keys = 100, .shards = 1});
+  for (int key = 0; key < 100; ++key) {
+    EXPECT_TRUE(limiter.CheckAt(key, kStart));
+  }
+  EXPECT_EQ(limiter.Size(), 100U);
+
+  // One second later every key is at rest again: dropping them loses nothing
+  for (int key = 100; key < 200; ++key) {
+    EXPECT_TRUE(limiter.CheckAt(key, kStart + kSecond));
+  }
+  EXPECT_LE(limiter.Size(), 100U);
+  EXPECT_EQ(limiter.Evictions(), 0U);
+
+  // Nobody at rest: the map stays bounded and counts evictions
+  for (int key = 200; key < 1000; ++key) {
+    EXPECT_TRUE(limiter.CheckAt(key, kStart + kSecond));
+  }
+  EXPECT_LE(limiter.Size(), 100U);
+  EXPECT_GT(limiter.Evictions(), 0U);
+}
+
+TEST(KeyedRateLimiterTest, FloodOfNewKeysDoesNotResetHotKey) {
+  KeyedRateLimiter<int> limiter(RateLimit{1, 5}, {.max_keys = 100, .shards = 1});
+  for (int key = 0; key < 90; ++key) {
+    EXPECT_TRUE(limiter.CheckAt(key, kStart));  // Close to rest half a second later
+  }
+  const std::int64_t now = kStart + kSecond / 2;
+  // Each flood key takes its whole burst: as far from rest as the hot key
+  constexpr int kHot = 999;
+  for (int key = 1000; key < 1020; ++key) {
+    EXPECT_TRUE(limiter.CheckAt(key, now, 5));
+  }
+  ASSERT_TRUE(limiter.CheckAt(kHot, now, 5));
+  ASSERT_FALSE(limiter.CheckAt(kHot, now));
+  for (int key = 1020; key < 1040; ++key) {
+    EXPECT_TRUE(limiter.CheckAt(key, now, 5));
+  }
+  EXPECT_EQ(limiter.Size(), 100U);
+  EXPECT_EQ(limiter.Evictions(), 31U);
+
+  // Evictions took keys closest to rest, not the newest: no key got its burst back
+  EXPECT_FALSE(limiter.CheckAt(kHot, now));
+  for (int key = 1000; key < 1040; ++key) {
+    EXPECT_FALSE(limiter.CheckAt(key, now)) << key;
+  }
+}
+
+TEST(KeyedRateLimiterTest, DeniedNewKeysAreNotStored) {
+  KeyedRateLimiter<int> limiter(RateLimit{0, 1});
+  EXPECT_FALSE(limiter.CheckAt(1, kStart));
+  EXPECT_EQ(limiter.Size(), 0U);
+}
+
+TEST(RateLimitsTest, ApplyUpdatesAndRestoresDefaults) {
+  auto params = RateLimits::Instance().Params("test_outbound", {100, 20});
+  EXPECT_EQ(params->Get(), (RateLimit{100, 20}));
+  EXPECT_EQ(RateLimits::Instance().Params("test_outbound", {1, 1}), params);
+
+  RateLimits::Instance().Apply({{"test_outbound", {50, 5}}, {"test_later", {2, 3}}});
+  EXPECT_EQ(params->Get(), (RateLimit{50, 5}));
+  // Configured before first use: the configuration wins over the default
+  EXPECT_EQ(RateLimits::Instance().Params("test_later", {1, 1})->Get(), (RateLimit{2, 3}));
+
+  RateLimits::Instance().Apply({});
+  EXPECT_EQ(params->Get(), (RateLimit{100, 20}));
+  EXPECT_EQ(RateLimits::Instance().Params("test_later", {1, 1})->Get(), (RateLimit{1, 1}));
+}
+
+}  // namespace
+}  // namespace comm
@@ -0,0 +1,415 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_shard.h
+ * @brief Shared-nothing runtime: one event-loop thread per core
+ * @details ShardRuntime starts one thread per shard, optionally pinned to its
+ *          own CPU. A shard owns everything its code touches: a memory
+ *          resource, a scratch arena, a timer wheel, an epoll loop and its
+ *          part of the data (ShardLocal<T>). Shards never share locks; they
+ *          talk by posting tasks through single-producer/single-consumer
+ *          rings, one per ordered pair of shards. Threads outside the
+ *          runtime submit through one bounded inbox per shard.
+ *
+ * @code
+ * comm::ShardLocal<Sessions> sessions;
+ *
+ * // Route a request to the shard owning its key
+ * auto& runtime = comm::ShardRuntime::Instance();
+ * runtime.Submit(runtime.ShardFor(std::hash<std::string>{}(key)), [key] {
+ *   sessions.Local().Touch(key);
+ *   comm::Shard::Current()->Schedule(30s, [key] { sessions.Local().Expire(key); });
+ * });
+ * @endcode
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "comm_arena.h"
+#include "comm_clock.h"
+#include "comm_mpmc_queue.h"
+#include "comm_pool.h"
+#include "comm_spsc_queue.h"
+#include "comm_timer_wheel.h"
+
+namespace comm {
+
+/**
+ * @brief Error codes for Shard module operations
+ */
+enum class ShardError {
+  Success = 0,               ///< Operation completed successfully
+  NotRunning = 1,            ///< Runtime not started yet or already stopped
+  AlreadyRunning = 2,        ///< Start() called twice
+  InvalidShard = 3,          ///< Shard index out of range
+  ThreadCreationFailed = 4,  ///< Failed to create a shard thread
+  InitFailed = 5,            ///< The init callback threw on a shard
+};
+
+/**
+ * @brief Error category for Shard module errors
+ */
+class ShardErrorCategory : public std::error_category {
+ public:
+  const char* name() const noexcept override { return "comm_shard"; }
+  std::string message(int error_value) const override;
+};
+
+/**
+ * @brief Get the singleton instance of ShardErrorCategory
+ */
+const std::error_category& get_shard_error_category() noexcept;
+
+/**
+ * @brief Helper function to create std::error_code from ShardError
+ */
+inline std::error_code make_error_code(ShardError err) noexcept {
+  return {static_cast<int>(err), get_shard_error_category()};
+}
+
+struct ShardConfig;
+
+namespace detail {
+
+/**
+ * @brief Type-erased, move-only task allocated from the PoolResource
+ * @details Freed by the shard that ran it into its own thread cache;
+ *          PoolResource moves blocks back between threads in batches.
+ */
+class ShardTask {
+ public:
+  virtual void Run() = 0;
+  /// Destroy and free (the size is only known to the derived type)
+  virtual void Destroy() noexcept = 0;
+
+ protected:
+  ~ShardTask() = default;
+};
+
+template <typename F>
+class ShardTaskImpl final : public ShardTask {
+ public:
+  template <typename G>
+  explicit ShardTaskImpl(G&& function) : m_function(std::forward<G>(function)) {}
+
+  void Run() override { m_function(); }
+
+  void Destroy() noexcept override {
+    this->~ShardTaskImpl();
+    PoolResource::Instance().deallocate(this, sizeof(ShardTaskImpl), alignof(ShardTaskImpl));
+  }
+
+ private:
+  F m_function;
+};
+
+struct ShardTaskDeleter {
+  void operator()(ShardTask* task) const noexcept { task->Destroy(); }
+};
+
+using ShardTaskPtr = std::unique_ptr<ShardTask, ShardTaskDeleter>;
+
+template <typename F>
+ShardTaskPtr MakeShardTask(F&& function) {
+  using Task = ShardTaskImpl<std::decay_t<F>>;
+  void* memory = PoolResource::Instance().allocate(sizeof(Task), alignof(Task));
+  try {
+    return ShardTaskPtr(new (memory) Task(std::forward<F>(function)));
+  } catch (...) {
+    PoolResource::Instance().deallocate(memory, sizeof(Task), alignof(Task));
+    throw;
+  }
+}
+
+}  // namespace detail
+
+/**
+ * @brief Counters reported by Shard::GetStats() and ShardRuntime::GetStats()
+ */
+struct ShardStats {
+  std::uint64_t tasks_run{0};       ///< Posted and submitted tasks executed
+  std::uint64_t timers_fired{0};    ///< Shard timers expired
+  std::uint64_t ring_overflows{0};  ///< Posts parked because the ring was full
+  std::uint64_t wakeups{0};         ///< Times the loop slept and was woken
+};
+
+class ShardRuntime;
+
+/**
+ * @class Shard
+ * @brief State and event loop of one shard thread
+ * @note Apart from Index() and GetStats(), members must be called on the
+ *       shard's own thread (reach it with Shard::Current()).
+ */
+class Shard {
+ public:
+  /// Timer resolution of Schedule()
+  static constexpr std::chrono::milliseconds kTick{1};
+
+  ~Shard();
+
+  Shard(const Shard&) = delete;
+  Shard& operator=(const Shard&) = delete;
+
+  /**
+   * @brief Shard running on the calling thread, nullptr on other threads
+   */
+  static Shard* Current();
+
+  unsigned Index() const { return m_index; }
+
+  /**
+   * @brief Run task on shard to (may be this one), in posting order
+   * @details Never blocks: when the ring to the target is full the task
+   *          waits in a local overflow list, retried on every loop pass.
+   */
+  template <typename F>
+  std::error_code Post(unsigned to, F&& task) {
+    return PostTask(to, detail::MakeShardTask(std::forward<F>(task)));
+  }
+
+  /**
+   * @brief Run callback on this shard after delay (rounded up to kTick)
+   */
+  template <typename F>
+  TimerId Schedule(FastClock::duration delay, F&& callback) {
+    return AddTimer(delay, detail::MakeShardTask(std::forward<F>(callback)));
+  }
+
+  /**
+   * @return True if the timer was pending and will not run
+   */
+  bool CancelTimer(TimerId id);
+
+  /**
+   * @brief Call callback with the epoll event mask while fd is ready
+   * @param events EPOLLIN/EPOLLOUT/...; level-triggered
+   * @return System error from epoll_ctl()
+   * @note The fd must stay open until Unwatch()
+   */
+  std::error_code Watch(int fd, std::uint32_t events, std::function<void(std::uint32_t)> callback);
+  void Unwatch(int fd);
+
+  /**
+   * @brief Memory resource owned by this shard (unsynchronized pools)
+   * @note Memory from it must be freed on this shard
+   */
+  std::pmr::memory_resource& Memory() { return m_memory; }
+
+  /**
+   * @brief Arena reset after every loop pass, for per-task scratch data
+   */
+  Arena& Scratch() { return m_scratch; }
+
+  /**
+   * @brief Run callback on this shard on every configuration reload
+   */
+  void OnReload(std::function<void()> callback);
+
+  /**
+   * @brief Run callback on this shard when the runtime stops
+   */
+  void OnStop(std::function<void()> callback);
+
+  ShardStats GetStats() const;
+
+ private:
+  friend class ShardRuntime;
+
+  Shard(ShardRuntime& runtime, unsigned index, unsigned count, std::size_t ring_capacity);
+
+  /// Create the epoll instance and the wake-up eventfd
+  std::error_code Open();
+  std::error_code PostTask(unsigned to, detail::ShardTaskPtr task);
+  TimerId AddTimer(FastClock::duration delay, detail::ShardTaskPtr task);
+  /// From any thread: wake the loop if it sleeps
+  void Wake();
+  void Loop();
+  bool HasInbound() const;
+  std::size_t RunInbound();
+  void FlushOverflow();
+  void RunTimers();
+  void RunTask(detail::ShardTask& task);
+  void RunCallbacks(const std::vector<std::function<void()>>& callbacks, const char* what);
+  int PollTimeoutMs() const;
+  void Dispatch(int timeout_ms);
+
+  ShardRuntime& m_runtime;
+  const unsigned m_index;
+  int m_epoll_fd{-1};
+  int m_wake_fd{-1};
+  std::thread m_thread;
+
+  /// m_rings[from]: tasks posted by shard from to this shard
+  std::vector<std::unique_ptr<SpscQueue<detail::ShardTaskPtr>>> m_rings;
+  /// Tasks submitted by threads outside the runtime
+  MpmcQueue<detail::ShardTaskPtr> m_inbox;
+  /// m_overflow[to]: posts waiting for room in the ring to shard to
+  std::vector<std::deque<detail::ShardTaskPtr>> m_overflow;
+  std::size_t m_overflow_count{0};
+
+  std::pmr::unsynchronized_pool_resource m_memory;
+  Arena m_scratch;
+  TimerWheel<detail::ShardTaskPtr> m_timers;
+  std::vector<detail::ShardTaskPtr> m_expired;
+  std::unordered_map<int, std::unique_ptr<std::function<void(std::uint32_t)>>> m_watches;
+  /// Unwatched callbacks, freed after the epoll events of this pass
+  std::vector<std::unique_ptr<std::function<void(std::uint32_t)>>> m_unwatched;
+  std::vector<std::function<void()>> m_reload_callbacks;
+  std::vector<std::function<void()>> m_stop_callbacks;
+
+  /// Set before the loop sleeps; posters wake it through m_wake_fd
+  std::atomic<bool> m_sleeping{false};
+  std::atomic<bool> m_exit{false};
+
+  std::atomic<std::uint64_t> m_tasks_run{0};
+  std::atomic<std::uint64_t> m_timers_fired{0};
+  std::atomic<std::uint64_t> m_ring_overflows{0};
+  std::atomic<std::uint64_t> m_wakeups{0};
+};
+
+/**
+ * @class ShardRuntime
+ * @brief Owner of the shard threads (singleton)
+ * @details Started by comm::Main::init() when [shards] enabled = true;
+ *          comm::Main fans configuration reloads out to every shard and
+ *          main() stops the runtime, running every shard's stop callbacks,
+ *          before the layers are deinitialized.
+ */
+class ShardRuntime {
+ public:
+  /**
+   * @brief Returns singleton instance of ShardRuntime class
+   * @details Thread-safe initialization using Meyers' Singleton pattern
+   * @return Reference to the single ShardRuntime instance
+   */
+  static ShardRuntime& Instance() {
+    static ShardRuntime instance;
+    return instance;
+  }
+
+  ShardRuntime(const ShardRuntime&) = delete;
+  ShardRuntime& operator=(const ShardRuntime&) = delete;
+
+  /**
+   * @brief Start the shard threads
+   * @param init Run on every shard thread before its loop starts (e.g. to
+   *             register OnReload()/OnStop() callbacks or Watch() sockets)
+   * @return std::error_code - empty once every shard runs its loop
+   */
+  std::error_code Start(const ShardConfig& config, std::function<void(Shard&)> init = {});
+
+  /**
+   * @brief Run every shard's stop callbacks on its thread, then end the loops
+   * @details Tasks posted before a loop ends still run; the rest are dropped.
+   *          Idempotent; must not be called from a shard thread.
+   */
+  void Stop();
+
+  /**
+   * @brief Run every shard's reload callbacks on its thread (asynchronous)
+   */
+  void Reload();
+
+  bool IsRunning() const { return m_running.load(std::memory_order_acquire); }
+  unsigned ShardCount() const { return static_cast<unsigned>(m_shards.size()); }
+
+  /**
+   * @brief Shard owning the key with this hash
+   */
+  unsigned ShardFor(std::uint64_t hash) const {
+    return static_cast<unsigned>(hash % m_shards.size());
+  }
+
+  /**
+   * @brief Run task on shard from any thread
+   * @details From a shard thread this is Shard::Post(); other threads wait
+   *          for room in the shard's inbox.
+   * @return ShardError::NotRunning or ShardError::InvalidShard
+   */
+  template <typename F>
+  std::error_code Submit(unsigned shard, F&& task) {
+    if (Shard* current = Shard::Current(); current != nullptr && &current->m_runtime == this) {
+      return current->Post(shard, std::forward<F>(task));
+    }
+    return SubmitTask(shard, detail::MakeShardTask(std::forward<F>(task)));
+  }
+
+  /**
+   * @brief Sum of the per-shard counters (approximate while running)
+   */
+  ShardStats GetStats() const;
+
+ private:
+  friend class Shard;
+
+  ShardRuntime() = default;
+  ~ShardRuntime();
+
+  std::error_code SubmitTask(unsigned shard, detail::ShardTaskPtr task);
+  /// Stop and join the threads of m_shards
+  void Join();
+
+  std::vector<std::unique_ptr<Shard>> m_shards;
+  std::atomic<bool> m_running{false};
+};
+
+/**
+ * @class ShardLocal
+ * @brief One T per shard, each touched only by its own shard
+ * @details Instances are cache-line aligned so neighbouring shards do not
+ *          share lines. Construct after ShardRuntime::Start().
+ */
+template <typename T>
+class ShardLocal {
+ public:
+  template <typename... Args>
+  explicit ShardLocal(Args&&... args) {
+    const unsigned count = std::max(ShardRuntime::Instance().ShardCount(), 1U);
+    m_values.reserve(count);
+    for (unsigned index = 0; index < count; ++index) {
+      m_values.push_back(std::make_unique<Slot>(args...));
+    }
+  }
+
+  /// Instance of the calling shard
+  T& Local() { return At(Shard::Current()->Index()); }
+
+  /// Instance of shard index (from that shard, or while the runtime is stopped)
+  T& At(unsigned index) { return m_values[index]->value; }
+
+  unsigned Size() const { return static_cast<unsigned>(m_values.size()); }
+
+ private:
+  struct alignas(64) Slot {
+    template <typename... Args>
+    explicit Slot(Args&... args) : value(args...) {}
+    T value;
+  };
+
+  std::vector<std::unique_ptr<Slot>> m_values;
+};
+
+}  // namespace comm
+
+namespace std {
+template <>
+struct is_error_code_enum<comm::ShardError> : true_type {};
+}  // namespace std
@@ -0,0 +1,42 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_shard_config.h
+ * @brief [shards] configuration section and its TOML serialization
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <toml.hpp>
+
+namespace comm {
+
+/**
+ * @brief Settings read from the [shards] section of config.toml
+ *
+ * @code
+ * [shards]
+ * enabled = true       # start the shared-nothing runtime next to the pools
+ * threads = 0          # shard threads, 0 = one per CPU the process may use
+ * pin_threads = true   # bind shard i to the i-th allowed CPU
+ * ring_capacity = 1024 # tasks per shard-to-shard ring and per inbox
+ * @endcode
+ *
+ * @note Applied once at startup; changes take effect after a restart
+ */
+struct ShardConfig {
+  bool enabled = false;
+  int threads = 0;
+  bool pin_threads = true;
+  std::size_t ring_capacity = 1024;
+
+  bool operator==(const ShardConfig&) const = default;
+};
+
+// ADL-based serialization functions
+void to_toml(toml::value& dest, const ShardConfig& value);
+void from_toml(const toml::value& src, ShardConfig& value);
+
+}  // namespace comm
@@ -0,0 +1,557 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_shard.cpp
+ * @brief Shard event loop, cross-shard rings and runtime start/stop
+ */
+
+#include "comm_shard.h"
+
+#include <glog/logging.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <exception>
+#include <latch>
+
+#include "comm_shard_config.h"
+#include "comm_terminate_signals.h"
+
+namespace comm {
+
+namespace {
+
+constexpr std::int64_t kTickNs =
+    std::chrono::duration_cast<std::chrono::nanoseconds>(Shard::kTick).count();
+
+/// Tasks taken from one ring per loop pass, so that no sender starves the others
+constexpr std::size_t kBatch = 64;
+
+thread_local Shard* t_current = nullptr;
+
+std::uint64_t NowTick() { return static_cast<std::uint64_t>(FastClock::NowNs() / kTickNs); }
+
+/// CPUs this process may run on, in ascending order
+std::vector<int> AllowedCpus() {
+  std::vector<int> cpus;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+  return cpus;
+}
+
+}  // namespace
+
+// Error category implementation
+std::string ShardErrorCategory::message(int error_value) const {
+  switch (static_cast<ShardError>(error_value)) {
+    case ShardError::Success:
+      return "Success";
+    case ShardError::NotRunning:
+      return "Shard runtime is not running";
+    case ShardError::AlreadyRunning:
+      return "Shard runtime is already running";
+    case ShardError::InvalidShard:
+      return "No shard with this index";
+    case ShardError::ThreadCreationFailed:
+      return "Failed to create shard thread";
+    case ShardError::InitFailed:
+      return "Shard initialization failed";
+    default:
+      return "Unknown shard error";
+  }
+}
+
+const std::error_category& get_shard_error_category() noexcept {
+  static ShardErrorCategory instance;
+  return instance;
+}
+
+Shard::Shard(ShardRuntime& runtime, unsigned index, unsigned count, std::size_t ring_capacity)
+    : m_runtime(runtime),
+      m_index(index),
+      m_inbox(ring_capacity),
+      m_overflow(count),
+      m_memory(&PoolResource::Instance()),
+      m_timers(NowTick()) {
+  m_rings.reserve(count);
+  for (unsigned from = 0; from < count; ++from) {
+    m_rings.push_back(std::make_unique<SpscQueue<detail::ShardTaskPtr>>(ring_capacity));
+  }
+}
+
+Shard::~Shard() {
+  if (m_wake_fd >= 0) {
+    close(m_wake_fd);
+  }
+  if (m_epoll_fd >= 0) {
+    close(m_epoll_fd);
+  }
+}
+
+Shard* Shard::Current() { return t_current; }
+
+std::error_code Shard::Open() {
+  m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (m_epoll_fd < 0) {
+    return {errno, std::system_category()};
+  }
+  m_wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (m_wake_fd < 0) {
+    return {errno, std::system_category()};
+  }
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.fd = m_wake_fd;
+  if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_wake_fd, &event) != 0) {
+    return {errno, std::system_category()};
+  }
+  return {};
+}
+
+std::error_code Shard::PostTask(unsigned to, detail::ShardTaskPtr task) {
+  if (to >= m_overflow.size()) {
+    return make_error_code(ShardError::InvalidShard);
+  }
+  Shard& target = *m_runtime.m_shards[to];
+  // Keep the order of posts: nothing may overtake what already overflowed
+  if (m_overflow[to].empty() && target.m_rings[m_index]->TryPush(std::move(task))) {
+    target.Wake();
+    return {};
+  }
+  m_overflow[to].push_back(std::move(task));
+  ++m_overflow_count;
+  m_ring_overflows.fetch_add(1, std::memory_order_relaxed);
+  return {};
+}
+
+void Shard::FlushOverflow() {
+  if (m_overflow_count == 0) {
+    return;
+  }
+  for (unsigned to = 0; to < m_overflow.size(); ++to) {
+    auto& pending = m_overflow[to];
+    if (pending.empty()) {
+      continue;
+    }
+    Shard& target = *m_runtime.m_shards[to];
+    std::size_t moved = 0;
+    while (!pending.empty() && target.m_rings[m_index]->TryPush(std::move(pending.front()))) {
+      pending.pop_front();
+      ++moved;
+    }
+    if (moved > 0) {
+      m_overflow_count -= moved;
+      target.Wake();
+    }
+  }
+}
+
+TimerId Shard::AddTimer(FastClock::duration delay, detail::ShardTaskPtr task) {
+  const std::int64_t deadline_ns = FastClock::NowNs() + std::max<std::int64_t>(delay.count(), 0);
+  return m_timers.Insert(static_cast<std::uint64_t>((deadline_ns + kTickNs - 1) / kTickNs),
+                         std::move(task));
+}
+
+bool Shard::CancelTimer(TimerId id) { return m_timers.Cancel(id).has_value(); }
+
+std::error_code Shard::Watch(int fd, std::uint32_t events,
+                             std::function<void(std::uint32_t)> callback) {
+  epoll_event event{};
+  event.events = events;
+  event.data.fd = fd;
+  auto found = m_watches.find(fd);
+  const int operation = found == m_watches.end() ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+  if (epoll_ctl(m_epoll_fd, operation, fd, &event) != 0) {
+    return {errno, std::system_category()};
+  }
+  auto function = std::make_unique<std::function<void(std::uint32_t)>>(std::move(callback));
+  if (found == m_watches.end()) {
+    m_watches.emplace(fd, std::move(function));
+  } else {
+    // The old callback may be the one running
+    m_unwatched.push_back(std::exchange(found->second, std::move(function)));
+  }
+  return {};
+}
+
+void Shard::Unwatch(int fd) {
+  auto found = m_watches.find(fd);
+  if (found == m_watches.end()) {
+    return;
+  }
+  epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+  m_unwatched.push_back(std::move(found->second));
+  m_watches.erase(found);
+}
+
+void Shard::OnReload(std::function<void()> callback) {
+  m_reload_callbacks.push_back(std::move(callback));
+}
+
+void Shard::OnStop(std::function<void()> callback) { m_stop_callbacks.push_back(std::move(callback)); }
+
+ShardStats Shard::GetStats() const {
+  ShardStats stats;
+  stats.tasks_run = m_tasks_run.load(std::memory_order_relaxed);
+  stats.timers_fired = m_timers_fired.load(std::memory_order_relaxed);
+  stats.ring_overflows = m_ring_overflows.load(std::memory_order_relaxed);
+  stats.wakeups = m_wakeups.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void Shard::Wake() {
+  // Pairs with the fence in Loop(): either the loop sees our task before it
+  // sleeps, or we see it sleeping
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (m_sleeping.load(std::memory_order_relaxed) &&
+      m_sleeping.exchange(false, std::memory_order_relaxed)) {
+    const std::uint64_t one = 1;
+    if (write(m_wake_fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+      LOG(ERROR) << "Shard " << m_index << " wake-up failed: " << std::strerror(errno);
+    }
+  }
+}
+
+bool Shard::HasInbound() const {
+  if (m_inbox.Size() > 0) {
+    return true;
+  }
+  for (const auto& ring : m_rings) {
+    if (ring->Size() > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Shard::RunTask(detail::ShardTask& task) {
+  try {
+    task.Run();
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Exception in task on shard " << m_index << ": " << e.what();
+  } catch (...) {
+    LOG(ERROR) << "Unknown exception in task on shard " << m_index;
+  }
+}
+
+std::size_t Shard::RunInbound() {
+  std::array<detail::ShardTaskPtr, kBatch> batch;
+  std::size_t total = 0;
+  const auto run = [&](std::size_t count) {
+    for (std::size_t index = 0; index < count; ++index) {
+      RunTask(*batch[index]);
+      batch[index].reset();
+    }
+    total += count;
+  };
+  for (auto& ring : m_rings) {
+    run(ring->TryPopBatch(batch.data(), batch.size()));
+  }
+  run(m_inbox.TryPopBatch(batch.data(), batch.size()));
+  m_tasks_run.fetch_add(total, std::memory_order_relaxed);
+  return total;
+}
+
+void Shard::RunTimers() {
+  const std::uint64_t now = NowTick();
+  if (m_timers.NextEventTick() > now) {
+    return;
+  }
+  // Collect first: callbacks may schedule or cancel timers
+  m_timers.Advance(now, [this](detail::ShardTaskPtr&& task) {
+    m_expired.push_back(std::move(task));
+  });
+  m_timers_fired.fetch_add(m_expired.size(), std::memory_order_relaxed);
+  for (auto& task : m_expired) {
+    RunTask(*task);
+  }
+  m_expired.clear();
+}
+
+void Shard::RunCallbacks(const std::vector<std::function<void()>>& callbacks, const char* what) {
+  for (const auto& callback : callbacks) {
+    try {
+      callback();
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "Exception in " << what << " callback on shard " << m_index << ": " << e.what();
+    } catch (...) {
+      LOG(ERROR) << "Unknown exception in " << what << " callback on shard " << m_index;
+    }
+  }
+}
+
+int Shard::PollTimeoutMs() const {
+  if (m_overflow_count > 0) {
+    // Retry soon: the target drains its rings without telling us
+    return 1;
+  }
+  const std::uint64_t next = m_timers.NextEventTick();
+  if (next == TimerWheel<detail::ShardTaskPtr>::kNever) {
+    return -1;
+  }
+  const std::uint64_t now = NowTick();
+  if (next <= now) {
+    return 0;
+  }
+  const std::uint64_t ticks = next - now;
+  return ticks > static_cast<std::uint64_t>(INT_MAX / kTick.count())
+             ? INT_MAX
+             : static_cast<int>(ticks * static_cast<std::uint64_t>(kTick.count()));
+}
+
+void Shard::Dispatch(int timeout_ms) {
+  std::array<epoll_event, 64> events;
+  const int count = epoll_wait(m_epoll_fd, events.data(), static_cast<int>(events.size()), timeout_ms);
+  if (count < 0 && errno != EINTR) {
+    LOG(ERROR) << "Shard " << m_index << " epoll_wait() failed: " << std::strerror(errno);
+  }
+  for (int index = 0; index < count; ++index) {
+    const int fd = events[index].data.fd;
+    if (fd == m_wake_fd) {
+      std::uint64_t value = 0;
+      if (read(m_wake_fd, &value, sizeof(value)) > 0) {
+        m_wakeups.fetch_add(1, std::memory_order_relaxed);
+      }
+      continue;
+    }
+    // Skips fds unwatched by an earlier callback of this batch
+    auto found = m_watches.find(fd);
+    if (found == m_watches.end()) {
+      continue;
+    }
+    try {
+      (*found->second)(events[index].events);
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "Exception in fd " << fd << " callback on shard " << m_index << ": "
+                 << e.what();
+    }
+  }
+  m_unwatched.clear();
+}
+
+void Shard::Loop() {
+  while (true) {
+    // Read before draining: whatever was posted before Stop() still runs
+    const bool exit = m_exit.load(std::memory_order_acquire);
+    const std::size_t ran = RunInbound();
+    FlushOverflow();
+    RunTimers();
+    m_scratch.Reset();
+    if (exit) {
+      break;
+    }
+    if (ran > 0) {
+      // Busy: only pick up ready fds
+      Dispatch(0);
+      continue;
+    }
+
+    m_sleeping.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (HasInbound() || m_exit.load(std::memory_order_relaxed)) {
+      m_sleeping.store(false, std::memory_order_relaxed);
+      continue;
+    }
+    Dispatch(PollTimeoutMs());
+    m_sleeping.store(false, std::memory_order_relaxed);
+  }
+  t_current = nullptr;
+}
+
+ShardRuntime::~ShardRuntime() { Stop(); }
+
+std::error_code ShardRuntime::Start(const ShardConfig& config, std::function<void(Shard&)> init) {
+  if (IsRunning()) {
+    return make_error_code(ShardError::AlreadyRunning);
+  }
+
+  const std::vector<int> cpus = AllowedCpus();
+  unsigned count = static_cast<unsigned>(config.threads);
+  if (count == 0) {
+    count = cpus.empty() ? std::max(std::thread::hardware_concurrency(), 1U)
+                         : static_cast<unsigned>(cpus.size());
+  }
+  const bool pin = config.pin_threads && !cpus.empty();
+  if (pin && count > cpus.size()) {
+    LOG(WARNING) << count << " shards share " << cpus.size() << " CPUs";
+  }
+
+  m_shards.clear();
+  m_shards.reserve(count);
+  for (unsigned index = 0; index < count; ++index) {
+    m_shards.push_back(
+        std::unique_ptr<Shard>(new Shard(*this, index, count, config.ring_capacity)));
+    if (auto error = m_shards.back()->Open()) {
+      LOG(ERROR) << "Failed to create shard " << index << " event loop: " << error.message();
+      m_shards.clear();
+      return error;
+    }
+  }
+
+  std::latch ready(count);
+  std::atomic<unsigned> init_failures{0};
+  const auto thread_main = [&](Shard& shard, int cpu) {
+    t_current = &shard;
+    const std::string name = "comm_shard-" + std::to_string(shard.Index());
+    pthread_setname_np(pthread_self(), name.c_str());
+    if (cpu >= 0) {
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      CPU_SET(cpu, &set);
+      if (const int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set)) {
+        LOG(WARNING) << "Failed to pin shard " << shard.Index() << " to CPU " << cpu << ": "
+                     << std::strerror(error);
+      }
+    }
+    if (init) {
+      try {
+        init(shard);
+      } catch (const std::exception& e) {
+        LOG(ERROR) << "Shard " << shard.Index() << " init failed: " << e.what();
+        init_failures.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+    ready.count_down();
+  };
+
+  std::error_code result;
+  unsigned started = 0;
+  {
+    const TerminationSignalBlock block;
+    for (; started < count; ++started) {
+      Shard& shard = *m_shards[started];
+      const int cpu = pin ? cpus[started % cpus.size()] : -1;
+      try {
+        shard.m_thread = std::thread([&thread_main, &shard, cpu] {
+          thread_main(shard, cpu);
+          shard.Loop();
+        });
+      } catch (const std::system_error& e) {
+        LOG(ERROR) << "Failed to create shard thread " << started << ": " << e.what();
+        result = make_error_code(ShardError::ThreadCreationFailed);
+        break;
+      }
+    }
+  }
+
+  if (started < count) {
+    ready.count_down(count - started);
+  }
+  // thread_main, captured by reference, is done with once all counted down
+  ready.wait();
+  if (!result && init_failures.load(std::memory_order_relaxed) > 0) {
+    result = make_error_code(ShardError::InitFailed);
+  }
+  if (result) {
+    Join();
+    m_shards.clear();
+    return result;
+  }
+
+  m_running.store(true, std::memory_order_release);
+  LOG(INFO) << "Started " << count << " shards" << (pin ? " pinned to CPUs" : "");
+  return {};
+}
+
+void ShardRuntime::Join() {
+  for (auto& shard : m_shards) {
+    shard->m_exit.store(true, std::memory_order_release);
+    shard->m_inbox.Close();
+    shard->Wake();
+  }
+  for (auto& shard : m_shards) {
+    if (shard->m_thread.joinable()) {
+      shard->m_thread.join();
+    }
+  }
+}
+
+void ShardRuntime::Stop() {
+  if (Shard::Current() != nullptr) {
+    LOG(ERROR) << "ShardRuntime::Stop() called on a shard thread, ignored";
+    return;
+  }
+  if (!m_running.exchange(false, std::memory_order_acq_rel)) {
+    return;
+  }
+
+  // Loops keep running until every shard finished its stop callbacks, so
+  // those may still post to other shards
+  std::latch stopped(static_cast<std::ptrdiff_t>(m_shards.size()));
+  for (auto& shard : m_shards) {
+    Shard* target = shard.get();
+    const auto error = target->m_inbox.Push(detail::MakeShardTask([target, &stopped] {
+      target->RunCallbacks(target->m_stop_callbacks, "stop");
+      stopped.count_down();
+    }));
+    if (error) {
+      stopped.count_down();
+    } else {
+      target->Wake();
+    }
+  }
+  stopped.wait();
+
+  Join();
+  const ShardStats stats = GetStats();
+  LOG(INFO) << "Stopped " << m_shards.size() << " shards after " << stats.tasks_run << " tasks, "
+            << stats.timers_fired << " timers";
+}
+
+void ShardRuntime::Reload() {
+  if (!IsRunning()) {
+    return;
+  }
+  for (auto& shard : m_shards) {
+    Shard* target = shard.get();
+    if (SubmitTask(target->Index(), detail::MakeShardTask([target] {
+                     target->RunCallbacks(target->m_reload_callbacks, "reload");
+                   }))) {
+      LOG(WARNING) << "Reload not delivered to shard " << target->Index();
+    }
+  }
+}
+
+std::error_code ShardRuntime::SubmitTask(unsigned shard, detail::ShardTaskPtr task) {
+  if (!IsRunning()) {
+    return make_error_code(ShardError::NotRunning);
+  }
+  if (shard >= m_shards.size()) {
+    return make_error_code(ShardError::InvalidShard);
+  }
+  Shard& target = *m_shards[shard];
+  if (target.m_inbox.Push(std::move(task))) {
+    return make_error_code(ShardError::NotRunning);
+  }
+  target.Wake();
+  return {};
+}
+
+ShardStats ShardRuntime::GetStats() const {
+  ShardStats total;
+  for (const auto& shard : m_shards) {
+    const ShardStats stats = shard->GetStats();
+    total.tasks_run += stats.tasks_run;
+    total.timers_fired += stats.timers_fired;
+    total.ring_overflows += stats.ring_overflows;
+    total.wakeups += stats.wakeups;
+  }
+  return total;
+}
+
+}  // namespace comm
@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_shard_config.cpp
+ * @brief Implementation of ShardConfig serialization
+ */
+
+#include "comm_shard_config.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+
+namespace comm {
+
+void to_toml(toml::value& dest, const ShardConfig& value) {
+  dest["enabled"] = value.enabled;
+  dest["threads"] = value.threads;
+  dest["pin_threads"] = value.pin_threads;
+  dest["ring_capacity"] = static_cast<std::int64_t>(value.ring_capacity);
+}
+
+void from_toml(const toml::value& src, ShardConfig& value) {
+  // Use default-constructed struct as source of default values (created once)
+  static const ShardConfig defaults;
+
+  try {
+    value.enabled = toml::find_or(src, "enabled", defaults.enabled);
+    value.threads = std::max(toml::find_or(src, "threads", defaults.threads), 0);
+    value.pin_threads = toml::find_or(src, "pin_threads", defaults.pin_threads);
+    value.ring_capacity = static_cast<std::size_t>(std::max<std::int64_t>(
+        toml::find_or(src, "ring_capacity", static_cast<std::int64_t>(defaults.ring_capacity)),
+        2));
+
+    LOG(INFO) << "Loaded ShardConfig";
+    LOG(INFO) << "  enabled: " << value.enabled;
+    LOG(INFO) << "  threads: " << value.threads;
+    LOG(INFO) << "  pin_threads: " << value.pin_threads;
+    LOG(INFO) << "  ring_capacity: " << value.ring_capacity;
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Error parsing ShardConfig: " << e.what();
+    LOG(WARNING) << "Using default values";
+    value = defaults;
+  }
+}
+
+}  // namespace comm
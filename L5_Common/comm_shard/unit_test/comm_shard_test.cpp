@@ -0,0 +1,184 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_shard_test.cpp
+ * @brief Unit tests for ShardRuntime, Shard and ShardLocal
+ */
+
+#include <gtest/gtest.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "comm_shard.h"
+#include "comm_shard_config.h"
+
+namespace comm {
+namespace {
+
+using namespace std::chrono_literals;
+
+class ShardTest : public ::testing::Test {
+ protected:
+  void TearDown() override { ShardRuntime::Instance().Stop(); }
+
+  static ShardConfig Config(int threads, std::size_t ring_capacity = 1024) {
+    ShardConfig config;
+    config.enabled = true;
+    config.threads = threads;
+    config.pin_threads = false;
+    config.ring_capacity = ring_capacity;
+    return config;
+  }
+
+  /// Run function on shard and wait for its result
+  template <typename F>
+  static auto RunOn(unsigned shard, F function) {
+    std::promise<decltype(function())> result;
+    auto future = result.get_future();
+    EXPECT_FALSE(ShardRuntime::Instance().Submit(
+        shard, [&result, &function] { result.set_value(function()); }));
+    return future.get();
+  }
+};
+
+TEST_F(ShardTest, SubmitRunsOnTargetShard) {
+  auto& runtime = ShardRuntime::Instance();
+  ASSERT_FALSE(runtime.Start(Config(3)));
+  ASSERT_EQ(runtime.ShardCount(), 3U);
+  EXPECT_EQ(Shard::Current(), nullptr);
+
+  for (unsigned shard = 0; shard < 3; ++shard) {
+    EXPECT_EQ(RunOn(shard, [] { return Shard::Current()->Index(); }), shard);
+  }
+  EXPECT_EQ(runtime.Submit(3, [] {}), ShardError::InvalidShard);
+  EXPECT_EQ(runtime.Start(Config(3)), ShardError::AlreadyRunning);
+}
+
+TEST_F(ShardTest, ShardLocalGivesEachShardItsOwnValue) {
+  ASSERT_FALSE(ShardRuntime::Instance().Start(Config(2)));
+  ShardLocal<int> counters(0);
+  ASSERT_EQ(counters.Size(), 2U);
+  for (int round = 0; round < 5; ++round) {
+    RunOn(0, [&] { return ++counters.Local(); });
+  }
+  RunOn(1, [&] { return ++counters.Local(); });
+  ShardRuntime::Instance().Stop();
+  EXPECT_EQ(counters.At(0), 5);
+  EXPECT_EQ(counters.At(1), 1);
+}
+
+TEST_F(ShardTest, PostsKeepOrderWhenRingOverflows) {
+  constexpr int kPosts = 1000;
+  ASSERT_FALSE(ShardRuntime::Instance().Start(Config(2, 4)));
+  std::vector<int> received;  // owned by shard 1
+  std::promise<void> done;
+
+  RunOn(0, [&] {
+    Shard& shard = *Shard::Current();
+    for (int value = 0; value < kPosts; ++value) {
+      EXPECT_FALSE(shard.Post(1, [&received, value] { received.push_back(value); }));
+    }
+    EXPECT_FALSE(shard.Post(1, [&done] { done.set_value(); }));
+    return shard.GetStats().ring_overflows;
+  });
+  done.get_future().get();
+
+  ASSERT_EQ(received.size(), static_cast<std::size_t>(kPosts));
+  for (int value = 0; value < kPosts; ++value) {
+    ASSERT_EQ(received[static_cast<std::size_t>(value)], value);
+  }
+  EXPECT_GT(ShardRuntime::Instance().GetStats().ring_overflows, 0U);
+}
+
+TEST_F(ShardTest, TimersFireOnOwningShardAndCanBeCancelled) {
+  ASSERT_FALSE(ShardRuntime::Instance().Start(Config(2)));
+  std::promise<unsigned> fired;
+  std::atomic<bool> cancelled_ran{false};
+  const auto start = std::chrono::steady_clock::now();
+
+  const bool cancelled = RunOn(1, [&] {
+    Shard& shard = *Shard::Current();
+    const TimerId cancel = shard.Schedule(5ms, [&] { cancelled_ran = true; });
+    shard.Schedule(20ms, [&] { fired.set_value(Shard::Current()->Index()); });
+    return shard.CancelTimer(cancel);
+  });
+  EXPECT_TRUE(cancelled);
+  EXPECT_EQ(fired.get_future().get(), 1U);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 20ms);
+  EXPECT_FALSE(cancelled_ran);
+  EXPECT_EQ(ShardRuntime::Instance().GetStats().timers_fired, 1U);
+}
+
+TEST_F(ShardTest, WatchedFdCallsBackUntilUnwatched) {
+  ASSERT_FALSE(ShardRuntime::Instance().Start(Config(2)));
+  const int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  ASSERT_GE(fd, 0);
+  std::promise<std::uint64_t> read_value;
+
+  EXPECT_FALSE(RunOn(0, [&] {
+    return Shard::Current()->Watch(fd, EPOLLIN, [&, fd](std::uint32_t) {
+      std::uint64_t value = 0;
+      ASSERT_EQ(read(fd, &value, sizeof(value)), static_cast<ssize_t>(sizeof(value)));
+      Shard::Current()->Unwatch(fd);
+      read_value.set_value(value);
+    });
+  }));
+  const std::uint64_t value = 7;
+  ASSERT_EQ(write(fd, &value, sizeof(value)), static_cast<ssize_t>(sizeof(value)));
+  EXPECT_EQ(read_value.get_future().get(), 7U);
+
+  ShardRuntime::Instance().Stop();
+  close(fd);
+}
+
+TEST_F(ShardTest, ReloadAndStopReachEveryShard) {
+  constexpr unsigned kShards = 3;
+  std::atomic<unsigned> reloads{0};
+  std::atomic<unsigned> stops{0};
+  auto& runtime = ShardRuntime::Instance();
+  ASSERT_FALSE(runtime.Start(Config(kShards), [&](Shard& shard) {
+    EXPECT_EQ(Shard::Current(), &shard);
+    shard.OnReload([&] { reloads.fetch_add(1); });
+    shard.OnStop([&] { stops.fetch_add(1); });
+  }));
+
+  runtime.Reload();
+  // Inbox tasks run in order: these complete after the reload callbacks
+  for (unsigned shard = 0; shard < kShards; ++shard) {
+    RunOn(shard, [] { return 0; });
+  }
+  EXPECT_EQ(reloads.load(), kShards);
+
+  runtime.Stop();
+  EXPECT_EQ(stops.load(), kShards);
+  EXPECT_FALSE(runtime.IsRunning());
+  EXPECT_EQ(runtime.Submit(0, [] {}), ShardError::NotRunning);
+  runtime.Stop();
+  EXPECT_EQ(stops.load(), kShards);
+}
+
+TEST_F(ShardTest, FailingInitStopsAllShards) {
+  auto& runtime = ShardRuntime::Instance();
+  EXPECT_EQ(runtime.Start(Config(2),
+                          [](Shard& shard) {
+                            if (shard.Index() == 1) {
+                              throw std::runtime_error("no socket");
+                            }
+                          }),
+            ShardError::InitFailed);
+  EXPECT_FALSE(runtime.IsRunning());
+  ASSERT_FALSE(runtime.Start(Config(2)));
+  EXPECT_EQ(RunOn(1, [] { return Shard::Current()->Index(); }), 1U);
+}
+
+}  // namespace
+}  // namespace comm
@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_singleflight_benchmark.cpp
+ * @brief Overhead of SingleFlight and the work it saves under contention
+ * @details BM_DoOverhead runs a trivial computation alone (the cost of
+ *          joining and landing a flight: two short critical sections and an
+ *          allocation). BM_HotKey has 1-8 threads ask for the same key whose
+ *          load waits 50 us, as when a popular cache entry expires; the
+ *          "executions" counter is the share of calls that actually ran it.
+ *
+ * Usage: modu-core-comm_singleflight_benchmark [--benchmark_filter=...]
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "comm_singleflight.h"
+
+namespace {
+
+/// Stands in for a load that waits on I/O (a file, a peer)
+std::uint64_t Load() {
+  std::this_thread::sleep_for(std::chrono::microseconds(50));
+  return 1;
+}
+
+void BM_DoOverhead(benchmark::State& state) {
+  comm::SingleFlight<std::uint64_t, std::uint64_t> flights;
+  std::uint64_t key = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(flights.Do(++key & 1023, [key] { return key; }));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_HotKey(benchmark::State& state) {
+  static comm::SingleFlight<std::string, std::uint64_t> flights;
+  const comm::SingleFlightStats before = flights.GetStats();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(flights.Do("routes.default", Load));
+  }
+  state.SetItemsProcessed(state.iterations());
+  if (state.thread_index() == 0) {
+    const comm::SingleFlightStats after = flights.GetStats();
+    state.counters["executions"] = static_cast<double>(after.executions - before.executions) /
+                                   static_cast<double>(after.calls - before.calls);
+  }
+}
+
+}  // namespace
+
+BENCHMARK(BM_DoOverhead);
+BENCHMARK(BM_HotKey)->ThreadRange(1, 8)->UseRealTime();
@@ -0,0 +1,233 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_singleflight.h
+ * @brief Keyed request coalescing: one computation per key at a time
+ * @details When a cached or derived value expires, every caller that misses
+ *          would otherwise recompute it at once. SingleFlight lets the first
+ *          caller for a key (the leader) run the computation; callers that
+ *          arrive with the same key while it runs wait for it and get the
+ *          same value, or the same exception. Nothing is cached: once the
+ *          leader finishes, the next caller starts a new computation, so
+ *          SingleFlight sits in front of a cache, not in place of one.
+ *
+ *          Do() blocks waiting threads (on an atomic wait, no lock held).
+ *          DoAsync() suspends waiting coroutines without holding a thread
+ *          and resumes them on their pools. Both can join the same flight.
+ *
+ * @code
+ * comm::SingleFlight<std::string, std::shared_ptr<const Route>> m_loads;
+ *
+ * std::shared_ptr<const Route> Routes::Get(const std::string& name) {
+ *   if (auto cached = m_cache.Find(name)) {
+ *     return cached;
+ *   }
+ *   return m_loads.Do(name, [&] { return m_cache.Store(name, LoadRoute(name)); });
+ * }
+ *
+ * comm::Task<Config> Refresh() {
+ *   co_return co_await m_refresh.DoAsync("peers", [] { return FetchPeers(); });
+ * }
+ * @endcode
+ */
+
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
+
+#include "comm_coro.h"
+#include "comm_flat_map.h"
+
+namespace comm {
+
+/**
+ * @brief Counters reported by SingleFlight::GetStats()
+ */
+struct SingleFlightStats {
+  std::uint64_t calls{0};       ///< Do() and DoAsync() calls
+  std::uint64_t executions{0};  ///< Calls that ran the computation (leaders)
+  std::uint64_t coalesced{0};   ///< Calls that shared another call's result
+  std::uint64_t cancelled{0};   ///< DoAsync() waits given up on their stop token
+  std::size_t in_flight{0};     ///< Keys being computed now
+};
+
+namespace detail {
+
+/**
+ * @brief Completion of one computation, shared by the leader and its waiters
+ */
+class Flight {
+ public:
+  Flight() = default;
+  Flight(const Flight&) = delete;
+  Flight& operator=(const Flight&) = delete;
+
+  /// Block the calling thread until Finish()
+  void Wait() const noexcept;
+
+  /// co_await: resumes when finished; CoroError::Cancelled if stop was requested
+  AsyncEvent::Awaiter WaitAsync(std::stop_token stop) { return m_event.Wait(std::move(stop)); }
+
+  /// Publish the result (stored before) and release all waiters
+  void Finish() noexcept;
+
+  /// Rethrow the computation's exception, if it threw
+  void RethrowError() const;
+
+  std::exception_ptr error;
+
+ private:
+  std::atomic<bool> m_done{false};
+  AsyncEvent m_event;
+};
+
+template <typename T>
+struct FlightOf : Flight {
+  std::optional<T> value;
+};
+
+/// Throw std::system_error with CoroError::Cancelled
+[[noreturn]] void ThrowFlightCancelled();
+
+}  // namespace detail
+
+/**
+ * @class SingleFlight
+ * @brief Runs at most one computation per key at a time and shares its result
+ * @tparam Key Key type (hashed with FlatHash by default)
+ * @tparam T Result type; every caller receives a copy, so use a
+ *           std::shared_ptr<const X> for large values
+ * @note A computation must not call its own SingleFlight with the same key:
+ *       it would wait for itself.
+ */
+template <typename Key, typename T, typename Hash = FlatHash<Key>,
+          typename KeyEqual = std::equal_to<>>
+class SingleFlight {
+  static_assert(std::is_copy_constructible_v<T>, "SingleFlight hands out copies of T");
+
+ public:
+  SingleFlight() = default;
+  SingleFlight(const SingleFlight&) = delete;
+  SingleFlight& operator=(const SingleFlight&) = delete;
+
+  /**
+   * @brief Run compute() for key, or wait for the run already in flight
+   * @return The computed value (the leader's, if this call waited)
+   * @throws Whatever compute() threw, in the leader and in every waiter
+   * @note Blocks the calling thread; in a coroutine use DoAsync()
+   */
+  template <typename F>
+    requires std::is_invocable_r_v<T, F&>
+  T Do(const Key& key, F&& compute) {
+    auto [flight, leader] = Join(key);
+    if (leader) {
+      try {
+        flight->value.emplace(std::invoke(compute));
+      } catch (...) {
+        flight->error = std::current_exception();
+      }
+      Land(key, flight);
+    } else {
+      flight->Wait();
+    }
+    return Result(*flight);
+  }
+
+  /**
+   * @brief Coroutine variant: compute() returns the Task<T> to run
+   * @param stop Gives up waiting for another caller's run (throws
+   *             std::system_error with CoroError::Cancelled); a leader always
+   *             finishes, since others wait for it
+   * @note key and compute are copied into the coroutine frame
+   */
+  template <typename F>
+    requires std::same_as<std::invoke_result_t<F&>, Task<T>>
+  Task<T> DoAsync(Key key, F compute, std::stop_token stop = {}) {
+    auto [flight, leader] = Join(key);
+    if (leader) {
+      try {
+        flight->value.emplace(co_await std::invoke(compute));
+      } catch (...) {
+        flight->error = std::current_exception();
+      }
+      Land(key, flight);
+    } else if (co_await flight->WaitAsync(std::move(stop))) {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.cancelled;
+      }
+      detail::ThrowFlightCancelled();
+    }
+    co_return Result(*flight);
+  }
+
+  /**
+   * @brief Detach the run in flight for key, if any
+   * @details Its caller and current waiters still get its result; the next
+   *          caller starts a new computation (e.g. after an invalidation
+   *          that makes the running one stale)
+   */
+  void Forget(const Key& key) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_flights.erase(key);
+  }
+
+  SingleFlightStats GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    SingleFlightStats stats = m_stats;
+    stats.in_flight = m_flights.size();
+    return stats;
+  }
+
+ private:
+  using FlightPtr = std::shared_ptr<detail::FlightOf<T>>;
+
+  /// The flight for key, and whether this call leads it
+  std::pair<FlightPtr, bool> Join(const Key& key) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_stats.calls;
+    if (auto it = m_flights.find(key); it != m_flights.end()) {
+      ++m_stats.coalesced;
+      return {it->second, false};
+    }
+    // Allocated before the slot is taken: a throw must not leave a null flight
+    FlightPtr flight = std::make_shared<detail::FlightOf<T>>();
+    m_flights.try_emplace(key, flight);
+    ++m_stats.executions;
+    return {std::move(flight), true};
+  }
+
+  /// Leader: stop accepting waiters, then release the ones that joined
+  void Land(const Key& key, const FlightPtr& flight) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      // Forget() may have replaced it with a newer run
+      if (auto it = m_flights.find(key); it != m_flights.end() && it->second == flight) {
+        m_flights.erase(it);
+      }
+    }
+    flight->Finish();
+  }
+
+  static T Result(const detail::FlightOf<T>& flight) {
+    flight.RethrowError();
+    return *flight.value;
+  }
+
+  mutable std::mutex m_mutex;
+  FlatMap<Key, FlightPtr, Hash, KeyEqual> m_flights;
+  SingleFlightStats m_stats;
+};
+
+}  // namespace comm
@@ -0,0 +1,31 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_singleflight.cpp
+ * @brief Flight completion shared by blocking and coroutine waiters
+ */
+
+#include "comm_singleflight.h"
+
+#include <system_error>
+
+namespace comm::detail {
+
+void Flight::Wait() const noexcept { m_done.wait(false, std::memory_order_acquire); }
+
+void Flight::Finish() noexcept {
+  m_done.store(true, std::memory_order_release);
+  m_done.notify_all();
+  m_event.Set();
+}
+
+void Flight::RethrowError() const {
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void ThrowFlightCancelled() { throw std::system_error(make_error_code(CoroError::Cancelled)); }
+
+}  // namespace comm::detail
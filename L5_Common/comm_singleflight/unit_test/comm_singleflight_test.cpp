@@ -0,0 +1,237 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_singleflight_test.cpp
+ * @brief Unit tests for SingleFlight request coalescing
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "comm_coro_io.h"
+#include "comm_singleflight.h"
+
+namespace comm {
+namespace {
+
+using std::chrono::milliseconds;
+
+/// Poll until the flights reach the expected number of coalesced calls
+template <typename Flights>
+void WaitForCoalesced(const Flights& flights, std::uint64_t coalesced) {
+  while (flights.GetStats().coalesced < coalesced) {
+    std::this_thread::sleep_for(milliseconds(1));
+  }
+}
+
+}  // namespace
+
+TEST(SingleFlightTest, SequentialCallsComputeEachTime) {
+  SingleFlight<std::string, int> flights;
+  int runs = 0;
+  EXPECT_EQ(flights.Do("key", [&] { return ++runs; }), 1);
+  EXPECT_EQ(flights.Do("key", [&] { return ++runs; }), 2);
+
+  const SingleFlightStats stats = flights.GetStats();
+  EXPECT_EQ(stats.calls, 2U);
+  EXPECT_EQ(stats.executions, 2U);
+  EXPECT_EQ(stats.coalesced, 0U);
+  EXPECT_EQ(stats.in_flight, 0U);
+}
+
+TEST(SingleFlightTest, ConcurrentCallersShareOneComputation) {
+  constexpr int kWaiters = 8;
+  SingleFlight<std::string, std::string> flights;
+  std::atomic<int> runs{0};
+  std::atomic<bool> release{false};
+  auto compute = [&] {
+    runs.fetch_add(1);
+    while (!release.load()) {
+      std::this_thread::sleep_for(milliseconds(1));
+    }
+    return std::string("value");
+  };
+
+  std::vector<std::string> results(kWaiters + 1);
+  std::vector<std::thread> threads;
+  threads.emplace_back([&] { results[0] = flights.Do("key", compute); });
+  while (runs.load() == 0) {
+    std::this_thread::sleep_for(milliseconds(1));
+  }
+  for (int index = 1; index <= kWaiters; ++index) {
+    threads.emplace_back([&, index] { results[index] = flights.Do("key", compute); });
+  }
+  WaitForCoalesced(flights, kWaiters);
+  EXPECT_EQ(flights.GetStats().in_flight, 1U);
+  release.store(true);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(runs.load(), 1);
+  for (const auto& result : results) {
+    EXPECT_EQ(result, "value");
+  }
+  const SingleFlightStats stats = flights.GetStats();
+  EXPECT_EQ(stats.calls, kWaiters + 1U);
+  EXPECT_EQ(stats.executions, 1U);
+  EXPECT_EQ(stats.coalesced, static_cast<std::uint64_t>(kWaiters));
+  EXPECT_EQ(stats.in_flight, 0U);
+}
+
+TEST(SingleFlightTest, ExceptionReachesAllCallersAndIsNotKept) {
+  SingleFlight<int, int> flights;
+  std::atomic<bool> release{false};
+  std::atomic<bool> started{false};
+  auto failing = [&]() -> int {
+    started.store(true);
+    while (!release.load()) {
+      std::this_thread::sleep_for(milliseconds(1));
+    }
+    throw std::runtime_error("load failed");
+  };
+
+  std::atomic<int> failures{0};
+  auto call = [&] {
+    try {
+      flights.Do(7, failing);
+    } catch (const std::runtime_error&) {
+      failures.fetch_add(1);
+    }
+  };
+  std::thread leader(call);
+  while (!started.load()) {
+    std::this_thread::sleep_for(milliseconds(1));
+  }
+  std::thread waiter(call);
+  WaitForCoalesced(flights, 1);
+  release.store(true);
+  leader.join();
+  waiter.join();
+  EXPECT_EQ(failures.load(), 2);
+
+  // The failure is not cached: the next call computes again
+  EXPECT_EQ(flights.Do(7, [] { return 42; }), 42);
+}
+
+TEST(SingleFlightTest, KeysAreIndependentAndForgetStartsANewRun) {
+  SingleFlight<std::string, int> flights;
+  std::atomic<bool> release{false};
+  std::atomic<int> started{0};
+  auto slow = [&] {
+    started.fetch_add(1);
+    while (!release.load()) {
+      std::this_thread::sleep_for(milliseconds(1));
+    }
+    return 1;
+  };
+  std::thread first([&] { EXPECT_EQ(flights.Do("a", slow), 1); });
+  while (started.load() == 0) {
+    std::this_thread::sleep_for(milliseconds(1));
+  }
+
+  // Another key, and the same key after Forget(), do not wait for the run of "a"
+  EXPECT_EQ(flights.Do("b", [] { return 2; }), 2);
+  flights.Forget("a");
+  EXPECT_EQ(flights.GetStats().in_flight, 0U);
+  EXPECT_EQ(flights.Do("a", [] { return 3; }), 3);
+
+  release.store(true);
+  first.join();
+  const SingleFlightStats stats = flights.GetStats();
+  EXPECT_EQ(stats.executions, 3U);
+  EXPECT_EQ(stats.coalesced, 0U);
+  EXPECT_EQ(stats.in_flight, 0U);
+}
+
+TEST(SingleFlightTest, CoroutinesShareOneComputation) {
+  constexpr int kCallers = 50;
+  SingleFlight<std::string, int> flights;
+  AsyncEvent gate;
+  std::atomic<int> runs{0};
+  std::atomic<int> sum{0};
+
+  auto compute = [&]() -> Task<int> {
+    runs.fetch_add(1);
+    co_await gate.Wait();
+    co_return 5;
+  };
+  auto caller = [&]() -> Task<void> {
+    sum.fetch_add(co_await flights.DoAsync("key", compute));
+  };
+  auto run = [&]() -> Task<void> {
+    TaskScope scope;
+    for (int index = 0; index < kCallers; ++index) {
+      scope.Spawn(caller());
+    }
+    // A blocking caller can join a coroutine's run as well
+    std::thread blocking([&] {
+      WaitForCoalesced(flights, kCallers - 1);
+      sum.fetch_add(flights.Do("key", [] { return 1000; }));
+    });
+    WaitForCoalesced(flights, kCallers);
+    gate.Set();
+    co_await scope.Join();
+    blocking.join();
+  };
+  SyncWait(run());
+
+  EXPECT_EQ(runs.load(), 1);
+  EXPECT_EQ(sum.load(), (kCallers + 1) * 5);
+  EXPECT_EQ(flights.GetStats().executions, 1U);
+  EXPECT_EQ(flights.GetStats().coalesced, static_cast<std::uint64_t>(kCallers));
+}
+
+TEST(SingleFlightTest, StopTokenCancelsOnlyTheWait) {
+  SingleFlight<int, int> flights;
+  AsyncEvent gate;
+  auto compute = [&]() -> Task<int> {
+    co_await gate.Wait();
+    co_return 9;
+  };
+
+  std::stop_source stop;
+  std::atomic<int> leader_result{0};
+  std::atomic<bool> cancelled{false};
+  auto leader = [&]() -> Task<void> { leader_result.store(co_await flights.DoAsync(1, compute)); };
+  auto waiter = [&]() -> Task<void> {
+    try {
+      co_await flights.DoAsync(1, compute, stop.get_token());
+    } catch (const std::system_error& error) {
+      cancelled.store(error.code() == CoroError::Cancelled);
+    }
+  };
+  auto run = [&]() -> Task<void> {
+    TaskScope scope;
+    scope.Spawn(leader());
+    while (flights.GetStats().in_flight == 0) {
+      co_await SleepFor(milliseconds(1));
+    }
+    scope.Spawn(waiter());
+    // Polls without blocking: the waiter may need this worker to start
+    while (flights.GetStats().coalesced == 0) {
+      co_await SleepFor(milliseconds(1));
+    }
+    stop.request_stop();
+    while (!cancelled.load()) {
+      co_await SleepFor(milliseconds(1));
+    }
+    gate.Set();
+    co_await scope.Join();
+  };
+  SyncWait(run());
+
+  EXPECT_TRUE(cancelled.load());
+  EXPECT_EQ(leader_result.load(), 9);
+  EXPECT_EQ(flights.GetStats().cancelled, 1U);
+}
+
+}  // namespace comm
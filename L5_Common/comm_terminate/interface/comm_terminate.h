@@ -4,18 +4,20 @@
 #pragma once
 
 #include <atomic>
-#include <condition_variable>
+#include <chrono>
 #include <csignal>
 #include <functional>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <semaphore>
 #include <string>
 #include <system_error>
 #include <thread>
 #include <vector>
 
+#include "comm_counter.h"
+#include "comm_mpmc_queue.h"
+
 namespace comm {
 
 /**
@@ -49,6 +51,17 @@ inline std::error_code make_error_code(TerminateError err) noexcept {
   return {static_cast<int>(err), get_terminate_error_category()};
 }
 
+/**
+ * @brief Counters reported by Terminate::GetStats()
+ */
+struct TerminateStats {
+  std::uint64_t reload_events{0};              ///< SIGHUP reload events processed
+  std::uint64_t reloads_coalesced{0};          ///< SIGHUPs merged into an already queued reload
+  std::uint64_t listener_calls{0};             ///< Reload listener invocations
+  std::uint64_t listener_failures{0};          ///< Listeners that threw
+  std::chrono::microseconds max_listener_time{0};  ///< Slowest listener so far
+};
+
 class Terminate {
  private:
   /// Worker thread that waits for termination signals (SIGINT, SIGTERM, SIGQUIT, SIGHUP)
@@ -72,20 +85,14 @@ class Terminate {
   /// Event types for internal processing
   enum class EventType {
     ConfigReload,  ///< SIGHUP received - reload configuration
-    Shutdown       ///< Shutdown event processor thread
   };
 
-  /// Event queue for async processing (signal handler -> event processor thread)
-  std::queue<EventType> m_event_queue;
-  
-  /// Mutex protecting event queue
-  std::mutex m_event_mutex;
-  
-  /// Condition variable for event queue notifications
-  std::condition_variable m_event_cv;
-  
-  /// Flag to stop event processor thread (protected by m_event_mutex)
-  bool m_stop_event_processor{false};
+  /// Reload events that may be pending at once; more SIGHUPs are coalesced
+  static constexpr std::size_t kEventQueueCapacity = 16;
+
+  /// Event queue for async processing (signal handler -> event processor thread);
+  /// closed to stop the event processor once queued events are handled
+  MpmcQueue<EventType> m_events;
 
   /// Registered callbacks for configuration reload notifications
   std::vector<std::function<void()>> m_config_reload_listeners;
@@ -96,6 +103,9 @@ class Terminate {
   /// Flag to track if first SIGINT was received (for double Ctrl-C handling)
   std::atomic<bool> m_first_sigint_received{false};
 
+  /// Slowest listener; the reload counters live in the MetricsRegistry
+  MaxGauge m_max_listener_us;
+
   /**
    * @brief Initializes signal set and semaphore for graceful shutdown handling
    * @note Private constructor - Singleton pattern (Meyers' Singleton)
@@ -159,6 +169,12 @@ class Terminate {
    */
   void RegisterConfigReloadListener(std::function<void()> callback);
 
+  /**
+   * @brief Reload event and listener statistics
+   * @return Counters aggregated over all threads
+   */
+  TerminateStats GetStats() const;
+
   /**
    * @brief Programmatically triggers application termination (alternative to external signals)
    * @details Signals the worker thread to exit and triggers WaitForTermination() to return
@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_terminate_signals.h
+ * @brief The signals Terminate receives with sigwait() and a guard blocking them
+ * @details sigwait() only gets a process-directed signal that every other
+ *          thread blocks. New threads inherit the mask of their creator, so
+ *          modules create their threads inside a TerminationSignalBlock.
+ *          Header-only: modules Terminate itself depends on can use it.
+ */
+
+#pragma once
+
+#include <pthread.h>
+
+#include <csignal>
+
+namespace comm {
+
+/**
+ * @brief Signals handled by Terminate's sigwait() thread
+ * @return SIGINT, SIGTERM, SIGQUIT (shutdown) and SIGHUP (config reload)
+ */
+inline sigset_t TerminationSignals() noexcept {
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);   // Ctrl-C - interactive interrupt
+  sigaddset(&signals, SIGTERM);  // Standard termination (systemd, kill)
+  sigaddset(&signals, SIGQUIT);  // Ctrl-\ - quit with core dump signal
+  sigaddset(&signals, SIGHUP);   // Hangup - config reload without restart
+  return signals;
+}
+
+/**
+ * @brief Blocks TerminationSignals() in the calling thread while alive
+ * @details Threads spawned meanwhile inherit the blocked mask; the caller's
+ *          previous mask is restored on destruction.
+ *
+ * @code
+ * {
+ *   TerminationSignalBlock block;
+ *   m_thread = std::thread(&Worker::Loop, this);
+ * }
+ * @endcode
+ */
+class TerminationSignalBlock {
+ public:
+  TerminationSignalBlock() noexcept {
+    const sigset_t signals = TerminationSignals();
+    pthread_sigmask(SIG_BLOCK, &signals, &m_previous);
+  }
+
+  ~TerminationSignalBlock() { pthread_sigmask(SIG_SETMASK, &m_previous, nullptr); }
+
+  TerminationSignalBlock(const TerminationSignalBlock&) = delete;
+  TerminationSignalBlock& operator=(const TerminationSignalBlock&) = delete;
+
+ private:
+  sigset_t m_previous;
+};
+
+}  // namespace comm
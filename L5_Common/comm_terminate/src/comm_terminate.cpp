@@ -10,6 +10,11 @@
 
 #include "comm_terminate.h"
 
+#include "comm_arena.h"
+#include "comm_metrics.h"
+#include "comm_terminate_signals.h"
+#include "comm_trace.h"
+
 #include <glog/logging.h>
 #include <signal.h>
 #include <systemd/sd-daemon.h>
@@ -19,6 +24,49 @@
 #include <string>
 
 namespace {
+
+/// Reload metrics of the event processor; Terminate is a singleton as well
+struct TerminateMetrics {
+  comm::Counter& reload_events = comm::MetricsRegistry::Instance().GetCounter(
+      "modu_terminate_reload_events_total", "SIGHUP reload events processed");
+  comm::Counter& reloads_coalesced = comm::MetricsRegistry::Instance().GetCounter(
+      "modu_terminate_reloads_coalesced_total", "SIGHUPs merged into an already queued reload");
+  comm::Counter& listener_calls = comm::MetricsRegistry::Instance().GetCounter(
+      "modu_terminate_listener_calls_total", "Terminate reload listener invocations");
+  comm::Counter& listener_failures = comm::MetricsRegistry::Instance().GetCounter(
+      "modu_terminate_listener_failures_total", "Terminate reload listeners that threw");
+  comm::Histogram& listener_duration = comm::MetricsRegistry::Instance().GetHistogram(
+      "modu_terminate_listener_duration_seconds", "Time spent in one reload listener");
+};
+
+TerminateMetrics& Metrics() {
+  static TerminateMetrics metrics;
+  return metrics;
+}
+
+/// Count a signal received by sigwait() under its short name
+void CountSignal(int signal) {
+  const char* label = "other";
+  switch (signal) {
+    case SIGINT:
+      label = "SIGINT";
+      break;
+    case SIGTERM:
+      label = "SIGTERM";
+      break;
+    case SIGQUIT:
+      label = "SIGQUIT";
+      break;
+    case SIGHUP:
+      label = "SIGHUP";
+      break;
+  }
+  comm::MetricsRegistry::Instance()
+      .GetCounter("modu_signals_received_total", "Signals received by the signal thread",
+                  {{"signal", label}})
+      .Add();
+}
+
 /**
  * @brief Converts POSIX signal number to human-readable description
  * @param signal POSIX signal number (e.g., SIGINT, SIGTERM)
@@ -104,6 +152,7 @@ void Terminate::WaitForTerminateSignal() {
         LOG(ERROR) << "sigwait() failed with error code: " << received;
         break;
       }
+      CountSignal(signal);
       
       // Handle SIGHUP separately - config reload without termination
       if (signal == SIGHUP) {
@@ -114,11 +163,11 @@ void Terminate::WaitForTerminateSignal() {
         
         // Queue event for processing thread to handle
         // Note: READY=1 will be sent by event processor after listeners complete
-        {
-          std::lock_guard<std::mutex> lock(m_event_mutex);
-          m_event_queue.push(EventType::ConfigReload);
+        // A full queue still ends in a reload that starts after this SIGHUP
+        if (!m_events.TryPush(EventType::ConfigReload)) {
+          Metrics().reloads_coalesced.Add();
+          LOG(WARNING) << "Config reloads already queued, SIGHUP coalesced with them";
         }
-        m_event_cv.notify_one();
         
         // Continue waiting for signals (don't terminate)
         continue;
@@ -179,26 +228,18 @@ void Terminate::WaitForTerminateSignal() {
   m_terminate.release();
 }
 
-Terminate::Terminate() : m_terminate{0}, m_wait_ms{0}, m_waited_signals{}, m_stop_event_processor{false} {
+Terminate::Terminate()
+    : m_terminate{0}, m_wait_ms{0}, m_waited_signals{}, m_events(kEventQueueCapacity) {
   // Initialize binary_semaphore to 0 (blocked state) - will be released on termination signal
   
-  sigemptyset(&m_waited_signals);
-  // Register signals to handle for graceful shutdown
-  sigaddset(&m_waited_signals, SIGINT);   // Ctrl-C - interactive interrupt
-  sigaddset(&m_waited_signals, SIGTERM);  // Standard termination (systemd, kill)
-  sigaddset(&m_waited_signals, SIGQUIT);  // Ctrl-\ - quit with core dump signal
-  sigaddset(&m_waited_signals, SIGHUP);   // Hangup - config reload without restart
+  // Register signals to handle for graceful shutdown and config reload
+  m_waited_signals = TerminationSignals();
 };
 
 Terminate::~Terminate() {
-  // Stop event processor thread
+  // Stop event processor thread (after the events already queued)
   if (m_event_processor && m_event_processor->joinable()) {
-    {
-      std::lock_guard<std::mutex> lock(m_event_mutex);
-      m_stop_event_processor = true;
-      m_event_queue.push(EventType::Shutdown);
-    }
-    m_event_cv.notify_one();
+    m_events.Close();
     m_event_processor->join();
   }
 
@@ -244,12 +285,7 @@ std::error_code Terminate::Start() {
     LOG(ERROR) << "Failed to create signal handler thread: " << e.what();
     
     // Cleanup event processor thread before returning error
-    {
-      std::lock_guard<std::mutex> lock(m_event_mutex);
-      m_stop_event_processor = true;
-      m_event_queue.push(EventType::Shutdown);
-    }
-    m_event_cv.notify_one();
+    m_events.Close();
     if (m_event_processor && m_event_processor->joinable()) {
       m_event_processor->join();
     }
@@ -287,6 +323,16 @@ void Terminate::TerminateApp(uint32_t milis_to_wait) {
   m_terminate.release();
 }
 
+TerminateStats Terminate::GetStats() const {
+  TerminateStats stats;
+  stats.reload_events = Metrics().reload_events.Value();
+  stats.reloads_coalesced = Metrics().reloads_coalesced.Value();
+  stats.listener_calls = Metrics().listener_calls.Value();
+  stats.listener_failures = Metrics().listener_failures.Value();
+  stats.max_listener_time = std::chrono::microseconds(m_max_listener_us.Value());
+  return stats;
+}
+
 void Terminate::RegisterConfigReloadListener(std::function<void()> callback) {
   std::lock_guard<std::mutex> lock(m_listeners_mutex);
   m_config_reload_listeners.push_back(std::move(callback));
@@ -296,48 +342,48 @@ void Terminate::RegisterConfigReloadListener(std::function<void()> callback) {
 void Terminate::ProcessEvents() {
   LOG(INFO) << "Event processor thread started";
   
-  while (true) {
-    std::unique_lock<std::mutex> lock(m_event_mutex);
-    
-    // Wait for events to be queued or stop request
-    m_event_cv.wait(lock, [this] {
-      return !m_event_queue.empty() || m_stop_event_processor;
-    });
-    
-    // If stop was requested and there are no more events, exit the loop
-    if (m_stop_event_processor && m_event_queue.empty()) {
-      break;
-    }
-    
-    // Process next queued event (queue is non-empty here)
-    EventType event = m_event_queue.front();
-    m_event_queue.pop();
-    
-    // Handle event based on type
+  // Spins briefly, then parks: see WaitPolicy in comm_wait.h
+  EventType event{};
+  while (!m_events.Pop(event)) {
     switch (event) {
       case EventType::ConfigReload: {
         LOG(INFO) << "Processing ConfigReload event, invoking listeners";
-        
-        // Release event mutex while processing to avoid blocking signal handler
-        lock.unlock();
+        Span span("terminate.reload_event");
         
         // Copy listeners under lock to avoid holding lock during callbacks
-        std::vector<std::function<void()>> listeners_copy;
+        // (into a stack arena: no global heap traffic for typical sizes)
+        InlineArena<2048> arena;
+        std::pmr::vector<std::function<void()>> listeners_copy(&arena);
         {
           std::lock_guard<std::mutex> listeners_lock(m_listeners_mutex);
-          listeners_copy = m_config_reload_listeners;
+          listeners_copy.assign(m_config_reload_listeners.begin(),
+                                m_config_reload_listeners.end());
         }
         
         // Invoke all registered listeners without holding lock
-        for (const auto& listener : listeners_copy) {
+        span.SetAttribute("listeners", listeners_copy.size());
+        TerminateMetrics& metrics = Metrics();
+        for (std::size_t index = 0; index < listeners_copy.size(); ++index) {
+          const auto& listener = listeners_copy[index];
+          Span listener_span("terminate.listener");  // Parent of Config::Reload's spans
+          listener_span.SetAttribute("index", index);
+          const auto start = std::chrono::steady_clock::now();
           try {
             listener();
           } catch (const std::exception& e) {
+            metrics.listener_failures.Add();
             LOG(ERROR) << "Exception in config reload listener: " << e.what();
           } catch (...) {
+            metrics.listener_failures.Add();
             LOG(ERROR) << "Unknown exception in config reload listener";
           }
+          const auto elapsed = std::chrono::steady_clock::now() - start;
+          metrics.listener_calls.Add();
+          metrics.listener_duration.ObserveDuration(elapsed);
+          m_max_listener_us.Record(
+              std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
         }
+        metrics.reload_events.Add();
         
         LOG(INFO) << "Config reload event processed, invoked " << listeners_copy.size() << " listeners";
         
@@ -345,15 +391,6 @@ void Terminate::ProcessEvents() {
         sd_notify(0, "READY=1");
         break;
       }
-      
-      case EventType::Shutdown:
-        LOG(INFO) << "Processing Shutdown event, event processor will exit";
-        // Protect the stop flag update with m_event_mutex
-        m_stop_event_processor = true;
-        // Release the mutex before exiting to avoid blocking other threads
-        lock.unlock();
-        LOG(INFO) << "Event processor thread exiting";
-        return;
     }
   }
   
@@ -8,12 +8,202 @@
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <dlfcn.h>
 #include <glog/logging.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
 
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "comm_metrics.h"
 #include "comm_terminate.h"
 
 using namespace comm;
 
+namespace {
+
+/// pthread_create() calls left before one fails; negative: none fails
+std::atomic<int> g_threads_until_failure{-1};
+
+}  // namespace
+
+/// Lets a test fail thread creation: the executable's definition wins over libc's
+extern "C" int pthread_create(pthread_t* thread, const pthread_attr_t* attr,
+                              void* (*start)(void*), void* arg) {
+  using Create = int (*)(pthread_t*, const pthread_attr_t*, void* (*)(void*), void*);
+  static const auto real_create = reinterpret_cast<Create>(dlsym(RTLD_NEXT, "pthread_create"));
+  if (g_threads_until_failure.fetch_sub(1) == 0) {
+    // Time for the threads already created to block before the caller cleans up
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    return EAGAIN;
+  }
+  return real_create(thread, attr, start, arg);
+}
+
+namespace {
+
+/// Poll condition until it holds or 5 seconds pass
+bool WaitUntil(const std::function<bool()>& condition) {
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!condition()) {
+    if (std::chrono::steady_clock::now() >= deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+/// Signals of one kind taken by Terminate's sigwait() thread so far
+std::uint64_t SignalsReceived(const char* name) {
+  return MetricsRegistry::Instance()
+      .GetCounter("modu_signals_received_total", "Signals received by the signal thread",
+                  {{"signal", name}})
+      .Value();
+}
+
+/// Send signal to this process and wait until the sigwait() thread took it
+bool RaiseAndWait(int signal, const char* name) {
+  const std::uint64_t before = SignalsReceived(name);
+  kill(getpid(), signal);
+  return WaitUntil([&] { return SignalsReceived(name) > before; });
+}
+
+/**
+ * @brief Failed checks of a test running Terminate in a child process
+ * @details Start() changes the process signal mask and its threads live until
+ *          exit, so such tests run inside EXPECT_EXIT; the child reports the
+ *          first failed check on stderr and through its exit code.
+ */
+class ChildChecks {
+ public:
+  void Check(bool condition, const char* what) {
+    if (!condition && m_failure.empty()) {
+      m_failure = what;
+    }
+  }
+
+  /// Stop Terminate with SIGTERM and exit; the Terminate destructor runs in exit()
+  [[noreturn]] void ShutDownAndExit() {
+    Check(RaiseAndWait(SIGTERM, "SIGTERM"), "SIGTERM not received");
+    Check(Terminate::Instance().WaitForTermination() == "Termination request",
+          "unexpected termination reason");
+    Exit();
+  }
+
+  /// Exit with 0 if every check held
+  [[noreturn]] void Exit() {
+    if (!m_failure.empty()) {
+      std::cerr << "Check failed: " << m_failure << std::endl;
+    }
+    std::exit(m_failure.empty() ? 0 : 1);
+  }
+
+ private:
+  std::string m_failure;
+};
+
+/// One reload through a slow listener and a throwing one, then shutdown
+void RunReloadWithFailingListener() {
+  alarm(5);  // A hang fails the test instead of stalling it
+  ChildChecks checks;
+  auto& terminate = Terminate::Instance();
+  std::atomic<int> calls{0};
+  terminate.RegisterConfigReloadListener([&calls] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    calls.fetch_add(1);
+  });
+  terminate.RegisterConfigReloadListener([&calls] {
+    calls.fetch_add(1);
+    throw std::runtime_error("reload rejected");
+  });
+
+  checks.Check(!terminate.Start(), "Start() failed");
+  checks.Check(RaiseAndWait(SIGHUP, "SIGHUP"), "SIGHUP not received");
+  checks.Check(WaitUntil([&] { return terminate.GetStats().reload_events == 1; }),
+               "reload event not processed");
+  const TerminateStats stats = terminate.GetStats();
+  checks.Check(calls.load() == 2, "listeners not called once each");
+  checks.Check(stats.listener_calls == 2, "listener_calls != 2");
+  checks.Check(stats.listener_failures == 1, "listener_failures != 1");
+  checks.Check(stats.max_listener_time >= std::chrono::milliseconds(5),
+               "max_listener_time below the slow listener's 5 ms");
+  checks.ShutDownAndExit();
+}
+
+/// SIGHUPs arriving while a listener holds the event processor
+void RunReloadBurst() {
+  alarm(5);
+  ChildChecks checks;
+  auto& terminate = Terminate::Instance();
+  std::atomic<bool> entered{false};
+  std::atomic<bool> hold{true};
+  std::atomic<std::uint64_t> calls{0};
+  terminate.RegisterConfigReloadListener([&] {
+    calls.fetch_add(1);
+    entered.store(true);
+    while (hold.load()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+
+  checks.Check(!terminate.Start(), "Start() failed");
+  checks.Check(RaiseAndWait(SIGHUP, "SIGHUP"), "SIGHUP not received");
+  checks.Check(WaitUntil([&] { return entered.load(); }), "first reload did not start");
+  constexpr std::uint64_t kBurst = 40;  // Well past the event queue's capacity
+  for (std::uint64_t index = 0; index < kBurst; ++index) {
+    checks.Check(RaiseAndWait(SIGHUP, "SIGHUP"), "SIGHUP not received");
+  }
+  checks.Check(terminate.GetStats().reloads_coalesced > 0, "no SIGHUP coalesced");
+  hold.store(false);
+
+  // Every SIGHUP ends in a reload of its own or in one it was merged into
+  checks.Check(WaitUntil([&] {
+                 const TerminateStats stats = terminate.GetStats();
+                 return stats.reload_events + stats.reloads_coalesced == kBurst + 1;
+               }),
+               "SIGHUPs neither processed nor counted as coalesced");
+  const TerminateStats stats = terminate.GetStats();
+  checks.Check(stats.reload_events > 1, "no reload ran after the burst");
+  checks.Check(calls.load() == stats.reload_events, "listener calls != reload events");
+  checks.ShutDownAndExit();
+}
+
+/// Shutdown while the event processor is parked on its empty queue
+void RunShutdownWithIdleEventProcessor() {
+  alarm(5);
+  ChildChecks checks;
+  checks.Check(!Terminate::Instance().Start(), "Start() failed");
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));  // Past its spins: parked
+  checks.ShutDownAndExit();  // ~Terminate closes the queue and joins the processor
+}
+
+/// Start() whose signal thread cannot be created
+void RunStartWithoutSignalThread() {
+  alarm(5);
+  ChildChecks checks;
+  g_threads_until_failure = 1;  // The event processor starts, the signal thread does not
+  const std::error_code error = Terminate::Instance().Start();
+  // Returning at all means Close() woke the parked processor for the join
+  checks.Check(error == make_error_code(TerminateError::ThreadCreationFailed),
+               "Start() did not report the failed thread");
+  sigset_t mask;
+  pthread_sigmask(SIG_BLOCK, nullptr, &mask);
+  checks.Check(sigismember(&mask, SIGHUP) == 0, "signal mask not restored");
+  checks.Exit();
+}
+
+}  // namespace
+
 /**
  * @brief Test fixture for Terminate tests
  */
@@ -146,6 +336,56 @@ TEST_F(TerminateTest, MultipleListenersCanBeRegistered) {
   EXPECT_EQ(call_count2, 0);
 }
 
+/**
+ * @brief Test statistics are empty before any reload event
+ */
+TEST_F(TerminateTest, StatsStartEmpty) {
+  const TerminateStats stats = Terminate::Instance().GetStats();
+  EXPECT_EQ(stats.reload_events, 0U);
+  EXPECT_EQ(stats.listener_calls, 0U);
+  EXPECT_EQ(stats.listener_failures, 0U);
+  EXPECT_EQ(stats.max_listener_time.count(), 0);
+}
+
+/**
+ * @brief Test fixture for tests that start Terminate in a child process
+ */
+class TerminateDeathTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Re-run the test binary for the child instead of forking this process
+    GTEST_FLAG_SET(death_test_style, "threadsafe");
+  }
+};
+
+/**
+ * @brief Test a SIGHUP reload counts listener calls, failures and time
+ */
+TEST_F(TerminateDeathTest, ReloadCountsListenerCallsAndFailures) {
+  EXPECT_EXIT(RunReloadWithFailingListener(), ::testing::ExitedWithCode(0), "");
+}
+
+/**
+ * @brief Test SIGHUPs past the event queue's capacity are coalesced, not lost
+ */
+TEST_F(TerminateDeathTest, ReloadsBeyondQueueCapacityAreCoalesced) {
+  EXPECT_EXIT(RunReloadBurst(), ::testing::ExitedWithCode(0), "");
+}
+
+/**
+ * @brief Test shutdown wakes an event processor blocked in Pop()
+ */
+TEST_F(TerminateDeathTest, ShutdownWakesIdleEventProcessor) {
+  EXPECT_EXIT(RunShutdownWithIdleEventProcessor(), ::testing::ExitedWithCode(0), "");
+}
+
+/**
+ * @brief Test a failed Start() stops the event processor and restores the mask
+ */
+TEST_F(TerminateDeathTest, FailedStartStopsEventProcessor) {
+  EXPECT_EXIT(RunStartWithoutSignalThread(), ::testing::ExitedWithCode(0), "");
+}
+
 /**
  * @brief Main function for running tests
  */
@@ -0,0 +1,215 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_timer.h
+ * @brief Timeouts and deadlines on a hierarchical timing wheel
+ * @details TimerService keeps all timers of the process in one timing wheel
+ *          with 1 ms ticks: scheduling and cancelling are O(1), so millions
+ *          of connection and request deadlines cost a few dozen bytes each.
+ *          One thread sleeps on a single timerfd armed for the next wheel
+ *          event; every wake-up expires all due timers at once and hands
+ *          their callbacks to the chosen ThreadPool in batches.
+ *
+ * @code
+ * comm::TimerHandle timeout;
+ * comm::TimerService::Instance().Schedule(std::chrono::seconds(30),
+ *                                         [this] { OnTimeout(); }, &timeout);
+ * ...
+ * timeout.Cancel();   // or let the handle go out of scope
+ * @endcode
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "comm_clock.h"
+#include "comm_executor.h"
+
+namespace comm {
+
+/**
+ * @brief Error codes for Timer module operations
+ */
+enum class TimerError {
+  Success = 0,      ///< Operation completed successfully
+  Stopped = 1,      ///< TimerService::Stop() was called
+  StartFailed = 2,  ///< timerfd or timer thread creation failed
+};
+
+/**
+ * @brief Error category for Timer module errors
+ */
+class TimerErrorCategory : public std::error_category {
+ public:
+  const char* name() const noexcept override { return "comm_timer"; }
+  std::string message(int error_value) const override;
+};
+
+/**
+ * @brief Get the singleton instance of TimerErrorCategory
+ */
+const std::error_category& get_timer_error_category() noexcept;
+
+/**
+ * @brief Helper function to create std::error_code from TimerError
+ */
+inline std::error_code make_error_code(TimerError err) noexcept {
+  return {static_cast<int>(err), get_timer_error_category()};
+}
+
+template <typename T>
+class TimerWheel;
+
+/**
+ * @class TimerHandle
+ * @brief Owns a scheduled timer; cancels it when destroyed
+ * @details Move-only. Release() keeps the timer running without the handle.
+ */
+class TimerHandle {
+ public:
+  TimerHandle() = default;
+  ~TimerHandle() { Cancel(); }
+  TimerHandle(TimerHandle&& other) noexcept;
+  TimerHandle& operator=(TimerHandle&& other) noexcept;
+  TimerHandle(const TimerHandle&) = delete;
+  TimerHandle& operator=(const TimerHandle&) = delete;
+
+  /**
+   * @brief Cancel the timer
+   * @return True if the callback will not run; false if it already expired
+   *         (it may be queued or running on its pool) or nothing is held
+   */
+  bool Cancel();
+
+  /**
+   * @brief Forget the timer without cancelling it
+   */
+  void Release() { m_generation = 0; }
+
+  /**
+   * @brief True while the timer is scheduled and has not expired yet
+   */
+  bool IsPending() const;
+
+ private:
+  friend class TimerService;
+
+  std::uint32_t m_index{0};
+  std::uint32_t m_generation{0};  ///< 0 = holds nothing
+};
+
+/**
+ * @brief Counters reported by TimerService::GetStats()
+ */
+struct TimerStats {
+  std::uint64_t scheduled{0};  ///< Timers accepted by Schedule()
+  std::uint64_t expired{0};    ///< Callbacks handed to a pool
+  std::uint64_t cancelled{0};  ///< Timers removed before expiry
+  std::uint64_t wakeups{0};    ///< timerfd expirations handled
+  std::size_t pending{0};      ///< Timers currently in the wheel
+};
+
+/**
+ * @class TimerService
+ * @brief Process-wide timing wheel driven by one timerfd and one thread
+ * @details Started on first use; comm::Main::deinit() stops it before the
+ *          thread pools. Callbacks never run on the timer thread.
+ */
+class TimerService {
+ public:
+  /// Wheel resolution: callbacks run up to one tick late, never early
+  static constexpr std::chrono::milliseconds kTick{1};
+
+  /**
+   * @brief Returns singleton instance of TimerService class
+   * @details Thread-safe initialization using Meyers' Singleton pattern
+   * @return Reference to the single TimerService instance
+   */
+  static TimerService& Instance() {
+    static TimerService instance;
+    return instance;
+  }
+
+  TimerService(const TimerService&) = delete;
+  TimerService& operator=(const TimerService&) = delete;
+
+  /**
+   * @brief Run callback on pool once delay has elapsed
+   * @param callback Callable taking no arguments; may be move-only
+   * @param handle Receives ownership of the timer (cancelled on destruction);
+   *               nullptr for a timer that cannot be cancelled
+   * @param pool Pool running the callback, nullptr = Executor default pool
+   * @return TimerError::Stopped after Stop(), TimerError::StartFailed
+   */
+  template <typename F>
+  std::error_code Schedule(FastClock::duration delay, F&& callback,
+                           TimerHandle* handle = nullptr, ThreadPool* pool = nullptr) {
+    return ScheduleAt(FastClock::now() + delay, std::forward<F>(callback), handle, pool);
+  }
+
+  /**
+   * @brief Run callback on pool at deadline (see Schedule())
+   */
+  template <typename F>
+  std::error_code ScheduleAt(FastClock::time_point deadline, F&& callback,
+                             TimerHandle* handle = nullptr, ThreadPool* pool = nullptr) {
+    using Task = detail::TaskImpl<std::decay_t<F>>;
+    return Add(deadline, std::make_unique<Task>(std::forward<F>(callback)), handle, pool);
+  }
+
+  /**
+   * @brief Drop all pending timers (callbacks are destroyed without running)
+   *        and join the timer thread
+   * @note Later Schedule() calls return TimerError::Stopped
+   */
+  void Stop();
+
+  TimerStats GetStats() const;
+
+ private:
+  friend class TimerHandle;
+
+  struct Entry {
+    std::unique_ptr<detail::TaskNode> callback;
+    ThreadPool* pool;
+  };
+
+  TimerService();
+  ~TimerService();
+
+  std::error_code Add(FastClock::time_point deadline,
+                      std::unique_ptr<detail::TaskNode> callback, TimerHandle* handle,
+                      ThreadPool* pool);
+  bool Cancel(std::uint32_t index, std::uint32_t generation);
+  bool IsPending(std::uint32_t index, std::uint32_t generation) const;
+  std::error_code StartLocked();
+  void Loop();
+  void ArmLocked();
+  static void Dispatch(std::vector<Entry>& expired);
+
+  mutable std::mutex m_mutex;
+  std::unique_ptr<TimerWheel<Entry>> m_wheel;
+  bool m_stopped{false};
+  std::thread m_thread;
+  int m_timer_fd{-1};
+  std::uint64_t m_armed_tick{0};  ///< 0 = disarmed
+  TimerStats m_stats;
+};
+
+}  // namespace comm
+
+namespace std {
+template <>
+struct is_error_code_enum<comm::TimerError> : true_type {};
+}  // namespace std
@@ -0,0 +1,247 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_timer_wheel.h
+ * @brief Hierarchical timing wheel (Varghese & Lauck, scheme 7)
+ * @details kLevels wheels of kSlots slots; a slot of level L covers
+ *          kSlots^L ticks. An entry goes to the level of the highest 6-bit
+ *          digit in which its expiry differs from the current tick, so it
+ *          is moved ("cascaded") at most kLevels - 1 times before it
+ *          expires. Slots are intrusive doubly-linked lists of indexes into
+ *          a node array reused through a free list: insert and cancel are
+ *          O(1) and allocation-free once the array has grown. Per-level
+ *          occupancy bitmaps let Advance() jump over empty ticks. Entries
+ *          beyond the top level (2^36 ticks, 795 days of 1 ms) wait in an
+ *          overflow list that is re-sorted once per top-level rotation.
+ *          Not thread-safe: TimerService serializes access, every shard of
+ *          comm_shard owns a wheel of its own.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace comm {
+
+/**
+ * @brief Reference to a wheel entry; stale once the entry expired or was cancelled
+ */
+struct TimerId {
+  std::uint32_t index{0};
+  std::uint32_t generation{0};  ///< 0 never refers to an entry
+};
+
+/**
+ * @class TimerWheel
+ * @tparam T Payload handed back on expiry or cancellation
+ */
+template <typename T>
+class TimerWheel {
+ public:
+  static constexpr unsigned kSlotBits = 6;
+  static constexpr unsigned kSlots = 1U << kSlotBits;
+  static constexpr unsigned kLevels = 6;
+  static constexpr std::uint64_t kNever = ~std::uint64_t{0};
+
+  explicit TimerWheel(std::uint64_t now = 0) : m_now(now) { m_heads.fill(kNil); }
+
+  std::uint64_t Now() const { return m_now; }
+  std::size_t Size() const { return m_size; }
+
+  /**
+   * @brief Add an entry expiring at tick expiry (at least one tick from now)
+   */
+  TimerId Insert(std::uint64_t expiry, T payload) {
+    expiry = std::max(expiry, m_now + 1);
+    std::uint32_t index;
+    if (m_free != kNil) {
+      index = m_free;
+      m_free = m_nodes[index].next;
+    } else {
+      index = static_cast<std::uint32_t>(m_nodes.size());
+      m_nodes.emplace_back();
+    }
+    Node& node = m_nodes[index];
+    node.expiry = expiry;
+    node.payload.emplace(std::move(payload));
+    ++m_size;
+    Link(index);
+    return {index, node.generation};
+  }
+
+  /**
+   * @brief Remove a pending entry
+   * @return Its payload, or nullopt if id is stale
+   */
+  std::optional<T> Cancel(TimerId id) {
+    if (!IsPending(id)) {
+      return std::nullopt;
+    }
+    Unlink(id.index);
+    return Release(id.index);
+  }
+
+  bool IsPending(TimerId id) const {
+    return id.index < m_nodes.size() && id.generation != 0 &&
+           m_nodes[id.index].generation == id.generation &&
+           m_nodes[id.index].slot != kNil;
+  }
+
+  /**
+   * @brief Earliest tick at which Advance() has work (expiry or cascade)
+   * @return kNever when empty
+   */
+  std::uint64_t NextEventTick() const {
+    std::uint64_t next = kNever;
+    for (unsigned level = 0; level < kLevels; ++level) {
+      const unsigned shift = level * kSlotBits;
+      const unsigned digit = static_cast<unsigned>(m_now >> shift) & (kSlots - 1);
+      // Occupied slots are always ahead of the current digit
+      const std::uint64_t ahead =
+          digit == kSlots - 1 ? 0 : (m_occupied[level] >> (digit + 1)) << (digit + 1);
+      if (ahead == 0) {
+        continue;
+      }
+      const auto slot = static_cast<std::uint64_t>(std::countr_zero(ahead));
+      const std::uint64_t high = m_now >> (shift + kSlotBits) << (shift + kSlotBits);
+      next = std::min(next, high | (slot << shift));
+    }
+    if (m_heads[kOverflow] != kNil) {
+      next = std::min(next, ((m_now >> kRange) + 1) << kRange);
+    }
+    return next;
+  }
+
+  /**
+   * @brief Move the current tick forward to target
+   * @param expired Called with the payload of every entry with expiry <= target,
+   *                in expiry order
+   */
+  template <typename Callback>
+  void Advance(std::uint64_t target, Callback&& expired) {
+    while (true) {
+      const std::uint64_t next = NextEventTick();
+      if (next == kNever || next > target) {
+        m_now = std::max(m_now, target);
+        return;
+      }
+      m_now = next;
+      // Higher levels first: their entries may land in the slot expiring now
+      if ((m_now & ((std::uint64_t{1} << kRange) - 1)) == 0) {
+        Cascade(kOverflow, expired);
+      }
+      for (unsigned level = kLevels - 1; level > 0; --level) {
+        const unsigned shift = level * kSlotBits;
+        if ((m_now & ((std::uint64_t{1} << shift) - 1)) == 0) {
+          Cascade(level * kSlots + (static_cast<unsigned>(m_now >> shift) & (kSlots - 1)),
+                  expired);
+        }
+      }
+      const unsigned slot = static_cast<unsigned>(m_now) & (kSlots - 1);
+      while (m_heads[slot] != kNil) {
+        const std::uint32_t index = m_heads[slot];
+        Unlink(index);
+        expired(Release(index));
+      }
+    }
+  }
+
+ private:
+  static constexpr std::uint32_t kNil = ~std::uint32_t{0};
+  /// Ticks covered by the levels (bits of the expiry)
+  static constexpr unsigned kRange = kSlotBits * kLevels;
+  /// Head index of the overflow list, after the level slots
+  static constexpr std::uint32_t kOverflow = kLevels * kSlots;
+
+  struct Node {
+    std::uint64_t expiry{0};
+    std::uint32_t next{kNil};
+    std::uint32_t previous{kNil};
+    std::uint32_t slot{kNil};  ///< level * kSlots + digit, kOverflow or kNil (not linked)
+    std::uint32_t generation{1};
+    std::optional<T> payload;
+  };
+
+  void Link(std::uint32_t index) {
+    Node& node = m_nodes[index];
+    const std::uint64_t differing = node.expiry ^ m_now;
+    const unsigned level =
+        static_cast<unsigned>(std::bit_width(differing) - 1) / kSlotBits;
+    const unsigned digit =
+        static_cast<unsigned>(node.expiry >> (level * kSlotBits)) & (kSlots - 1);
+    const std::uint32_t slot = level < kLevels ? level * kSlots + digit : kOverflow;
+    node.slot = slot;
+    node.previous = kNil;
+    node.next = m_heads[slot];
+    if (node.next != kNil) {
+      m_nodes[node.next].previous = index;
+    }
+    m_heads[slot] = index;
+    if (slot != kOverflow) {
+      m_occupied[level] |= std::uint64_t{1} << digit;
+    }
+  }
+
+  void Unlink(std::uint32_t index) {
+    Node& node = m_nodes[index];
+    if (node.previous != kNil) {
+      m_nodes[node.previous].next = node.next;
+    } else {
+      m_heads[node.slot] = node.next;
+      if (node.next == kNil && node.slot != kOverflow) {
+        m_occupied[node.slot / kSlots] &= ~(std::uint64_t{1} << (node.slot % kSlots));
+      }
+    }
+    if (node.next != kNil) {
+      m_nodes[node.next].previous = node.previous;
+    }
+    node.slot = kNil;
+  }
+
+  T Release(std::uint32_t index) {
+    Node& node = m_nodes[index];
+    T payload = std::move(*node.payload);
+    node.payload.reset();
+    // Skip 0 so that a default TimerId never matches
+    node.generation = node.generation == ~std::uint32_t{0} ? 1 : node.generation + 1;
+    node.next = m_free;
+    m_free = index;
+    --m_size;
+    return payload;
+  }
+
+  template <typename Callback>
+  void Cascade(std::uint32_t slot, Callback& expired) {
+    std::uint32_t index = m_heads[slot];
+    m_heads[slot] = kNil;
+    if (slot != kOverflow) {
+      m_occupied[slot / kSlots] &= ~(std::uint64_t{1} << (slot % kSlots));
+    }
+    while (index != kNil) {
+      const std::uint32_t next = m_nodes[index].next;
+      if (m_nodes[index].expiry <= m_now) {
+        m_nodes[index].slot = kNil;
+        expired(Release(index));
+      } else {
+        Link(index);
+      }
+      index = next;
+    }
+  }
+
+  std::uint64_t m_now;
+  std::size_t m_size{0};
+  std::uint32_t m_free{kNil};
+  std::vector<Node> m_nodes;
+  std::array<std::uint32_t, kLevels * kSlots + 1> m_heads{};
+  std::array<std::uint64_t, kLevels> m_occupied{};
+};
+
+}  // namespace comm
@@ -0,0 +1,297 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_timer.cpp
+ * @brief TimerService: timing wheel, timerfd thread and batched dispatch
+ */
+
+#include "comm_timer.h"
+
+#include <glog/logging.h>
+#include <pthread.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <exception>
+
+#include "comm_terminate_signals.h"
+#include "comm_timer_wheel.h"
+
+namespace comm {
+
+namespace {
+
+constexpr std::int64_t kTickNs =
+    std::chrono::duration_cast<std::chrono::nanoseconds>(TimerService::kTick).count();
+
+/// Most callbacks handed to a pool as one task
+constexpr std::size_t kDispatchBatch = 64;
+
+/// Current tick, on the clock the timerfd runs on
+std::uint64_t MonotonicNowTick() {
+  timespec now{};
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<std::uint64_t>(
+      (static_cast<std::int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec) / kTickNs);
+}
+
+/// First tick not before deadline_ns: a timer never fires early
+std::uint64_t DeadlineTick(std::int64_t deadline_ns) {
+  return deadline_ns <= 0 ? 0 : static_cast<std::uint64_t>((deadline_ns + kTickNs - 1) / kTickNs);
+}
+
+void RunCallback(detail::TaskNode& callback) {
+  try {
+    callback.Run();
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Timer callback threw an exception: " << e.what();
+  } catch (...) {
+    LOG(ERROR) << "Timer callback threw an unknown exception";
+  }
+}
+
+}  // namespace
+
+// Error category implementation
+std::string TimerErrorCategory::message(int error_value) const {
+  switch (static_cast<TimerError>(error_value)) {
+    case TimerError::Success:
+      return "Success";
+    case TimerError::Stopped:
+      return "Timer service is stopped";
+    case TimerError::StartFailed:
+      return "Failed to start timer service";
+    default:
+      return "Unknown timer error";
+  }
+}
+
+const std::error_category& get_timer_error_category() noexcept {
+  static TimerErrorCategory instance;
+  return instance;
+}
+
+TimerHandle::TimerHandle(TimerHandle&& other) noexcept
+    : m_index(other.m_index), m_generation(other.m_generation) {
+  other.m_generation = 0;
+}
+
+TimerHandle& TimerHandle::operator=(TimerHandle&& other) noexcept {
+  if (this != &other) {
+    Cancel();
+    m_index = other.m_index;
+    m_generation = other.m_generation;
+    other.m_generation = 0;
+  }
+  return *this;
+}
+
+bool TimerHandle::Cancel() {
+  if (m_generation == 0) {
+    return false;
+  }
+  const std::uint32_t generation = m_generation;
+  m_generation = 0;
+  return TimerService::Instance().Cancel(m_index, generation);
+}
+
+bool TimerHandle::IsPending() const {
+  return m_generation != 0 && TimerService::Instance().IsPending(m_index, m_generation);
+}
+
+TimerService::TimerService()
+    : m_wheel(std::make_unique<TimerWheel<Entry>>(MonotonicNowTick())) {}
+
+TimerService::~TimerService() { Stop(); }
+
+std::error_code TimerService::StartLocked() {
+  if (m_thread.joinable()) {
+    return {};
+  }
+  m_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+  if (m_timer_fd < 0) {
+    LOG(ERROR) << "Failed to create timer service timerfd: " << std::strerror(errno);
+    return make_error_code(TimerError::StartFailed);
+  }
+
+  std::error_code result;
+  try {
+    const TerminationSignalBlock block;
+    m_thread = std::thread(&TimerService::Loop, this);
+  } catch (const std::system_error& e) {
+    LOG(ERROR) << "Failed to create timer service thread: " << e.what();
+    result = make_error_code(TimerError::StartFailed);
+  }
+
+  if (result) {
+    close(m_timer_fd);
+    m_timer_fd = -1;
+  }
+  return result;
+}
+
+std::error_code TimerService::Add(FastClock::time_point deadline,
+                                  std::unique_ptr<detail::TaskNode> callback,
+                                  TimerHandle* handle, ThreadPool* pool) {
+  if (handle != nullptr) {
+    // Outside the lock: the replaced timer is cancelled like on assignment
+    handle->Cancel();
+  }
+
+  TimerId id;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stopped) {
+      return make_error_code(TimerError::Stopped);
+    }
+    if (auto result = StartLocked(); result) {
+      return result;
+    }
+    id = m_wheel->Insert(DeadlineTick(deadline.time_since_epoch().count()),
+                         Entry{std::move(callback), pool});
+    ++m_stats.scheduled;
+    ArmLocked();
+  }
+
+  if (handle != nullptr) {
+    handle->m_index = id.index;
+    handle->m_generation = id.generation;
+  }
+  return {};
+}
+
+bool TimerService::Cancel(std::uint32_t index, std::uint32_t generation) {
+  std::optional<Entry> entry;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // The timerfd may still fire for it; that only costs a spurious wake-up
+    entry = m_wheel->Cancel({index, generation});
+    if (entry) {
+      ++m_stats.cancelled;
+    }
+  }
+  // The callback (and whatever it captured) is destroyed outside the lock
+  return entry.has_value();
+}
+
+bool TimerService::IsPending(std::uint32_t index, std::uint32_t generation) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_wheel->IsPending({index, generation});
+}
+
+TimerStats TimerService::GetStats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  TimerStats stats = m_stats;
+  stats.pending = m_wheel->Size();
+  return stats;
+}
+
+void TimerService::ArmLocked() {
+  const std::uint64_t next = m_wheel->NextEventTick();
+  const std::uint64_t armed = next == TimerWheel<Entry>::kNever ? 0 : next;
+  if (armed == m_armed_tick) {
+    return;
+  }
+  m_armed_tick = armed;
+  itimerspec spec{};
+  if (armed != 0) {
+    const auto deadline_ns = static_cast<std::int64_t>(armed) * kTickNs;
+    spec.it_value.tv_sec = deadline_ns / 1000000000;
+    spec.it_value.tv_nsec = deadline_ns % 1000000000;
+  }
+  timerfd_settime(m_timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+void TimerService::Dispatch(std::vector<Entry>& expired) {
+  // Consecutive callbacks for the same pool share one task
+  std::size_t first = 0;
+  while (first < expired.size()) {
+    ThreadPool* pool = expired[first].pool;
+    auto batch = std::make_shared<std::vector<std::unique_ptr<detail::TaskNode>>>();
+    std::size_t last = first;
+    while (last < expired.size() && expired[last].pool == pool &&
+           batch->size() < kDispatchBatch) {
+      batch->push_back(std::move(expired[last].callback));
+      ++last;
+    }
+    first = last;
+
+    ThreadPool& target = pool != nullptr ? *pool : Executor::Instance().Default();
+    auto run = [batch] {
+      for (auto& callback : *batch) {
+        RunCallback(*callback);
+      }
+    };
+    if (auto error = target.Submit(run)) {
+      // Only during shutdown: better late on this thread than never
+      LOG(WARNING) << "Running timer callbacks on the timer thread, pool '"
+                   << target.GetName() << "': " << error.message();
+      run();
+    }
+  }
+  expired.clear();
+}
+
+void TimerService::Loop() {
+  pthread_setname_np(pthread_self(), "comm_timer");
+  std::vector<Entry> expired;
+
+  while (true) {
+    std::uint64_t expirations = 0;
+    if (read(m_timer_fd, &expirations, sizeof(expirations)) < 0 && errno != EINTR) {
+      LOG(ERROR) << "Timer service read() failed: " << std::strerror(errno);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_stopped) {
+        break;
+      }
+      ++m_stats.wakeups;
+      // The timerfd is one-shot: force ArmLocked() to program it again
+      m_armed_tick = 0;
+      m_wheel->Advance(MonotonicNowTick(),
+                       [&expired](Entry&& entry) { expired.push_back(std::move(entry)); });
+      m_stats.expired += expired.size();
+      ArmLocked();
+    }
+
+    // Outside the lock: submitting may run into a full pool or a callback
+    // scheduling the next timer
+    Dispatch(expired);
+  }
+}
+
+void TimerService::Stop() {
+  std::unique_ptr<TimerWheel<Entry>> dropped;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stopped) {
+      return;
+    }
+    m_stopped = true;
+    // Stale handles find nothing in the empty replacement
+    dropped = std::exchange(m_wheel, std::make_unique<TimerWheel<Entry>>(MonotonicNowTick()));
+    if (m_thread.joinable()) {
+      // Fire at once to wake the thread
+      itimerspec spec{};
+      spec.it_value.tv_nsec = 1;
+      timerfd_settime(m_timer_fd, 0, &spec, nullptr);
+    }
+  }
+  if (dropped->Size() > 0) {
+    LOG(INFO) << "Timer service dropped " << dropped->Size() << " pending timers";
+  }
+  if (m_thread.joinable()) {
+    m_thread.join();
+    close(m_timer_fd);
+    m_timer_fd = -1;
+  }
+  LOG(INFO) << "Timer service stopped";
+}
+
+}  // namespace comm
@@ -0,0 +1,220 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_timer_test.cpp
+ * @brief Unit tests for the timing wheel and TimerService
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <map>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "comm_timer.h"
+#include "comm_timer_wheel.h"
+
+namespace comm {
+namespace {
+
+using std::chrono::milliseconds;
+
+std::int64_t ElapsedMs(FastClock::time_point start) {
+  return std::chrono::duration_cast<milliseconds>(FastClock::now() - start).count();
+}
+
+}  // namespace
+
+TEST(TimerWheelTest, ExpiresEachEntryAtItsTickAcrossLevels) {
+  TimerWheel<std::uint64_t> wheel(1000);
+  // Level 0, the level boundaries, the top level and the overflow list
+  const std::vector<std::uint64_t> deltas = {1,     2,      63,          64,
+                                             65,    4095,   4096,        262145,
+                                             1U << 30, (std::uint64_t{1} << 36) + 7};
+  for (const std::uint64_t delta : deltas) {
+    wheel.Insert(1000 + delta, 1000 + delta);
+  }
+  EXPECT_EQ(wheel.Size(), deltas.size());
+
+  for (const std::uint64_t delta : deltas) {
+    const std::uint64_t expiry = 1000 + delta;
+    std::vector<std::uint64_t> expired;
+    wheel.Advance(expiry - 1, [&expired](std::uint64_t value) { expired.push_back(value); });
+    EXPECT_TRUE(expired.empty()) << "early at " << expiry;
+    wheel.Advance(expiry, [&expired](std::uint64_t value) { expired.push_back(value); });
+    ASSERT_EQ(expired.size(), 1U) << "missed " << expiry;
+    EXPECT_EQ(expired[0], expiry);
+  }
+  EXPECT_EQ(wheel.Size(), 0U);
+  EXPECT_EQ(wheel.NextEventTick(), TimerWheel<std::uint64_t>::kNever);
+}
+
+TEST(TimerWheelTest, MatchesReferenceUnderRandomInsertCancelAdvance) {
+  std::mt19937_64 random(42);
+  TimerWheel<std::uint64_t> wheel(random() % 1000000);
+  std::map<std::uint64_t, TimerId> pending;  // expiry * 64 + sequence -> id
+  std::uint64_t sequence = 0;
+
+  for (int round = 0; round < 2000; ++round) {
+    for (int insert = 0; insert < 20; ++insert) {
+      // Mostly short timeouts, some up to hours
+      const std::uint64_t delta = random() % 8 == 0 ? random() % 20000000 : random() % 5000;
+      const std::uint64_t expiry = wheel.Now() + 1 + delta;
+      const std::uint64_t key = expiry * 64 + (sequence++ % 64);
+      if (pending.count(key) == 0) {
+        pending[key] = wheel.Insert(expiry, key);
+      }
+    }
+    if (!pending.empty() && random() % 2 == 0) {
+      auto victim = pending.lower_bound(random() % (pending.rbegin()->first + 1));
+      if (victim != pending.end()) {
+        ASSERT_EQ(wheel.Cancel(victim->second), victim->first);
+        EXPECT_FALSE(wheel.Cancel(victim->second).has_value());
+        pending.erase(victim);
+      }
+    }
+
+    const std::uint64_t target = wheel.Now() + random() % 3000;
+    wheel.Advance(target, [&](std::uint64_t key) {
+      EXPECT_LE(key / 64, target);
+      EXPECT_EQ(pending.erase(key), 1U) << "unexpected or duplicate expiry";
+    });
+    if (!pending.empty()) {
+      ASSERT_GT(pending.begin()->first / 64, target) << "entry not expired in time";
+    }
+    ASSERT_EQ(wheel.Size(), pending.size());
+  }
+}
+
+TEST(TimerWheelTest, StaleIdsDoNotCancelReusedNodes) {
+  TimerWheel<int> wheel;
+  const TimerId first = wheel.Insert(10, 1);
+  EXPECT_TRUE(wheel.IsPending(first));
+  wheel.Advance(10, [](int) {});
+  EXPECT_FALSE(wheel.IsPending(first));
+
+  // Same node, new generation
+  const TimerId second = wheel.Insert(20, 2);
+  EXPECT_EQ(second.index, first.index);
+  EXPECT_FALSE(wheel.Cancel(first).has_value());
+  EXPECT_FALSE(wheel.Cancel(TimerId{}).has_value());
+  EXPECT_EQ(wheel.Cancel(second), 2);
+
+  // Deadlines in the past expire on the next tick
+  wheel.Insert(5, 3);
+  int expired = 0;
+  wheel.Advance(wheel.Now() + 1, [&expired](int value) { expired = value; });
+  EXPECT_EQ(expired, 3);
+}
+
+TEST(TimerServiceTest, RunsCallbackOnChosenPoolAfterDelay) {
+  ThreadPool pool("timer-pool", 1);
+  ASSERT_FALSE(pool.Start());
+  std::promise<ThreadPool*> ran_on;
+  const auto start = FastClock::now();
+  ASSERT_FALSE(TimerService::Instance().Schedule(
+      milliseconds(30), [&ran_on] { ran_on.set_value(ThreadPool::Current()); }, nullptr,
+      &pool));
+  auto result = ran_on.get_future();
+  ASSERT_EQ(result.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+  EXPECT_EQ(result.get(), &pool);
+  EXPECT_GE(ElapsedMs(start), 29);
+
+  // Move-only callback on the default pool
+  std::promise<int> value;
+  auto owned = std::make_unique<int>(7);
+  ASSERT_FALSE(TimerService::Instance().Schedule(
+      milliseconds(1), [owned = std::move(owned), &value] { value.set_value(*owned); }));
+  EXPECT_EQ(value.get_future().get(), 7);
+}
+
+TEST(TimerServiceTest, HandleCancelsOnDestructionAndReassignment) {
+  std::atomic<int> fired{0};
+  {
+    TimerHandle handle;
+    ASSERT_FALSE(TimerService::Instance().Schedule(
+        milliseconds(20), [&fired] { fired.fetch_add(1); }, &handle));
+    EXPECT_TRUE(handle.IsPending());
+  }
+  TimerHandle handle;
+  ASSERT_FALSE(TimerService::Instance().Schedule(
+      milliseconds(20), [&fired] { fired.fetch_add(1); }, &handle));
+  // Scheduling into a handle that holds a timer replaces it
+  ASSERT_FALSE(TimerService::Instance().Schedule(
+      milliseconds(20), [&fired] { fired.fetch_add(10); }, &handle));
+  TimerHandle moved = std::move(handle);
+  EXPECT_FALSE(handle.IsPending());
+  EXPECT_TRUE(moved.IsPending());
+  EXPECT_TRUE(moved.Cancel());
+  EXPECT_FALSE(moved.Cancel());
+
+  std::this_thread::sleep_for(milliseconds(60));
+  EXPECT_EQ(fired.load(), 0);
+
+  // An expired timer can no longer be cancelled
+  std::promise<void> done;
+  ASSERT_FALSE(TimerService::Instance().Schedule(
+      milliseconds(1), [&done] { done.set_value(); }, &moved));
+  done.get_future().wait();
+  EXPECT_FALSE(moved.IsPending());
+  EXPECT_FALSE(moved.Cancel());
+}
+
+TEST(TimerServiceTest, HundredThousandTimersExpireInBatches) {
+  constexpr int kTimers = 100000;
+  std::atomic<int> fired{0};
+  std::atomic<std::int64_t> early{0};
+  std::vector<TimerHandle> handles(kTimers);
+  const TimerStats before = TimerService::Instance().GetStats();
+  const auto start = FastClock::now();
+  for (int index = 0; index < kTimers; ++index) {
+    const auto deadline = start + milliseconds(10 + index % 200);
+    ASSERT_FALSE(TimerService::Instance().ScheduleAt(
+        deadline,
+        [deadline, &fired, &early] {
+          if (FastClock::now() < deadline) {
+            early.fetch_add(1);
+          }
+          fired.fetch_add(1);
+        },
+        &handles[index]));
+  }
+  // Every other one is cancelled again
+  int cancelled = 0;
+  for (int index = 0; index < kTimers; index += 2) {
+    cancelled += handles[index].Cancel() ? 1 : 0;
+  }
+
+  while (fired.load() + cancelled < kTimers && ElapsedMs(start) < 5000) {
+    std::this_thread::sleep_for(milliseconds(5));
+  }
+  EXPECT_EQ(fired.load() + cancelled, kTimers);
+  EXPECT_EQ(early.load(), 0);
+
+  const TimerStats after = TimerService::Instance().GetStats();
+  EXPECT_EQ(after.scheduled - before.scheduled, static_cast<std::uint64_t>(kTimers));
+  EXPECT_EQ(after.cancelled - before.cancelled, static_cast<std::uint64_t>(cancelled));
+  EXPECT_EQ(after.pending, 0U);
+  // Far fewer wake-ups than timers: one per tick with due timers at most
+  EXPECT_LT(after.wakeups - before.wakeups, 1000U);
+}
+
+// Runs last: the service cannot be restarted in this process
+TEST(TimerServiceTest, StopDropsPendingTimers) {
+  std::atomic<bool> fired{false};
+  ASSERT_FALSE(TimerService::Instance().Schedule(std::chrono::seconds(30),
+                                                 [&fired] { fired = true; }));
+  EXPECT_EQ(TimerService::Instance().GetStats().pending, 1U);
+  TimerService::Instance().Stop();
+  EXPECT_EQ(TimerService::Instance().GetStats().pending, 0U);
+  EXPECT_FALSE(fired.load());
+  EXPECT_EQ(TimerService::Instance().Schedule(milliseconds(1), [] {}), TimerError::Stopped);
+}
+
+}  // namespace comm
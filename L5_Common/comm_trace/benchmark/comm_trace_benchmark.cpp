@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_trace_benchmark.cpp
+ * @brief Cost of a span on an instrumented path and of an export
+ * @details BM_SpanDisabled is what instrumentation costs while tracing is
+ *          off, BM_SpanSampledOut a root span whose trace is not sampled,
+ *          BM_Span a recorded root span from 1-8 threads and
+ *          BM_SpanWithAttributes a recorded child span carrying two
+ *          attributes. BM_Render formats 8192 spans as Chrome or OTLP JSON.
+ *
+ * Usage: modu-core-comm_trace_benchmark [--benchmark_filter=...]
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "comm_trace.h"
+
+namespace {
+
+void BM_SpanDisabled(benchmark::State& state) {
+  comm::Tracer::Instance().Disable();
+  for (auto _ : state) {
+    comm::Span span("bench.disabled");
+    benchmark::DoNotOptimize(span.IsRecording());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_SpanSampledOut(benchmark::State& state) {
+  comm::Tracer::Instance().Enable(0.0);
+  for (auto _ : state) {
+    comm::Span span("bench.sampled_out");
+    benchmark::DoNotOptimize(span.IsRecording());
+  }
+  comm::Tracer::Instance().Disable();
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_Span(benchmark::State& state) {
+  if (state.thread_index() == 0) {
+    comm::Tracer::Instance().Enable();
+  }
+  for (auto _ : state) {
+    comm::Span span("bench.span");
+    benchmark::DoNotOptimize(span.IsRecording());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_SpanWithAttributes(benchmark::State& state) {
+  comm::Tracer::Instance().Enable();
+  comm::Span parent("bench.parent");
+  std::int64_t index = 0;
+  for (auto _ : state) {
+    comm::Span span("bench.child");
+    span.SetAttribute("index", ++index);
+    span.SetAttribute("path", "/etc/modu-core/config.toml");
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_Render(benchmark::State& state) {
+  auto& tracer = comm::Tracer::Instance();
+  tracer.Enable(1.0, 1024);
+  tracer.Clear();
+  for (int thread = 0; thread < 8; ++thread) {
+    std::thread([] {
+      for (int span = 0; span < 1024; ++span) {
+        comm::Span outer("bench.render");
+        outer.SetAttribute("span", span);
+      }
+    }).join();
+  }
+  tracer.Disable();
+  const auto format = static_cast<comm::TraceFormat>(state.range(0));
+  std::size_t bytes = 0;
+  for (auto _ : state) {
+    const std::string text = tracer.Render(format);
+    bytes = text.size();
+    benchmark::DoNotOptimize(text.data());
+  }
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * bytes));
+}
+
+}  // namespace
+
+BENCHMARK(BM_SpanDisabled);
+BENCHMARK(BM_SpanSampledOut);
+BENCHMARK(BM_Span)->ThreadRange(1, 8);
+BENCHMARK(BM_SpanWithAttributes);
+BENCHMARK(BM_Render)
+    ->Arg(static_cast<int>(comm::TraceFormat::Chrome))
+    ->Arg(static_cast<int>(comm::TraceFormat::Otlp))
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,275 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_trace.h
+ * @brief In-process tracing: scoped spans recorded into per-thread rings
+ * @details A Span measures one scope. Spans opened while another span is
+ *          open on the same thread become its children; a span started on
+ *          another thread names its parent through a SpanContext. Each
+ *          thread writes finished spans into its own fixed-size ring, the
+ *          newest overwriting the oldest, with no lock: a flight recorder of
+ *          the recent past. Tracer::Render() and Export() read all rings on
+ *          demand and write Chrome/Perfetto trace JSON or OTLP JSON.
+ *
+ *          Tracing is off until Tracer::Enable(); a Span then costs one
+ *          relaxed load. Sampling is decided once per trace, at its root
+ *          span, and children follow it, so traces are kept whole.
+ *
+ * @code
+ * std::error_code Config::Reload() {
+ *   comm::Span span("config.reload");
+ *   span.SetAttribute("path", m_config_paths[0]);
+ *   ...
+ *   for (const auto& listener : listeners) {
+ *     comm::Span listener_span("config.listener");  // child of config.reload
+ *     listener();
+ *   }
+ * }
+ *
+ * // Later, e.g. from an HTTP handler
+ * comm::Tracer::Instance().Export("/tmp/trace.json", comm::TraceFormat::Chrome);
+ * @endcode
+ *
+ *          While a span is open, its trace id is the thread's log trace id
+ *          (SetLogTraceId()), so LOG() records carry it.
+ *
+ * @note Span names and attribute keys are stored as pointers: pass string
+ *       literals or other strings that live until the process exits.
+ *       String attribute values are copied, truncated to kMaxSpanText bytes.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+namespace comm {
+
+/**
+ * @brief Output format of Tracer::Render() and Export()
+ */
+enum class TraceFormat {
+  Chrome,  ///< Trace Event JSON, opened by ui.perfetto.dev and chrome://tracing
+  Otlp,    ///< OpenTelemetry OTLP/JSON ExportTraceServiceRequest
+};
+
+/**
+ * @brief Identity of a span, passed to another thread to parent its spans
+ */
+struct SpanContext {
+  std::uint64_t trace_id{0};
+  std::uint64_t span_id{0};
+  bool sampled{false};
+
+  bool IsValid() const noexcept { return trace_id != 0; }
+};
+
+namespace detail {
+
+inline constexpr std::size_t kMaxSpanAttributes = 4;
+inline constexpr std::size_t kMaxSpanText = 24;
+
+/// Set by Tracer::Enable(), read by every Span constructor
+inline std::atomic<bool> g_tracing_enabled{false};
+
+enum class SpanValueKind : std::uint8_t { Int, Double, Bool, Text };
+
+struct SpanAttribute {
+  const char* key;
+  SpanValueKind kind;
+  std::uint8_t length;  ///< Bytes used in text
+  union {
+    std::int64_t integer;
+    double real;
+    bool boolean;
+    char text[kMaxSpanText];
+  };
+};
+
+/**
+ * @brief One finished span as stored in a thread's ring
+ */
+struct SpanRecord {
+  const char* name;
+  std::uint64_t trace_id;
+  std::uint64_t span_id;
+  std::uint64_t parent_id;  ///< 0 for the root of a trace
+  std::int64_t start_ns;    ///< FastClock::NowNs()
+  std::int64_t duration_ns;
+  std::int32_t tid;
+  std::uint32_t attribute_count;
+  SpanAttribute attributes[kMaxSpanAttributes];
+};
+
+static_assert(std::is_trivially_copyable_v<SpanRecord> && sizeof(SpanRecord) % 8 == 0);
+
+struct TraceRing;
+
+}  // namespace detail
+
+/**
+ * @class Span
+ * @brief Times the enclosing scope; recorded when it ends if its trace is sampled
+ * @warning The thread's current span is thread-local and spans must end in
+ *          reverse order of their start: a Span must begin and end on one
+ *          thread, never held across co_await or a hop to another executor
+ *          or shard. Continue the trace there with Span(name, Context()).
+ */
+class Span {
+ public:
+  /// Child of the thread's current span, or the root of a new trace
+  explicit Span(const char* name) noexcept {
+    if (detail::g_tracing_enabled.load(std::memory_order_relaxed)) {
+      Begin(name, nullptr);
+    }
+  }
+
+  /// Child of parent, typically the Context() of a span on another thread
+  Span(const char* name, const SpanContext& parent) noexcept {
+    if (detail::g_tracing_enabled.load(std::memory_order_relaxed)) {
+      Begin(name, &parent);
+    }
+  }
+
+  ~Span() {
+    if (m_active) {
+      End();
+    }
+  }
+
+  Span(const Span&) = delete;
+  Span& operator=(const Span&) = delete;
+
+  /// True if this span will be recorded
+  bool IsRecording() const noexcept { return m_active && m_sampled; }
+
+  /// Identity to hand to another thread; invalid if tracing was off
+  SpanContext Context() const noexcept {
+    return m_active ? SpanContext{m_record.trace_id, m_record.span_id, m_sampled}
+                    : SpanContext{};
+  }
+
+  /// Attach a key/value to the span; ignored past kMaxSpanAttributes
+  template <typename T>
+    requires std::integral<T> && (!std::same_as<T, bool>)
+  void SetAttribute(const char* key, T value) noexcept {
+    if (detail::SpanAttribute* attribute = NextAttribute(key, detail::SpanValueKind::Int)) {
+      attribute->integer = static_cast<std::int64_t>(value);
+    }
+  }
+  void SetAttribute(const char* key, double value) noexcept;
+  void SetAttribute(const char* key, bool value) noexcept;
+  void SetAttribute(const char* key, std::string_view value) noexcept;
+  void SetAttribute(const char* key, const char* value) noexcept {
+    SetAttribute(key, std::string_view(value));
+  }
+  void SetAttribute(const char* key, const std::string& value) noexcept {
+    SetAttribute(key, std::string_view(value));
+  }
+
+ private:
+  void Begin(const char* name, const SpanContext* parent) noexcept;
+  void End() noexcept;
+  detail::SpanAttribute* NextAttribute(const char* key, detail::SpanValueKind kind) noexcept;
+
+  bool m_active{false};  ///< Begin() ran: this span is the thread's current one
+  bool m_sampled{false};
+  Span* m_parent{nullptr};  ///< Thread's current span before this one
+  std::uint64_t m_log_trace_id{0};  ///< Thread's log trace id before this one
+  detail::SpanRecord m_record;
+};
+
+/**
+ * @brief Counters reported by Tracer::GetStats()
+ */
+struct TraceStats {
+  std::uint64_t spans{0};        ///< Spans recorded into the rings
+  std::uint64_t overwritten{0};  ///< Spans lost because their ring wrapped
+  std::uint64_t sampled_out{0};  ///< Traces not recorded by sampling
+  std::size_t threads{0};        ///< Rings, one per thread that recorded
+};
+
+/**
+ * @class Tracer
+ * @brief Process-wide switch, per-thread rings and the exporters
+ */
+class Tracer {
+ public:
+  /// Spans kept per thread unless Enable() says otherwise (224 KiB per thread)
+  static constexpr std::size_t kDefaultRingSpans = 1024;
+
+  /**
+   * @brief Returns the process-wide tracer
+   * @note Never destroyed: spans may end on threads outliving main()
+   */
+  static Tracer& Instance();
+
+  Tracer(const Tracer&) = delete;
+  Tracer& operator=(const Tracer&) = delete;
+
+  /**
+   * @brief Start recording spans
+   * @param sample_rate Share of new traces recorded, 0-1
+   * @param ring_spans Spans each thread keeps, rounded up to a power of two;
+   *        applies to rings created afterwards
+   */
+  void Enable(double sample_rate = 1.0, std::size_t ring_spans = kDefaultRingSpans);
+
+  /// Stop recording; spans already recorded stay available for export
+  void Disable();
+
+  bool IsEnabled() const noexcept {
+    return detail::g_tracing_enabled.load(std::memory_order_relaxed);
+  }
+
+  /// service.name in OTLP output (default "modu-core")
+  void SetServiceName(std::string name);
+
+  /// Forget the spans recorded so far (they are skipped by later exports)
+  void Clear();
+
+  /**
+   * @brief All spans currently held by the rings, oldest first
+   * @note Safe while other threads record; a span being overwritten during
+   *       the read is skipped
+   */
+  std::string Render(TraceFormat format) const;
+
+  /**
+   * @brief Write Render(format) to path
+   * @return Empty error_code or the system error of opening or writing it
+   */
+  std::error_code Export(const std::string& path, TraceFormat format) const;
+
+  TraceStats GetStats() const;
+
+ private:
+  friend class Span;
+
+  Tracer();
+  ~Tracer();
+
+  std::vector<detail::SpanRecord> Collect() const;
+  detail::TraceRing& CurrentRing();
+  std::shared_ptr<detail::TraceRing> AdoptRing();
+
+  std::atomic<std::uint64_t> m_sample_threshold{~std::uint64_t{0}};  ///< rate * 2^64
+  std::atomic<std::size_t> m_ring_spans{kDefaultRingSpans};
+  std::atomic<std::int64_t> m_cleared_ns{0};
+
+  mutable std::mutex m_mutex;  ///< Guards the ring list and the service name
+  std::vector<std::shared_ptr<detail::TraceRing>> m_rings;
+  std::string m_service_name{"modu-core"};
+};
+
+}  // namespace comm
@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_trace_config.h
+ * @brief [tracing] configuration section and its TOML serialization
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <toml.hpp>
+
+#include "comm_trace.h"
+
+namespace comm {
+
+/**
+ * @brief Settings read from the [tracing] section of config.toml
+ *
+ * @code
+ * [tracing]
+ * enabled = true
+ * sample_rate = 0.1               # share of traces recorded, 0-1
+ * ring_spans = 1024               # spans kept per thread
+ * export_path = "/tmp/modu.json"  # written at shutdown, "" for none
+ * format = "chrome"               # "chrome" (Perfetto) or "otlp"
+ * @endcode
+ *
+ * @note enabled and sample_rate apply on reload; ring_spans applies to
+ *       threads that record their first span afterwards
+ */
+struct TraceConfig {
+  bool enabled = false;
+  double sample_rate = 1.0;
+  std::size_t ring_spans = Tracer::kDefaultRingSpans;
+  std::string export_path;
+  std::string format = "chrome";
+
+  bool operator==(const TraceConfig&) const = default;
+};
+
+/// "otlp" is TraceFormat::Otlp, anything else TraceFormat::Chrome
+TraceFormat ParseTraceFormat(std::string_view name);
+
+/// Enable the Tracer with config's sample rate and ring size, or disable it
+void ApplyTraceConfig(const TraceConfig& config);
+
+// ADL-based serialization functions
+void to_toml(toml::value& dest, const TraceConfig& value);
+void from_toml(const toml::value& src, TraceConfig& value);
+
+}  // namespace comm
@@ -0,0 +1,504 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_trace.cpp
+ * @brief Span recording into per-thread seqlock rings, Chrome and OTLP JSON export
+ */
+
+#include "comm_trace.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+
+#include "comm_clock.h"
+#include "comm_log.h"
+
+namespace comm {
+
+namespace detail {
+
+/**
+ * @brief Fixed-size span ring written by one thread, read by exporters
+ * @details Every slot is a seqlock: the writer makes its sequence odd, stores
+ *          the record as relaxed atomic words and makes the sequence even
+ *          again; a reader keeps a copy only if it saw the same even
+ *          sequence before and after. The writer never waits, and the newest
+ *          span overwrites the oldest.
+ */
+struct TraceRing {
+  static constexpr std::size_t kWords = sizeof(SpanRecord) / sizeof(std::uint64_t);
+
+  struct Slot {
+    std::atomic<std::uint64_t> sequence{0};  ///< Odd while written, 0 if never
+    std::atomic<std::uint64_t> words[kWords];
+  };
+
+  explicit TraceRing(std::size_t spans)
+      : capacity(std::bit_ceil(std::max<std::size_t>(spans, 16))),
+        slots(std::make_unique<Slot[]>(capacity)) {}
+
+  void Write(const SpanRecord& record) noexcept {
+    const std::uint64_t index = head.load(std::memory_order_relaxed);
+    Slot& slot = slots[index & (capacity - 1)];
+    const std::uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::uint64_t words[kWords];
+    std::memcpy(words, &record, sizeof(record));
+    for (std::size_t word = 0; word < kWords; ++word) {
+      slot.words[word].store(words[word], std::memory_order_relaxed);
+    }
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    head.store(index + 1, std::memory_order_release);
+  }
+
+  /// Copy of the slot, false if it is empty or was being written
+  bool Read(std::size_t index, SpanRecord& record) const noexcept {
+    const Slot& slot = slots[index];
+    const std::uint64_t before = slot.sequence.load(std::memory_order_acquire);
+    if (before == 0 || (before & 1) != 0) {
+      return false;
+    }
+    std::uint64_t words[kWords];
+    for (std::size_t word = 0; word < kWords; ++word) {
+      words[word] = slot.words[word].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != before) {
+      return false;
+    }
+    std::memcpy(&record, words, sizeof(record));
+    return true;
+  }
+
+  const std::size_t capacity;
+  std::unique_ptr<Slot[]> slots;
+  std::atomic<std::uint64_t> head{0};         ///< Spans written; owner thread stores
+  std::atomic<std::uint64_t> sampled_out{0};  ///< Root spans not sampled; owner stores
+  std::atomic<bool> orphaned{false};          ///< Owner exited; a new thread may adopt it
+};
+
+}  // namespace detail
+
+namespace {
+
+/// Thread-local handle; hands the ring back for adoption when the thread exits
+struct ThreadRingHandle {
+  std::shared_ptr<detail::TraceRing> ring;
+
+  ~ThreadRingHandle() {
+    if (ring) {
+      ring->orphaned.store(true, std::memory_order_release);
+    }
+  }
+};
+
+thread_local ThreadRingHandle t_ring;
+thread_local Span* t_current_span = nullptr;
+thread_local std::uint64_t t_random_state = 0;
+thread_local std::int32_t t_tid = 0;
+
+/// splitmix64; never returns 0 (0 means "no span")
+std::uint64_t NextId() noexcept {
+  if (t_random_state == 0) {
+    t_random_state = static_cast<std::uint64_t>(FastClock::NowNs()) ^
+                     (static_cast<std::uint64_t>(::gettid()) << 32) ^
+                     reinterpret_cast<std::uintptr_t>(&t_random_state);
+  }
+  std::uint64_t id = 0;
+  do {
+    std::uint64_t z = (t_random_state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    id = z ^ (z >> 31);
+  } while (id == 0);
+  return id;
+}
+
+std::int32_t ThreadId() noexcept {
+  if (t_tid == 0) {
+    t_tid = static_cast<std::int32_t>(::gettid());
+  }
+  return t_tid;
+}
+
+void AppendHex(std::string& out, std::uint64_t value) {
+  char buffer[16];
+  for (int digit = 15; digit >= 0; --digit) {
+    buffer[digit] = "0123456789abcdef"[value & 0xF];
+    value >>= 4;
+  }
+  out.append(buffer, sizeof(buffer));
+}
+
+void AppendInteger(std::string& out, std::int64_t value) {
+  char buffer[24];
+  const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  out.append(buffer, result.ptr);
+}
+
+void AppendDouble(std::string& out, double value) {
+  char buffer[32];
+  const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  out.append(buffer, result.ptr);
+}
+
+/// Microseconds with nanosecond decimals, as the Trace Event format expects
+void AppendMicros(std::string& out, std::int64_t ns) {
+  AppendInteger(out, ns / 1000);
+  char buffer[4] = {'.', static_cast<char>('0' + ns % 1000 / 100),
+                    static_cast<char>('0' + ns % 100 / 10), static_cast<char>('0' + ns % 10)};
+  out.append(buffer, sizeof(buffer));
+}
+
+void AppendJsonString(std::string& out, std::string_view text) {
+  out += '"';
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char buffer[8];
+      std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned>(c));
+      out += buffer;
+    } else {
+      out += c;
+    }
+  }
+  out += '"';
+}
+
+std::string_view TextOf(const detail::SpanAttribute& attribute) {
+  return {attribute.text, attribute.length};
+}
+
+/// "args" object of a Chrome trace event
+void AppendChromeArgs(std::string& out, const detail::SpanRecord& record) {
+  out += "\"args\":{\"trace_id\":\"";
+  AppendHex(out, record.trace_id);
+  out += "\",\"span_id\":\"";
+  AppendHex(out, record.span_id);
+  out += '"';
+  if (record.parent_id != 0) {
+    out += ",\"parent_id\":\"";
+    AppendHex(out, record.parent_id);
+    out += '"';
+  }
+  for (std::uint32_t index = 0; index < record.attribute_count; ++index) {
+    const detail::SpanAttribute& attribute = record.attributes[index];
+    out += ',';
+    AppendJsonString(out, attribute.key);
+    out += ':';
+    switch (attribute.kind) {
+      case detail::SpanValueKind::Int:
+        AppendInteger(out, attribute.integer);
+        break;
+      case detail::SpanValueKind::Double:
+        AppendDouble(out, attribute.real);
+        break;
+      case detail::SpanValueKind::Bool:
+        out += attribute.boolean ? "true" : "false";
+        break;
+      case detail::SpanValueKind::Text:
+        AppendJsonString(out, TextOf(attribute));
+        break;
+    }
+  }
+  out += '}';
+}
+
+std::string RenderChrome(const std::vector<detail::SpanRecord>& spans) {
+  const std::string pid = std::to_string(::getpid());
+  std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  for (const detail::SpanRecord& record : spans) {
+    out += first ? "\n" : ",\n";
+    first = false;
+    out += "{\"name\":";
+    AppendJsonString(out, record.name);
+    out += ",\"cat\":\"modu\",\"ph\":\"X\",\"ts\":";
+    AppendMicros(out, record.start_ns);
+    out += ",\"dur\":";
+    AppendMicros(out, record.duration_ns);
+    out += ",\"pid\":";
+    out += pid;
+    out += ",\"tid\":";
+    AppendInteger(out, record.tid);
+    out += ',';
+    AppendChromeArgs(out, record);
+    out += '}';
+  }
+  out += "\n]}\n";
+  return out;
+}
+
+void AppendOtlpAttribute(std::string& out, std::string_view key,
+                         const detail::SpanAttribute& value) {
+  out += "{\"key\":";
+  AppendJsonString(out, key);
+  out += ",\"value\":{";
+  switch (value.kind) {
+    case detail::SpanValueKind::Int:
+      out += "\"intValue\":\"";  // int64 is a string in proto3 JSON
+      AppendInteger(out, value.integer);
+      out += '"';
+      break;
+    case detail::SpanValueKind::Double:
+      out += "\"doubleValue\":";
+      AppendDouble(out, value.real);
+      break;
+    case detail::SpanValueKind::Bool:
+      out += value.boolean ? "\"boolValue\":true" : "\"boolValue\":false";
+      break;
+    case detail::SpanValueKind::Text:
+      out += "\"stringValue\":";
+      AppendJsonString(out, TextOf(value));
+      break;
+  }
+  out += "}}";
+}
+
+std::string RenderOtlp(const std::vector<detail::SpanRecord>& spans, std::string_view service) {
+  // Span times are FastClock (monotonic); OTLP wants Unix epoch nanoseconds
+  const std::int64_t epoch_offset = FastClock::RealtimeNs() - FastClock::NowNs();
+  std::string out =
+      "{\"resourceSpans\":[{\"resource\":{\"attributes\":[{\"key\":\"service.name\","
+      "\"value\":{\"stringValue\":";
+  AppendJsonString(out, service);
+  out += "}}]},\"scopeSpans\":[{\"scope\":{\"name\":\"comm_trace\"},\"spans\":[";
+  bool first = true;
+  for (const detail::SpanRecord& record : spans) {
+    out += first ? "\n" : ",\n";
+    first = false;
+    out += "{\"traceId\":\"0000000000000000";
+    AppendHex(out, record.trace_id);
+    out += "\",\"spanId\":\"";
+    AppendHex(out, record.span_id);
+    out += '"';
+    if (record.parent_id != 0) {
+      out += ",\"parentSpanId\":\"";
+      AppendHex(out, record.parent_id);
+      out += '"';
+    }
+    out += ",\"name\":";
+    AppendJsonString(out, record.name);
+    out += ",\"kind\":1,\"startTimeUnixNano\":\"";
+    AppendInteger(out, record.start_ns + epoch_offset);
+    out += "\",\"endTimeUnixNano\":\"";
+    AppendInteger(out, record.start_ns + record.duration_ns + epoch_offset);
+    out += "\",\"attributes\":[";
+    detail::SpanAttribute tid{};
+    tid.kind = detail::SpanValueKind::Int;
+    tid.integer = record.tid;
+    AppendOtlpAttribute(out, "thread.id", tid);
+    for (std::uint32_t index = 0; index < record.attribute_count; ++index) {
+      out += ',';
+      AppendOtlpAttribute(out, record.attributes[index].key, record.attributes[index]);
+    }
+    out += "]}";
+  }
+  out += "\n]}]}]}\n";
+  return out;
+}
+
+}  // namespace
+
+void Span::Begin(const char* name, const SpanContext* parent) noexcept {
+  m_active = true;
+  m_parent = t_current_span;
+  t_current_span = this;
+
+  m_record.name = name;
+  m_record.attribute_count = 0;
+  if (parent == nullptr && m_parent != nullptr) {
+    m_record.trace_id = m_parent->m_record.trace_id;
+    m_record.parent_id = m_parent->m_record.span_id;
+    m_sampled = m_parent->m_sampled;
+  } else if (parent != nullptr && parent->IsValid()) {
+    m_record.trace_id = parent->trace_id;
+    m_record.parent_id = parent->span_id;
+    m_sampled = parent->sampled;
+  } else {
+    // Root of a new trace: the only place sampling is decided
+    Tracer& tracer = Tracer::Instance();
+    m_record.trace_id = NextId();
+    m_record.parent_id = 0;
+    const std::uint64_t threshold = tracer.m_sample_threshold.load(std::memory_order_relaxed);
+    m_sampled = threshold == ~std::uint64_t{0} || NextId() < threshold;
+    if (!m_sampled) {
+      // Only this thread writes its ring's counters: no read-modify-write needed
+      std::atomic<std::uint64_t>& sampled_out = tracer.CurrentRing().sampled_out;
+      sampled_out.store(sampled_out.load(std::memory_order_relaxed) + 1,
+                        std::memory_order_relaxed);
+    }
+  }
+  m_record.span_id = NextId();
+  m_log_trace_id = GetLogTraceId();
+  SetLogTraceId(m_record.trace_id);
+  if (m_sampled) {
+    m_record.start_ns = FastClock::NowNs();  // The clock is most of an unsampled span's cost
+  }
+}
+
+void Span::End() noexcept {
+  t_current_span = m_parent;
+  SetLogTraceId(m_log_trace_id);
+  if (!m_sampled) {
+    return;
+  }
+  m_record.duration_ns = FastClock::NowNs() - m_record.start_ns;
+  m_record.tid = ThreadId();
+  Tracer::Instance().CurrentRing().Write(m_record);
+}
+
+detail::SpanAttribute* Span::NextAttribute(const char* key, detail::SpanValueKind kind) noexcept {
+  if (!IsRecording() || m_record.attribute_count == detail::kMaxSpanAttributes) {
+    return nullptr;
+  }
+  detail::SpanAttribute& attribute = m_record.attributes[m_record.attribute_count++];
+  attribute.key = key;
+  attribute.kind = kind;
+  attribute.length = 0;
+  return &attribute;
+}
+
+void Span::SetAttribute(const char* key, double value) noexcept {
+  if (detail::SpanAttribute* attribute = NextAttribute(key, detail::SpanValueKind::Double)) {
+    attribute->real = value;
+  }
+}
+
+void Span::SetAttribute(const char* key, bool value) noexcept {
+  if (detail::SpanAttribute* attribute = NextAttribute(key, detail::SpanValueKind::Bool)) {
+    attribute->boolean = value;
+  }
+}
+
+void Span::SetAttribute(const char* key, std::string_view value) noexcept {
+  if (detail::SpanAttribute* attribute = NextAttribute(key, detail::SpanValueKind::Text)) {
+    const std::size_t length = std::min(value.size(), detail::kMaxSpanText);
+    std::memcpy(attribute->text, value.data(), length);
+    attribute->length = static_cast<std::uint8_t>(length);
+  }
+}
+
+Tracer& Tracer::Instance() {
+  static Tracer* const instance = new Tracer();
+  return *instance;
+}
+
+Tracer::Tracer() = default;
+
+Tracer::~Tracer() = default;
+
+void Tracer::Enable(double sample_rate, std::size_t ring_spans) {
+  const double rate = std::clamp(sample_rate, 0.0, 1.0);
+  m_sample_threshold.store(rate >= 1.0 ? ~std::uint64_t{0}
+                                       : static_cast<std::uint64_t>(rate * 0x1p64),
+                           std::memory_order_relaxed);
+  m_ring_spans.store(ring_spans, std::memory_order_relaxed);
+  detail::g_tracing_enabled.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::Disable() { detail::g_tracing_enabled.store(false, std::memory_order_relaxed); }
+
+void Tracer::SetServiceName(std::string name) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_service_name = std::move(name);
+}
+
+void Tracer::Clear() { m_cleared_ns.store(FastClock::NowNs(), std::memory_order_relaxed); }
+
+detail::TraceRing& Tracer::CurrentRing() {
+  if (!t_ring.ring) {
+    t_ring.ring = AdoptRing();
+  }
+  return *t_ring.ring;
+}
+
+std::shared_ptr<detail::TraceRing> Tracer::AdoptRing() {
+  const std::size_t spans = m_ring_spans.load(std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  // Reuse the ring of an exited thread (its spans stay until overwritten)
+  for (const auto& ring : m_rings) {
+    if (ring->orphaned.load(std::memory_order_acquire) &&
+        ring->capacity == std::bit_ceil(std::max<std::size_t>(spans, 16))) {
+      ring->orphaned.store(false, std::memory_order_relaxed);
+      return ring;
+    }
+  }
+  m_rings.push_back(std::make_shared<detail::TraceRing>(spans));
+  return m_rings.back();
+}
+
+std::vector<detail::SpanRecord> Tracer::Collect() const {
+  std::vector<std::shared_ptr<detail::TraceRing>> rings;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    rings = m_rings;
+  }
+  const std::int64_t cleared_ns = m_cleared_ns.load(std::memory_order_relaxed);
+  std::vector<detail::SpanRecord> spans;
+  detail::SpanRecord record;
+  for (const auto& ring : rings) {
+    for (std::size_t index = 0; index < ring->capacity; ++index) {
+      if (ring->Read(index, record) && record.start_ns >= cleared_ns) {
+        spans.push_back(record);
+      }
+    }
+  }
+  std::sort(spans.begin(), spans.end(), [](const auto& a, const auto& b) {
+    return a.start_ns < b.start_ns;
+  });
+  return spans;
+}
+
+std::string Tracer::Render(TraceFormat format) const {
+  const std::vector<detail::SpanRecord> spans = Collect();
+  if (format == TraceFormat::Otlp) {
+    std::string service;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      service = m_service_name;
+    }
+    return RenderOtlp(spans, service);
+  }
+  return RenderChrome(spans);
+}
+
+std::error_code Tracer::Export(const std::string& path, TraceFormat format) const {
+  const std::string text = Render(format);
+  std::FILE* file = std::fopen(path.c_str(), "w");
+  if (file == nullptr) {
+    return {errno, std::system_category()};
+  }
+  const bool written = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+  const int write_errno = errno;
+  if (std::fclose(file) != 0 || !written) {
+    return {written ? errno : write_errno, std::system_category()};
+  }
+  return {};
+}
+
+TraceStats Tracer::GetStats() const {
+  TraceStats stats;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  stats.threads = m_rings.size();
+  for (const auto& ring : m_rings) {
+    const std::uint64_t written = ring->head.load(std::memory_order_relaxed);
+    stats.spans += written;
+    stats.overwritten += written > ring->capacity ? written - ring->capacity : 0;
+    stats.sampled_out += ring->sampled_out.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+}  // namespace comm
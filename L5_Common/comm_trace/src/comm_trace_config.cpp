@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_trace_config.cpp
+ * @brief Implementation of TraceConfig serialization
+ */
+
+#include "comm_trace_config.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace comm {
+
+TraceFormat ParseTraceFormat(std::string_view name) {
+  return name == "otlp" ? TraceFormat::Otlp : TraceFormat::Chrome;
+}
+
+void ApplyTraceConfig(const TraceConfig& config) {
+  if (config.enabled) {
+    Tracer::Instance().Enable(config.sample_rate, config.ring_spans);
+  } else {
+    Tracer::Instance().Disable();
+  }
+}
+
+void to_toml(toml::value& dest, const TraceConfig& value) {
+  dest["enabled"] = value.enabled;
+  dest["sample_rate"] = value.sample_rate;
+  dest["ring_spans"] = static_cast<std::int64_t>(value.ring_spans);
+  dest["export_path"] = value.export_path;
+  dest["format"] = value.format;
+}
+
+void from_toml(const toml::value& src, TraceConfig& value) {
+  // Use default-constructed struct as source of default values (created once)
+  static const TraceConfig defaults;
+
+  try {
+    value.enabled = toml::find_or(src, "enabled", defaults.enabled);
+    value.sample_rate =
+        std::clamp(toml::find_or(src, "sample_rate", defaults.sample_rate), 0.0, 1.0);
+    value.ring_spans = static_cast<std::size_t>(std::clamp<std::int64_t>(
+        toml::find_or(src, "ring_spans", static_cast<std::int64_t>(defaults.ring_spans)), 16,
+        1 << 20));
+    value.export_path = toml::find_or(src, "export_path", defaults.export_path);
+    value.format = toml::find_or(src, "format", defaults.format);
+    if (value.format != "chrome" && value.format != "otlp") {
+      LOG(WARNING) << "Unknown tracing format '" << value.format << "', using chrome";
+      value.format = defaults.format;
+    }
+
+    LOG(INFO) << "Loaded TraceConfig";
+    LOG(INFO) << "  enabled: " << value.enabled;
+    LOG(INFO) << "  sample_rate: " << value.sample_rate;
+    LOG(INFO) << "  ring_spans: " << value.ring_spans;
+    LOG(INFO) << "  export_path: " << value.export_path;
+    LOG(INFO) << "  format: " << value.format;
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Error parsing TraceConfig: " << e.what();
+    LOG(WARNING) << "Using default values";
+    value = defaults;
+  }
+}
+
+}  // namespace comm
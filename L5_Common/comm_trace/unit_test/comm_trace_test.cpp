@@ -0,0 +1,231 @@
+// SPDX-License-Identifier: BSD-2-Clause
+// SPDX-FileCopyrightText: 2026 Przemek Kieszkowski
+
+/**
+ * @file comm_trace_test.cpp
+ * @brief Unit tests for spans, their rings, sampling and the exporters
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "comm_log.h"
+#include "comm_trace.h"
+
+namespace comm {
+namespace {
+
+std::size_t Count(const std::string& text, const std::string& needle) {
+  std::size_t count = 0;
+  for (std::size_t at = text.find(needle); at != std::string::npos;
+       at = text.find(needle, at + needle.size())) {
+    ++count;
+  }
+  return count;
+}
+
+std::string Hex(std::uint64_t value) {
+  char buffer[17];
+  std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+  return buffer;
+}
+
+/// Each test starts with tracing on, every trace sampled and no spans kept
+class TraceTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Tracer::Instance().Enable();
+    Tracer::Instance().Clear();
+  }
+  void TearDown() override { Tracer::Instance().Disable(); }
+};
+
+TEST_F(TraceTest, DisabledSpansRecordNothing) {
+  Tracer::Instance().Disable();
+  {
+    Span span("disabled");
+    span.SetAttribute("ignored", 1);
+    EXPECT_FALSE(span.IsRecording());
+    EXPECT_FALSE(span.Context().IsValid());
+  }
+  EXPECT_EQ(Tracer::Instance().Render(TraceFormat::Chrome).find("disabled"), std::string::npos);
+}
+
+TEST_F(TraceTest, NestedSpansShareTraceAndNameTheirParent) {
+  SpanContext root_context;
+  SpanContext child_context;
+  SpanContext remote_context;
+  {
+    Span root("root");
+    root.SetAttribute("path", "/etc/modu-core/config.toml");
+    root.SetAttribute("listeners", 3U);
+    root.SetAttribute("ratio", 0.5);
+    root.SetAttribute("ok", true);
+    root.SetAttribute("dropped", 5);  // Past kMaxSpanAttributes
+    root_context = root.Context();
+    {
+      Span child("child");
+      child_context = child.Context();
+    }
+    std::thread([&] {
+      Span remote("remote", root_context);
+      remote_context = remote.Context();
+    }).join();
+  }
+  ASSERT_TRUE(root_context.IsValid());
+  EXPECT_EQ(child_context.trace_id, root_context.trace_id);
+  EXPECT_EQ(remote_context.trace_id, root_context.trace_id);
+  EXPECT_NE(child_context.span_id, root_context.span_id);
+
+  const std::string chrome = Tracer::Instance().Render(TraceFormat::Chrome);
+  EXPECT_EQ(Count(chrome, "\"ph\":\"X\""), 3U);
+  EXPECT_EQ(Count(chrome, "\"parent_id\":\"" + Hex(root_context.span_id) + "\""), 2U);
+  // Text values are cut at kMaxSpanText bytes
+  EXPECT_NE(chrome.find("\"path\":\"/etc/modu-core/config.to\""), std::string::npos);
+  EXPECT_NE(chrome.find("\"listeners\":3,\"ratio\":0.5,\"ok\":true}"), std::string::npos);
+  EXPECT_EQ(chrome.find("dropped"), std::string::npos);
+  // Spans come out oldest first: root started before the spans it encloses
+  EXPECT_LT(chrome.find("\"name\":\"root\""), chrome.find("\"name\":\"child\""));
+
+  Tracer::Instance().SetServiceName("trace-test");
+  const std::string otlp = Tracer::Instance().Render(TraceFormat::Otlp);
+  EXPECT_NE(otlp.find("\"service.name\",\"value\":{\"stringValue\":\"trace-test\"}"),
+            std::string::npos);
+  EXPECT_NE(otlp.find("\"traceId\":\"0000000000000000" + Hex(root_context.trace_id) + "\""),
+            std::string::npos);
+  EXPECT_EQ(Count(otlp, "\"parentSpanId\":\"" + Hex(root_context.span_id) + "\""), 2U);
+  EXPECT_NE(otlp.find("{\"key\":\"listeners\",\"value\":{\"intValue\":\"3\"}}"),
+            std::string::npos);
+  EXPECT_EQ(Count(otlp, "\"startTimeUnixNano\":\"1"), 3U);  // Epoch ns, 2001-2033
+
+  Tracer::Instance().Clear();
+  EXPECT_EQ(Count(Tracer::Instance().Render(TraceFormat::Chrome), "\"ph\":\"X\""), 0U);
+}
+
+TEST_F(TraceTest, SpansSetTheLogTraceId) {
+  SetLogTraceId(42);
+  {
+    Span root("root");
+    EXPECT_EQ(GetLogTraceId(), root.Context().trace_id);
+    {
+      Span child("other_trace", SpanContext{7, 8, true});
+      EXPECT_EQ(GetLogTraceId(), 7U);
+    }
+    EXPECT_EQ(GetLogTraceId(), root.Context().trace_id);
+    std::thread([context = root.Context()] {
+      EXPECT_EQ(GetLogTraceId(), 0U);
+      {
+        Span remote("remote", context);
+        EXPECT_EQ(GetLogTraceId(), context.trace_id);
+      }
+      EXPECT_EQ(GetLogTraceId(), 0U);
+    }).join();
+  }
+  EXPECT_EQ(GetLogTraceId(), 42U);
+
+  Tracer::Instance().Disable();
+  {
+    Span disabled("disabled");
+    EXPECT_EQ(GetLogTraceId(), 42U);
+  }
+  SetLogTraceId(0);
+}
+
+TEST_F(TraceTest, SamplingDropsWholeTraces) {
+  Tracer::Instance().Enable(0.0);
+  const std::uint64_t sampled_out = Tracer::Instance().GetStats().sampled_out;
+  {
+    Span root("unsampled");
+    EXPECT_FALSE(root.IsRecording());
+    ASSERT_TRUE(root.Context().IsValid());  // Still propagated, as not sampled
+    Span child("unsampled_child");
+    EXPECT_FALSE(child.IsRecording());
+    std::thread([context = root.Context()] {
+      Span remote("unsampled_remote", context);
+      EXPECT_FALSE(remote.IsRecording());
+    }).join();
+  }
+  EXPECT_EQ(Tracer::Instance().GetStats().sampled_out, sampled_out + 1);
+  EXPECT_EQ(Tracer::Instance().Render(TraceFormat::Chrome).find("unsampled"), std::string::npos);
+
+  Tracer::Instance().Enable(0.5);
+  int recorded = 0;
+  for (int trace = 0; trace < 2000; ++trace) {
+    Span root("half");
+    recorded += root.IsRecording() ? 1 : 0;
+  }
+  EXPECT_GT(recorded, 800);
+  EXPECT_LT(recorded, 1200);
+}
+
+TEST_F(TraceTest, RingKeepsTheNewestSpans) {
+  Tracer::Instance().Enable(1.0, 16);
+  const TraceStats before = Tracer::Instance().GetStats();
+  std::thread([] {
+    for (int index = 0; index < 40; ++index) {
+      Span span("wrapped");
+      span.SetAttribute("index", index);
+    }
+  }).join();
+  const TraceStats after = Tracer::Instance().GetStats();
+  EXPECT_EQ(after.spans - before.spans, 40U);
+  EXPECT_EQ(after.overwritten - before.overwritten, 24U);
+
+  const std::string chrome = Tracer::Instance().Render(TraceFormat::Chrome);
+  EXPECT_EQ(Count(chrome, "\"name\":\"wrapped\""), 16U);
+  EXPECT_EQ(chrome.find("\"index\":23}"), std::string::npos);
+  EXPECT_NE(chrome.find("\"index\":24}"), std::string::npos);
+  EXPECT_NE(chrome.find("\"index\":39}"), std::string::npos);
+}
+
+TEST_F(TraceTest, ExportsWhileThreadsRecord) {
+  const std::uint64_t recorded = Tracer::Instance().GetStats().spans;
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < 3; ++thread) {
+    threads.emplace_back([&stop] {
+      while (!stop.load(std::memory_order_relaxed)) {
+        Span outer("busy");
+        Span inner("busy_inner");
+        inner.SetAttribute("text", "written while read");
+      }
+    });
+  }
+  while (Tracer::Instance().GetStats().spans < recorded + 1000) {
+    std::this_thread::yield();
+  }
+  // gtest_discover_tests and the whole-binary test may run this concurrently
+  const std::string path =
+      ::testing::TempDir() + "comm_trace_" +
+      ::testing::UnitTest::GetInstance()->current_test_info()->name() + "_" +
+      std::to_string(::getpid()) + ".json";
+  for (int round = 0; round < 20; ++round) {
+    ASSERT_FALSE(Tracer::Instance().Export(path, round % 2 ? TraceFormat::Otlp
+                                                           : TraceFormat::Chrome));
+  }
+  stop.store(true, std::memory_order_relaxed);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::ifstream file(path);
+  std::stringstream text;
+  text << file.rdbuf();
+  EXPECT_NE(text.str().find("\"name\":\"busy_inner\""), std::string::npos);
+  EXPECT_EQ(text.str().rfind("\n]}]}]}\n"), text.str().size() - 8);
+  std::remove(path.c_str());
+
+  EXPECT_EQ(Tracer::Instance().Export("/nonexistent-dir/trace.json", TraceFormat::Chrome),
+            std::errc::no_such_file_or_directory);
+}
+
+}  // namespace
+}  // namespace comm
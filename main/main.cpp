@@ -3,6 +3,7 @@
 
 #include <glog/logging.h>
 #include "comm_main.h"
+#include "comm_shard.h"
 #include "comm_terminate.h"
 #include "infr_main.h"
 #include "config.h"  // CMake-generated project configuration
@@ -34,12 +35,21 @@ int main(const int argc, const char *argv[]) {
     return 1;
   }
       
+  if (comm::ShardRuntime::Instance().IsRunning()) {
+    LOG(INFO) << "Running in sharded mode with " << comm::ShardRuntime::Instance().ShardCount()
+              << " shards";
+  }
+
   // wait for application termination signal
   LOG(INFO) << "Waiting for application termination";
   auto term_reason = comm::Terminate::Instance().WaitForTermination();
 
   LOG(INFO) << "Application is shutting down, reason: " << term_reason;
 
+  // Sharded mode: run the shards' stop callbacks and end their loops while
+  // the layers whose state they touch are still initialized
+  comm::ShardRuntime::Instance().Stop();
+
   // Deinitialize all layers in reverse order (highest to lowest)
   
   // L4 - Infrastructure layer